@@ -70,6 +70,7 @@
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #endif
  
@@ -100,9 +101,25 @@ struct sockaddr_un {
 
 #define MAX_PENDING_CONNECTIONS 10
 
+// max bytes queued for a single client before events are dropped or the client is disconnected
+#ifndef SOCKET_CONNECTION_MAX_QUEUED_BYTES
+#define SOCKET_CONNECTION_MAX_QUEUED_BYTES 65536
+#endif
+
+// max bytes queued for all clients
+#ifndef SOCKET_CONNECTION_MAX_QUEUED_BYTES_TOTAL
+#define SOCKET_CONNECTION_MAX_QUEUED_BYTES_TOTAL 524288
+#endif
+
+// max queued packets written with a single writev call
+#define SOCKET_CONNECTION_MAX_IOVEC 16
+
 /** prototypes */
 static void socket_connection_hci_process(btstack_data_source_t *ds, btstack_data_source_callback_type_t callback_type);
 static int socket_connection_dummy_handler(connection_t *connection, uint16_t packet_type, uint16_t channel, uint8_t *data, uint16_t length);
+#ifndef _WIN32
+static void socket_connection_output_flush(connection_t *conn);
+#endif
 
 /** globals */
 
@@ -124,20 +141,37 @@ typedef struct linked_connection {
     connection_t * connection;
 } linked_connection_t;
 
+/** packet queued for a client that could not be written without blocking */
+typedef struct socket_connection_output {
+    btstack_linked_item_t item;
+    uint16_t len;       // packet header + payload
+    uint16_t offset;    // bytes already written
+    uint8_t  data[0];   // packet header + payload
+} socket_connection_output_t;
+
 struct connection {
     btstack_data_source_t ds;                // used for run loop
     linked_connection_t linked_connection;   // used for connection list
+    linked_connection_t parked_connection;   // used for parked list
     int socket_fd;                           // ds only stores event handle in win32
     SOCKET_STATE state;
     uint16_t bytes_read;
     uint16_t bytes_to_read;
     uint8_t  buffer[6+HCI_ACL_BUFFER_SIZE]; // packet_header(6) + max packet: 3-DH5 = header(6) + payload (1021)
+    // output queue
+    btstack_linked_list_t output_queue;
+    uint32_t output_queued_bytes;
+    uint32_t output_dropped_packets;
+    uint8_t  output_closed;                 // set on write error or overflow, connection is closed on next read
 };
 
 /** list of socket connections */
 static btstack_linked_list_t connections = NULL;
 static btstack_linked_list_t parked = NULL;
 
+/** bytes queued for all connections */
+static uint32_t socket_connection_queued_bytes_total;
+
 #ifdef _WIN32
 // workaround as btstack_data_source_t only stores windows event (instead of fd)
 static int tcp_socket_fd;
@@ -156,12 +190,24 @@ static int socket_connection_dummy_handler(connection_t *connection, uint16_t pa
     return 0;
 }
 
+static void socket_connection_output_discard(connection_t *conn){
+    while (conn->output_queue != NULL){
+        socket_connection_output_t * output = (socket_connection_output_t *) btstack_linked_list_pop(&conn->output_queue);
+        free(output);
+    }
+    socket_connection_queued_bytes_total -= conn->output_queued_bytes;
+    conn->output_queued_bytes = 0;
+}
+
 static void socket_connection_free_connection(connection_t *conn){
     // remove from run_loop 
     btstack_run_loop_remove_data_source(&conn->ds);
     
-    // and from connection list
+    // and from connection and parked list
     btstack_linked_list_remove(&connections, &conn->linked_connection.item);
+    btstack_linked_list_remove(&parked, &conn->parked_connection.item);
+
+    socket_connection_output_discard(conn);
     
 #ifdef _WIN32
     if (conn->ds.source.handle){
@@ -185,8 +231,9 @@ static connection_t * socket_connection_register_new_connection(int fd){
     connection_t * conn = malloc( sizeof(connection_t));
     if (conn == NULL) return NULL;
     memset(conn, 0, sizeof(connection_t));
-    // store reference from linked item to base object
+    // store reference from linked items to base object
     conn->linked_connection.connection = conn;
+    conn->parked_connection.connection = conn;
 
     // keep fd around
     conn->socket_fd = fd;
@@ -239,11 +286,19 @@ void static socket_connection_emit_connection_closed(connection_t *connection){
 }
 
 void socket_connection_hci_process(btstack_data_source_t *socket_ds, btstack_data_source_callback_type_t callback_type) {
-    UNUSED(callback_type);
     connection_t *conn = (connection_t *) socket_ds;
 
     log_debug("socket_connection_hci_process, callback %x", callback_type);
 
+#ifndef _WIN32
+    if (callback_type == DATA_SOURCE_CALLBACK_WRITE){
+        socket_connection_output_flush(conn);
+        return;
+    }
+#else
+    UNUSED(callback_type);
+#endif
+
     // get socket_fd
     int socket_fd = conn->socket_fd;
 
@@ -267,6 +322,14 @@ void socket_connection_hci_process(btstack_data_source_t *socket_ds, btstack_dat
 #endif
 
     log_debug("socket_connection_hci_process fd %x, bytes read %d", socket_fd, bytes_read);
+    if (bytes_read < 0){
+        // non-blocking socket: no data available or interrupted, try again on next callback
+#ifdef _WIN32
+        if (WSAGetLastError() == WSAEWOULDBLOCK) return;
+#else
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) return;
+#endif
+    }
     if (bytes_read <= 0){
         // connection broken (no particular channel, no date yet)
         socket_connection_emit_connection_closed(conn);
@@ -304,11 +367,11 @@ void socket_connection_hci_process(btstack_data_source_t *socket_ds, btstack_dat
         // reset state machine
         socket_connection_init_statemachine(conn);
         
-        // "park" if dispatch failed
+        // "park" if dispatch failed, stop reading but keep writing queued packets
         if (dispatch_err) {
             log_info("socket_connection_hci_process dispatch failed -> park connection");
-            btstack_run_loop_remove_data_source(socket_ds);
-            btstack_linked_list_add_tail(&parked, (btstack_linked_item_t *) socket_ds);
+            btstack_run_loop_disable_data_source_callbacks(socket_ds, DATA_SOURCE_CALLBACK_READ);
+            btstack_linked_list_add_tail(&parked, &conn->parked_connection.item);
         }
     }
 }
@@ -322,7 +385,7 @@ void socket_connection_retry_parked(void){
     // log_info("socket_connection_hci_process retry parked");
     btstack_linked_item_t *it = (btstack_linked_item_t *) &parked;
     while (it->next) {
-        connection_t * conn = (connection_t *) it->next;
+        connection_t * conn = ((linked_connection_t *) it->next)->connection;
         
         // dispatch packet !!! connection, type, channel, data, size
         uint16_t packet_type = little_endian_read_16( conn->buffer, 0);
@@ -334,7 +397,7 @@ void socket_connection_retry_parked(void){
         if (!dispatch_err) {
             log_info("socket_connection_hci_process dispatch succeeded -> un-park connection %p", conn);
             it->next = it->next->next;
-            btstack_run_loop_add_data_source( (btstack_data_source_t *) conn);
+            btstack_run_loop_enable_data_source_callbacks(&conn->ds, DATA_SOURCE_CALLBACK_READ);
         } else {
             it = it->next;
         }
@@ -374,8 +437,20 @@ static void socket_connection_accept(btstack_data_source_t *socket_ds, btstack_d
 	}
         
     log_info("socket_connection_accept new connection %u", fd);
+
+#ifndef _WIN32
+    // never block on a slow client, packets are queued instead
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags >= 0){
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+#endif
     
     connection_t * connection = socket_connection_register_new_connection(fd);
+    if (connection == NULL){
+        close(fd);
+        return;
+    }
     socket_connection_emit_connection_opened(connection);
 }
 
@@ -555,6 +630,165 @@ void socket_connection_register_packet_callback( int (*packet_callback)(connecti
     socket_connection_packet_callback = packet_callback;
 }
 
+#ifndef _WIN32
+
+static int socket_connection_output_droppable(uint16_t type, const uint8_t * packet, uint16_t size){
+    if (type != HCI_EVENT_PACKET) return 0;
+    if (size < 3) return 0;
+    switch (hci_event_packet_get_type(packet)){
+        case HCI_EVENT_INQUIRY_RESULT:
+        case HCI_EVENT_INQUIRY_RESULT_WITH_RSSI:
+        case HCI_EVENT_EXTENDED_INQUIRY_RESPONSE:
+        case GAP_EVENT_ADVERTISING_REPORT:
+        case GAP_EVENT_ADVERTISING_REPORT_BATCH:
+        case GAP_EVENT_INQUIRY_RESULT:
+            return 1;
+        case HCI_EVENT_LE_META:
+            return hci_event_le_meta_get_subevent_code(packet) == HCI_SUBEVENT_LE_ADVERTISING_REPORT;
+        default:
+            return 0;
+    }
+}
+
+// events that report the current state, only the latest one is relevant for the client.
+// a queued, not yet started copy is dropped and the new event is appended at the tail: the client
+// skips intermediate states, and events queued in between are now delivered before the state change
+// instead of after the superseded one. the latest state is never delivered before events preceding it
+static int socket_connection_output_coalescable(uint16_t type, const uint8_t * packet, uint16_t size){
+    if (type != HCI_EVENT_PACKET) return 0;
+    if (size < 2) return 0;
+    switch (hci_event_packet_get_type(packet)){
+        case BTSTACK_EVENT_STATE:
+        case BTSTACK_EVENT_NR_CONNECTIONS_CHANGED:
+        case BTSTACK_EVENT_DISCOVERABLE_ENABLED:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static void socket_connection_output_remove(connection_t *conn, socket_connection_output_t * output){
+    btstack_linked_list_remove(&conn->output_queue, &output->item);
+    conn->output_queued_bytes -= output->len;
+    socket_connection_queued_bytes_total -= output->len;
+    free(output);
+}
+
+// remove queued packets that have not been started yet and match the filter
+static void socket_connection_output_remove_matching(connection_t *conn, int (*filter)(uint16_t type, const uint8_t * packet, uint16_t size), uint8_t event_type){
+    btstack_linked_item_t * it = (btstack_linked_item_t *) &conn->output_queue;
+    while (it->next != NULL){
+        socket_connection_output_t * output = (socket_connection_output_t *) it->next;
+        uint16_t type = little_endian_read_16(output->data, 0);
+        const uint8_t * packet = &output->data[sizeof(packet_header_t)];
+        uint16_t size = output->len - sizeof(packet_header_t);
+        if ((output->offset == 0) && (*filter)(type, packet, size) && ((event_type == 0) || (packet[0] == event_type))){
+            socket_connection_output_remove(conn, output);
+        } else {
+            it = it->next;
+        }
+    }
+}
+
+// stop sending to client, connection is freed when read returns end of stream
+static void socket_connection_output_close(connection_t *conn){
+    conn->output_closed = 1;
+    socket_connection_output_discard(conn);
+    btstack_run_loop_disable_data_source_callbacks(&conn->ds, DATA_SOURCE_CALLBACK_WRITE);
+    btstack_run_loop_enable_data_source_callbacks(&conn->ds, DATA_SOURCE_CALLBACK_READ);
+    shutdown(conn->socket_fd, SHUT_RDWR);
+}
+
+static void socket_connection_output_flush(connection_t *conn){
+    while (conn->output_queue != NULL){
+        // collect queued packets
+        struct iovec iov[SOCKET_CONNECTION_MAX_IOVEC];
+        int iovcnt = 0;
+        btstack_linked_item_t * it;
+        for (it = conn->output_queue; (it != NULL) && (iovcnt < SOCKET_CONNECTION_MAX_IOVEC); it = it->next){
+            socket_connection_output_t * output = (socket_connection_output_t *) it;
+            iov[iovcnt].iov_base = &output->data[output->offset];
+            iov[iovcnt].iov_len  = output->len - output->offset;
+            iovcnt++;
+        }
+
+        ssize_t bytes_written = writev(conn->socket_fd, iov, iovcnt);
+        if (bytes_written < 0){
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)) break;
+            log_error("socket_connection_output_flush write failed, %s", strerror(errno));
+            socket_connection_output_close(conn);
+            return;
+        }
+
+        // remove completely written packets
+        size_t remaining = (size_t) bytes_written;
+        while (remaining > 0){
+            socket_connection_output_t * output = (socket_connection_output_t *) conn->output_queue;
+            size_t len = output->len - output->offset;
+            if (remaining < len){
+                output->offset += (uint16_t) remaining;
+                break;
+            }
+            remaining -= len;
+            socket_connection_output_remove(conn, output);
+        }
+    }
+
+    // get notified when socket becomes writable again
+    if (conn->output_queue == NULL){
+        btstack_run_loop_disable_data_source_callbacks(&conn->ds, DATA_SOURCE_CALLBACK_WRITE);
+    } else {
+        btstack_run_loop_enable_data_source_callbacks(&conn->ds, DATA_SOURCE_CALLBACK_WRITE);
+    }
+}
+
+static int socket_connection_output_has_space(connection_t *conn, uint16_t len){
+    if ((conn->output_queued_bytes + len) > SOCKET_CONNECTION_MAX_QUEUED_BYTES) return 0;
+    if ((socket_connection_queued_bytes_total + len) > SOCKET_CONNECTION_MAX_QUEUED_BYTES_TOTAL) return 0;
+    return 1;
+}
+
+static void socket_connection_output_queue(connection_t *conn, const uint8_t * header, uint16_t type, const uint8_t * packet, uint16_t size, uint16_t offset){
+    uint16_t len = sizeof(packet_header_t) + size;
+
+    // only keep latest state, queued at the tail to keep it after the events preceding it
+    if (socket_connection_output_coalescable(type, packet, size)){
+        socket_connection_output_remove_matching(conn, &socket_connection_output_coalescable, packet[0]);
+    }
+
+    // backpressure: drop scan results first, then give up on client. a partially written packet must be completed
+    if ((offset == 0) && !socket_connection_output_has_space(conn, len)){
+        if (socket_connection_output_droppable(type, packet, size)){
+            conn->output_dropped_packets++;
+            return;
+        }
+        socket_connection_output_remove_matching(conn, &socket_connection_output_droppable, 0);
+        if (!socket_connection_output_has_space(conn, len)){
+            log_error("socket_connection_send_packet: client %p too slow, %u bytes queued -> close connection", conn, conn->output_queued_bytes);
+            socket_connection_output_close(conn);
+            return;
+        }
+    }
+
+    socket_connection_output_t * output = malloc(sizeof(socket_connection_output_t) + len);
+    if (output == NULL){
+        log_error("socket_connection_send_packet: out of memory -> close connection");
+        socket_connection_output_close(conn);
+        return;
+    }
+    (void)memcpy(&output->data[0], header, sizeof(packet_header_t));
+    (void)memcpy(&output->data[sizeof(packet_header_t)], packet, size);
+    output->len    = len;
+    output->offset = offset;
+    btstack_linked_list_add_tail(&conn->output_queue, &output->item);
+    conn->output_queued_bytes += len;
+    socket_connection_queued_bytes_total += len;
+
+    btstack_run_loop_enable_data_source_callbacks(&conn->ds, DATA_SOURCE_CALLBACK_WRITE);
+}
+
+#endif
+
 /**
  * send HCI packet to single connection
  */
@@ -563,17 +797,42 @@ void socket_connection_send_packet(connection_t *conn, uint16_t type, uint16_t c
     little_endian_store_16(header, 0, type);
     little_endian_store_16(header, 2, channel);
     little_endian_store_16(header, 4, size);
+#ifdef _WIN32
     // avoid -Wunused-result
     int res;
-#ifdef _WIN32
     int flags = 0;
     res = send(conn->socket_fd, (const char *) header, 6, flags);
     res = send(conn->socket_fd, (const char *) packet, size, flags);
+    UNUSED(res);
 #else
-    res = write(conn->socket_fd, header, 6);
-    res = write(conn->socket_fd, packet, size);
+    if (conn->output_closed) return;
+
+    // keep order if packets are queued already
+    if (conn->output_queue != NULL){
+        socket_connection_output_queue(conn, header, type, packet, size, 0);
+        return;
+    }
+
+    // try to write header and packet directly
+    struct iovec iov[2];
+    iov[0].iov_base = header;
+    iov[0].iov_len  = sizeof(header);
+    iov[1].iov_base = packet;
+    iov[1].iov_len  = size;
+    ssize_t bytes_written = writev(conn->socket_fd, iov, 2);
+    if (bytes_written < 0){
+        if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)){
+            log_error("socket_connection_send_packet write failed, %s", strerror(errno));
+            socket_connection_output_close(conn);
+            return;
+        }
+        bytes_written = 0;
+    }
+    if ((size_t) bytes_written == (sizeof(header) + size)) return;
+
+    // queue remaining part
+    socket_connection_output_queue(conn, header, type, packet, size, (uint16_t) bytes_written);
 #endif
-    UNUSED(res);
 }
 
 /**
@@ -109,6 +109,8 @@ void socket_connection_register_packet_callback( int (*packet_callback)(connecti
 
 /**
  * send HCI packet to single connection
+ * packets are queued if the client socket is busy. if too many bytes are queued,
+ * scan results are dropped first and the client is disconnected if it does not catch up
  */
 void socket_connection_send_packet(connection_t *connection, uint16_t packet_type, uint16_t channel, uint8_t *data, uint16_t size);
 
@@ -202,6 +202,7 @@ static const btstack_uart_block_t btstack_uart_embedded = {
 	/* int (*get_supported_sleep_modes); */                           &btstack_uart_embedded_get_supported_sleep_modes,
     /* void (*set_sleep)(btstack_uart_sleep_mode_t sleep_mode); */    &btstack_uart_embedded_set_sleep,
     /* void (*set_wakeup_handler)(void (*handler)(void)); */          &btstack_uart_embedded_set_wakeup_handler,
+    /* void (*set_data_received)(void (*handler)(const uint8_t * data, uint16_t size)); */ NULL,
 };
 
 const btstack_uart_block_t * btstack_uart_block_embedded_instance(void){
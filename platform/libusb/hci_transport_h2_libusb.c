@@ -58,6 +58,9 @@
 #include <string.h>
 #include <unistd.h>   /* UNIX standard function definitions */
 #include <sys/types.h>
+#ifndef _WIN32
+#include <poll.h>
+#endif
 
 #include <libusb.h>
 
@@ -79,12 +82,46 @@
 #define HAVE_USB_VENDOR_ID_AND_PRODUCT_ID
 #endif
 
-#define ACL_IN_BUFFER_COUNT    3
+// number of ACL IN transfers that are queued with libusb
+#ifndef HCI_TRANSPORT_USB_ACL_IN_BUFFER_COUNT
+#define HCI_TRANSPORT_USB_ACL_IN_BUFFER_COUNT 8
+#endif
+
+// number of concurrent ACL OUT transfers, outgoing packets are copied into transfer buffers
+// more transfers than controller ACL buffers don't help as HCI stops sending when all buffers are used
+#ifndef HCI_TRANSPORT_USB_ACL_OUT_BUFFER_COUNT
+#define HCI_TRANSPORT_USB_ACL_OUT_BUFFER_COUNT 4
+#endif
+
+#define ACL_IN_BUFFER_COUNT   HCI_TRANSPORT_USB_ACL_IN_BUFFER_COUNT
+#define ACL_OUT_BUFFER_COUNT  HCI_TRANSPORT_USB_ACL_OUT_BUFFER_COUNT
 #define EVENT_IN_BUFFER_COUNT  3
-#define SCO_IN_BUFFER_COUNT   10
 
+// number of SCO IN transfers that are queued with libusb, each with SCO_IN_ISO_PACKETS isochronous packets
+#ifndef HCI_TRANSPORT_USB_SCO_IN_BUFFER_COUNT
+#define HCI_TRANSPORT_USB_SCO_IN_BUFFER_COUNT 10
+#endif
+#ifndef HCI_TRANSPORT_USB_SCO_IN_ISO_PACKETS
+#define HCI_TRANSPORT_USB_SCO_IN_ISO_PACKETS 3
+#endif
+
+// number of SCO OUT transfers, each with a single SCO packet
+#ifndef HCI_TRANSPORT_USB_SCO_OUT_BUFFER_COUNT
+#define HCI_TRANSPORT_USB_SCO_OUT_BUFFER_COUNT 8
+#endif
+
+#define SCO_IN_BUFFER_COUNT   HCI_TRANSPORT_USB_SCO_IN_BUFFER_COUNT
+#define SCO_IN_ISO_PACKETS    HCI_TRANSPORT_USB_SCO_IN_ISO_PACKETS
+
+// SCO statistics are reported every second, i.e. every 1000 isochronous packets
+#define SCO_STATISTICS_INTERVAL_ISO_PACKETS 1000
+
+// polling interval if libusb does not provide file descriptors
 #define ASYNC_POLLING_INTERVAL_MS 1
 
+// max number of file descriptors provided by libusb
+#define USB_MAX_POLLFDS 8
+
 //
 // Bluetooth USB Transport Alternate Settings:
 //
@@ -120,10 +157,11 @@ static const uint16_t iso_packet_size_for_alt_setting[] = {
 // 49 bytes is the max usb packet size for alternate setting 5 (Three 8 kHz 16-bit channels or one 8 kHz 16-bit channel and one 16 kHz 16-bit channel)
 // note: alt setting 6 has max packet size of 63 every 7.5 ms = 472.5 bytes / HCI packet, while max SCO packet has 255 byte payload
 #define SCO_PACKET_SIZE  (49 * NUM_ISO_PACKETS)
+#define SCO_IN_TRANSFER_SIZE  (49 * SCO_IN_ISO_PACKETS)
 
 // Outgoing SCO packet queue
 // simplified ring buffer implementation
-#define SCO_OUT_BUFFER_COUNT  (8)
+#define SCO_OUT_BUFFER_COUNT  HCI_TRANSPORT_USB_SCO_OUT_BUFFER_COUNT
 #define SCO_OUT_BUFFER_SIZE (SCO_OUT_BUFFER_COUNT * SCO_PACKET_SIZE)
 
 // seems to be the max depth for USB 3
@@ -161,7 +199,7 @@ static struct libusb_device_descriptor desc;
 static libusb_device_handle * handle;
 
 static struct libusb_transfer *command_out_transfer;
-static struct libusb_transfer *acl_out_transfer;
+static struct libusb_transfer *acl_out_transfers[ACL_OUT_BUFFER_COUNT];
 static struct libusb_transfer *event_in_transfer[EVENT_IN_BUFFER_COUNT];
 static struct libusb_transfer *acl_in_transfer[ACL_IN_BUFFER_COUNT];
 
@@ -177,7 +215,7 @@ static uint8_t  sco_buffer[255+3 + SCO_PACKET_SIZE];
 static uint16_t sco_read_pos;
 static uint16_t sco_bytes_to_read;
 static struct  libusb_transfer *sco_in_transfer[SCO_IN_BUFFER_COUNT];
-static uint8_t hci_sco_in_buffer[SCO_IN_BUFFER_COUNT][SCO_PACKET_SIZE]; 
+static uint8_t hci_sco_in_buffer[SCO_IN_BUFFER_COUNT][SCO_IN_TRANSFER_SIZE]; 
 
 // outgoing SCO
 static uint8_t  sco_out_ring_buffer[SCO_OUT_BUFFER_SIZE];
@@ -195,6 +233,15 @@ static int      sco_shutdown;
 static uint16_t iso_packet_size;
 static int      sco_enabled;
 
+// SCO statistics for current interval
+static uint32_t sco_statistics_rx_packets;
+static uint32_t sco_statistics_rx_errors;
+static uint16_t sco_statistics_rx_jitter_max_ms;
+static uint32_t sco_statistics_tx_packets;
+static uint32_t sco_statistics_tx_underruns;
+static uint32_t sco_statistics_iso_packets;
+static uint32_t sco_statistics_last_rx_ms;
+
 #endif
 
 // outgoing buffer for HCI Command packets
@@ -204,16 +251,25 @@ static uint8_t hci_cmd_buffer[3 + 256 + LIBUSB_CONTROL_SETUP_SIZE];
 static uint8_t hci_event_in_buffer[EVENT_IN_BUFFER_COUNT][HCI_ACL_BUFFER_SIZE]; // bigger than largest packet
 static uint8_t hci_acl_in_buffer[ACL_IN_BUFFER_COUNT][HCI_INCOMING_PRE_BUFFER_SIZE + HCI_ACL_BUFFER_SIZE]; 
 
+// outgoing buffer for ACL packets
+static uint8_t hci_acl_out_buffer[ACL_OUT_BUFFER_COUNT][HCI_ACL_BUFFER_SIZE];
+static int     acl_out_transfers_in_flight[ACL_OUT_BUFFER_COUNT];
+static int     acl_out_transfers_active;
+// emit packet sent when ACL OUT transfer completes, as HCI could not send because all transfers were in flight
+static int     acl_out_notify_pending;
+// emit packet sent from timer to avoid re-entering HCI from send_packet
+static btstack_timer_source_t acl_out_notify_timer;
+static int     acl_out_notify_timer_active;
+
 // For (ab)use as a linked list of received packets
 static struct libusb_transfer *handle_packet;
 
 static int doing_pollfds;
-static int num_pollfds;
-static btstack_data_source_t * pollfd_data_sources;
+static btstack_data_source_t pollfd_data_sources[USB_MAX_POLLFDS];
+static int pollfd_data_sources_in_use[USB_MAX_POLLFDS];
 static btstack_timer_source_t usb_timer;
 static int usb_timer_active;
 
-static int usb_acl_out_active = 0;
 static int usb_command_active = 0;
 
 // endpoint addresses
@@ -317,6 +373,14 @@ LIBUSB_CALL static void async_callback(struct libusb_transfer *transfer){
                 return;
             }
         }
+        for (c=0;c<ACL_OUT_BUFFER_COUNT;c++){
+            if (transfer == acl_out_transfers[c]){
+                acl_out_transfers_in_flight[c] = 0;
+                libusb_free_transfer(transfer);
+                acl_out_transfers[c] = 0;
+                return;
+            }
+        }
         return;
     }
 
@@ -387,6 +451,7 @@ static int usb_send_sco_packet(uint8_t *packet, int size){
     }
     sco_out_transfers_active++;
     sco_out_transfers_in_flight[tranfer_index] = 1;
+    sco_statistics_tx_packets++;
 
     // log_info("H2: queued packet at index %u, num active %u", tranfer_index, sco_out_transfers_active);
 
@@ -408,8 +473,58 @@ static void sco_state_machine_init(void){
     sco_bytes_to_read = 3;
 }
 
+static void sco_statistics_reset(void){
+    sco_statistics_rx_packets = 0;
+    sco_statistics_rx_errors = 0;
+    sco_statistics_rx_jitter_max_ms = 0;
+    sco_statistics_tx_packets = 0;
+    sco_statistics_tx_underruns = 0;
+    sco_statistics_iso_packets = 0;
+}
+
+static void sco_statistics_emit(void){
+    uint8_t event[20];
+    event[0] = HCI_EVENT_TRANSPORT_SCO_STATISTICS;
+    event[1] = sizeof(event) - 2;
+    little_endian_store_32(event,  2, sco_statistics_rx_packets);
+    little_endian_store_32(event,  6, sco_statistics_rx_errors);
+    little_endian_store_16(event, 10, sco_statistics_rx_jitter_max_ms);
+    little_endian_store_32(event, 12, sco_statistics_tx_packets);
+    little_endian_store_32(event, 16, sco_statistics_tx_underruns);
+    packet_handler(HCI_EVENT_PACKET, &event[0], sizeof(event));
+}
+
+// track deviation of SCO IN transfer completion from nominal interval of 1 ms per isochronous packet
+static void sco_statistics_rx_transfer(int num_iso_packets){
+    uint32_t now_ms = btstack_run_loop_get_time_ms();
+    if (sco_statistics_last_rx_ms != 0){
+        int32_t jitter_ms = (int32_t) (now_ms - sco_statistics_last_rx_ms) - num_iso_packets;
+        if (jitter_ms < 0){
+            jitter_ms = -jitter_ms;
+        }
+        if (jitter_ms > sco_statistics_rx_jitter_max_ms){
+            sco_statistics_rx_jitter_max_ms = (uint16_t) btstack_min(jitter_ms, 0xffff);
+        }
+    }
+    sco_statistics_last_rx_ms = now_ms;
+
+    sco_statistics_iso_packets += num_iso_packets;
+    if (sco_statistics_iso_packets < SCO_STATISTICS_INTERVAL_ISO_PACKETS) return;
+    sco_statistics_emit();
+    sco_statistics_reset();
+}
+
 static void handle_isochronous_data(uint8_t * buffer, uint16_t size){
     while (size){
+        // deliver complete SCO packet without copy
+        if ((sco_read_pos == 0) && (size >= 3) && (size >= (3 + buffer[2]))){
+            uint16_t packet_len = 3 + buffer[2];
+            sco_statistics_rx_packets++;
+            packet_handler(HCI_SCO_DATA_PACKET, buffer, packet_len);
+            buffer += packet_len;
+            size   -= packet_len;
+            continue;
+        }
         if (size < sco_bytes_to_read){
             // just store incomplete data
             memcpy(&sco_buffer[sco_read_pos], buffer, size);
@@ -431,6 +546,7 @@ static void handle_isochronous_data(uint8_t * buffer, uint16_t size){
                 break;
             case H2_W4_PAYLOAD:
                 // packet complete
+                sco_statistics_rx_packets++;
                 packet_handler(HCI_SCO_DATA_PACKET, sco_buffer, sco_read_pos);
                 sco_state_machine_init();
                 break;
@@ -457,24 +573,50 @@ static void handle_completed_transfer(struct libusb_transfer *transfer){
         signal_done = 1;
     } else if (transfer->endpoint == acl_out_addr){
         // log_info("acl out done, size %u", transfer->actual_length);
-        usb_acl_out_active = 0;
-        signal_done = 1;
+        int c;
+        for (c=0;c<ACL_OUT_BUFFER_COUNT;c++){
+            if (transfer == acl_out_transfers[c]){
+                acl_out_transfers_in_flight[c] = 0;
+                acl_out_transfers_active--;
+                break;
+            }
+        }
+        if (acl_out_notify_pending){
+            acl_out_notify_pending = 0;
+            signal_done = 1;
+        }
 #ifdef ENABLE_SCO_OVER_HCI
     } else if (transfer->endpoint == sco_in_addr) {
         // log_info("handle_completed_transfer for SCO IN! num packets %u", transfer->NUM_ISO_PACKETS);
+        // isochronous packets are processed as one block as long as they are adjacent in the transfer buffer
+        uint8_t * block_data = NULL;
+        uint16_t  block_len  = 0;
         int i;
         for (i = 0; i < transfer->num_iso_packets; i++) {
             struct libusb_iso_packet_descriptor *pack = &transfer->iso_packet_desc[i];
             if (pack->status != LIBUSB_TRANSFER_COMPLETED) {
                 log_error("Error: pack %u status %d\n", i, pack->status);
+                sco_statistics_rx_errors++;
                 continue;
             }
             if (!pack->actual_length) continue;
             uint8_t * data = libusb_get_iso_packet_buffer_simple(transfer, i);
             // printf_hexdump(data, pack->actual_length);
             // log_info("handle_isochronous_data,size %u/%u", pack->length, pack->actual_length);
-            handle_isochronous_data(data, pack->actual_length);
+            if ((block_len > 0) && (&block_data[block_len] == data)){
+                block_len += pack->actual_length;
+                continue;
+            }
+            if (block_len > 0){
+                handle_isochronous_data(block_data, block_len);
+            }
+            block_data = data;
+            block_len  = pack->actual_length;
         }
+        if (block_len > 0){
+            handle_isochronous_data(block_data, block_len);
+        }
+        sco_statistics_rx_transfer(transfer->num_iso_packets);
         resubmit = 1;
     } else if (transfer->endpoint == sco_out_addr){
         int i;
@@ -496,6 +638,10 @@ static void handle_completed_transfer(struct libusb_transfer *transfer){
         }
         // decrease tab
         sco_out_transfers_active--;
+        if (sco_out_transfers_active == 0){
+            // controller has no more SCO data to send
+            sco_statistics_tx_underruns++;
+        }
         // log_info("H2: sco out complete, num active num active %u", sco_out_transfers_active);
 #endif
     } else {
@@ -575,6 +721,123 @@ static void usb_process_ts(btstack_timer_source_t *timer) {
     return;
 }
 
+#ifndef _WIN32
+
+static void usb_pollfd_update_timeout(void);
+
+static void usb_pollfd_process_timeout(btstack_timer_source_t *timer) {
+    UNUSED(timer);
+    usb_timer_active = 0;
+    if (libusb_state != LIB_USB_TRANSFERS_ALLOCATED) return;
+    usb_process_ds((struct btstack_data_source *) NULL, DATA_SOURCE_CALLBACK_READ);
+    if (libusb_state != LIB_USB_TRANSFERS_ALLOCATED) return;
+    usb_pollfd_update_timeout();
+}
+
+// libusb timeouts need to be handled by us, if libusb cannot provide a timerfd
+static void usb_pollfd_update_timeout(void){
+    if (libusb_pollfds_handle_timeouts(NULL)) return;
+
+    if (usb_timer_active){
+        btstack_run_loop_remove_timer(&usb_timer);
+        usb_timer_active = 0;
+    }
+
+    struct timeval tv;
+    if (libusb_get_next_timeout(NULL, &tv) != 1) return;
+
+    uint32_t msec = (uint32_t) (tv.tv_sec * 1000) + (uint32_t) ((tv.tv_usec + 999) / 1000);
+    usb_timer.process = usb_pollfd_process_timeout;
+    btstack_run_loop_set_timer(&usb_timer, msec);
+    btstack_run_loop_add_timer(&usb_timer);
+    usb_timer_active = 1;
+}
+
+static void usb_process_pollfd(btstack_data_source_t *ds, btstack_data_source_callback_type_t callback_type) {
+    usb_process_ds(ds, callback_type);
+    if (libusb_state != LIB_USB_TRANSFERS_ALLOCATED) return;
+    usb_pollfd_update_timeout();
+}
+
+static void usb_pollfd_add(int fd, short events){
+    int i;
+    for (i=0;i<USB_MAX_POLLFDS;i++){
+        if (pollfd_data_sources_in_use[i]) continue;
+        btstack_data_source_t *ds = &pollfd_data_sources[i];
+        memset(ds, 0, sizeof(btstack_data_source_t));
+        btstack_run_loop_set_data_source_fd(ds, fd);
+        btstack_run_loop_set_data_source_handler(ds, &usb_process_pollfd);
+        // Linux usbfs reports completed transfers via POLLOUT
+        if (events & POLLIN){
+            btstack_run_loop_enable_data_source_callbacks(ds, DATA_SOURCE_CALLBACK_READ);
+        }
+        if (events & POLLOUT){
+            btstack_run_loop_enable_data_source_callbacks(ds, DATA_SOURCE_CALLBACK_WRITE);
+        }
+        btstack_run_loop_add_data_source(ds);
+        pollfd_data_sources_in_use[i] = 1;
+        log_info("pollfd %u: fd %u, events %x", i, fd, events);
+        return;
+    }
+    log_error("Cannot add pollfd %u, increase USB_MAX_POLLFDS", fd);
+}
+
+static void usb_pollfd_remove_all(void){
+    int i;
+    for (i=0;i<USB_MAX_POLLFDS;i++){
+        if (!pollfd_data_sources_in_use[i]) continue;
+        btstack_run_loop_remove_data_source(&pollfd_data_sources[i]);
+        pollfd_data_sources_in_use[i] = 0;
+    }
+}
+
+LIBUSB_CALL static void usb_pollfd_added(int fd, short events, void * user_data){
+    UNUSED(user_data);
+    usb_pollfd_add(fd, events);
+}
+
+LIBUSB_CALL static void usb_pollfd_removed(int fd, void * user_data){
+    UNUSED(user_data);
+    int i;
+    for (i=0;i<USB_MAX_POLLFDS;i++){
+        if (!pollfd_data_sources_in_use[i]) continue;
+        if (pollfd_data_sources[i].source.fd != fd) continue;
+        btstack_run_loop_remove_data_source(&pollfd_data_sources[i]);
+        pollfd_data_sources_in_use[i] = 0;
+        log_info("pollfd %u: fd %u removed", i, fd);
+    }
+}
+
+// @returns 1 if libusb events are handled via file descriptors
+static int usb_pollfd_start(void){
+    const struct libusb_pollfd ** pollfd = libusb_get_pollfds(NULL);
+    if (pollfd == NULL) return 0;
+
+    log_info("Async using pollfds:");
+    int i;
+    for (i = 0 ; pollfd[i] ; i++){
+        usb_pollfd_add(pollfd[i]->fd, pollfd[i]->events);
+    }
+    libusb_free_pollfds(pollfd);
+    libusb_set_pollfd_notifiers(NULL, &usb_pollfd_added, &usb_pollfd_removed, NULL);
+    usb_pollfd_update_timeout();
+    return 1;
+}
+
+static void usb_pollfd_stop(void){
+    libusb_set_pollfd_notifiers(NULL, NULL, NULL, NULL);
+    usb_pollfd_remove_all();
+}
+#endif
+
+static void usb_acl_out_notify(btstack_timer_source_t *timer){
+    UNUSED(timer);
+    acl_out_notify_timer_active = 0;
+    // notify upper stack that provided buffer can be used again
+    uint8_t event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
+    packet_handler(HCI_EVENT_PACKET, &event[0], sizeof(event));
+}
+
 #ifndef HAVE_USB_VENDOR_ID_AND_PRODUCT_ID
 
 // list of known devices, using VendorID/ProductID tuples
@@ -810,6 +1073,8 @@ static int usb_sco_start(void){
 
     sco_state_machine_init();
     sco_ring_init();
+    sco_statistics_reset();
+    sco_statistics_last_rx_ms = 0;
 
     int alt_setting;
     if (sco_voice_setting & 0x0020){
@@ -832,14 +1097,14 @@ static int usb_sco_start(void){
     // incoming
     int c;
     for (c = 0 ; c < SCO_IN_BUFFER_COUNT ; c++) {
-        sco_in_transfer[c] = libusb_alloc_transfer(NUM_ISO_PACKETS); // isochronous transfers SCO in
+        sco_in_transfer[c] = libusb_alloc_transfer(SCO_IN_ISO_PACKETS); // isochronous transfers SCO in
         if (!sco_in_transfer[c]) {
             usb_close();
             return LIBUSB_ERROR_NO_MEM;
         }
         // configure sco_in handlers
         libusb_fill_iso_transfer(sco_in_transfer[c], handle, sco_in_addr, 
-            hci_sco_in_buffer[c], NUM_ISO_PACKETS * iso_packet_size, NUM_ISO_PACKETS, async_callback, NULL, 0);
+            hci_sco_in_buffer[c], SCO_IN_ISO_PACKETS * iso_packet_size, SCO_IN_ISO_PACKETS, async_callback, NULL, 0);
         libusb_set_iso_packet_lengths(sco_in_transfer[c], iso_packet_size);
         r = libusb_submit_transfer(sco_in_transfer[c]);
         if (r) {
@@ -1077,9 +1342,20 @@ static int usb_open(void){
     }
 
     command_out_transfer = libusb_alloc_transfer(0);
-    acl_out_transfer     = libusb_alloc_transfer(0);
-
-    // TODO check for error
+    if (!command_out_transfer) {
+        usb_close();
+        return LIBUSB_ERROR_NO_MEM;
+    }
+    for (c = 0 ; c < ACL_OUT_BUFFER_COUNT ; c++) {
+        acl_out_transfers[c] = libusb_alloc_transfer(0); // 0 isochronous transfers ACL out
+        if (!acl_out_transfers[c]) {
+            usb_close();
+            return LIBUSB_ERROR_NO_MEM;
+        }
+        acl_out_transfers_in_flight[c] = 0;
+    }
+    acl_out_transfers_active = 0;
+    acl_out_notify_pending = 0;
 
     libusb_state = LIB_USB_TRANSFERS_ALLOCATED;
 
@@ -1108,36 +1384,14 @@ static int usb_open(void){
  
      }
 
- #if 0
-    // Check for pollfds functionality
-    doing_pollfds = libusb_pollfds_handle_timeouts(NULL);
-#else
-    // NOTE: using pollfds doesn't work on Linux, so it is disable until further investigation
+    // use libusb file descriptors if available, e.g. not on Windows
+#ifdef _WIN32
     doing_pollfds = 0;
+#else
+    doing_pollfds = usb_pollfd_start();
 #endif
 
-    if (doing_pollfds) {
-        log_info("Async using pollfds:");
-
-        const struct libusb_pollfd ** pollfd = libusb_get_pollfds(NULL);
-        for (num_pollfds = 0 ; pollfd[num_pollfds] ; num_pollfds++);
-        pollfd_data_sources = (btstack_data_source_t *)malloc(sizeof(btstack_data_source_t) * num_pollfds);
-        if (!pollfd_data_sources){
-            log_error("Cannot allocate data sources for pollfds");
-            usb_close();
-            return 1;            
-        }
-        memset(pollfd_data_sources, 0, sizeof(btstack_data_source_t) * num_pollfds);
-        for (r = 0 ; r < num_pollfds ; r++) {
-            btstack_data_source_t *ds = &pollfd_data_sources[r];
-            btstack_run_loop_set_data_source_fd(ds, pollfd[r]->fd);
-            btstack_run_loop_set_data_source_handler(ds, &usb_process_ds);
-            btstack_run_loop_enable_data_source_callbacks(ds, DATA_SOURCE_CALLBACK_READ);
-            btstack_run_loop_add_data_source(ds);
-            log_info("%u: %p fd: %u, events %x", r, pollfd[r], pollfd[r]->fd, pollfd[r]->events);
-        }
-        free(pollfd);
-    } else {
+    if (!doing_pollfds) {
         log_info("Async using timers:");
 
         usb_timer.process = usb_process_ts;
@@ -1171,17 +1425,17 @@ static int usb_close(void){
                 usb_timer_active = 0;
             }
 
+            if (acl_out_notify_timer_active){
+                btstack_run_loop_remove_timer(&acl_out_notify_timer);
+                acl_out_notify_timer_active = 0;
+            }
+
+#ifndef _WIN32
             if (doing_pollfds){
-                int r;
-                for (r = 0 ; r < num_pollfds ; r++) {
-                    btstack_data_source_t *ds = &pollfd_data_sources[r];
-                    btstack_run_loop_remove_data_source(ds);
-                }
-                free(pollfd_data_sources);
-                pollfd_data_sources = NULL;
-                num_pollfds = 0;
+                usb_pollfd_stop();
                 doing_pollfds = 0;
             }
+#endif
 
         case LIB_USB_INTERFACE_CLAIMED:
             // Cancel all transfers, ignore warnings for this
@@ -1198,6 +1452,15 @@ static int usb_close(void){
                     libusb_cancel_transfer(acl_in_transfer[c]);
                 }
             }
+            for (c = 0 ; c < ACL_OUT_BUFFER_COUNT ; c++) {
+                if (acl_out_transfers_in_flight[c]){
+                    log_info("cancel acl_out_transfers[%u] = %p", c, acl_out_transfers[c]);
+                    libusb_cancel_transfer(acl_out_transfers[c]);
+                } else if (acl_out_transfers[c]) {
+                    libusb_free_transfer(acl_out_transfers[c]);
+                    acl_out_transfers[c] = 0;
+                }
+            }
 #ifdef ENABLE_SCO_OVER_HCI
             for (c = 0 ; c < SCO_IN_BUFFER_COUNT ; c++) {
                 if (sco_in_transfer[c]){
@@ -1249,6 +1512,16 @@ static int usb_close(void){
                     }
                 }
 
+                if (!completed) continue;
+
+                for (c=0;c<ACL_OUT_BUFFER_COUNT;c++){
+                    if (acl_out_transfers[c]) {
+                        log_info("acl_out_transfers[%u] still active (%p)", c, acl_out_transfers[c]);
+                        completed = 0;
+                        break;
+                    }
+                }
+
 #ifdef ENABLE_SCO_OVER_HCI
                 if (!completed) continue;
 
@@ -1330,23 +1603,54 @@ static int usb_send_acl_packet(uint8_t *packet, int size){
     if (libusb_state != LIB_USB_TRANSFERS_ALLOCATED) return -1;
 
     // log_info("usb_send_acl_packet enter, size %u", size);
-    
+
+    if (size > HCI_ACL_BUFFER_SIZE) {
+        log_error("usb_send_acl_packet: size %u > buffer size %u", size, HCI_ACL_BUFFER_SIZE);
+        return -1;
+    }
+
+    // get free transfer
+    int transfer_index;
+    for (transfer_index = 0; transfer_index < ACL_OUT_BUFFER_COUNT; transfer_index++){
+        if (acl_out_transfers_in_flight[transfer_index] == 0) break;
+    }
+    if (transfer_index == ACL_OUT_BUFFER_COUNT) {
+        log_error("usb_send_acl_packet: no free transfer");
+        return -1;
+    }
+
+    // store packet in transfer buffer
+    uint8_t * data = hci_acl_out_buffer[transfer_index];
+    memcpy(data, packet, size);
+
     // prepare transfer
-    int completed = 0;
-    libusb_fill_bulk_transfer(acl_out_transfer, handle, acl_out_addr, packet, size,
-        async_callback, &completed, 0);
+    struct libusb_transfer * acl_out_transfer = acl_out_transfers[transfer_index];
+    libusb_fill_bulk_transfer(acl_out_transfer, handle, acl_out_addr, data, size,
+        async_callback, NULL, 0);
     acl_out_transfer->type = LIBUSB_TRANSFER_TYPE_BULK;
 
-    // update stata before submitting transfer
-    usb_acl_out_active = 1;
-
     r = libusb_submit_transfer(acl_out_transfer);
     if (r < 0) {
-        usb_acl_out_active = 0;
         log_error("Error submitting acl transfer, %d", r);
         return -1;
     }
 
+    // mark transfer as in flight
+    acl_out_transfers_in_flight[transfer_index] = 1;
+    acl_out_transfers_active++;
+
+    // provided buffer can be used again. if all transfers are in flight, notify on transfer complete
+    if (acl_out_transfers_active < ACL_OUT_BUFFER_COUNT){
+        if (!acl_out_notify_timer_active){
+            btstack_run_loop_set_timer_handler(&acl_out_notify_timer, &usb_acl_out_notify);
+            btstack_run_loop_set_timer(&acl_out_notify_timer, 0);
+            btstack_run_loop_add_timer(&acl_out_notify_timer);
+            acl_out_notify_timer_active = 1;
+        }
+    } else {
+        acl_out_notify_pending = 1;
+    }
+
     return 0;
 }
 
@@ -1355,7 +1659,7 @@ static int usb_can_send_packet_now(uint8_t packet_type){
         case HCI_COMMAND_DATA_PACKET:
             return !usb_command_active;
         case HCI_ACL_DATA_PACKET:
-            return !usb_acl_out_active;
+            return acl_out_transfers_active < ACL_OUT_BUFFER_COUNT;
 #ifdef ENABLE_SCO_OVER_HCI
         case HCI_SCO_DATA_PACKET:
             if (!sco_enabled) return 0;
@@ -79,6 +79,9 @@
 
 #define LWIP_TIMER_INTERVAL_MS 25
 
+// destination address, source address, ether type
+#define BNEP_LWIP_ETHERNET_HEADER_SIZE 14
+
 static void bnep_lwip_outgoing_process(void * arg);
 static int bnep_lwip_outgoing_packets_empty(void);
 
@@ -104,9 +107,6 @@ static btstack_packet_handler_t client_handler;
 // next packet only modified from btstack context
 static struct pbuf * bnep_lwip_outgoing_next_packet;
 
-// temp buffer to unchain buffer
-static uint8_t btstack_network_outgoing_buffer[HCI_ACL_PAYLOAD_SIZE];
-
 // helper functions to hide NO_SYS vs. FreeRTOS implementations
 
 static int bnep_lwip_outgoing_init_queue(void){
@@ -371,10 +371,38 @@ static void bnep_lwip_send_packet(void){
         return;
     }
 
-    // flatten into our buffer
-    uint32_t len = btstack_min(sizeof(btstack_network_outgoing_buffer), bnep_lwip_outgoing_next_packet->tot_len);
-    pbuf_copy_partial(bnep_lwip_outgoing_next_packet, btstack_network_outgoing_buffer, len, 0);
-    bnep_send(bnep_cid, (uint8_t*) btstack_network_outgoing_buffer, len);
+    struct pbuf * p = bnep_lwip_outgoing_next_packet;
+    if (p->tot_len < BNEP_LWIP_ETHERNET_HEADER_SIZE){
+        log_error("packet too short");
+        return;
+    }
+
+    // Ethernet header is usually in first pbuf
+    uint8_t header_buffer[BNEP_LWIP_ETHERNET_HEADER_SIZE];
+    uint8_t * header = header_buffer;
+    if (p->len >= BNEP_LWIP_ETHERNET_HEADER_SIZE){
+        header = (uint8_t *) p->payload;
+    } else {
+        pbuf_copy_partial(p, header_buffer, BNEP_LWIP_ETHERNET_HEADER_SIZE, 0);
+    }
+
+    // get buffer with BNEP header for payload
+    uint16_t max_payload_len;
+    uint8_t * payload = bnep_reserve_send_buffer(bnep_cid, &header[0], &header[6], big_endian_read_16(header, 12), &max_payload_len);
+    if (payload == NULL){
+        log_error("cannot reserve send buffer");
+        return;
+    }
+    uint16_t payload_len = p->tot_len - BNEP_LWIP_ETHERNET_HEADER_SIZE;
+    if (payload_len > max_payload_len){
+        log_error("packet too large, %u > %u", payload_len, max_payload_len);
+        bnep_release_send_buffer(bnep_cid);
+        return;
+    }
+
+    // copy pbuf chain directly into outgoing buffer
+    pbuf_copy_partial(p, payload, payload_len, BNEP_LWIP_ETHERNET_HEADER_SIZE);
+    bnep_commit_send_buffer(bnep_cid, payload_len);
 }
 
 static void bnep_lwip_packet_sent(void){
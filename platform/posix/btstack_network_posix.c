@@ -78,11 +78,21 @@
 
 #include "btstack.h"
 
+// number of network packets read from TAP interface and queued for sending
+#ifndef BTSTACK_NETWORK_QUEUE_SIZE
+#define BTSTACK_NETWORK_QUEUE_SIZE 4
+#endif
+
 static int  tap_fd = -1;
-static uint8_t network_buffer[BNEP_MTU_MIN];
-static size_t  network_buffer_len = 0;
 static char tap_dev_name[16];
 
+// ring of network packets, packet at head has been passed to send_packet_callback if packet_in_flight is set
+static uint8_t  network_queue_buffers[BTSTACK_NETWORK_QUEUE_SIZE][BNEP_MTU_MIN];
+static uint16_t network_queue_lengths[BTSTACK_NETWORK_QUEUE_SIZE];
+static uint16_t network_queue_head;
+static uint16_t network_queue_count;
+static bool     network_packet_in_flight;
+
 #if defined(__APPLE__) || defined(__FreeBSD__)
 // tuntaposx provides fixed set of tapX devices
 static const char * tap_dev = "/dev/tap0";
@@ -100,37 +110,56 @@ static btstack_data_source_t tap_dev_ds;
 static void (*btstack_network_send_packet_callback)(const uint8_t * packet, uint16_t size);
 
 /*
- * @text Listing processTapData shows how a packet is received from the TAP network interface
+ * @text Listing processTapData shows how packets are received from the TAP network interface
  * and forwarded over the BNEP connection.
  * 
- * After successfully reading a network packet, the call to
- * the *bnep_can_send_packet_now* function checks, if BTstack can forward
- * a network packet now. If that's not possible, the received data stays
- * in the network buffer and the data source elements is removed from the
- * run loop. The *process_tap_dev_data* function will not be called until
- * the data source is registered again. This provides a basic flow control.
+ * The TAP device is non-blocking. On each wakeup, all available network packets are read 
+ * into the network packet queue until it is full. The first queued packet is passed to the client,
+ * who will call *btstack_network_packet_sent* after the packet was sent.
+ * If the queue is full, the data source elements is disabled in the run loop. 
+ * The *process_tap_dev_data* function will not be called until a packet was sent and the 
+ * data source is enabled again. This provides a basic flow control.
  */
 
+static void network_queue_reset(void){
+    network_queue_head = 0;
+    network_queue_count = 0;
+    network_packet_in_flight = false;
+}
+
+static void network_queue_deliver_next(void){
+    if (network_packet_in_flight) return;
+    if (network_queue_count == 0) return;
+    network_packet_in_flight = true;
+    (*btstack_network_send_packet_callback)(network_queue_buffers[network_queue_head], network_queue_lengths[network_queue_head]);
+}
+
 /* LISTING_START(processTapData): Process incoming network packets */
 static void process_tap_dev_data(btstack_data_source_t *ds, btstack_data_source_callback_type_t callback_type) 
 {
     UNUSED(ds);
     UNUSED(callback_type);
 
-    ssize_t len;
-    len = read(ds->source.fd, network_buffer, sizeof(network_buffer));
-    if (len <= 0){
-        fprintf(stderr, "TAP: Error while reading: %s\n", strerror(errno));
-        return;
+    // read all available packets
+    while (network_queue_count < BTSTACK_NETWORK_QUEUE_SIZE){
+        uint16_t index = (network_queue_head + network_queue_count) % BTSTACK_NETWORK_QUEUE_SIZE;
+        ssize_t len = read(ds->source.fd, network_queue_buffers[index], BNEP_MTU_MIN);
+        if (len <= 0){
+            if ((len < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK))) break;
+            fprintf(stderr, "TAP: Error while reading: %s\n", strerror(errno));
+            break;
+        }
+        network_queue_lengths[index] = (uint16_t) len;
+        network_queue_count++;
     }
 
-    network_buffer_len = len;
-
-    // disable reading from netif
-    btstack_run_loop_disable_data_source_callbacks(&tap_dev_ds, DATA_SOURCE_CALLBACK_READ);
+    // disable reading from netif if queue is full
+    if (network_queue_count == BTSTACK_NETWORK_QUEUE_SIZE){
+        btstack_run_loop_disable_data_source_callbacks(&tap_dev_ds, DATA_SOURCE_CALLBACK_READ);
+    }
 
     // let client now
-    (*btstack_network_send_packet_callback)(network_buffer, network_buffer_len);
+    network_queue_deliver_next();
 }
 
 /**
@@ -240,6 +269,16 @@ int btstack_network_up(bd_addr_t network_address){
 
     close(fd_socket);
 
+    // read all available packets on wakeup
+    int flags = fcntl(fd_dev, F_GETFL, 0);
+    if ((flags < 0) || (fcntl(fd_dev, F_SETFL, flags | O_NONBLOCK) < 0)){
+        close(fd_dev);
+        fprintf(stderr, "TAP: Error setting O_NONBLOCK: %s\n", strerror(errno));
+        return -1;
+    }
+
+    network_queue_reset();
+
     tap_fd = fd_dev;
     log_info("BNEP device \"%s\" allocated", tap_dev_name);
 
@@ -273,6 +312,7 @@ int btstack_network_down(void){
         close(tap_fd);
     }
     tap_fd = -1;
+    network_queue_reset();
     return 0;
 }
 
@@ -300,8 +340,18 @@ void btstack_network_process_packet(const uint8_t * packet, uint16_t size){
  */
 void btstack_network_packet_sent(void){
 
-    network_buffer_len = 0;
+    if (network_packet_in_flight == false) return;
+
+    // drop sent packet
+    network_packet_in_flight = false;
+    network_queue_head = (network_queue_head + 1) % BTSTACK_NETWORK_QUEUE_SIZE;
+    network_queue_count--;
 
     // Re-enable the tap device data source
-    btstack_run_loop_enable_data_source_callbacks(&tap_dev_ds, DATA_SOURCE_CALLBACK_READ);
+    if (tap_fd >= 0){
+        btstack_run_loop_enable_data_source_callbacks(&tap_dev_ds, DATA_SOURCE_CALLBACK_READ);
+    }
+
+    // forward next queued packet
+    network_queue_deliver_next();
 }
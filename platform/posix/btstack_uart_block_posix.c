@@ -72,9 +72,16 @@ static const uint8_t * write_bytes_data;
 static uint16_t  read_bytes_len;
 static uint8_t * read_bytes_data;
 
+// streaming mode: read as much as possible
+#ifndef BTSTACK_UART_POSIX_STREAM_BUFFER_SIZE
+#define BTSTACK_UART_POSIX_STREAM_BUFFER_SIZE 1024
+#endif
+static uint8_t stream_buffer[BTSTACK_UART_POSIX_STREAM_BUFFER_SIZE];
+
 // callbacks
 static void (*block_sent)(void);
 static void (*block_received)(void);
+static void (*data_received)(const uint8_t * data, uint16_t size);
 
 
 static int btstack_uart_posix_init(const btstack_uart_config_t * config){
@@ -120,6 +127,22 @@ static void btstack_uart_posix_process_write(btstack_data_source_t *ds) {
     }
 }
 
+static void btstack_uart_posix_process_stream(btstack_data_source_t *ds) {
+
+    // read all available data
+    ssize_t bytes_read = read(ds->source.fd, stream_buffer, sizeof(stream_buffer));
+    if (bytes_read == 0){
+        log_error("read zero bytes\n");
+        return;
+    }
+    if (bytes_read < 0) {
+        log_error("read returned error\n");
+        return;
+    }
+
+    (*data_received)(stream_buffer, (uint16_t) bytes_read);
+}
+
 static void btstack_uart_posix_process_read(btstack_data_source_t *ds) {
 
     if (read_bytes_len == 0) {
@@ -160,7 +183,11 @@ static void hci_uart_posix_process(btstack_data_source_t *ds, btstack_data_sourc
     if (ds->source.fd < 0) return;
     switch (callback_type){
         case DATA_SOURCE_CALLBACK_READ:
-            btstack_uart_posix_process_read(ds);
+            if (data_received){
+                btstack_uart_posix_process_stream(ds);
+            } else {
+                btstack_uart_posix_process_read(ds);
+            }
             break;
         case DATA_SOURCE_CALLBACK_WRITE:
             btstack_uart_posix_process_write(ds);
@@ -368,6 +395,11 @@ static int btstack_uart_posix_open(void){
     btstack_run_loop_set_data_source_handler(&transport_data_source, &hci_uart_posix_process);
     btstack_run_loop_add_data_source(&transport_data_source);
 
+    // in streaming mode, always read
+    if (data_received){
+        btstack_run_loop_enable_data_source_callbacks(&transport_data_source, DATA_SOURCE_CALLBACK_READ);
+    }
+
     // wait a bit - at least cheap FTDI232 clones might send the first byte out incorrectly
     usleep(100000);
 
@@ -393,6 +425,10 @@ static void btstack_uart_posix_set_block_sent( void (*block_handler)(void)){
     block_sent = block_handler;
 }
 
+static void btstack_uart_posix_set_data_received( void (*data_handler)(const uint8_t * data, uint16_t size)){
+    data_received = data_handler;
+}
+
 static void btstack_uart_posix_send_block(const uint8_t *data, uint16_t size){
     // setup async write
     write_bytes_data = data;
@@ -431,6 +467,7 @@ static const btstack_uart_block_t btstack_uart_posix = {
     /* int (*get_supported_sleep_modes); */                           NULL,
     /* void (*set_sleep)(btstack_uart_sleep_mode_t sleep_mode); */    NULL,
     /* void (*set_wakeup_handler)(void (*handler)(void)); */          NULL,
+    /* void (*set_data_received)(void (*handler)(const uint8_t * data, uint16_t size)); */ &btstack_uart_posix_set_data_received,
 };
 
 const btstack_uart_block_t * btstack_uart_block_posix_instance(void){
@@ -378,6 +378,7 @@ static const btstack_uart_block_t btstack_uart_block_wiced = {
     /* int (*get_supported_sleep_modes); */                           NULL,
     /* void (*set_sleep)(btstack_uart_sleep_mode_t sleep_mode); */    NULL,
     /* void (*set_wakeup_handler)(void (*handler)(void)); */          NULL,
+    /* void (*set_data_received)(void (*handler)(const uint8_t * data, uint16_t size)); */ NULL,
 };
 
 const btstack_uart_block_t * btstack_uart_block_wiced_instance(void){
@@ -47,6 +47,7 @@ $(NAME)_SOURCES += \
 	../../src/btstack_linked_list.c       \
 	../../src/btstack_memory.c            \
 	../../src/btstack_memory_pool.c       \
+	../../src/btstack_ring_buffer.c       \
 	../../src/btstack_resample.c          \
 	../../src/btstack_run_loop.c          \
 	../../src/btstack_util.c              \
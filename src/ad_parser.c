@@ -169,3 +169,202 @@ bool ad_data_contains_uuid128(uint8_t ad_len, const uint8_t * ad_data, const uin
     return false;
 }
 
+
+// Bluetooth Base UUID 00000000-0000-1000-8000-00805F9B34FB without first 4 bytes, in little endian
+static const uint8_t ad_filter_bluetooth_base_uuid_le[12] = {
+    0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00
+};
+
+void ad_filter_init(ad_filter_t * filter){
+    memset(filter, 0, sizeof(ad_filter_t));
+}
+
+// binary search in sorted uuid table, returns index of uuid or of first larger entry
+static uint8_t ad_filter_uuid_index(const ad_filter_t * filter, uint32_t uuid){
+    uint8_t low  = 0;
+    uint8_t high = filter->num_uuids;
+    while (low < high){
+        uint8_t mid = (low + high) / 2;
+        if (filter->uuids[mid].uuid < uuid){
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static uint32_t ad_filter_match_uuid(const ad_filter_t * filter, uint32_t uuid){
+    uint8_t index = ad_filter_uuid_index(filter, uuid);
+    if (index == filter->num_uuids) return 0;
+    if (filter->uuids[index].uuid != uuid) return 0;
+    return filter->uuids[index].rules;
+}
+
+uint8_t ad_filter_add_uuid32(ad_filter_t * filter, uint8_t rule_id, uint32_t uuid32){
+    if (rule_id >= AD_FILTER_MAX_RULES) return ERROR_CODE_INVALID_HCI_COMMAND_PARAMETERS;
+    uint32_t rule = 1u << rule_id;
+    uint8_t index = ad_filter_uuid_index(filter, uuid32);
+    if ((index == filter->num_uuids) || (filter->uuids[index].uuid != uuid32)){
+        if (filter->num_uuids == AD_FILTER_MAX_UUIDS) return ERROR_CODE_MEMORY_CAPACITY_EXCEEDED;
+        // keep table sorted
+        memmove(&filter->uuids[index + 1], &filter->uuids[index], (filter->num_uuids - index) * sizeof(ad_filter_uuid_t));
+        filter->uuids[index].uuid  = uuid32;
+        filter->uuids[index].rules = 0;
+        filter->num_uuids++;
+    }
+    filter->uuids[index].rules |= rule;
+    filter->rules |= rule;
+    return ERROR_CODE_SUCCESS;
+}
+
+uint8_t ad_filter_add_uuid16(ad_filter_t * filter, uint8_t rule_id, uint16_t uuid16){
+    return ad_filter_add_uuid32(filter, rule_id, uuid16);
+}
+
+uint8_t ad_filter_add_uuid128(ad_filter_t * filter, uint8_t rule_id, const uint8_t * uuid128){
+    if (rule_id >= AD_FILTER_MAX_RULES) return ERROR_CODE_INVALID_HCI_COMMAND_PARAMETERS;
+    uint8_t uuid128_le[16];
+    reverse_128(uuid128, uuid128_le);
+    if (memcmp(uuid128_le, ad_filter_bluetooth_base_uuid_le, 12) == 0){
+        return ad_filter_add_uuid32(filter, rule_id, little_endian_read_32(uuid128_le, 12));
+    }
+    uint32_t rule = 1u << rule_id;
+    uint8_t i;
+    for (i=0;i<filter->num_uuid128s;i++){
+        if (memcmp(filter->uuid128s[i].uuid128, uuid128_le, 16) != 0) continue;
+        filter->uuid128s[i].rules |= rule;
+        filter->rules |= rule;
+        return ERROR_CODE_SUCCESS;
+    }
+    if (filter->num_uuid128s == AD_FILTER_MAX_UUID128S) return ERROR_CODE_MEMORY_CAPACITY_EXCEEDED;
+    (void)memcpy(filter->uuid128s[filter->num_uuid128s].uuid128, uuid128_le, 16);
+    filter->uuid128s[filter->num_uuid128s].rules = rule;
+    filter->num_uuid128s++;
+    filter->rules |= rule;
+    return ERROR_CODE_SUCCESS;
+}
+
+uint8_t ad_filter_add_manufacturer_data(ad_filter_t * filter, uint8_t rule_id, uint16_t company_id, const uint8_t * data, const uint8_t * mask, uint8_t len){
+    if (rule_id >= AD_FILTER_MAX_RULES) return ERROR_CODE_INVALID_HCI_COMMAND_PARAMETERS;
+    if (len > AD_FILTER_MANUFACTURER_DATA_MAX_LEN) return ERROR_CODE_INVALID_HCI_COMMAND_PARAMETERS;
+    if (filter->num_manufacturer_data == AD_FILTER_MAX_MANUFACTURER_DATA) return ERROR_CODE_MEMORY_CAPACITY_EXCEEDED;
+    ad_filter_manufacturer_data_t * entry = &filter->manufacturer_data[filter->num_manufacturer_data];
+    entry->company_id = company_id;
+    entry->len = len;
+    uint8_t i;
+    for (i=0;i<len;i++){
+        entry->mask[i] = (mask != NULL) ? mask[i] : 0xff;
+        entry->data[i] = data[i] & entry->mask[i];
+    }
+    entry->rules = 1u << rule_id;
+    filter->num_manufacturer_data++;
+    filter->rules |= entry->rules;
+    return ERROR_CODE_SUCCESS;
+}
+
+uint8_t ad_filter_add_name_prefix(ad_filter_t * filter, uint8_t rule_id, const char * prefix){
+    if (rule_id >= AD_FILTER_MAX_RULES) return ERROR_CODE_INVALID_HCI_COMMAND_PARAMETERS;
+    size_t len = strlen(prefix);
+    if (len > LE_ADVERTISING_DATA_SIZE) return ERROR_CODE_INVALID_HCI_COMMAND_PARAMETERS;
+    if (filter->num_name_prefixes == AD_FILTER_MAX_NAME_PREFIXES) return ERROR_CODE_MEMORY_CAPACITY_EXCEEDED;
+    ad_filter_name_prefix_t * entry = &filter->name_prefixes[filter->num_name_prefixes];
+    entry->prefix = prefix;
+    entry->len = (uint8_t) len;
+    entry->rules = 1u << rule_id;
+    filter->num_name_prefixes++;
+    filter->rules |= entry->rules;
+    return ERROR_CODE_SUCCESS;
+}
+
+static uint32_t ad_filter_match_uuid128(const ad_filter_t * filter, const uint8_t * uuid128_le){
+    if (memcmp(uuid128_le, ad_filter_bluetooth_base_uuid_le, 12) == 0){
+        return ad_filter_match_uuid(filter, little_endian_read_32(uuid128_le, 12));
+    }
+    uint32_t matches = 0;
+    uint8_t i;
+    for (i=0;i<filter->num_uuid128s;i++){
+        if (memcmp(filter->uuid128s[i].uuid128, uuid128_le, 16) == 0){
+            matches |= filter->uuid128s[i].rules;
+        }
+    }
+    return matches;
+}
+
+static uint32_t ad_filter_match_manufacturer_data(const ad_filter_t * filter, const uint8_t * data, uint8_t data_len){
+    if (data_len < 2) return 0;
+    uint16_t company_id = little_endian_read_16(data, 0);
+    uint32_t matches = 0;
+    uint8_t i;
+    for (i=0;i<filter->num_manufacturer_data;i++){
+        const ad_filter_manufacturer_data_t * entry = &filter->manufacturer_data[i];
+        if (entry->company_id != company_id) continue;
+        if ((entry->len + 2) > data_len) continue;
+        uint8_t j;
+        for (j=0;j<entry->len;j++){
+            if ((data[2 + j] & entry->mask[j]) != entry->data[j]) break;
+        }
+        if (j == entry->len){
+            matches |= entry->rules;
+        }
+    }
+    return matches;
+}
+
+static uint32_t ad_filter_match_name(const ad_filter_t * filter, const uint8_t * data, uint8_t data_len){
+    uint32_t matches = 0;
+    uint8_t i;
+    for (i=0;i<filter->num_name_prefixes;i++){
+        const ad_filter_name_prefix_t * entry = &filter->name_prefixes[i];
+        if (entry->len > data_len) continue;
+        if (memcmp(entry->prefix, data, entry->len) == 0){
+            matches |= entry->rules;
+        }
+    }
+    return matches;
+}
+
+uint32_t ad_filter_match(const ad_filter_t * filter, uint8_t ad_len, const uint8_t * ad_data){
+    uint32_t matches = 0;
+    ad_context_t context;
+    for (ad_iterator_init(&context, ad_len, ad_data); ad_iterator_has_more(&context); ad_iterator_next(&context)){
+        uint8_t data_type    = ad_iterator_get_data_type(&context);
+        uint8_t data_len     = ad_iterator_get_data_len(&context);
+        const uint8_t * data = ad_iterator_get_data(&context);
+        int i;
+        switch (data_type){
+            case BLUETOOTH_DATA_TYPE_INCOMPLETE_LIST_OF_16_BIT_SERVICE_CLASS_UUIDS:
+            case BLUETOOTH_DATA_TYPE_COMPLETE_LIST_OF_16_BIT_SERVICE_CLASS_UUIDS:
+                if (filter->num_uuids == 0) break;
+                for (i=0; (i+2) <= data_len; i+=2){
+                    matches |= ad_filter_match_uuid(filter, little_endian_read_16(data, i));
+                }
+                break;
+            case BLUETOOTH_DATA_TYPE_INCOMPLETE_LIST_OF_32_BIT_SERVICE_CLASS_UUIDS:
+            case BLUETOOTH_DATA_TYPE_COMPLETE_LIST_OF_32_BIT_SERVICE_CLASS_UUIDS:
+                if (filter->num_uuids == 0) break;
+                for (i=0; (i+4) <= data_len; i+=4){
+                    matches |= ad_filter_match_uuid(filter, little_endian_read_32(data, i));
+                }
+                break;
+            case BLUETOOTH_DATA_TYPE_INCOMPLETE_LIST_OF_128_BIT_SERVICE_CLASS_UUIDS:
+            case BLUETOOTH_DATA_TYPE_COMPLETE_LIST_OF_128_BIT_SERVICE_CLASS_UUIDS:
+                for (i=0; (i+16) <= data_len; i+=16){
+                    matches |= ad_filter_match_uuid128(filter, &data[i]);
+                }
+                break;
+            case BLUETOOTH_DATA_TYPE_MANUFACTURER_SPECIFIC_DATA:
+                matches |= ad_filter_match_manufacturer_data(filter, data, data_len);
+                break;
+            case BLUETOOTH_DATA_TYPE_SHORTENED_LOCAL_NAME:
+            case BLUETOOTH_DATA_TYPE_COMPLETE_LOCAL_NAME:
+                matches |= ad_filter_match_name(filter, data, data_len);
+                break;
+            default:
+                break;
+        }
+        // all rules matched, remaining fields cannot change result
+        if (matches == filter->rules) break;
+    }
+    return matches;
+}
@@ -53,6 +53,26 @@
 extern "C" {
 #endif
 
+// Advertising Data Filter capacity
+#ifndef AD_FILTER_MAX_UUIDS
+#define AD_FILTER_MAX_UUIDS 8
+#endif
+#ifndef AD_FILTER_MAX_UUID128S
+#define AD_FILTER_MAX_UUID128S 2
+#endif
+#ifndef AD_FILTER_MAX_MANUFACTURER_DATA
+#define AD_FILTER_MAX_MANUFACTURER_DATA 4
+#endif
+#ifndef AD_FILTER_MAX_NAME_PREFIXES
+#define AD_FILTER_MAX_NAME_PREFIXES 2
+#endif
+
+// max manufacturer specific data after company id in legacy advertisement
+#define AD_FILTER_MANUFACTURER_DATA_MAX_LEN 27
+
+// number of rule ids, rule matches are reported as bit mask
+#define AD_FILTER_MAX_RULES 32
+
 /* API_START */
 
 typedef struct ad_context {
@@ -75,6 +95,109 @@ const uint8_t * ad_iterator_get_data(const ad_context_t * context);
 bool ad_data_contains_uuid16(uint8_t ad_len, const uint8_t * ad_data, uint16_t uuid16);
 bool ad_data_contains_uuid128(uint8_t ad_len, const uint8_t * ad_data, const uint8_t * uuid128);
 
+// Advertising Data Filter: rules with 16/32-bit UUIDs sorted for binary search, 128-bit UUIDs in little endian,
+// manufacturer data stored pre-masked. Each entry lists the rules it belongs to as bit mask
+typedef struct {
+    uint32_t uuid;
+    uint32_t rules;
+} ad_filter_uuid_t;
+
+typedef struct {
+    uint8_t  uuid128[16];
+    uint32_t rules;
+} ad_filter_uuid128_t;
+
+typedef struct {
+    uint16_t company_id;
+    uint8_t  len;
+    uint8_t  data[AD_FILTER_MANUFACTURER_DATA_MAX_LEN];
+    uint8_t  mask[AD_FILTER_MANUFACTURER_DATA_MAX_LEN];
+    uint32_t rules;
+} ad_filter_manufacturer_data_t;
+
+typedef struct {
+    const char * prefix;
+    uint8_t      len;
+    uint32_t     rules;
+} ad_filter_name_prefix_t;
+
+typedef struct {
+    // rules with at least one criterion
+    uint32_t rules;
+    uint8_t  num_uuids;
+    uint8_t  num_uuid128s;
+    uint8_t  num_manufacturer_data;
+    uint8_t  num_name_prefixes;
+    ad_filter_uuid_t              uuids[AD_FILTER_MAX_UUIDS];
+    ad_filter_uuid128_t           uuid128s[AD_FILTER_MAX_UUID128S];
+    ad_filter_manufacturer_data_t manufacturer_data[AD_FILTER_MAX_MANUFACTURER_DATA];
+    ad_filter_name_prefix_t       name_prefixes[AD_FILTER_MAX_NAME_PREFIXES];
+} ad_filter_t;
+
+/**
+ * @brief Init Advertising Data Filter without rules
+ * @note A rule is identified by its rule id 0..31 and matches if any of its criteria matches
+ * @param filter
+ */
+void ad_filter_init(ad_filter_t * filter);
+
+/**
+ * @brief Add 16-bit Service UUID to rule. Matches 16, 32, and 128-bit Service UUID lists
+ * @param filter
+ * @param rule_id < AD_FILTER_MAX_RULES
+ * @param uuid16
+ * @return status ERROR_CODE_SUCCESS, ERROR_CODE_MEMORY_CAPACITY_EXCEEDED, or ERROR_CODE_INVALID_HCI_COMMAND_PARAMETERS
+ */
+uint8_t ad_filter_add_uuid16(ad_filter_t * filter, uint8_t rule_id, uint16_t uuid16);
+
+/**
+ * @brief Add 32-bit Service UUID to rule. Matches 16, 32, and 128-bit Service UUID lists
+ * @param filter
+ * @param rule_id < AD_FILTER_MAX_RULES
+ * @param uuid32
+ * @return status
+ */
+uint8_t ad_filter_add_uuid32(ad_filter_t * filter, uint8_t rule_id, uint32_t uuid32);
+
+/**
+ * @brief Add 128-bit Service UUID to rule. UUIDs based on the Bluetooth Base UUID are handled as 32-bit UUIDs
+ * @param filter
+ * @param rule_id < AD_FILTER_MAX_RULES
+ * @param uuid128 in big endian/network order
+ * @return status
+ */
+uint8_t ad_filter_add_uuid128(ad_filter_t * filter, uint8_t rule_id, const uint8_t * uuid128);
+
+/**
+ * @brief Add Manufacturer Specific Data to rule
+ * @param filter
+ * @param rule_id < AD_FILTER_MAX_RULES
+ * @param company_id
+ * @param data expected data following the company id, can be NULL if len == 0
+ * @param mask for data, bits set in mask have to match, NULL = all bits have to match
+ * @param len of data and mask, max AD_FILTER_MANUFACTURER_DATA_MAX_LEN
+ * @return status
+ */
+uint8_t ad_filter_add_manufacturer_data(ad_filter_t * filter, uint8_t rule_id, uint16_t company_id, const uint8_t * data, const uint8_t * mask, uint8_t len);
+
+/**
+ * @brief Add local name prefix to rule. Matches Shortened and Complete Local Name
+ * @param filter
+ * @param rule_id < AD_FILTER_MAX_RULES
+ * @param prefix has to stay valid while filter is used
+ * @return status
+ */
+uint8_t ad_filter_add_name_prefix(ad_filter_t * filter, uint8_t rule_id, const char * prefix);
+
+/**
+ * @brief Evaluate Advertising or Scan Response data in a single pass
+ * @param filter
+ * @param ad_len
+ * @param ad_data
+ * @return bit mask of matching rule ids, bit n set for rule id n
+ */
+uint32_t ad_filter_match(const ad_filter_t * filter, uint8_t ad_len, const uint8_t * ad_data);
+
 /* API_END */
 
 #if defined __cplusplus
@@ -95,6 +95,7 @@ typedef struct {
 
 // global
 static btstack_packet_callback_registration_t hci_event_callback_registration;
+static btstack_event_filter_t                 hci_event_filter;
 static btstack_packet_callback_registration_t sm_event_callback_registration;
 static btstack_packet_handler_t               att_client_packet_handler = NULL;
 static btstack_linked_list_t                  service_handlers;
@@ -1100,7 +1101,13 @@ void att_server_init(uint8_t const * db, att_read_callback_t read_callback, att_
     att_server_client_write_callback = write_callback;
 
     // register for HCI Events
+    btstack_event_filter_init(&hci_event_filter);
+    btstack_event_filter_add_event(&hci_event_filter, HCI_EVENT_ENCRYPTION_CHANGE);
+    btstack_event_filter_add_event(&hci_event_filter, HCI_EVENT_ENCRYPTION_KEY_REFRESH_COMPLETE);
+    btstack_event_filter_add_event(&hci_event_filter, HCI_EVENT_DISCONNECTION_COMPLETE);
+    btstack_event_filter_add_le_subevent(&hci_event_filter, HCI_SUBEVENT_LE_CONNECTION_COMPLETE);
     hci_event_callback_registration.callback = &att_event_packet_handler;
+    hci_event_callback_registration.event_filter = &hci_event_filter;
     hci_add_event_handler(&hci_event_callback_registration);
 
     // register for SM events
@@ -63,6 +63,7 @@
 static btstack_linked_list_t gatt_client_connections;
 static btstack_linked_list_t gatt_client_value_listeners;
 static btstack_packet_callback_registration_t hci_event_callback_registration;
+static btstack_event_filter_t                 hci_event_filter;
 
 #if defined(ENABLE_GATT_CLIENT_PAIRING) || defined (ENABLE_LE_SIGNED_WRITE)
 static btstack_packet_callback_registration_t sm_event_callback_registration;
@@ -73,11 +74,26 @@ static uint8_t mtu_exchange_enabled;
 static void gatt_client_att_packet_handler(uint8_t packet_type, uint16_t handle, uint8_t *packet, uint16_t size);
 static void gatt_client_event_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size);
 static void gatt_client_report_error_if_pending(gatt_client_t *peripheral, uint8_t att_error_code);
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+static void gatt_client_le_throughput_optimizer_exchange_mtu(hci_con_handle_t con_handle, uint16_t max_tx_octets);
+#endif
 
 #ifdef ENABLE_LE_SIGNED_WRITE
 static void att_signed_write_handle_cmac_result(uint8_t hash[8]);
 #endif
 
+// MTU offered in MTU Exchange Request
+static uint16_t gatt_client_local_rx_mtu(gatt_client_t * peripheral){
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+    if (peripheral->le_throughput_optimizer_mtu != 0u){
+        return peripheral->le_throughput_optimizer_mtu;
+    }
+#else
+    UNUSED(peripheral);
+#endif
+    return l2cap_max_le_mtu();
+}
+
 static uint16_t peripheral_mtu(gatt_client_t *peripheral){
     if (peripheral->mtu > l2cap_max_le_mtu()){
         log_error("Peripheral mtu is not initialized");
@@ -90,8 +106,15 @@ void gatt_client_init(void){
     gatt_client_connections = NULL;
     mtu_exchange_enabled = 1;
 
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+    hci_le_throughput_optimizer_register_mtu_exchange_handler(&gatt_client_le_throughput_optimizer_exchange_mtu);
+#endif
+
     // regsister for HCI Events
+    // any event may allow gatt_client_run to continue, e.g. after re-encryption, but scan results never do
+    btstack_event_filter_init_without_scan_results(&hci_event_filter);
     hci_event_callback_registration.callback = &gatt_client_event_packet_handler;
+    hci_event_callback_registration.event_filter = &hci_event_filter;
     hci_add_event_handler(&hci_event_callback_registration);
 
 #if defined(ENABLE_GATT_CLIENT_PAIRING) || defined (ENABLE_LE_SIGNED_WRITE)
@@ -348,8 +371,7 @@ static uint8_t att_prepare_write_request(uint16_t request_type, uint16_t periphe
     return l2cap_send_prepared_connectionless(peripheral_handle, L2CAP_CID_ATTRIBUTE_PROTOCOL, 5+blob_length);
 }
 
-static uint8_t att_exchange_mtu_request(uint16_t peripheral_handle){
-    uint16_t mtu = l2cap_max_le_mtu();
+static uint8_t att_exchange_mtu_request(uint16_t peripheral_handle, uint16_t mtu){
     l2cap_reserve_packet_buffer();
     uint8_t * request = l2cap_get_outgoing_buffer();
     request[0] = ATT_EXCHANGE_MTU_REQUEST;
@@ -591,6 +613,17 @@ static void emit_gatt_mtu_exchanged_result_event(gatt_client_t * peripheral, uin
     att_dispatch_client_mtu_exchanged(peripheral->con_handle, new_mtu);
     emit_event_new(peripheral->callback, packet, sizeof(packet));
 }
+
+static void gatt_client_handle_mtu_exchange_complete(gatt_client_t * peripheral){
+    peripheral->mtu_state = MTU_EXCHANGED;
+    emit_gatt_mtu_exchanged_result_event(peripheral, peripheral->mtu);
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+    if (peripheral->le_throughput_optimizer_pending){
+        peripheral->le_throughput_optimizer_pending = 0;
+        hci_le_throughput_optimizer_mtu_exchanged(peripheral->con_handle, peripheral->mtu);
+    }
+#endif
+}
 ///
 static void report_gatt_services(gatt_client_t * peripheral, uint8_t * packet,  uint16_t size){
     uint8_t attr_length = packet[1];
@@ -866,7 +899,7 @@ static int gatt_client_run_for_peripheral( gatt_client_t * peripheral){
     switch (peripheral->mtu_state) {
         case SEND_MTU_EXCHANGE:
             peripheral->mtu_state = SENT_MTU_EXCHANGE;
-            att_exchange_mtu_request(peripheral->con_handle);
+            att_exchange_mtu_request(peripheral->con_handle, gatt_client_local_rx_mtu(peripheral));
             return 1;
         case SENT_MTU_EXCHANGE:
             return 0;
@@ -1214,10 +1247,9 @@ static void gatt_client_att_packet_handler(uint8_t packet_type, uint16_t handle,
         {
             if (size < 3) break;
             uint16_t remote_rx_mtu = little_endian_read_16(packet, 1);
-            uint16_t local_rx_mtu = l2cap_max_le_mtu();
+            uint16_t local_rx_mtu = gatt_client_local_rx_mtu(peripheral);
             peripheral->mtu = (remote_rx_mtu < local_rx_mtu) ? remote_rx_mtu : local_rx_mtu;
-            peripheral->mtu_state = MTU_EXCHANGED;
-            emit_gatt_mtu_exchanged_result_event(peripheral, peripheral->mtu);
+            gatt_client_handle_mtu_exchange_complete(peripheral);
             break;
         }
         case ATT_READ_BY_GROUP_TYPE_RESPONSE:
@@ -1505,6 +1537,12 @@ static void gatt_client_att_packet_handler(uint8_t packet_type, uint16_t handle,
 
         case ATT_ERROR_RESPONSE:
             if (size < 5) return;
+            if ((peripheral->mtu_state == SENT_MTU_EXCHANGE) && (packet[1] == ATT_EXCHANGE_MTU_REQUEST)){
+                // MTU Exchange rejected, keep default MTU
+                peripheral->mtu = ATT_DEFAULT_MTU;
+                gatt_client_handle_mtu_exchange_complete(peripheral);
+                break;
+            }
             switch (packet[4]){
                 case ATT_ERROR_ATTRIBUTE_NOT_FOUND: {
                     switch(peripheral->gatt_client_state){
@@ -2144,6 +2182,48 @@ void gatt_client_deserialize_characteristic_descriptor(const uint8_t * packet, i
     }
 }
 
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+// largest MTU where ATT PDU and L2CAP header fill complete LL PDUs
+static uint16_t gatt_client_mtu_for_max_tx_octets(uint16_t max_tx_octets){
+    uint16_t max_mtu = l2cap_max_le_mtu();
+    uint16_t mtu = max_tx_octets - L2CAP_HEADER_SIZE;
+    if (mtu >= max_mtu) return max_mtu;
+    while ((mtu + max_tx_octets) <= max_mtu){
+        mtu += max_tx_octets;
+    }
+    return mtu;
+}
+
+static void gatt_client_le_throughput_optimizer_exchange_mtu(hci_con_handle_t con_handle, uint16_t max_tx_octets){
+    gatt_client_t * context = provide_context_for_conn_handle(con_handle);
+    if (context == NULL) {
+        hci_le_throughput_optimizer_mtu_exchanged(con_handle, ATT_DEFAULT_MTU);
+        return;
+    }
+    switch (context->mtu_state){
+        case SEND_MTU_EXCHANGE:
+            break;
+        case SENT_MTU_EXCHANGE:
+            // report result of ongoing MTU Exchange
+            context->le_throughput_optimizer_pending = 1;
+            return;
+        case MTU_AUTO_EXCHANGE_DISABLED:
+            // only one ATT request at a time
+            if (is_ready(context)) break;
+            hci_le_throughput_optimizer_mtu_exchanged(con_handle, context->mtu);
+            return;
+        default:
+            // MTU Exchange is only allowed once
+            hci_le_throughput_optimizer_mtu_exchanged(con_handle, context->mtu);
+            return;
+    }
+    context->le_throughput_optimizer_pending = 1;
+    context->le_throughput_optimizer_mtu = gatt_client_mtu_for_max_tx_octets(max_tx_octets);
+    context->mtu_state = SEND_MTU_EXCHANGE;
+    gatt_client_run();
+}
+#endif
+
 void gatt_client_send_mtu_negotiation(btstack_packet_handler_t callback, hci_con_handle_t con_handle){
     gatt_client_t * context = provide_context_for_conn_handle(con_handle);
     if (context == NULL) return;
@@ -154,6 +154,11 @@ typedef struct gatt_client{
 
     uint16_t          mtu;
     gatt_client_mtu_t mtu_state;
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+    // MTU Exchange requested by LE Throughput Optimizer
+    uint8_t           le_throughput_optimizer_pending;
+    uint16_t          le_throughput_optimizer_mtu;
+#endif
     
     uint16_t uuid16;
     uint8_t  uuid128[16];
@@ -47,9 +47,11 @@
 
 // LE Device DB Implementation storing entries in btstack_tlv
 
-// Local cache is used to keep track of deleted entries in TLV
+// A RAM index with sequence number, address and IRK of all stored entries is kept to avoid TLV reads
+// on lookups. Full entries are only fetched from TLV for keys and signing counters.
 
 #define INVALID_ENTRY_ADDR_TYPE 0xff
+#define INVALID_ENTRY_INDEX     0xffff
 
 // Single stored entry
 typedef struct le_device_db_entry_t {
@@ -84,6 +86,15 @@ typedef struct le_device_db_entry_t {
 
 } le_device_db_entry_t;
 
+// Index entry, addr_type is INVALID_ENTRY_ADDR_TYPE for unused entries
+typedef struct {
+    uint32_t  seq_nr;
+    uint16_t  hash_next;    // next entry in address hash bucket
+    uint8_t   addr_type;
+    bd_addr_t addr;
+    sm_key_t  irk;
+} le_device_db_index_entry_t;
+
 
 #ifndef NVM_NUM_DEVICE_DB_ENTRIES 
 #error "NVM_NUM_DEVICE_DB_ENTRIES not defined, please define in btstack_config.h"
@@ -93,8 +104,14 @@ typedef struct le_device_db_entry_t {
 #error "NVM_NUM_DEVICE_DB_ENTRIES must not be 0, please update in btstack_config.h"
 #endif
 
-// only stores if entry present
-static uint8_t  entry_map[NVM_NUM_DEVICE_DB_ENTRIES];
+// entry index is stored in lowest byte of TLV tag
+#if NVM_NUM_DEVICE_DB_ENTRIES > 256
+#error "NVM_NUM_DEVICE_DB_ENTRIES must not be larger than 256, please update in btstack_config.h"
+#endif
+
+static le_device_db_index_entry_t le_device_db_index[NVM_NUM_DEVICE_DB_ENTRIES];
+static uint16_t le_device_db_hash_buckets[NVM_NUM_DEVICE_DB_ENTRIES];
+static uint32_t le_device_db_highest_seq_nr;
 static uint32_t num_valid_entries;
 
 static const btstack_tlv_t * le_device_db_tlv_btstack_tlv_impl;
@@ -111,7 +128,7 @@ static uint32_t le_device_db_tlv_tag_for_index(uint8_t index){
 
 // @returns success
 // @param index = entry_pos
-static bool le_device_db_tlv_fetch(int index, le_device_db_entry_t * entry){
+static bool le_device_db_tlv_read(int index, le_device_db_entry_t * entry){
     btstack_assert(le_device_db_tlv_btstack_tlv_impl != NULL);
     btstack_assert(index >= 0);
     btstack_assert(index < NVM_NUM_DEVICE_DB_ENTRIES);
@@ -144,17 +161,86 @@ static bool le_device_db_tlv_delete(int index){
 	return true;
 }
 
+static bool le_device_db_index_valid(int index){
+    if (index < 0) return false;
+    if (index >= NVM_NUM_DEVICE_DB_ENTRIES) return false;
+    return le_device_db_index[index].addr_type != INVALID_ENTRY_ADDR_TYPE;
+}
+
+// @returns success, skips TLV access for unused entries
+// @param index = entry_pos
+static bool le_device_db_tlv_fetch(int index, le_device_db_entry_t * entry){
+    if (!le_device_db_index_valid(index)) return false;
+    return le_device_db_tlv_read(index, entry);
+}
+
+static uint16_t le_device_db_hash_for_addr(int addr_type, const bd_addr_t addr){
+    uint32_t hash = (uint32_t) addr_type;
+    int i;
+    for (i=0;i<6;i++){
+        hash = (hash * 31u) + addr[i];
+    }
+    return (uint16_t) (hash % NVM_NUM_DEVICE_DB_ENTRIES);
+}
+
+static void le_device_db_index_add(int index, const le_device_db_entry_t * entry){
+    le_device_db_index_entry_t * index_entry = &le_device_db_index[index];
+    index_entry->seq_nr    = entry->seq_nr;
+    index_entry->addr_type = (uint8_t) entry->addr_type;
+    (void)memcpy(index_entry->addr, entry->addr, 6);
+    (void)memcpy(index_entry->irk, entry->irk, 16);
+    // prepend to hash bucket
+    uint16_t bucket = le_device_db_hash_for_addr(entry->addr_type, entry->addr);
+    index_entry->hash_next = le_device_db_hash_buckets[bucket];
+    le_device_db_hash_buckets[bucket] = (uint16_t) index;
+    if (entry->seq_nr > le_device_db_highest_seq_nr){
+        le_device_db_highest_seq_nr = entry->seq_nr;
+    }
+    num_valid_entries++;
+}
+
+static void le_device_db_index_remove(int index){
+    le_device_db_index_entry_t * index_entry = &le_device_db_index[index];
+    // unlink from hash bucket
+    uint16_t * link = &le_device_db_hash_buckets[le_device_db_hash_for_addr(index_entry->addr_type, index_entry->addr)];
+    while (*link != INVALID_ENTRY_INDEX){
+        if (*link == index){
+            *link = index_entry->hash_next;
+            break;
+        }
+        link = &le_device_db_index[*link].hash_next;
+    }
+    index_entry->addr_type = INVALID_ENTRY_ADDR_TYPE;
+    num_valid_entries--;
+}
+
+// @returns index for addr_type, addr or -1
+static int le_device_db_index_lookup(int addr_type, const bd_addr_t addr){
+    uint16_t index = le_device_db_hash_buckets[le_device_db_hash_for_addr(addr_type, addr)];
+    while (index != INVALID_ENTRY_INDEX){
+        const le_device_db_index_entry_t * index_entry = &le_device_db_index[index];
+        if ((index_entry->addr_type == addr_type) && (memcmp(index_entry->addr, addr, 6) == 0)){
+            return index;
+        }
+        index = index_entry->hash_next;
+    }
+    return -1;
+}
+
 static void le_device_db_tlv_scan(void){
     int i;
     num_valid_entries = 0;
-    memset(entry_map, 0, sizeof(entry_map));
+    le_device_db_highest_seq_nr = 0;
+    for (i=0;i<NVM_NUM_DEVICE_DB_ENTRIES;i++){
+        le_device_db_index[i].addr_type = INVALID_ENTRY_ADDR_TYPE;
+        le_device_db_hash_buckets[i] = INVALID_ENTRY_INDEX;
+    }
     for (i=0;i<NVM_NUM_DEVICE_DB_ENTRIES;i++){
         // lookup entry
         le_device_db_entry_t entry;
-        if (!le_device_db_tlv_fetch(i, &entry)) continue;
+        if (!le_device_db_tlv_read(i, &entry)) continue;
 
-        entry_map[i] = 1;
-        num_valid_entries++;
+        le_device_db_index_add(i, &entry);
     }
     log_info("num valid le device entries %u", num_valid_entries);
 }
@@ -181,64 +267,35 @@ int le_device_db_max_count(void){
 
 void le_device_db_remove(int index){
     // check if entry exists
-    if (entry_map[index] == 0) return; 
+    if (!le_device_db_index_valid(index)) return;
 
 	// delete entry in TLV
 	le_device_db_tlv_delete(index);
 
-	// mark as unused
-    entry_map[index] = 0;
-
-    // keep track
-    num_valid_entries--;
+	// mark as unused and keep track
+    le_device_db_index_remove(index);
 }
 
 int le_device_db_add(int addr_type, bd_addr_t addr, sm_key_t irk){
 
-    uint32_t highest_seq_nr = 0;
-    uint32_t lowest_seq_nr  = 0xFFFFFFFF;
-    int index_for_lowest_seq_nr = -1;
-    int index_for_addr  = -1;
-    int index_for_empty = -1;
+    int index_to_use = le_device_db_index_lookup(addr_type, addr);
 
-	// find unused entry in the used list
-    int i;
-    for (i=0;i<NVM_NUM_DEVICE_DB_ENTRIES;i++){
-         if (entry_map[i]) {
-            le_device_db_entry_t entry;
-            le_device_db_tlv_fetch(i, &entry);
-            // found addr?
-            if ((memcmp(addr, entry.addr, 6) == 0) && (addr_type == entry.addr_type)){
-                index_for_addr = i;
+    // find empty entry or entry with lowest seq nr
+    if (index_to_use < 0){
+        uint32_t lowest_seq_nr = 0xFFFFFFFF;
+        int i;
+        for (i=0;i<NVM_NUM_DEVICE_DB_ENTRIES;i++){
+            if (le_device_db_index[i].addr_type == INVALID_ENTRY_ADDR_TYPE){
+                index_to_use = i;
+                break;
             }
-            // update highest seq nr
-            if (entry.seq_nr > highest_seq_nr){
-                highest_seq_nr = entry.seq_nr;
+            if ((index_to_use < 0) || (le_device_db_index[i].seq_nr < lowest_seq_nr)){
+                index_to_use = i;
+                lowest_seq_nr = le_device_db_index[i].seq_nr;
             }
-            // find entry with lowest seq nr
-            if ((index_for_lowest_seq_nr == -1) || (entry.seq_nr < lowest_seq_nr)){
-                index_for_lowest_seq_nr = i;
-                lowest_seq_nr = entry.seq_nr;
-            }
-        } else {
-            index_for_empty = i;
         }
     }
 
-    log_info("index_for_addr %x, index_for_empy %x, index_for_lowest_seq_nr %x", index_for_addr, index_for_empty, index_for_lowest_seq_nr);
-
-    uint32_t index_to_use = 0;
-    if (index_for_addr >= 0){
-        index_to_use = index_for_addr;
-    } else if (index_for_empty >= 0){
-        index_to_use = index_for_empty;
-    } else if (index_for_lowest_seq_nr >= 0){
-        index_to_use = index_for_lowest_seq_nr;
-    } else {
-        // should not happen
-        return -1;
-    }
-
     log_info("new entry for index %u", index_to_use);
 
     // store entry at index
@@ -251,7 +308,7 @@ int le_device_db_add(int addr_type, bd_addr_t addr, sm_key_t irk){
     entry.addr_type = addr_type;
     (void)memcpy(entry.addr, addr, 6);
     (void)memcpy(entry.irk, irk, 16);
-    entry.seq_nr = highest_seq_nr + 1;
+    entry.seq_nr = le_device_db_highest_seq_nr + 1;
  #ifdef ENABLE_LE_SIGNED_WRITE
     entry.remote_counter = 0; 
 #endif
@@ -262,13 +319,12 @@ int le_device_db_add(int addr_type, bd_addr_t addr, sm_key_t irk){
         log_error("tag store failed");
         return -1;
     }
-    // set in entry_mape
-    entry_map[index_to_use] = 1;
 
-    // keep track - don't increase if old entry found
-    if (index_for_addr < 0){
-        num_valid_entries++;
+    // replace old entry (same address or evicted) in index
+    if (le_device_db_index_valid(index_to_use)){
+        le_device_db_index_remove(index_to_use);
     }
+    le_device_db_index_add(index_to_use, &entry);
 
     return index_to_use;
 }
@@ -277,20 +333,19 @@ int le_device_db_add(int addr_type, bd_addr_t addr, sm_key_t irk){
 // get device information: addr type and address
 void le_device_db_info(int index, int * addr_type, bd_addr_t addr, sm_key_t irk){
 
-	// fetch entry
-    le_device_db_entry_t entry;
-    int ok = le_device_db_tlv_fetch(index, &entry);
-
     // set defaults if not found
-    if (!ok) {
-        memset(&entry, 0, sizeof(le_device_db_entry_t));
-        entry.addr_type = BD_ADDR_TYPE_UNKNOWN;
+    if (!le_device_db_index_valid(index)) {
+        if (addr_type) *addr_type = BD_ADDR_TYPE_UNKNOWN;
+        if (addr) memset(addr, 0, 6);
+        if (irk) memset(irk, 0, 16);
+        return;
     }
 
-    // setup return values
-    if (addr_type) *addr_type = entry.addr_type;
-    if (addr) (void)memcpy(addr, entry.addr, 6);
-    if (irk) (void)memcpy(irk, entry.irk, 16);
+    // setup return values from index
+    const le_device_db_index_entry_t * index_entry = &le_device_db_index[index];
+    if (addr_type) *addr_type = index_entry->addr_type;
+    if (addr) (void)memcpy(addr, index_entry->addr, 6);
+    if (irk) (void)memcpy(irk, index_entry->irk, 16);
 }
 
 void le_device_db_encryption_set(int index, uint16_t ediv, uint8_t rand[8], sm_key_t ltk, int key_size, int authenticated, int authorized, int secure_connection){
@@ -453,7 +508,7 @@ void le_device_db_dump(void){
     uint32_t i;
 
     for (i=0;i<NVM_NUM_DEVICE_DB_ENTRIES;i++){
-        if (!entry_map[i]) continue;
+        if (!le_device_db_index_valid(i)) continue;
 		// fetch entry
 		le_device_db_entry_t entry;
 		le_device_db_tlv_fetch(i, &entry);
@@ -269,6 +269,7 @@ static uint8_t sm_aes128_ciphertext[16];
 
 // to receive hci events
 static btstack_packet_callback_registration_t hci_event_callback_registration;
+static btstack_event_filter_t                 hci_event_filter;
 
 /* to dispatch sm event */
 static btstack_linked_list_t sm_event_handlers;
@@ -4096,7 +4097,10 @@ void sm_init(void){
     test_use_fixed_local_csrk = false;
 
     // register for HCI Events from HCI
+    // SM handles connection, LTK request, encryption and command complete events, skip Advertising Reports
+    btstack_event_filter_init_without_scan_results(&hci_event_filter);
     hci_event_callback_registration.callback = &sm_event_packet_handler;
+    hci_event_callback_registration.event_filter = &hci_event_filter;
     hci_add_event_handler(&hci_event_callback_registration);
 
     // 
@@ -123,6 +123,7 @@
 #include "classic/hsp_ag.h"
 #include "classic/hsp_hs.h"
 #include "classic/pan.h"
+#include "classic/pan_bridge.h"
 #include "classic/rfcomm.h"
 #include "classic/sdp_client.h"
 #include "classic/sdp_client_rfcomm.h"
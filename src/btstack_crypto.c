@@ -130,6 +130,7 @@ static const uint8_t zero[16] = { 0 };
 static uint8_t btstack_crypto_initialized;
 static btstack_linked_list_t btstack_crypto_operations;
 static btstack_packet_callback_registration_t hci_event_callback_registration;
+static btstack_event_filter_t                 hci_event_filter;
 static uint8_t btstack_crypto_wait_for_hci_result;
 
 // state for AES-CMAC
@@ -1140,8 +1141,16 @@ void btstack_crypto_init(void){
 	if (btstack_crypto_initialized) return;
 	btstack_crypto_initialized = 1;
 
-	// register with HCI
+	// register with HCI for events that report results or allow to send the next command
+    btstack_event_filter_init(&hci_event_filter);
+    btstack_event_filter_add_event(&hci_event_filter, BTSTACK_EVENT_STATE);
+    btstack_event_filter_add_event(&hci_event_filter, HCI_EVENT_COMMAND_COMPLETE);
+    btstack_event_filter_add_event(&hci_event_filter, HCI_EVENT_COMMAND_STATUS);
+    btstack_event_filter_add_event(&hci_event_filter, HCI_EVENT_TRANSPORT_PACKET_SENT);
+    btstack_event_filter_add_le_subevent(&hci_event_filter, HCI_SUBEVENT_LE_READ_LOCAL_P256_PUBLIC_KEY_COMPLETE);
+    btstack_event_filter_add_le_subevent(&hci_event_filter, HCI_SUBEVENT_LE_GENERATE_DHKEY_COMPLETE);
     hci_event_callback_registration.callback = &btstack_crypto_event_handler;
+    hci_event_callback_registration.event_filter = &hci_event_filter;
     hci_add_event_handler(&hci_event_callback_registration);
 
 #ifdef USE_MBEDTLS_ECC_P256
@@ -57,10 +57,20 @@
 // packet handler
 typedef void (*btstack_packet_handler_t) (uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size);
 
+// event filter for packet callback registrations, see btstack_event_filter_* in btstack_util.h
+typedef struct {
+    // bit set for each HCI/BTstack event type to deliver, HCI_EVENT_LE_META delivers all LE subevents
+    uint8_t event_mask[32];
+    // bit set for each HCI LE Meta subevent to deliver
+    uint8_t le_subevent_mask[32];
+} btstack_event_filter_t;
+
 // packet callback supporting multiple registrations
 typedef struct {
     btstack_linked_item_t    item;
     btstack_packet_handler_t callback;
+    // only used by hci_add_event_handler: events to deliver, NULL for all events
+    const btstack_event_filter_t * event_filter;
 } btstack_packet_callback_registration_t;
 
 // context callback supporting multiple registrations
@@ -70,6 +80,12 @@ typedef struct {
   void * context;
 } btstack_context_callback_registration_t;
 
+// scatter-gather element for send functions that combine several buffers into one packet
+typedef struct {
+    const uint8_t * data;
+    uint16_t        len;
+} btstack_iovec_t;
+
 /**
  * @brief 128 bit key used with AES128 in Security Manager
  */
@@ -629,6 +645,16 @@ typedef uint8_t sm_key_t[16];
 // array of advertisements, not handled by event accessor generator
 #define HCI_SUBEVENT_LE_DIRECT_ADVERTISING_REPORT          0x0B
 
+/**
+ * @format 11H11
+ * @param subevent_code
+ * @param status
+ * @param connection_handle
+ * @param tx_phy
+ * @param rx_phy
+ */
+#define HCI_SUBEVENT_LE_PHY_UPDATE_COMPLETE                0x0C
+
 
 /**
  * @format 1
@@ -751,6 +777,17 @@ typedef uint8_t sm_key_t[16];
  */
 #define HCI_EVENT_SCO_CAN_SEND_NOW                         0x6F
 
+/**
+ * @brief SCO statistics of HCI transport for last interval, currently reported every second by H2 libusb transport
+ * @format 44244
+ * @param rx_packets
+ * @param rx_errors
+ * @param rx_jitter_max_ms
+ * @param tx_packets
+ * @param tx_underruns
+ */
+#define HCI_EVENT_TRANSPORT_SCO_STATISTICS                 0x6A
+
 
 // L2CAP EVENTS
     
@@ -929,6 +966,21 @@ typedef uint8_t sm_key_t[16];
  */
 #define RFCOMM_EVENT_CAN_SEND_NOW                          0x89
 
+/**
+ * @format 2444444124
+ * @param rfcomm_cid
+ * @param tx_stalls
+ * @param tx_stall_time_ms
+ * @param rx_stalls
+ * @param rx_stall_time_ms
+ * @param credits_granted
+ * @param rx_bytes_per_second
+ * @param credits_target
+ * @param rtt_ms
+ * @param rx_frames
+ */
+#define RFCOMM_EVENT_CHANNEL_STATISTICS                    0x8A
+
 
 /**
  * @format 1
@@ -1364,6 +1416,30 @@ typedef uint8_t sm_key_t[16];
  */
 #define GAP_EVENT_RSSI_MEASUREMENT                            0xE5
 
+/**
+ * @format 1JV
+ * @param num_reports
+ * @param reports_length
+ * @param reports
+ * @note each report has the layout of GAP_EVENT_ADVERTISING_REPORT without event type and length, see gap_advertising_report_iterator_init
+ * @note reports take 10 + data_length bytes and an event holds up to 253 bytes of reports,
+ *       i.e. 6 reports with 31 bytes of advertising data; shorter reports allow more per batch
+ */
+#define GAP_EVENT_ADVERTISING_REPORT_BATCH                    0xE6
+
+/**
+ * @format H2222112
+ * @param con_handle
+ * @param max_tx_octets
+ * @param max_tx_time
+ * @param max_rx_octets
+ * @param max_rx_time
+ * @param tx_phy 1 = 1M, 2 = 2M, 3 = Coded
+ * @param rx_phy 1 = 1M, 2 = 2M, 3 = Coded
+ * @param att_mtu
+ */
+#define GAP_EVENT_LE_THROUGHPUT_OPTIMIZATION_COMPLETE         0xE7
+
 // Meta Events, see below for sub events
 #define HCI_EVENT_HSP_META                                 0xE8
 #define HCI_EVENT_HFP_META                                 0xE9
@@ -1099,6 +1099,52 @@ static inline void hci_event_sco_can_send_now_get_handle(const uint8_t * event,
     reverse_bytes(&event[2], handle, 6);
 }
 
+/**
+ * @brief Get field rx_packets from event HCI_EVENT_TRANSPORT_SCO_STATISTICS
+ * @param event packet
+ * @return rx_packets
+ * @note: btstack_type 4
+ */
+static inline uint32_t hci_event_transport_sco_statistics_get_rx_packets(const uint8_t * event){
+    return little_endian_read_32(event, 2);
+}
+/**
+ * @brief Get field rx_errors from event HCI_EVENT_TRANSPORT_SCO_STATISTICS
+ * @param event packet
+ * @return rx_errors
+ * @note: btstack_type 4
+ */
+static inline uint32_t hci_event_transport_sco_statistics_get_rx_errors(const uint8_t * event){
+    return little_endian_read_32(event, 6);
+}
+/**
+ * @brief Get field rx_jitter_max_ms from event HCI_EVENT_TRANSPORT_SCO_STATISTICS
+ * @param event packet
+ * @return rx_jitter_max_ms
+ * @note: btstack_type 2
+ */
+static inline uint16_t hci_event_transport_sco_statistics_get_rx_jitter_max_ms(const uint8_t * event){
+    return little_endian_read_16(event, 10);
+}
+/**
+ * @brief Get field tx_packets from event HCI_EVENT_TRANSPORT_SCO_STATISTICS
+ * @param event packet
+ * @return tx_packets
+ * @note: btstack_type 4
+ */
+static inline uint32_t hci_event_transport_sco_statistics_get_tx_packets(const uint8_t * event){
+    return little_endian_read_32(event, 12);
+}
+/**
+ * @brief Get field tx_underruns from event HCI_EVENT_TRANSPORT_SCO_STATISTICS
+ * @param event packet
+ * @return tx_underruns
+ * @note: btstack_type 4
+ */
+static inline uint32_t hci_event_transport_sco_statistics_get_tx_underruns(const uint8_t * event){
+    return little_endian_read_32(event, 16);
+}
+
 /**
  * @brief Get field status from event L2CAP_EVENT_CHANNEL_OPENED
  * @param event packet
@@ -1685,6 +1731,97 @@ static inline uint16_t rfcomm_event_can_send_now_get_rfcomm_cid(const uint8_t *
     return little_endian_read_16(event, 2);
 }
 
+/**
+ * @brief Get field rfcomm_cid from event RFCOMM_EVENT_CHANNEL_STATISTICS
+ * @param event packet
+ * @return rfcomm_cid
+ * @note: btstack_type 2
+ */
+static inline uint16_t rfcomm_event_channel_statistics_get_rfcomm_cid(const uint8_t * event){
+    return little_endian_read_16(event, 2);
+}
+/**
+ * @brief Get field tx_stalls from event RFCOMM_EVENT_CHANNEL_STATISTICS
+ * @param event packet
+ * @return tx_stalls
+ * @note: btstack_type 4
+ */
+static inline uint32_t rfcomm_event_channel_statistics_get_tx_stalls(const uint8_t * event){
+    return little_endian_read_32(event, 4);
+}
+/**
+ * @brief Get field tx_stall_time_ms from event RFCOMM_EVENT_CHANNEL_STATISTICS
+ * @param event packet
+ * @return tx_stall_time_ms
+ * @note: btstack_type 4
+ */
+static inline uint32_t rfcomm_event_channel_statistics_get_tx_stall_time_ms(const uint8_t * event){
+    return little_endian_read_32(event, 8);
+}
+/**
+ * @brief Get field rx_stalls from event RFCOMM_EVENT_CHANNEL_STATISTICS
+ * @param event packet
+ * @return rx_stalls
+ * @note: btstack_type 4
+ */
+static inline uint32_t rfcomm_event_channel_statistics_get_rx_stalls(const uint8_t * event){
+    return little_endian_read_32(event, 12);
+}
+/**
+ * @brief Get field rx_stall_time_ms from event RFCOMM_EVENT_CHANNEL_STATISTICS
+ * @param event packet
+ * @return rx_stall_time_ms
+ * @note: btstack_type 4
+ */
+static inline uint32_t rfcomm_event_channel_statistics_get_rx_stall_time_ms(const uint8_t * event){
+    return little_endian_read_32(event, 16);
+}
+/**
+ * @brief Get field credits_granted from event RFCOMM_EVENT_CHANNEL_STATISTICS
+ * @param event packet
+ * @return credits_granted
+ * @note: btstack_type 4
+ */
+static inline uint32_t rfcomm_event_channel_statistics_get_credits_granted(const uint8_t * event){
+    return little_endian_read_32(event, 20);
+}
+/**
+ * @brief Get field rx_bytes_per_second from event RFCOMM_EVENT_CHANNEL_STATISTICS
+ * @param event packet
+ * @return rx_bytes_per_second
+ * @note: btstack_type 4
+ */
+static inline uint32_t rfcomm_event_channel_statistics_get_rx_bytes_per_second(const uint8_t * event){
+    return little_endian_read_32(event, 24);
+}
+/**
+ * @brief Get field credits_target from event RFCOMM_EVENT_CHANNEL_STATISTICS
+ * @param event packet
+ * @return credits_target
+ * @note: btstack_type 1
+ */
+static inline uint8_t rfcomm_event_channel_statistics_get_credits_target(const uint8_t * event){
+    return event[28];
+}
+/**
+ * @brief Get field rtt_ms from event RFCOMM_EVENT_CHANNEL_STATISTICS
+ * @param event packet
+ * @return rtt_ms
+ * @note: btstack_type 2
+ */
+static inline uint16_t rfcomm_event_channel_statistics_get_rtt_ms(const uint8_t * event){
+    return little_endian_read_16(event, 29);
+}
+/**
+ * @brief Get field rx_frames from event RFCOMM_EVENT_CHANNEL_STATISTICS
+ * @param event packet
+ * @return rx_frames
+ * @note: btstack_type 4
+ */
+static inline uint32_t rfcomm_event_channel_statistics_get_rx_frames(const uint8_t * event){
+    return little_endian_read_32(event, 31);
+}
+
 /**
  * @brief Get field status from event SDP_EVENT_QUERY_COMPLETE
  * @param event packet
@@ -3278,6 +3415,107 @@ static inline uint8_t gap_event_rssi_measurement_get_rssi(const uint8_t * event)
     return event[4];
 }
 
+/**
+ * @brief Get field num_reports from event GAP_EVENT_ADVERTISING_REPORT_BATCH
+ * @param event packet
+ * @return num_reports
+ * @note: btstack_type 1
+ */
+static inline uint8_t gap_event_advertising_report_batch_get_num_reports(const uint8_t * event){
+    return event[2];
+}
+/**
+ * @brief Get field reports_length from event GAP_EVENT_ADVERTISING_REPORT_BATCH
+ * @param event packet
+ * @return reports_length
+ * @note: btstack_type J
+ */
+static inline uint8_t gap_event_advertising_report_batch_get_reports_length(const uint8_t * event){
+    return event[3];
+}
+/**
+ * @brief Get field reports from event GAP_EVENT_ADVERTISING_REPORT_BATCH
+ * @param event packet
+ * @return reports
+ * @note: btstack_type V
+ */
+static inline const uint8_t * gap_event_advertising_report_batch_get_reports(const uint8_t * event){
+    return &event[4];
+}
+
+/**
+ * @brief Get field con_handle from event GAP_EVENT_LE_THROUGHPUT_OPTIMIZATION_COMPLETE
+ * @param event packet
+ * @return con_handle
+ * @note: btstack_type H
+ */
+static inline hci_con_handle_t gap_event_le_throughput_optimization_complete_get_con_handle(const uint8_t * event){
+    return little_endian_read_16(event, 2);
+}
+/**
+ * @brief Get field max_tx_octets from event GAP_EVENT_LE_THROUGHPUT_OPTIMIZATION_COMPLETE
+ * @param event packet
+ * @return max_tx_octets
+ * @note: btstack_type 2
+ */
+static inline uint16_t gap_event_le_throughput_optimization_complete_get_max_tx_octets(const uint8_t * event){
+    return little_endian_read_16(event, 4);
+}
+/**
+ * @brief Get field max_tx_time from event GAP_EVENT_LE_THROUGHPUT_OPTIMIZATION_COMPLETE
+ * @param event packet
+ * @return max_tx_time
+ * @note: btstack_type 2
+ */
+static inline uint16_t gap_event_le_throughput_optimization_complete_get_max_tx_time(const uint8_t * event){
+    return little_endian_read_16(event, 6);
+}
+/**
+ * @brief Get field max_rx_octets from event GAP_EVENT_LE_THROUGHPUT_OPTIMIZATION_COMPLETE
+ * @param event packet
+ * @return max_rx_octets
+ * @note: btstack_type 2
+ */
+static inline uint16_t gap_event_le_throughput_optimization_complete_get_max_rx_octets(const uint8_t * event){
+    return little_endian_read_16(event, 8);
+}
+/**
+ * @brief Get field max_rx_time from event GAP_EVENT_LE_THROUGHPUT_OPTIMIZATION_COMPLETE
+ * @param event packet
+ * @return max_rx_time
+ * @note: btstack_type 2
+ */
+static inline uint16_t gap_event_le_throughput_optimization_complete_get_max_rx_time(const uint8_t * event){
+    return little_endian_read_16(event, 10);
+}
+/**
+ * @brief Get field tx_phy from event GAP_EVENT_LE_THROUGHPUT_OPTIMIZATION_COMPLETE
+ * @param event packet
+ * @return tx_phy
+ * @note: btstack_type 1
+ */
+static inline uint8_t gap_event_le_throughput_optimization_complete_get_tx_phy(const uint8_t * event){
+    return event[12];
+}
+/**
+ * @brief Get field rx_phy from event GAP_EVENT_LE_THROUGHPUT_OPTIMIZATION_COMPLETE
+ * @param event packet
+ * @return rx_phy
+ * @note: btstack_type 1
+ */
+static inline uint8_t gap_event_le_throughput_optimization_complete_get_rx_phy(const uint8_t * event){
+    return event[13];
+}
+/**
+ * @brief Get field att_mtu from event GAP_EVENT_LE_THROUGHPUT_OPTIMIZATION_COMPLETE
+ * @param event packet
+ * @return att_mtu
+ * @note: btstack_type 2
+ */
+static inline uint16_t gap_event_le_throughput_optimization_complete_get_att_mtu(const uint8_t * event){
+    return little_endian_read_16(event, 14);
+}
+
 /**
  * @brief Get field status from event HCI_SUBEVENT_LE_CONNECTION_COMPLETE
  * @param event packet
@@ -3701,6 +3939,43 @@ static inline uint8_t hci_subevent_le_enhanced_connection_complete_get_master_cl
     return event[32];
 }
 
+/**
+ * @brief Get field status from event HCI_SUBEVENT_LE_PHY_UPDATE_COMPLETE
+ * @param event packet
+ * @return status
+ * @note: btstack_type 1
+ */
+static inline uint8_t hci_subevent_le_phy_update_complete_get_status(const uint8_t * event){
+    return event[3];
+}
+/**
+ * @brief Get field connection_handle from event HCI_SUBEVENT_LE_PHY_UPDATE_COMPLETE
+ * @param event packet
+ * @return connection_handle
+ * @note: btstack_type H
+ */
+static inline hci_con_handle_t hci_subevent_le_phy_update_complete_get_connection_handle(const uint8_t * event){
+    return little_endian_read_16(event, 4);
+}
+/**
+ * @brief Get field tx_phy from event HCI_SUBEVENT_LE_PHY_UPDATE_COMPLETE
+ * @param event packet
+ * @return tx_phy
+ * @note: btstack_type 1
+ */
+static inline uint8_t hci_subevent_le_phy_update_complete_get_tx_phy(const uint8_t * event){
+    return event[6];
+}
+/**
+ * @brief Get field rx_phy from event HCI_SUBEVENT_LE_PHY_UPDATE_COMPLETE
+ * @param event packet
+ * @return rx_phy
+ * @note: btstack_type 1
+ */
+static inline uint8_t hci_subevent_le_phy_update_complete_get_rx_phy(const uint8_t * event){
+    return event[7];
+}
+
 /**
  * @brief Get field status from event HSP_SUBEVENT_RFCOMM_CONNECTION_COMPLETE
  * @param event packet
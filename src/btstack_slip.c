@@ -42,48 +42,104 @@
  *  SLIP encoder/decoder
  */
 
+#include <string.h>
+
 #include "btstack_slip.h"
 #include "btstack_debug.h"
+#include "btstack_util.h"
 
-typedef enum {
-	SLIP_ENCODER_DEFAULT,
-	SLIP_ENCODER_SEND_DC,
-	SLIP_ENCODER_SEND_DD
-} btstack_slip_encoder_state_t;
-
-// h5 slip state machine
-typedef enum {
-    SLIP_DECODER_UNKNOWN = 1,
-    SLIP_DECODER_ACTIVE,
-    SLIP_DECODER_X_C0,
-    SLIP_DECODER_X_DB,
-    SLIP_DECODER_COMPLETE
-} btstack_slip_decoder_state_t;
+#define SLIP_ESC     0xdb
+#define SLIP_ESC_END 0xdc
+#define SLIP_ESC_ESC 0xdd
 
+// default instances for single stream API
+static btstack_slip_encoder_t slip_encoder;
+static btstack_slip_decoder_t slip_decoder;
 
-// encoder
-static btstack_slip_encoder_state_t encoder_state;
-static const uint8_t * encoder_data;
-static uint16_t  encoder_len;
+// SCAN
 
-// decoder 
-static btstack_slip_decoder_state_t decoder_state;
-static uint8_t * decoder_buffer;
-static uint16_t  decoder_max_size;
-static uint16_t  decoder_pos;
+// true if any byte of word is zero
+static inline int btstack_slip_word_has_zero_byte(uint32_t word){
+    return ((word - 0x01010101u) & ~word & 0x80808080u) != 0u;
+}
 
+// find first SOF or ESC, checking 4 bytes at a time. Returns len if none found
+static uint16_t btstack_slip_find_special(const uint8_t * data, uint16_t len){
+    uint16_t pos = 0;
+    while ((pos + 4u) <= len){
+        uint32_t word;
+        (void)memcpy(&word, &data[pos], 4);
+        if (btstack_slip_word_has_zero_byte(word ^ 0xc0c0c0c0u)) break;
+        if (btstack_slip_word_has_zero_byte(word ^ 0xdbdbdbdbu)) break;
+        pos += 4;
+    }
+    while (pos < len){
+        uint8_t value = data[pos];
+        if ((value == BTSTACK_SLIP_SOF) || (value == SLIP_ESC)) break;
+        pos++;
+    }
+    return pos;
+}
 
 // ENCODER
 
+void btstack_slip_encoder_instance_start(btstack_slip_encoder_t * encoder, const uint8_t * data, uint16_t len){
+    encoder->state = SLIP_ENCODER_DEFAULT;
+    encoder->data  = data;
+    encoder->len   = len;
+}
+
+int btstack_slip_encoder_instance_has_data(const btstack_slip_encoder_t * encoder){
+    if (encoder->state != SLIP_ENCODER_DEFAULT) return 1;
+    return encoder->len > 0u;
+}
+
+uint16_t btstack_slip_encoder_instance_encode(btstack_slip_encoder_t * encoder, uint8_t * buffer, uint16_t size){
+    uint16_t pos = 0;
+    while (pos < size){
+        switch (encoder->state){
+            case SLIP_ENCODER_SEND_DC:
+                buffer[pos++] = SLIP_ESC_END;
+                encoder->state = SLIP_ENCODER_DEFAULT;
+                break;
+            case SLIP_ENCODER_SEND_DD:
+                buffer[pos++] = SLIP_ESC_ESC;
+                encoder->state = SLIP_ENCODER_DEFAULT;
+                break;
+            case SLIP_ENCODER_DEFAULT: {
+                if (encoder->len == 0u) return pos;
+                // copy run without special bytes
+                uint16_t run_len = btstack_slip_find_special(encoder->data, btstack_min(encoder->len, size - pos));
+                if (run_len > 0u){
+                    (void)memcpy(&buffer[pos], encoder->data, run_len);
+                    pos          += run_len;
+                    encoder->data += run_len;
+                    encoder->len  -= run_len;
+                    break;
+                }
+                // escape SOF or ESC
+                uint8_t next_byte = *encoder->data++;
+                encoder->len--;
+                buffer[pos++] = SLIP_ESC;
+                encoder->state = (next_byte == BTSTACK_SLIP_SOF) ? SLIP_ENCODER_SEND_DC : SLIP_ENCODER_SEND_DD;
+                break;
+            }
+            default:
+                log_error("btstack_slip_encoder_instance_encode invalid state %x", encoder->state);
+                encoder->state = SLIP_ENCODER_DEFAULT;
+                break;
+        }
+    }
+    return pos;
+}
+
 /**
  * @brief Initialise SLIP encoder with data
  * @param data
  * @param len
  */
 void btstack_slip_encoder_start(const uint8_t * data, uint16_t len){
-	encoder_state = SLIP_ENCODER_DEFAULT;
-	encoder_data  = data;
-	encoder_len   = len;
+    btstack_slip_encoder_instance_start(&slip_encoder, data, len);
 }
 
 /**
@@ -91,8 +147,7 @@ void btstack_slip_encoder_start(const uint8_t * data, uint16_t len){
  * @return True if data ready
  */
 int  btstack_slip_encoder_has_data(void){
-	if (encoder_state != SLIP_ENCODER_DEFAULT) return 1;
-	return encoder_len > 0;
+    return btstack_slip_encoder_instance_has_data(&slip_encoder);
 }
 
 /** 
@@ -100,47 +155,134 @@ int  btstack_slip_encoder_has_data(void){
  * @return Next bytes from encoder
  */
 uint8_t btstack_slip_encoder_get_byte(void){
-	uint8_t next_byte;
-	switch (encoder_state){
-		case SLIP_ENCODER_DEFAULT:
-			next_byte = *encoder_data++;
-			encoder_len--;
-			switch (next_byte){
-				case BTSTACK_SLIP_SOF:
-					encoder_state = SLIP_ENCODER_SEND_DC;
-					return 0xdb;
-				case 0xdb:
-					encoder_state = SLIP_ENCODER_SEND_DD;
-					return 0xdb;
-				default:
+    uint8_t next_byte;
+    switch (slip_encoder.state){
+        case SLIP_ENCODER_DEFAULT:
+            next_byte = *slip_encoder.data++;
+            slip_encoder.len--;
+            switch (next_byte){
+                case BTSTACK_SLIP_SOF:
+                    slip_encoder.state = SLIP_ENCODER_SEND_DC;
+                    return SLIP_ESC;
+                case SLIP_ESC:
+                    slip_encoder.state = SLIP_ENCODER_SEND_DD;
+                    return SLIP_ESC;
+                default:
                     break;
-			}
-			return next_byte;
-		case SLIP_ENCODER_SEND_DC:
-			encoder_state = SLIP_ENCODER_DEFAULT;
-			return 0x0dc;
-		case SLIP_ENCODER_SEND_DD:
-			encoder_state = SLIP_ENCODER_DEFAULT;
-			return 0x0dd;
+            }
+            return next_byte;
+        case SLIP_ENCODER_SEND_DC:
+            slip_encoder.state = SLIP_ENCODER_DEFAULT;
+            return SLIP_ESC_END;
+        case SLIP_ENCODER_SEND_DD:
+            slip_encoder.state = SLIP_ENCODER_DEFAULT;
+            return SLIP_ESC_ESC;
         default:
-            log_error("btstack_slip_encoder_get_byte invalid state %x", encoder_state);
+            log_error("btstack_slip_encoder_get_byte invalid state %x", slip_encoder.state);
             return 0x00;
-	}
+    }
 }
 
 // Decoder
 
-static void btstack_slip_decoder_reset(void){
-	decoder_state = SLIP_DECODER_UNKNOWN;
-	decoder_pos = 0;
+static void btstack_slip_decoder_reset(btstack_slip_decoder_t * decoder){
+    decoder->state = SLIP_DECODER_UNKNOWN;
+    decoder->pos = 0;
+}
+
+static void btstack_slip_decoder_store(btstack_slip_decoder_t * decoder, const uint8_t * data, uint16_t len){
+    if ((decoder->pos + len) > decoder->max_size){
+        log_error("btstack_slip_decoder_store: packet to long");
+        btstack_slip_decoder_reset(decoder);
+        return;
+    }
+    (void)memcpy(&decoder->buffer[decoder->pos], data, len);
+    decoder->pos += len;
 }
 
-static void btstack_slip_decoder_store_byte(uint8_t input){
-	if (decoder_pos >= decoder_max_size){
-	    log_error("btstack_slip_decoder_store_byte: packet to long");
-	    btstack_slip_decoder_reset();
-	}
-	decoder_buffer[decoder_pos++] = input;
+void btstack_slip_decoder_instance_init(btstack_slip_decoder_t * decoder, uint8_t * buffer, uint16_t max_size){
+    decoder->buffer = buffer;
+    decoder->max_size = max_size;
+    btstack_slip_decoder_reset(decoder);
+}
+
+uint16_t btstack_slip_decoder_instance_process(btstack_slip_decoder_t * decoder, const uint8_t * data, uint16_t size){
+    uint16_t pos = 0;
+    const uint8_t * sof;
+    uint16_t run_len;
+    uint8_t input;
+    while (pos < size){
+        switch (decoder->state){
+            case SLIP_DECODER_UNKNOWN:
+                sof = (const uint8_t *) memchr(&data[pos], BTSTACK_SLIP_SOF, size - pos);
+                if (sof == NULL) return size;
+                pos = (uint16_t)(sof - data) + 1u;
+                btstack_slip_decoder_reset(decoder);
+                decoder->state = SLIP_DECODER_X_C0;
+                break;
+            case SLIP_DECODER_COMPLETE:
+                log_error("btstack_slip_decoder_instance_process called in state COMPLETE");
+                btstack_slip_decoder_reset(decoder);
+                break;
+            case SLIP_DECODER_X_C0:
+                // skip repeated SOF
+                if (data[pos] == BTSTACK_SLIP_SOF){
+                    pos++;
+                    break;
+                }
+                decoder->state = SLIP_DECODER_ACTIVE;
+                break;
+            case SLIP_DECODER_X_DB:
+                input = data[pos++];
+                switch (input){
+                    case SLIP_ESC_END:
+                        input = BTSTACK_SLIP_SOF;
+                        break;
+                    case SLIP_ESC_ESC:
+                        input = SLIP_ESC;
+                        break;
+                    default:
+                        btstack_slip_decoder_reset(decoder);
+                        continue;
+                }
+                decoder->state = SLIP_DECODER_ACTIVE;
+                btstack_slip_decoder_store(decoder, &input, 1);
+                break;
+            case SLIP_DECODER_ACTIVE:
+                // copy run without special bytes
+                run_len = btstack_slip_find_special(&data[pos], size - pos);
+                if (run_len > 0u){
+                    btstack_slip_decoder_store(decoder, &data[pos], run_len);
+                    pos += run_len;
+                    break;
+                }
+                input = data[pos++];
+                if (input == SLIP_ESC){
+                    decoder->state = SLIP_DECODER_X_DB;
+                    break;
+                }
+                // SOF
+                if (decoder->pos == 0u){
+                    btstack_slip_decoder_reset(decoder);
+                    break;
+                }
+                decoder->state = SLIP_DECODER_COMPLETE;
+                return pos;
+            default:
+                btstack_slip_decoder_reset(decoder);
+                break;
+        }
+    }
+    return pos;
+}
+
+uint16_t btstack_slip_decoder_instance_frame_size(const btstack_slip_decoder_t * decoder){
+    switch (decoder->state){
+        case SLIP_DECODER_COMPLETE:
+            return decoder->pos;
+        default:
+            return 0;
+    }
 }
 
 /**
@@ -149,9 +291,7 @@ static void btstack_slip_decoder_store_byte(uint8_t input){
  * @param max_size of buffer
  */
 void btstack_slip_decoder_init(uint8_t * buffer, uint16_t max_size){
-	decoder_buffer = buffer;
-	decoder_max_size = max_size;
-	btstack_slip_decoder_reset();
+    btstack_slip_decoder_instance_init(&slip_decoder, buffer, max_size);
 }
 
 /**
@@ -160,62 +300,22 @@ void btstack_slip_decoder_init(uint8_t * buffer, uint16_t max_size){
  */
 
 void btstack_slip_decoder_process(uint8_t input){
-	switch(decoder_state){
-        case SLIP_DECODER_UNKNOWN:
-            if (input != BTSTACK_SLIP_SOF) break;
-            btstack_slip_decoder_reset();
-            decoder_state = SLIP_DECODER_X_C0;
-            break;
-        case SLIP_DECODER_COMPLETE:
-        	log_error("btstack_slip_decoder_process called in state COMPLETE");
-            btstack_slip_decoder_reset();
-        	break;
-        case SLIP_DECODER_X_C0:
-            switch(input){
-                case BTSTACK_SLIP_SOF:
-                    break;
-                case 0xdb:
-                    decoder_state = SLIP_DECODER_X_DB;
-                    break;
-                default:
-                    btstack_slip_decoder_store_byte(input);
-                    decoder_state = SLIP_DECODER_ACTIVE;
-                    break; 
-            }                   
-            break;
-        case SLIP_DECODER_X_DB:
-            switch(input){
-                case 0xdc:
-                    btstack_slip_decoder_store_byte(BTSTACK_SLIP_SOF);
-                    decoder_state = SLIP_DECODER_ACTIVE;
-                    break;
-                case 0xdd:
-                    btstack_slip_decoder_store_byte(0xdb);
-                    decoder_state = SLIP_DECODER_ACTIVE;
-                    break;
-                default:
-                    btstack_slip_decoder_reset();
-                    break;
-            }
-            break;
+    switch (slip_decoder.state){
         case SLIP_DECODER_ACTIVE:
-            switch(input){
-                case BTSTACK_SLIP_SOF:
-                    if (decoder_pos){
-                    	decoder_state = SLIP_DECODER_COMPLETE;
-                    } else {
-	                    btstack_slip_decoder_reset();
-                    }
-                    break;
-                case 0xdb:
-                    decoder_state = SLIP_DECODER_X_DB;
-                    break;
-                default:
-                    btstack_slip_decoder_store_byte(input);
-                    break;
+            // fast path for plain data
+            if ((input != BTSTACK_SLIP_SOF) && (input != SLIP_ESC)){
+                btstack_slip_decoder_store(&slip_decoder, &input, 1);
+                return;
             }
             break;
+        case SLIP_DECODER_COMPLETE:
+            log_error("btstack_slip_decoder_process called in state COMPLETE");
+            btstack_slip_decoder_reset(&slip_decoder);
+            return;
+        default:
+            break;
     }
+    (void) btstack_slip_decoder_instance_process(&slip_decoder, &input, 1);
 }
 
 /**
@@ -224,10 +324,5 @@ void btstack_slip_decoder_process(uint8_t input){
  */
 
 uint16_t btstack_slip_decoder_frame_size(void){
-	switch (decoder_state){
-		case SLIP_DECODER_COMPLETE:
-			return decoder_pos;
-		default:
-			return 0;
-	}
+    return btstack_slip_decoder_instance_frame_size(&slip_decoder);
 }
@@ -51,6 +51,33 @@ extern "C" {
 
 #define BTSTACK_SLIP_SOF 0xc0
 
+typedef enum {
+    SLIP_ENCODER_DEFAULT,
+    SLIP_ENCODER_SEND_DC,
+    SLIP_ENCODER_SEND_DD
+} btstack_slip_encoder_state_t;
+
+typedef enum {
+    SLIP_DECODER_UNKNOWN = 1,
+    SLIP_DECODER_ACTIVE,
+    SLIP_DECODER_X_C0,
+    SLIP_DECODER_X_DB,
+    SLIP_DECODER_COMPLETE
+} btstack_slip_decoder_state_t;
+
+typedef struct {
+    btstack_slip_encoder_state_t state;
+    const uint8_t * data;
+    uint16_t        len;
+} btstack_slip_encoder_t;
+
+typedef struct {
+    btstack_slip_decoder_state_t state;
+    uint8_t * buffer;
+    uint16_t  max_size;
+    uint16_t  pos;
+} btstack_slip_decoder_t;
+
 // ENCODER
 
 /**
@@ -72,6 +99,30 @@ int  btstack_slip_encoder_has_data(void);
  */
 uint8_t btstack_slip_encoder_get_byte(void);
 
+/**
+ * @brief Initialise SLIP encoder instance with data
+ * @param encoder
+ * @param data
+ * @param len
+ */
+void btstack_slip_encoder_instance_start(btstack_slip_encoder_t * encoder, const uint8_t * data, uint16_t len);
+
+/**
+ * @brief Check if encoder instance has data ready
+ * @param encoder
+ * @return True if data ready
+ */
+int  btstack_slip_encoder_instance_has_data(const btstack_slip_encoder_t * encoder);
+
+/**
+ * @brief Encode as much data as fits into buffer. Runs without SOF or escape are copied as a whole
+ * @param encoder
+ * @param buffer for encoded data
+ * @param size of buffer
+ * @return number of bytes stored in buffer
+ */
+uint16_t btstack_slip_encoder_instance_encode(btstack_slip_encoder_t * encoder, uint8_t * buffer, uint16_t size);
+
 // DECODER
 
 /**
@@ -95,6 +146,31 @@ void btstack_slip_decoder_process(uint8_t input);
 
 uint16_t btstack_slip_decoder_frame_size(void);
 
+/**
+ * @brief Initialise SLIP decoder instance with buffer
+ * @param decoder
+ * @param buffer to store received data
+ * @param max_size of buffer
+ */
+void btstack_slip_decoder_instance_init(btstack_slip_decoder_t * decoder, uint8_t * buffer, uint16_t max_size);
+
+/**
+ * @brief Process received data until a frame is complete. Runs without SOF or escape are copied as a whole
+ * @param decoder
+ * @param data
+ * @param size
+ * @return number of bytes consumed. Processing stops after a complete frame, which needs to be handled before
+ *         the decoder is initialised again and the remaining data is processed
+ */
+uint16_t btstack_slip_decoder_instance_process(btstack_slip_decoder_t * decoder, const uint8_t * data, uint16_t size);
+
+/**
+ * @brief Get size of decoded frame
+ * @param decoder
+ * @return size of frame. Size = 0 => frame not complete
+ */
+uint16_t btstack_slip_decoder_instance_frame_size(const btstack_slip_decoder_t * decoder);
+
 #if defined __cplusplus
 }
 #endif
@@ -143,6 +143,15 @@ typedef struct {
      */
     void (*set_wakeup_handler)(void (*wakeup_handler)(void));
 
+    // support for streaming mode
+
+    /**
+     * set callback for received data. NULL disables streaming mode
+     * In streaming mode, the UART driver reads all available data and passes it to the data handler, receive_block is not used
+     * Has to be called before open. Optional, NULL if not supported
+     */
+    void (*set_data_received)(void (*data_handler)(const uint8_t * data, uint16_t size));
+
 } btstack_uart_block_t;
 
 // common implementations
@@ -473,3 +473,53 @@ uint8_t btstack_crc8_calc(uint8_t *data, uint16_t len){
     /* Ones complement */
     return 0xFF - crc8(data, len);
 }
+
+/*-----------------------------------------------------------------------------------*/
+void btstack_event_filter_init(btstack_event_filter_t * event_filter){
+    memset(event_filter, 0, sizeof(btstack_event_filter_t));
+}
+
+void btstack_event_filter_init_without_scan_results(btstack_event_filter_t * event_filter){
+    memset(event_filter->event_mask, 0xff, sizeof(event_filter->event_mask));
+    memset(event_filter->le_subevent_mask, 0xff, sizeof(event_filter->le_subevent_mask));
+    // LE Meta events are delivered per subevent
+    event_filter->event_mask[HCI_EVENT_LE_META >> 3] &= ~(1u << (HCI_EVENT_LE_META & 7u));
+    static const uint8_t scan_result_events[] = {
+        HCI_EVENT_INQUIRY_RESULT,
+        HCI_EVENT_INQUIRY_RESULT_WITH_RSSI,
+        HCI_EVENT_EXTENDED_INQUIRY_RESPONSE,
+        GAP_EVENT_ADVERTISING_REPORT,
+        GAP_EVENT_ADVERTISING_REPORT_BATCH,
+        GAP_EVENT_INQUIRY_RESULT,
+    };
+    static const uint8_t scan_result_le_subevents[] = {
+        HCI_SUBEVENT_LE_ADVERTISING_REPORT,
+        HCI_SUBEVENT_LE_DIRECT_ADVERTISING_REPORT,
+    };
+    uint16_t i;
+    for (i = 0; i < sizeof(scan_result_events); i++){
+        uint8_t event_type = scan_result_events[i];
+        event_filter->event_mask[event_type >> 3] &= ~(1u << (event_type & 7u));
+    }
+    for (i = 0; i < sizeof(scan_result_le_subevents); i++){
+        uint8_t subevent_code = scan_result_le_subevents[i];
+        event_filter->le_subevent_mask[subevent_code >> 3] &= ~(1u << (subevent_code & 7u));
+    }
+}
+
+void btstack_event_filter_add_event(btstack_event_filter_t * event_filter, uint8_t event_type){
+    event_filter->event_mask[event_type >> 3] |= 1u << (event_type & 7u);
+}
+
+void btstack_event_filter_add_le_subevent(btstack_event_filter_t * event_filter, uint8_t subevent_code){
+    event_filter->le_subevent_mask[subevent_code >> 3] |= 1u << (subevent_code & 7u);
+}
+
+bool btstack_event_filter_matches(const btstack_event_filter_t * event_filter, const uint8_t * event, uint16_t size){
+    if (event_filter == NULL) return true;
+    uint8_t event_type = event[0];
+    if ((event_filter->event_mask[event_type >> 3] & (1u << (event_type & 7u))) != 0u) return true;
+    if ((event_type != HCI_EVENT_LE_META) || (size < 3u)) return false;
+    uint8_t subevent_code = event[2];
+    return (event_filter->le_subevent_mask[subevent_code >> 3] & (1u << (subevent_code & 7u))) != 0u;
+}
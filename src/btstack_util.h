@@ -55,6 +55,7 @@ extern "C" {
 #include <string.h>
 
 #include "bluetooth.h"
+#include "btstack_bool.h"
 #include "btstack_defines.h"
 #include "btstack_linked_list.h"
 	
@@ -288,6 +289,42 @@ int count_set_bits_uint32(uint32_t x);
 uint8_t btstack_crc8_check(uint8_t *data, uint16_t len, uint8_t check_sum);
 uint8_t btstack_crc8_calc(uint8_t *data, uint16_t len);
 
+/**
+ * @brief Init event filter without any events
+ * @param event_filter
+ */
+void btstack_event_filter_init(btstack_event_filter_t * event_filter);
+
+/**
+ * @brief Init event filter with all events except for Inquiry Results and Advertising Reports
+ * @note for handlers that only need to run their state machine on events that can change it
+ * @param event_filter
+ */
+void btstack_event_filter_init_without_scan_results(btstack_event_filter_t * event_filter);
+
+/**
+ * @brief Add event type to event filter. HCI_EVENT_LE_META enables all LE Meta subevents
+ * @param event_filter
+ * @param event_type
+ */
+void btstack_event_filter_add_event(btstack_event_filter_t * event_filter, uint8_t event_type);
+
+/**
+ * @brief Add LE Meta subevent to event filter
+ * @param event_filter
+ * @param subevent_code
+ */
+void btstack_event_filter_add_le_subevent(btstack_event_filter_t * event_filter, uint8_t subevent_code);
+
+/**
+ * @brief Check if event filter delivers event. A NULL filter delivers all events
+ * @param event_filter
+ * @param event
+ * @param size
+ * @return true if event matches
+ */
+bool btstack_event_filter_matches(const btstack_event_filter_t * event_filter, const uint8_t * event, uint16_t size);
+
 /* API_END */
 
 #if defined __cplusplus
@@ -98,6 +98,14 @@
 #define BNEP_RESP_FILTER_ERR_TOO_MANY_FILTERS           0x0003
 #define BNEP_RESP_FILTER_ERR_SECURITY                   0x0004
 
+/* Network protocol types */
+#define BNEP_NETWORK_PROTOCOL_TYPE_IPV4                 0x0800
+#define BNEP_NETWORK_PROTOCOL_TYPE_ARP                  0x0806
+#define BNEP_NETWORK_PROTOCOL_TYPE_IPV6                 0x86DD
+
+/* destination address, source address, network protocol type */
+#define BNEP_ETHERNET_HEADER_SIZE                       14
+
 #define BNEP_CONNECTION_TIMEOUT_MS 10000
 #define BNEP_CONNECTION_MAX_RETRIES 1
 
@@ -432,29 +440,129 @@ void bnep_request_can_send_now_event(uint16_t bnep_cid)
 }
 
 
+/* Common network protocol types, stored as bitmap in net_filter_common_types */
+static const uint16_t bnep_common_network_protocol_types[] = { BNEP_NETWORK_PROTOCOL_TYPE_IPV4, BNEP_NETWORK_PROTOCOL_TYPE_ARP, BNEP_NETWORK_PROTOCOL_TYPE_IPV6, ETHERTYPE_VLAN };
+
+static const bd_addr_t bnep_broadcast_addr = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+/* Binary search in sorted, non-overlapping ranges */
+static int bnep_net_filter_contains(bnep_channel_t *channel, uint16_t network_protocol_type)
+{
+    int low  = 0;
+    int high = channel->net_filter_count - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        if (network_protocol_type < channel->net_filter[mid].range_start) {
+            high = mid - 1;
+        } else if (network_protocol_type > channel->net_filter[mid].range_end) {
+            low = mid + 1;
+        } else {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int bnep_multicast_filter_contains(bnep_channel_t *channel, const uint8_t * addr)
+{
+    int low  = 0;
+    int high = channel->multicast_filter_count - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        if (memcmp(addr, channel->multicast_filter[mid].addr_start, ETHER_ADDR_LEN) < 0) {
+            high = mid - 1;
+        } else if (memcmp(addr, channel->multicast_filter[mid].addr_end, ETHER_ADDR_LEN) > 0) {
+            low = mid + 1;
+        } else {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Sort and merge overlapping ranges, then cache result for common network protocol types */
+static void bnep_net_filter_compile(bnep_channel_t *channel)
+{
+    uint16_t i;
+    uint16_t j;
+    uint16_t count = 0;
+
+    /* insertion sort by range start, max MAX_BNEP_NETFILTER entries */
+    for (i = 1; i < channel->net_filter_count; i++) {
+        bnep_net_filter_t filter = channel->net_filter[i];
+        for (j = i; (j > 0) && (channel->net_filter[j-1].range_start > filter.range_start); j--) {
+            channel->net_filter[j] = channel->net_filter[j-1];
+        }
+        channel->net_filter[j] = filter;
+    }
+
+    for (i = 0; i < channel->net_filter_count; i++) {
+        if ((count > 0) && ((uint32_t) channel->net_filter[i].range_start <= ((uint32_t) channel->net_filter[count-1].range_end + 1))) {
+            channel->net_filter[count-1].range_end = btstack_max(channel->net_filter[count-1].range_end, channel->net_filter[i].range_end);
+        } else {
+            channel->net_filter[count++] = channel->net_filter[i];
+        }
+    }
+    channel->net_filter_count = count;
+
+    channel->net_filter_common_types = 0;
+    for (i = 0; i < (sizeof(bnep_common_network_protocol_types) / sizeof(uint16_t)); i++) {
+        if (bnep_net_filter_contains(channel, bnep_common_network_protocol_types[i])) {
+            channel->net_filter_common_types |= 1 << i;
+        }
+    }
+}
+
+/* Sort and merge overlapping ranges, then cache result for broadcast address */
+static void bnep_multicast_filter_compile(bnep_channel_t *channel)
+{
+    uint16_t i;
+    uint16_t j;
+    uint16_t count = 0;
+
+    /* insertion sort by start address, max MAX_BNEP_MULTICAST_FILTER entries */
+    for (i = 1; i < channel->multicast_filter_count; i++) {
+        bnep_multi_filter_t filter = channel->multicast_filter[i];
+        for (j = i; (j > 0) && (memcmp(channel->multicast_filter[j-1].addr_start, filter.addr_start, ETHER_ADDR_LEN) > 0); j--) {
+            channel->multicast_filter[j] = channel->multicast_filter[j-1];
+        }
+        channel->multicast_filter[j] = filter;
+    }
+
+    for (i = 0; i < channel->multicast_filter_count; i++) {
+        if ((count > 0) && (memcmp(channel->multicast_filter[i].addr_start, channel->multicast_filter[count-1].addr_end, ETHER_ADDR_LEN) <= 0)) {
+            if (memcmp(channel->multicast_filter[i].addr_end, channel->multicast_filter[count-1].addr_end, ETHER_ADDR_LEN) > 0) {
+                bd_addr_copy(channel->multicast_filter[count-1].addr_end, channel->multicast_filter[i].addr_end);
+            }
+        } else {
+            channel->multicast_filter[count++] = channel->multicast_filter[i];
+        }
+    }
+    channel->multicast_filter_count = count;
+
+    channel->multicast_filter_broadcast = bnep_multicast_filter_contains(channel, bnep_broadcast_addr);
+}
+
 static int bnep_filter_protocol(bnep_channel_t *channel, uint16_t network_protocol_type)
 {
-	int i;
+	unsigned int i;
     
     if (channel->net_filter_count == 0) {
         /* No filter set */
         return 1;
     }
 
-    for (i = 0; i < channel->net_filter_count; i ++) {
-        if ((network_protocol_type >= channel->net_filter[i].range_start) &&
-            (network_protocol_type <= channel->net_filter[i].range_end)) {
-            return 1;
+    for (i = 0; i < (sizeof(bnep_common_network_protocol_types) / sizeof(uint16_t)); i++) {
+        if (network_protocol_type == bnep_common_network_protocol_types[i]) {
+            return (channel->net_filter_common_types >> i) & 1;
         }
     }
 
-    return 0;
+    return bnep_net_filter_contains(channel, network_protocol_type);
 }
 
 static int bnep_filter_multicast(bnep_channel_t *channel, bd_addr_t addr_dest)
 {
-	int i;
-
     /* Check if the multicast flag is set int the destination address */
 	if ((addr_dest[0] & 0x01) == 0x00) {
         /* Not a multicast frame, do not apply filtering and send it in any case */
@@ -466,83 +574,164 @@ static int bnep_filter_multicast(bnep_channel_t *channel, bd_addr_t addr_dest)
         return 1;
     }
 
-	for (i = 0; i < channel->multicast_filter_count; i ++) {
-		if ((memcmp(addr_dest, channel->multicast_filter[i].addr_start, sizeof(bd_addr_t)) >= 0) &&
-		    (memcmp(addr_dest, channel->multicast_filter[i].addr_end, sizeof(bd_addr_t)) <= 0)) {
-			return 1;
+    if (memcmp(addr_dest, bnep_broadcast_addr, ETHER_ADDR_LEN) == 0) {
+        return channel->multicast_filter_broadcast;
+    }
+
+	return bnep_multicast_filter_contains(channel, addr_dest);
+}
+
+/* Check filters for ethernet packet, same as bnep_commit_send_buffer */
+static int bnep_filter_frame(bnep_channel_t *channel, uint8_t *packet, uint16_t len)
+{
+    uint16_t network_protocol_type = big_endian_read_16(packet, 12);
+	if (network_protocol_type == ETHERTYPE_VLAN) {
+        if (len < (BNEP_ETHERNET_HEADER_SIZE + 4)) {
+            return 0;
         }
+		network_protocol_type = big_endian_read_16(packet, BNEP_ETHERNET_HEADER_SIZE + 2);
 	}
+    if (bnep_filter_protocol(channel, network_protocol_type) && bnep_filter_multicast(channel, packet)) {
+        return 1;
+    }
+    /* IEEE 802.1Q tag header is sent without payload */
+    return network_protocol_type == ETHERTYPE_VLAN;
+}
 
-	return 0;
+void bnep_shared_frame_retain(bnep_shared_frame_t * frame)
+{
+    frame->ref_count++;
 }
 
+void bnep_shared_frame_release(bnep_shared_frame_t * frame)
+{
+    btstack_assert(frame->ref_count > 0);
+    frame->ref_count--;
+    if (frame->ref_count > 0) return;
+    if (frame->release_handler == NULL) return;
+    (*frame->release_handler)(frame);
+}
 
-/* Send BNEP ethernet packet */
-int bnep_send(uint16_t bnep_cid, uint8_t *packet, uint16_t len)
+/* @return 0 if queued or filtered, BTSTACK_ACL_BUFFERS_FULL if queue is full */
+static int bnep_channel_queue_shared_frame(bnep_channel_t *channel, bnep_shared_frame_t * frame)
 {
-    bnep_channel_t *channel;
-    uint8_t        *bnep_out_buffer = NULL;
-    uint16_t        pos = 0;
-    uint16_t        pos_out = 0;
-    uint16_t        payload_len;
-    int             err = 0;
-    int             has_source;
-    int             has_dest;
+    if (frame->len < BNEP_ETHERNET_HEADER_SIZE) {
+        return 0;
+    }
 
-    bd_addr_t       addr_dest;
-    bd_addr_t       addr_source;
-    uint16_t        network_protocol_type;
+    /* Don't queue frames that would be dropped */
+    if (!bnep_filter_frame(channel, frame->data, frame->len)) {
+        return 0;
+    }
 
-    channel = bnep_channel_for_l2cap_cid(bnep_cid);
+    if (channel->shared_frames_count >= BNEP_SHARED_FRAME_QUEUE_SIZE) {
+        log_info("bnep_send_shared_frame cid 0x%02x: queue full", channel->l2cap_cid);
+        return BTSTACK_ACL_BUFFERS_FULL;
+    }
+
+    bnep_shared_frame_retain(frame);
+    channel->shared_frames[(channel->shared_frames_head + channel->shared_frames_count) % BNEP_SHARED_FRAME_QUEUE_SIZE] = frame;
+    channel->shared_frames_count++;
+    return 0;
+}
+
+int bnep_send_shared_frame(uint16_t bnep_cid, bnep_shared_frame_t * frame)
+{
+    bnep_channel_t *channel = bnep_channel_for_l2cap_cid(bnep_cid);
     if (channel == NULL) {
-        log_error("bnep_send cid 0x%02x doesn't exist!", bnep_cid);
+        log_error("bnep_send_shared_frame cid 0x%02x doesn't exist!", bnep_cid);
         return 1;
     }
-        
+
     if (channel->state != BNEP_CHANNEL_STATE_CONNECTED) {
         return BNEP_CHANNEL_NOT_CONNECTED;
     }
-    
-    /* Check for free ACL buffers */
-    if (!l2cap_can_send_packet_now(channel->l2cap_cid)) {
-        return BTSTACK_ACL_BUFFERS_FULL;
+
+    int err = bnep_channel_queue_shared_frame(channel, frame);
+    if (channel->shared_frames_count > 0) {
+        l2cap_request_can_send_now_event(channel->l2cap_cid);
     }
+    return err;
+}
 
-    /* Extract destination and source address from the ethernet packet */
-    pos = 0;
-    bd_addr_copy(addr_dest, &packet[pos]);
-    pos += sizeof(bd_addr_t);
-    bd_addr_copy(addr_source, &packet[pos]);
-    pos += sizeof(bd_addr_t);
-    network_protocol_type = big_endian_read_16(packet, pos);
-    pos += sizeof(uint16_t);
+int bnep_broadcast_shared_frame(bnep_shared_frame_t * frame, uint16_t exclude_bnep_cid, uint16_t * out_num_dropped)
+{
+    btstack_linked_list_iterator_t it;
+    /* each channel that queued the frame holds a reference */
+    uint16_t ref_count = frame->ref_count;
+    uint16_t num_dropped = 0;
+
+    /* queue on all channels first, as frame might be sent and released on can send now */
+    btstack_linked_list_iterator_init(&it, &bnep_channels);
+    while (btstack_linked_list_iterator_has_next(&it)) {
+        bnep_channel_t * channel = (bnep_channel_t *) btstack_linked_list_iterator_next(&it);
+        if (channel->l2cap_cid == exclude_bnep_cid) continue;
+        if (channel->state != BNEP_CHANNEL_STATE_CONNECTED) continue;
+        if (bnep_channel_queue_shared_frame(channel, frame) != 0) {
+            num_dropped++;
+        }
+    }
+    int num_channels = frame->ref_count - ref_count;
 
-    payload_len = len - pos;
+    btstack_linked_list_iterator_init(&it, &bnep_channels);
+    while (btstack_linked_list_iterator_has_next(&it)) {
+        bnep_channel_t * channel = (bnep_channel_t *) btstack_linked_list_iterator_next(&it);
+        if (channel->shared_frames_count == 0) continue;
+        l2cap_request_can_send_now_event(channel->l2cap_cid);
+    }
 
-	if (network_protocol_type == ETHERTYPE_VLAN) {	/* IEEE 802.1Q tag header */
-		if (payload_len < 4) {
-            /* Omit this packet */
-			return 0;
-        }
-        /* The "real" network protocol type is 4 bytes ahead in a VLAN packet */
-		network_protocol_type = big_endian_read_16(packet, pos + 2);
-	}
+    if (out_num_dropped != NULL) {
+        *out_num_dropped = num_dropped;
+    }
+    return num_channels;
+}
 
-    /* Check network protocol and multicast filters before sending */
-    if (!bnep_filter_protocol(channel, network_protocol_type) ||
-        !bnep_filter_multicast(channel, addr_dest)) {
-        /* Packet did not pass filter... */
-        if ((network_protocol_type == ETHERTYPE_VLAN) && 
-            (payload_len >= 4)) {
-            /* The packet has been tagged as a with IEE 802.1Q tag and has been filtered out.
-               According to the spec the IEE802.1Q tag header shall be sended without ethernet payload.
-               So limit the payload_len to 4.
-             */
-            payload_len = 4;
-        } else {
-            /* Packet is not tagged with IEE802.1Q header and was filtered out. Omit this packet */        
-            return 0;
-        }
+static void bnep_shared_frames_send_next(bnep_channel_t *channel)
+{
+    bnep_shared_frame_t * frame = channel->shared_frames[channel->shared_frames_head];
+    channel->shared_frames_head = (channel->shared_frames_head + 1) % BNEP_SHARED_FRAME_QUEUE_SIZE;
+    channel->shared_frames_count--;
+    bnep_send(channel->l2cap_cid, frame->data, frame->len);
+    bnep_shared_frame_release(frame);
+}
+
+static void bnep_shared_frames_discard(bnep_channel_t *channel)
+{
+    while (channel->shared_frames_count > 0) {
+        bnep_shared_frame_t * frame = channel->shared_frames[channel->shared_frames_head];
+        channel->shared_frames_head = (channel->shared_frames_head + 1) % BNEP_SHARED_FRAME_QUEUE_SIZE;
+        channel->shared_frames_count--;
+        bnep_shared_frame_release(frame);
+    }
+}
+
+/* Reserve l2cap packet buffer and store BNEP header for ethernet packet */
+uint8_t * bnep_reserve_send_buffer(uint16_t bnep_cid, bd_addr_t addr_dest, bd_addr_t addr_source, uint16_t network_protocol_type, uint16_t * out_size)
+{
+    bnep_channel_t *channel;
+    uint8_t        *bnep_out_buffer;
+    uint16_t        pos_out = 0;
+    int             has_source;
+    int             has_dest;
+
+    channel = bnep_channel_for_l2cap_cid(bnep_cid);
+    if (channel == NULL) {
+        log_error("bnep_reserve_send_buffer cid 0x%02x doesn't exist!", bnep_cid);
+        return NULL;
+    }
+
+    if (channel->state != BNEP_CHANNEL_STATE_CONNECTED) {
+        return NULL;
+    }
+
+    if (channel->send_buffer_reserved) {
+        log_error("bnep_reserve_send_buffer cid 0x%02x: buffer already reserved", bnep_cid);
+        return NULL;
+    }
+
+    /* Check for free ACL buffers */
+    if (!l2cap_can_send_packet_now(channel->l2cap_cid)) {
+        return NULL;
     }
 
     /* Reserve l2cap packet buffer */    
@@ -556,12 +745,6 @@ int bnep_send(uint16_t bnep_cid, uint8_t *packet, uint16_t len)
     has_source = (memcmp(addr_source, channel->local_addr, ETHER_ADDR_LEN) != 0);
     has_dest = (memcmp(addr_dest, channel->remote_addr, ETHER_ADDR_LEN) != 0);
 
-    /* Check for MTU limits */
-    if (payload_len > channel->max_frame_size) {
-        log_error("bnep_send: Max frame size (%d) exceeded: %d", channel->max_frame_size, payload_len);
-        return BNEP_DATA_LEN_EXCEEDS_MTU;
-    }
-    
     /* Fill in the package type depending on the given source and destination address */
     if (has_source && has_dest) {
         bnep_out_buffer[pos_out++] = BNEP_PKT_TYPE_GENERAL_ETHERNET;
@@ -592,11 +775,84 @@ int bnep_send(uint16_t bnep_cid, uint8_t *packet, uint16_t len)
     pos_out += 2;
     
     /* TODO: Add extension headers, if we may support them at a later stage */
-    /* Add the payload and then send out the package */
-    (void)memcpy(bnep_out_buffer + pos_out, packet + pos, payload_len);
-    pos_out += payload_len;
 
-    err = l2cap_send_prepared(channel->l2cap_cid, pos_out);
+    channel->send_buffer_reserved = 1;
+    channel->send_buffer_header_len = pos_out;
+    channel->send_buffer_network_protocol_type = network_protocol_type;
+    bd_addr_copy(channel->send_buffer_addr_dest, addr_dest);
+
+    *out_size = btstack_min(channel->max_frame_size, l2cap_get_remote_mtu_for_local_cid(channel->l2cap_cid) - pos_out);
+    return bnep_out_buffer + pos_out;
+}
+
+void bnep_release_send_buffer(uint16_t bnep_cid)
+{
+    bnep_channel_t *channel = bnep_channel_for_l2cap_cid(bnep_cid);
+    if (channel == NULL) return;
+    if (channel->send_buffer_reserved == 0) return;
+    channel->send_buffer_reserved = 0;
+    l2cap_release_packet_buffer();
+}
+
+/* Send BNEP ethernet packet stored in reserved buffer */
+int bnep_commit_send_buffer(uint16_t bnep_cid, uint16_t payload_len)
+{
+    bnep_channel_t *channel;
+    uint8_t        *payload;
+    uint16_t        network_protocol_type;
+    int             err;
+
+    channel = bnep_channel_for_l2cap_cid(bnep_cid);
+    if (channel == NULL) {
+        log_error("bnep_commit_send_buffer cid 0x%02x doesn't exist!", bnep_cid);
+        return 1;
+    }
+
+    if (channel->send_buffer_reserved == 0) {
+        log_error("bnep_commit_send_buffer cid 0x%02x: no buffer reserved", bnep_cid);
+        return 1;
+    }
+    channel->send_buffer_reserved = 0;
+
+    payload = l2cap_get_outgoing_buffer() + channel->send_buffer_header_len;
+    network_protocol_type = channel->send_buffer_network_protocol_type;
+
+	if (network_protocol_type == ETHERTYPE_VLAN) {	/* IEEE 802.1Q tag header */
+		if (payload_len < 4) {
+            /* Omit this packet */
+            l2cap_release_packet_buffer();
+			return 0;
+        }
+        /* The "real" network protocol type is 4 bytes ahead in a VLAN packet */
+		network_protocol_type = big_endian_read_16(payload, 2);
+	}
+
+    /* Check network protocol and multicast filters before sending */
+    if (!bnep_filter_protocol(channel, network_protocol_type) ||
+        !bnep_filter_multicast(channel, channel->send_buffer_addr_dest)) {
+        /* Packet did not pass filter... */
+        if ((network_protocol_type == ETHERTYPE_VLAN) && 
+            (payload_len >= 4)) {
+            /* The packet has been tagged as a with IEE 802.1Q tag and has been filtered out.
+               According to the spec the IEE802.1Q tag header shall be sended without ethernet payload.
+               So limit the payload_len to 4.
+             */
+            payload_len = 4;
+        } else {
+            /* Packet is not tagged with IEE802.1Q header and was filtered out. Omit this packet */        
+            l2cap_release_packet_buffer();
+            return 0;
+        }
+    }
+
+    /* Check for MTU limits */
+    if (payload_len > channel->max_frame_size) {
+        log_error("bnep_send: Max frame size (%d) exceeded: %d", channel->max_frame_size, payload_len);
+        l2cap_release_packet_buffer();
+        return BNEP_DATA_LEN_EXCEEDS_MTU;
+    }
+
+    err = l2cap_send_prepared(channel->l2cap_cid, channel->send_buffer_header_len + payload_len);
     
     if (err) {
         log_error("bnep_send: error %d", err);
@@ -604,6 +860,51 @@ int bnep_send(uint16_t bnep_cid, uint8_t *packet, uint16_t len)
     return err;        
 }
 
+/* Send BNEP ethernet packet */
+int bnep_send(uint16_t bnep_cid, uint8_t *packet, uint16_t len)
+{
+    bnep_channel_t *channel;
+    uint8_t        *payload;
+    uint16_t        payload_len;
+    uint16_t        max_payload_len;
+
+    channel = bnep_channel_for_l2cap_cid(bnep_cid);
+    if (channel == NULL) {
+        log_error("bnep_send cid 0x%02x doesn't exist!", bnep_cid);
+        return 1;
+    }
+        
+    if (channel->state != BNEP_CHANNEL_STATE_CONNECTED) {
+        return BNEP_CHANNEL_NOT_CONNECTED;
+    }
+    
+    /* Check for free ACL buffers */
+    if (!l2cap_can_send_packet_now(channel->l2cap_cid)) {
+        return BTSTACK_ACL_BUFFERS_FULL;
+    }
+
+    if (len < BNEP_ETHERNET_HEADER_SIZE) {
+        /* Omit this packet */
+        return 0;
+    }
+
+    /* Check for MTU limits before copying payload */
+    payload_len = len - BNEP_ETHERNET_HEADER_SIZE;
+    if (payload_len > channel->max_frame_size) {
+        log_error("bnep_send: Max frame size (%d) exceeded: %d", channel->max_frame_size, payload_len);
+        return BNEP_DATA_LEN_EXCEEDS_MTU;
+    }
+
+    /* Extract destination and source address from the ethernet packet and store BNEP header */
+    payload = bnep_reserve_send_buffer(bnep_cid, &packet[0], &packet[6], big_endian_read_16(packet, 12), &max_payload_len);
+    if (payload == NULL) {
+        return BTSTACK_ACL_BUFFERS_FULL;
+    }
+
+    /* Add the payload and then send out the package */
+    (void)memcpy(payload, packet + BNEP_ETHERNET_HEADER_SIZE, payload_len);
+    return bnep_commit_send_buffer(bnep_cid, payload_len);
+}
 
 /* Set BNEP network protocol type filter */
 int bnep_set_net_type_filter(uint16_t bnep_cid, bnep_net_filter_t *filter, uint16_t len)
@@ -674,7 +975,7 @@ int bnep_set_multicast_filter(uint16_t bnep_cid,  bnep_multi_filter_t *filter, u
 /* BNEP timeout timer helper function */
 static void bnep_channel_timer_handler(btstack_timer_source_t *timer)
 {
-    bnep_channel_t *channel = btstack_run_loop_get_timer_context(timer);
+    bnep_channel_t *channel = (bnep_channel_t *) btstack_run_loop_get_timer_context(timer);
     // retry send setup connection at least one time
     if (channel->state == BNEP_CHANNEL_STATE_WAIT_FOR_CONNECTION_RESPONSE){
         if (channel->retry_count < BNEP_CONNECTION_MAX_RETRIES){
@@ -794,6 +1095,7 @@ static bnep_service_t * bnep_service_for_uuid(uint16_t uuid)
 
 static void bnep_channel_free(bnep_channel_t *channel)
 {
+    bnep_shared_frames_discard(channel);
     btstack_linked_list_remove( &bnep_channels, (btstack_linked_item_t *) channel);
     btstack_memory_bnep_channel_free(channel);
 }
@@ -983,6 +1285,8 @@ static int bnep_handle_filter_net_type_set(bnep_channel_t *channel, uint8_t *pac
         }
     }
 
+    bnep_net_filter_compile(channel);
+
     /* Set flag to send out the set net filter response on next statemachine cycle */
     bnep_channel_state_add(channel, BNEP_CHANNEL_STATE_VAR_SND_FILTER_NET_TYPE_RESPONSE);
     channel->response_code = response_code;
@@ -1069,6 +1373,8 @@ static int bnep_handle_multi_addr_set(bnep_channel_t *channel, uint8_t *packet,
             }
         }
     }
+    bnep_multicast_filter_compile(channel);
+
     /* Set flag to send out the set multi addr response on next statemachine cycle */
     bnep_channel_state_add(channel, BNEP_CHANNEL_STATE_VAR_SND_FILTER_MULTI_ADDR_RESPONSE);
     channel->response_code = response_code;
@@ -1536,10 +1842,25 @@ static void bnep_channel_state_machine(bnep_channel_t* channel, bnep_channel_eve
             return;
         }
 
+        /* Send queued shared frames. If the application is waiting as well, it gets every other can send now */
+        if ((channel->shared_frames_count > 0) && ((channel->waiting_for_can_send_now == 0) || (channel->shared_frame_sent_last == 0))) {
+            bnep_shared_frames_send_next(channel);
+            channel->shared_frame_sent_last = 1;
+            if ((channel->shared_frames_count > 0) || channel->waiting_for_can_send_now) {
+                l2cap_request_can_send_now_event(channel->l2cap_cid);
+            }
+            return;
+        }
+        channel->shared_frame_sent_last = 0;
+
         /* If the event was not yet handled, notify the application layer */
         if (channel->waiting_for_can_send_now){
             channel->waiting_for_can_send_now = 0;            
             bnep_emit_ready_to_send(channel);
+            /* Continue with shared frames */
+            if (channel->shared_frames_count > 0) {
+                l2cap_request_can_send_now_event(channel->l2cap_cid);
+            }
         }
     }    
 }
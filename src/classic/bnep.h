@@ -59,6 +59,11 @@ extern "C" {
 #define MAX_BNEP_NETFILTER_OUT                          421
 #define MAX_BNEP_MULTICAST_FILTER_OUT                   140
 
+// number of shared frames queued per channel, see bnep_send_shared_frame
+#ifndef BNEP_SHARED_FRAME_QUEUE_SIZE
+#define BNEP_SHARED_FRAME_QUEUE_SIZE                    4
+#endif
+
 typedef enum {
 	BNEP_CHANNEL_STATE_CLOSED = 1,
     BNEP_CHANNEL_STATE_WAIT_FOR_CONNECTION_REQUEST,
@@ -98,6 +103,16 @@ typedef struct {
 } bnep_multi_filter_t;
 
 
+/* Ethernet frame sent on several channels without copying it for each channel */
+typedef struct bnep_shared_frame {
+    // number of references, frame is released when it drops to zero
+    uint16_t            ref_count;
+    uint16_t            len;
+    uint8_t            *data;
+    // called when frame was sent on all channels and released by its owner
+    void              (*release_handler)(struct bnep_shared_frame * frame);
+} bnep_shared_frame_t;
+
 // info regarding multiplexer
 // note: spec mandates single multplexer per device combination
 typedef struct {
@@ -121,14 +136,16 @@ typedef struct {
     uint8_t            last_control_type; // type of last control package
     uint16_t           response_code;     // response code of last action (temp. storage for state machine)
 
-    bnep_net_filter_t  net_filter[MAX_BNEP_NETFILTER];              // network protocol filter, define fixed size for now
+    bnep_net_filter_t  net_filter[MAX_BNEP_NETFILTER];              // network protocol filter, sorted and merged, define fixed size for now
     uint16_t           net_filter_count;
+    uint8_t            net_filter_common_types;                     // bitmap of common network protocol types that pass the filter
 
     bnep_net_filter_t *net_filter_out;                              // outgoint network protocol filter, must be statically allocated in the application
     uint16_t           net_filter_out_count;
     
-    bnep_multi_filter_t  multicast_filter[MAX_BNEP_MULTICAST_FILTER]; // multicast address filter, define fixed size for now
+    bnep_multi_filter_t  multicast_filter[MAX_BNEP_MULTICAST_FILTER]; // multicast address filter, sorted and merged, define fixed size for now
     uint16_t             multicast_filter_count;
+    uint8_t              multicast_filter_broadcast;                  // broadcast address passes the filter
     
     bnep_multi_filter_t *multicast_filter_out;                        // outgoing multicast address filter, must be statically allocated in the application
     uint16_t             multicast_filter_out_count;
@@ -142,6 +159,19 @@ typedef struct {
 
     uint8_t   waiting_for_can_send_now;
 
+    // outgoing buffer reserved by bnep_reserve_send_buffer, BNEP header already stored
+    uint8_t   send_buffer_reserved;
+    uint16_t  send_buffer_header_len;
+    uint16_t  send_buffer_network_protocol_type;
+    bd_addr_t send_buffer_addr_dest;
+
+    // shared frames to send
+    bnep_shared_frame_t * shared_frames[BNEP_SHARED_FRAME_QUEUE_SIZE];
+    uint8_t   shared_frames_head;
+    uint8_t   shared_frames_count;
+    // last can send now was used for a shared frame, next one goes to the application if waiting
+    uint8_t   shared_frame_sent_last;
+
 } bnep_channel_t;
 
 /* Internal BNEP service descriptor */
@@ -182,6 +212,66 @@ void bnep_request_can_send_now_event(uint16_t bnep_cid);
  */
 int bnep_send(uint16_t bnep_cid, uint8_t *packet, uint16_t len);
 
+/**
+ * @brief Reserve outgoing buffer for Ethernet frame payload to be filled by the caller, avoids copying the frame.
+ * @note The BNEP header is stored in front of the payload, compressed if addresses match the local/remote address.
+ *       Can be called on BNEP_EVENT_CAN_SEND_NOW or if bnep_can_send_packet_now returns true.
+ *       Call bnep_commit_send_buffer to send the frame or bnep_release_send_buffer to drop it
+ * @param bnep_cid
+ * @param addr_dest
+ * @param addr_source
+ * @param network_protocol_type
+ * @param out_size max size of payload that can be stored in buffer
+ * @return buffer for payload or NULL if the channel cannot send now
+ */
+uint8_t * bnep_reserve_send_buffer(uint16_t bnep_cid, bd_addr_t addr_dest, bd_addr_t addr_source, uint16_t network_protocol_type, uint16_t * out_size);
+
+/**
+ * @brief Send Ethernet frame with payload_len bytes stored in buffer provided by bnep_reserve_send_buffer
+ * @note Network protocol and multicast filters are applied, frames that don't pass are dropped and 0 is returned.
+ *       Buffer is released on error
+ * @param bnep_cid
+ * @param payload_len
+ * @return status
+ */
+int bnep_commit_send_buffer(uint16_t bnep_cid, uint16_t payload_len);
+
+/**
+ * @brief Release buffer provided by bnep_reserve_send_buffer without sending it
+ * @param bnep_cid
+ */
+void bnep_release_send_buffer(uint16_t bnep_cid);
+
+/**
+ * @brief Queue shared Ethernet frame for sending, BNEP keeps a reference until the frame was sent.
+ * @note Frames that don't pass the network protocol and multicast filters set by the remote device are not queued
+ * @param bnep_cid
+ * @param frame with ref_count >= 1 held by caller
+ * @return 0 if ok or filtered, BNEP_CHANNEL_NOT_CONNECTED, or BTSTACK_ACL_BUFFERS_FULL if queue is full
+ */
+int bnep_send_shared_frame(uint16_t bnep_cid, bnep_shared_frame_t * frame);
+
+/**
+ * @brief Queue shared Ethernet frame, e.g. a broadcast, on all connected channels except one
+ * @param frame with ref_count >= 1 held by caller
+ * @param exclude_bnep_cid channel the frame was received on, or 0
+ * @param out_num_dropped number of channels with full queue, can be NULL
+ * @return number of channels the frame was queued on
+ */
+int bnep_broadcast_shared_frame(bnep_shared_frame_t * frame, uint16_t exclude_bnep_cid, uint16_t * out_num_dropped);
+
+/**
+ * @brief Add reference to shared frame
+ * @param frame
+ */
+void bnep_shared_frame_retain(bnep_shared_frame_t * frame);
+
+/**
+ * @brief Drop reference to shared frame, calls release handler if it was the last one
+ * @param frame
+ */
+void bnep_shared_frame_release(bnep_shared_frame_t * frame);
+
 /**
  * @brief Set the network protocol filter.
  */
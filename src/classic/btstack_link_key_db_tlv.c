@@ -51,9 +51,26 @@
 #define NVM_NUM_LINK_KEYS 1
 #endif
 
+// link keys 0..255 use tag 'BTL'+index, larger indices use 'BL'+index
+#if NVM_NUM_LINK_KEYS > 0xffff
+#error "NVM_NUM_LINK_KEYS must not be larger than 65535, please update in btstack_config.h"
+#endif
+
+#define INVALID_ENTRY_INDEX 0xffff
+
+// seq_nr == 0 for unused entries
+typedef struct {
+    uint32_t  seq_nr;       // initialized from storage, updated on use
+    uint16_t  hash_next;    // next entry in address hash bucket
+    bd_addr_t bd_addr;
+} link_key_index_t;
+
 typedef struct {
     const btstack_tlv_t * btstack_tlv_impl;
     void * btstack_tlv_context;
+    uint32_t highest_seq_nr;
+    link_key_index_t index[NVM_NUM_LINK_KEYS];
+    uint16_t hash_buckets[NVM_NUM_LINK_KEYS];
 } btstack_link_key_db_tlv_h;
 
 typedef struct link_key_nvm {
@@ -70,10 +87,75 @@ static const char tag_0 = 'B';
 static const char tag_1 = 'T';
 static const char tag_2 = 'L';
 
-static uint32_t btstack_link_key_db_tag_for_index(uint8_t index){
+static uint32_t btstack_link_key_db_tag_for_index(uint16_t index){
+    if (index > 0xff){
+        return (tag_0 << 24) | (tag_2 << 16) | index;
+    }
     return (tag_0 << 24) | (tag_1 << 16) | (tag_2 << 8) | index;
 }
 
+static uint16_t btstack_link_key_db_tlv_hash(const bd_addr_t bd_addr){
+    uint32_t hash = 0;
+    int i;
+    for (i=0;i<6;i++){
+        hash = (hash * 31u) + bd_addr[i];
+    }
+    return (uint16_t) (hash % NVM_NUM_LINK_KEYS);
+}
+
+static void btstack_link_key_db_tlv_index_add(uint16_t index, const bd_addr_t bd_addr, uint32_t seq_nr){
+    link_key_index_t * entry = &self->index[index];
+    (void)memcpy(entry->bd_addr, bd_addr, 6);
+    entry->seq_nr = seq_nr;
+    uint16_t bucket = btstack_link_key_db_tlv_hash(bd_addr);
+    entry->hash_next = self->hash_buckets[bucket];
+    self->hash_buckets[bucket] = index;
+    if (seq_nr > self->highest_seq_nr){
+        self->highest_seq_nr = seq_nr;
+    }
+}
+
+static void btstack_link_key_db_tlv_index_remove(uint16_t index){
+    link_key_index_t * entry = &self->index[index];
+    uint16_t * link = &self->hash_buckets[btstack_link_key_db_tlv_hash(entry->bd_addr)];
+    while (*link != INVALID_ENTRY_INDEX){
+        if (*link == index){
+            *link = entry->hash_next;
+            break;
+        }
+        link = &self->index[*link].hash_next;
+    }
+    entry->seq_nr = 0;
+}
+
+// @returns index for bd_addr or INVALID_ENTRY_INDEX
+static uint16_t btstack_link_key_db_tlv_index_lookup(const bd_addr_t bd_addr){
+    uint16_t index = self->hash_buckets[btstack_link_key_db_tlv_hash(bd_addr)];
+    while (index != INVALID_ENTRY_INDEX){
+        if (memcmp(bd_addr, self->index[index].bd_addr, 6) == 0) break;
+        index = self->index[index].hash_next;
+    }
+    return index;
+}
+
+static void btstack_link_key_db_tlv_scan(void){
+    uint16_t i;
+    self->highest_seq_nr = 0;
+    for (i=0;i<NVM_NUM_LINK_KEYS;i++){
+        self->index[i].seq_nr = 0;
+        self->hash_buckets[i] = INVALID_ENTRY_INDEX;
+    }
+    for (i=0;i<NVM_NUM_LINK_KEYS;i++){
+        link_key_nvm_t entry;
+        uint32_t tag = btstack_link_key_db_tag_for_index(i);
+        int size = self->btstack_tlv_impl->get_tag(self->btstack_tlv_context, tag, (uint8_t*) &entry, sizeof(entry));
+        if (size != sizeof(entry)) continue;
+        // stored entries have seq_nr >= 1, seq_nr 0 marks unused index entries
+        if (entry.seq_nr == 0) continue;
+        btstack_link_key_db_tlv_index_add(i, entry.bd_addr, entry.seq_nr);
+    }
+}
+
 // Device info
 static void btstack_link_key_db_tlv_open(void){
 }
@@ -86,82 +168,51 @@ static void btstack_link_key_db_tlv_close(void){
 }
 
 static int btstack_link_key_db_tlv_get_link_key(bd_addr_t bd_addr, link_key_t link_key, link_key_type_t * link_key_type) {
-    int i;
-    for (i=0;i<NVM_NUM_LINK_KEYS;i++){
-        link_key_nvm_t entry;
-        uint32_t tag = btstack_link_key_db_tag_for_index(i);
-        int size = self->btstack_tlv_impl->get_tag(self->btstack_tlv_context, tag, (uint8_t*) &entry, sizeof(entry));
-        if (size == 0) continue;
-        log_info("tag %x, addr %s", tag, bd_addr_to_str(entry.bd_addr));
-        if (memcmp(bd_addr, entry.bd_addr, 6)) continue;
-        // found, pass back
-        (void)memcpy(link_key, entry.link_key, 16);
-        *link_key_type = entry.link_key_type;
-        return 1;
-    }
-	return 0;
+    uint16_t index = btstack_link_key_db_tlv_index_lookup(bd_addr);
+    if (index == INVALID_ENTRY_INDEX) return 0;
+
+    link_key_nvm_t entry;
+    uint32_t tag = btstack_link_key_db_tag_for_index(index);
+    int size = self->btstack_tlv_impl->get_tag(self->btstack_tlv_context, tag, (uint8_t*) &entry, sizeof(entry));
+    if (size != sizeof(entry)) return 0;
+    log_info("tag %x, addr %s", tag, bd_addr_to_str(entry.bd_addr));
+
+    // mark as most recently used, only kept in RAM
+    self->index[index].seq_nr = ++self->highest_seq_nr;
+
+    // found, pass back
+    (void)memcpy(link_key, entry.link_key, 16);
+    *link_key_type = entry.link_key_type;
+    return 1;
 }
 
 static void btstack_link_key_db_tlv_delete_link_key(bd_addr_t bd_addr){
-    int i;
-    for (i=0;i<NVM_NUM_LINK_KEYS;i++){
-        link_key_nvm_t entry;
-        uint32_t tag = btstack_link_key_db_tag_for_index(i);
-        int size = self->btstack_tlv_impl->get_tag(self->btstack_tlv_context, tag, (uint8_t*) &entry, sizeof(entry));
-        if (size == 0) continue;
-        if (memcmp(bd_addr, entry.bd_addr, 6)) continue;
-        // found, delete tag
-        self->btstack_tlv_impl->delete_tag(self->btstack_tlv_context, tag);
-        break;
-    }
+    uint16_t index = btstack_link_key_db_tlv_index_lookup(bd_addr);
+    if (index == INVALID_ENTRY_INDEX) return;
+    // found, delete tag
+    uint32_t tag = btstack_link_key_db_tag_for_index(index);
+    self->btstack_tlv_impl->delete_tag(self->btstack_tlv_context, tag);
+    btstack_link_key_db_tlv_index_remove(index);
 }
 
 static void btstack_link_key_db_tlv_put_link_key(bd_addr_t bd_addr, link_key_t link_key, link_key_type_t link_key_type){
-    int i;
-    uint32_t highest_seq_nr = 0;
-    uint32_t lowest_seq_nr = 0;
-    uint32_t tag_for_lowest_seq_nr = 0;
-    uint32_t tag_for_addr = 0;
-    uint32_t tag_for_empty = 0;
+    uint16_t index_to_use = btstack_link_key_db_tlv_index_lookup(bd_addr);
 
-    for (i=0;i<NVM_NUM_LINK_KEYS;i++){
-        link_key_nvm_t entry;
-        uint32_t tag = btstack_link_key_db_tag_for_index(i);
-        int size = self->btstack_tlv_impl->get_tag(self->btstack_tlv_context, tag, (uint8_t*) &entry, sizeof(entry));
-        // empty/deleted tag
-        if (size == 0) {
-            tag_for_empty = tag;
-            continue;
-        }
-        // found addr?
-        if (memcmp(bd_addr, entry.bd_addr, 6) == 0){
-            tag_for_addr = tag;
-        }
-        // update highest seq nr
-        if (entry.seq_nr > highest_seq_nr){
-            highest_seq_nr = entry.seq_nr;
-        }
-        // find entry with lowest seq nr
-        if ((tag_for_lowest_seq_nr == 0) || (entry.seq_nr < lowest_seq_nr)){
-            tag_for_lowest_seq_nr = tag;
-            lowest_seq_nr = entry.seq_nr;
+    // find empty entry or least recently used one
+    if (index_to_use == INVALID_ENTRY_INDEX){
+        uint32_t lowest_seq_nr = 0;
+        uint16_t i;
+        for (i=0;i<NVM_NUM_LINK_KEYS;i++){
+            uint32_t seq_nr = self->index[i].seq_nr;
+            if ((index_to_use == INVALID_ENTRY_INDEX) || (seq_nr < lowest_seq_nr)){
+                index_to_use = i;
+                lowest_seq_nr = seq_nr;
+            }
+            if (seq_nr == 0) break;
         }
     }
 
-    log_info("tag_for_addr %x, tag_for_empy %x, tag_for_lowest_seq_nr %x", tag_for_addr, tag_for_empty, tag_for_lowest_seq_nr);
-
-    uint32_t tag_to_use = 0;
-    if (tag_for_addr){
-        tag_to_use = tag_for_addr;
-    } else if (tag_for_empty){
-        tag_to_use = tag_for_empty;
-    } else if (tag_for_lowest_seq_nr){
-        tag_to_use = tag_for_lowest_seq_nr;
-    } else {
-        // should not happen
-        return;
-    }
-
+    uint32_t tag_to_use = btstack_link_key_db_tag_for_index(index_to_use);
     log_info("store with tag %x", tag_to_use);
 
     link_key_nvm_t entry;
@@ -169,12 +220,19 @@ static void btstack_link_key_db_tlv_put_link_key(bd_addr_t bd_addr, link_key_t l
     (void)memcpy(entry.bd_addr, bd_addr, 6);
     (void)memcpy(entry.link_key, link_key, 16);
     entry.link_key_type = link_key_type;
-    entry.seq_nr = highest_seq_nr + 1;
+    entry.seq_nr = self->highest_seq_nr + 1;
 
     int result = self->btstack_tlv_impl->store_tag(self->btstack_tlv_context, tag_to_use, (uint8_t*) &entry, sizeof(entry));
     if (result != 0){
         log_error("store link key failed");
+        return;
     }
+
+    // replace old entry (same address or evicted) in index
+    if (self->index[index_to_use].seq_nr != 0){
+        btstack_link_key_db_tlv_index_remove(index_to_use);
+    }
+    btstack_link_key_db_tlv_index_add(index_to_use, bd_addr, entry.seq_nr);
 }
 
 static int btstack_link_key_db_tlv_iterator_init(btstack_link_key_iterator_t * it){
@@ -186,6 +244,11 @@ static int  btstack_link_key_db_tlv_iterator_get_next(btstack_link_key_iterator_
     uintptr_t i = (uintptr_t) it->context;
     int found = 0;
     while (i<NVM_NUM_LINK_KEYS){
+        // skip unused entries
+        if (self->index[i].seq_nr == 0) {
+            i++;
+            continue;
+        }
         link_key_nvm_t entry;
         uint32_t tag = btstack_link_key_db_tag_for_index(i++);
         int size = self->btstack_tlv_impl->get_tag(self->btstack_tlv_context, tag, (uint8_t*) &entry, sizeof(entry));
@@ -219,6 +282,7 @@ static const btstack_link_key_db_t btstack_link_key_db_tlv = {
 const btstack_link_key_db_t * btstack_link_key_db_tlv_get_instance(const btstack_tlv_t * btstack_tlv_impl, void * btstack_tlv_context){
     self->btstack_tlv_impl = btstack_tlv_impl;
     self->btstack_tlv_context = btstack_tlv_context;
+    btstack_link_key_db_tlv_scan();
     return &btstack_link_key_db_tlv;
 }
 
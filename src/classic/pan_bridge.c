@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2020 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+#define BTSTACK_FILE__ "pan_bridge.c"
+
+/*
+ *  pan_bridge.c
+ *
+ *  Learning bridge between BNEP channels and a network interface
+ *
+ *  The bridge learns on which port, i.e. BNEP channel or network interface, a MAC address was seen last.
+ *  Unicast frames to known addresses are forwarded to that port only, frames between BNEP channels
+ *  don't pass the network interface. Broadcast, multicast and frames to unknown addresses are forwarded
+ *  to all other ports. Frames for BNEP channels are stored once and shared by all channels.
+ */
+
+#include "pan_bridge.h"
+
+#include <string.h>
+
+#include "btstack_config.h"
+#include "btstack_debug.h"
+#include "btstack_event.h"
+#include "btstack_run_loop.h"
+#include "btstack_util.h"
+#include "classic/bnep.h"
+
+// port for network interface, BNEP channels use their bnep_cid
+#define PAN_BRIDGE_PORT_NETWORK 0
+
+#define PAN_BRIDGE_ETHERNET_HEADER_SIZE 14
+
+typedef struct {
+    bd_addr_t addr;
+    uint16_t  port;
+    uint32_t  last_seen_ms;
+} pan_bridge_mac_entry_t;
+
+typedef struct {
+    bnep_shared_frame_t frame;
+    uint8_t             data[PAN_BRIDGE_MAX_FRAME_SIZE];
+} pan_bridge_frame_buffer_t;
+
+static const pan_bridge_network_t * pan_bridge_network;
+static bd_addr_t                    pan_bridge_network_address;
+static btstack_packet_handler_t     pan_bridge_client_handler;
+
+static pan_bridge_mac_entry_t       pan_bridge_mac_table[PAN_BRIDGE_MAC_TABLE_SIZE];
+static uint16_t                     pan_bridge_mac_table_count;
+
+static pan_bridge_frame_buffer_t    pan_bridge_frame_pool[PAN_BRIDGE_FRAME_POOL_SIZE];
+static uint32_t                     pan_bridge_dropped_frames;
+
+// frame from network interface is shared without copy until packet_sent
+static bnep_shared_frame_t          pan_bridge_network_frame;
+
+static pan_bridge_mac_entry_t * pan_bridge_mac_table_lookup(const uint8_t * addr){
+    uint32_t now = btstack_run_loop_get_time_ms();
+    uint16_t i;
+    for (i = 0; i < pan_bridge_mac_table_count; i++){
+        pan_bridge_mac_entry_t * entry = &pan_bridge_mac_table[i];
+        if (memcmp(entry->addr, addr, BD_ADDR_LEN) != 0) continue;
+        if ((now - entry->last_seen_ms) > PAN_BRIDGE_MAC_TABLE_TIMEOUT_MS) return NULL;
+        return entry;
+    }
+    return NULL;
+}
+
+static void pan_bridge_mac_table_remove_index(uint16_t index){
+    pan_bridge_mac_table_count--;
+    pan_bridge_mac_table[index] = pan_bridge_mac_table[pan_bridge_mac_table_count];
+}
+
+static void pan_bridge_mac_table_learn(const uint8_t * addr, uint16_t port){
+    // only unicast source addresses are valid
+    if ((addr[0] & 0x01) != 0) return;
+
+    uint32_t now = btstack_run_loop_get_time_ms();
+    uint16_t oldest = 0;
+    uint16_t i;
+    for (i = 0; i < pan_bridge_mac_table_count; i++){
+        pan_bridge_mac_entry_t * entry = &pan_bridge_mac_table[i];
+        if (memcmp(entry->addr, addr, BD_ADDR_LEN) == 0){
+            entry->port = port;
+            entry->last_seen_ms = now;
+            return;
+        }
+        if ((now - entry->last_seen_ms) > (now - pan_bridge_mac_table[oldest].last_seen_ms)){
+            oldest = i;
+        }
+    }
+    // replace oldest entry if table is full
+    if (pan_bridge_mac_table_count < PAN_BRIDGE_MAC_TABLE_SIZE){
+        i = pan_bridge_mac_table_count++;
+    } else {
+        i = oldest;
+    }
+    bd_addr_copy(pan_bridge_mac_table[i].addr, addr);
+    pan_bridge_mac_table[i].port = port;
+    pan_bridge_mac_table[i].last_seen_ms = now;
+}
+
+static void pan_bridge_mac_table_remove_port(uint16_t port){
+    uint16_t i = 0;
+    while (i < pan_bridge_mac_table_count){
+        if (pan_bridge_mac_table[i].port == port){
+            pan_bridge_mac_table_remove_index(i);
+        } else {
+            i++;
+        }
+    }
+}
+
+// @returns port for destination address or -1 if frame should be forwarded to all ports
+static int pan_bridge_port_for_destination(const uint8_t * addr_dest){
+    if ((addr_dest[0] & 0x01) != 0) return -1;
+    if (memcmp(addr_dest, pan_bridge_network_address, BD_ADDR_LEN) == 0) return PAN_BRIDGE_PORT_NETWORK;
+    pan_bridge_mac_entry_t * entry = pan_bridge_mac_table_lookup(addr_dest);
+    if (entry == NULL) return -1;
+    return entry->port;
+}
+
+static bnep_shared_frame_t * pan_bridge_frame_buffer_get(const uint8_t * packet, uint16_t size){
+    if (size > PAN_BRIDGE_MAX_FRAME_SIZE){
+        log_error("frame too large, %u bytes", size);
+        return NULL;
+    }
+    uint16_t i;
+    for (i = 0; i < PAN_BRIDGE_FRAME_POOL_SIZE; i++){
+        pan_bridge_frame_buffer_t * buffer = &pan_bridge_frame_pool[i];
+        if (buffer->frame.ref_count != 0) continue;
+        (void)memcpy(buffer->data, packet, size);
+        buffer->frame.ref_count = 1;
+        buffer->frame.len = size;
+        buffer->frame.data = buffer->data;
+        // buffer is free again when ref_count drops to zero
+        buffer->frame.release_handler = NULL;
+        return &buffer->frame;
+    }
+    pan_bridge_dropped_frames++;
+    return NULL;
+}
+
+// queue frame on channel for port or on all channels for broadcasts, frames that don't fit into queue are dropped
+static void pan_bridge_send_shared_frame(int port, bnep_shared_frame_t * frame, uint16_t exclude_bnep_cid){
+    if (port < 0){
+        uint16_t num_dropped = 0;
+        bnep_broadcast_shared_frame(frame, exclude_bnep_cid, &num_dropped);
+        pan_bridge_dropped_frames += num_dropped;
+    } else {
+        if (bnep_send_shared_frame((uint16_t) port, frame) != 0){
+            pan_bridge_dropped_frames++;
+        }
+    }
+}
+
+static void pan_bridge_handle_bnep_frame(uint16_t bnep_cid, uint8_t * packet, uint16_t size){
+    if (size < PAN_BRIDGE_ETHERNET_HEADER_SIZE) return;
+
+    pan_bridge_mac_table_learn(&packet[6], bnep_cid);
+
+    int port = pan_bridge_port_for_destination(&packet[0]);
+    if (port == bnep_cid) return;
+
+    // deliver to network interface directly
+    if ((port == PAN_BRIDGE_PORT_NETWORK) || (port < 0)){
+        (*pan_bridge_network->process_packet)(packet, size);
+        if (port == PAN_BRIDGE_PORT_NETWORK) return;
+    }
+
+    // store frame once for other channels
+    bnep_shared_frame_t * frame = pan_bridge_frame_buffer_get(packet, size);
+    if (frame == NULL) return;
+    pan_bridge_send_shared_frame(port, frame, bnep_cid);
+    bnep_shared_frame_release(frame);
+}
+
+static void pan_bridge_network_frame_released(bnep_shared_frame_t * frame){
+    UNUSED(frame);
+    (*pan_bridge_network->packet_sent)();
+}
+
+void pan_bridge_network_send_packet(const uint8_t * packet, uint16_t size){
+    if (size < PAN_BRIDGE_ETHERNET_HEADER_SIZE){
+        pan_bridge_dropped_frames++;
+        (*pan_bridge_network->packet_sent)();
+        return;
+    }
+
+    pan_bridge_mac_table_learn(&packet[6], PAN_BRIDGE_PORT_NETWORK);
+
+    int port = pan_bridge_port_for_destination(&packet[0]);
+    if (port == PAN_BRIDGE_PORT_NETWORK){
+        (*pan_bridge_network->packet_sent)();
+        return;
+    }
+
+    bnep_shared_frame_t * frame;
+    if (pan_bridge_network_frame.ref_count == 0){
+        // frame stays valid until packet_sent is called, share it without copy
+        pan_bridge_network_frame.ref_count = 1;
+        pan_bridge_network_frame.len = size;
+        pan_bridge_network_frame.data = (uint8_t *) packet;
+        pan_bridge_network_frame.release_handler = &pan_bridge_network_frame_released;
+        frame = &pan_bridge_network_frame;
+    } else {
+        // previous frame is still queued, store copy in frame pool
+        frame = pan_bridge_frame_buffer_get(packet, size);
+        if (frame == NULL){
+            (*pan_bridge_network->packet_sent)();
+            return;
+        }
+    }
+
+    pan_bridge_send_shared_frame(port, frame, 0);
+
+    bnep_shared_frame_release(frame);
+
+    // shared network frame emits packet_sent from its release handler
+    if (frame != &pan_bridge_network_frame){
+        (*pan_bridge_network->packet_sent)();
+    }
+}
+
+static void pan_bridge_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    switch (packet_type){
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case BNEP_EVENT_CHANNEL_CLOSED:
+                    pan_bridge_mac_table_remove_port(bnep_event_channel_closed_get_bnep_cid(packet));
+                    break;
+                default:
+                    break;
+            }
+            break;
+        case BNEP_DATA_PACKET:
+            pan_bridge_handle_bnep_frame(channel, packet, size);
+            break;
+        default:
+            break;
+    }
+
+    // forward events to app
+    if (packet_type != HCI_EVENT_PACKET) return;
+    if (pan_bridge_client_handler == NULL) return;
+    (*pan_bridge_client_handler)(packet_type, channel, packet, size);
+}
+
+void pan_bridge_init(const pan_bridge_network_t * network, const bd_addr_t network_address){
+    pan_bridge_network = network;
+    bd_addr_copy(pan_bridge_network_address, network_address);
+    pan_bridge_mac_table_count = 0;
+    pan_bridge_dropped_frames = 0;
+    (void)memset(pan_bridge_frame_pool, 0, sizeof(pan_bridge_frame_pool));
+    (void)memset(&pan_bridge_network_frame, 0, sizeof(pan_bridge_network_frame));
+}
+
+uint8_t pan_bridge_register_service(uint16_t service_uuid, uint16_t max_frame_size){
+    return bnep_register_service(&pan_bridge_packet_handler, service_uuid, max_frame_size);
+}
+
+void pan_bridge_register_packet_handler(btstack_packet_handler_t handler){
+    pan_bridge_client_handler = handler;
+}
+
+uint32_t pan_bridge_get_dropped_frames(void){
+    return pan_bridge_dropped_frames;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2020 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+/*
+ *  pan_bridge.h
+ *
+ *  Learning bridge between BNEP channels and a network interface
+ */
+
+#ifndef PAN_BRIDGE_H
+#define PAN_BRIDGE_H
+
+#include "btstack_config.h"
+
+#include <stdint.h>
+
+#include "bluetooth.h"
+#include "btstack_defines.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+// number of MAC addresses stored in learning table
+#ifndef PAN_BRIDGE_MAC_TABLE_SIZE
+#define PAN_BRIDGE_MAC_TABLE_SIZE 16
+#endif
+
+// learned MAC addresses expire after this time
+#ifndef PAN_BRIDGE_MAC_TABLE_TIMEOUT_MS
+#define PAN_BRIDGE_MAC_TABLE_TIMEOUT_MS 300000
+#endif
+
+// number of frame buffers for frames received via BNEP that are forwarded to other BNEP channels
+#ifndef PAN_BRIDGE_FRAME_POOL_SIZE
+#define PAN_BRIDGE_FRAME_POOL_SIZE 8
+#endif
+
+// max Ethernet frame size incl. IEEE 802.1Q tag header
+#ifndef PAN_BRIDGE_MAX_FRAME_SIZE
+#define PAN_BRIDGE_MAX_FRAME_SIZE 1518
+#endif
+
+/**
+ * Network interface connected to the bridge, e.g. TAP device or lwIP
+ */
+typedef struct {
+    /**
+     * @brief Forward Ethernet frame to network interface, e.g. btstack_network_process_packet
+     * @param packet
+     * @param size
+     */
+    void (*process_packet)(const uint8_t * packet, uint16_t size);
+
+    /**
+     * @brief Notify network interface that the frame passed to pan_bridge_network_send_packet
+     *        was forwarded and the next frame can be delivered, e.g. btstack_network_packet_sent
+     */
+    void (*packet_sent)(void);
+} pan_bridge_network_t;
+
+/* API_START */
+
+/**
+ * @brief Set up PAN Bridge
+ * @param network interface, frames to its address and broadcasts are forwarded to it
+ * @param network_address of network interface
+ */
+void pan_bridge_init(const pan_bridge_network_t * network, const bd_addr_t network_address);
+
+/**
+ * @brief Register BNEP service, same as bnep_register_service but bridge handles all BNEP channels of this service
+ * @param service_uuid e.g. BLUETOOTH_SERVICE_CLASS_NAP
+ * @param max_frame_size
+ * @return status
+ */
+uint8_t pan_bridge_register_service(uint16_t service_uuid, uint16_t max_frame_size);
+
+/**
+ * @brief Register packet handler for BNEP events, BNEP data packets are handled by the bridge
+ * @param handler
+ */
+void pan_bridge_register_packet_handler(btstack_packet_handler_t handler);
+
+/**
+ * @brief Forward Ethernet frame from network interface to BNEP channels, e.g. used as btstack_network_init callback
+ * @note Frame must stay valid until packet_sent is called. If the previous frame is still queued,
+ *       the frame is copied into the frame pool and packet_sent is called right away
+ * @param packet
+ * @param size
+ */
+void pan_bridge_network_send_packet(const uint8_t * packet, uint16_t size);
+
+/**
+ * @brief Get number of frames dropped as no frame buffer was available, the queue of a BNEP channel was full,
+ *        or the frame was invalid. A broadcast counts once for each channel that could not queue it
+ * @return count
+ */
+uint32_t pan_bridge_get_dropped_frames(void);
+
+/* API_END */
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // PAN_BRIDGE_H
@@ -83,6 +83,16 @@
 
 #define RFCOMM_CREDITS 10
 
+// interval for throughput measurement
+#define RFCOMM_STATISTICS_INTERVAL_MS 250
+
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+// max outgoing data the remote may send ahead, limits credits for large frames
+#ifndef RFCOMM_ADAPTIVE_CREDITS_MAX_BYTES
+#define RFCOMM_ADAPTIVE_CREDITS_MAX_BYTES 16384
+#endif
+#endif
+
 // FCS calc 
 #define BT_RFCOMM_CODE_WORD         0xE0 // pol = x8+x2+x1+1
 #define BT_RFCOMM_CRC_CHECK_LEN     3
@@ -188,6 +198,13 @@ static int rfcomm_channel_ready_to_send(rfcomm_channel_t * channel);
 static void rfcomm_channel_state_machine_with_channel(rfcomm_channel_t *channel, const rfcomm_channel_event_t *event, int * out_channel_valid);
 static void rfcomm_channel_state_machine_with_dlci(rfcomm_multiplexer_t * multiplexer, uint8_t dlci, const rfcomm_channel_event_t *event);
 static void rfcomm_emit_can_send_now(rfcomm_channel_t *channel);
+static int  rfcomm_channel_stream_pending(rfcomm_channel_t * channel);
+static void rfcomm_channel_stream_send(rfcomm_channel_t * channel);
+static int  rfcomm_channel_stream_writable(rfcomm_channel_t * channel);
+static int  rfcomm_channel_update_rx_statistics(rfcomm_channel_t * channel, uint16_t len);
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+static int  rfcomm_channel_adaptive_credits_update(rfcomm_channel_t * channel, int interval_complete);
+#endif
 static int rfcomm_multiplexer_ready_to_send(rfcomm_multiplexer_t * multiplexer);
 static void rfcomm_multiplexer_state_machine(rfcomm_multiplexer_t * multiplexer, RFCOMM_MULTIPLEXER_EVENT event);
 
@@ -328,6 +345,40 @@ static void rfcomm_emit_can_send_now(rfcomm_channel_t *channel) {
     (channel->packet_handler)(HCI_EVENT_PACKET, channel->rfcomm_cid, event, sizeof(event));
 }
 
+static void rfcomm_emit_channel_statistics(rfcomm_channel_t *channel) {
+    uint32_t now = btstack_run_loop_get_time_ms();
+    // include ongoing stalls
+    uint32_t tx_stall_time_ms = channel->tx_stall_time_ms;
+    if (channel->tx_stalled){
+        tx_stall_time_ms += now - channel->tx_stall_start_ms;
+    }
+    uint32_t rx_stall_time_ms = channel->rx_stall_time_ms;
+    if (channel->rx_stalled){
+        rx_stall_time_ms += now - channel->rx_stall_start_ms;
+    }
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+    uint8_t credits_target = channel->incoming_flow_control ? 0 : channel->credits_target;
+#else
+    uint8_t credits_target = channel->incoming_flow_control ? 0 : RFCOMM_CREDITS;
+#endif
+    uint8_t event[35];
+    uint8_t pos = 0;
+    event[pos++] = RFCOMM_EVENT_CHANNEL_STATISTICS;
+    event[pos++] = sizeof(event) - 2;
+    little_endian_store_16(event, pos, channel->rfcomm_cid);           pos += 2;
+    little_endian_store_32(event, pos, channel->tx_stalls);            pos += 4;
+    little_endian_store_32(event, pos, tx_stall_time_ms);              pos += 4;
+    little_endian_store_32(event, pos, channel->rx_stalls);            pos += 4;
+    little_endian_store_32(event, pos, rx_stall_time_ms);              pos += 4;
+    little_endian_store_32(event, pos, channel->credits_granted);      pos += 4;
+    little_endian_store_32(event, pos, channel->rx_bytes_per_second);  pos += 4;
+    event[pos++] = credits_target;
+    little_endian_store_16(event, pos, channel->rtt_ms);               pos += 2;
+    little_endian_store_32(event, pos, channel->rx_frames);            pos += 4;
+    hci_dump_packet( HCI_EVENT_PACKET, 0, event, sizeof(event));
+    (channel->packet_handler)(HCI_EVENT_PACKET, channel->rfcomm_cid, event, sizeof(event));
+}
+
 // MARK RFCOMM RPN DATA HELPER
 static void rfcomm_rpn_data_set_defaults(rfcomm_rpn_data_t * rpn_data){
         rpn_data->baud_rate = RPN_BAUD_9600;  /* 9600 bps */
@@ -472,6 +523,10 @@ static void rfcomm_channel_initialize(rfcomm_channel_t *channel, rfcomm_multiple
     // incoming flow control not active
     channel->new_credits_incoming  = RFCOMM_CREDITS;
     channel->incoming_flow_control = 0;
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+    channel->credits_target        = RFCOMM_CREDITS;
+#endif
+    channel->rtt_interval_min_ms   = 0xffff;
 
     channel->rls_line_status       = RFCOMM_RLS_STATUS_INVALID;
 
@@ -516,6 +571,13 @@ static void rfcomm_notify_channel_can_send(void){
     btstack_linked_list_iterator_init(&it, &rfcomm_channels);
     while (btstack_linked_list_iterator_has_next(&it)){
         rfcomm_channel_t * channel = (rfcomm_channel_t *) btstack_linked_list_iterator_next(&it);
+        if (channel->stream_buffer.storage != NULL){
+            // send data from ring buffer when l2cap is ready
+            if (rfcomm_channel_stream_pending(channel)){
+                l2cap_request_can_send_now_event(channel->multiplexer->l2cap_cid);
+            }
+            continue;
+        }
         if (!channel->waiting_for_can_send_now) continue; // didn't try to send yet
         if (!rfcomm_channel_can_send(channel)) continue;  // or cannot yet either
 
@@ -985,6 +1047,17 @@ static void rfcomm_handle_can_send_now(uint16_t l2cap_cid){
         }
     }
 
+    // forward token to channel in streaming mode with data in ring buffer
+    btstack_linked_list_iterator_init(&it, &rfcomm_channels);
+    while (!token_consumed && btstack_linked_list_iterator_has_next(&it)){
+        rfcomm_channel_t * channel = (rfcomm_channel_t *) btstack_linked_list_iterator_next(&it);
+        if (channel->multiplexer->l2cap_cid != l2cap_cid) continue;
+        if (!rfcomm_channel_stream_pending(channel)) continue;
+        log_debug("rfcomm_handle_can_send_now enter: stream token");
+        token_consumed = 1;
+        rfcomm_channel_stream_send(channel);
+    }
+
     // forward token to client
     btstack_linked_list_iterator_init(&it, &rfcomm_channels);
     while (!token_consumed && btstack_linked_list_iterator_has_next(&it)){
@@ -992,10 +1065,14 @@ static void rfcomm_handle_can_send_now(uint16_t l2cap_cid){
         if (channel->multiplexer->l2cap_cid != l2cap_cid) continue;
         // client waiting for can send now
         if (!channel->waiting_for_can_send_now)    continue;
-        if ((channel->multiplexer->fcon & 1) == 0) continue;
-        if (!channel->credits_outgoing){
-            log_debug("rfcomm_handle_can_send_now waiting to send but no credits (ignore)");
-            continue;
+        if (channel->stream_buffer.storage != NULL){
+            if (!rfcomm_channel_stream_writable(channel)) continue;
+        } else {
+            if ((channel->multiplexer->fcon & 1) == 0) continue;
+            if (!channel->credits_outgoing){
+                log_debug("rfcomm_handle_can_send_now waiting to send but no credits (ignore)");
+                continue;
+            }
         }
 
         log_debug("rfcomm_handle_can_send_now enter: client token");
@@ -1382,10 +1459,86 @@ static void rfcomm_multiplexer_state_machine(rfcomm_multiplexer_t * multiplexer,
 // MARK: RFCOMM CHANNEL
 
 static void rfcomm_channel_send_credits(rfcomm_channel_t *channel, uint8_t credits){
+    uint32_t now = btstack_run_loop_get_time_ms();
+    if (!channel->rtt_pending){
+        // measure time until first frame sent with the new credits arrives
+        channel->rtt_pending   = 1;
+        channel->rtt_start_ms  = now;
+        channel->rtt_frame_nr  = channel->rx_frames + channel->credits_incoming + 1;
+    }
+    if (channel->rx_stalled){
+        channel->rx_stalled = 0;
+        channel->rx_stall_time_ms += now - channel->rx_stall_start_ms;
+    }
     channel->credits_incoming += credits;
+    channel->credits_granted  += credits;
     rfcomm_send_uih_credits(channel->multiplexer, channel->dlci, credits);
 }
 
+// @return 1 if throughput of last interval was updated
+static int rfcomm_channel_update_rx_statistics(rfcomm_channel_t * channel, uint16_t len){
+    uint32_t now = btstack_run_loop_get_time_ms();
+    uint32_t gap_ms = now - channel->rx_last_frame_ms;
+    channel->rx_last_frame_ms = now;
+    channel->rx_frames++;
+    if (channel->rtt_pending && (channel->rx_frames == channel->rtt_frame_nr)){
+        channel->rtt_pending = 0;
+        // samples are only accurate if remote was waiting for credits, use minimum. if it had credits left, the frame
+        // follows the previous one at the usual rate and the sample only tells how long the old credits lasted.
+        // use these only without estimate or if lower, as the round-trip time can't be longer than any sample
+        uint16_t rtt_ms = (uint16_t) btstack_min(now - channel->rtt_start_ms, 0xffff);
+        int waited = (gap_ms * channel->rx_frames_per_second) > 2000u;
+        if (waited || (channel->rtt_ms == 0u) || (rtt_ms < channel->rtt_ms)){
+            channel->rtt_interval_min_ms = (uint16_t) btstack_min(channel->rtt_interval_min_ms, rtt_ms);
+        }
+    }
+    channel->rx_interval_frames++;
+    channel->rx_interval_bytes += len;
+    uint32_t elapsed_ms = now - channel->rx_interval_start_ms;
+    if (elapsed_ms < RFCOMM_STATISTICS_INTERVAL_MS) return 0;
+    channel->rx_bytes_per_second  = (uint32_t) (((uint64_t) channel->rx_interval_bytes * 1000u) / elapsed_ms);
+    channel->rx_frames_per_second = (uint16_t) btstack_min((channel->rx_interval_frames * 1000u) / elapsed_ms, 0xffff);
+    channel->rx_interval_start_ms = now;
+    channel->rx_interval_bytes    = 0;
+    channel->rx_interval_frames   = 0;
+    if (channel->rtt_interval_min_ms != 0xffff){
+        channel->rtt_ms = channel->rtt_interval_min_ms;
+        channel->rtt_interval_min_ms = 0xffff;
+    }
+    return 1;
+}
+
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+static uint8_t rfcomm_channel_adaptive_credits_max(rfcomm_channel_t * channel){
+    uint32_t max_credits = RFCOMM_ADAPTIVE_CREDITS_MAX_BYTES / channel->max_frame_size;
+    return (uint8_t) btstack_max(btstack_min(max_credits, 255), RFCOMM_CREDITS);
+}
+
+// @return 1 if new credits should be sent
+static int rfcomm_channel_adaptive_credits_update(rfcomm_channel_t * channel, int interval_complete){
+    if (interval_complete){
+        // credits for frames received during two round-trips, so remote gets new credits before it runs out.
+        // if credits limit throughput, this at most doubles the target per interval until the link is the limit
+        uint32_t target = channel->credits_target;
+        uint32_t rtt_credits = ((uint32_t) channel->rx_frames_per_second * channel->rtt_ms * 2u) / 1000u;
+        if (rtt_credits > target){
+            target = btstack_min(rtt_credits, target * 2u);
+        } else {
+            // shrink slowly
+            target = btstack_max(rtt_credits, target - (target / 4u));
+        }
+        target = btstack_max(target, RFCOMM_CREDITS);
+        channel->credits_target = (uint8_t) btstack_min(target, rfcomm_channel_adaptive_credits_max(channel));
+    }
+
+    // top up when half of the credits have been used
+    uint16_t outstanding = channel->credits_incoming + channel->new_credits_incoming;
+    if (outstanding > (channel->credits_target / 2)) return 0;
+    channel->new_credits_incoming += channel->credits_target - outstanding;
+    return 1;
+}
+#endif
+
 static int rfcomm_channel_can_send(rfcomm_channel_t * channel){
     if (!channel->credits_outgoing) return 0;
     if ((channel->multiplexer->fcon & 1) == 0) return 0;
@@ -1397,6 +1550,7 @@ static void rfcomm_channel_opened(rfcomm_channel_t *rfChannel){
     log_info("rfcomm_channel_opened!");
     
     rfChannel->state = RFCOMM_CHANNEL_OPEN;
+    rfChannel->rx_interval_start_ms = btstack_run_loop_get_time_ms();
     rfcomm_emit_channel_opened(rfChannel, 0);
     rfcomm_emit_port_configuration(rfChannel);
 
@@ -1421,6 +1575,7 @@ static void rfcomm_channel_packet_handler_uih(rfcomm_multiplexer_t *multiplexer,
     const uint8_t credit_offset = ((packet[1] & BT_RFCOMM_UIH_PF) == BT_RFCOMM_UIH_PF) ? 1 : 0;   // credits for uih_pf frames
     const uint8_t payload_offset = 3 + length_offset + credit_offset;
     int request_can_send_now = 0;
+    int interval_complete = 0;
 
     rfcomm_channel_t * channel = rfcomm_channel_for_multiplexer_and_dlci(multiplexer, frame_dlci);
     if (!channel) return;
@@ -1432,6 +1587,10 @@ static void rfcomm_channel_packet_handler_uih(rfcomm_multiplexer_t *multiplexer,
         uint16_t new_credits = packet[3+length_offset];
         channel->credits_outgoing += new_credits;
         log_info( "RFCOMM data UIH_PF, new credits channel 0x%02x: %u, now %u", channel->rfcomm_cid, new_credits, channel->credits_outgoing);
+        if (channel->tx_stalled && (new_credits > 0)){
+            channel->tx_stalled = 0;
+            channel->tx_stall_time_ms += btstack_run_loop_get_time_ms() - channel->tx_stall_start_ms;
+        }
 
         // notify channel statemachine 
         rfcomm_channel_event_t channel_event = { CH_EVT_RCVD_CREDITS, 0 };
@@ -1439,7 +1598,7 @@ static void rfcomm_channel_packet_handler_uih(rfcomm_multiplexer_t *multiplexer,
         int rfcomm_channel_valid = 1;
         rfcomm_channel_state_machine_with_channel(channel, &channel_event, &rfcomm_channel_valid);
         if (rfcomm_channel_valid){
-            if (rfcomm_channel_ready_to_send(channel) || channel->waiting_for_can_send_now){
+            if (rfcomm_channel_ready_to_send(channel) || channel->waiting_for_can_send_now || rfcomm_channel_stream_pending(channel)){
                 request_can_send_now = 1;
             }
         }        
@@ -1453,18 +1612,31 @@ static void rfcomm_channel_packet_handler_uih(rfcomm_multiplexer_t *multiplexer,
         // decrease incoming credit counter
         if (channel->credits_incoming > 0){
             channel->credits_incoming--;
+            if ((channel->credits_incoming == 0) && (channel->new_credits_incoming == 0)){
+                channel->rx_stalled = 1;
+                channel->rx_stall_start_ms = btstack_run_loop_get_time_ms();
+                channel->rx_stalls++;
+            }
         }
-        
+        interval_complete = rfcomm_channel_update_rx_statistics(channel, size-payload_offset-1);
+
         // deliver payload
         (channel->packet_handler)(RFCOMM_DATA_PACKET, channel->rfcomm_cid,
                               &packet[payload_offset], size-payload_offset-1);
     }
     
     // automatically provide new credits to remote device, if no incoming flow control
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+    if (!channel->incoming_flow_control && rfcomm_channel_adaptive_credits_update(channel, interval_complete)){
+        request_can_send_now = 1;
+    }
+#else
+    UNUSED(interval_complete);
     if (!channel->incoming_flow_control && (channel->credits_incoming < 5)){
         channel->new_credits_incoming = RFCOMM_CREDITS;
         request_can_send_now = 1;
     }    
+#endif
 
     if (request_can_send_now){
         l2cap_request_can_send_now_event(multiplexer->l2cap_cid);
@@ -2312,18 +2484,50 @@ int rfcomm_send_prepared(uint16_t rfcomm_cid, uint16_t len){
         log_error("rfcomm_send_prepared: error %d", result);
         return result;
     }
+
+    // all credits used, sender has to wait for remote
+    if (len && (channel->credits_outgoing == 0)){
+        channel->tx_stalled = 1;
+        channel->tx_stall_start_ms = btstack_run_loop_get_time_ms();
+        channel->tx_stalls++;
+    }
     
     return result;
 }
 
+static uint16_t rfcomm_channel_max_send_len(rfcomm_channel_t * channel){
+    uint16_t max_len = channel->max_frame_size;
+#ifdef RFCOMM_USE_OUTGOING_BUFFER
+    max_len = btstack_min(max_len, rfcomm_max_frame_size_for_l2cap_mtu(sizeof(outgoing_buffer)));
+#endif
+    return max_len;
+}
+
 int rfcomm_send(uint16_t rfcomm_cid, uint8_t *data, uint16_t len){
+    btstack_iovec_t iov;
+    iov.data = data;
+    iov.len  = len;
+    return rfcomm_send_iov(rfcomm_cid, &iov, 1);
+}
+
+int rfcomm_send_iov(uint16_t rfcomm_cid, const btstack_iovec_t * iov, uint8_t iov_count){
     rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
     if (!channel){
         log_error("cid 0x%02x doesn't exist!", rfcomm_cid);
         return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
     }
 
-    int err = rfcomm_assert_send_valid(channel, len);
+    uint32_t len = 0;
+    uint8_t i;
+    for (i = 0; i < iov_count; i++){
+        len += iov[i].len;
+    }
+    if (len > 0xffff){
+        log_error("rfcomm_send_iov cid 0x%02x, rfcomm data lenght exceeds MTU!", rfcomm_cid);
+        return RFCOMM_DATA_LEN_EXCEEDS_MTU;
+    }
+
+    int err = rfcomm_assert_send_valid(channel, (uint16_t) len);
     if (err) return err;
     if (!l2cap_can_send_packet_now(channel->multiplexer->l2cap_cid)){
         log_error("rfcomm_send_internal: l2cap cannot send now");
@@ -2336,8 +2540,13 @@ int rfcomm_send(uint16_t rfcomm_cid, uint8_t *data, uint16_t len){
 #endif
     uint8_t * rfcomm_payload = rfcomm_get_outgoing_buffer();
 
-    (void)memcpy(rfcomm_payload, data, len);
-    err = rfcomm_send_prepared(rfcomm_cid, len);    
+    // gather data directly in outgoing buffer
+    uint16_t pos = 0;
+    for (i = 0; i < iov_count; i++){
+        (void)memcpy(&rfcomm_payload[pos], iov[i].data, iov[i].len);
+        pos += iov[i].len;
+    }
+    err = rfcomm_send_prepared(rfcomm_cid, pos);
 
 #ifdef RFCOMM_USE_OUTGOING_BUFFER
 #else
@@ -2349,6 +2558,115 @@ int rfcomm_send(uint16_t rfcomm_cid, uint8_t *data, uint16_t len){
     return err;
 }
 
+uint8_t * rfcomm_reserve_send_buffer(uint16_t rfcomm_cid, uint16_t * out_size){
+    rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
+    if (!channel){
+        log_error("rfcomm_reserve_send_buffer cid 0x%02x doesn't exist!", rfcomm_cid);
+        return NULL;
+    }
+    if (!rfcomm_channel_can_send(channel)) return NULL;
+    if (!l2cap_can_send_packet_now(channel->multiplexer->l2cap_cid)) return NULL;
+
+#ifdef RFCOMM_USE_OUTGOING_BUFFER
+#else
+    rfcomm_reserve_packet_buffer();
+#endif
+    *out_size = rfcomm_channel_max_send_len(channel);
+    return rfcomm_get_outgoing_buffer();
+}
+
+int rfcomm_commit_send_buffer(uint16_t rfcomm_cid, uint16_t len){
+    rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
+    int err;
+    if (channel){
+        err = rfcomm_send_prepared(rfcomm_cid, len);
+    } else {
+        log_error("rfcomm_commit_send_buffer cid 0x%02x doesn't exist!", rfcomm_cid);
+        err = ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
+    }
+    if (err){
+        rfcomm_release_send_buffer(rfcomm_cid);
+    }
+    return err;
+}
+
+void rfcomm_release_send_buffer(uint16_t rfcomm_cid){
+    UNUSED(rfcomm_cid);
+#ifdef RFCOMM_USE_OUTGOING_BUFFER
+#else
+    rfcomm_release_packet_buffer();
+#endif
+}
+
+uint8_t rfcomm_enable_streaming(uint16_t rfcomm_cid, uint8_t * storage, uint32_t storage_size){
+    rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
+    if (!channel){
+        log_error("rfcomm_enable_streaming cid 0x%02x doesn't exist!", rfcomm_cid);
+        return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
+    }
+    btstack_ring_buffer_init(&channel->stream_buffer, storage, storage_size);
+    return ERROR_CODE_SUCCESS;
+}
+
+uint32_t rfcomm_stream_write(uint16_t rfcomm_cid, const uint8_t * data, uint32_t len){
+    rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
+    if (!channel){
+        log_error("rfcomm_stream_write cid 0x%02x doesn't exist!", rfcomm_cid);
+        return 0;
+    }
+    if (channel->stream_buffer.storage == NULL){
+        log_error("rfcomm_stream_write cid 0x%02x, streaming not enabled", rfcomm_cid);
+        return 0;
+    }
+    len = btstack_min(len, btstack_ring_buffer_bytes_free(&channel->stream_buffer));
+    if (len == 0) return 0;
+    (void)btstack_ring_buffer_write(&channel->stream_buffer, (uint8_t *) data, len);
+    if (rfcomm_channel_stream_pending(channel)){
+        l2cap_request_can_send_now_event(channel->multiplexer->l2cap_cid);
+    }
+    return len;
+}
+
+static int rfcomm_channel_stream_pending(rfcomm_channel_t * channel){
+    if (channel->stream_buffer.storage == NULL) return 0;
+    if (channel->state != RFCOMM_CHANNEL_OPEN) return 0;
+    if (btstack_ring_buffer_empty(&channel->stream_buffer)) return 0;
+    return rfcomm_channel_can_send(channel);
+}
+
+// notify client only when half of the ring buffer is free to batch writes
+static int rfcomm_channel_stream_writable(rfcomm_channel_t * channel){
+    return btstack_ring_buffer_bytes_free(&channel->stream_buffer) >= (channel->stream_buffer.size / 2);
+}
+
+// send frames from ring buffer as long as credits and outgoing buffers are available
+static void rfcomm_channel_stream_send(rfcomm_channel_t * channel){
+    uint16_t max_len = rfcomm_channel_max_send_len(channel);
+    while (rfcomm_channel_stream_pending(channel) && l2cap_can_send_packet_now(channel->multiplexer->l2cap_cid)){
+#ifdef RFCOMM_USE_OUTGOING_BUFFER
+#else
+        rfcomm_reserve_packet_buffer();
+#endif
+        uint8_t * rfcomm_payload = rfcomm_get_outgoing_buffer();
+        uint32_t bytes_read;
+        btstack_ring_buffer_read(&channel->stream_buffer, rfcomm_payload, max_len, &bytes_read);
+        uint16_t len = (uint16_t) bytes_read;
+        int err = rfcomm_send_prepared(channel->rfcomm_cid, len);
+        if (err){
+#ifdef RFCOMM_USE_OUTGOING_BUFFER
+#else
+            rfcomm_release_packet_buffer();
+#endif
+            log_error("rfcomm_channel_stream_send: error %d, %u bytes dropped", err, len);
+            break;
+        }
+    }
+    if (channel->waiting_for_can_send_now && rfcomm_channel_stream_writable(channel)){
+        channel->waiting_for_can_send_now = 0;
+        rfcomm_emit_can_send_now(channel);
+    }
+}
+
 // Sends Local Lnie Status, see LINE_STATUS_..
 int rfcomm_send_local_line_status(uint16_t rfcomm_cid, uint8_t line_status){
     rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
@@ -2608,6 +2926,16 @@ void rfcomm_grant_credits(uint16_t rfcomm_cid, uint8_t credits){
     l2cap_request_can_send_now_event(channel->multiplexer->l2cap_cid);
 }
 
+uint8_t rfcomm_request_channel_statistics_event(uint16_t rfcomm_cid){
+    rfcomm_channel_t * channel = rfcomm_channel_for_rfcomm_cid(rfcomm_cid);
+    if (!channel){
+        log_error("rfcomm_request_channel_statistics_event cid 0x%02x doesn't exist!", rfcomm_cid);
+        return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
+    }
+    rfcomm_emit_channel_statistics(channel);
+    return ERROR_CODE_SUCCESS;
+}
+
 #ifdef RFCOMM_USE_ERTM
 void rfcomm_enable_l2cap_ertm(void request_callback(rfcomm_ertm_request_t * request), void released_callback(uint16_t ertm_id)){
     rfcomm_ertm_request_callback  = request_callback;
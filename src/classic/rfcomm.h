@@ -45,6 +45,7 @@
 #include "btstack_util.h"
 
 #include <stdint.h>
+#include "btstack_ring_buffer.h"
 #include "btstack_run_loop.h"
 #include "gap.h"
 #include "l2cap.h"
@@ -246,7 +247,42 @@ typedef struct {
 
     //
     uint8_t   waiting_for_can_send_now;
-        
+
+    // statistics, see RFCOMM_EVENT_CHANNEL_STATISTICS
+    uint8_t  tx_stalled;
+    uint8_t  rx_stalled;
+    uint32_t tx_stall_start_ms;
+    uint32_t rx_stall_start_ms;
+    uint32_t tx_stalls;
+    uint32_t tx_stall_time_ms;
+    uint32_t rx_stalls;
+    uint32_t rx_stall_time_ms;
+    uint32_t credits_granted;
+    uint32_t rx_frames;
+    uint32_t rx_last_frame_ms;
+
+    // incoming throughput of last interval
+    uint32_t rx_interval_start_ms;
+    uint32_t rx_interval_bytes;
+    uint16_t rx_interval_frames;
+    uint16_t rx_frames_per_second;
+    uint32_t rx_bytes_per_second;
+
+    // time from providing credits until first frame sent with them is received
+    uint8_t  rtt_pending;
+    uint32_t rtt_start_ms;
+    uint32_t rtt_frame_nr;
+    uint16_t rtt_interval_min_ms;
+    uint16_t rtt_ms;
+
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+    // number of credits the remote should have
+    uint8_t  credits_target;
+#endif
+
+    // streaming mode: outgoing data is sent from ring buffer, see rfcomm_enable_streaming
+    btstack_ring_buffer_t stream_buffer;
+
 } rfcomm_channel_t;
 
 // struct used in ERTM callback
@@ -343,6 +379,15 @@ void rfcomm_decline_connection(uint16_t rfcomm_cid);
  */
 void rfcomm_grant_credits(uint16_t rfcomm_cid, uint8_t credits);
 
+/**
+ * @brief Request emission of RFCOMM_EVENT_CHANNEL_STATISTICS with stall and credit statistics for the given RFCOMM channel identifier.
+ * @note With ENABLE_RFCOMM_ADAPTIVE_CREDITS, channels without explicit credit management provide credits based on
+ *       measured throughput and round-trip time, limited by RFCOMM_ADAPTIVE_CREDITS_MAX_BYTES of outstanding data
+ * @param rfcomm_cid
+ * @return status
+ */
+uint8_t rfcomm_request_channel_statistics_event(uint16_t rfcomm_cid);
+
 /** 
  * @brief Checks if RFCOMM can send packet. 
  * @param rfcomm_cid
@@ -364,6 +409,61 @@ void rfcomm_request_can_send_now_event(uint16_t rfcomm_cid);
  */
 int  rfcomm_send(uint16_t rfcomm_cid, uint8_t *data, uint16_t len);
 
+/**
+ * @brief Sends RFCOMM data packet combined from several buffers to the RFCOMM channel with given identifier.
+ * @note Data is copied directly into the outgoing buffer. Total length must not exceed max frame size
+ * @param rfcomm_cid
+ * @param iov array of buffers
+ * @param iov_count number of buffers
+ * @return status
+ */
+int  rfcomm_send_iov(uint16_t rfcomm_cid, const btstack_iovec_t * iov, uint8_t iov_count);
+
+/**
+ * @brief Reserve outgoing buffer for RFCOMM data packet to be filled by the caller, avoids copying the data.
+ * @note Can be called on RFCOMM_EVENT_CAN_SEND_NOW or if rfcomm_can_send_packet_now returns true.
+ *       Call rfcomm_commit_send_buffer to send the data or rfcomm_release_send_buffer to drop it
+ * @param rfcomm_cid
+ * @param out_size max number of bytes that can be stored in buffer
+ * @return buffer or NULL if the channel cannot send now
+ */
+uint8_t * rfcomm_reserve_send_buffer(uint16_t rfcomm_cid, uint16_t * out_size);
+
+/**
+ * @brief Send RFCOMM data packet with len bytes stored in buffer provided by rfcomm_reserve_send_buffer
+ * @note buffer is released on error
+ * @param rfcomm_cid
+ * @param len
+ * @return status
+ */
+int  rfcomm_commit_send_buffer(uint16_t rfcomm_cid, uint16_t len);
+
+/**
+ * @brief Release buffer provided by rfcomm_reserve_send_buffer without sending it
+ * @param rfcomm_cid
+ */
+void rfcomm_release_send_buffer(uint16_t rfcomm_cid);
+
+/**
+ * @brief Enable streaming mode for RFCOMM channel: data written with rfcomm_stream_write is stored in a ring buffer
+ *        and sent in frames of max frame size as long as credits and outgoing buffers are available.
+ * @note If requested, RFCOMM_EVENT_CAN_SEND_NOW is emitted when at least half of the ring buffer is free
+ * @param rfcomm_cid
+ * @param storage for ring buffer, needs to stay valid until channel is closed
+ * @param storage_size
+ * @return status
+ */
+uint8_t rfcomm_enable_streaming(uint16_t rfcomm_cid, uint8_t * storage, uint32_t storage_size);
+
+/**
+ * @brief Store data in ring buffer of RFCOMM channel in streaming mode
+ * @param rfcomm_cid
+ * @param data
+ * @param len
+ * @return number of bytes stored, might be less than len if ring buffer is full
+ */
+uint32_t rfcomm_stream_write(uint16_t rfcomm_cid, const uint8_t * data, uint32_t len);
+
 /** 
  * @brief Sends Local Line Status, see LINE_STATUS_..
  * @param rfcomm_cid
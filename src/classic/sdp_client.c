@@ -46,6 +46,8 @@
 #include "bluetooth_sdp.h"
 #include "btstack_debug.h"
 #include "btstack_event.h"
+#include "btstack_linked_list.h"
+#include "btstack_run_loop.h"
 #include "classic/core.h"
 #include "classic/sdp_client.h"
 #include "classic/sdp_server.h"
@@ -65,9 +67,106 @@ typedef enum {
 
 // Types SDP Client 
 typedef enum {
-    INIT, W4_CONNECT, W2_SEND, W4_RESPONSE, QUERY_COMPLETE
-} sdp_client_state_t;
+    SDP_CLIENT_CONNECTION_FREE = 0,
+    SDP_CLIENT_CONNECTION_W4_CONNECT,
+    SDP_CLIENT_CONNECTION_IDLE,
+    SDP_CLIENT_CONNECTION_W2_SEND,
+    SDP_CLIENT_CONNECTION_W4_RESPONSE,
+    SDP_CLIENT_CONNECTION_W4_DISCONNECT,
+} sdp_client_connection_state_t;
 
+typedef enum {
+    SDP_CLIENT_QUERY_FREE = 0,
+    SDP_CLIENT_QUERY_QUEUED,
+    SDP_CLIENT_QUERY_ACTIVE,
+    SDP_CLIENT_QUERY_FAILED,
+#ifdef ENABLE_SDP_CLIENT_CACHE
+    SDP_CLIENT_QUERY_CACHED,
+#endif
+} sdp_client_query_state_t;
+
+// search patterns are copied as sdp_service_search_pattern_for_uuid16/128 use a global buffer
+#define SDP_CLIENT_SEARCH_PATTERN_STORAGE_SIZE 24
+
+#ifdef ENABLE_SDP_CLIENT_CACHE
+#ifndef SDP_CLIENT_CACHE_SIZE
+#define SDP_CLIENT_CACHE_SIZE 4
+#endif
+#ifndef SDP_CLIENT_CACHE_DATA_SIZE
+#define SDP_CLIENT_CACHE_DATA_SIZE 256
+#endif
+#ifndef SDP_CLIENT_CACHE_TTL_MS
+#define SDP_CLIENT_CACHE_TTL_MS 60000
+#endif
+// pdu id, search pattern or service record handle, attribute id list
+#define SDP_CLIENT_CACHE_KEY_SIZE 48
+#endif
+
+// State SDP Parser
+typedef struct {
+    de_state_t de_header_state;
+    sdp_parser_state_t state;
+    uint16_t attribute_id;
+    uint16_t attribute_bytes_received;
+    uint16_t attribute_bytes_delivered;
+    uint16_t list_offset;
+    uint16_t list_size;
+    uint16_t record_offset;
+    uint16_t record_size;
+    uint16_t attribute_value_size;
+    int      record_counter;
+    btstack_packet_handler_t callback;
+    // passed as channel to callback
+    uint16_t query_id;
+} sdp_parser_t;
+
+// State SDP Query
+typedef struct {
+    btstack_linked_item_t item;
+    sdp_client_query_state_t state;
+    uint16_t id;
+    bd_addr_t remote;
+    // expected response
+    SDP_PDU_ID_t pdu_id;
+    const uint8_t * service_search_pattern;
+    uint8_t service_search_pattern_storage[SDP_CLIENT_SEARCH_PATTERN_STORAGE_SIZE];
+    const uint8_t * attribute_id_list;
+#ifdef ENABLE_SDP_EXTRA_QUERIES
+    uint32_t service_record_handle;
+#endif
+    uint8_t status;
+    sdp_parser_t parser;
+} sdp_client_query_t;
+
+// State SDP Client connection
+typedef struct {
+    sdp_client_connection_state_t state;
+    bd_addr_t remote;
+    uint16_t  l2cap_cid;
+    uint16_t  mtu;
+    uint16_t  transaction_id;
+    uint8_t   continuation_state[16];
+    uint8_t   continuation_state_len;
+    sdp_client_query_t * query;
+#ifdef ENABLE_SDP_CLIENT_CACHE
+    // attribute lists received for current query
+    uint8_t   cache_data[SDP_CLIENT_CACHE_DATA_SIZE];
+    uint16_t  cache_data_len;
+    uint8_t   cache_data_overrun;
+#endif
+} sdp_client_connection_t;
+
+#ifdef ENABLE_SDP_CLIENT_CACHE
+typedef struct {
+    uint8_t   valid;
+    bd_addr_t remote;
+    uint32_t  time_ms;
+    uint8_t   key[SDP_CLIENT_CACHE_KEY_SIZE];
+    uint16_t  key_len;
+    uint8_t   data[SDP_CLIENT_CACHE_DATA_SIZE];
+    uint16_t  data_len;
+} sdp_client_cache_entry_t;
+#endif
 
 // Prototypes SDP Parser
 void sdp_parser_init(btstack_packet_handler_t callback);
@@ -80,47 +179,31 @@ void sdp_parser_handle_service_search(uint8_t * data, uint16_t total_count, uint
 // Prototypes SDP Client
 void sdp_client_reset(void);
 void sdp_client_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size);
-static uint16_t sdp_client_setup_service_search_attribute_request(uint8_t * data);
+static uint16_t sdp_client_setup_service_search_attribute_request(sdp_client_connection_t * connection, uint8_t * data);
 #ifdef ENABLE_SDP_EXTRA_QUERIES
-static uint16_t sdp_client_setup_service_search_request(uint8_t * data);
-static uint16_t sdp_client_setup_service_attribute_request(uint8_t * data);
-static void     sdp_client_parse_service_search_response(uint8_t* packet, uint16_t size);
-static void     sdp_client_parse_service_attribute_response(uint8_t* packet, uint16_t size);
+static uint16_t sdp_client_setup_service_search_request(sdp_client_connection_t * connection, uint8_t * data);
+static uint16_t sdp_client_setup_service_attribute_request(sdp_client_connection_t * connection, uint8_t * data);
+static void     sdp_client_parse_service_search_response(sdp_client_connection_t * connection, uint8_t* packet, uint16_t size);
+static void     sdp_client_parse_service_attribute_response(sdp_client_connection_t * connection, uint8_t* packet, uint16_t size);
 #endif
 
 static uint8_t des_attributeIDList[] = { 0x35, 0x05, 0x0A, 0x00, 0x00, 0xff, 0xff};  // Attribute: 0x0000 - 0xffff
 
-// State DES Parser
-static de_state_t de_header_state;
-
-// State SDP Parser
-static sdp_parser_state_t  state = GET_LIST_LENGTH;
-static uint16_t attribute_id = 0;
-static uint16_t attribute_bytes_received = 0;
-static uint16_t attribute_bytes_delivered = 0;
-static uint16_t list_offset = 0;
-static uint16_t list_size;
-static uint16_t record_offset = 0;
-static uint16_t record_size;
-static uint16_t attribute_value_size;
-static int record_counter = 0;
-static btstack_packet_handler_t sdp_parser_callback;
-
 // State SDP Client
-static uint16_t  mtu;
-static uint16_t  sdp_cid = 0x40;
-static const uint8_t * service_search_pattern;
-static const uint8_t * attribute_id_list;
-static uint16_t  transactionID = 0;
-static uint8_t   continuationState[16];
-static uint8_t   continuationStateLen;
-static sdp_client_state_t sdp_client_state = INIT;
-static SDP_PDU_ID_t PDU_ID = SDP_Invalid;
-#ifdef ENABLE_SDP_EXTRA_QUERIES
-static uint32_t serviceRecordHandle;
-static uint32_t record_handle;
+static sdp_client_connection_t sdp_client_connections[SDP_CLIENT_MAX_CONNECTIONS];
+static sdp_client_query_t      sdp_client_query_storage[SDP_CLIENT_MAX_QUERIES];
+static btstack_linked_list_t   sdp_client_queries;
+static uint16_t                sdp_client_query_id;
+
+#ifdef ENABLE_SDP_CLIENT_CACHE
+static sdp_client_cache_entry_t sdp_client_cache[SDP_CLIENT_CACHE_SIZE];
+static btstack_timer_source_t   sdp_client_cache_timer;
 #endif
 
+// parser used by sdp_parser_* functions called by test/sdp_client: standalone or of last started query
+static sdp_parser_t   sdp_parser_standalone;
+static sdp_parser_t * sdp_parser_current = &sdp_parser_standalone;
+
 // DES Parser
 void de_state_init(de_state_t * de_state){
     de_state->in_state_GET_DE_HEADER_LENGTH = 1;
@@ -157,102 +240,103 @@ int de_state_size(uint8_t eventByte, de_state_t *de_state){
     return 1;
 }
 
+
 // SDP Parser
-static void sdp_parser_emit_value_byte(uint8_t event_byte){
+static void sdp_parser_emit_value_byte(sdp_parser_t * parser, uint8_t event_byte){
     uint8_t event[11];
     event[0] = SDP_EVENT_QUERY_ATTRIBUTE_VALUE;
     event[1] = 9;
-    little_endian_store_16(event, 2, record_counter);
-    little_endian_store_16(event, 4, attribute_id);
-    little_endian_store_16(event, 6, attribute_value_size);
-    little_endian_store_16(event, 8, attribute_bytes_delivered);
+    little_endian_store_16(event, 2, parser->record_counter);
+    little_endian_store_16(event, 4, parser->attribute_id);
+    little_endian_store_16(event, 6, parser->attribute_value_size);
+    little_endian_store_16(event, 8, parser->attribute_bytes_delivered);
     event[10] = event_byte;
-    (*sdp_parser_callback)(HCI_EVENT_PACKET, 0, event, sizeof(event)); 
+    (*parser->callback)(HCI_EVENT_PACKET, parser->query_id, event, sizeof(event)); 
 }
 
-static void sdp_parser_process_byte(uint8_t eventByte){
+static void sdp_parser_process_byte(sdp_parser_t * parser, uint8_t eventByte){
     // count all bytes
-    list_offset++;
-    record_offset++;
+    parser->list_offset++;
+    parser->record_offset++;
 
     // log_info(" parse BYTE_RECEIVED %02x", eventByte);
-    switch(state){
+    switch(parser->state){
         case GET_LIST_LENGTH:
-            if (!de_state_size(eventByte, &de_header_state)) break;
-            list_offset = de_header_state.de_offset;
-            list_size = de_header_state.de_size;
+            if (!de_state_size(eventByte, &parser->de_header_state)) break;
+            parser->list_offset = parser->de_header_state.de_offset;
+            parser->list_size = parser->de_header_state.de_size;
             // log_info("parser: List offset %u, list size %u", list_offset, list_size);
             
-            record_counter = 0;
-            state = GET_RECORD_LENGTH;
+            parser->record_counter = 0;
+            parser->state = GET_RECORD_LENGTH;
             break;
 
         case GET_RECORD_LENGTH:
             // check size
-            if (!de_state_size(eventByte, &de_header_state)) break;
+            if (!de_state_size(eventByte, &parser->de_header_state)) break;
             // log_info("parser: Record payload is %d bytes.", de_header_state.de_size);
-            record_offset = de_header_state.de_offset;
-            record_size = de_header_state.de_size;
-            state = GET_ATTRIBUTE_ID_HEADER_LENGTH;
+            parser->record_offset = parser->de_header_state.de_offset;
+            parser->record_size = parser->de_header_state.de_size;
+            parser->state = GET_ATTRIBUTE_ID_HEADER_LENGTH;
             break;
 
         case GET_ATTRIBUTE_ID_HEADER_LENGTH:
-            if (!de_state_size(eventByte, &de_header_state)) break;
-            attribute_id = 0;
-            log_debug("ID data is stored in %d bytes.", (int) de_header_state.de_size);
-            state = GET_ATTRIBUTE_ID;
+            if (!de_state_size(eventByte, &parser->de_header_state)) break;
+            parser->attribute_id = 0;
+            log_debug("ID data is stored in %d bytes.", (int) parser->de_header_state.de_size);
+            parser->state = GET_ATTRIBUTE_ID;
             break;
         
         case GET_ATTRIBUTE_ID:
-            attribute_id = (attribute_id << 8) | eventByte;
-            de_header_state.de_size--;
-            if (de_header_state.de_size > 0) break;
-            log_debug("parser: Attribute ID: %04x.", attribute_id);
-
-            state = GET_ATTRIBUTE_VALUE_LENGTH;
-            attribute_bytes_received  = 0;
-            attribute_bytes_delivered = 0;
-            attribute_value_size      = 0;
-            de_state_init(&de_header_state);
+            parser->attribute_id = (parser->attribute_id << 8) | eventByte;
+            parser->de_header_state.de_size--;
+            if (parser->de_header_state.de_size > 0) break;
+            log_debug("parser: Attribute ID: %04x.", parser->attribute_id);
+
+            parser->state = GET_ATTRIBUTE_VALUE_LENGTH;
+            parser->attribute_bytes_received  = 0;
+            parser->attribute_bytes_delivered = 0;
+            parser->attribute_value_size      = 0;
+            de_state_init(&parser->de_header_state);
             break;
         
         case GET_ATTRIBUTE_VALUE_LENGTH:
-            attribute_bytes_received++;
-            sdp_parser_emit_value_byte(eventByte);
-            attribute_bytes_delivered++;
-            if (!de_state_size(eventByte, &de_header_state)) break;
+            parser->attribute_bytes_received++;
+            sdp_parser_emit_value_byte(parser, eventByte);
+            parser->attribute_bytes_delivered++;
+            if (!de_state_size(eventByte, &parser->de_header_state)) break;
 
-            attribute_value_size = de_header_state.de_size + attribute_bytes_received;
+            parser->attribute_value_size = parser->de_header_state.de_size + parser->attribute_bytes_received;
 
-            state = GET_ATTRIBUTE_VALUE;
+            parser->state = GET_ATTRIBUTE_VALUE;
             break;
         
         case GET_ATTRIBUTE_VALUE: 
-            attribute_bytes_received++;
-            sdp_parser_emit_value_byte(eventByte);
-            attribute_bytes_delivered++;
+            parser->attribute_bytes_received++;
+            sdp_parser_emit_value_byte(parser, eventByte);
+            parser->attribute_bytes_delivered++;
             // log_debug("paser: attribute_bytes_received %u, attribute_value_size %u", attribute_bytes_received, attribute_value_size);
 
-            if (attribute_bytes_received < attribute_value_size) break;
+            if (parser->attribute_bytes_received < parser->attribute_value_size) break;
             // log_debug("parser: Record offset %u, record size %u", record_offset, record_size);
-            if (record_offset != record_size){
-                state = GET_ATTRIBUTE_ID_HEADER_LENGTH;
+            if (parser->record_offset != parser->record_size){
+                parser->state = GET_ATTRIBUTE_ID_HEADER_LENGTH;
                 // log_debug("Get next attribute");
                 break;
             } 
-            record_offset = 0;
+            parser->record_offset = 0;
             // log_debug("parser: List offset %u, list size %u", list_offset, list_size);
             
-            if ((list_size > 0) && (list_offset != list_size)){
-                record_counter++;
-                state = GET_RECORD_LENGTH;
+            if ((parser->list_size > 0) && (parser->list_offset != parser->list_size)){
+                parser->record_counter++;
+                parser->state = GET_RECORD_LENGTH;
                 log_debug("parser: END_OF_RECORD");
                 break;
             }
-            list_offset = 0;
-            de_state_init(&de_header_state);
-            state = GET_LIST_LENGTH;
-            record_counter = 0;
+            parser->list_offset = 0;
+            de_state_init(&parser->de_header_state);
+            parser->state = GET_LIST_LENGTH;
+            parser->record_counter = 0;
             log_debug("parser: END_OF_RECORD & DONE");
             break;
         default:
@@ -260,103 +344,418 @@ static void sdp_parser_process_byte(uint8_t eventByte){
     }
 }
 
-void sdp_parser_init(btstack_packet_handler_t callback){
-    // init
-    sdp_parser_callback = callback;
-    de_state_init(&de_header_state);
-    state = GET_LIST_LENGTH;
-    list_offset = 0;
-    record_offset = 0;
-    record_counter = 0;
+static void sdp_parser_reset(sdp_parser_t * parser, btstack_packet_handler_t callback, uint16_t query_id){
+    parser->callback = callback;
+    parser->query_id = query_id;
+    de_state_init(&parser->de_header_state);
+    parser->state = GET_LIST_LENGTH;
+    parser->list_offset = 0;
+    parser->record_offset = 0;
+    parser->record_counter = 0;
 }
 
-void sdp_parser_handle_chunk(uint8_t * data, uint16_t size){
+static void sdp_parser_process_chunk(sdp_parser_t * parser, const uint8_t * data, uint16_t size){
     int i;
     for (i=0;i<size;i++){
-        sdp_parser_process_byte(data[i]);
+        sdp_parser_process_byte(parser, data[i]);
     }
 }
 
 #ifdef ENABLE_SDP_EXTRA_QUERIES
-void sdp_parser_init_service_attribute_search(void){
-    // init
-    de_state_init(&de_header_state);
-    state = GET_RECORD_LENGTH;
-    list_offset = 0;
-    record_offset = 0;
-    record_counter = 0;
-}
-
-void sdp_parser_init_service_search(void){
-    record_offset = 0;
+static void sdp_parser_reset_service_attribute_search(sdp_parser_t * parser){
+    de_state_init(&parser->de_header_state);
+    parser->state = GET_RECORD_LENGTH;
+    parser->list_offset = 0;
+    parser->record_offset = 0;
+    parser->record_counter = 0;
 }
 
-void sdp_parser_handle_service_search(uint8_t * data, uint16_t total_count, uint16_t record_handle_count){
+static void sdp_parser_process_service_search(sdp_parser_t * parser, const uint8_t * data, uint16_t total_count, uint16_t record_handle_count){
     int i;
     for (i=0;i<record_handle_count;i++){
-        record_handle = big_endian_read_32(data, i*4);
-        record_counter++;
+        uint32_t record_handle = big_endian_read_32(data, i*4);
+        parser->record_counter++;
         uint8_t event[10];
         event[0] = SDP_EVENT_QUERY_SERVICE_RECORD_HANDLE;
         event[1] = 8;
         little_endian_store_16(event, 2, total_count);
-        little_endian_store_16(event, 4, record_counter);
+        little_endian_store_16(event, 4, parser->record_counter);
         little_endian_store_32(event, 6, record_handle);
-        (*sdp_parser_callback)(HCI_EVENT_PACKET, 0, event, sizeof(event)); 
+        (*parser->callback)(HCI_EVENT_PACKET, parser->query_id, event, sizeof(event)); 
     }        
 }
 #endif
 
-void sdp_parser_handle_done(uint8_t status){
+static void sdp_parser_emit_done(btstack_packet_handler_t callback, uint16_t query_id, uint8_t status){
     uint8_t event[3];
     event[0] = SDP_EVENT_QUERY_COMPLETE;
     event[1] = 1;
     event[2] = status;
-    (*sdp_parser_callback)(HCI_EVENT_PACKET, 0, event, sizeof(event)); 
+    (*callback)(HCI_EVENT_PACKET, query_id, event, sizeof(event)); 
 }
 
-// SDP Client
+// SDP Parser - called by test/sdp_client
+void sdp_parser_init(btstack_packet_handler_t callback){
+    sdp_parser_current = &sdp_parser_standalone;
+    sdp_parser_reset(sdp_parser_current, callback, 0);
+}
+
+void sdp_parser_handle_chunk(uint8_t * data, uint16_t size){
+    sdp_parser_process_chunk(sdp_parser_current, data, size);
+}
+
+#ifdef ENABLE_SDP_EXTRA_QUERIES
+void sdp_parser_init_service_attribute_search(void){
+    sdp_parser_reset_service_attribute_search(sdp_parser_current);
+}
+
+void sdp_parser_init_service_search(void){
+    sdp_parser_current->record_offset = 0;
+}
+
+void sdp_parser_handle_service_search(uint8_t * data, uint16_t total_count, uint16_t record_handle_count){
+    sdp_parser_process_service_search(sdp_parser_current, data, total_count, record_handle_count);
+}
+#endif
+
+void sdp_parser_handle_done(uint8_t status){
+    sdp_parser_emit_done(sdp_parser_current->callback, sdp_parser_current->query_id, status);
+}
+
+// SDP Client - Queries
+
+static sdp_client_query_t * sdp_client_query_alloc(void){
+    int i;
+    for (i=0;i<SDP_CLIENT_MAX_QUERIES;i++){
+        sdp_client_query_t * query = &sdp_client_query_storage[i];
+        if (query->state == SDP_CLIENT_QUERY_FREE) return query;
+    }
+    return NULL;
+}
+
+static sdp_client_query_t * sdp_client_query_for_state(sdp_client_query_state_t state){
+    btstack_linked_list_iterator_t it;
+    btstack_linked_list_iterator_init(&it, &sdp_client_queries);
+    while (btstack_linked_list_iterator_has_next(&it)){
+        sdp_client_query_t * query = (sdp_client_query_t *) btstack_linked_list_iterator_next(&it);
+        if (query->state == state) return query;
+    }
+    return NULL;
+}
+
+static void sdp_client_query_finalize(sdp_client_query_t * query, uint8_t status){
+    // free query before emitting done, so that the callback can start a new query
+    btstack_packet_handler_t callback = query->parser.callback;
+    uint16_t query_id = query->id;
+    btstack_linked_list_remove(&sdp_client_queries, (btstack_linked_item_t *) query);
+    query->state = SDP_CLIENT_QUERY_FREE;
+    sdp_parser_emit_done(callback, query_id, status);
+}
+
+static void sdp_client_fail_queries_for_remote(const bd_addr_t remote, uint8_t status){
+    btstack_linked_list_iterator_t it;
+    btstack_linked_list_iterator_init(&it, &sdp_client_queries);
+    while (btstack_linked_list_iterator_has_next(&it)){
+        sdp_client_query_t * query = (sdp_client_query_t *) btstack_linked_list_iterator_next(&it);
+        if (query->state != SDP_CLIENT_QUERY_QUEUED) continue;
+        if (bd_addr_cmp(query->remote, remote) != 0) continue;
+        query->state  = SDP_CLIENT_QUERY_FAILED;
+        query->status = status;
+    }
+}
+
+static void sdp_client_handle_failed_queries(void){
+    while (true){
+        sdp_client_query_t * query = sdp_client_query_for_state(SDP_CLIENT_QUERY_FAILED);
+        if (query == NULL) return;
+        sdp_client_query_finalize(query, query->status);
+    }
+}
+
+// SDP Client - Result Cache
+
+#ifdef ENABLE_SDP_CLIENT_CACHE
+static uint16_t sdp_client_cache_key(const sdp_client_query_t * query, uint8_t * key){
+    // only responses with attribute lists are cached
+    uint16_t service_search_pattern_len = 0;
+    uint16_t key_len = 1;
+    switch (query->pdu_id){
+        case SDP_ServiceSearchAttributeResponse:
+            service_search_pattern_len = de_get_len(query->service_search_pattern);
+            key_len += service_search_pattern_len;
+            break;
+#ifdef ENABLE_SDP_EXTRA_QUERIES
+        case SDP_ServiceAttributeResponse:
+            key_len += 4;
+            break;
+#endif
+        default:
+            return 0;
+    }
+    uint16_t attribute_id_list_len = de_get_len(query->attribute_id_list);
+    key_len += attribute_id_list_len;
+    if (key_len > SDP_CLIENT_CACHE_KEY_SIZE) return 0;
+
+    uint16_t pos = 0;
+    key[pos++] = (uint8_t) query->pdu_id;
+    if (service_search_pattern_len > 0){
+        (void)memcpy(&key[pos], query->service_search_pattern, service_search_pattern_len);
+        pos += service_search_pattern_len;
+    }
+#ifdef ENABLE_SDP_EXTRA_QUERIES
+    if (query->pdu_id == SDP_ServiceAttributeResponse){
+        big_endian_store_32(key, pos, query->service_record_handle);
+        pos += 4;
+    }
+#endif
+    (void)memcpy(&key[pos], query->attribute_id_list, attribute_id_list_len);
+    return key_len;
+}
+
+static sdp_client_cache_entry_t * sdp_client_cache_lookup(const sdp_client_query_t * query){
+    uint8_t key[SDP_CLIENT_CACHE_KEY_SIZE];
+    uint16_t key_len = sdp_client_cache_key(query, key);
+    if (key_len == 0) return NULL;
+    uint32_t now = btstack_run_loop_get_time_ms();
+    int i;
+    for (i=0;i<SDP_CLIENT_CACHE_SIZE;i++){
+        sdp_client_cache_entry_t * entry = &sdp_client_cache[i];
+        if (entry->valid == 0) continue;
+        if (btstack_time_delta(now, entry->time_ms) > SDP_CLIENT_CACHE_TTL_MS){
+            entry->valid = 0;
+            continue;
+        }
+        if (bd_addr_cmp(entry->remote, query->remote) != 0) continue;
+        if (entry->key_len != key_len) continue;
+        if (memcmp(entry->key, key, key_len) != 0) continue;
+        return entry;
+    }
+    return NULL;
+}
+
+static void sdp_client_cache_store(const sdp_client_connection_t * connection){
+    const sdp_client_query_t * query = connection->query;
+    if (connection->cache_data_overrun) return;
+    uint8_t key[SDP_CLIENT_CACHE_KEY_SIZE];
+    uint16_t key_len = sdp_client_cache_key(query, key);
+    if (key_len == 0) return;
+
+    // replace entry for same query, unused entry, or oldest entry
+    sdp_client_cache_entry_t * entry = NULL;
+    int i;
+    for (i=0;i<SDP_CLIENT_CACHE_SIZE;i++){
+        sdp_client_cache_entry_t * candidate = &sdp_client_cache[i];
+        if (candidate->valid && (bd_addr_cmp(candidate->remote, query->remote) == 0) &&
+            (candidate->key_len == key_len) && (memcmp(candidate->key, key, key_len) == 0)){
+            entry = candidate;
+            break;
+        }
+        if (entry == NULL){
+            entry = candidate;
+        } else if (entry->valid && ((candidate->valid == 0) || (btstack_time_delta(candidate->time_ms, entry->time_ms) < 0))){
+            entry = candidate;
+        }
+    }
+
+    entry->valid = 1;
+    (void)memcpy(entry->remote, query->remote, 6);
+    entry->time_ms = btstack_run_loop_get_time_ms();
+    (void)memcpy(entry->key, key, key_len);
+    entry->key_len = key_len;
+    (void)memcpy(entry->data, connection->cache_data, connection->cache_data_len);
+    entry->data_len = connection->cache_data_len;
+}
+
+static void sdp_client_run(void);
+
+static void sdp_client_cache_timer_handler(btstack_timer_source_t * ts){
+    UNUSED(ts);
+    while (true){
+        sdp_client_query_t * query = sdp_client_query_for_state(SDP_CLIENT_QUERY_CACHED);
+        if (query == NULL) break;
+        sdp_client_cache_entry_t * entry = sdp_client_cache_lookup(query);
+        if (entry == NULL){
+            // expired or removed in the meantime
+            query->state = SDP_CLIENT_QUERY_QUEUED;
+            continue;
+        }
+        log_info("SDP Client query %u answered from cache", query->id);
+        query->state = SDP_CLIENT_QUERY_ACTIVE;
+#ifdef ENABLE_SDP_EXTRA_QUERIES
+        if (query->pdu_id == SDP_ServiceAttributeResponse){
+            sdp_parser_reset_service_attribute_search(&query->parser);
+        }
+#endif
+        sdp_parser_process_chunk(&query->parser, entry->data, entry->data_len);
+        sdp_client_query_finalize(query, ERROR_CODE_SUCCESS);
+    }
+    sdp_client_run();
+    sdp_client_handle_failed_queries();
+}
+
+static bool sdp_client_cache_handle_query(sdp_client_query_t * query){
+    if (sdp_client_cache_lookup(query) == NULL) return false;
+    // results are delivered from the run loop as for a remote query
+    query->state = SDP_CLIENT_QUERY_CACHED;
+    btstack_run_loop_remove_timer(&sdp_client_cache_timer);
+    btstack_run_loop_set_timer_handler(&sdp_client_cache_timer, &sdp_client_cache_timer_handler);
+    btstack_run_loop_set_timer(&sdp_client_cache_timer, 0);
+    btstack_run_loop_add_timer(&sdp_client_cache_timer);
+    return true;
+}
+
+static void sdp_client_cache_add_data(sdp_client_connection_t * connection, const uint8_t * data, uint16_t size){
+    if (connection->cache_data_overrun) return;
+    if ((connection->cache_data_len + size) > SDP_CLIENT_CACHE_DATA_SIZE){
+        connection->cache_data_overrun = 1;
+        return;
+    }
+    (void)memcpy(&connection->cache_data[connection->cache_data_len], data, size);
+    connection->cache_data_len += size;
+}
+#endif
+
+// SDP Client - Connections
+
+static sdp_client_connection_t * sdp_client_connection_for_cid(uint16_t l2cap_cid){
+    int i;
+    for (i=0;i<SDP_CLIENT_MAX_CONNECTIONS;i++){
+        sdp_client_connection_t * connection = &sdp_client_connections[i];
+        if (connection->state == SDP_CLIENT_CONNECTION_FREE) continue;
+        if (connection->l2cap_cid == l2cap_cid) return connection;
+    }
+    return NULL;
+}
+
+static sdp_client_connection_t * sdp_client_connection_for_remote(const bd_addr_t remote){
+    int i;
+    for (i=0;i<SDP_CLIENT_MAX_CONNECTIONS;i++){
+        sdp_client_connection_t * connection = &sdp_client_connections[i];
+        if (connection->state == SDP_CLIENT_CONNECTION_FREE) continue;
+        if (bd_addr_cmp(connection->remote, remote) == 0) return connection;
+    }
+    return NULL;
+}
+
+static sdp_client_connection_t * sdp_client_connection_alloc(void){
+    int i;
+    for (i=0;i<SDP_CLIENT_MAX_CONNECTIONS;i++){
+        sdp_client_connection_t * connection = &sdp_client_connections[i];
+        if (connection->state == SDP_CLIENT_CONNECTION_FREE) return connection;
+    }
+    return NULL;
+}
+
+static void sdp_client_connection_start_query(sdp_client_connection_t * connection, sdp_client_query_t * query){
+    query->state = SDP_CLIENT_QUERY_ACTIVE;
+    connection->query = query;
+    connection->continuation_state_len = 0;
+#ifdef ENABLE_SDP_CLIENT_CACHE
+    connection->cache_data_len = 0;
+    connection->cache_data_overrun = 0;
+#endif
+    if (connection->state == SDP_CLIENT_CONNECTION_IDLE){
+        connection->state = SDP_CLIENT_CONNECTION_W2_SEND;
+        l2cap_request_can_send_now_event(connection->l2cap_cid);
+    }
+}
+
+// start queued queries in order, queries for a remote device share its L2CAP channel one after the other
+static void sdp_client_run(void){
+    btstack_linked_list_iterator_t it;
+    btstack_linked_list_iterator_init(&it, &sdp_client_queries);
+    while (btstack_linked_list_iterator_has_next(&it)){
+        sdp_client_query_t * query = (sdp_client_query_t *) btstack_linked_list_iterator_next(&it);
+        if (query->state != SDP_CLIENT_QUERY_QUEUED) continue;
+
+        sdp_client_connection_t * connection = sdp_client_connection_for_remote(query->remote);
+        if (connection != NULL){
+            if (connection->state == SDP_CLIENT_CONNECTION_IDLE){
+                log_debug("SDP Client query %u reuses cid 0x%04x", query->id, connection->l2cap_cid);
+                sdp_client_connection_start_query(connection, query);
+            }
+            continue;
+        }
+
+        connection = sdp_client_connection_alloc();
+        if (connection == NULL) continue;
+
+        uint8_t status = l2cap_create_channel(&sdp_client_packet_handler, query->remote, BLUETOOTH_PSM_SDP, l2cap_max_mtu(), &connection->l2cap_cid);
+        if (status != ERROR_CODE_SUCCESS){
+            query->state  = SDP_CLIENT_QUERY_FAILED;
+            query->status = status;
+            continue;
+        }
+        connection->state = SDP_CLIENT_CONNECTION_W4_CONNECT;
+        (void)memcpy(connection->remote, query->remote, 6);
+        sdp_client_connection_start_query(connection, query);
+    }
+}
 
-// TODO: inline if not needed (des(des))
+static void sdp_client_connection_finalize_query(sdp_client_connection_t * connection, uint8_t status){
+#ifdef ENABLE_SDP_CLIENT_CACHE
+    if (status == ERROR_CODE_SUCCESS){
+        sdp_client_cache_store(connection);
+    }
+#endif
+    sdp_client_query_t * query = connection->query;
+    connection->query = NULL;
+    connection->state = SDP_CLIENT_CONNECTION_IDLE;
+    sdp_client_query_finalize(query, status);
+
+    // continue with next query for this remote, if any, or disconnect
+    if (connection->state == SDP_CLIENT_CONNECTION_IDLE){
+        sdp_client_run();
+    }
+    if (connection->state == SDP_CLIENT_CONNECTION_IDLE){
+        connection->state = SDP_CLIENT_CONNECTION_W4_DISCONNECT;
+        l2cap_disconnect(connection->l2cap_cid, 0);
+    }
+    sdp_client_handle_failed_queries();
+}
 
-static void sdp_client_parse_attribute_lists(uint8_t* packet, uint16_t length){
-    sdp_parser_handle_chunk(packet, length);
+// SDP Client
+
+static void sdp_client_parse_attribute_lists(sdp_client_connection_t * connection, uint8_t* packet, uint16_t length){
+#ifdef ENABLE_SDP_CLIENT_CACHE
+    sdp_client_cache_add_data(connection, packet, length);
+#endif
+    sdp_parser_process_chunk(&connection->query->parser, packet, length);
 }
 
 
-static void sdp_client_send_request(uint16_t channel){
+static void sdp_client_send_request(sdp_client_connection_t * connection){
 
-    if (sdp_client_state != W2_SEND) return;
+    if (connection->state != SDP_CLIENT_CONNECTION_W2_SEND) return;
 
     l2cap_reserve_packet_buffer();
     uint8_t * data = l2cap_get_outgoing_buffer();
     uint16_t request_len = 0;
 
-    switch (PDU_ID){
+    switch (connection->query->pdu_id){
 #ifdef ENABLE_SDP_EXTRA_QUERIES
         case SDP_ServiceSearchResponse:
-            request_len = sdp_client_setup_service_search_request(data);
+            request_len = sdp_client_setup_service_search_request(connection, data);
             break;
         case SDP_ServiceAttributeResponse:
-            request_len = sdp_client_setup_service_attribute_request(data);
+            request_len = sdp_client_setup_service_attribute_request(connection, data);
             break;
 #endif
         case SDP_ServiceSearchAttributeResponse:
-            request_len = sdp_client_setup_service_search_attribute_request(data);
+            request_len = sdp_client_setup_service_search_attribute_request(connection, data);
             break;
         default:
-            log_error("SDP Client sdp_client_send_request :: PDU ID invalid. %u", PDU_ID);
+            log_error("SDP Client sdp_client_send_request :: PDU ID invalid. %u", connection->query->pdu_id);
             return;
     }
 
     // prevent re-entrance
-    sdp_client_state = W4_RESPONSE;
-    PDU_ID = SDP_Invalid;
-    l2cap_send_prepared(channel, request_len);
+    connection->state = SDP_CLIENT_CONNECTION_W4_RESPONSE;
+    l2cap_send_prepared(connection->l2cap_cid, request_len);
 }
 
 
-static void sdp_client_parse_service_search_attribute_response(uint8_t* packet, uint16_t size){
+static void sdp_client_parse_service_search_attribute_response(sdp_client_connection_t * connection, uint8_t* packet, uint16_t size){
 
     uint16_t offset = 3;
     if ((offset + 2 + 2) > size) return;  // parameterLength + attributeListByteCount
@@ -367,75 +766,77 @@ static void sdp_client_parse_service_search_attribute_response(uint8_t* packet,
     // AttributeListByteCount <= mtu
     uint16_t attributeListByteCount = big_endian_read_16(packet,offset);
     offset+=2;
-    if (attributeListByteCount > mtu){
+    if (attributeListByteCount > connection->mtu){
         log_error("Error parsing ServiceSearchAttributeResponse: Number of bytes in found attribute list is larger then the MaximumAttributeByteCount.");
         return;
     }
 
     // AttributeLists
     if ((offset + attributeListByteCount) > size) return;
-    sdp_client_parse_attribute_lists(packet+offset, attributeListByteCount);
+    sdp_client_parse_attribute_lists(connection, packet+offset, attributeListByteCount);
     offset+=attributeListByteCount;
 
     // continuation state len
     if ((offset + 1) > size) return;
-    continuationStateLen = packet[offset];
+    connection->continuation_state_len = packet[offset];
     offset++;
-    if (continuationStateLen > 16){
-        continuationStateLen = 0;
+    if (connection->continuation_state_len > 16){
+        connection->continuation_state_len = 0;
         log_error("Error parsing ServiceSearchAttributeResponse: Number of bytes in continuation state exceedes 16.");
         return;
     }
 
     // continuation state
-    if ((offset + continuationStateLen) > size) return;
-    (void)memcpy(continuationState, packet + offset, continuationStateLen);
+    if ((offset + connection->continuation_state_len) > size) return;
+    (void)memcpy(connection->continuation_state, packet + offset, connection->continuation_state_len);
     // offset+=continuationStateLen;
 }
 
 void sdp_client_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    sdp_client_connection_t * connection;
     
-    // uint16_t handle;
     if (packet_type == L2CAP_DATA_PACKET){
+        connection = sdp_client_connection_for_cid(channel);
+        if (connection == NULL) return;
+        if (connection->state != SDP_CLIENT_CONNECTION_W4_RESPONSE) return;
         if (size < 3) return;
         uint16_t responseTransactionID = big_endian_read_16(packet,1);
-        if (responseTransactionID != transactionID){
-            log_error("Mismatching transaction ID, expected %u, found %u.", transactionID, responseTransactionID);
+        if (responseTransactionID != connection->transaction_id){
+            log_error("Mismatching transaction ID, expected %u, found %u.", connection->transaction_id, responseTransactionID);
             return;
         } 
         
-        PDU_ID = (SDP_PDU_ID_t)packet[0];
-        switch (PDU_ID){
+        SDP_PDU_ID_t pdu_id = (SDP_PDU_ID_t)packet[0];
+        switch (pdu_id){
             case SDP_ErrorResponse:
-                log_error("Received error response with code %u, disconnecting", packet[2]);
-                l2cap_disconnect(sdp_cid, 0);
+                log_error("Received error response with code %u", packet[2]);
+                sdp_client_connection_finalize_query(connection, SDP_QUERY_INCOMPLETE);
                 return;
 #ifdef ENABLE_SDP_EXTRA_QUERIES
             case SDP_ServiceSearchResponse:
-                sdp_client_parse_service_search_response(packet, size);
+                sdp_client_parse_service_search_response(connection, packet, size);
                 break;
             case SDP_ServiceAttributeResponse:
-                sdp_client_parse_service_attribute_response(packet, size);
+                sdp_client_parse_service_attribute_response(connection, packet, size);
                 break;
 #endif
             case SDP_ServiceSearchAttributeResponse:
-                sdp_client_parse_service_search_attribute_response(packet, size);
+                sdp_client_parse_service_search_attribute_response(connection, packet, size);
                 break;
             default:
-                log_error("PDU ID %u unexpected/invalid", PDU_ID);
+                log_error("PDU ID %u unexpected/invalid", pdu_id);
                 return;
         }
 
         // continuation set or DONE?
-        if (continuationStateLen == 0){
+        if (connection->continuation_state_len == 0){
             log_debug("SDP Client Query DONE! ");
-            sdp_client_state = QUERY_COMPLETE;
-            l2cap_disconnect(sdp_cid, 0);
+            sdp_client_connection_finalize_query(connection, ERROR_CODE_SUCCESS);
             return;
         }
         // prepare next request and send
-        sdp_client_state = W2_SEND;
-        l2cap_request_can_send_now_event(sdp_cid);
+        connection->state = SDP_CLIENT_CONNECTION_W2_SEND;
+        l2cap_request_can_send_now_event(connection->l2cap_cid);
         return;
     }
     
@@ -443,37 +844,48 @@ void sdp_client_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *p
     
     switch(hci_event_packet_get_type(packet)){
         case L2CAP_EVENT_CHANNEL_OPENED:
-            if (sdp_client_state != W4_CONNECT) break;
+            connection = sdp_client_connection_for_cid(l2cap_event_channel_opened_get_local_cid(packet));
+            if (connection == NULL) break;
+            if (connection->state != SDP_CLIENT_CONNECTION_W4_CONNECT) break;
             // data: event (8), len(8), status (8), address(48), handle (16), psm (16), local_cid(16), remote_cid (16), local_mtu(16), remote_mtu(16) 
             if (packet[2]) {
                 log_info("SDP Client Connection failed, status 0x%02x.", packet[2]);
-                sdp_client_state = INIT;
-                sdp_parser_handle_done(packet[2]);
+                // fail all queries for this remote
+                connection->state = SDP_CLIENT_CONNECTION_FREE;
+                connection->query->state  = SDP_CLIENT_QUERY_FAILED;
+                connection->query->status = packet[2];
+                connection->query = NULL;
+                sdp_client_fail_queries_for_remote(connection->remote, packet[2]);
+                sdp_client_run();
+                sdp_client_handle_failed_queries();
                 break;
             }
-            sdp_cid = channel;
-            mtu = little_endian_read_16(packet, 17);
+            connection->mtu = little_endian_read_16(packet, 17);
             // handle = little_endian_read_16(packet, 9);
-            log_debug("SDP Client Connected, cid %x, mtu %u.", sdp_cid, mtu);
+            log_debug("SDP Client Connected, cid %x, mtu %u.", connection->l2cap_cid, connection->mtu);
 
-            sdp_client_state = W2_SEND;
-            l2cap_request_can_send_now_event(sdp_cid);
+            connection->state = SDP_CLIENT_CONNECTION_W2_SEND;
+            l2cap_request_can_send_now_event(connection->l2cap_cid);
             break;
 
         case L2CAP_EVENT_CAN_SEND_NOW:
-            if(l2cap_event_can_send_now_get_local_cid(packet) == sdp_cid){
-                sdp_client_send_request(sdp_cid);
-            }
+            connection = sdp_client_connection_for_cid(l2cap_event_can_send_now_get_local_cid(packet));
+            if (connection == NULL) break;
+            sdp_client_send_request(connection);
             break;
         case L2CAP_EVENT_CHANNEL_CLOSED: {
-            if (sdp_cid != little_endian_read_16(packet, 2)) {
-                // log_info("Received L2CAP_EVENT_CHANNEL_CLOSED for cid %x, current cid %x\n",  little_endian_read_16(packet, 2),sdp_cid);
-                break;
-            }
+            connection = sdp_client_connection_for_cid(l2cap_event_channel_closed_get_local_cid(packet));
+            if (connection == NULL) break;
             log_info("SDP Client disconnected.");
-            uint8_t status = (sdp_client_state == QUERY_COMPLETE) ? 0 : SDP_QUERY_INCOMPLETE;
-            sdp_client_state = INIT;
-            sdp_parser_handle_done(status);
+            sdp_client_query_t * query = connection->query;
+            connection->state = SDP_CLIENT_CONNECTION_FREE;
+            connection->query = NULL;
+            // queued queries for this remote get a new channel
+            sdp_client_run();
+            if (query != NULL){
+                sdp_client_query_finalize(query, SDP_QUERY_INCOMPLETE);
+            }
+            sdp_client_handle_failed_queries();
             break;
         }
         default:
@@ -482,14 +894,14 @@ void sdp_client_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *p
 }
 
 
-static uint16_t sdp_client_setup_service_search_attribute_request(uint8_t * data){
+static uint16_t sdp_client_setup_service_search_attribute_request(sdp_client_connection_t * connection, uint8_t * data){
 
     uint16_t offset = 0;
-    transactionID++;
+    connection->transaction_id++;
     // uint8_t SDP_PDU_ID_t.SDP_ServiceSearchRequest;
     data[offset++] = SDP_ServiceSearchAttributeRequest;
     // uint16_t transactionID
-    big_endian_store_16(data, offset, transactionID);
+    big_endian_store_16(data, offset, connection->transaction_id);
     offset += 2;
 
     // param legnth
@@ -497,25 +909,27 @@ static uint16_t sdp_client_setup_service_search_attribute_request(uint8_t * data
 
     // parameters: 
     //     Service_search_pattern - DES (min 1 UUID, max 12)
+    const uint8_t * service_search_pattern = connection->query->service_search_pattern;
     uint16_t service_search_pattern_len = de_get_len(service_search_pattern);
     (void)memcpy(data + offset, service_search_pattern,
                  service_search_pattern_len);
     offset += service_search_pattern_len;
 
     //     MaximumAttributeByteCount - uint16_t  0x0007 - 0xffff -> mtu
-    big_endian_store_16(data, offset, mtu);
+    big_endian_store_16(data, offset, connection->mtu);
     offset += 2;
 
     //     AttibuteIDList  
+    const uint8_t * attribute_id_list = connection->query->attribute_id_list;
     uint16_t attribute_id_list_len = de_get_len(attribute_id_list);
     (void)memcpy(data + offset, attribute_id_list, attribute_id_list_len);
     offset += attribute_id_list_len;
 
     //     ContinuationState - uint8_t number of cont. bytes N<=16 
-    data[offset++] = continuationStateLen;
+    data[offset++] = connection->continuation_state_len;
     //                       - N-bytes previous response from server
-    (void)memcpy(data + offset, continuationState, continuationStateLen);
-    offset += continuationStateLen;
+    (void)memcpy(data + offset, connection->continuation_state, connection->continuation_state_len);
+    offset += connection->continuation_state_len;
 
     // uint16_t paramLength 
     big_endian_store_16(data, 3, offset - 5);
@@ -528,13 +942,13 @@ void sdp_client_parse_service_record_handle_list(uint8_t* packet, uint16_t total
     sdp_parser_handle_service_search(packet, total_count, current_count);
 }
 
-static uint16_t sdp_client_setup_service_search_request(uint8_t * data){
+static uint16_t sdp_client_setup_service_search_request(sdp_client_connection_t * connection, uint8_t * data){
     uint16_t offset = 0;
-    transactionID++;
+    connection->transaction_id++;
     // uint8_t SDP_PDU_ID_t.SDP_ServiceSearchRequest;
     data[offset++] = SDP_ServiceSearchRequest;
     // uint16_t transactionID
-    big_endian_store_16(data, offset, transactionID);
+    big_endian_store_16(data, offset, connection->transaction_id);
     offset += 2;
 
     // param legnth
@@ -542,20 +956,21 @@ static uint16_t sdp_client_setup_service_search_request(uint8_t * data){
 
     // parameters: 
     //     Service_search_pattern - DES (min 1 UUID, max 12)
+    const uint8_t * service_search_pattern = connection->query->service_search_pattern;
     uint16_t service_search_pattern_len = de_get_len(service_search_pattern);
     (void)memcpy(data + offset, service_search_pattern,
                  service_search_pattern_len);
     offset += service_search_pattern_len;
 
     //     MaximumAttributeByteCount - uint16_t  0x0007 - 0xffff -> mtu
-    big_endian_store_16(data, offset, mtu);
+    big_endian_store_16(data, offset, connection->mtu);
     offset += 2;
 
     //     ContinuationState - uint8_t number of cont. bytes N<=16 
-    data[offset++] = continuationStateLen;
+    data[offset++] = connection->continuation_state_len;
     //                       - N-bytes previous response from server
-    (void)memcpy(data + offset, continuationState, continuationStateLen);
-    offset += continuationStateLen;
+    (void)memcpy(data + offset, connection->continuation_state, connection->continuation_state_len);
+    offset += connection->continuation_state_len;
 
     // uint16_t paramLength 
     big_endian_store_16(data, 3, offset - 5);
@@ -564,14 +979,14 @@ static uint16_t sdp_client_setup_service_search_request(uint8_t * data){
 }
 
 
-static uint16_t sdp_client_setup_service_attribute_request(uint8_t * data){
+static uint16_t sdp_client_setup_service_attribute_request(sdp_client_connection_t * connection, uint8_t * data){
 
     uint16_t offset = 0;
-    transactionID++;
+    connection->transaction_id++;
     // uint8_t SDP_PDU_ID_t.SDP_ServiceSearchRequest;
     data[offset++] = SDP_ServiceAttributeRequest;
     // uint16_t transactionID
-    big_endian_store_16(data, offset, transactionID);
+    big_endian_store_16(data, offset, connection->transaction_id);
     offset += 2;
 
     // param legnth
@@ -579,23 +994,24 @@ static uint16_t sdp_client_setup_service_attribute_request(uint8_t * data){
 
     // parameters: 
     //     ServiceRecordHandle
-    big_endian_store_32(data, offset, serviceRecordHandle);
+    big_endian_store_32(data, offset, connection->query->service_record_handle);
     offset += 4;
 
     //     MaximumAttributeByteCount - uint16_t  0x0007 - 0xffff -> mtu
-    big_endian_store_16(data, offset, mtu);
+    big_endian_store_16(data, offset, connection->mtu);
     offset += 2;
 
     //     AttibuteIDList  
+    const uint8_t * attribute_id_list = connection->query->attribute_id_list;
     uint16_t attribute_id_list_len = de_get_len(attribute_id_list);
     (void)memcpy(data + offset, attribute_id_list, attribute_id_list_len);
     offset += attribute_id_list_len;
 
     //     ContinuationState - uint8_t number of cont. bytes N<=16 
-    data[offset++] = continuationStateLen;
+    data[offset++] = connection->continuation_state_len;
     //                       - N-bytes previous response from server
-    (void)memcpy(data + offset, continuationState, continuationStateLen);
-    offset += continuationStateLen;
+    (void)memcpy(data + offset, connection->continuation_state, connection->continuation_state_len);
+    offset += connection->continuation_state_len;
 
     // uint16_t paramLength 
     big_endian_store_16(data, 3, offset - 5);
@@ -603,7 +1019,7 @@ static uint16_t sdp_client_setup_service_attribute_request(uint8_t * data){
     return offset;
 }
 
-static void sdp_client_parse_service_search_response(uint8_t* packet, uint16_t size){
+static void sdp_client_parse_service_search_response(sdp_client_connection_t * connection, uint8_t* packet, uint16_t size){
 
     uint16_t offset = 3;
     if (offset + 2 + 2 + 2 > size) return;  // parameterLength, totalServiceRecordCount, currentServiceRecordCount
@@ -623,23 +1039,23 @@ static void sdp_client_parse_service_search_response(uint8_t* packet, uint16_t s
     }
     
     if (offset + currentServiceRecordCount * 4 > size) return;
-    sdp_client_parse_service_record_handle_list(packet+offset, totalServiceRecordCount, currentServiceRecordCount);
+    sdp_parser_process_service_search(&connection->query->parser, packet+offset, totalServiceRecordCount, currentServiceRecordCount);
     offset+= currentServiceRecordCount * 4;
 
     if (offset + 1 > size) return;
-    continuationStateLen = packet[offset];
+    connection->continuation_state_len = packet[offset];
     offset++;
-    if (continuationStateLen > 16){
-        continuationStateLen = 0;
+    if (connection->continuation_state_len > 16){
+        connection->continuation_state_len = 0;
         log_error("Error parsing ServiceSearchResponse: Number of bytes in continuation state exceedes 16.");
         return;
     }
-    if (offset + continuationStateLen > size) return;
-    (void)memcpy(continuationState, packet + offset, continuationStateLen);
+    if (offset + connection->continuation_state_len > size) return;
+    (void)memcpy(connection->continuation_state, packet + offset, connection->continuation_state_len);
     // offset+=continuationStateLen;
 }
 
-static void sdp_client_parse_service_attribute_response(uint8_t* packet, uint16_t size){
+static void sdp_client_parse_service_attribute_response(sdp_client_connection_t * connection, uint8_t* packet, uint16_t size){
 
     uint16_t offset = 3;
     if (offset + 2 + 2 > size) return;  // parameterLength, attributeListByteCount
@@ -650,53 +1066,108 @@ static void sdp_client_parse_service_attribute_response(uint8_t* packet, uint16_
     // AttributeListByteCount <= mtu
     uint16_t attributeListByteCount = big_endian_read_16(packet,offset);
     offset+=2;
-    if (attributeListByteCount > mtu){
+    if (attributeListByteCount > connection->mtu){
         log_error("Error parsing ServiceSearchAttributeResponse: Number of bytes in found attribute list is larger then the MaximumAttributeByteCount.");
         return;
     }
 
     // AttributeLists
     if (offset+attributeListByteCount > size) return;
-    sdp_client_parse_attribute_lists(packet+offset, attributeListByteCount);
+    sdp_client_parse_attribute_lists(connection, packet+offset, attributeListByteCount);
     offset+=attributeListByteCount;
 
     // continuationStateLen
     if (offset + 1 > size) return;
-    continuationStateLen = packet[offset];
+    connection->continuation_state_len = packet[offset];
     offset++;
-    if (continuationStateLen > 16){
-        continuationStateLen = 0;
+    if (connection->continuation_state_len > 16){
+        connection->continuation_state_len = 0;
         log_error("Error parsing ServiceAttributeResponse: Number of bytes in continuation state exceedes 16.");
         return;
     }
-    if (offset + continuationStateLen > size) return;
-    (void)memcpy(continuationState, packet + offset, continuationStateLen);
+    if (offset + connection->continuation_state_len > size) return;
+    (void)memcpy(connection->continuation_state, packet + offset, connection->continuation_state_len);
     // offset+=continuationStateLen;
 }
 #endif
 
 // for testing only
 void sdp_client_reset(void){
-    sdp_client_state = INIT;
+    (void)memset(sdp_client_connections, 0, sizeof(sdp_client_connections));
+    (void)memset(sdp_client_query_storage, 0, sizeof(sdp_client_query_storage));
+    sdp_client_queries = NULL;
+    sdp_parser_current = &sdp_parser_standalone;
+#ifdef ENABLE_SDP_CLIENT_CACHE
+    (void)memset(sdp_client_cache, 0, sizeof(sdp_client_cache));
+#endif
+}
+
+static uint8_t sdp_client_query_start(btstack_packet_handler_t callback, bd_addr_t remote, SDP_PDU_ID_t pdu_id, const uint8_t * des_service_search_pattern,
+                                      uint32_t service_record_handle, const uint8_t * des_attribute_id_list, uint16_t * out_query_id){
+    sdp_client_query_t * query = sdp_client_query_alloc();
+    if (query == NULL) return SDP_QUERY_BUSY;
+
+    (void)memset(query, 0, sizeof(sdp_client_query_t));
+    sdp_client_query_id++;
+    if (sdp_client_query_id == 0){
+        sdp_client_query_id = 1;
+    }
+    query->id = sdp_client_query_id;
+    query->state = SDP_CLIENT_QUERY_QUEUED;
+    query->pdu_id = pdu_id;
+    (void)memcpy(query->remote, remote, 6);
+    query->service_search_pattern = des_service_search_pattern;
+    if ((des_service_search_pattern != NULL) && (de_get_len(des_service_search_pattern) <= SDP_CLIENT_SEARCH_PATTERN_STORAGE_SIZE)){
+        (void)memcpy(query->service_search_pattern_storage, des_service_search_pattern, de_get_len(des_service_search_pattern));
+        query->service_search_pattern = query->service_search_pattern_storage;
+    }
+    query->attribute_id_list = des_attribute_id_list;
+#ifdef ENABLE_SDP_EXTRA_QUERIES
+    query->service_record_handle = service_record_handle;
+#else
+    UNUSED(service_record_handle);
+#endif
+    sdp_parser_reset(&query->parser, callback, query->id);
+#ifdef ENABLE_SDP_EXTRA_QUERIES
+    if (pdu_id == SDP_ServiceAttributeResponse){
+        sdp_parser_reset_service_attribute_search(&query->parser);
+    }
+#endif
+    sdp_parser_current = &query->parser;
+    btstack_linked_list_add_tail(&sdp_client_queries, (btstack_linked_item_t *) query);
+
+    if (out_query_id != NULL){
+        *out_query_id = query->id;
+    }
+
+#ifdef ENABLE_SDP_CLIENT_CACHE
+    if (sdp_client_cache_handle_query(query)) return ERROR_CODE_SUCCESS;
+#endif
+
+    sdp_client_run();
+
+    // report error if channel for new query could not be created
+    if (query->state == SDP_CLIENT_QUERY_FAILED){
+        uint8_t status = query->status;
+        btstack_linked_list_remove(&sdp_client_queries, (btstack_linked_item_t *) query);
+        query->state = SDP_CLIENT_QUERY_FREE;
+        return status;
+    }
+    return ERROR_CODE_SUCCESS;
 }
 
 // Public API
 
 int sdp_client_ready(void){
-    return sdp_client_state == INIT;
+    return sdp_client_query_alloc() != NULL;
 }
 
 uint8_t sdp_client_query(btstack_packet_handler_t callback, bd_addr_t remote, const uint8_t * des_service_search_pattern, const uint8_t * des_attribute_id_list){
-    if (!sdp_client_ready()) return SDP_QUERY_BUSY;
-
-    sdp_parser_init(callback);
-    service_search_pattern = des_service_search_pattern;
-    attribute_id_list = des_attribute_id_list;
-    continuationStateLen = 0;
-    PDU_ID = SDP_ServiceSearchAttributeResponse;
+    return sdp_client_query_start(callback, remote, SDP_ServiceSearchAttributeResponse, des_service_search_pattern, 0, des_attribute_id_list, NULL);
+}
 
-    sdp_client_state = W4_CONNECT;
-    return l2cap_create_channel(sdp_client_packet_handler, remote, BLUETOOTH_PSM_SDP, l2cap_max_mtu(), NULL);
+uint8_t sdp_client_query_with_id(btstack_packet_handler_t callback, bd_addr_t remote, const uint8_t * des_service_search_pattern, const uint8_t * des_attribute_id_list, uint16_t * out_query_id){
+    return sdp_client_query_start(callback, remote, SDP_ServiceSearchAttributeResponse, des_service_search_pattern, 0, des_attribute_id_list, out_query_id);
 }
 
 uint8_t sdp_client_query_uuid16(btstack_packet_handler_t callback, bd_addr_t remote, uint16_t uuid){
@@ -711,31 +1182,21 @@ uint8_t sdp_client_query_uuid128(btstack_packet_handler_t callback, bd_addr_t re
 
 #ifdef ENABLE_SDP_EXTRA_QUERIES
 uint8_t sdp_client_service_attribute_search(btstack_packet_handler_t callback, bd_addr_t remote, uint32_t search_service_record_handle, const uint8_t * des_attribute_id_list){
-    if (!sdp_client_ready()) return SDP_QUERY_BUSY;
-
-    sdp_parser_init(callback);
-    serviceRecordHandle = search_service_record_handle;
-    attribute_id_list = des_attribute_id_list;
-    continuationStateLen = 0;
-    PDU_ID = SDP_ServiceAttributeResponse;
-
-    sdp_client_state = W4_CONNECT;
-    l2cap_create_channel(sdp_client_packet_handler, remote, BLUETOOTH_PSM_SDP, l2cap_max_mtu(), NULL);
-    return 0;
+    return sdp_client_query_start(callback, remote, SDP_ServiceAttributeResponse, NULL, search_service_record_handle, des_attribute_id_list, NULL);
 }
 
 uint8_t sdp_client_service_search(btstack_packet_handler_t callback, bd_addr_t remote, const uint8_t * des_service_search_pattern){
-
-    if (!sdp_client_ready()) return SDP_QUERY_BUSY;
-
-    sdp_parser_init(callback);
-    service_search_pattern = des_service_search_pattern;
-    continuationStateLen = 0;
-    PDU_ID = SDP_ServiceSearchResponse;
-
-    sdp_client_state = W4_CONNECT;
-    l2cap_create_channel(sdp_client_packet_handler, remote, BLUETOOTH_PSM_SDP, l2cap_max_mtu(), NULL);
-    return 0;
+    return sdp_client_query_start(callback, remote, SDP_ServiceSearchResponse, des_service_search_pattern, 0, NULL, NULL);
 }
 #endif
 
+#ifdef ENABLE_SDP_CLIENT_CACHE
+void sdp_client_cache_remove(bd_addr_t remote){
+    int i;
+    for (i=0;i<SDP_CLIENT_CACHE_SIZE;i++){
+        sdp_client_cache_entry_t * entry = &sdp_client_cache[i];
+        if (bd_addr_cmp(entry->remote, remote) != 0) continue;
+        entry->valid = 0;
+    }
+}
+#endif
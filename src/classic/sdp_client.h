@@ -50,6 +50,16 @@
 extern "C" {
 #endif
 
+// max number of parallel L2CAP connections to different remote devices
+#ifndef SDP_CLIENT_MAX_CONNECTIONS
+#define SDP_CLIENT_MAX_CONNECTIONS 2
+#endif
+
+// max number of queued and active queries
+#ifndef SDP_CLIENT_MAX_QUERIES
+#define SDP_CLIENT_MAX_QUERIES 4
+#endif
+
 /* API_START */
 
 typedef struct de_state {
@@ -64,20 +74,35 @@ int  de_state_size(uint8_t eventByte, de_state_t *de_state);
 
 /** 
  * @brief Checks if the SDP Client is ready
- * @return 1 when no query is active
+ * @return 1 when another query can be queued
  */
 int sdp_client_ready(void);
 
 /** 
  * @brief Queries the SDP service of the remote device given a service search pattern and a list of attribute IDs. 
  * The remote data is handled by the SDP parser. The SDP parser delivers attribute values and done event via the callback.
+ * Queries are queued (up to SDP_CLIENT_MAX_QUERIES). Queries to different remote devices run in parallel (up to 
+ * SDP_CLIENT_MAX_CONNECTIONS), queries to the same remote device run one after the other over a single L2CAP channel.
+ * The query id is passed as channel to the callback.
  * @param callback for attributes values and done event
  * @param remote address
  * @param des_service_search_pattern 
  * @param des_attribute_id_list
+ * @return status ERROR_CODE_SUCCESS or SDP_QUERY_BUSY if query queue is full
  */
 uint8_t sdp_client_query(btstack_packet_handler_t callback, bd_addr_t remote, const uint8_t * des_service_search_pattern, const uint8_t * des_attribute_id_list);
 
+/**
+ * @brief Same as sdp_client_query, provides the query id that is passed as channel to the callback
+ * @param callback for attributes values and done event
+ * @param remote address
+ * @param des_service_search_pattern
+ * @param des_attribute_id_list
+ * @param out_query_id
+ * @return status
+ */
+uint8_t sdp_client_query_with_id(btstack_packet_handler_t callback, bd_addr_t remote, const uint8_t * des_service_search_pattern, const uint8_t * des_attribute_id_list, uint16_t * out_query_id);
+
 /*
  * @brief Searches SDP records on a remote device for all services with a given UUID.
  * @note calls sdp_client_query with service search pattern based on uuid16
@@ -112,6 +137,14 @@ uint8_t sdp_client_service_attribute_search(btstack_packet_handler_t callback, b
  */
 uint8_t sdp_client_service_search(btstack_packet_handler_t callback, bd_addr_t remote, const uint8_t * des_service_search_pattern);
 
+/**
+ * @brief Remove cached query results for remote device, e.g. after its service records have changed
+ * @note only provided if ENABLE_SDP_CLIENT_CACHE is defined. Results of queries with attribute lists are cached for
+ * SDP_CLIENT_CACHE_TTL_MS and delivered from the run loop without connecting to the remote device again.
+ * @param remote address
+ */
+void sdp_client_cache_remove(bd_addr_t remote);
+
 #ifdef ENABLE_SDP_EXTRA_QUERIES
 void sdp_client_parse_service_record_handle_list(uint8_t* packet, uint16_t total_count, uint16_t current_count);
 #endif
@@ -73,128 +73,146 @@ typedef enum {
 // All attributes: 0x0001 - 0x0100
 static const uint8_t des_attributeIDList[]    = { 0x35, 0x05, 0x0A, 0x00, 0x01, 0x01, 0x00};  
 
-static uint8_t sdp_service_name[SDP_SERVICE_NAME_LEN+1];
-static uint8_t sdp_service_name_len = 0;
-static uint8_t sdp_rfcomm_channel_nr = 0;
-static uint8_t sdp_service_name_header_size;
-
-static pdl_state_t pdl_state = GET_PROTOCOL_LIST_LENGTH;
-static int protocol_value_bytes_received = 0;
-static uint16_t protocol_id = 0;
-static int protocol_offset;
-static int protocol_size;
-static int protocol_id_bytes_to_read;
-static int protocol_value_size;
-static de_state_t de_header_state;
-static de_state_t sn_de_header_state;
-static btstack_packet_handler_t sdp_app_callback;
-//
-
-static void sdp_rfcomm_query_emit_service(void){
+// parser state per query, as queries to different remote devices run in parallel
+typedef struct {
+    uint8_t  in_use;
+    uint16_t query_id;
+    btstack_packet_handler_t sdp_app_callback;
+
+    uint8_t sdp_service_name[SDP_SERVICE_NAME_LEN+1];
+    uint8_t sdp_service_name_len;
+    uint8_t sdp_rfcomm_channel_nr;
+    uint8_t sdp_service_name_header_size;
+
+    pdl_state_t pdl_state;
+    int protocol_value_bytes_received;
+    uint16_t protocol_id;
+    int protocol_offset;
+    int protocol_size;
+    int protocol_id_bytes_to_read;
+    int protocol_value_size;
+    de_state_t de_header_state;
+    de_state_t sn_de_header_state;
+} sdp_client_rfcomm_query_t;
+
+static sdp_client_rfcomm_query_t sdp_client_rfcomm_queries[SDP_CLIENT_MAX_QUERIES];
+
+static sdp_client_rfcomm_query_t * sdp_client_rfcomm_query_for_id(uint16_t query_id){
+    int i;
+    for (i=0;i<SDP_CLIENT_MAX_QUERIES;i++){
+        sdp_client_rfcomm_query_t * context = &sdp_client_rfcomm_queries[i];
+        if (context->in_use == 0) continue;
+        if (context->query_id != query_id) continue;
+        return context;
+    }
+    return NULL;
+}
+
+static void sdp_rfcomm_query_emit_service(sdp_client_rfcomm_query_t * context){
     uint8_t event[3+SDP_SERVICE_NAME_LEN+1];
     event[0] = SDP_EVENT_QUERY_RFCOMM_SERVICE;
-    event[1] = sdp_service_name_len + 1;
-    event[2] = sdp_rfcomm_channel_nr;
-    (void)memcpy(&event[3], sdp_service_name, sdp_service_name_len);
-    event[3+sdp_service_name_len] = 0;
-    (*sdp_app_callback)(HCI_EVENT_PACKET, 0, event, sizeof(event)); 
-    sdp_rfcomm_channel_nr = 0;
+    event[1] = context->sdp_service_name_len + 1;
+    event[2] = context->sdp_rfcomm_channel_nr;
+    (void)memcpy(&event[3], context->sdp_service_name, context->sdp_service_name_len);
+    event[3+context->sdp_service_name_len] = 0;
+    (*context->sdp_app_callback)(HCI_EVENT_PACKET, context->query_id, event, sizeof(event)); 
+    context->sdp_rfcomm_channel_nr = 0;
 }
 
-static void sdp_client_query_rfcomm_handle_protocol_descriptor_list_data(uint32_t attribute_value_length, uint32_t data_offset, uint8_t data){
+static void sdp_client_query_rfcomm_handle_protocol_descriptor_list_data(sdp_client_rfcomm_query_t * context, uint32_t attribute_value_length, uint32_t data_offset, uint8_t data){
     UNUSED(attribute_value_length);
     
     // init state on first byte
     if (data_offset == 0){
-        pdl_state = GET_PROTOCOL_LIST_LENGTH;
+        context->pdl_state = GET_PROTOCOL_LIST_LENGTH;
     }
 
     // log_info("sdp_client_query_rfcomm_handle_protocol_descriptor_list_data (%u,%u) %02x", attribute_value_length, data_offset, data);
 
-    switch(pdl_state){
+    switch(context->pdl_state){
         
         case GET_PROTOCOL_LIST_LENGTH:
-            if (!de_state_size(data, &de_header_state)) break;
+            if (!de_state_size(data, &context->de_header_state)) break;
             // log_info("   query: PD List payload is %d bytes.", de_header_state.de_size);
             // log_info("   query: PD List offset %u, list size %u", de_header_state.de_offset, de_header_state.de_size);
 
-            pdl_state = GET_PROTOCOL_LENGTH;
+            context->pdl_state = GET_PROTOCOL_LENGTH;
             break;
         
         case GET_PROTOCOL_LENGTH:
             // check size
-            if (!de_state_size(data, &de_header_state)) break;
+            if (!de_state_size(data, &context->de_header_state)) break;
             // log_info("   query: PD Record payload is %d bytes.", de_header_state.de_size);
             
             // cache protocol info
-            protocol_offset = de_header_state.de_offset;
-            protocol_size   = de_header_state.de_size;
+            context->protocol_offset = context->de_header_state.de_offset;
+            context->protocol_size   = context->de_header_state.de_size;
 
-            pdl_state = GET_PROTOCOL_ID_HEADER_LENGTH;
+            context->pdl_state = GET_PROTOCOL_ID_HEADER_LENGTH;
             break;
         
        case GET_PROTOCOL_ID_HEADER_LENGTH:
-            protocol_offset++;
-            if (!de_state_size(data, &de_header_state)) break;
+            context->protocol_offset++;
+            if (!de_state_size(data, &context->de_header_state)) break;
             
-            protocol_id = 0;
-            protocol_id_bytes_to_read = de_header_state.de_size;
+            context->protocol_id = 0;
+            context->protocol_id_bytes_to_read = context->de_header_state.de_size;
             // log_info("   query: ID data is stored in %d bytes.", protocol_id_bytes_to_read);
-            pdl_state = GET_PROTOCOL_ID;
+            context->pdl_state = GET_PROTOCOL_ID;
             
             break;
         
         case GET_PROTOCOL_ID:
-            protocol_offset++;
+            context->protocol_offset++;
 
-            protocol_id = (protocol_id << 8) | data;
-            protocol_id_bytes_to_read--;
-            if (protocol_id_bytes_to_read > 0) break;
+            context->protocol_id = (context->protocol_id << 8) | data;
+            context->protocol_id_bytes_to_read--;
+            if (context->protocol_id_bytes_to_read > 0) break;
 
             // log_info("   query: Protocol ID: %04x.", protocol_id);
 
-            if (protocol_offset >= protocol_size){
-                pdl_state = GET_PROTOCOL_LENGTH;
+            if (context->protocol_offset >= context->protocol_size){
+                context->pdl_state = GET_PROTOCOL_LENGTH;
                 // log_info("   query: Get next protocol");
                 break;
             } 
             
-            pdl_state = GET_PROTOCOL_VALUE_LENGTH;
-            protocol_value_bytes_received = 0;
+            context->pdl_state = GET_PROTOCOL_VALUE_LENGTH;
+            context->protocol_value_bytes_received = 0;
             break;
         
         case GET_PROTOCOL_VALUE_LENGTH:
-            protocol_offset++;
+            context->protocol_offset++;
 
-            if (!de_state_size(data, &de_header_state)) break;
+            if (!de_state_size(data, &context->de_header_state)) break;
 
-            protocol_value_size = de_header_state.de_size;
-            pdl_state = GET_PROTOCOL_VALUE;
-            sdp_rfcomm_channel_nr = 0;
+            context->protocol_value_size = context->de_header_state.de_size;
+            context->pdl_state = GET_PROTOCOL_VALUE;
+            context->sdp_rfcomm_channel_nr = 0;
             break;
         
         case GET_PROTOCOL_VALUE:
-            protocol_offset++;
-            protocol_value_bytes_received++;
+            context->protocol_offset++;
+            context->protocol_value_bytes_received++;
            
             // log_info("   query: protocol_value_bytes_received %u, protocol_value_size %u", protocol_value_bytes_received, protocol_value_size);
 
-            if (protocol_value_bytes_received < protocol_value_size) break;
+            if (context->protocol_value_bytes_received < context->protocol_value_size) break;
 
-            if (protocol_id == BLUETOOTH_PROTOCOL_RFCOMM){
+            if (context->protocol_id == BLUETOOTH_PROTOCOL_RFCOMM){
                 //  log_info("\n\n *******  Data ***** %02x\n\n", data);
-                sdp_rfcomm_channel_nr = data;
+                context->sdp_rfcomm_channel_nr = data;
             }
 
             // log_info("   query: protocol done");
             // log_info("   query: Protocol offset %u, protocol size %u", protocol_offset, protocol_size);
 
-            if (protocol_offset >= protocol_size) {
-                pdl_state = GET_PROTOCOL_LENGTH;
+            if (context->protocol_offset >= context->protocol_size) {
+                context->pdl_state = GET_PROTOCOL_LENGTH;
                 break;
 
             }
-            pdl_state = GET_PROTOCOL_ID_HEADER_LENGTH;
+            context->pdl_state = GET_PROTOCOL_ID_HEADER_LENGTH;
             // log_info("   query: Get next protocol");
             break;
         default:
@@ -202,62 +220,65 @@ static void sdp_client_query_rfcomm_handle_protocol_descriptor_list_data(uint32_
     }
 }
 
-static void sdp_client_query_rfcomm_handle_service_name_data(uint32_t attribute_value_length, uint32_t data_offset, uint8_t data){
+static void sdp_client_query_rfcomm_handle_service_name_data(sdp_client_rfcomm_query_t * context, uint32_t attribute_value_length, uint32_t data_offset, uint8_t data){
 
     // Get Header Len
     if (data_offset == 0){
-        de_state_size(data, &sn_de_header_state);
-        sdp_service_name_header_size = sn_de_header_state.addon_header_bytes + 1;
+        de_state_size(data, &context->sn_de_header_state);
+        context->sdp_service_name_header_size = context->sn_de_header_state.addon_header_bytes + 1;
         return;
     }
 
     // Get Header
-    if (data_offset < sdp_service_name_header_size){
-        de_state_size(data, &sn_de_header_state);
+    if (data_offset < context->sdp_service_name_header_size){
+        de_state_size(data, &context->sn_de_header_state);
         return;
     }
 
     // Process payload
-    int name_len = attribute_value_length - sdp_service_name_header_size;
-    int name_pos = data_offset - sdp_service_name_header_size;
+    int name_len = attribute_value_length - context->sdp_service_name_header_size;
+    int name_pos = data_offset - context->sdp_service_name_header_size;
 
     if (name_pos < SDP_SERVICE_NAME_LEN){
-        sdp_service_name[name_pos] = data;
+        context->sdp_service_name[name_pos] = data;
         name_pos++;
 
         // terminate if name complete
         if (name_pos >= name_len){
-            sdp_service_name[name_pos] = 0;
-            sdp_service_name_len = name_pos;            
+            context->sdp_service_name[name_pos] = 0;
+            context->sdp_service_name_len = name_pos;            
         } 
 
         // terminate if buffer full
         if (name_pos == SDP_SERVICE_NAME_LEN){
-            sdp_service_name[name_pos] = 0;            
-            sdp_service_name_len = name_pos;            
+            context->sdp_service_name[name_pos] = 0;            
+            context->sdp_service_name_len = name_pos;            
         }
     }
 
     // notify on last char
-    if ((data_offset == (attribute_value_length - 1)) && (sdp_rfcomm_channel_nr!=0)){
-        sdp_rfcomm_query_emit_service();
+    if ((data_offset == (attribute_value_length - 1)) && (context->sdp_rfcomm_channel_nr!=0)){
+        sdp_rfcomm_query_emit_service(context);
     }
 }
 
 static void sdp_client_query_rfcomm_handle_sdp_parser_event(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
     UNUSED(packet_type);
-    UNUSED(channel);
+
+    // channel is query id
+    sdp_client_rfcomm_query_t * context = sdp_client_rfcomm_query_for_id(channel);
+    if (context == NULL) return;
 
     switch (hci_event_packet_get_type(packet)){
         case SDP_EVENT_QUERY_SERVICE_RECORD_HANDLE:
             // handle service without a name
-            if (sdp_rfcomm_channel_nr){
-                sdp_rfcomm_query_emit_service();
+            if (context->sdp_rfcomm_channel_nr){
+                sdp_rfcomm_query_emit_service(context);
             }
 
             // prepare for new record
-            sdp_rfcomm_channel_nr = 0;
-            sdp_service_name[0] = 0;
+            context->sdp_rfcomm_channel_nr = 0;
+            context->sdp_service_name[0] = 0;
             break;
         case SDP_EVENT_QUERY_ATTRIBUTE_VALUE:
             // log_info("sdp_client_query_rfcomm_handle_sdp_parser_event [ AID, ALen, DOff, Data] : [%x, %u, %u] BYTE %02x", 
@@ -266,13 +287,13 @@ static void sdp_client_query_rfcomm_handle_sdp_parser_event(uint8_t packet_type,
             switch (sdp_event_query_attribute_byte_get_attribute_id(packet)){
                 case BLUETOOTH_ATTRIBUTE_PROTOCOL_DESCRIPTOR_LIST:
                     // find rfcomm channel
-                    sdp_client_query_rfcomm_handle_protocol_descriptor_list_data(sdp_event_query_attribute_byte_get_attribute_length(packet),
+                    sdp_client_query_rfcomm_handle_protocol_descriptor_list_data(context, sdp_event_query_attribute_byte_get_attribute_length(packet),
                         sdp_event_query_attribute_byte_get_data_offset(packet),
                         sdp_event_query_attribute_byte_get_data(packet));
                     break;
                 case 0x0100:
                     // get service name
-                    sdp_client_query_rfcomm_handle_service_name_data(sdp_event_query_attribute_byte_get_attribute_length(packet),
+                    sdp_client_query_rfcomm_handle_service_name_data(context, sdp_event_query_attribute_byte_get_attribute_length(packet),
                         sdp_event_query_attribute_byte_get_data_offset(packet),
                         sdp_event_query_attribute_byte_get_data(packet));
                     break;
@@ -283,23 +304,19 @@ static void sdp_client_query_rfcomm_handle_sdp_parser_event(uint8_t packet_type,
             break;
         case SDP_EVENT_QUERY_COMPLETE:
             // handle service without a name
-            if (sdp_rfcomm_channel_nr){
-                sdp_rfcomm_query_emit_service();
+            if (context->sdp_rfcomm_channel_nr){
+                sdp_rfcomm_query_emit_service(context);
             }
-            (*sdp_app_callback)(HCI_EVENT_PACKET, 0, packet, size); 
+            // free context before emitting done, so that the callback can start a new query
+            context->in_use = 0;
+            (*context->sdp_app_callback)(HCI_EVENT_PACKET, channel, packet, size); 
             break;
     }
     // insert higher level code HERE
 }
 
 void sdp_client_query_rfcomm_init(void){
-    // init
-    de_state_init(&de_header_state);
-    de_state_init(&sn_de_header_state);
-    pdl_state = GET_PROTOCOL_LIST_LENGTH;
-    protocol_offset = 0;
-    sdp_rfcomm_channel_nr = 0;
-    sdp_service_name[0] = 0;
+    (void)memset(sdp_client_rfcomm_queries, 0, sizeof(sdp_client_rfcomm_queries));
 }
 
 // Public API
@@ -307,9 +324,30 @@ void sdp_client_query_rfcomm_init(void){
 uint8_t sdp_client_query_rfcomm_channel_and_name_for_search_pattern(btstack_packet_handler_t callback, bd_addr_t remote, const uint8_t * service_search_pattern){
     if (!sdp_client_ready()) return SDP_QUERY_BUSY;
 
-    sdp_app_callback = callback;
-    sdp_client_query_rfcomm_init();
-    return sdp_client_query(&sdp_client_query_rfcomm_handle_sdp_parser_event, remote, service_search_pattern, (uint8_t*)&des_attributeIDList[0]);
+    sdp_client_rfcomm_query_t * context = NULL;
+    int i;
+    for (i=0;i<SDP_CLIENT_MAX_QUERIES;i++){
+        if (sdp_client_rfcomm_queries[i].in_use == 0){
+            context = &sdp_client_rfcomm_queries[i];
+            break;
+        }
+    }
+    if (context == NULL) return SDP_QUERY_BUSY;
+
+    (void)memset(context, 0, sizeof(sdp_client_rfcomm_query_t));
+    de_state_init(&context->de_header_state);
+    de_state_init(&context->sn_de_header_state);
+    context->pdl_state = GET_PROTOCOL_LIST_LENGTH;
+    context->sdp_app_callback = callback;
+
+    uint16_t query_id;
+    uint8_t status = sdp_client_query_with_id(&sdp_client_query_rfcomm_handle_sdp_parser_event, remote, service_search_pattern, (uint8_t*)&des_attributeIDList[0], &query_id);
+    if (status != ERROR_CODE_SUCCESS) return status;
+
+    // events are delivered from the run loop, after the query id is known
+    context->in_use = 1;
+    context->query_id = query_id;
+    return ERROR_CODE_SUCCESS;
 }
 
 uint8_t sdp_client_query_rfcomm_channel_and_name_for_uuid(btstack_packet_handler_t callback, bd_addr_t remote, uint16_t uuid16){
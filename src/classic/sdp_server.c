@@ -70,6 +70,37 @@
 #define SDP_RESPONSE_BUFFER_SIZE (HCI_ACL_PAYLOAD_SIZE-L2CAP_HEADER_SIZE)
 #endif
 
+// max number of l2cap connections served in parallel, each with its own request and continuation state
+#ifndef SDP_SERVER_MAX_CHANNELS
+#define SDP_SERVER_MAX_CHANNELS 2
+#endif
+
+// requests are stored if the response cannot be sent right away, default fits largest request accepted by L2CAP
+#ifndef SDP_SERVER_REQUEST_BUFFER_SIZE
+#define SDP_SERVER_REQUEST_BUFFER_SIZE (HCI_ACL_PAYLOAD_SIZE-L2CAP_HEADER_SIZE)
+#endif
+
+#ifdef ENABLE_SDP_SERVER_UUID_INDEX
+// max number of (UUID, service record) pairs in index
+#ifndef SDP_SERVER_UUID_INDEX_SIZE
+#define SDP_SERVER_UUID_INDEX_SIZE 64
+#endif
+
+// Bluetooth Base UUIDs are indexed by their 32-bit value, other UUIDs by a 32-bit hash
+typedef struct {
+    uint32_t key;
+    uint32_t service_record_handle;
+    uint8_t  hashed;
+} sdp_uuid_index_entry_t;
+#endif
+
+typedef struct {
+    uint16_t l2cap_cid;
+    // pending request, truncated if larger than request buffer
+    uint16_t request_len;
+    uint8_t  request[SDP_SERVER_REQUEST_BUFFER_SIZE];
+} sdp_server_channel_t;
+
 static void sdp_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size);
 
 // registered service records
@@ -78,17 +109,24 @@ static btstack_linked_list_t sdp_service_records = NULL;
 // our handles start after the reserved range
 static uint32_t sdp_next_service_record_handle = ((uint32_t) maxReservedServiceRecordHandle) + 2;
 
-static uint8_t sdp_response_buffer[SDP_RESPONSE_BUFFER_SIZE];
+static sdp_server_channel_t sdp_server_channels[SDP_SERVER_MAX_CHANNELS];
 
-static uint16_t l2cap_cid = 0;
-static uint16_t sdp_response_size = 0;
 static uint16_t l2cap_waiting_list_cids[SDP_WAITING_LIST_MAX_COUNT];
 static int      l2cap_waiting_list_count;
 
+#ifdef ENABLE_SDP_SERVER_UUID_INDEX
+// sorted by key and service record handle
+static sdp_uuid_index_entry_t sdp_uuid_index[SDP_SERVER_UUID_INDEX_SIZE];
+static uint16_t               sdp_uuid_index_count;
+// set if not all records could be indexed, service search patterns are then matched against the records
+static bool                   sdp_uuid_index_incomplete;
+#endif
+
 void sdp_init(void){
     // register with l2cap psm sevices - max MTU
     l2cap_register_service(sdp_packet_handler, BLUETOOTH_PSM_SDP, 0xffff, LEVEL_0);
     l2cap_waiting_list_count = 0;
+    (void)memset(sdp_server_channels, 0, sizeof(sdp_server_channels));
 }
 
 uint32_t sdp_get_service_record_handle(const uint8_t * record){
@@ -117,6 +155,118 @@ uint8_t * sdp_get_record_for_handle(uint32_t handle){
     return record_item->service_record;
 }
 
+#ifdef ENABLE_SDP_SERVER_UUID_INDEX
+// @returns false if element is not a valid UUID
+static bool sdp_uuid_index_key_for_uuid(const uint8_t * element, uint32_t * key, uint8_t * hashed){
+    uint8_t uuid128[16];
+    if (!de_get_normalized_uuid(uuid128, element)) return false;
+    if (uuid_has_bluetooth_prefix(uuid128)){
+        *key = big_endian_read_32(uuid128, 0);
+        *hashed = 0;
+    } else {
+        *key = big_endian_read_32(uuid128, 0) ^ big_endian_read_32(uuid128, 4) ^ big_endian_read_32(uuid128, 8) ^ big_endian_read_32(uuid128, 12);
+        *hashed = 1;
+    }
+    return true;
+}
+
+static int sdp_uuid_index_compare(uint32_t key, uint8_t hashed, uint32_t service_record_handle, const sdp_uuid_index_entry_t * entry){
+    if (key != entry->key) return (key < entry->key) ? -1 : 1;
+    if (hashed != entry->hashed) return (hashed < entry->hashed) ? -1 : 1;
+    if (service_record_handle != entry->service_record_handle) return (service_record_handle < entry->service_record_handle) ? -1 : 1;
+    return 0;
+}
+
+// @returns position of first entry that is not smaller
+static uint16_t sdp_uuid_index_lower_bound(uint32_t key, uint8_t hashed, uint32_t service_record_handle){
+    uint16_t low  = 0;
+    uint16_t high = sdp_uuid_index_count;
+    while (low < high){
+        uint16_t mid = (low + high) / 2;
+        if (sdp_uuid_index_compare(key, hashed, service_record_handle, &sdp_uuid_index[mid]) > 0){
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static bool sdp_uuid_index_contains(uint32_t key, uint8_t hashed, uint32_t service_record_handle){
+    uint16_t pos = sdp_uuid_index_lower_bound(key, hashed, service_record_handle);
+    if (pos >= sdp_uuid_index_count) return false;
+    return sdp_uuid_index_compare(key, hashed, service_record_handle, &sdp_uuid_index[pos]) == 0;
+}
+
+static void sdp_uuid_index_add(uint32_t key, uint8_t hashed, uint32_t service_record_handle){
+    uint16_t pos = sdp_uuid_index_lower_bound(key, hashed, service_record_handle);
+    if ((pos < sdp_uuid_index_count) && (sdp_uuid_index_compare(key, hashed, service_record_handle, &sdp_uuid_index[pos]) == 0)) return;
+    if (sdp_uuid_index_count >= SDP_SERVER_UUID_INDEX_SIZE){
+        log_info("UUID index full, matching service search patterns against records");
+        sdp_uuid_index_incomplete = true;
+        return;
+    }
+    (void)memmove(&sdp_uuid_index[pos+1], &sdp_uuid_index[pos], (sdp_uuid_index_count - pos) * sizeof(sdp_uuid_index_entry_t));
+    sdp_uuid_index[pos].key = key;
+    sdp_uuid_index[pos].hashed = hashed;
+    sdp_uuid_index[pos].service_record_handle = service_record_handle;
+    sdp_uuid_index_count++;
+}
+
+// add all UUIDs contained in data element sequence, same as sdp_record_contains_UUID128
+static void sdp_uuid_index_add_sequence(uint8_t * element, uint32_t service_record_handle){
+    des_iterator_t it;
+    for (des_iterator_init(&it, element); des_iterator_has_more(&it); des_iterator_next(&it)){
+        uint8_t * child = des_iterator_get_element(&it);
+        uint32_t key;
+        uint8_t  hashed;
+        switch (des_iterator_get_type(&it)){
+            case DE_UUID:
+                if (!sdp_uuid_index_key_for_uuid(child, &key, &hashed)) break;
+                sdp_uuid_index_add(key, hashed, service_record_handle);
+                break;
+            case DE_DES:
+                sdp_uuid_index_add_sequence(child, service_record_handle);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static void sdp_uuid_index_rebuild(void){
+    sdp_uuid_index_count = 0;
+    sdp_uuid_index_incomplete = false;
+    btstack_linked_item_t *it;
+    for (it = (btstack_linked_item_t *) sdp_service_records; it ; it = it->next){
+        service_record_item_t * item = (service_record_item_t *) it;
+        sdp_uuid_index_add_sequence(item->service_record, item->service_record_handle);
+    }
+}
+#endif
+
+// same as sdp_record_matches_service_search_pattern, but uses UUID index if available
+static int sdp_record_item_matches_service_search_pattern(service_record_item_t * item, uint8_t * serviceSearchPattern){
+#ifdef ENABLE_SDP_SERVER_UUID_INDEX
+    if (sdp_uuid_index_incomplete == false){
+        bool verify = false;
+        des_iterator_t it;
+        for (des_iterator_init(&it, serviceSearchPattern); des_iterator_has_more(&it); des_iterator_next(&it)){
+            uint32_t key;
+            uint8_t  hashed;
+            if (!sdp_uuid_index_key_for_uuid(des_iterator_get_element(&it), &key, &hashed)) return 0;
+            if (!sdp_uuid_index_contains(key, hashed, item->service_record_handle)) return 0;
+            // hash collisions are possible
+            if (hashed){
+                verify = true;
+            }
+        }
+        if (verify == false) return 1;
+    }
+#endif
+    return sdp_record_matches_service_search_pattern(item->service_record, serviceSearchPattern);
+}
+
 // get next free, unregistered service record handle
 uint32_t sdp_create_service_record_handle(void){
     uint32_t handle = 0;
@@ -152,6 +302,10 @@ uint8_t sdp_register_service(const uint8_t * record){
     
     // add to linked list
     btstack_linked_list_add(&sdp_service_records, (btstack_linked_item_t *) newRecordItem);
+
+#ifdef ENABLE_SDP_SERVER_UUID_INDEX
+    sdp_uuid_index_add_sequence(newRecordItem->service_record, record_handle);
+#endif
     
     return 0;
 }
@@ -164,12 +318,15 @@ void sdp_unregister_service(uint32_t service_record_handle){
     if (!record_item) return;
     btstack_linked_list_remove(&sdp_service_records, (btstack_linked_item_t *) record_item);
     btstack_memory_service_record_item_free(record_item);
+#ifdef ENABLE_SDP_SERVER_UUID_INDEX
+    sdp_uuid_index_rebuild();
+#endif
 }
 
 // PDU
 // PDU ID (1), Transaction ID (2), Param Length (2), Param 1, Param 2, ..
 
-static int sdp_create_error_response(uint16_t transaction_id, uint16_t error_code){
+static int sdp_create_error_response(uint16_t transaction_id, uint16_t error_code, uint8_t * sdp_response_buffer){
     sdp_response_buffer[0] = SDP_ErrorResponse;
     big_endian_store_16(sdp_response_buffer, 1, transaction_id);
     big_endian_store_16(sdp_response_buffer, 3, 2);
@@ -177,7 +334,7 @@ static int sdp_create_error_response(uint16_t transaction_id, uint16_t error_cod
     return 7;
 }
 
-int sdp_handle_service_search_request(uint8_t * packet, uint16_t remote_mtu){
+int sdp_handle_service_search_request(uint8_t * packet, uint16_t remote_mtu, uint8_t * sdp_response_buffer){
     
     // get request details
     uint16_t  transaction_id = big_endian_read_16(packet, 1);
@@ -212,7 +369,7 @@ int sdp_handle_service_search_request(uint8_t * packet, uint16_t remote_mtu){
     uint16_t total_service_count   = 0;
     for (it = (btstack_linked_item_t *) sdp_service_records; it ; it = it->next){
         service_record_item_t * item = (service_record_item_t *) it;
-        if (!sdp_record_matches_service_search_pattern(item->service_record, serviceSearchPattern)) continue;
+        if (!sdp_record_item_matches_service_search_pattern(item, serviceSearchPattern)) continue;
         total_service_count++;
     }
     if (total_service_count > maximumServiceRecordCount){
@@ -227,7 +384,7 @@ int sdp_handle_service_search_request(uint8_t * packet, uint16_t remote_mtu){
     for (it = (btstack_linked_item_t *) sdp_service_records; it ; it = it->next, ++current_service_index){
         service_record_item_t * item = (service_record_item_t *) it;
 
-        if (!sdp_record_matches_service_search_pattern(item->service_record, serviceSearchPattern)) continue;
+        if (!sdp_record_item_matches_service_search_pattern(item, serviceSearchPattern)) continue;
         matching_service_count++;
         
         if (current_service_index < continuation_index) continue;
@@ -264,7 +421,7 @@ int sdp_handle_service_search_request(uint8_t * packet, uint16_t remote_mtu){
     return pos;
 }
 
-int sdp_handle_service_attribute_request(uint8_t * packet, uint16_t remote_mtu){
+int sdp_handle_service_attribute_request(uint8_t * packet, uint16_t remote_mtu, uint8_t * sdp_response_buffer){
     
     // get request details
     uint16_t  transaction_id = big_endian_read_16(packet, 1);
@@ -301,7 +458,7 @@ int sdp_handle_service_attribute_request(uint8_t * packet, uint16_t remote_mtu){
     service_record_item_t * item = sdp_get_record_item_for_handle(serviceRecordHandle);
     if (!item){
         // service record handle doesn't exist
-        return sdp_create_error_response(transaction_id, 0x0002); /// invalid Service Record Handle
+        return sdp_create_error_response(transaction_id, 0x0002, sdp_response_buffer); /// invalid Service Record Handle
     }
     
     
@@ -350,7 +507,7 @@ static uint16_t sdp_get_size_for_service_search_attribute_response(uint8_t * ser
     for (it = (btstack_linked_item_t *) sdp_service_records; it ; it = it->next){
         service_record_item_t * item = (service_record_item_t *) it;
         
-        if (!sdp_record_matches_service_search_pattern(item->service_record, serviceSearchPattern)) continue;
+        if (!sdp_record_item_matches_service_search_pattern(item, serviceSearchPattern)) continue;
         
         // for all service records that match
         total_response_size += 3 + spd_get_filtered_size(item->service_record, attributeIDList);
@@ -358,7 +515,7 @@ static uint16_t sdp_get_size_for_service_search_attribute_response(uint8_t * ser
     return total_response_size;
 }
 
-int sdp_handle_service_search_attribute_request(uint8_t * packet, uint16_t remote_mtu){
+int sdp_handle_service_search_attribute_request(uint8_t * packet, uint16_t remote_mtu, uint8_t * sdp_response_buffer){
     
     // SDP header before attribute sevice list: 7
     // Continuation, worst case: 5
@@ -423,7 +580,7 @@ int sdp_handle_service_search_attribute_request(uint8_t * packet, uint16_t remot
         service_record_item_t * item = (service_record_item_t *) it;
         
         if (current_service_index < continuation_service_index ) continue;
-        if (!sdp_record_matches_service_search_pattern(item->service_record, serviceSearchPattern)) continue;
+        if (!sdp_record_item_matches_service_search_pattern(item, serviceSearchPattern)) continue;
 
         if (continuation_offset == 0){
             
@@ -483,14 +640,78 @@ int sdp_handle_service_search_attribute_request(uint8_t * packet, uint16_t remot
     return pos;
 }
 
-static void sdp_respond(void){
-    if (!sdp_response_size ) return;
-    if (!l2cap_cid) return;
+static sdp_server_channel_t * sdp_server_channel_for_cid(uint16_t cid){
+    int i;
+    for (i=0;i<SDP_SERVER_MAX_CHANNELS;i++){
+        if (sdp_server_channels[i].l2cap_cid == cid) return &sdp_server_channels[i];
+    }
+    return NULL;
+}
+
+static void sdp_server_accept_connection(sdp_server_channel_t * channel, uint16_t cid){
+    channel->l2cap_cid = cid;
+    channel->request_len = 0;
+    l2cap_accept_connection(cid);
+}
+
+// @returns size of response in sdp_response_buffer
+static uint16_t sdp_server_handle_request(uint16_t cid, uint8_t * packet, uint16_t size, uint8_t * sdp_response_buffer){
+	uint16_t transaction_id;
+    SDP_PDU_ID_t pdu_id;
+    uint16_t remote_mtu;
+    uint16_t param_len;
+
+    pdu_id = (SDP_PDU_ID_t) packet[0];
+    transaction_id = big_endian_read_16(packet, 1);
+    param_len = big_endian_read_16(packet, 3);
+    remote_mtu = l2cap_get_remote_mtu_for_local_cid(cid);
+    // account for our buffer
+    if (remote_mtu > SDP_RESPONSE_BUFFER_SIZE){
+        remote_mtu = SDP_RESPONSE_BUFFER_SIZE;
+    }
+    if (remote_mtu > l2cap_max_mtu()){
+        remote_mtu = l2cap_max_mtu();
+    }
+    // validate parm_len against packet size
+    if ((param_len + 5) > size) {
+        // just clear pdu_id
+        pdu_id = SDP_ErrorResponse;
+    }
     
-    // update state before sending packet (avoid getting called when new l2cap credit gets emitted)
-    uint16_t size = sdp_response_size;
-    sdp_response_size = 0;
-    l2cap_send(l2cap_cid, sdp_response_buffer, size);
+    // log_info("SDP Request: type %u, transaction id %u, len %u, mtu %u", pdu_id, transaction_id, param_len, remote_mtu);
+    switch (pdu_id){
+            
+        case SDP_ServiceSearchRequest:
+            return sdp_handle_service_search_request(packet, remote_mtu, sdp_response_buffer);
+                                
+        case SDP_ServiceAttributeRequest:
+            return sdp_handle_service_attribute_request(packet, remote_mtu, sdp_response_buffer);
+            
+        case SDP_ServiceSearchAttributeRequest:
+            return sdp_handle_service_search_attribute_request(packet, remote_mtu, sdp_response_buffer);
+            
+        default:
+            return sdp_create_error_response(transaction_id, 0x0003, sdp_response_buffer); // invalid syntax
+    }
+}
+
+// create response in outgoing buffer
+static void sdp_server_respond(uint16_t cid, uint8_t * packet, uint16_t size){
+    l2cap_reserve_packet_buffer();
+    uint8_t * sdp_response_buffer = l2cap_get_outgoing_buffer();
+    uint16_t  sdp_response_size = sdp_server_handle_request(cid, packet, size, sdp_response_buffer);
+    if (!sdp_response_size){
+        l2cap_release_packet_buffer();
+        return;
+    }
+    l2cap_send_prepared(cid, sdp_response_size);
+}
+
+// request could not be stored completely
+static void sdp_server_respond_insufficient_resources(uint16_t cid, uint16_t transaction_id){
+    l2cap_reserve_packet_buffer();
+    uint8_t * sdp_response_buffer = l2cap_get_outgoing_buffer();
+    l2cap_send_prepared(cid, sdp_create_error_response(transaction_id, 0x0006, sdp_response_buffer)); // insufficient resources
 }
 
 // @pre space in list
@@ -508,51 +729,30 @@ static uint16_t sdp_waiting_list_get(void){
     return cid;
 }
 
-// we assume that we don't get two requests in a row
+// we assume that we don't get two requests in a row on the same channel
 static void sdp_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
-	uint16_t transaction_id;
-    SDP_PDU_ID_t pdu_id;
-    uint16_t remote_mtu;
-    uint16_t param_len;
+    sdp_server_channel_t * server_channel;
+    uint16_t cid;
     
 	switch (packet_type) {
 			
 		case L2CAP_DATA_PACKET:
-            pdu_id = (SDP_PDU_ID_t) packet[0];
-            transaction_id = big_endian_read_16(packet, 1);
-            param_len = big_endian_read_16(packet, 3);
-            remote_mtu = l2cap_get_remote_mtu_for_local_cid(channel);
-            // account for our buffer
-            if (remote_mtu > SDP_RESPONSE_BUFFER_SIZE){
-                remote_mtu = SDP_RESPONSE_BUFFER_SIZE;
-            }
-            // validate parm_len against packet size
-            if ((param_len + 5) > size) {
-                // just clear pdu_id
-                pdu_id = SDP_ErrorResponse;
+            server_channel = sdp_server_channel_for_cid(channel);
+            if (server_channel == NULL) break;
+            if (size < 5) break;
+            if (server_channel->request_len != 0){
+                log_info("request on cid 0x%04x while response pending, dropped", channel);
+                break;
             }
-            
-            // log_info("SDP Request: type %u, transaction id %u, len %u, mtu %u", pdu_id, transaction_id, param_len, remote_mtu);
-            switch (pdu_id){
-                    
-                case SDP_ServiceSearchRequest:
-                    sdp_response_size = sdp_handle_service_search_request(packet, remote_mtu);
-                    break;
-                                        
-                case SDP_ServiceAttributeRequest:
-                    sdp_response_size = sdp_handle_service_attribute_request(packet, remote_mtu);
-                    break;
-                    
-                case SDP_ServiceSearchAttributeRequest:
-                    sdp_response_size = sdp_handle_service_search_attribute_request(packet, remote_mtu);
-                    break;
-                    
-                default:
-                    sdp_response_size = sdp_create_error_response(transaction_id, 0x0003); // invalid syntax
-                    break;
+            // respond right away if possible
+            if (l2cap_can_send_packet_now(channel)){
+                sdp_server_respond(channel, packet, size);
+                break;
             }
-            if (!sdp_response_size) break;
-            l2cap_request_can_send_now_event(l2cap_cid);
+            // store request, or only header if too large
+            server_channel->request_len = size;
+            (void)memcpy(server_channel->request, packet, btstack_min(size, SDP_SERVER_REQUEST_BUFFER_SIZE));
+            l2cap_request_can_send_now_event(channel);
 			break;
 			
 		case HCI_EVENT_PACKET:
@@ -560,52 +760,65 @@ static void sdp_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *p
 			switch (hci_event_packet_get_type(packet)) {
 
 				case L2CAP_EVENT_INCOMING_CONNECTION:
-                    if (l2cap_cid) {
+                    cid = l2cap_event_incoming_connection_get_local_cid(packet);
+                    server_channel = sdp_server_channel_for_cid(0);
+                    if (server_channel == NULL) {
                         // try to queue up
                         if (l2cap_waiting_list_count < SDP_WAITING_LIST_MAX_COUNT){
-                            sdp_waiting_list_add(channel);
-                            log_info("busy, queing incoming cid 0x%04x, now %u waiting", channel, l2cap_waiting_list_count);
+                            sdp_waiting_list_add(cid);
+                            log_info("busy, queing incoming cid 0x%04x, now %u waiting", cid, l2cap_waiting_list_count);
                             break;
                         }
 
                         // CONNECTION REJECTED DUE TO LIMITED RESOURCES 
-                        l2cap_decline_connection(channel);
+                        l2cap_decline_connection(cid);
                         break;
                     }
                     // accept
-                    l2cap_cid = channel;
-                    sdp_response_size = 0;
-                    l2cap_accept_connection(l2cap_cid);
+                    sdp_server_accept_connection(server_channel, cid);
 					break;
                     
                 case L2CAP_EVENT_CHANNEL_OPENED:
                     if (packet[2]) {
                         // open failed -> reset
-                        l2cap_cid = 0;
+                        server_channel = sdp_server_channel_for_cid(l2cap_event_channel_opened_get_local_cid(packet));
+                        if (server_channel == NULL) break;
+                        server_channel->l2cap_cid = 0;
                     }
                     break;
 
                 case L2CAP_EVENT_CAN_SEND_NOW:
-                    sdp_respond();
+                    cid = l2cap_event_can_send_now_get_local_cid(packet);
+                    server_channel = sdp_server_channel_for_cid(cid);
+                    if (server_channel == NULL) break;
+                    if (server_channel->request_len == 0) break;
+                    // update state before sending packet (avoid getting called when new l2cap credit gets emitted)
+                    size = server_channel->request_len;
+                    server_channel->request_len = 0;
+                    if (size > SDP_SERVER_REQUEST_BUFFER_SIZE){
+                        sdp_server_respond_insufficient_resources(cid, big_endian_read_16(server_channel->request, 1));
+                        break;
+                    }
+                    sdp_server_respond(cid, server_channel->request, size);
                     break;
                 
                 case L2CAP_EVENT_CHANNEL_CLOSED:
-                    if (channel == l2cap_cid){
-                        // reset
-                        l2cap_cid = 0;
+                    server_channel = sdp_server_channel_for_cid(l2cap_event_channel_closed_get_local_cid(packet));
+                    if (server_channel == NULL) break;
 
-                        // other request queued?
-                        if (!l2cap_waiting_list_count) break;
+                    // reset
+                    server_channel->l2cap_cid = 0;
 
-                        // get first item 
-                        l2cap_cid = sdp_waiting_list_get();
+                    // other request queued?
+                    if (!l2cap_waiting_list_count) break;
 
-                        log_info("disconnect, accept queued cid 0x%04x, now %u waiting", l2cap_cid, l2cap_waiting_list_count);
+                    // get first item 
+                    cid = sdp_waiting_list_get();
 
-                        // accept connection
-                        sdp_response_size = 0;
-                        l2cap_accept_connection(l2cap_cid);
-                    }
+                    log_info("disconnect, accept queued cid 0x%04x, now %u waiting", cid, l2cap_waiting_list_count);
+
+                    // accept connection
+                    sdp_server_accept_connection(server_channel, cid);
                     break;
 					                    
 				default:
@@ -619,4 +832,3 @@ static void sdp_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *p
 			break;
 	}
 }
-
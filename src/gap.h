@@ -42,6 +42,7 @@
 extern "C" {
 #endif
 
+#include "ad_parser.h"
 #include "btstack_defines.h"
 #include "btstack_util.h"
 #include "classic/btstack_link_key_db.h"
@@ -112,6 +113,13 @@ typedef enum {
     AUTHORIZATION_GRANTED
 } authorization_state_t;
 
+// iterator for reports in GAP_EVENT_ADVERTISING_REPORT_BATCH
+typedef struct {
+    const uint8_t * data;
+    uint16_t        size;
+    uint16_t        offset;
+} gap_advertising_report_iterator_t;
+
 
 /* API_START */
 
@@ -283,6 +291,63 @@ void gap_start_scan(void);
  */
 void gap_stop_scan(void);
 
+/**
+ * @brief Enable host-side filter for duplicate advertising reports. Requires ENABLE_LE_SCAN_FILTER
+ * @note Reports are duplicates if address, advertising event type and data are the same.
+ *       The cache is cleared on gap_start_scan and can hold LE_SCAN_FILTER_CACHE_SIZE reports.
+ * @param enabled
+ * @param report_interval_ms duplicates are reported again after this time per device and data, 0 = only report changes
+ */
+void gap_le_scan_filter_set_duplicate_filter(int enabled, uint32_t report_interval_ms);
+
+/**
+ * @brief Drop advertising reports with lower RSSI. Requires ENABLE_LE_SCAN_FILTER
+ * @param rssi_threshold in dBm, default: -128 = deliver all reports
+ */
+void gap_le_scan_filter_set_rssi_threshold(int8_t rssi_threshold);
+
+/**
+ * @brief Drop advertising reports that don't match any rule of the Advertising Data Filter. Requires ENABLE_LE_SCAN_FILTER
+ * @note Advertisements and Scan Responses are checked independently
+ * @param ad_filter has to stay valid while used, NULL = deliver all reports
+ */
+void gap_le_scan_filter_set_ad_filter(const ad_filter_t * ad_filter);
+
+/**
+ * @brief Deliver advertising reports in GAP_EVENT_ADVERTISING_REPORT_BATCH events instead of
+ *        GAP_EVENT_ADVERTISING_REPORT. Requires ENABLE_LE_SCAN_FILTER
+ * @note A batch is emitted when it is full or max_delay_ms after its first report
+ * @param max_delay_ms, 0 = disable batching
+ */
+void gap_le_scan_filter_set_batching(uint16_t max_delay_ms);
+
+/**
+ * @brief Init iterator for reports in GAP_EVENT_ADVERTISING_REPORT_BATCH
+ * @param it
+ * @param event
+ */
+void gap_advertising_report_iterator_init(gap_advertising_report_iterator_t * it, const uint8_t * event);
+
+/**
+ * @brief Check if iterator points to a complete report
+ */
+int  gap_advertising_report_iterator_has_more(const gap_advertising_report_iterator_t * it);
+
+/**
+ * @brief Advance to next report
+ */
+void gap_advertising_report_iterator_next(gap_advertising_report_iterator_t * it);
+
+/**
+ * @brief Getters for current report, see GAP_EVENT_ADVERTISING_REPORT
+ */
+uint8_t gap_advertising_report_iterator_get_advertising_event_type(const gap_advertising_report_iterator_t * it);
+uint8_t gap_advertising_report_iterator_get_address_type(const gap_advertising_report_iterator_t * it);
+void    gap_advertising_report_iterator_get_address(const gap_advertising_report_iterator_t * it, bd_addr_t address);
+int8_t  gap_advertising_report_iterator_get_rssi(const gap_advertising_report_iterator_t * it);
+uint8_t gap_advertising_report_iterator_get_data_length(const gap_advertising_report_iterator_t * it);
+const uint8_t * gap_advertising_report_iterator_get_data(const gap_advertising_report_iterator_t * it);
+
 /**
  * @brief Enable privacy by using random addresses
  * @param random_address_type to use (incl. OFF)
@@ -459,6 +524,22 @@ void gap_auto_connection_stop_all(void);
  */
 uint8_t gap_le_set_phy(hci_con_handle_t con_handle, uint8_t all_phys, uint8_t tx_phys, uint8_t rx_phys, uint8_t phy_options);
 
+/**
+ * @brief Optimize throughput of new LE connections. Requires ENABLE_LE_THROUGHPUT_OPTIMIZER
+ * @note After connection, the maximal LE Data Length is requested, followed by the LE 2M PHY and, if GATT Client is
+ *       initialized, the exchange of an ATT MTU that fills complete LL PDUs. The achieved parameters are reported in
+ *       GAP_EVENT_LE_THROUGHPUT_OPTIMIZATION_COMPLETE
+ * @param enabled
+ */
+void gap_le_throughput_optimizer_enable(bool enabled);
+
+/**
+ * @brief Optimize throughput of existing LE connection. Requires ENABLE_LE_THROUGHPUT_OPTIMIZER
+ * @param con_handle
+ * @returns ERROR_CODE_SUCCESS, ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER, or ERROR_CODE_COMMAND_DISALLOWED if already active
+ */
+uint8_t gap_le_throughput_optimizer_start(hci_con_handle_t con_handle);
+
 /**
  * @brief Get connection interval
  * @return connection interval, otherwise 0 if error 
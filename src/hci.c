@@ -75,6 +75,7 @@
 #include "gap.h"
 #include "hci.h"
 #include "hci_cmd.h"
+#include "hci_cmd_encoder.h"
 #include "hci_dump.h"
 #include "ad_parser.h"
 
@@ -214,6 +215,15 @@ static hci_connection_t * create_connection_for_bd_addr_and_type(bd_addr_t addr,
 #endif
 #ifdef ENABLE_LE_LIMIT_ACL_FRAGMENT_BY_MAX_OCTETS
     conn->le_max_tx_octets = 27;
+#endif
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+    // defaults for new connection
+    conn->le_data_length_max_tx_octets = 27;
+    conn->le_data_length_max_tx_time   = 328;
+    conn->le_data_length_max_rx_octets = 27;
+    conn->le_data_length_max_rx_time   = 328;
+    conn->le_tx_phy = 1;
+    conn->le_rx_phy = 1;
 #endif
     btstack_linked_list_add(&hci_stack->connections, (btstack_linked_item_t *) conn);
     return conn;
@@ -451,8 +461,30 @@ static int nr_hci_connections(void){
     return count;
 }
 
-static int hci_number_free_acl_slots_for_connection_type(bd_addr_type_t address_type){
-    
+// update outgoing packet count for connection and ACL totals
+static void hci_connection_add_packets_sent(hci_connection_t * connection, uint16_t num_packets){
+    connection->num_packets_sent += num_packets;
+    if (hci_is_le_connection(connection)){
+        hci_stack->le_acl_packets_sent_num += num_packets;
+    }
+    if (connection->address_type == BD_ADDR_TYPE_ACL){
+        hci_stack->acl_packets_sent_num += num_packets;
+    }
+}
+
+static void hci_connection_remove_packets_sent(hci_connection_t * connection, uint16_t num_packets){
+    connection->num_packets_sent -= num_packets;
+    if (hci_is_le_connection(connection)){
+        hci_stack->le_acl_packets_sent_num -= num_packets;
+    }
+    if (connection->address_type == BD_ADDR_TYPE_ACL){
+        hci_stack->acl_packets_sent_num -= num_packets;
+    }
+}
+
+#ifdef ENABLE_LOG_DEBUG
+// verify that ACL totals match sum over all connections
+static void hci_acl_packets_sent_self_check(void){
     unsigned int num_packets_sent_classic = 0;
     unsigned int num_packets_sent_le = 0;
 
@@ -466,6 +498,23 @@ static int hci_number_free_acl_slots_for_connection_type(bd_addr_type_t address_
             num_packets_sent_classic += connection->num_packets_sent;
         }
     }
+    if ((num_packets_sent_classic != hci_stack->acl_packets_sent_num) || (num_packets_sent_le != hci_stack->le_acl_packets_sent_num)){
+        log_error("hci_number_free_acl_slots: ACL packet count mismatch, classic %u != %u, le %u != %u",
+                  num_packets_sent_classic, hci_stack->acl_packets_sent_num, num_packets_sent_le, hci_stack->le_acl_packets_sent_num);
+        btstack_assert(false);
+    }
+}
+#endif
+
+static int hci_number_free_acl_slots_for_connection_type(bd_addr_type_t address_type){
+    
+#ifdef ENABLE_LOG_DEBUG
+    hci_acl_packets_sent_self_check();
+#endif
+
+    unsigned int num_packets_sent_classic = hci_stack->acl_packets_sent_num;
+    unsigned int num_packets_sent_le      = hci_stack->le_acl_packets_sent_num;
+
     log_debug("ACL classic buffers: %u used of %u", num_packets_sent_classic, hci_stack->acl_packets_total_num);
     int free_slots_classic = hci_stack->acl_packets_total_num - num_packets_sent_classic;
     int free_slots_le = 0;
@@ -517,6 +566,90 @@ int hci_number_free_acl_slots_for_handle(hci_con_handle_t con_handle){
     return hci_number_free_acl_slots_for_connection_type(connection->address_type);
 }
 
+static uint8_t * hci_acl_tx_priority_connections_for_connection(hci_connection_t * connection){
+    if (hci_is_le_connection(connection)){
+        return hci_stack->le_acl_tx_priority_connections;
+    }
+    return hci_stack->acl_tx_priority_connections;
+}
+
+static void hci_connection_set_acl_tx_priority(hci_connection_t * connection, hci_acl_tx_priority_t priority){
+    uint8_t * priority_connections = hci_acl_tx_priority_connections_for_connection(connection);
+    if (connection->acl_tx_priority != HCI_ACL_TX_PRIORITY_BULK){
+        priority_connections[connection->acl_tx_priority]--;
+    }
+    connection->acl_tx_priority = priority;
+    if (connection->acl_tx_priority != HCI_ACL_TX_PRIORITY_BULK){
+        priority_connections[connection->acl_tx_priority]++;
+    }
+}
+
+// lower priority connections leave one ACL buffer per higher priority class with active connections
+static bool hci_connection_acl_tx_priority_can_send_now(hci_connection_t * connection){
+    bool le_connection = hci_is_le_connection(connection);
+    bool shared_buffers = hci_stack->le_acl_packets_total_num == 0;
+    int reserved_slots = 0;
+    int priority;
+    for (priority = (int) connection->acl_tx_priority + 1; priority < (int) HCI_ACL_TX_PRIORITY_NUM; priority++){
+        int num_connections = 0;
+        if (shared_buffers || !le_connection){
+            num_connections += hci_stack->acl_tx_priority_connections[priority];
+        }
+        if (shared_buffers || le_connection){
+            num_connections += hci_stack->le_acl_tx_priority_connections[priority];
+        }
+        if (num_connections > 0){
+            reserved_slots++;
+        }
+    }
+    if (reserved_slots == 0) return true;
+
+    // keep at least one buffer usable
+    int total_slots = (le_connection && !shared_buffers) ? hci_stack->le_acl_packets_total_num : hci_stack->acl_packets_total_num;
+    if (reserved_slots >= total_slots){
+        reserved_slots = total_slots - 1;
+    }
+    return hci_number_free_acl_slots_for_connection_type(connection->address_type) > reserved_slots;
+}
+
+uint8_t hci_set_acl_tx_priority(hci_con_handle_t con_handle, hci_acl_tx_priority_t priority){
+    hci_connection_t * connection = hci_connection_for_handle(con_handle);
+    if (connection == NULL) return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
+    if (priority >= HCI_ACL_TX_PRIORITY_NUM) return ERROR_CODE_INVALID_HCI_COMMAND_PARAMETERS;
+    if ((connection->address_type == BD_ADDR_TYPE_SCO) || (connection->address_type == BD_ADDR_TYPE_UNKNOWN)) return ERROR_CODE_COMMAND_DISALLOWED;
+    hci_connection_set_acl_tx_priority(connection, priority);
+    return ERROR_CODE_SUCCESS;
+}
+
+hci_acl_tx_priority_t hci_get_acl_tx_priority(hci_con_handle_t con_handle){
+    hci_connection_t * connection = hci_connection_for_handle(con_handle);
+    if (connection == NULL) return HCI_ACL_TX_PRIORITY_BULK;
+    return connection->acl_tx_priority;
+}
+
+bool hci_acl_tx_priority_can_send_now(hci_con_handle_t con_handle){
+    hci_connection_t * connection = hci_connection_for_handle(con_handle);
+    if (connection == NULL) return false;
+    return hci_connection_acl_tx_priority_can_send_now(connection);
+}
+
+void hci_acl_tx_priority_packet_deferred(hci_con_handle_t con_handle){
+    hci_connection_t * connection = hci_connection_for_handle(con_handle);
+    if (connection == NULL) return;
+    // count each PDU held back only once
+    if (connection->acl_tx_deferred) return;
+    connection->acl_tx_deferred = true;
+    connection->acl_tx_statistics.packets_deferred++;
+}
+
+uint8_t hci_get_acl_tx_statistics(hci_con_handle_t con_handle, hci_acl_tx_statistics_t * statistics){
+    hci_connection_t * connection = hci_connection_for_handle(con_handle);
+    if (connection == NULL) return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
+    *statistics = connection->acl_tx_statistics;
+    statistics->packets_in_flight = connection->num_packets_sent;
+    return ERROR_CODE_SUCCESS;
+}
+
 #ifdef ENABLE_CLASSIC
 static int hci_number_free_sco_slots(void){
     unsigned int num_sco_packets_sent  = 0;
@@ -679,16 +812,20 @@ static int hci_send_acl_packet_fragments(hci_connection_t *connection){
 
         // copy handle_and_flags if not first fragment and update packet boundary flags to be 01 (continuing fragmnent)
         if (acl_header_pos > 0){
-            uint16_t handle_and_flags = little_endian_read_16(hci_stack->hci_packet_buffer, 0);
+            uint16_t handle_and_flags = little_endian_read_16(hci_stack->acl_fragmentation_packet, 0);
             handle_and_flags = (handle_and_flags & 0xcfff) | (1 << 12);
-            little_endian_store_16(hci_stack->hci_packet_buffer, acl_header_pos, handle_and_flags);
+            little_endian_store_16(hci_stack->acl_fragmentation_packet, acl_header_pos, handle_and_flags);
         }
 
         // update header len
-        little_endian_store_16(hci_stack->hci_packet_buffer, acl_header_pos + 2, current_acl_data_packet_length);
+        little_endian_store_16(hci_stack->acl_fragmentation_packet, acl_header_pos + 2, current_acl_data_packet_length);
 
         // count packet
-        connection->num_packets_sent++;
+        hci_connection_add_packets_sent(connection, 1);
+        connection->acl_tx_statistics.packets_sent++;
+        if (connection->num_packets_sent > connection->acl_tx_statistics.packets_in_flight_max){
+            connection->acl_tx_statistics.packets_in_flight_max = connection->num_packets_sent;
+        }
         log_debug("hci_send_acl_packet_fragments loop before send (more fragments %d)", more_fragments);
 
         // update state for next fragment (if any) as "transport done" might be sent during send_packet already
@@ -702,7 +839,7 @@ static int hci_send_acl_packet_fragments(hci_connection_t *connection){
         }
 
         // send packet
-        uint8_t * packet = &hci_stack->hci_packet_buffer[acl_header_pos];
+        uint8_t * packet = &hci_stack->acl_fragmentation_packet[acl_header_pos];
         const int size = current_acl_data_packet_length + 4;
         hci_dump_packet(HCI_ACL_DATA_PACKET, 0, packet, size);
         hci_stack->acl_fragmentation_tx_active = 1;
@@ -729,17 +866,8 @@ static int hci_send_acl_packet_fragments(hci_connection_t *connection){
     return err;
 }
 
-// pre: caller has reserved the packet buffer
-int hci_send_acl_packet_buffer(int size){
-
-    // log_info("hci_send_acl_packet_buffer size %u", size);
+static int hci_send_acl_packet(uint8_t * packet, int size){
 
-    if (!hci_stack->hci_packet_buffer_reserved) {
-        log_error("hci_send_acl_packet_buffer called without reserving packet buffer");
-        return 0;
-    }
-
-    uint8_t * packet = hci_stack->hci_packet_buffer;
     hci_con_handle_t con_handle = READ_ACL_CONNECTION_HANDLE(packet);
 
     // check for free places on Bluetooth module
@@ -764,13 +892,41 @@ int hci_send_acl_packet_buffer(int size){
 
     // hci_dump_packet( HCI_ACL_DATA_PACKET, 0, packet, size);
 
+    connection->acl_tx_statistics.sdus_sent++;
+    connection->acl_tx_deferred = false;
+
     // setup data
+    hci_stack->acl_fragmentation_packet = packet;
     hci_stack->acl_fragmentation_total_size = size;
     hci_stack->acl_fragmentation_pos = 4;   // start of L2CAP packet
 
     return hci_send_acl_packet_fragments(connection);
 }
 
+// pre: caller has reserved the packet buffer
+int hci_send_acl_packet_buffer(int size){
+
+    // log_info("hci_send_acl_packet_buffer size %u", size);
+
+    if (!hci_stack->hci_packet_buffer_reserved) {
+        log_error("hci_send_acl_packet_buffer called without reserving packet buffer");
+        return 0;
+    }
+
+    return hci_send_acl_packet(hci_stack->hci_packet_buffer, size);
+}
+
+// pre: caller has reserved the packet buffer
+int hci_send_acl_packet_external(uint8_t * packet, int size){
+
+    if (!hci_stack->hci_packet_buffer_reserved) {
+        log_error("hci_send_acl_packet_external called without reserving packet buffer");
+        return 0;
+    }
+
+    return hci_send_acl_packet(packet, size);
+}
+
 #ifdef ENABLE_CLASSIC
 // pre: caller has reserved the packet buffer
 int hci_send_sco_packet_buffer(int size){
@@ -949,6 +1105,10 @@ static void hci_shutdown_connection(hci_connection_t *conn){
 #endif
 
     btstack_run_loop_remove_timer(&conn->timeout);
+
+    // outgoing packets are flushed by controller
+    hci_connection_remove_packets_sent(conn, conn->num_packets_sent);
+    hci_connection_set_acl_tx_priority(conn, HCI_ACL_TX_PRIORITY_BULK);
     
     btstack_linked_list_remove(&hci_stack->connections, (btstack_linked_item_t *) conn);
     btstack_memory_hci_connection_free( conn );
@@ -1078,6 +1238,122 @@ void gap_le_get_own_address(uint8_t * addr_type, bd_addr_t addr){
 }
 
 #ifdef ENABLE_LE_CENTRAL
+
+#ifdef ENABLE_LE_SCAN_FILTER
+
+// max number of cache entries checked for a report
+#define LE_SCAN_FILTER_MAX_PROBES 8
+
+// FNV-1a
+static uint32_t hci_le_scan_filter_hash(uint32_t hash, const uint8_t * data, uint16_t len){
+    uint16_t i;
+    for (i=0;i<len;i++){
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void hci_le_scan_filter_reset_cache(void){
+    int i;
+    for (i=0;i<LE_SCAN_FILTER_CACHE_SIZE;i++){
+        hci_stack->le_scan_filter_cache[i].address_type = 0xff;
+    }
+}
+
+// report: event type, address type, address, data length, data, rssi as in HCI LE Advertising Report
+static int hci_le_scan_filter_accept(const uint8_t * report, uint8_t data_length, int8_t rssi){
+    // rssi 127 = not available
+    if ((rssi != 127) && (rssi < hci_stack->le_scan_filter_rssi_threshold)) return 0;
+    if ((hci_stack->le_scan_filter_ad_filter != NULL) && (ad_filter_match(hci_stack->le_scan_filter_ad_filter, data_length, &report[9]) == 0u)) return 0;
+    if (!hci_stack->le_scan_filter_duplicates) return 1;
+
+    uint8_t  address_type = report[1];
+    uint32_t payload_hash = hci_le_scan_filter_hash(2166136261u, &report[0], 1);
+    payload_hash = hci_le_scan_filter_hash(payload_hash, &report[9], data_length);
+    uint32_t key_hash = hci_le_scan_filter_hash(payload_hash, &report[1], 7);
+
+    // lookup address and payload, remember free or least recently reported entry for insert
+    uint32_t now = btstack_run_loop_get_time_ms();
+    le_scan_filter_entry_t * victim = NULL;
+    uint32_t victim_age = 0;
+    uint32_t index = key_hash % LE_SCAN_FILTER_CACHE_SIZE;
+    int probe;
+    for (probe = 0; (probe < LE_SCAN_FILTER_MAX_PROBES) && (probe < LE_SCAN_FILTER_CACHE_SIZE); probe++){
+        le_scan_filter_entry_t * entry = &hci_stack->le_scan_filter_cache[index];
+        index++;
+        if (index == LE_SCAN_FILTER_CACHE_SIZE){
+            index = 0;
+        }
+        if (entry->address_type == 0xff){
+            if ((victim == NULL) || (victim->address_type != 0xff)){
+                victim = entry;
+            }
+            continue;
+        }
+        if ((entry->payload_hash == payload_hash) && (entry->address_type == address_type) && (memcmp(entry->address, &report[2], 6) == 0)){
+            // duplicate, report again after interval if set
+            if (hci_stack->le_scan_filter_report_interval_ms == 0) return 0;
+            if ((now - entry->last_report_ms) < hci_stack->le_scan_filter_report_interval_ms) return 0;
+            entry->last_report_ms = now;
+            return 1;
+        }
+        if ((victim != NULL) && (victim->address_type == 0xff)) continue;
+        uint32_t age = now - entry->last_report_ms;
+        if ((victim == NULL) || (age > victim_age)){
+            victim = entry;
+            victim_age = age;
+        }
+    }
+
+    // new device or changed data
+    victim->address_type = address_type;
+    (void)memcpy(victim->address, &report[2], 6);
+    victim->payload_hash = payload_hash;
+    victim->last_report_ms = now;
+    return 1;
+}
+
+static void hci_le_scan_filter_batch_flush(void){
+    if (hci_stack->le_scan_filter_batch_num_reports == 0) return;
+    btstack_run_loop_remove_timer(&hci_stack->le_scan_filter_batch_timer);
+    uint16_t size = hci_stack->le_scan_filter_batch_pos;
+    uint8_t * event = hci_stack->le_scan_filter_batch;
+    event[0] = GAP_EVENT_ADVERTISING_REPORT_BATCH;
+    event[1] = size - 2;
+    event[2] = hci_stack->le_scan_filter_batch_num_reports;
+    event[3] = size - 4;
+    hci_stack->le_scan_filter_batch_num_reports = 0;
+    hci_stack->le_scan_filter_batch_pos = 4;
+    hci_emit_event(event, size, 1);
+}
+
+static void hci_le_scan_filter_batch_timeout_handler(btstack_timer_source_t * ts){
+    UNUSED(ts);
+    hci_le_scan_filter_batch_flush();
+}
+
+static void hci_le_scan_filter_batch_add(const uint8_t * report, uint8_t data_length, int8_t rssi){
+    uint16_t report_size = 10 + data_length;
+    if ((hci_stack->le_scan_filter_batch_pos + report_size) > sizeof(hci_stack->le_scan_filter_batch)){
+        hci_le_scan_filter_batch_flush();
+    }
+    if (hci_stack->le_scan_filter_batch_num_reports == 0){
+        btstack_run_loop_set_timer_handler(&hci_stack->le_scan_filter_batch_timer, &hci_le_scan_filter_batch_timeout_handler);
+        btstack_run_loop_set_timer(&hci_stack->le_scan_filter_batch_timer, hci_stack->le_scan_filter_batch_max_delay_ms);
+        btstack_run_loop_add_timer(&hci_stack->le_scan_filter_batch_timer);
+    }
+    // same layout as GAP_EVENT_ADVERTISING_REPORT without event header
+    uint8_t * pos = &hci_stack->le_scan_filter_batch[hci_stack->le_scan_filter_batch_pos];
+    (void)memcpy(pos, report, 1 + 1 + 6); // event type + address type + address
+    pos[8] = (uint8_t) rssi;
+    pos[9] = data_length;
+    (void)memcpy(&pos[10], &report[9], data_length);
+    hci_stack->le_scan_filter_batch_pos += report_size;
+    hci_stack->le_scan_filter_batch_num_reports++;
+}
+#endif
+
 void le_handle_advertisement_report(uint8_t *packet, uint16_t size){
 
     int offset = 3;
@@ -1092,20 +1368,28 @@ void le_handle_advertisement_report(uint8_t *packet, uint16_t size){
         uint8_t data_length = packet[offset + 8];
         if (data_length > LE_ADVERTISING_DATA_SIZE) return;
         if ((offset + 9 + data_length + 1) > size)    return;
+        // event type, address type, address, data length, data, rssi
+        const uint8_t * report = &packet[offset];
+        int8_t rssi = (int8_t) report[9 + data_length];
+        offset += 10 + data_length;
+#ifdef ENABLE_LE_SCAN_FILTER
+        if (!hci_le_scan_filter_accept(report, data_length, rssi)) continue;
+        if (hci_stack->le_scan_filter_batch_max_delay_ms != 0){
+            hci_le_scan_filter_batch_add(report, data_length, rssi);
+            continue;
+        }
+#endif
         // setup event
         uint8_t event_size = 10 + data_length;
         int pos = 0;
         event[pos++] = GAP_EVENT_ADVERTISING_REPORT;
         event[pos++] = event_size;
-        (void)memcpy(&event[pos], &packet[offset], 1 + 1 + 6); // event type + address type + address
-        offset += 8;
+        (void)memcpy(&event[pos], report, 1 + 1 + 6); // event type + address type + address
         pos += 8;
-        event[pos++] = packet[offset + 1 + data_length]; // rssi
+        event[pos++] = (uint8_t) rssi;
         event[pos++] = data_length;
-        offset++;
-        (void)memcpy(&event[pos], &packet[offset], data_length);
+        (void)memcpy(&event[pos], &report[9], data_length);
         pos +=    data_length;
-        offset += data_length + 1; // rssi
         hci_emit_event(event, pos, 1);
     }
 }
@@ -1137,6 +1421,84 @@ static void hci_reenable_advertisements_if_needed(void){
 #endif
 #endif
 
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+
+// LE Throughput Optimizer: largest LL PDU and transmit time on LE 1M PHY
+#define LE_THROUGHPUT_OPTIMIZER_MAX_TX_OCTETS  251
+#define LE_THROUGHPUT_OPTIMIZER_MAX_TX_TIME   2120
+
+static void hci_emit_le_throughput_optimization_complete(hci_connection_t * conn, uint16_t att_mtu){
+    uint8_t event[16];
+    event[0] = GAP_EVENT_LE_THROUGHPUT_OPTIMIZATION_COMPLETE;
+    event[1] = sizeof(event) - 2;
+    little_endian_store_16(event,  2, conn->con_handle);
+    little_endian_store_16(event,  4, conn->le_data_length_max_tx_octets);
+    little_endian_store_16(event,  6, conn->le_data_length_max_tx_time);
+    little_endian_store_16(event,  8, conn->le_data_length_max_rx_octets);
+    little_endian_store_16(event, 10, conn->le_data_length_max_rx_time);
+    event[12] = conn->le_tx_phy;
+    event[13] = conn->le_rx_phy;
+    little_endian_store_16(event, 14, att_mtu);
+    hci_emit_event(event, sizeof(event), 1);
+}
+
+static void hci_le_throughput_optimizer_exchange_mtu(hci_connection_t * conn){
+    if (hci_stack->le_throughput_optimizer_mtu_exchange_handler == NULL){
+        // report MTU negotiated by remote GATT Client, if any
+        conn->le_throughput_optimizer_state = LE_THROUGHPUT_OPTIMIZER_DONE;
+        uint16_t att_mtu = (conn->att_server.connection.mtu != 0u) ? conn->att_server.connection.mtu : ATT_DEFAULT_MTU;
+        hci_emit_le_throughput_optimization_complete(conn, att_mtu);
+        return;
+    }
+    // handler might report result right away
+    conn->le_throughput_optimizer_state = LE_THROUGHPUT_OPTIMIZER_W4_MTU_EXCHANGE_COMPLETE;
+    (*hci_stack->le_throughput_optimizer_mtu_exchange_handler)(conn->con_handle, conn->le_data_length_max_tx_octets);
+}
+
+static void hci_le_throughput_optimizer_set_phy(hci_connection_t * conn){
+    // bit 11 = LE Set PHY
+    if ((hci_stack->local_supported_commands[1] & 0x08) == 0u){
+        hci_le_throughput_optimizer_exchange_mtu(conn);
+        return;
+    }
+    conn->le_throughput_optimizer_state = LE_THROUGHPUT_OPTIMIZER_W2_SET_PHY;
+}
+
+static void hci_le_throughput_optimizer_start(hci_connection_t * conn){
+    // bit 10 = LE Set Data Length
+    if ((hci_stack->local_supported_commands[1] & 0x04) == 0u){
+        hci_le_throughput_optimizer_set_phy(conn);
+        return;
+    }
+    conn->le_throughput_optimizer_state = LE_THROUGHPUT_OPTIMIZER_W2_SET_DATA_LENGTH;
+}
+
+static bool hci_run_le_throughput_optimizer(hci_connection_t * conn){
+    uint16_t max_tx_octets = LE_THROUGHPUT_OPTIMIZER_MAX_TX_OCTETS;
+    uint16_t max_tx_time   = LE_THROUGHPUT_OPTIMIZER_MAX_TX_TIME;
+    switch (conn->le_throughput_optimizer_state){
+        case LE_THROUGHPUT_OPTIMIZER_W2_SET_DATA_LENGTH:
+#ifdef ENABLE_LE_DATA_LENGTH_EXTENSION
+            if (hci_stack->le_supported_max_tx_octets != 0u){
+                max_tx_octets = hci_stack->le_supported_max_tx_octets;
+                max_tx_time   = hci_stack->le_supported_max_tx_time;
+            }
+#endif
+            conn->le_throughput_optimizer_state = LE_THROUGHPUT_OPTIMIZER_W4_SET_DATA_LENGTH_COMPLETE;
+            hci_send_cmd(&hci_le_set_data_length, conn->con_handle, max_tx_octets, max_tx_time);
+            return true;
+        case LE_THROUGHPUT_OPTIMIZER_W2_SET_PHY:
+            // prefer LE 2M for rx and tx, controller falls back to LE 1M if not supported by remote
+            conn->le_throughput_optimizer_state = LE_THROUGHPUT_OPTIMIZER_W4_PHY_UPDATE_COMPLETE;
+            hci_stack->le_throughput_optimizer_set_phy_con_handle = conn->con_handle;
+            hci_send_cmd(&hci_le_set_phy, conn->con_handle, 0, 0x02, 0x02, 0);
+            return true;
+        default:
+            return false;
+    }
+}
+#endif
+
 #if !defined(HAVE_PLATFORM_IPHONE_OS) && !defined (HAVE_HOST_CONTROLLER_API)
 
 static uint32_t hci_transport_uart_get_main_baud_rate(void){
@@ -1534,7 +1896,7 @@ static void hci_initializing_run(void){
         case HCI_INIT_LE_SET_SCAN_PARAMETERS:
             // LE Scan Parameters: active scanning, 300 ms interval, 30 ms window, own address type, accept all advs
             hci_stack->substate = HCI_INIT_W4_LE_SET_SCAN_PARAMETERS;
-            hci_send_cmd(&hci_le_set_scan_parameters, 1, hci_stack->le_scan_interval, hci_stack->le_scan_window, hci_stack->le_own_addr_type, 0);
+            hci_send_cmd_le_set_scan_parameters(1, hci_stack->le_scan_interval, hci_stack->le_scan_window, hci_stack->le_own_addr_type, 0);
             break;
 #endif
         default:
@@ -1999,6 +2361,16 @@ static void event_handler(uint8_t *packet, int size){
                 log_info("hci_le_read_maximum_data_length: tx octets %u, tx time %u us", hci_stack->le_supported_max_tx_octets, hci_stack->le_supported_max_tx_time);
             }
 #endif
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+            else if (HCI_EVENT_IS_COMMAND_COMPLETE(packet, hci_le_set_data_length)){
+                // continue with PHY update, the LE Data Length Change event may follow later
+                handle = little_endian_read_16(packet, OFFSET_OF_DATA_IN_COMMAND_COMPLETE+1);
+                conn   = hci_connection_for_handle(handle);
+                if ((conn != NULL) && (conn->le_throughput_optimizer_state == LE_THROUGHPUT_OPTIMIZER_W4_SET_DATA_LENGTH_COMPLETE)){
+                    hci_le_throughput_optimizer_set_phy(conn);
+                }
+            }
+#endif
 #ifdef ENABLE_LE_CENTRAL
             else if (HCI_EVENT_IS_COMMAND_COMPLETE(packet, hci_le_read_white_list_size)){
                 hci_stack->le_whitelist_capacity = packet[6];
@@ -2070,7 +2442,9 @@ static void event_handler(uint8_t *packet, int size){
                     ((packet[OFFSET_OF_DATA_IN_COMMAND_COMPLETE+1+20] & 0x10) << 3);   // bit 7 = Octet 20, bit 4 / Read Encryption Key Size
                 hci_stack->local_supported_commands[1] =
                     ((packet[OFFSET_OF_DATA_IN_COMMAND_COMPLETE+1+ 2] & 0x40) >> 6) |  // bit 8 = Octet  2, bit 6 / Read Remote Extended Features
-                    ((packet[OFFSET_OF_DATA_IN_COMMAND_COMPLETE+1+32] & 0x08) >> 2);   // bit 9 = Octet 32, bit 3 / Write Secure Connections Host
+                    ((packet[OFFSET_OF_DATA_IN_COMMAND_COMPLETE+1+32] & 0x08) >> 2) |  // bit 9 = Octet 32, bit 3 / Write Secure Connections Host
+                    ((packet[OFFSET_OF_DATA_IN_COMMAND_COMPLETE+1+33] & 0x40) >> 4) |  // bit 10 = Octet 33, bit 6 / LE Set Data Length
+                    ((packet[OFFSET_OF_DATA_IN_COMMAND_COMPLETE+1+35] & 0x40) >> 3);   // bit 11 = Octet 35, bit 6 / LE Set PHY
                 log_info("Local supported commands summary %02x - %02x", hci_stack->local_supported_commands[0],  hci_stack->local_supported_commands[1]);
             }
 #ifdef ENABLE_CLASSIC
@@ -2128,6 +2502,17 @@ static void event_handler(uint8_t *packet, int size){
                     hci_handle_connection_failed(conn, status);
                 }
             }
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+            if (HCI_EVENT_IS_COMMAND_STATUS(packet, hci_le_set_phy) && (hci_stack->le_throughput_optimizer_set_phy_con_handle != HCI_CON_HANDLE_INVALID)){
+                conn = hci_connection_for_handle(hci_stack->le_throughput_optimizer_set_phy_con_handle);
+                hci_stack->le_throughput_optimizer_set_phy_con_handle = HCI_CON_HANDLE_INVALID;
+                // error => no LE PHY Update Complete event
+                if ((conn != NULL) && (hci_event_command_status_get_status(packet) != ERROR_CODE_SUCCESS) &&
+                    (conn->le_throughput_optimizer_state == LE_THROUGHPUT_OPTIMIZER_W4_PHY_UPDATE_COMPLETE)){
+                    hci_le_throughput_optimizer_exchange_mtu(conn);
+                }
+            }
+#endif
             break;
 
         case HCI_EVENT_NUMBER_OF_COMPLETED_PACKETS:{
@@ -2148,10 +2533,10 @@ static void event_handler(uint8_t *packet, int size){
                 }
                 
                 if (conn->num_packets_sent >= num_packets){
-                    conn->num_packets_sent -= num_packets;
+                    hci_connection_remove_packets_sent(conn, num_packets);
                 } else {
                     log_error("hci_number_completed_packets, more packet slots freed then sent.");
-                    conn->num_packets_sent = 0;
+                    hci_connection_remove_packets_sent(conn, conn->num_packets_sent);
                 }
                 // log_info("hci_number_completed_packet %u processed for handle %u, outstanding %u", num_packets, handle, conn->num_packets_sent);
 
@@ -2427,7 +2812,7 @@ static void event_handler(uint8_t *packet, int size){
             handle = little_endian_read_16(packet, 3);
             // drop outgoing ACL fragments if it is for closed connection and release buffer if tx not active
             if (hci_stack->acl_fragmentation_total_size > 0) {
-                if (handle == READ_ACL_CONNECTION_HANDLE(hci_stack->hci_packet_buffer)){
+                if (handle == READ_ACL_CONNECTION_HANDLE(hci_stack->acl_fragmentation_packet)){
                     int release_buffer = hci_stack->acl_fragmentation_tx_active == 0;
                     log_info("drop fragmented ACL data for closed connection, release buffer %u", release_buffer);
                     hci_stack->acl_fragmentation_total_size = 0;
@@ -2597,6 +2982,12 @@ static void event_handler(uint8_t *packet, int size){
                     log_info("New connection: handle %u, %s", conn->con_handle, bd_addr_to_str(conn->address));
                     
                     hci_emit_nr_connections_changed();
+
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+                    if (hci_stack->le_throughput_optimizer_enabled){
+                        hci_le_throughput_optimizer_start(conn);
+                    }
+#endif
                     break;
 
                 // log_info("LE buffer size: %u, count %u", little_endian_read_16(packet,6), packet[8]);
@@ -2633,12 +3024,34 @@ static void event_handler(uint8_t *packet, int size){
                         }
                     }
                     break;
-#ifdef ENABLE_LE_LIMIT_ACL_FRAGMENT_BY_MAX_OCTETS
+#if defined(ENABLE_LE_LIMIT_ACL_FRAGMENT_BY_MAX_OCTETS) || defined(ENABLE_LE_THROUGHPUT_OPTIMIZER)
                 case HCI_SUBEVENT_LE_DATA_LENGTH_CHANGE:
                     handle = hci_subevent_le_data_length_change_get_connection_handle(packet);
                     conn = hci_connection_for_handle(handle);
                     if (conn) {
+#ifdef ENABLE_LE_LIMIT_ACL_FRAGMENT_BY_MAX_OCTETS
                         conn->le_max_tx_octets = hci_subevent_le_data_length_change_get_max_tx_octets(packet);
+#endif
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+                        conn->le_data_length_max_tx_octets = hci_subevent_le_data_length_change_get_max_tx_octets(packet);
+                        conn->le_data_length_max_tx_time   = hci_subevent_le_data_length_change_get_max_tx_time(packet);
+                        conn->le_data_length_max_rx_octets = hci_subevent_le_data_length_change_get_max_rx_octets(packet);
+                        conn->le_data_length_max_rx_time   = hci_subevent_le_data_length_change_get_max_rx_time(packet);
+#endif
+                    }
+                    break;
+#endif
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+                case HCI_SUBEVENT_LE_PHY_UPDATE_COMPLETE:
+                    handle = hci_subevent_le_phy_update_complete_get_connection_handle(packet);
+                    conn = hci_connection_for_handle(handle);
+                    if (!conn) break;
+                    if (hci_subevent_le_phy_update_complete_get_status(packet) == ERROR_CODE_SUCCESS){
+                        conn->le_tx_phy = hci_subevent_le_phy_update_complete_get_tx_phy(packet);
+                        conn->le_rx_phy = hci_subevent_le_phy_update_complete_get_rx_phy(packet);
+                    }
+                    if (conn->le_throughput_optimizer_state == LE_THROUGHPUT_OPTIMIZER_W4_PHY_UPDATE_COMPLETE){
+                        hci_le_throughput_optimizer_exchange_mtu(conn);
                     }
                     break;
 #endif
@@ -2806,6 +3219,9 @@ static void packet_handler(uint8_t packet_type, uint8_t *packet, uint16_t size){
  */
 void hci_add_event_handler(btstack_packet_callback_registration_t * callback_handler){
     btstack_linked_list_add_tail(&hci_stack->event_handlers, (btstack_linked_item_t*) callback_handler);
+    hci_stack->num_event_handlers++;
+    // matching event handlers have to be collected again
+    hci_stack->event_dispatch_cache_num_entries = 0;
 }
 
 
@@ -2886,6 +3302,7 @@ void hci_init(const hci_transport_t *transport, const void *config){
     
     // setup pointer for outgoing packet buffer
     hci_stack->hci_packet_buffer = &hci_stack->hci_packet_buffer_data[HCI_OUTGOING_PRE_BUFFER_SIZE];
+    hci_stack->acl_fragmentation_packet = hci_stack->hci_packet_buffer;
 
     // max acl payload size defined in config.h
     hci_stack->acl_data_packet_length = HCI_ACL_PAYLOAD_SIZE;
@@ -2944,6 +3361,16 @@ void hci_init(const hci_transport_t *transport, const void *config){
     // default LE Scanning
     hci_stack->le_scan_interval = 0x1e0;
     hci_stack->le_scan_window   =  0x30;
+
+#ifdef ENABLE_LE_SCAN_FILTER
+    // deliver all reports
+    hci_stack->le_scan_filter_rssi_threshold = -128;
+    hci_stack->le_scan_filter_batch_pos = 4;
+    hci_le_scan_filter_reset_cache();
+#endif
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+    hci_stack->le_throughput_optimizer_set_phy_con_handle = HCI_CON_HANDLE_INVALID;
+#endif
 #endif
 
 #ifdef ENABLE_LE_PERIPHERAL
@@ -3402,7 +3829,7 @@ static void hci_halting_timeout_handler(btstack_timer_source_t * ds){
 
 static bool hci_run_acl_fragments(void){
     if (hci_stack->acl_fragmentation_total_size > 0) {
-        hci_con_handle_t con_handle = READ_ACL_CONNECTION_HANDLE(hci_stack->hci_packet_buffer);
+        hci_con_handle_t con_handle = READ_ACL_CONNECTION_HANDLE(hci_stack->acl_fragmentation_packet);
         hci_connection_t *connection = hci_connection_for_handle(con_handle);
         if (connection) {
             if (hci_can_send_prepared_acl_packet_now(con_handle)){
@@ -3499,18 +3926,18 @@ static bool hci_run_general_gap_le(void){
     if (hci_stack->le_scan_type != 0xff) {
         if (hci_stack->le_scanning_active){
             hci_stack->le_scanning_active = 0;
-            hci_send_cmd(&hci_le_set_scan_enable, 0, 0);
+            hci_send_cmd_le_set_scan_enable(0, 0);
         } else {
             int scan_type = (int) hci_stack->le_scan_type;
             hci_stack->le_scan_type = 0xff;
-            hci_send_cmd(&hci_le_set_scan_parameters, scan_type, hci_stack->le_scan_interval, hci_stack->le_scan_window, hci_stack->le_own_addr_type, 0);
+            hci_send_cmd_le_set_scan_parameters(scan_type, hci_stack->le_scan_interval, hci_stack->le_scan_window, hci_stack->le_own_addr_type, 0);
         }
         return true;
     }
     // finally, we can enable/disable le scan
     if ((hci_stack->le_scanning_enabled != hci_stack->le_scanning_active)){
         hci_stack->le_scanning_active = hci_stack->le_scanning_enabled;
-        hci_send_cmd(&hci_le_set_scan_enable, hci_stack->le_scanning_enabled, 0);
+        hci_send_cmd_le_set_scan_enable(hci_stack->le_scanning_enabled, 0);
         return true;
     }
 #endif
@@ -3584,7 +4011,7 @@ static bool hci_run_general_gap_le(void){
     if (modification_pending){
         // stop connnecting if modification pending
         if (hci_stack->le_connecting_state != LE_CONNECTING_IDLE){
-            hci_send_cmd(&hci_le_create_connection_cancel);
+            hci_send_cmd_le_create_connection_cancel();
             return true;
         }
 
@@ -3614,7 +4041,7 @@ static bool hci_run_general_gap_le(void){
          !btstack_linked_list_empty(&hci_stack->le_whitelist)){
         bd_addr_t null_addr;
         memset(null_addr, 0, 6);
-        hci_send_cmd(&hci_le_create_connection,
+        hci_send_cmd_le_create_connection(
                      hci_stack->le_connection_scan_interval,    // scan interval: 60 ms
                      hci_stack->le_connection_scan_window,    // scan interval: 30 ms
                      1,         // use whitelist
@@ -3657,7 +4084,7 @@ static bool hci_run_general_pending_commmands(void){
                         (void)memcpy(hci_stack->outgoing_addr,
                                      connection->address, 6);
                         log_info("sending hci_le_create_connection");
-                        hci_send_cmd(&hci_le_create_connection,
+                        hci_send_cmd_le_create_connection(
                                      hci_stack->le_connection_scan_interval,    // conn scan interval
                                      hci_stack->le_connection_scan_window,      // conn scan windows
                                      0,         // don't use whitelist
@@ -3693,13 +4120,13 @@ static bool hci_run_general_pending_commmands(void){
 #ifdef ENABLE_LE_CENTRAL
             case SEND_CANCEL_CONNECTION:
                 connection->state = SENT_CANCEL_CONNECTION;
-                hci_send_cmd(&hci_le_create_connection_cancel);
+                hci_send_cmd_le_create_connection_cancel();
                 return true;
 #endif
 #endif
             case SEND_DISCONNECT:
                 connection->state = SENT_DISCONNECT;
-                hci_send_cmd(&hci_disconnect, connection->con_handle, 0x13); // remote closed connection
+                hci_send_cmd_disconnect(connection->con_handle, 0x13); // remote closed connection
                 return true;
 
             default:
@@ -3786,7 +4213,7 @@ static bool hci_run_general_pending_commmands(void){
         if (connection->bonding_flags & BONDING_DISCONNECT_DEDICATED_DONE){
             connection->bonding_flags &= ~BONDING_DISCONNECT_DEDICATED_DONE;
             connection->bonding_flags |= BONDING_EMIT_COMPLETE_ON_DISCONNECT;
-            hci_send_cmd(&hci_disconnect, connection->con_handle, 0x13);  // authentication done
+            hci_send_cmd_disconnect(connection->con_handle, 0x13);  // authentication done
             return true;
         }
 
@@ -3810,7 +4237,7 @@ static bool hci_run_general_pending_commmands(void){
 
         if (connection->bonding_flags & BONDING_DISCONNECT_SECURITY_BLOCK){
             connection->bonding_flags &= ~BONDING_DISCONNECT_SECURITY_BLOCK;
-            hci_send_cmd(&hci_disconnect, connection->con_handle, 0x0005);  // authentication failure
+            hci_send_cmd_disconnect(connection->con_handle, 0x0005);  // authentication failure
             return true;
         }
 
@@ -3836,7 +4263,7 @@ static bool hci_run_general_pending_commmands(void){
             // response to L2CAP CON PARAMETER UPDATE REQUEST
             case CON_PARAMETER_UPDATE_CHANGE_HCI_CON_PARAMETERS:
                 connection->le_con_parameter_update_state = CON_PARAMETER_UPDATE_NONE;
-                hci_send_cmd(&hci_le_connection_update, connection->con_handle, connection->le_conn_interval_min,
+                hci_send_cmd_le_connection_update(connection->con_handle, connection->le_conn_interval_min,
                              connection->le_conn_interval_max, connection->le_conn_latency, connection->le_supervision_timeout,
                              0x0000, 0xffff);
                 return true;
@@ -3859,6 +4286,9 @@ static bool hci_run_general_pending_commmands(void){
             hci_send_cmd(&hci_le_set_phy, connection->con_handle, all_phys, connection->le_phy_update_tx_phys, connection->le_phy_update_rx_phys, connection->le_phy_update_phy_options);
             return true;
         }
+#endif
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+        if (hci_run_le_throughput_optimizer(connection)) return true;
 #endif
     }
     return false;
@@ -3949,7 +4379,7 @@ static void hci_run(void){
                         hci_shutdown_connection(connection);
 
                         // finally, send the disconnect command
-                        hci_send_cmd(&hci_disconnect, con_handle, 0x13);  // remote closed connection
+                        hci_send_cmd_disconnect(con_handle, 0x13);  // remote closed connection
                         return;
                     }
 
@@ -4005,7 +4435,7 @@ static void hci_run(void){
                         if (!hci_can_send_command_packet_now()) return;
 
                         log_info("HCI_STATE_FALLING_ASLEEP, connection %p, handle %u", connection, (uint16_t)connection->con_handle);
-                        hci_send_cmd(&hci_disconnect, connection->con_handle, 0x13);  // remote closed connection
+                        hci_send_cmd_disconnect(connection->con_handle, 0x13);  // remote closed connection
                         
                         // send disconnected event right away - causes higher layer connections to get closed, too.
                         hci_shutdown_connection(connection);
@@ -4229,20 +4659,22 @@ void gap_secure_connections_enable(bool enable){
 
 #endif
 
-// va_list part of hci_send_cmd
-int hci_send_cmd_va_arg(const hci_cmd_t *cmd, va_list argptr){
+uint8_t * hci_reserve_cmd_packet_buffer(void){
     if (!hci_can_send_command_packet_now()){ 
         log_error("hci_send_cmd called but cannot send packet now");
-        return 0;
+        return NULL;
     }
+    hci_reserve_packet_buffer();
+    return hci_stack->hci_packet_buffer;
+}
+
+int hci_send_cmd_packet_buffer(uint16_t size){
+    uint8_t * packet = hci_stack->hci_packet_buffer;
 
     // for HCI INITIALIZATION
-    // log_info("hci_send_cmd: opcode %04x", cmd->opcode);
-    hci_stack->last_cmd_opcode = cmd->opcode;
+    hci_stack->last_cmd_opcode = little_endian_read_16(packet, 0);
+    // log_info("hci_send_cmd: opcode %04x", hci_stack->last_cmd_opcode);
 
-    hci_reserve_packet_buffer();
-    uint8_t * packet = hci_stack->hci_packet_buffer;
-    uint16_t size = hci_cmd_create_from_template(packet, cmd, argptr);
     int err = hci_send_cmd_packet(packet, size);
 
     // release packet buffer on error or for synchronous transport implementations
@@ -4254,6 +4686,14 @@ int hci_send_cmd_va_arg(const hci_cmd_t *cmd, va_list argptr){
     return err;
 }
 
+// va_list part of hci_send_cmd
+int hci_send_cmd_va_arg(const hci_cmd_t *cmd, va_list argptr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    uint16_t size = hci_cmd_create_from_template(packet, cmd, argptr);
+    return hci_send_cmd_packet_buffer(size);
+}
+
 /**
  * pre: numcmds >= 0 - it's allowed to send a command to the controller
  */
@@ -4268,18 +4708,84 @@ int hci_send_cmd(const hci_cmd_t *cmd, ...){
 // Create various non-HCI events. 
 // TODO: generalize, use table similar to hci_create_command
 
+// deliver event to all matching event handlers, starting with the handler at position first_handler
+static void hci_emit_event_to_matching_handlers(uint8_t * event, uint16_t size, uint16_t first_handler){
+    uint16_t pos = 0;
+    btstack_linked_list_iterator_t it;
+    btstack_linked_list_iterator_init(&it, &hci_stack->event_handlers);
+    while (btstack_linked_list_iterator_has_next(&it)){
+        btstack_packet_callback_registration_t * entry = (btstack_packet_callback_registration_t*) btstack_linked_list_iterator_next(&it);
+        if (pos++ < first_handler) continue;
+        if (!btstack_event_filter_matches(entry->event_filter, event, size)) continue;
+        (*entry->callback)(HCI_EVENT_PACKET, 0, event, size);
+    }
+}
+
+// get cache entry with matching event handlers for event type / LE Meta subevent, NULL if not cacheable
+static hci_event_dispatch_cache_entry_t * hci_event_dispatch_cache_get(const uint8_t * event, uint16_t size){
+    uint16_t key = ((uint16_t) event[0]) << 8;
+    if (event[0] == HCI_EVENT_LE_META){
+        if (size < 3u) return NULL;
+        key |= event[2];
+    }
+
+    uint8_t i;
+    for (i = 0; i < hci_stack->event_dispatch_cache_num_entries; i++){
+        hci_event_dispatch_cache_entry_t * cache_entry = &hci_stack->event_dispatch_cache[i];
+        if (cache_entry->key != key) continue;
+        return cache_entry->overflow ? NULL : cache_entry;
+    }
+
+    // collect matching event handlers in unused or oldest entry
+    hci_event_dispatch_cache_entry_t * cache_entry;
+    if (hci_stack->event_dispatch_cache_num_entries < HCI_EVENT_DISPATCH_CACHE_SIZE){
+        cache_entry = &hci_stack->event_dispatch_cache[hci_stack->event_dispatch_cache_num_entries++];
+    } else {
+        cache_entry = &hci_stack->event_dispatch_cache[hci_stack->event_dispatch_cache_next_entry];
+        hci_stack->event_dispatch_cache_next_entry = (hci_stack->event_dispatch_cache_next_entry + 1u) % HCI_EVENT_DISPATCH_CACHE_SIZE;
+    }
+    cache_entry->key = key;
+    cache_entry->overflow = 0;
+    cache_entry->num_handlers = 0;
+    btstack_linked_list_iterator_t it;
+    btstack_linked_list_iterator_init(&it, &hci_stack->event_handlers);
+    while (btstack_linked_list_iterator_has_next(&it)){
+        btstack_packet_callback_registration_t * entry = (btstack_packet_callback_registration_t*) btstack_linked_list_iterator_next(&it);
+        if (!btstack_event_filter_matches(entry->event_filter, event, size)) continue;
+        if (cache_entry->num_handlers == HCI_EVENT_DISPATCH_CACHE_MAX_HANDLERS){
+            cache_entry->overflow = 1;
+            return NULL;
+        }
+        cache_entry->handlers[cache_entry->num_handlers++] = entry;
+    }
+    return cache_entry;
+}
+
 static void hci_emit_event(uint8_t * event, uint16_t size, int dump){
     // dump packet
     if (dump) {
         hci_dump_packet( HCI_EVENT_PACKET, 0, event, size);
     } 
 
-    // dispatch to all event handlers
-    btstack_linked_list_iterator_t it;
-    btstack_linked_list_iterator_init(&it, &hci_stack->event_handlers);
-    while (btstack_linked_list_iterator_has_next(&it)){
-        btstack_packet_callback_registration_t * entry = (btstack_packet_callback_registration_t*) btstack_linked_list_iterator_next(&it);
-        entry->callback(HCI_EVENT_PACKET, 0, event, size);
+    uint16_t num_event_handlers = hci_stack->num_event_handlers;
+    hci_event_dispatch_cache_entry_t * cache_entry = hci_event_dispatch_cache_get(event, size);
+    if (cache_entry == NULL){
+        hci_emit_event_to_matching_handlers(event, size, 0);
+        return;
+    }
+
+    // copy handlers as nested events may replace the cache entry
+    btstack_packet_callback_registration_t * handlers[HCI_EVENT_DISPATCH_CACHE_MAX_HANDLERS];
+    uint8_t num_handlers = cache_entry->num_handlers;
+    (void)memcpy(handlers, cache_entry->handlers, num_handlers * sizeof(btstack_packet_callback_registration_t *));
+    uint8_t i;
+    for (i = 0; i < num_handlers; i++){
+        (*handlers[i]->callback)(HCI_EVENT_PACKET, 0, event, size);
+    }
+
+    // event handlers added during dispatch have been appended to the list
+    if (hci_stack->num_event_handlers != num_event_handlers){
+        hci_emit_event_to_matching_handlers(event, size, num_event_handlers);
     }
 }
 
@@ -4718,14 +5224,80 @@ void gap_set_local_name(const char * local_name){
 #ifdef ENABLE_LE_CENTRAL
 void gap_start_scan(void){
     hci_stack->le_scanning_enabled = 1;
+#ifdef ENABLE_LE_SCAN_FILTER
+    hci_le_scan_filter_reset_cache();
+#endif
     hci_run();
 }
 
 void gap_stop_scan(void){
     hci_stack->le_scanning_enabled = 0;
+#ifdef ENABLE_LE_SCAN_FILTER
+    hci_le_scan_filter_batch_flush();
+#endif
     hci_run();
 }
 
+#ifdef ENABLE_LE_SCAN_FILTER
+void gap_le_scan_filter_set_duplicate_filter(int enabled, uint32_t report_interval_ms){
+    hci_stack->le_scan_filter_duplicates = enabled ? 1 : 0;
+    hci_stack->le_scan_filter_report_interval_ms = report_interval_ms;
+    hci_le_scan_filter_reset_cache();
+}
+
+void gap_le_scan_filter_set_rssi_threshold(int8_t rssi_threshold){
+    hci_stack->le_scan_filter_rssi_threshold = rssi_threshold;
+}
+
+void gap_le_scan_filter_set_ad_filter(const ad_filter_t * ad_filter){
+    hci_stack->le_scan_filter_ad_filter = ad_filter;
+}
+
+void gap_le_scan_filter_set_batching(uint16_t max_delay_ms){
+    hci_le_scan_filter_batch_flush();
+    hci_stack->le_scan_filter_batch_max_delay_ms = max_delay_ms;
+}
+#endif
+
+void gap_advertising_report_iterator_init(gap_advertising_report_iterator_t * it, const uint8_t * event){
+    it->data   = gap_event_advertising_report_batch_get_reports(event);
+    it->size   = gap_event_advertising_report_batch_get_reports_length(event);
+    it->offset = 0;
+}
+
+int gap_advertising_report_iterator_has_more(const gap_advertising_report_iterator_t * it){
+    if ((it->offset + 10u) > it->size) return 0;
+    return (it->offset + 10u + it->data[it->offset + 9u]) <= it->size;
+}
+
+void gap_advertising_report_iterator_next(gap_advertising_report_iterator_t * it){
+    it->offset += 10u + it->data[it->offset + 9u];
+}
+
+uint8_t gap_advertising_report_iterator_get_advertising_event_type(const gap_advertising_report_iterator_t * it){
+    return it->data[it->offset];
+}
+
+uint8_t gap_advertising_report_iterator_get_address_type(const gap_advertising_report_iterator_t * it){
+    return it->data[it->offset + 1u];
+}
+
+void gap_advertising_report_iterator_get_address(const gap_advertising_report_iterator_t * it, bd_addr_t address){
+    reverse_bd_addr(&it->data[it->offset + 2u], address);
+}
+
+int8_t gap_advertising_report_iterator_get_rssi(const gap_advertising_report_iterator_t * it){
+    return (int8_t) it->data[it->offset + 8u];
+}
+
+uint8_t gap_advertising_report_iterator_get_data_length(const gap_advertising_report_iterator_t * it){
+    return it->data[it->offset + 9u];
+}
+
+const uint8_t * gap_advertising_report_iterator_get_data(const gap_advertising_report_iterator_t * it){
+    return &it->data[it->offset + 10u];
+}
+
 void gap_set_scan_parameters(uint8_t scan_type, uint16_t scan_interval, uint16_t scan_window){
     hci_stack->le_scan_type     = scan_type;
     hci_stack->le_scan_interval = scan_interval;
@@ -5043,6 +5615,39 @@ uint8_t gap_le_set_phy(hci_con_handle_t connection_handle, uint8_t all_phys, uin
     return 0;
 }
 
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+void gap_le_throughput_optimizer_enable(bool enabled){
+    hci_stack->le_throughput_optimizer_enabled = enabled ? 1 : 0;
+}
+
+uint8_t gap_le_throughput_optimizer_start(hci_con_handle_t con_handle){
+    hci_connection_t * conn = hci_connection_for_handle(con_handle);
+    if (!conn) return ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER;
+    switch (conn->le_throughput_optimizer_state){
+        case LE_THROUGHPUT_OPTIMIZER_IDLE:
+        case LE_THROUGHPUT_OPTIMIZER_DONE:
+            break;
+        default:
+            return ERROR_CODE_COMMAND_DISALLOWED;
+    }
+    hci_le_throughput_optimizer_start(conn);
+    hci_run();
+    return ERROR_CODE_SUCCESS;
+}
+
+void hci_le_throughput_optimizer_register_mtu_exchange_handler(void (*handler)(hci_con_handle_t con_handle, uint16_t max_tx_octets)){
+    hci_stack->le_throughput_optimizer_mtu_exchange_handler = handler;
+}
+
+void hci_le_throughput_optimizer_mtu_exchanged(hci_con_handle_t con_handle, uint16_t mtu){
+    hci_connection_t * conn = hci_connection_for_handle(con_handle);
+    if (!conn) return;
+    if (conn->le_throughput_optimizer_state != LE_THROUGHPUT_OPTIMIZER_W4_MTU_EXCHANGE_COMPLETE) return;
+    conn->le_throughput_optimizer_state = LE_THROUGHPUT_OPTIMIZER_DONE;
+    hci_emit_le_throughput_optimization_complete(conn, mtu);
+}
+#endif
+
 #ifdef ENABLE_LE_CENTRAL
 /**
  * @brief Auto Connection Establishment - Start Connecting to device
@@ -5536,6 +6141,10 @@ void hci_free_connections_fuzz(void){
         btstack_linked_list_iterator_remove(&it);
         btstack_memory_hci_connection_free(con);
     }
+    hci_stack->acl_packets_sent_num = 0;
+    hci_stack->le_acl_packets_sent_num = 0;
+    memset(hci_stack->acl_tx_priority_connections, 0, sizeof(hci_stack->acl_tx_priority_connections));
+    memset(hci_stack->le_acl_tx_priority_connections, 0, sizeof(hci_stack->le_acl_tx_priority_connections));
 }
 void hci_simulate_working_fuzz(void){
     hci_init_done();
@@ -149,6 +149,23 @@ extern "C" {
 #endif
 #endif
 
+// Event types and LE Meta subevents with cached list of matching event handlers
+#ifndef HCI_EVENT_DISPATCH_CACHE_SIZE
+#define HCI_EVENT_DISPATCH_CACHE_SIZE 4
+#endif
+
+// Max event handlers per event dispatch cache entry
+#ifndef HCI_EVENT_DISPATCH_CACHE_MAX_HANDLERS
+#define HCI_EVENT_DISPATCH_CACHE_MAX_HANDLERS 8
+#endif
+
+// Host-side LE Scan Filter: number of cached advertising reports
+#ifdef ENABLE_LE_SCAN_FILTER
+#ifndef LE_SCAN_FILTER_CACHE_SIZE
+#define LE_SCAN_FILTER_CACHE_SIZE 32
+#endif
+#endif
+
 // 
 #define IS_COMMAND(packet, command) ( little_endian_read_16(packet,0) == command.opcode )
 
@@ -185,6 +202,18 @@ typedef enum {
     CON_PARAMETER_UPDATE_NEGATIVE_REPLY,
 } le_con_parameter_update_state_t;
 
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+typedef enum {
+    LE_THROUGHPUT_OPTIMIZER_IDLE = 0,
+    LE_THROUGHPUT_OPTIMIZER_W2_SET_DATA_LENGTH,
+    LE_THROUGHPUT_OPTIMIZER_W4_SET_DATA_LENGTH_COMPLETE,
+    LE_THROUGHPUT_OPTIMIZER_W2_SET_PHY,
+    LE_THROUGHPUT_OPTIMIZER_W4_PHY_UPDATE_COMPLETE,
+    LE_THROUGHPUT_OPTIMIZER_W4_MTU_EXCHANGE_COMPLETE,
+    LE_THROUGHPUT_OPTIMIZER_DONE,
+} le_throughput_optimizer_state_t;
+#endif
+
 // Authentication flags
 typedef enum {
     AUTH_FLAGS_NONE                = 0x0000,
@@ -249,6 +278,28 @@ typedef enum {
     BLUETOOTH_ACTIVE
 } BLUETOOTH_STATE;
 
+// ACL transmit priority classes, higher value = higher priority
+typedef enum {
+    HCI_ACL_TX_PRIORITY_BULK = 0,
+    HCI_ACL_TX_PRIORITY_INTERACTIVE,
+    HCI_ACL_TX_PRIORITY_AUDIO,
+    HCI_ACL_TX_PRIORITY_NUM
+} hci_acl_tx_priority_t;
+
+// ACL transmit statistics for a single connection
+typedef struct {
+    // ACL packets sent to controller and not completed yet
+    uint8_t  packets_in_flight;
+    // max number of ACL packets in flight
+    uint8_t  packets_in_flight_max;
+    // ACL packets (fragments) sent to controller
+    uint32_t packets_sent;
+    // L2CAP PDUs sent via hci_send_acl_packet_buffer
+    uint32_t sdus_sent;
+    // L2CAP PDUs postponed to leave controller buffers for higher priority connections
+    uint32_t packets_deferred;
+} hci_acl_tx_statistics_t;
+
 typedef enum {
     LE_CONNECTING_IDLE,
     LE_CONNECTING_DIRECT,
@@ -542,6 +593,11 @@ typedef struct {
     // number packets sent to controller
     uint8_t num_packets_sent;
 
+    // ACL transmit priority and statistics
+    hci_acl_tx_priority_t   acl_tx_priority;
+    hci_acl_tx_statistics_t acl_tx_statistics;
+    bool                    acl_tx_deferred;
+
 #ifdef ENABLE_HCI_CONTROLLER_TO_HOST_FLOW_CONTROL
     uint8_t num_packets_completed;
 #endif
@@ -563,6 +619,17 @@ typedef struct {
     uint8_t le_phy_update_rx_phys;
     int8_t  le_phy_update_phy_options;
 
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+    // LE Throughput Optimizer: current state and negotiated link parameters
+    le_throughput_optimizer_state_t le_throughput_optimizer_state;
+    uint16_t le_data_length_max_tx_octets;
+    uint16_t le_data_length_max_tx_time;
+    uint16_t le_data_length_max_rx_octets;
+    uint16_t le_data_length_max_rx_time;
+    uint8_t  le_tx_phy;
+    uint8_t  le_rx_phy;
+#endif
+
     // LE Security Manager
     sm_connection_t sm_connection;
 
@@ -720,6 +787,29 @@ typedef struct {
     uint8_t        state;   
 } whitelist_entry_t;
 
+/**
+ * Event handlers that receive a single event type or LE Meta subevent
+ */
+typedef struct {
+    // event type << 8 | LE Meta subevent
+    uint16_t key;
+    // more event handlers match than fit into handlers
+    uint8_t  overflow;
+    uint8_t  num_handlers;
+    btstack_packet_callback_registration_t * handlers[HCI_EVENT_DISPATCH_CACHE_MAX_HANDLERS];
+} hci_event_dispatch_cache_entry_t;
+
+#ifdef ENABLE_LE_SCAN_FILTER
+typedef struct {
+    bd_addr_t address;
+    // 0xff if unused
+    uint8_t   address_type;
+    // covers advertising event type and data
+    uint32_t  payload_hash;
+    uint32_t  last_report_ms;
+} le_scan_filter_entry_t;
+#endif
+
 /**
  * main data structure
  */
@@ -748,6 +838,12 @@ typedef struct {
 
     /* callbacks for events */
     btstack_linked_list_t event_handlers;
+    uint16_t              num_event_handlers;
+
+    /* matching event handlers for recent event types, reset when event handler is added */
+    hci_event_dispatch_cache_entry_t event_dispatch_cache[HCI_EVENT_DISPATCH_CACHE_SIZE];
+    uint8_t               event_dispatch_cache_num_entries;
+    uint8_t               event_dispatch_cache_next_entry;
 
 #ifdef ENABLE_CLASSIC
     /* callback for reject classic connection */
@@ -781,6 +877,8 @@ typedef struct {
     uint8_t   * hci_packet_buffer;
     uint8_t   hci_packet_buffer_data[HCI_OUTGOING_PRE_BUFFER_SIZE + HCI_OUTGOING_PACKET_BUFFER_SIZE];
     uint8_t   hci_packet_buffer_reserved;
+    // ACL packet currently sent, either hci_packet_buffer or buffer provided by hci_send_acl_packet_external
+    uint8_t   * acl_fragmentation_packet;
     uint16_t  acl_fragmentation_pos;
     uint16_t  acl_fragmentation_total_size;
     uint8_t   acl_fragmentation_tx_active;
@@ -794,6 +892,12 @@ typedef struct {
     uint8_t  synchronous_flow_control_enabled;
     uint8_t  le_acl_packets_total_num;
     uint16_t le_data_packets_length;
+    // outgoing ACL packets not completed yet, sum of num_packets_sent for Classic/LE connections
+    uint16_t acl_packets_sent_num;
+    uint16_t le_acl_packets_sent_num;
+    // number of Classic/LE connections per ACL transmit priority class, bulk connections are not counted
+    uint8_t  acl_tx_priority_connections[HCI_ACL_TX_PRIORITY_NUM];
+    uint8_t  le_acl_tx_priority_connections[HCI_ACL_TX_PRIORITY_NUM];
     uint8_t  sco_waiting_for_can_send_now;
     uint8_t  sco_can_send_now;
 
@@ -889,6 +993,31 @@ typedef struct {
     uint8_t               le_whitelist_capacity;
     btstack_linked_list_t le_whitelist;
 
+#ifdef ENABLE_LE_SCAN_FILTER
+    // Host-side LE Scan Filter
+    uint8_t                le_scan_filter_duplicates;
+    uint32_t               le_scan_filter_report_interval_ms;
+    int8_t                 le_scan_filter_rssi_threshold;
+    const ad_filter_t *    le_scan_filter_ad_filter;
+    le_scan_filter_entry_t le_scan_filter_cache[LE_SCAN_FILTER_CACHE_SIZE];
+
+    // batched advertising reports, emitted when full or after max delay
+    uint16_t               le_scan_filter_batch_max_delay_ms;
+    btstack_timer_source_t le_scan_filter_batch_timer;
+    uint16_t               le_scan_filter_batch_pos;
+    uint8_t                le_scan_filter_batch_num_reports;
+    uint8_t                le_scan_filter_batch[HCI_EVENT_HEADER_SIZE + HCI_EVENT_PAYLOAD_SIZE];
+#endif
+
+#ifdef ENABLE_LE_THROUGHPUT_OPTIMIZER
+    // start LE Throughput Optimizer for new connections
+    uint8_t                le_throughput_optimizer_enabled;
+    // connection of outstanding LE Set PHY command
+    hci_con_handle_t       le_throughput_optimizer_set_phy_con_handle;
+    // ATT MTU Exchange, provided by GATT Client
+    void (*le_throughput_optimizer_mtu_exchange_handler)(hci_con_handle_t con_handle, uint16_t max_tx_octets);
+#endif
+
     // Connection parameters
     uint16_t le_connection_interval_min;
     uint16_t le_connection_interval_max;
@@ -1012,7 +1141,9 @@ void hci_close(void);
 
 
 /**
- * @brief Add event packet handler. 
+ * @brief Add event packet handler. If event_filter of the callback registration is set, 
+ *        only events enabled in the event filter are delivered
+ * @note event filter has to stay valid while event handler is registered
  */
 void hci_add_event_handler(btstack_packet_callback_registration_t * callback_handler);
 
@@ -1105,6 +1236,17 @@ void hci_set_master_slave_policy(uint8_t policy);
  */
 int hci_send_cmd_va_arg(const hci_cmd_t *cmd, va_list argtr);
 
+/**
+ * Reserve HCI packet buffer for command built by encoder from hci_cmd_encoder.h, used by hci_send_cmd_* functions
+ * @return packet buffer or NULL if command cannot be sent now
+ */
+uint8_t * hci_reserve_cmd_packet_buffer(void);
+
+/**
+ * Send command prepared in reserved HCI packet buffer, used by hci_send_cmd_* functions
+ */
+int hci_send_cmd_packet_buffer(uint16_t size);
+
 /**
  * Get connection iterator. Only used by l2cap.c and sm.c
  */
@@ -1150,6 +1292,14 @@ int hci_can_send_prepared_acl_packet_now(hci_con_handle_t con_handle);
  */
 int hci_send_acl_packet_buffer(int size);
 
+/**
+ * Send acl packet prepared in buffer provided by caller, e.g. L2CAP ERTM retransmission buffer. Called by L2CAP
+ * @pre caller has reserved the packet buffer
+ * @note packet needs HCI_OUTGOING_PRE_BUFFER_SIZE bytes in front of it and has to stay valid until HCI_EVENT_TRANSPORT_PACKET_SENT
+ * @note for fragmented packets, the 4 bytes in front of each continuation fragment are overwritten with its ACL header
+ */
+int hci_send_acl_packet_external(uint8_t * packet, int size);
+
 /**
  * Check if authentication is active. It delays automatic disconnect while no L2CAP connection
  * Called by l2cap.
@@ -1212,6 +1362,63 @@ void hci_disconnect_all(void);
  */
 int hci_number_free_acl_slots_for_handle(hci_con_handle_t con_handle);
 
+/**
+ * @brief Set ACL transmit priority for connection
+ * @note As long as connections with higher priority exist, lower priority connections leave
+ *       one controller ACL buffer per higher priority class free and channels of higher priority
+ *       connections get to send first. The reservation is checked before an L2CAP PDU is started,
+ *       fragments of a started PDU are always sent. Fixed channels (ATT, SM) are not affected
+ * @param con_handle
+ * @param priority
+ * @return status ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER if connection does not exist
+ */
+uint8_t hci_set_acl_tx_priority(hci_con_handle_t con_handle, hci_acl_tx_priority_t priority);
+
+/**
+ * @brief Get ACL transmit priority for connection
+ * @param con_handle
+ * @return priority, HCI_ACL_TX_PRIORITY_BULK if connection does not exist
+ */
+hci_acl_tx_priority_t hci_get_acl_tx_priority(hci_con_handle_t con_handle);
+
+/**
+ * @brief Check if ACL packet for given handle can be sent without using controller buffers
+ *        reserved for higher priority connections
+ * @param con_handle
+ * @return true if packet can be sent
+ */
+bool hci_acl_tx_priority_can_send_now(hci_con_handle_t con_handle);
+
+/**
+ * @brief Report that ACL packet for given handle was held back as hci_acl_tx_priority_can_send_now returned false.
+ *        Counted once per L2CAP PDU in packets_deferred of ACL TX statistics
+ * @param con_handle
+ */
+void hci_acl_tx_priority_packet_deferred(hci_con_handle_t con_handle);
+
+/**
+ * @brief Get ACL transmit statistics for connection
+ * @param con_handle
+ * @param statistics
+ * @return status ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER if connection does not exist
+ */
+uint8_t hci_get_acl_tx_statistics(hci_con_handle_t con_handle, hci_acl_tx_statistics_t * statistics);
+
+/**
+ * @brief Register ATT MTU Exchange for LE Throughput Optimizer. Used by GATT Client
+ * @note The handler exchanges an ATT MTU that fills LL PDUs of max_tx_octets and reports the result
+ *       via hci_le_throughput_optimizer_mtu_exchanged
+ * @param handler
+ */
+void hci_le_throughput_optimizer_register_mtu_exchange_handler(void (*handler)(hci_con_handle_t con_handle, uint16_t max_tx_octets));
+
+/**
+ * @brief Report ATT MTU after MTU Exchange requested by LE Throughput Optimizer
+ * @param con_handle
+ * @param mtu
+ */
+void hci_le_throughput_optimizer_mtu_exchanged(hci_con_handle_t con_handle, uint16_t mtu);
+
 /**
  * @brief Set Advertisement Parameters
  * @param adv_int_min
@@ -0,0 +1,4369 @@
+/*
+ * Copyright (C) 2020 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+
+
+/*
+ *  hci_cmd_encoder.h
+ *
+ *  @brief Typed HCI Command encoders, alternative to hci_send_cmd without format string interpretation
+ *  @note  Don't edit - generated by tool/btstack_hci_cmd_generator.py
+ *
+ */
+
+#ifndef HCI_CMD_ENCODER_H
+#define HCI_CMD_ENCODER_H
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_cmd.h"
+
+#define HCI_CMD_ENCODER_OPCODE(ogf, ocf) ((ocf) | ((ogf) << 10))
+
+/* API_START */
+
+/**
+ * @brief Encode hci_inquiry into buffer
+ * @param packet buffer for 8 bytes
+ * @param lap
+ * @param inquiry_length
+ * @param num_responses
+ * @return size of command
+ * @note: format 311
+ */
+static inline uint16_t hci_cmd_encode_inquiry(uint8_t * packet, uint32_t lap, uint8_t inquiry_length, uint8_t num_responses){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x01);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x01) >> 8);
+    packet[2] = 5;
+    packet[3] = (uint8_t) lap;
+    packet[4] = (uint8_t) (lap >> 8);
+    packet[5] = (uint8_t) (lap >> 16);
+    packet[6] = (uint8_t) inquiry_length;
+    packet[7] = (uint8_t) num_responses;
+    return 8;
+}
+
+/**
+ * @brief Send hci_inquiry, same as hci_send_cmd(&hci_inquiry, ...)
+ * @param lap
+ * @param inquiry_length
+ * @param num_responses
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_inquiry(uint32_t lap, uint8_t inquiry_length, uint8_t num_responses){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_inquiry(packet, lap, inquiry_length, num_responses));
+}
+
+/**
+ * @brief Encode hci_inquiry_cancel into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_inquiry_cancel(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x02);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x02) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_inquiry_cancel, same as hci_send_cmd(&hci_inquiry_cancel, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_inquiry_cancel(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_inquiry_cancel(packet));
+}
+
+/**
+ * @brief Encode hci_create_connection into buffer
+ * @param packet buffer for 16 bytes
+ * @param bd_addr
+ * @param packet_type
+ * @param page_scan_repetition_mode
+ * @param reserved
+ * @param clock_offset
+ * @param allow_role_switch
+ * @return size of command
+ * @note: format B21121
+ */
+static inline uint16_t hci_cmd_encode_create_connection(uint8_t * packet, const bd_addr_t bd_addr, uint16_t packet_type, uint8_t page_scan_repetition_mode, uint8_t reserved, uint16_t clock_offset, uint8_t allow_role_switch){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x05);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x05) >> 8);
+    packet[2] = 13;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = (uint8_t) packet_type;
+    packet[10] = (uint8_t) (packet_type >> 8);
+    packet[11] = (uint8_t) page_scan_repetition_mode;
+    packet[12] = (uint8_t) reserved;
+    packet[13] = (uint8_t) clock_offset;
+    packet[14] = (uint8_t) (clock_offset >> 8);
+    packet[15] = (uint8_t) allow_role_switch;
+    return 16;
+}
+
+/**
+ * @brief Send hci_create_connection, same as hci_send_cmd(&hci_create_connection, ...)
+ * @param bd_addr
+ * @param packet_type
+ * @param page_scan_repetition_mode
+ * @param reserved
+ * @param clock_offset
+ * @param allow_role_switch
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_create_connection(const bd_addr_t bd_addr, uint16_t packet_type, uint8_t page_scan_repetition_mode, uint8_t reserved, uint16_t clock_offset, uint8_t allow_role_switch){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_create_connection(packet, bd_addr, packet_type, page_scan_repetition_mode, reserved, clock_offset, allow_role_switch));
+}
+
+/**
+ * @brief Encode hci_disconnect into buffer
+ * @param packet buffer for 6 bytes
+ * @param handle
+ * @param reason
+ * @return size of command
+ * @note: format H1
+ */
+static inline uint16_t hci_cmd_encode_disconnect(uint8_t * packet, hci_con_handle_t handle, uint8_t reason){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x06);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x06) >> 8);
+    packet[2] = 3;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    packet[5] = (uint8_t) reason;
+    return 6;
+}
+
+/**
+ * @brief Send hci_disconnect, same as hci_send_cmd(&hci_disconnect, ...)
+ * @param handle
+ * @param reason
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_disconnect(hci_con_handle_t handle, uint8_t reason){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_disconnect(packet, handle, reason));
+}
+
+/**
+ * @brief Encode hci_create_connection_cancel into buffer
+ * @param packet buffer for 9 bytes
+ * @param bd_addr
+ * @return size of command
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_create_connection_cancel(uint8_t * packet, const bd_addr_t bd_addr){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x08);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x08) >> 8);
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send hci_create_connection_cancel, same as hci_send_cmd(&hci_create_connection_cancel, ...)
+ * @param bd_addr
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_create_connection_cancel(const bd_addr_t bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_create_connection_cancel(packet, bd_addr));
+}
+
+/**
+ * @brief Encode hci_accept_connection_request into buffer
+ * @param packet buffer for 10 bytes
+ * @param bd_addr
+ * @param role
+ * @return size of command
+ * @note: format B1
+ */
+static inline uint16_t hci_cmd_encode_accept_connection_request(uint8_t * packet, const bd_addr_t bd_addr, uint8_t role){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x09);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x09) >> 8);
+    packet[2] = 7;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = (uint8_t) role;
+    return 10;
+}
+
+/**
+ * @brief Send hci_accept_connection_request, same as hci_send_cmd(&hci_accept_connection_request, ...)
+ * @param bd_addr
+ * @param role
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_accept_connection_request(const bd_addr_t bd_addr, uint8_t role){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_accept_connection_request(packet, bd_addr, role));
+}
+
+/**
+ * @brief Encode hci_reject_connection_request into buffer
+ * @param packet buffer for 10 bytes
+ * @param bd_addr
+ * @param reason
+ * @return size of command
+ * @note: format B1
+ */
+static inline uint16_t hci_cmd_encode_reject_connection_request(uint8_t * packet, const bd_addr_t bd_addr, uint8_t reason){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0a);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0a) >> 8);
+    packet[2] = 7;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = (uint8_t) reason;
+    return 10;
+}
+
+/**
+ * @brief Send hci_reject_connection_request, same as hci_send_cmd(&hci_reject_connection_request, ...)
+ * @param bd_addr
+ * @param reason
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_reject_connection_request(const bd_addr_t bd_addr, uint8_t reason){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_reject_connection_request(packet, bd_addr, reason));
+}
+
+/**
+ * @brief Encode hci_link_key_request_reply into buffer
+ * @param packet buffer for 25 bytes
+ * @param bd_addr
+ * @param link_key
+ * @return size of command
+ * @note: format BP
+ */
+static inline uint16_t hci_cmd_encode_link_key_request_reply(uint8_t * packet, const bd_addr_t bd_addr, const uint8_t * link_key){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0b);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0b) >> 8);
+    packet[2] = 22;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    (void)memcpy(&packet[9], link_key, 16);
+    return 25;
+}
+
+/**
+ * @brief Send hci_link_key_request_reply, same as hci_send_cmd(&hci_link_key_request_reply, ...)
+ * @param bd_addr
+ * @param link_key
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_link_key_request_reply(const bd_addr_t bd_addr, const uint8_t * link_key){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_link_key_request_reply(packet, bd_addr, link_key));
+}
+
+/**
+ * @brief Encode hci_link_key_request_negative_reply into buffer
+ * @param packet buffer for 9 bytes
+ * @param bd_addr
+ * @return size of command
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_link_key_request_negative_reply(uint8_t * packet, const bd_addr_t bd_addr){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0c);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0c) >> 8);
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send hci_link_key_request_negative_reply, same as hci_send_cmd(&hci_link_key_request_negative_reply, ...)
+ * @param bd_addr
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_link_key_request_negative_reply(const bd_addr_t bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_link_key_request_negative_reply(packet, bd_addr));
+}
+
+/**
+ * @brief Encode hci_pin_code_request_reply into buffer
+ * @param packet buffer for 26 bytes
+ * @param bd_addr
+ * @param pin_length
+ * @param pin
+ * @return size of command
+ * @note: format B1P
+ */
+static inline uint16_t hci_cmd_encode_pin_code_request_reply(uint8_t * packet, const bd_addr_t bd_addr, uint8_t pin_length, const uint8_t * pin){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0d);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0d) >> 8);
+    packet[2] = 23;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = (uint8_t) pin_length;
+    (void)memcpy(&packet[10], pin, 16);
+    return 26;
+}
+
+/**
+ * @brief Send hci_pin_code_request_reply, same as hci_send_cmd(&hci_pin_code_request_reply, ...)
+ * @param bd_addr
+ * @param pin_length
+ * @param pin
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_pin_code_request_reply(const bd_addr_t bd_addr, uint8_t pin_length, const uint8_t * pin){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_pin_code_request_reply(packet, bd_addr, pin_length, pin));
+}
+
+/**
+ * @brief Encode hci_pin_code_request_negative_reply into buffer
+ * @param packet buffer for 9 bytes
+ * @param bd_addr
+ * @return size of command
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_pin_code_request_negative_reply(uint8_t * packet, const bd_addr_t bd_addr){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0e);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0e) >> 8);
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send hci_pin_code_request_negative_reply, same as hci_send_cmd(&hci_pin_code_request_negative_reply, ...)
+ * @param bd_addr
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_pin_code_request_negative_reply(const bd_addr_t bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_pin_code_request_negative_reply(packet, bd_addr));
+}
+
+/**
+ * @brief Encode hci_change_connection_packet_type into buffer
+ * @param packet buffer for 7 bytes
+ * @param handle
+ * @param packet_type
+ * @return size of command
+ * @note: format H2
+ */
+static inline uint16_t hci_cmd_encode_change_connection_packet_type(uint8_t * packet, hci_con_handle_t handle, uint16_t packet_type){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0f);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0f) >> 8);
+    packet[2] = 4;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    packet[5] = (uint8_t) packet_type;
+    packet[6] = (uint8_t) (packet_type >> 8);
+    return 7;
+}
+
+/**
+ * @brief Send hci_change_connection_packet_type, same as hci_send_cmd(&hci_change_connection_packet_type, ...)
+ * @param handle
+ * @param packet_type
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_change_connection_packet_type(hci_con_handle_t handle, uint16_t packet_type){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_change_connection_packet_type(packet, handle, packet_type));
+}
+
+/**
+ * @brief Encode hci_authentication_requested into buffer
+ * @param packet buffer for 5 bytes
+ * @param handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_authentication_requested(uint8_t * packet, hci_con_handle_t handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x11);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x11) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_authentication_requested, same as hci_send_cmd(&hci_authentication_requested, ...)
+ * @param handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_authentication_requested(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_authentication_requested(packet, handle));
+}
+
+/**
+ * @brief Encode hci_set_connection_encryption into buffer
+ * @param packet buffer for 6 bytes
+ * @param handle
+ * @param encryption_enable
+ * @return size of command
+ * @note: format H1
+ */
+static inline uint16_t hci_cmd_encode_set_connection_encryption(uint8_t * packet, hci_con_handle_t handle, uint8_t encryption_enable){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x13);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x13) >> 8);
+    packet[2] = 3;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    packet[5] = (uint8_t) encryption_enable;
+    return 6;
+}
+
+/**
+ * @brief Send hci_set_connection_encryption, same as hci_send_cmd(&hci_set_connection_encryption, ...)
+ * @param handle
+ * @param encryption_enable
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_set_connection_encryption(hci_con_handle_t handle, uint8_t encryption_enable){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_set_connection_encryption(packet, handle, encryption_enable));
+}
+
+/**
+ * @brief Encode hci_change_connection_link_key into buffer
+ * @param packet buffer for 5 bytes
+ * @param handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_change_connection_link_key(uint8_t * packet, hci_con_handle_t handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x15);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x15) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_change_connection_link_key, same as hci_send_cmd(&hci_change_connection_link_key, ...)
+ * @param handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_change_connection_link_key(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_change_connection_link_key(packet, handle));
+}
+
+/**
+ * @brief Encode hci_remote_name_request into buffer
+ * @param packet buffer for 13 bytes
+ * @param bd_addr
+ * @param page_scan_repetition_mode
+ * @param reserved
+ * @param clock_offset
+ * @return size of command
+ * @note: format B112
+ */
+static inline uint16_t hci_cmd_encode_remote_name_request(uint8_t * packet, const bd_addr_t bd_addr, uint8_t page_scan_repetition_mode, uint8_t reserved, uint16_t clock_offset){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x19);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x19) >> 8);
+    packet[2] = 10;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = (uint8_t) page_scan_repetition_mode;
+    packet[10] = (uint8_t) reserved;
+    packet[11] = (uint8_t) clock_offset;
+    packet[12] = (uint8_t) (clock_offset >> 8);
+    return 13;
+}
+
+/**
+ * @brief Send hci_remote_name_request, same as hci_send_cmd(&hci_remote_name_request, ...)
+ * @param bd_addr
+ * @param page_scan_repetition_mode
+ * @param reserved
+ * @param clock_offset
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_remote_name_request(const bd_addr_t bd_addr, uint8_t page_scan_repetition_mode, uint8_t reserved, uint16_t clock_offset){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_remote_name_request(packet, bd_addr, page_scan_repetition_mode, reserved, clock_offset));
+}
+
+/**
+ * @brief Encode hci_remote_name_request_cancel into buffer
+ * @param packet buffer for 9 bytes
+ * @param bd_addr
+ * @return size of command
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_remote_name_request_cancel(uint8_t * packet, const bd_addr_t bd_addr){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x1A);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x1A) >> 8);
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send hci_remote_name_request_cancel, same as hci_send_cmd(&hci_remote_name_request_cancel, ...)
+ * @param bd_addr
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_remote_name_request_cancel(const bd_addr_t bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_remote_name_request_cancel(packet, bd_addr));
+}
+
+/**
+ * @brief Encode hci_read_remote_supported_features_command into buffer
+ * @param packet buffer for 5 bytes
+ * @param handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_read_remote_supported_features_command(uint8_t * packet, hci_con_handle_t handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x1B);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x1B) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_read_remote_supported_features_command, same as hci_send_cmd(&hci_read_remote_supported_features_command, ...)
+ * @param handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_remote_supported_features_command(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_remote_supported_features_command(packet, handle));
+}
+
+/**
+ * @brief Encode hci_read_remote_extended_features_command into buffer
+ * @param packet buffer for 6 bytes
+ * @param arg1
+ * @param arg2
+ * @return size of command
+ * @note: format H1
+ */
+static inline uint16_t hci_cmd_encode_read_remote_extended_features_command(uint8_t * packet, hci_con_handle_t arg1, uint8_t arg2){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x1C);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x1C) >> 8);
+    packet[2] = 3;
+    packet[3] = (uint8_t) arg1;
+    packet[4] = (uint8_t) (arg1 >> 8);
+    packet[5] = (uint8_t) arg2;
+    return 6;
+}
+
+/**
+ * @brief Send hci_read_remote_extended_features_command, same as hci_send_cmd(&hci_read_remote_extended_features_command, ...)
+ * @param arg1
+ * @param arg2
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_remote_extended_features_command(hci_con_handle_t arg1, uint8_t arg2){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_remote_extended_features_command(packet, arg1, arg2));
+}
+
+/**
+ * @brief Encode hci_read_remote_version_information into buffer
+ * @param packet buffer for 5 bytes
+ * @param handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_read_remote_version_information(uint8_t * packet, hci_con_handle_t handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x1D);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x1D) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_read_remote_version_information, same as hci_send_cmd(&hci_read_remote_version_information, ...)
+ * @param handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_remote_version_information(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_remote_version_information(packet, handle));
+}
+
+/**
+ * @brief Encode hci_setup_synchronous_connection into buffer
+ * @param packet buffer for 20 bytes
+ * @param handle
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param max_latency
+ * @param voice_settings
+ * @param retransmission_effort
+ * @param packet_type
+ * @return size of command
+ * @note: format H442212
+ */
+static inline uint16_t hci_cmd_encode_setup_synchronous_connection(uint8_t * packet, hci_con_handle_t handle, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint16_t max_latency, uint16_t voice_settings, uint8_t retransmission_effort, uint16_t packet_type){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0028);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0028) >> 8);
+    packet[2] = 17;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    packet[5] = (uint8_t) transmit_bandwidth;
+    packet[6] = (uint8_t) (transmit_bandwidth >> 8);
+    packet[7] = (uint8_t) (transmit_bandwidth >> 16);
+    packet[8] = (uint8_t) (transmit_bandwidth >> 24);
+    packet[9] = (uint8_t) receive_bandwidth;
+    packet[10] = (uint8_t) (receive_bandwidth >> 8);
+    packet[11] = (uint8_t) (receive_bandwidth >> 16);
+    packet[12] = (uint8_t) (receive_bandwidth >> 24);
+    packet[13] = (uint8_t) max_latency;
+    packet[14] = (uint8_t) (max_latency >> 8);
+    packet[15] = (uint8_t) voice_settings;
+    packet[16] = (uint8_t) (voice_settings >> 8);
+    packet[17] = (uint8_t) retransmission_effort;
+    packet[18] = (uint8_t) packet_type;
+    packet[19] = (uint8_t) (packet_type >> 8);
+    return 20;
+}
+
+/**
+ * @brief Send hci_setup_synchronous_connection, same as hci_send_cmd(&hci_setup_synchronous_connection, ...)
+ * @param handle
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param max_latency
+ * @param voice_settings
+ * @param retransmission_effort
+ * @param packet_type
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_setup_synchronous_connection(hci_con_handle_t handle, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint16_t max_latency, uint16_t voice_settings, uint8_t retransmission_effort, uint16_t packet_type){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_setup_synchronous_connection(packet, handle, transmit_bandwidth, receive_bandwidth, max_latency, voice_settings, retransmission_effort, packet_type));
+}
+
+/**
+ * @brief Encode hci_accept_synchronous_connection into buffer
+ * @param packet buffer for 24 bytes
+ * @param bd_addr
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param max_latency
+ * @param voice_settings
+ * @param retransmission_effort
+ * @param packet_type
+ * @return size of command
+ * @note: format B442212
+ */
+static inline uint16_t hci_cmd_encode_accept_synchronous_connection(uint8_t * packet, const bd_addr_t bd_addr, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint16_t max_latency, uint16_t voice_settings, uint8_t retransmission_effort, uint16_t packet_type){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0029);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x0029) >> 8);
+    packet[2] = 21;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = (uint8_t) transmit_bandwidth;
+    packet[10] = (uint8_t) (transmit_bandwidth >> 8);
+    packet[11] = (uint8_t) (transmit_bandwidth >> 16);
+    packet[12] = (uint8_t) (transmit_bandwidth >> 24);
+    packet[13] = (uint8_t) receive_bandwidth;
+    packet[14] = (uint8_t) (receive_bandwidth >> 8);
+    packet[15] = (uint8_t) (receive_bandwidth >> 16);
+    packet[16] = (uint8_t) (receive_bandwidth >> 24);
+    packet[17] = (uint8_t) max_latency;
+    packet[18] = (uint8_t) (max_latency >> 8);
+    packet[19] = (uint8_t) voice_settings;
+    packet[20] = (uint8_t) (voice_settings >> 8);
+    packet[21] = (uint8_t) retransmission_effort;
+    packet[22] = (uint8_t) packet_type;
+    packet[23] = (uint8_t) (packet_type >> 8);
+    return 24;
+}
+
+/**
+ * @brief Send hci_accept_synchronous_connection, same as hci_send_cmd(&hci_accept_synchronous_connection, ...)
+ * @param bd_addr
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param max_latency
+ * @param voice_settings
+ * @param retransmission_effort
+ * @param packet_type
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_accept_synchronous_connection(const bd_addr_t bd_addr, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint16_t max_latency, uint16_t voice_settings, uint8_t retransmission_effort, uint16_t packet_type){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_accept_synchronous_connection(packet, bd_addr, transmit_bandwidth, receive_bandwidth, max_latency, voice_settings, retransmission_effort, packet_type));
+}
+
+/**
+ * @brief Encode hci_io_capability_request_reply into buffer
+ * @param packet buffer for 12 bytes
+ * @param bd_addr
+ * @param io_capability
+ * @param oob_data_present
+ * @param authentication_requirements
+ * @return size of command
+ * @note: format B111
+ */
+static inline uint16_t hci_cmd_encode_io_capability_request_reply(uint8_t * packet, const bd_addr_t bd_addr, uint8_t io_capability, uint8_t oob_data_present, uint8_t authentication_requirements){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2b);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2b) >> 8);
+    packet[2] = 9;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = (uint8_t) io_capability;
+    packet[10] = (uint8_t) oob_data_present;
+    packet[11] = (uint8_t) authentication_requirements;
+    return 12;
+}
+
+/**
+ * @brief Send hci_io_capability_request_reply, same as hci_send_cmd(&hci_io_capability_request_reply, ...)
+ * @param bd_addr
+ * @param io_capability
+ * @param oob_data_present
+ * @param authentication_requirements
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_io_capability_request_reply(const bd_addr_t bd_addr, uint8_t io_capability, uint8_t oob_data_present, uint8_t authentication_requirements){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_io_capability_request_reply(packet, bd_addr, io_capability, oob_data_present, authentication_requirements));
+}
+
+/**
+ * @brief Encode hci_user_confirmation_request_reply into buffer
+ * @param packet buffer for 9 bytes
+ * @param bd_addr
+ * @return size of command
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_user_confirmation_request_reply(uint8_t * packet, const bd_addr_t bd_addr){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2c);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2c) >> 8);
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send hci_user_confirmation_request_reply, same as hci_send_cmd(&hci_user_confirmation_request_reply, ...)
+ * @param bd_addr
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_user_confirmation_request_reply(const bd_addr_t bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_user_confirmation_request_reply(packet, bd_addr));
+}
+
+/**
+ * @brief Encode hci_user_confirmation_request_negative_reply into buffer
+ * @param packet buffer for 9 bytes
+ * @param bd_addr
+ * @return size of command
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_user_confirmation_request_negative_reply(uint8_t * packet, const bd_addr_t bd_addr){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2d);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2d) >> 8);
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send hci_user_confirmation_request_negative_reply, same as hci_send_cmd(&hci_user_confirmation_request_negative_reply, ...)
+ * @param bd_addr
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_user_confirmation_request_negative_reply(const bd_addr_t bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_user_confirmation_request_negative_reply(packet, bd_addr));
+}
+
+/**
+ * @brief Encode hci_user_passkey_request_reply into buffer
+ * @param packet buffer for 13 bytes
+ * @param bd_addr
+ * @param numeric_value
+ * @return size of command
+ * @note: format B4
+ */
+static inline uint16_t hci_cmd_encode_user_passkey_request_reply(uint8_t * packet, const bd_addr_t bd_addr, uint32_t numeric_value){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2e);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2e) >> 8);
+    packet[2] = 10;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = (uint8_t) numeric_value;
+    packet[10] = (uint8_t) (numeric_value >> 8);
+    packet[11] = (uint8_t) (numeric_value >> 16);
+    packet[12] = (uint8_t) (numeric_value >> 24);
+    return 13;
+}
+
+/**
+ * @brief Send hci_user_passkey_request_reply, same as hci_send_cmd(&hci_user_passkey_request_reply, ...)
+ * @param bd_addr
+ * @param numeric_value
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_user_passkey_request_reply(const bd_addr_t bd_addr, uint32_t numeric_value){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_user_passkey_request_reply(packet, bd_addr, numeric_value));
+}
+
+/**
+ * @brief Encode hci_user_passkey_request_negative_reply into buffer
+ * @param packet buffer for 9 bytes
+ * @param bd_addr
+ * @return size of command
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_user_passkey_request_negative_reply(uint8_t * packet, const bd_addr_t bd_addr){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2f);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x2f) >> 8);
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send hci_user_passkey_request_negative_reply, same as hci_send_cmd(&hci_user_passkey_request_negative_reply, ...)
+ * @param bd_addr
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_user_passkey_request_negative_reply(const bd_addr_t bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_user_passkey_request_negative_reply(packet, bd_addr));
+}
+
+/**
+ * @brief Encode hci_remote_oob_data_request_reply into buffer
+ * @param packet buffer for 41 bytes
+ * @param bd_addr
+ * @param c
+ * @param r
+ * @return size of command
+ * @note: format BPP
+ */
+static inline uint16_t hci_cmd_encode_remote_oob_data_request_reply(uint8_t * packet, const bd_addr_t bd_addr, const uint8_t * c, const uint8_t * r){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x30);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x30) >> 8);
+    packet[2] = 38;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    (void)memcpy(&packet[9], c, 16);
+    (void)memcpy(&packet[25], r, 16);
+    return 41;
+}
+
+/**
+ * @brief Send hci_remote_oob_data_request_reply, same as hci_send_cmd(&hci_remote_oob_data_request_reply, ...)
+ * @param bd_addr
+ * @param c
+ * @param r
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_remote_oob_data_request_reply(const bd_addr_t bd_addr, const uint8_t * c, const uint8_t * r){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_remote_oob_data_request_reply(packet, bd_addr, c, r));
+}
+
+/**
+ * @brief Encode hci_remote_oob_data_request_negative_reply into buffer
+ * @param packet buffer for 9 bytes
+ * @param bd_addr
+ * @return size of command
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_remote_oob_data_request_negative_reply(uint8_t * packet, const bd_addr_t bd_addr){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x33);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x33) >> 8);
+    packet[2] = 6;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send hci_remote_oob_data_request_negative_reply, same as hci_send_cmd(&hci_remote_oob_data_request_negative_reply, ...)
+ * @param bd_addr
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_remote_oob_data_request_negative_reply(const bd_addr_t bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_remote_oob_data_request_negative_reply(packet, bd_addr));
+}
+
+/**
+ * @brief Encode hci_io_capability_request_negative_reply into buffer
+ * @param packet buffer for 10 bytes
+ * @param bd_addr
+ * @param reason
+ * @return size of command
+ * @note: format B1
+ */
+static inline uint16_t hci_cmd_encode_io_capability_request_negative_reply(uint8_t * packet, const bd_addr_t bd_addr, uint8_t reason){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x34);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x34) >> 8);
+    packet[2] = 7;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = (uint8_t) reason;
+    return 10;
+}
+
+/**
+ * @brief Send hci_io_capability_request_negative_reply, same as hci_send_cmd(&hci_io_capability_request_negative_reply, ...)
+ * @param bd_addr
+ * @param reason
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_io_capability_request_negative_reply(const bd_addr_t bd_addr, uint8_t reason){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_io_capability_request_negative_reply(packet, bd_addr, reason));
+}
+
+/**
+ * @brief Encode hci_enhanced_setup_synchronous_connection into buffer
+ * @param packet buffer for 62 bytes
+ * @param handle
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param transmit_coding_format_type
+ * @param transmit_coding_format_company
+ * @param transmit_coding_format_codec
+ * @param receive_coding_format_type
+ * @param receive_coding_format_company
+ * @param receive_coding_format_codec
+ * @param transmit_coding_frame_size
+ * @param receive_coding_frame_size
+ * @param input_bandwidth
+ * @param output_bandwidth
+ * @param input_coding_format_type
+ * @param input_coding_format_company
+ * @param input_coding_format_codec
+ * @param output_coding_format_type
+ * @param output_coding_format_company
+ * @param output_coding_format_codec
+ * @param input_coded_data_size
+ * @param outupt_coded_data_size
+ * @param input_pcm_data_format
+ * @param output_pcm_data_format
+ * @param input_pcm_sample_payload_msb_position
+ * @param output_pcm_sample_payload_msb_position
+ * @param input_data_path
+ * @param output_data_path
+ * @param input_transport_unit_size
+ * @param output_transport_unit_size
+ * @param max_latency
+ * @param packet_type
+ * @param retransmission_effort
+ * @return size of command
+ * @note: format H4412212222441221222211111111221
+ */
+static inline uint16_t hci_cmd_encode_enhanced_setup_synchronous_connection(uint8_t * packet, hci_con_handle_t handle, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint8_t transmit_coding_format_type, uint16_t transmit_coding_format_company, uint16_t transmit_coding_format_codec, uint8_t receive_coding_format_type, uint16_t receive_coding_format_company, uint16_t receive_coding_format_codec, uint16_t transmit_coding_frame_size, uint16_t receive_coding_frame_size, uint32_t input_bandwidth, uint32_t output_bandwidth, uint8_t input_coding_format_type, uint16_t input_coding_format_company, uint16_t input_coding_format_codec, uint8_t output_coding_format_type, uint16_t output_coding_format_company, uint16_t output_coding_format_codec, uint16_t input_coded_data_size, uint16_t outupt_coded_data_size, uint8_t input_pcm_data_format, uint8_t output_pcm_data_format, uint8_t input_pcm_sample_payload_msb_position, uint8_t output_pcm_sample_payload_msb_position, uint8_t input_data_path, uint8_t output_data_path, uint8_t input_transport_unit_size, uint8_t output_transport_unit_size, uint16_t max_latency, uint16_t packet_type, uint8_t retransmission_effort){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x3d);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x3d) >> 8);
+    packet[2] = 59;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    packet[5] = (uint8_t) transmit_bandwidth;
+    packet[6] = (uint8_t) (transmit_bandwidth >> 8);
+    packet[7] = (uint8_t) (transmit_bandwidth >> 16);
+    packet[8] = (uint8_t) (transmit_bandwidth >> 24);
+    packet[9] = (uint8_t) receive_bandwidth;
+    packet[10] = (uint8_t) (receive_bandwidth >> 8);
+    packet[11] = (uint8_t) (receive_bandwidth >> 16);
+    packet[12] = (uint8_t) (receive_bandwidth >> 24);
+    packet[13] = (uint8_t) transmit_coding_format_type;
+    packet[14] = (uint8_t) transmit_coding_format_company;
+    packet[15] = (uint8_t) (transmit_coding_format_company >> 8);
+    packet[16] = (uint8_t) transmit_coding_format_codec;
+    packet[17] = (uint8_t) (transmit_coding_format_codec >> 8);
+    packet[18] = (uint8_t) receive_coding_format_type;
+    packet[19] = (uint8_t) receive_coding_format_company;
+    packet[20] = (uint8_t) (receive_coding_format_company >> 8);
+    packet[21] = (uint8_t) receive_coding_format_codec;
+    packet[22] = (uint8_t) (receive_coding_format_codec >> 8);
+    packet[23] = (uint8_t) transmit_coding_frame_size;
+    packet[24] = (uint8_t) (transmit_coding_frame_size >> 8);
+    packet[25] = (uint8_t) receive_coding_frame_size;
+    packet[26] = (uint8_t) (receive_coding_frame_size >> 8);
+    packet[27] = (uint8_t) input_bandwidth;
+    packet[28] = (uint8_t) (input_bandwidth >> 8);
+    packet[29] = (uint8_t) (input_bandwidth >> 16);
+    packet[30] = (uint8_t) (input_bandwidth >> 24);
+    packet[31] = (uint8_t) output_bandwidth;
+    packet[32] = (uint8_t) (output_bandwidth >> 8);
+    packet[33] = (uint8_t) (output_bandwidth >> 16);
+    packet[34] = (uint8_t) (output_bandwidth >> 24);
+    packet[35] = (uint8_t) input_coding_format_type;
+    packet[36] = (uint8_t) input_coding_format_company;
+    packet[37] = (uint8_t) (input_coding_format_company >> 8);
+    packet[38] = (uint8_t) input_coding_format_codec;
+    packet[39] = (uint8_t) (input_coding_format_codec >> 8);
+    packet[40] = (uint8_t) output_coding_format_type;
+    packet[41] = (uint8_t) output_coding_format_company;
+    packet[42] = (uint8_t) (output_coding_format_company >> 8);
+    packet[43] = (uint8_t) output_coding_format_codec;
+    packet[44] = (uint8_t) (output_coding_format_codec >> 8);
+    packet[45] = (uint8_t) input_coded_data_size;
+    packet[46] = (uint8_t) (input_coded_data_size >> 8);
+    packet[47] = (uint8_t) outupt_coded_data_size;
+    packet[48] = (uint8_t) (outupt_coded_data_size >> 8);
+    packet[49] = (uint8_t) input_pcm_data_format;
+    packet[50] = (uint8_t) output_pcm_data_format;
+    packet[51] = (uint8_t) input_pcm_sample_payload_msb_position;
+    packet[52] = (uint8_t) output_pcm_sample_payload_msb_position;
+    packet[53] = (uint8_t) input_data_path;
+    packet[54] = (uint8_t) output_data_path;
+    packet[55] = (uint8_t) input_transport_unit_size;
+    packet[56] = (uint8_t) output_transport_unit_size;
+    packet[57] = (uint8_t) max_latency;
+    packet[58] = (uint8_t) (max_latency >> 8);
+    packet[59] = (uint8_t) packet_type;
+    packet[60] = (uint8_t) (packet_type >> 8);
+    packet[61] = (uint8_t) retransmission_effort;
+    return 62;
+}
+
+/**
+ * @brief Send hci_enhanced_setup_synchronous_connection, same as hci_send_cmd(&hci_enhanced_setup_synchronous_connection, ...)
+ * @param handle
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param transmit_coding_format_type
+ * @param transmit_coding_format_company
+ * @param transmit_coding_format_codec
+ * @param receive_coding_format_type
+ * @param receive_coding_format_company
+ * @param receive_coding_format_codec
+ * @param transmit_coding_frame_size
+ * @param receive_coding_frame_size
+ * @param input_bandwidth
+ * @param output_bandwidth
+ * @param input_coding_format_type
+ * @param input_coding_format_company
+ * @param input_coding_format_codec
+ * @param output_coding_format_type
+ * @param output_coding_format_company
+ * @param output_coding_format_codec
+ * @param input_coded_data_size
+ * @param outupt_coded_data_size
+ * @param input_pcm_data_format
+ * @param output_pcm_data_format
+ * @param input_pcm_sample_payload_msb_position
+ * @param output_pcm_sample_payload_msb_position
+ * @param input_data_path
+ * @param output_data_path
+ * @param input_transport_unit_size
+ * @param output_transport_unit_size
+ * @param max_latency
+ * @param packet_type
+ * @param retransmission_effort
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_enhanced_setup_synchronous_connection(hci_con_handle_t handle, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint8_t transmit_coding_format_type, uint16_t transmit_coding_format_company, uint16_t transmit_coding_format_codec, uint8_t receive_coding_format_type, uint16_t receive_coding_format_company, uint16_t receive_coding_format_codec, uint16_t transmit_coding_frame_size, uint16_t receive_coding_frame_size, uint32_t input_bandwidth, uint32_t output_bandwidth, uint8_t input_coding_format_type, uint16_t input_coding_format_company, uint16_t input_coding_format_codec, uint8_t output_coding_format_type, uint16_t output_coding_format_company, uint16_t output_coding_format_codec, uint16_t input_coded_data_size, uint16_t outupt_coded_data_size, uint8_t input_pcm_data_format, uint8_t output_pcm_data_format, uint8_t input_pcm_sample_payload_msb_position, uint8_t output_pcm_sample_payload_msb_position, uint8_t input_data_path, uint8_t output_data_path, uint8_t input_transport_unit_size, uint8_t output_transport_unit_size, uint16_t max_latency, uint16_t packet_type, uint8_t retransmission_effort){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_enhanced_setup_synchronous_connection(packet, handle, transmit_bandwidth, receive_bandwidth, transmit_coding_format_type, transmit_coding_format_company, transmit_coding_format_codec, receive_coding_format_type, receive_coding_format_company, receive_coding_format_codec, transmit_coding_frame_size, receive_coding_frame_size, input_bandwidth, output_bandwidth, input_coding_format_type, input_coding_format_company, input_coding_format_codec, output_coding_format_type, output_coding_format_company, output_coding_format_codec, input_coded_data_size, outupt_coded_data_size, input_pcm_data_format, output_pcm_data_format, input_pcm_sample_payload_msb_position, output_pcm_sample_payload_msb_position, input_data_path, output_data_path, input_transport_unit_size, output_transport_unit_size, max_latency, packet_type, retransmission_effort));
+}
+
+/**
+ * @brief Encode hci_enhanced_accept_synchronous_connection into buffer
+ * @param packet buffer for 66 bytes
+ * @param bd_addr
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param transmit_coding_format_type
+ * @param transmit_coding_format_company
+ * @param transmit_coding_format_codec
+ * @param receive_coding_format_type
+ * @param receive_coding_format_company
+ * @param receive_coding_format_codec
+ * @param transmit_coding_frame_size
+ * @param receive_coding_frame_size
+ * @param input_bandwidth
+ * @param output_bandwidth
+ * @param input_coding_format_type
+ * @param input_coding_format_company
+ * @param input_coding_format_codec
+ * @param output_coding_format_type
+ * @param output_coding_format_company
+ * @param output_coding_format_codec
+ * @param input_coded_data_size
+ * @param outupt_coded_data_size
+ * @param input_pcm_data_format
+ * @param output_pcm_data_format
+ * @param input_pcm_sample_payload_msb_position
+ * @param output_pcm_sample_payload_msb_position
+ * @param input_data_path
+ * @param output_data_path
+ * @param input_transport_unit_size
+ * @param output_transport_unit_size
+ * @param max_latency
+ * @param packet_type
+ * @param retransmission_effort
+ * @return size of command
+ * @note: format B4412212222441221222211111111221
+ */
+static inline uint16_t hci_cmd_encode_enhanced_accept_synchronous_connection(uint8_t * packet, const bd_addr_t bd_addr, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint8_t transmit_coding_format_type, uint16_t transmit_coding_format_company, uint16_t transmit_coding_format_codec, uint8_t receive_coding_format_type, uint16_t receive_coding_format_company, uint16_t receive_coding_format_codec, uint16_t transmit_coding_frame_size, uint16_t receive_coding_frame_size, uint32_t input_bandwidth, uint32_t output_bandwidth, uint8_t input_coding_format_type, uint16_t input_coding_format_company, uint16_t input_coding_format_codec, uint8_t output_coding_format_type, uint16_t output_coding_format_company, uint16_t output_coding_format_codec, uint16_t input_coded_data_size, uint16_t outupt_coded_data_size, uint8_t input_pcm_data_format, uint8_t output_pcm_data_format, uint8_t input_pcm_sample_payload_msb_position, uint8_t output_pcm_sample_payload_msb_position, uint8_t input_data_path, uint8_t output_data_path, uint8_t input_transport_unit_size, uint8_t output_transport_unit_size, uint16_t max_latency, uint16_t packet_type, uint8_t retransmission_effort){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x3e);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_CONTROL, 0x3e) >> 8);
+    packet[2] = 63;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = (uint8_t) transmit_bandwidth;
+    packet[10] = (uint8_t) (transmit_bandwidth >> 8);
+    packet[11] = (uint8_t) (transmit_bandwidth >> 16);
+    packet[12] = (uint8_t) (transmit_bandwidth >> 24);
+    packet[13] = (uint8_t) receive_bandwidth;
+    packet[14] = (uint8_t) (receive_bandwidth >> 8);
+    packet[15] = (uint8_t) (receive_bandwidth >> 16);
+    packet[16] = (uint8_t) (receive_bandwidth >> 24);
+    packet[17] = (uint8_t) transmit_coding_format_type;
+    packet[18] = (uint8_t) transmit_coding_format_company;
+    packet[19] = (uint8_t) (transmit_coding_format_company >> 8);
+    packet[20] = (uint8_t) transmit_coding_format_codec;
+    packet[21] = (uint8_t) (transmit_coding_format_codec >> 8);
+    packet[22] = (uint8_t) receive_coding_format_type;
+    packet[23] = (uint8_t) receive_coding_format_company;
+    packet[24] = (uint8_t) (receive_coding_format_company >> 8);
+    packet[25] = (uint8_t) receive_coding_format_codec;
+    packet[26] = (uint8_t) (receive_coding_format_codec >> 8);
+    packet[27] = (uint8_t) transmit_coding_frame_size;
+    packet[28] = (uint8_t) (transmit_coding_frame_size >> 8);
+    packet[29] = (uint8_t) receive_coding_frame_size;
+    packet[30] = (uint8_t) (receive_coding_frame_size >> 8);
+    packet[31] = (uint8_t) input_bandwidth;
+    packet[32] = (uint8_t) (input_bandwidth >> 8);
+    packet[33] = (uint8_t) (input_bandwidth >> 16);
+    packet[34] = (uint8_t) (input_bandwidth >> 24);
+    packet[35] = (uint8_t) output_bandwidth;
+    packet[36] = (uint8_t) (output_bandwidth >> 8);
+    packet[37] = (uint8_t) (output_bandwidth >> 16);
+    packet[38] = (uint8_t) (output_bandwidth >> 24);
+    packet[39] = (uint8_t) input_coding_format_type;
+    packet[40] = (uint8_t) input_coding_format_company;
+    packet[41] = (uint8_t) (input_coding_format_company >> 8);
+    packet[42] = (uint8_t) input_coding_format_codec;
+    packet[43] = (uint8_t) (input_coding_format_codec >> 8);
+    packet[44] = (uint8_t) output_coding_format_type;
+    packet[45] = (uint8_t) output_coding_format_company;
+    packet[46] = (uint8_t) (output_coding_format_company >> 8);
+    packet[47] = (uint8_t) output_coding_format_codec;
+    packet[48] = (uint8_t) (output_coding_format_codec >> 8);
+    packet[49] = (uint8_t) input_coded_data_size;
+    packet[50] = (uint8_t) (input_coded_data_size >> 8);
+    packet[51] = (uint8_t) outupt_coded_data_size;
+    packet[52] = (uint8_t) (outupt_coded_data_size >> 8);
+    packet[53] = (uint8_t) input_pcm_data_format;
+    packet[54] = (uint8_t) output_pcm_data_format;
+    packet[55] = (uint8_t) input_pcm_sample_payload_msb_position;
+    packet[56] = (uint8_t) output_pcm_sample_payload_msb_position;
+    packet[57] = (uint8_t) input_data_path;
+    packet[58] = (uint8_t) output_data_path;
+    packet[59] = (uint8_t) input_transport_unit_size;
+    packet[60] = (uint8_t) output_transport_unit_size;
+    packet[61] = (uint8_t) max_latency;
+    packet[62] = (uint8_t) (max_latency >> 8);
+    packet[63] = (uint8_t) packet_type;
+    packet[64] = (uint8_t) (packet_type >> 8);
+    packet[65] = (uint8_t) retransmission_effort;
+    return 66;
+}
+
+/**
+ * @brief Send hci_enhanced_accept_synchronous_connection, same as hci_send_cmd(&hci_enhanced_accept_synchronous_connection, ...)
+ * @param bd_addr
+ * @param transmit_bandwidth
+ * @param receive_bandwidth
+ * @param transmit_coding_format_type
+ * @param transmit_coding_format_company
+ * @param transmit_coding_format_codec
+ * @param receive_coding_format_type
+ * @param receive_coding_format_company
+ * @param receive_coding_format_codec
+ * @param transmit_coding_frame_size
+ * @param receive_coding_frame_size
+ * @param input_bandwidth
+ * @param output_bandwidth
+ * @param input_coding_format_type
+ * @param input_coding_format_company
+ * @param input_coding_format_codec
+ * @param output_coding_format_type
+ * @param output_coding_format_company
+ * @param output_coding_format_codec
+ * @param input_coded_data_size
+ * @param outupt_coded_data_size
+ * @param input_pcm_data_format
+ * @param output_pcm_data_format
+ * @param input_pcm_sample_payload_msb_position
+ * @param output_pcm_sample_payload_msb_position
+ * @param input_data_path
+ * @param output_data_path
+ * @param input_transport_unit_size
+ * @param output_transport_unit_size
+ * @param max_latency
+ * @param packet_type
+ * @param retransmission_effort
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_enhanced_accept_synchronous_connection(const bd_addr_t bd_addr, uint32_t transmit_bandwidth, uint32_t receive_bandwidth, uint8_t transmit_coding_format_type, uint16_t transmit_coding_format_company, uint16_t transmit_coding_format_codec, uint8_t receive_coding_format_type, uint16_t receive_coding_format_company, uint16_t receive_coding_format_codec, uint16_t transmit_coding_frame_size, uint16_t receive_coding_frame_size, uint32_t input_bandwidth, uint32_t output_bandwidth, uint8_t input_coding_format_type, uint16_t input_coding_format_company, uint16_t input_coding_format_codec, uint8_t output_coding_format_type, uint16_t output_coding_format_company, uint16_t output_coding_format_codec, uint16_t input_coded_data_size, uint16_t outupt_coded_data_size, uint8_t input_pcm_data_format, uint8_t output_pcm_data_format, uint8_t input_pcm_sample_payload_msb_position, uint8_t output_pcm_sample_payload_msb_position, uint8_t input_data_path, uint8_t output_data_path, uint8_t input_transport_unit_size, uint8_t output_transport_unit_size, uint16_t max_latency, uint16_t packet_type, uint8_t retransmission_effort){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_enhanced_accept_synchronous_connection(packet, bd_addr, transmit_bandwidth, receive_bandwidth, transmit_coding_format_type, transmit_coding_format_company, transmit_coding_format_codec, receive_coding_format_type, receive_coding_format_company, receive_coding_format_codec, transmit_coding_frame_size, receive_coding_frame_size, input_bandwidth, output_bandwidth, input_coding_format_type, input_coding_format_company, input_coding_format_codec, output_coding_format_type, output_coding_format_company, output_coding_format_codec, input_coded_data_size, outupt_coded_data_size, input_pcm_data_format, output_pcm_data_format, input_pcm_sample_payload_msb_position, output_pcm_sample_payload_msb_position, input_data_path, output_data_path, input_transport_unit_size, output_transport_unit_size, max_latency, packet_type, retransmission_effort));
+}
+
+/**
+ * @brief Encode hci_sniff_mode into buffer
+ * @param packet buffer for 13 bytes
+ * @param handle
+ * @param sniff_max_interval
+ * @param sniff_min_interval
+ * @param sniff_attempt
+ * @param sniff_timeout
+ * @return size of command
+ * @note: format H2222
+ */
+static inline uint16_t hci_cmd_encode_sniff_mode(uint8_t * packet, hci_con_handle_t handle, uint16_t sniff_max_interval, uint16_t sniff_min_interval, uint16_t sniff_attempt, uint16_t sniff_timeout){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x03);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x03) >> 8);
+    packet[2] = 10;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    packet[5] = (uint8_t) sniff_max_interval;
+    packet[6] = (uint8_t) (sniff_max_interval >> 8);
+    packet[7] = (uint8_t) sniff_min_interval;
+    packet[8] = (uint8_t) (sniff_min_interval >> 8);
+    packet[9] = (uint8_t) sniff_attempt;
+    packet[10] = (uint8_t) (sniff_attempt >> 8);
+    packet[11] = (uint8_t) sniff_timeout;
+    packet[12] = (uint8_t) (sniff_timeout >> 8);
+    return 13;
+}
+
+/**
+ * @brief Send hci_sniff_mode, same as hci_send_cmd(&hci_sniff_mode, ...)
+ * @param handle
+ * @param sniff_max_interval
+ * @param sniff_min_interval
+ * @param sniff_attempt
+ * @param sniff_timeout
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_sniff_mode(hci_con_handle_t handle, uint16_t sniff_max_interval, uint16_t sniff_min_interval, uint16_t sniff_attempt, uint16_t sniff_timeout){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_sniff_mode(packet, handle, sniff_max_interval, sniff_min_interval, sniff_attempt, sniff_timeout));
+}
+
+/**
+ * @brief Encode hci_exit_sniff_mode into buffer
+ * @param packet buffer for 5 bytes
+ * @param handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_exit_sniff_mode(uint8_t * packet, hci_con_handle_t handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x04);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x04) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_exit_sniff_mode, same as hci_send_cmd(&hci_exit_sniff_mode, ...)
+ * @param handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_exit_sniff_mode(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_exit_sniff_mode(packet, handle));
+}
+
+/**
+ * @brief Encode hci_qos_setup into buffer
+ * @param packet buffer for 23 bytes
+ * @param handle
+ * @param flags
+ * @param service_type
+ * @param token_rate
+ * @param peak_bandwith
+ * @param latency
+ * @param delay_variation
+ * @return size of command
+ * @note: format H114444
+ */
+static inline uint16_t hci_cmd_encode_qos_setup(uint8_t * packet, hci_con_handle_t handle, uint8_t flags, uint8_t service_type, uint32_t token_rate, uint32_t peak_bandwith, uint32_t latency, uint32_t delay_variation){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x07);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x07) >> 8);
+    packet[2] = 20;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    packet[5] = (uint8_t) flags;
+    packet[6] = (uint8_t) service_type;
+    packet[7] = (uint8_t) token_rate;
+    packet[8] = (uint8_t) (token_rate >> 8);
+    packet[9] = (uint8_t) (token_rate >> 16);
+    packet[10] = (uint8_t) (token_rate >> 24);
+    packet[11] = (uint8_t) peak_bandwith;
+    packet[12] = (uint8_t) (peak_bandwith >> 8);
+    packet[13] = (uint8_t) (peak_bandwith >> 16);
+    packet[14] = (uint8_t) (peak_bandwith >> 24);
+    packet[15] = (uint8_t) latency;
+    packet[16] = (uint8_t) (latency >> 8);
+    packet[17] = (uint8_t) (latency >> 16);
+    packet[18] = (uint8_t) (latency >> 24);
+    packet[19] = (uint8_t) delay_variation;
+    packet[20] = (uint8_t) (delay_variation >> 8);
+    packet[21] = (uint8_t) (delay_variation >> 16);
+    packet[22] = (uint8_t) (delay_variation >> 24);
+    return 23;
+}
+
+/**
+ * @brief Send hci_qos_setup, same as hci_send_cmd(&hci_qos_setup, ...)
+ * @param handle
+ * @param flags
+ * @param service_type
+ * @param token_rate
+ * @param peak_bandwith
+ * @param latency
+ * @param delay_variation
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_qos_setup(hci_con_handle_t handle, uint8_t flags, uint8_t service_type, uint32_t token_rate, uint32_t peak_bandwith, uint32_t latency, uint32_t delay_variation){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_qos_setup(packet, handle, flags, service_type, token_rate, peak_bandwith, latency, delay_variation));
+}
+
+/**
+ * @brief Encode hci_role_discovery into buffer
+ * @param packet buffer for 5 bytes
+ * @param handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_role_discovery(uint8_t * packet, hci_con_handle_t handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x09);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x09) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_role_discovery, same as hci_send_cmd(&hci_role_discovery, ...)
+ * @param handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_role_discovery(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_role_discovery(packet, handle));
+}
+
+/**
+ * @brief Encode hci_switch_role_command into buffer
+ * @param packet buffer for 10 bytes
+ * @param bd_addr
+ * @param role
+ * @return size of command
+ * @note: format B1
+ */
+static inline uint16_t hci_cmd_encode_switch_role_command(uint8_t * packet, const bd_addr_t bd_addr, uint8_t role){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x0b);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x0b) >> 8);
+    packet[2] = 7;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = (uint8_t) role;
+    return 10;
+}
+
+/**
+ * @brief Send hci_switch_role_command, same as hci_send_cmd(&hci_switch_role_command, ...)
+ * @param bd_addr
+ * @param role
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_switch_role_command(const bd_addr_t bd_addr, uint8_t role){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_switch_role_command(packet, bd_addr, role));
+}
+
+/**
+ * @brief Encode hci_read_link_policy_settings into buffer
+ * @param packet buffer for 5 bytes
+ * @param handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_read_link_policy_settings(uint8_t * packet, hci_con_handle_t handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x0c);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x0c) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_read_link_policy_settings, same as hci_send_cmd(&hci_read_link_policy_settings, ...)
+ * @param handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_link_policy_settings(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_link_policy_settings(packet, handle));
+}
+
+/**
+ * @brief Encode hci_write_link_policy_settings into buffer
+ * @param packet buffer for 7 bytes
+ * @param handle
+ * @param settings
+ * @return size of command
+ * @note: format H2
+ */
+static inline uint16_t hci_cmd_encode_write_link_policy_settings(uint8_t * packet, hci_con_handle_t handle, uint16_t settings){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x0d);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x0d) >> 8);
+    packet[2] = 4;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    packet[5] = (uint8_t) settings;
+    packet[6] = (uint8_t) (settings >> 8);
+    return 7;
+}
+
+/**
+ * @brief Send hci_write_link_policy_settings, same as hci_send_cmd(&hci_write_link_policy_settings, ...)
+ * @param handle
+ * @param settings
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_link_policy_settings(hci_con_handle_t handle, uint16_t settings){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_link_policy_settings(packet, handle, settings));
+}
+
+/**
+ * @brief Encode hci_write_default_link_policy_setting into buffer
+ * @param packet buffer for 5 bytes
+ * @param policy
+ * @return size of command
+ * @note: format 2
+ */
+static inline uint16_t hci_cmd_encode_write_default_link_policy_setting(uint8_t * packet, uint16_t policy){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x0F);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LINK_POLICY, 0x0F) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) policy;
+    packet[4] = (uint8_t) (policy >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_write_default_link_policy_setting, same as hci_send_cmd(&hci_write_default_link_policy_setting, ...)
+ * @param policy
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_default_link_policy_setting(uint16_t policy){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_default_link_policy_setting(packet, policy));
+}
+
+/**
+ * @brief Encode hci_set_event_mask into buffer
+ * @param packet buffer for 11 bytes
+ * @param event_mask_lover_octets
+ * @param event_mask_higher_octets
+ * @return size of command
+ * @note: format 44
+ */
+static inline uint16_t hci_cmd_encode_set_event_mask(uint8_t * packet, uint32_t event_mask_lover_octets, uint32_t event_mask_higher_octets){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x01);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x01) >> 8);
+    packet[2] = 8;
+    packet[3] = (uint8_t) event_mask_lover_octets;
+    packet[4] = (uint8_t) (event_mask_lover_octets >> 8);
+    packet[5] = (uint8_t) (event_mask_lover_octets >> 16);
+    packet[6] = (uint8_t) (event_mask_lover_octets >> 24);
+    packet[7] = (uint8_t) event_mask_higher_octets;
+    packet[8] = (uint8_t) (event_mask_higher_octets >> 8);
+    packet[9] = (uint8_t) (event_mask_higher_octets >> 16);
+    packet[10] = (uint8_t) (event_mask_higher_octets >> 24);
+    return 11;
+}
+
+/**
+ * @brief Send hci_set_event_mask, same as hci_send_cmd(&hci_set_event_mask, ...)
+ * @param event_mask_lover_octets
+ * @param event_mask_higher_octets
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_set_event_mask(uint32_t event_mask_lover_octets, uint32_t event_mask_higher_octets){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_set_event_mask(packet, event_mask_lover_octets, event_mask_higher_octets));
+}
+
+/**
+ * @brief Encode hci_reset into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_reset(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x03);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x03) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_reset, same as hci_send_cmd(&hci_reset, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_reset(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_reset(packet));
+}
+
+/**
+ * @brief Encode hci_flush into buffer
+ * @param packet buffer for 5 bytes
+ * @param handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_flush(uint8_t * packet, hci_con_handle_t handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x08);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x08) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_flush, same as hci_send_cmd(&hci_flush, ...)
+ * @param handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_flush(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_flush(packet, handle));
+}
+
+/**
+ * @brief Encode hci_read_pin_type into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_pin_type(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x09);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x09) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_pin_type, same as hci_send_cmd(&hci_read_pin_type, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_pin_type(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_pin_type(packet));
+}
+
+/**
+ * @brief Encode hci_write_pin_type into buffer
+ * @param packet buffer for 4 bytes
+ * @param handle
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_pin_type(uint8_t * packet, uint8_t handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x0A);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x0A) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) handle;
+    return 4;
+}
+
+/**
+ * @brief Send hci_write_pin_type, same as hci_send_cmd(&hci_write_pin_type, ...)
+ * @param handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_pin_type(uint8_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_pin_type(packet, handle));
+}
+
+/**
+ * @brief Encode hci_delete_stored_link_key into buffer
+ * @param packet buffer for 10 bytes
+ * @param bd_addr
+ * @param delete_all_flags
+ * @return size of command
+ * @note: format B1
+ */
+static inline uint16_t hci_cmd_encode_delete_stored_link_key(uint8_t * packet, const bd_addr_t bd_addr, uint8_t delete_all_flags){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x12);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x12) >> 8);
+    packet[2] = 7;
+    reverse_bd_addr(bd_addr, &packet[3]);
+    packet[9] = (uint8_t) delete_all_flags;
+    return 10;
+}
+
+/**
+ * @brief Send hci_delete_stored_link_key, same as hci_send_cmd(&hci_delete_stored_link_key, ...)
+ * @param bd_addr
+ * @param delete_all_flags
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_delete_stored_link_key(const bd_addr_t bd_addr, uint8_t delete_all_flags){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_delete_stored_link_key(packet, bd_addr, delete_all_flags));
+}
+
+/**
+ * @brief Encode hci_write_local_name into buffer
+ * @param packet buffer for 251 bytes
+ * @param local_name
+ * @return size of command
+ * @note: format N
+ */
+static inline uint16_t hci_cmd_encode_write_local_name(uint8_t * packet, const char * local_name){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x13);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x13) >> 8);
+    packet[2] = 248;
+    uint16_t local_name_len = btstack_min(strlen(local_name), 248);
+    (void)memcpy(&packet[3], local_name, local_name_len);
+    memset(&packet[3 + local_name_len], 0, 248 - local_name_len);
+    return 251;
+}
+
+/**
+ * @brief Send hci_write_local_name, same as hci_send_cmd(&hci_write_local_name, ...)
+ * @param local_name
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_local_name(const char * local_name){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_local_name(packet, local_name));
+}
+
+/**
+ * @brief Encode hci_read_local_name into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_local_name(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x14);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x14) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_local_name, same as hci_send_cmd(&hci_read_local_name, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_local_name(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_local_name(packet));
+}
+
+/**
+ * @brief Encode hci_read_page_timeout into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_page_timeout(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x17);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x17) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_page_timeout, same as hci_send_cmd(&hci_read_page_timeout, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_page_timeout(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_page_timeout(packet));
+}
+
+/**
+ * @brief Encode hci_write_page_timeout into buffer
+ * @param packet buffer for 5 bytes
+ * @param page_timeout
+ * @return size of command
+ * @note: format 2
+ */
+static inline uint16_t hci_cmd_encode_write_page_timeout(uint8_t * packet, uint16_t page_timeout){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x18);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x18) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) page_timeout;
+    packet[4] = (uint8_t) (page_timeout >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_write_page_timeout, same as hci_send_cmd(&hci_write_page_timeout, ...)
+ * @param page_timeout
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_page_timeout(uint16_t page_timeout){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_page_timeout(packet, page_timeout));
+}
+
+/**
+ * @brief Encode hci_write_scan_enable into buffer
+ * @param packet buffer for 4 bytes
+ * @param scan_enable
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_scan_enable(uint8_t * packet, uint8_t scan_enable){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x1A);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x1A) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) scan_enable;
+    return 4;
+}
+
+/**
+ * @brief Send hci_write_scan_enable, same as hci_send_cmd(&hci_write_scan_enable, ...)
+ * @param scan_enable
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_scan_enable(uint8_t scan_enable){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_scan_enable(packet, scan_enable));
+}
+
+/**
+ * @brief Encode hci_read_page_scan_activity into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_page_scan_activity(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x1B);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x1B) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_page_scan_activity, same as hci_send_cmd(&hci_read_page_scan_activity, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_page_scan_activity(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_page_scan_activity(packet));
+}
+
+/**
+ * @brief Encode hci_write_page_scan_activity into buffer
+ * @param packet buffer for 7 bytes
+ * @param page_scan_interval
+ * @param page_scan_window
+ * @return size of command
+ * @note: format 22
+ */
+static inline uint16_t hci_cmd_encode_write_page_scan_activity(uint8_t * packet, uint16_t page_scan_interval, uint16_t page_scan_window){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x1C);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x1C) >> 8);
+    packet[2] = 4;
+    packet[3] = (uint8_t) page_scan_interval;
+    packet[4] = (uint8_t) (page_scan_interval >> 8);
+    packet[5] = (uint8_t) page_scan_window;
+    packet[6] = (uint8_t) (page_scan_window >> 8);
+    return 7;
+}
+
+/**
+ * @brief Send hci_write_page_scan_activity, same as hci_send_cmd(&hci_write_page_scan_activity, ...)
+ * @param page_scan_interval
+ * @param page_scan_window
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_page_scan_activity(uint16_t page_scan_interval, uint16_t page_scan_window){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_page_scan_activity(packet, page_scan_interval, page_scan_window));
+}
+
+/**
+ * @brief Encode hci_read_inquiry_scan_activity into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_inquiry_scan_activity(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x1D);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x1D) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_inquiry_scan_activity, same as hci_send_cmd(&hci_read_inquiry_scan_activity, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_inquiry_scan_activity(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_inquiry_scan_activity(packet));
+}
+
+/**
+ * @brief Encode hci_write_inquiry_scan_activity into buffer
+ * @param packet buffer for 7 bytes
+ * @param inquiry_scan_interval
+ * @param inquiry_scan_window
+ * @return size of command
+ * @note: format 22
+ */
+static inline uint16_t hci_cmd_encode_write_inquiry_scan_activity(uint8_t * packet, uint16_t inquiry_scan_interval, uint16_t inquiry_scan_window){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x1E);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x1E) >> 8);
+    packet[2] = 4;
+    packet[3] = (uint8_t) inquiry_scan_interval;
+    packet[4] = (uint8_t) (inquiry_scan_interval >> 8);
+    packet[5] = (uint8_t) inquiry_scan_window;
+    packet[6] = (uint8_t) (inquiry_scan_window >> 8);
+    return 7;
+}
+
+/**
+ * @brief Send hci_write_inquiry_scan_activity, same as hci_send_cmd(&hci_write_inquiry_scan_activity, ...)
+ * @param inquiry_scan_interval
+ * @param inquiry_scan_window
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_inquiry_scan_activity(uint16_t inquiry_scan_interval, uint16_t inquiry_scan_window){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_inquiry_scan_activity(packet, inquiry_scan_interval, inquiry_scan_window));
+}
+
+/**
+ * @brief Encode hci_write_authentication_enable into buffer
+ * @param packet buffer for 4 bytes
+ * @param authentication_enable
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_authentication_enable(uint8_t * packet, uint8_t authentication_enable){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x20);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x20) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) authentication_enable;
+    return 4;
+}
+
+/**
+ * @brief Send hci_write_authentication_enable, same as hci_send_cmd(&hci_write_authentication_enable, ...)
+ * @param authentication_enable
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_authentication_enable(uint8_t authentication_enable){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_authentication_enable(packet, authentication_enable));
+}
+
+/**
+ * @brief Encode hci_write_class_of_device into buffer
+ * @param packet buffer for 6 bytes
+ * @param class_of_device
+ * @return size of command
+ * @note: format 3
+ */
+static inline uint16_t hci_cmd_encode_write_class_of_device(uint8_t * packet, uint32_t class_of_device){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x24);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x24) >> 8);
+    packet[2] = 3;
+    packet[3] = (uint8_t) class_of_device;
+    packet[4] = (uint8_t) (class_of_device >> 8);
+    packet[5] = (uint8_t) (class_of_device >> 16);
+    return 6;
+}
+
+/**
+ * @brief Send hci_write_class_of_device, same as hci_send_cmd(&hci_write_class_of_device, ...)
+ * @param class_of_device
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_class_of_device(uint32_t class_of_device){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_class_of_device(packet, class_of_device));
+}
+
+/**
+ * @brief Encode hci_read_num_broadcast_retransmissions into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_num_broadcast_retransmissions(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x29);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x29) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_num_broadcast_retransmissions, same as hci_send_cmd(&hci_read_num_broadcast_retransmissions, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_num_broadcast_retransmissions(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_num_broadcast_retransmissions(packet));
+}
+
+/**
+ * @brief Encode hci_write_num_broadcast_retransmissions into buffer
+ * @param packet buffer for 4 bytes
+ * @param num_broadcast_retransmissions
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_num_broadcast_retransmissions(uint8_t * packet, uint8_t num_broadcast_retransmissions){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x2a);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x2a) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) num_broadcast_retransmissions;
+    return 4;
+}
+
+/**
+ * @brief Send hci_write_num_broadcast_retransmissions, same as hci_send_cmd(&hci_write_num_broadcast_retransmissions, ...)
+ * @param num_broadcast_retransmissions
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_num_broadcast_retransmissions(uint8_t num_broadcast_retransmissions){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_num_broadcast_retransmissions(packet, num_broadcast_retransmissions));
+}
+
+/**
+ * @brief Encode hci_read_transmit_power_level into buffer
+ * @param packet buffer for 5 bytes
+ * @param connection_handle
+ * @param type
+ * @return size of command
+ * @note: format 11
+ */
+static inline uint16_t hci_cmd_encode_read_transmit_power_level(uint8_t * packet, uint8_t connection_handle, uint8_t type){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x2D);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x2D) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) connection_handle;
+    packet[4] = (uint8_t) type;
+    return 5;
+}
+
+/**
+ * @brief Send hci_read_transmit_power_level, same as hci_send_cmd(&hci_read_transmit_power_level, ...)
+ * @param connection_handle
+ * @param type
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_transmit_power_level(uint8_t connection_handle, uint8_t type){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_transmit_power_level(packet, connection_handle, type));
+}
+
+/**
+ * @brief Encode hci_write_synchronous_flow_control_enable into buffer
+ * @param packet buffer for 4 bytes
+ * @param synchronous_flow_control_enable
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_synchronous_flow_control_enable(uint8_t * packet, uint8_t synchronous_flow_control_enable){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x2f);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x2f) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) synchronous_flow_control_enable;
+    return 4;
+}
+
+/**
+ * @brief Send hci_write_synchronous_flow_control_enable, same as hci_send_cmd(&hci_write_synchronous_flow_control_enable, ...)
+ * @param synchronous_flow_control_enable
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_synchronous_flow_control_enable(uint8_t synchronous_flow_control_enable){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_synchronous_flow_control_enable(packet, synchronous_flow_control_enable));
+}
+
+/**
+ * @brief Encode hci_set_controller_to_host_flow_control into buffer
+ * @param packet buffer for 4 bytes
+ * @param flow_control_enable
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_set_controller_to_host_flow_control(uint8_t * packet, uint8_t flow_control_enable){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x31);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x31) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) flow_control_enable;
+    return 4;
+}
+
+/**
+ * @brief Send hci_set_controller_to_host_flow_control, same as hci_send_cmd(&hci_set_controller_to_host_flow_control, ...)
+ * @param flow_control_enable
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_set_controller_to_host_flow_control(uint8_t flow_control_enable){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_set_controller_to_host_flow_control(packet, flow_control_enable));
+}
+
+/**
+ * @brief Encode hci_host_buffer_size into buffer
+ * @param packet buffer for 10 bytes
+ * @param host_acl_data_packet_length
+ * @param host_synchronous_data_packet_length
+ * @param host_total_num_acl_data_packets
+ * @param host_total_num_synchronous_data_packets
+ * @return size of command
+ * @note: format 2122
+ */
+static inline uint16_t hci_cmd_encode_host_buffer_size(uint8_t * packet, uint16_t host_acl_data_packet_length, uint8_t host_synchronous_data_packet_length, uint16_t host_total_num_acl_data_packets, uint16_t host_total_num_synchronous_data_packets){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x33);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x33) >> 8);
+    packet[2] = 7;
+    packet[3] = (uint8_t) host_acl_data_packet_length;
+    packet[4] = (uint8_t) (host_acl_data_packet_length >> 8);
+    packet[5] = (uint8_t) host_synchronous_data_packet_length;
+    packet[6] = (uint8_t) host_total_num_acl_data_packets;
+    packet[7] = (uint8_t) (host_total_num_acl_data_packets >> 8);
+    packet[8] = (uint8_t) host_total_num_synchronous_data_packets;
+    packet[9] = (uint8_t) (host_total_num_synchronous_data_packets >> 8);
+    return 10;
+}
+
+/**
+ * @brief Send hci_host_buffer_size, same as hci_send_cmd(&hci_host_buffer_size, ...)
+ * @param host_acl_data_packet_length
+ * @param host_synchronous_data_packet_length
+ * @param host_total_num_acl_data_packets
+ * @param host_total_num_synchronous_data_packets
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_host_buffer_size(uint16_t host_acl_data_packet_length, uint8_t host_synchronous_data_packet_length, uint16_t host_total_num_acl_data_packets, uint16_t host_total_num_synchronous_data_packets){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_host_buffer_size(packet, host_acl_data_packet_length, host_synchronous_data_packet_length, host_total_num_acl_data_packets, host_total_num_synchronous_data_packets));
+}
+
+/**
+ * @brief Encode hci_host_number_of_completed_packets into buffer
+ * @param packet buffer for 8 bytes
+ * @param number_of_handles
+ * @param connection_handle
+ * @param host_num_of_completed_packets
+ * @return size of command
+ * @note: format 1H2
+ */
+static inline uint16_t hci_cmd_encode_host_number_of_completed_packets(uint8_t * packet, uint8_t number_of_handles, hci_con_handle_t connection_handle, uint16_t host_num_of_completed_packets){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x35);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x35) >> 8);
+    packet[2] = 5;
+    packet[3] = (uint8_t) number_of_handles;
+    packet[4] = (uint8_t) connection_handle;
+    packet[5] = (uint8_t) (connection_handle >> 8);
+    packet[6] = (uint8_t) host_num_of_completed_packets;
+    packet[7] = (uint8_t) (host_num_of_completed_packets >> 8);
+    return 8;
+}
+
+/**
+ * @brief Send hci_host_number_of_completed_packets, same as hci_send_cmd(&hci_host_number_of_completed_packets, ...)
+ * @param number_of_handles
+ * @param connection_handle
+ * @param host_num_of_completed_packets
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_host_number_of_completed_packets(uint8_t number_of_handles, hci_con_handle_t connection_handle, uint16_t host_num_of_completed_packets){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_host_number_of_completed_packets(packet, number_of_handles, connection_handle, host_num_of_completed_packets));
+}
+
+/**
+ * @brief Encode hci_read_link_supervision_timeout into buffer
+ * @param packet buffer for 5 bytes
+ * @param handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_read_link_supervision_timeout(uint8_t * packet, hci_con_handle_t handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x36);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x36) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_read_link_supervision_timeout, same as hci_send_cmd(&hci_read_link_supervision_timeout, ...)
+ * @param handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_link_supervision_timeout(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_link_supervision_timeout(packet, handle));
+}
+
+/**
+ * @brief Encode hci_write_link_supervision_timeout into buffer
+ * @param packet buffer for 7 bytes
+ * @param handle
+ * @param timeout
+ * @return size of command
+ * @note: format H2
+ */
+static inline uint16_t hci_cmd_encode_write_link_supervision_timeout(uint8_t * packet, hci_con_handle_t handle, uint16_t timeout){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x37);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x37) >> 8);
+    packet[2] = 4;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    packet[5] = (uint8_t) timeout;
+    packet[6] = (uint8_t) (timeout >> 8);
+    return 7;
+}
+
+/**
+ * @brief Send hci_write_link_supervision_timeout, same as hci_send_cmd(&hci_write_link_supervision_timeout, ...)
+ * @param handle
+ * @param timeout
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_link_supervision_timeout(hci_con_handle_t handle, uint16_t timeout){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_link_supervision_timeout(packet, handle, timeout));
+}
+
+/**
+ * @brief Encode hci_write_current_iac_lap_two_iacs into buffer
+ * @param packet buffer for 10 bytes
+ * @param num_current_iac
+ * @param iac_lap1
+ * @param iac_lap2
+ * @return size of command
+ * @note: format 133
+ */
+static inline uint16_t hci_cmd_encode_write_current_iac_lap_two_iacs(uint8_t * packet, uint8_t num_current_iac, uint32_t iac_lap1, uint32_t iac_lap2){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x3A);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x3A) >> 8);
+    packet[2] = 7;
+    packet[3] = (uint8_t) num_current_iac;
+    packet[4] = (uint8_t) iac_lap1;
+    packet[5] = (uint8_t) (iac_lap1 >> 8);
+    packet[6] = (uint8_t) (iac_lap1 >> 16);
+    packet[7] = (uint8_t) iac_lap2;
+    packet[8] = (uint8_t) (iac_lap2 >> 8);
+    packet[9] = (uint8_t) (iac_lap2 >> 16);
+    return 10;
+}
+
+/**
+ * @brief Send hci_write_current_iac_lap_two_iacs, same as hci_send_cmd(&hci_write_current_iac_lap_two_iacs, ...)
+ * @param num_current_iac
+ * @param iac_lap1
+ * @param iac_lap2
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_current_iac_lap_two_iacs(uint8_t num_current_iac, uint32_t iac_lap1, uint32_t iac_lap2){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_current_iac_lap_two_iacs(packet, num_current_iac, iac_lap1, iac_lap2));
+}
+
+/**
+ * @brief Encode hci_write_inquiry_mode into buffer
+ * @param packet buffer for 4 bytes
+ * @param inquiry_mode
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_inquiry_mode(uint8_t * packet, uint8_t inquiry_mode){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x45);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x45) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) inquiry_mode;
+    return 4;
+}
+
+/**
+ * @brief Send hci_write_inquiry_mode, same as hci_send_cmd(&hci_write_inquiry_mode, ...)
+ * @param inquiry_mode
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_inquiry_mode(uint8_t inquiry_mode){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_inquiry_mode(packet, inquiry_mode));
+}
+
+/**
+ * @brief Encode hci_write_extended_inquiry_response into buffer
+ * @param packet buffer for 244 bytes
+ * @param fec_required
+ * @param exstended_inquiry_response
+ * @return size of command
+ * @note: format 1E
+ */
+static inline uint16_t hci_cmd_encode_write_extended_inquiry_response(uint8_t * packet, uint8_t fec_required, const uint8_t * exstended_inquiry_response){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x52);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x52) >> 8);
+    packet[2] = 241;
+    packet[3] = (uint8_t) fec_required;
+    (void)memcpy(&packet[4], exstended_inquiry_response, 240);
+    return 244;
+}
+
+/**
+ * @brief Send hci_write_extended_inquiry_response, same as hci_send_cmd(&hci_write_extended_inquiry_response, ...)
+ * @param fec_required
+ * @param exstended_inquiry_response
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_extended_inquiry_response(uint8_t fec_required, const uint8_t * exstended_inquiry_response){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_extended_inquiry_response(packet, fec_required, exstended_inquiry_response));
+}
+
+/**
+ * @brief Encode hci_write_simple_pairing_mode into buffer
+ * @param packet buffer for 4 bytes
+ * @param mode
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_simple_pairing_mode(uint8_t * packet, uint8_t mode){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x56);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x56) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) mode;
+    return 4;
+}
+
+/**
+ * @brief Send hci_write_simple_pairing_mode, same as hci_send_cmd(&hci_write_simple_pairing_mode, ...)
+ * @param mode
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_simple_pairing_mode(uint8_t mode){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_simple_pairing_mode(packet, mode));
+}
+
+/**
+ * @brief Encode hci_read_local_oob_data into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_local_oob_data(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x57);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x57) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_local_oob_data, same as hci_send_cmd(&hci_read_local_oob_data, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_local_oob_data(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_local_oob_data(packet));
+}
+
+/**
+ * @brief Encode hci_write_default_erroneous_data_reporting into buffer
+ * @param packet buffer for 4 bytes
+ * @param mode
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_default_erroneous_data_reporting(uint8_t * packet, uint8_t mode){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x5B);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x5B) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) mode;
+    return 4;
+}
+
+/**
+ * @brief Send hci_write_default_erroneous_data_reporting, same as hci_send_cmd(&hci_write_default_erroneous_data_reporting, ...)
+ * @param mode
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_default_erroneous_data_reporting(uint8_t mode){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_default_erroneous_data_reporting(packet, mode));
+}
+
+/**
+ * @brief Encode hci_read_le_host_supported into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_le_host_supported(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x6c);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x6c) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_le_host_supported, same as hci_send_cmd(&hci_read_le_host_supported, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_le_host_supported(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_le_host_supported(packet));
+}
+
+/**
+ * @brief Encode hci_write_le_host_supported into buffer
+ * @param packet buffer for 5 bytes
+ * @param le_supported_host
+ * @param simultaneous_le_host
+ * @return size of command
+ * @note: format 11
+ */
+static inline uint16_t hci_cmd_encode_write_le_host_supported(uint8_t * packet, uint8_t le_supported_host, uint8_t simultaneous_le_host){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x6d);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x6d) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) le_supported_host;
+    packet[4] = (uint8_t) simultaneous_le_host;
+    return 5;
+}
+
+/**
+ * @brief Send hci_write_le_host_supported, same as hci_send_cmd(&hci_write_le_host_supported, ...)
+ * @param le_supported_host
+ * @param simultaneous_le_host
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_le_host_supported(uint8_t le_supported_host, uint8_t simultaneous_le_host){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_le_host_supported(packet, le_supported_host, simultaneous_le_host));
+}
+
+/**
+ * @brief Encode hci_write_secure_connections_host_support into buffer
+ * @param packet buffer for 4 bytes
+ * @param secure_connections_host_support
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_secure_connections_host_support(uint8_t * packet, uint8_t secure_connections_host_support){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x7a);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x7a) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) secure_connections_host_support;
+    return 4;
+}
+
+/**
+ * @brief Send hci_write_secure_connections_host_support, same as hci_send_cmd(&hci_write_secure_connections_host_support, ...)
+ * @param secure_connections_host_support
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_secure_connections_host_support(uint8_t secure_connections_host_support){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_secure_connections_host_support(packet, secure_connections_host_support));
+}
+
+/**
+ * @brief Encode hci_read_local_extended_ob_data into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_local_extended_ob_data(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x7d);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_CONTROLLER_BASEBAND, 0x7d) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_local_extended_ob_data, same as hci_send_cmd(&hci_read_local_extended_ob_data, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_local_extended_ob_data(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_local_extended_ob_data(packet));
+}
+
+/**
+ * @brief Encode hci_read_loopback_mode into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_loopback_mode(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x01);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x01) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_loopback_mode, same as hci_send_cmd(&hci_read_loopback_mode, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_loopback_mode(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_loopback_mode(packet));
+}
+
+/**
+ * @brief Encode hci_write_loopback_mode into buffer
+ * @param packet buffer for 4 bytes
+ * @param loopback_mode
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_loopback_mode(uint8_t * packet, uint8_t loopback_mode){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x02);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x02) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) loopback_mode;
+    return 4;
+}
+
+/**
+ * @brief Send hci_write_loopback_mode, same as hci_send_cmd(&hci_write_loopback_mode, ...)
+ * @param loopback_mode
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_loopback_mode(uint8_t loopback_mode){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_loopback_mode(packet, loopback_mode));
+}
+
+/**
+ * @brief Encode hci_enable_device_under_test_mode into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_enable_device_under_test_mode(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x03);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x03) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_enable_device_under_test_mode, same as hci_send_cmd(&hci_enable_device_under_test_mode, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_enable_device_under_test_mode(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_enable_device_under_test_mode(packet));
+}
+
+/**
+ * @brief Encode hci_write_simple_pairing_debug_mode into buffer
+ * @param packet buffer for 4 bytes
+ * @param simple_pairing_debug_mode
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_write_simple_pairing_debug_mode(uint8_t * packet, uint8_t simple_pairing_debug_mode){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x04);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x04) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) simple_pairing_debug_mode;
+    return 4;
+}
+
+/**
+ * @brief Send hci_write_simple_pairing_debug_mode, same as hci_send_cmd(&hci_write_simple_pairing_debug_mode, ...)
+ * @param simple_pairing_debug_mode
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_simple_pairing_debug_mode(uint8_t simple_pairing_debug_mode){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_simple_pairing_debug_mode(packet, simple_pairing_debug_mode));
+}
+
+/**
+ * @brief Encode hci_write_secure_connections_test_mode into buffer
+ * @param packet buffer for 7 bytes
+ * @param handle
+ * @param dm1_acl_u_mode
+ * @param esco_loopback_mode
+ * @return size of command
+ * @note: format H11
+ */
+static inline uint16_t hci_cmd_encode_write_secure_connections_test_mode(uint8_t * packet, hci_con_handle_t handle, uint8_t dm1_acl_u_mode, uint8_t esco_loopback_mode){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x0a);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_TESTING, 0x0a) >> 8);
+    packet[2] = 4;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    packet[5] = (uint8_t) dm1_acl_u_mode;
+    packet[6] = (uint8_t) esco_loopback_mode;
+    return 7;
+}
+
+/**
+ * @brief Send hci_write_secure_connections_test_mode, same as hci_send_cmd(&hci_write_secure_connections_test_mode, ...)
+ * @param handle
+ * @param dm1_acl_u_mode
+ * @param esco_loopback_mode
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_write_secure_connections_test_mode(hci_con_handle_t handle, uint8_t dm1_acl_u_mode, uint8_t esco_loopback_mode){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_write_secure_connections_test_mode(packet, handle, dm1_acl_u_mode, esco_loopback_mode));
+}
+
+/**
+ * @brief Encode hci_read_local_version_information into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_local_version_information(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x01);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x01) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_local_version_information, same as hci_send_cmd(&hci_read_local_version_information, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_local_version_information(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_local_version_information(packet));
+}
+
+/**
+ * @brief Encode hci_read_local_supported_commands into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_local_supported_commands(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x02);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x02) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_local_supported_commands, same as hci_send_cmd(&hci_read_local_supported_commands, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_local_supported_commands(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_local_supported_commands(packet));
+}
+
+/**
+ * @brief Encode hci_read_local_supported_features into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_local_supported_features(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x03);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x03) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_local_supported_features, same as hci_send_cmd(&hci_read_local_supported_features, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_local_supported_features(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_local_supported_features(packet));
+}
+
+/**
+ * @brief Encode hci_read_buffer_size into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_buffer_size(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x05);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x05) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_buffer_size, same as hci_send_cmd(&hci_read_buffer_size, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_buffer_size(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_buffer_size(packet));
+}
+
+/**
+ * @brief Encode hci_read_bd_addr into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_read_bd_addr(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x09);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_INFORMATIONAL_PARAMETERS, 0x09) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_read_bd_addr, same as hci_send_cmd(&hci_read_bd_addr, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_bd_addr(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_bd_addr(packet));
+}
+
+/**
+ * @brief Encode hci_read_rssi into buffer
+ * @param packet buffer for 5 bytes
+ * @param handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_read_rssi(uint8_t * packet, hci_con_handle_t handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_STATUS_PARAMETERS, 0x05);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_STATUS_PARAMETERS, 0x05) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_read_rssi, same as hci_send_cmd(&hci_read_rssi, ...)
+ * @param handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_rssi(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_rssi(packet, handle));
+}
+
+/**
+ * @brief Encode hci_read_encryption_key_size into buffer
+ * @param packet buffer for 5 bytes
+ * @param handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_read_encryption_key_size(uint8_t * packet, hci_con_handle_t handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_STATUS_PARAMETERS, 0x08);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_STATUS_PARAMETERS, 0x08) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) handle;
+    packet[4] = (uint8_t) (handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_read_encryption_key_size, same as hci_send_cmd(&hci_read_encryption_key_size, ...)
+ * @param handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_read_encryption_key_size(hci_con_handle_t handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_read_encryption_key_size(packet, handle));
+}
+
+/**
+ * @brief Encode hci_le_set_event_mask into buffer
+ * @param packet buffer for 11 bytes
+ * @param event_mask_lower_octets
+ * @param event_mask_higher_octets
+ * @return size of command
+ * @note: format 44
+ */
+static inline uint16_t hci_cmd_encode_le_set_event_mask(uint8_t * packet, uint32_t event_mask_lower_octets, uint32_t event_mask_higher_octets){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x01);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x01) >> 8);
+    packet[2] = 8;
+    packet[3] = (uint8_t) event_mask_lower_octets;
+    packet[4] = (uint8_t) (event_mask_lower_octets >> 8);
+    packet[5] = (uint8_t) (event_mask_lower_octets >> 16);
+    packet[6] = (uint8_t) (event_mask_lower_octets >> 24);
+    packet[7] = (uint8_t) event_mask_higher_octets;
+    packet[8] = (uint8_t) (event_mask_higher_octets >> 8);
+    packet[9] = (uint8_t) (event_mask_higher_octets >> 16);
+    packet[10] = (uint8_t) (event_mask_higher_octets >> 24);
+    return 11;
+}
+
+/**
+ * @brief Send hci_le_set_event_mask, same as hci_send_cmd(&hci_le_set_event_mask, ...)
+ * @param event_mask_lower_octets
+ * @param event_mask_higher_octets
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_set_event_mask(uint32_t event_mask_lower_octets, uint32_t event_mask_higher_octets){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_set_event_mask(packet, event_mask_lower_octets, event_mask_higher_octets));
+}
+
+/**
+ * @brief Encode hci_le_read_buffer_size into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_le_read_buffer_size(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x02);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x02) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_le_read_buffer_size, same as hci_send_cmd(&hci_le_read_buffer_size, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_read_buffer_size(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_read_buffer_size(packet));
+}
+
+/**
+ * @brief Encode hci_le_read_supported_features into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_le_read_supported_features(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x03);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x03) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_le_read_supported_features, same as hci_send_cmd(&hci_le_read_supported_features, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_read_supported_features(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_read_supported_features(packet));
+}
+
+/**
+ * @brief Encode hci_le_set_random_address into buffer
+ * @param packet buffer for 9 bytes
+ * @param random_bd_addr
+ * @return size of command
+ * @note: format B
+ */
+static inline uint16_t hci_cmd_encode_le_set_random_address(uint8_t * packet, const bd_addr_t random_bd_addr){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x05);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x05) >> 8);
+    packet[2] = 6;
+    reverse_bd_addr(random_bd_addr, &packet[3]);
+    return 9;
+}
+
+/**
+ * @brief Send hci_le_set_random_address, same as hci_send_cmd(&hci_le_set_random_address, ...)
+ * @param random_bd_addr
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_set_random_address(const bd_addr_t random_bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_set_random_address(packet, random_bd_addr));
+}
+
+/**
+ * @brief Encode hci_le_set_advertising_parameters into buffer
+ * @param packet buffer for 18 bytes
+ * @param advertising_interval_min
+ * @param advertising_interval_max
+ * @param advertising_type
+ * @param own_address_type
+ * @param direct_address_type
+ * @param direct_address
+ * @param advertising_channel_map
+ * @param advertising_filter_policy
+ * @return size of command
+ * @note: format 22111B11
+ */
+static inline uint16_t hci_cmd_encode_le_set_advertising_parameters(uint8_t * packet, uint16_t advertising_interval_min, uint16_t advertising_interval_max, uint8_t advertising_type, uint8_t own_address_type, uint8_t direct_address_type, const bd_addr_t direct_address, uint8_t advertising_channel_map, uint8_t advertising_filter_policy){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x06);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x06) >> 8);
+    packet[2] = 15;
+    packet[3] = (uint8_t) advertising_interval_min;
+    packet[4] = (uint8_t) (advertising_interval_min >> 8);
+    packet[5] = (uint8_t) advertising_interval_max;
+    packet[6] = (uint8_t) (advertising_interval_max >> 8);
+    packet[7] = (uint8_t) advertising_type;
+    packet[8] = (uint8_t) own_address_type;
+    packet[9] = (uint8_t) direct_address_type;
+    reverse_bd_addr(direct_address, &packet[10]);
+    packet[16] = (uint8_t) advertising_channel_map;
+    packet[17] = (uint8_t) advertising_filter_policy;
+    return 18;
+}
+
+/**
+ * @brief Send hci_le_set_advertising_parameters, same as hci_send_cmd(&hci_le_set_advertising_parameters, ...)
+ * @param advertising_interval_min
+ * @param advertising_interval_max
+ * @param advertising_type
+ * @param own_address_type
+ * @param direct_address_type
+ * @param direct_address
+ * @param advertising_channel_map
+ * @param advertising_filter_policy
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_set_advertising_parameters(uint16_t advertising_interval_min, uint16_t advertising_interval_max, uint8_t advertising_type, uint8_t own_address_type, uint8_t direct_address_type, const bd_addr_t direct_address, uint8_t advertising_channel_map, uint8_t advertising_filter_policy){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_set_advertising_parameters(packet, advertising_interval_min, advertising_interval_max, advertising_type, own_address_type, direct_address_type, direct_address, advertising_channel_map, advertising_filter_policy));
+}
+
+/**
+ * @brief Encode hci_le_read_advertising_channel_tx_power into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_le_read_advertising_channel_tx_power(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x07);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x07) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_le_read_advertising_channel_tx_power, same as hci_send_cmd(&hci_le_read_advertising_channel_tx_power, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_read_advertising_channel_tx_power(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_read_advertising_channel_tx_power(packet));
+}
+
+/**
+ * @brief Encode hci_le_set_advertising_data into buffer
+ * @param packet buffer for 35 bytes
+ * @param advertising_data_length
+ * @param advertising_data
+ * @return size of command
+ * @note: format 1A
+ */
+static inline uint16_t hci_cmd_encode_le_set_advertising_data(uint8_t * packet, uint8_t advertising_data_length, const uint8_t * advertising_data){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x08);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x08) >> 8);
+    packet[2] = 32;
+    packet[3] = (uint8_t) advertising_data_length;
+    (void)memcpy(&packet[4], advertising_data, 31);
+    return 35;
+}
+
+/**
+ * @brief Send hci_le_set_advertising_data, same as hci_send_cmd(&hci_le_set_advertising_data, ...)
+ * @param advertising_data_length
+ * @param advertising_data
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_set_advertising_data(uint8_t advertising_data_length, const uint8_t * advertising_data){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_set_advertising_data(packet, advertising_data_length, advertising_data));
+}
+
+/**
+ * @brief Encode hci_le_set_scan_response_data into buffer
+ * @param packet buffer for 35 bytes
+ * @param scan_response_data_length
+ * @param scan_response_data
+ * @return size of command
+ * @note: format 1A
+ */
+static inline uint16_t hci_cmd_encode_le_set_scan_response_data(uint8_t * packet, uint8_t scan_response_data_length, const uint8_t * scan_response_data){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x09);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x09) >> 8);
+    packet[2] = 32;
+    packet[3] = (uint8_t) scan_response_data_length;
+    (void)memcpy(&packet[4], scan_response_data, 31);
+    return 35;
+}
+
+/**
+ * @brief Send hci_le_set_scan_response_data, same as hci_send_cmd(&hci_le_set_scan_response_data, ...)
+ * @param scan_response_data_length
+ * @param scan_response_data
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_set_scan_response_data(uint8_t scan_response_data_length, const uint8_t * scan_response_data){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_set_scan_response_data(packet, scan_response_data_length, scan_response_data));
+}
+
+/**
+ * @brief Encode hci_le_set_advertise_enable into buffer
+ * @param packet buffer for 4 bytes
+ * @param advertise_enable
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_le_set_advertise_enable(uint8_t * packet, uint8_t advertise_enable){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0a);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0a) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) advertise_enable;
+    return 4;
+}
+
+/**
+ * @brief Send hci_le_set_advertise_enable, same as hci_send_cmd(&hci_le_set_advertise_enable, ...)
+ * @param advertise_enable
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_set_advertise_enable(uint8_t advertise_enable){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_set_advertise_enable(packet, advertise_enable));
+}
+
+/**
+ * @brief Encode hci_le_set_scan_parameters into buffer
+ * @param packet buffer for 10 bytes
+ * @param le_scan_type
+ * @param le_scan_interval
+ * @param le_scan_window
+ * @param own_address_type
+ * @param scanning_filter_policy
+ * @return size of command
+ * @note: format 12211
+ */
+static inline uint16_t hci_cmd_encode_le_set_scan_parameters(uint8_t * packet, uint8_t le_scan_type, uint16_t le_scan_interval, uint16_t le_scan_window, uint8_t own_address_type, uint8_t scanning_filter_policy){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0b);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0b) >> 8);
+    packet[2] = 7;
+    packet[3] = (uint8_t) le_scan_type;
+    packet[4] = (uint8_t) le_scan_interval;
+    packet[5] = (uint8_t) (le_scan_interval >> 8);
+    packet[6] = (uint8_t) le_scan_window;
+    packet[7] = (uint8_t) (le_scan_window >> 8);
+    packet[8] = (uint8_t) own_address_type;
+    packet[9] = (uint8_t) scanning_filter_policy;
+    return 10;
+}
+
+/**
+ * @brief Send hci_le_set_scan_parameters, same as hci_send_cmd(&hci_le_set_scan_parameters, ...)
+ * @param le_scan_type
+ * @param le_scan_interval
+ * @param le_scan_window
+ * @param own_address_type
+ * @param scanning_filter_policy
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_set_scan_parameters(uint8_t le_scan_type, uint16_t le_scan_interval, uint16_t le_scan_window, uint8_t own_address_type, uint8_t scanning_filter_policy){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_set_scan_parameters(packet, le_scan_type, le_scan_interval, le_scan_window, own_address_type, scanning_filter_policy));
+}
+
+/**
+ * @brief Encode hci_le_set_scan_enable into buffer
+ * @param packet buffer for 5 bytes
+ * @param le_scan_enable
+ * @param filter_duplices
+ * @return size of command
+ * @note: format 11
+ */
+static inline uint16_t hci_cmd_encode_le_set_scan_enable(uint8_t * packet, uint8_t le_scan_enable, uint8_t filter_duplices){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0c);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0c) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) le_scan_enable;
+    packet[4] = (uint8_t) filter_duplices;
+    return 5;
+}
+
+/**
+ * @brief Send hci_le_set_scan_enable, same as hci_send_cmd(&hci_le_set_scan_enable, ...)
+ * @param le_scan_enable
+ * @param filter_duplices
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_set_scan_enable(uint8_t le_scan_enable, uint8_t filter_duplices){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_set_scan_enable(packet, le_scan_enable, filter_duplices));
+}
+
+/**
+ * @brief Encode hci_le_create_connection into buffer
+ * @param packet buffer for 28 bytes
+ * @param le_scan_interval
+ * @param le_scan_window
+ * @param initiator_filter_policy
+ * @param peer_address_type
+ * @param peer_address
+ * @param own_address_type
+ * @param conn_interval_min
+ * @param conn_interval_max
+ * @param conn_latency
+ * @param supervision_timeout
+ * @param minimum_ce_length
+ * @param maximum_ce_length
+ * @return size of command
+ * @note: format 2211B1222222
+ */
+static inline uint16_t hci_cmd_encode_le_create_connection(uint8_t * packet, uint16_t le_scan_interval, uint16_t le_scan_window, uint8_t initiator_filter_policy, uint8_t peer_address_type, const bd_addr_t peer_address, uint8_t own_address_type, uint16_t conn_interval_min, uint16_t conn_interval_max, uint16_t conn_latency, uint16_t supervision_timeout, uint16_t minimum_ce_length, uint16_t maximum_ce_length){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0d);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0d) >> 8);
+    packet[2] = 25;
+    packet[3] = (uint8_t) le_scan_interval;
+    packet[4] = (uint8_t) (le_scan_interval >> 8);
+    packet[5] = (uint8_t) le_scan_window;
+    packet[6] = (uint8_t) (le_scan_window >> 8);
+    packet[7] = (uint8_t) initiator_filter_policy;
+    packet[8] = (uint8_t) peer_address_type;
+    reverse_bd_addr(peer_address, &packet[9]);
+    packet[15] = (uint8_t) own_address_type;
+    packet[16] = (uint8_t) conn_interval_min;
+    packet[17] = (uint8_t) (conn_interval_min >> 8);
+    packet[18] = (uint8_t) conn_interval_max;
+    packet[19] = (uint8_t) (conn_interval_max >> 8);
+    packet[20] = (uint8_t) conn_latency;
+    packet[21] = (uint8_t) (conn_latency >> 8);
+    packet[22] = (uint8_t) supervision_timeout;
+    packet[23] = (uint8_t) (supervision_timeout >> 8);
+    packet[24] = (uint8_t) minimum_ce_length;
+    packet[25] = (uint8_t) (minimum_ce_length >> 8);
+    packet[26] = (uint8_t) maximum_ce_length;
+    packet[27] = (uint8_t) (maximum_ce_length >> 8);
+    return 28;
+}
+
+/**
+ * @brief Send hci_le_create_connection, same as hci_send_cmd(&hci_le_create_connection, ...)
+ * @param le_scan_interval
+ * @param le_scan_window
+ * @param initiator_filter_policy
+ * @param peer_address_type
+ * @param peer_address
+ * @param own_address_type
+ * @param conn_interval_min
+ * @param conn_interval_max
+ * @param conn_latency
+ * @param supervision_timeout
+ * @param minimum_ce_length
+ * @param maximum_ce_length
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_create_connection(uint16_t le_scan_interval, uint16_t le_scan_window, uint8_t initiator_filter_policy, uint8_t peer_address_type, const bd_addr_t peer_address, uint8_t own_address_type, uint16_t conn_interval_min, uint16_t conn_interval_max, uint16_t conn_latency, uint16_t supervision_timeout, uint16_t minimum_ce_length, uint16_t maximum_ce_length){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_create_connection(packet, le_scan_interval, le_scan_window, initiator_filter_policy, peer_address_type, peer_address, own_address_type, conn_interval_min, conn_interval_max, conn_latency, supervision_timeout, minimum_ce_length, maximum_ce_length));
+}
+
+/**
+ * @brief Encode hci_le_create_connection_cancel into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_le_create_connection_cancel(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0e);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0e) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_le_create_connection_cancel, same as hci_send_cmd(&hci_le_create_connection_cancel, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_create_connection_cancel(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_create_connection_cancel(packet));
+}
+
+/**
+ * @brief Encode hci_le_read_white_list_size into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_le_read_white_list_size(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0f);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x0f) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_le_read_white_list_size, same as hci_send_cmd(&hci_le_read_white_list_size, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_read_white_list_size(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_read_white_list_size(packet));
+}
+
+/**
+ * @brief Encode hci_le_clear_white_list into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_le_clear_white_list(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x10);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x10) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_le_clear_white_list, same as hci_send_cmd(&hci_le_clear_white_list, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_clear_white_list(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_clear_white_list(packet));
+}
+
+/**
+ * @brief Encode hci_le_add_device_to_white_list into buffer
+ * @param packet buffer for 10 bytes
+ * @param address_type
+ * @param bd_addr
+ * @return size of command
+ * @note: format 1B
+ */
+static inline uint16_t hci_cmd_encode_le_add_device_to_white_list(uint8_t * packet, uint8_t address_type, const bd_addr_t bd_addr){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x11);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x11) >> 8);
+    packet[2] = 7;
+    packet[3] = (uint8_t) address_type;
+    reverse_bd_addr(bd_addr, &packet[4]);
+    return 10;
+}
+
+/**
+ * @brief Send hci_le_add_device_to_white_list, same as hci_send_cmd(&hci_le_add_device_to_white_list, ...)
+ * @param address_type
+ * @param bd_addr
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_add_device_to_white_list(uint8_t address_type, const bd_addr_t bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_add_device_to_white_list(packet, address_type, bd_addr));
+}
+
+/**
+ * @brief Encode hci_le_remove_device_from_white_list into buffer
+ * @param packet buffer for 10 bytes
+ * @param address_type
+ * @param bd_addr
+ * @return size of command
+ * @note: format 1B
+ */
+static inline uint16_t hci_cmd_encode_le_remove_device_from_white_list(uint8_t * packet, uint8_t address_type, const bd_addr_t bd_addr){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x12);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x12) >> 8);
+    packet[2] = 7;
+    packet[3] = (uint8_t) address_type;
+    reverse_bd_addr(bd_addr, &packet[4]);
+    return 10;
+}
+
+/**
+ * @brief Send hci_le_remove_device_from_white_list, same as hci_send_cmd(&hci_le_remove_device_from_white_list, ...)
+ * @param address_type
+ * @param bd_addr
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_remove_device_from_white_list(uint8_t address_type, const bd_addr_t bd_addr){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_remove_device_from_white_list(packet, address_type, bd_addr));
+}
+
+/**
+ * @brief Encode hci_le_connection_update into buffer
+ * @param packet buffer for 17 bytes
+ * @param conn_handle
+ * @param conn_interval_min
+ * @param conn_interval_max
+ * @param conn_latency
+ * @param supervision_timeout
+ * @param minimum_ce_length
+ * @param maximum_ce_length
+ * @return size of command
+ * @note: format H222222
+ */
+static inline uint16_t hci_cmd_encode_le_connection_update(uint8_t * packet, hci_con_handle_t conn_handle, uint16_t conn_interval_min, uint16_t conn_interval_max, uint16_t conn_latency, uint16_t supervision_timeout, uint16_t minimum_ce_length, uint16_t maximum_ce_length){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x13);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x13) >> 8);
+    packet[2] = 14;
+    packet[3] = (uint8_t) conn_handle;
+    packet[4] = (uint8_t) (conn_handle >> 8);
+    packet[5] = (uint8_t) conn_interval_min;
+    packet[6] = (uint8_t) (conn_interval_min >> 8);
+    packet[7] = (uint8_t) conn_interval_max;
+    packet[8] = (uint8_t) (conn_interval_max >> 8);
+    packet[9] = (uint8_t) conn_latency;
+    packet[10] = (uint8_t) (conn_latency >> 8);
+    packet[11] = (uint8_t) supervision_timeout;
+    packet[12] = (uint8_t) (supervision_timeout >> 8);
+    packet[13] = (uint8_t) minimum_ce_length;
+    packet[14] = (uint8_t) (minimum_ce_length >> 8);
+    packet[15] = (uint8_t) maximum_ce_length;
+    packet[16] = (uint8_t) (maximum_ce_length >> 8);
+    return 17;
+}
+
+/**
+ * @brief Send hci_le_connection_update, same as hci_send_cmd(&hci_le_connection_update, ...)
+ * @param conn_handle
+ * @param conn_interval_min
+ * @param conn_interval_max
+ * @param conn_latency
+ * @param supervision_timeout
+ * @param minimum_ce_length
+ * @param maximum_ce_length
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_connection_update(hci_con_handle_t conn_handle, uint16_t conn_interval_min, uint16_t conn_interval_max, uint16_t conn_latency, uint16_t supervision_timeout, uint16_t minimum_ce_length, uint16_t maximum_ce_length){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_connection_update(packet, conn_handle, conn_interval_min, conn_interval_max, conn_latency, supervision_timeout, minimum_ce_length, maximum_ce_length));
+}
+
+/**
+ * @brief Encode hci_le_set_host_channel_classification into buffer
+ * @param packet buffer for 8 bytes
+ * @param channel_map_lower_32bits
+ * @param channel_map_higher_5bits
+ * @return size of command
+ * @note: format 41
+ */
+static inline uint16_t hci_cmd_encode_le_set_host_channel_classification(uint8_t * packet, uint32_t channel_map_lower_32bits, uint8_t channel_map_higher_5bits){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x14);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x14) >> 8);
+    packet[2] = 5;
+    packet[3] = (uint8_t) channel_map_lower_32bits;
+    packet[4] = (uint8_t) (channel_map_lower_32bits >> 8);
+    packet[5] = (uint8_t) (channel_map_lower_32bits >> 16);
+    packet[6] = (uint8_t) (channel_map_lower_32bits >> 24);
+    packet[7] = (uint8_t) channel_map_higher_5bits;
+    return 8;
+}
+
+/**
+ * @brief Send hci_le_set_host_channel_classification, same as hci_send_cmd(&hci_le_set_host_channel_classification, ...)
+ * @param channel_map_lower_32bits
+ * @param channel_map_higher_5bits
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_set_host_channel_classification(uint32_t channel_map_lower_32bits, uint8_t channel_map_higher_5bits){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_set_host_channel_classification(packet, channel_map_lower_32bits, channel_map_higher_5bits));
+}
+
+/**
+ * @brief Encode hci_le_read_channel_map into buffer
+ * @param packet buffer for 5 bytes
+ * @param conn_handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_le_read_channel_map(uint8_t * packet, hci_con_handle_t conn_handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x15);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x15) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) conn_handle;
+    packet[4] = (uint8_t) (conn_handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_le_read_channel_map, same as hci_send_cmd(&hci_le_read_channel_map, ...)
+ * @param conn_handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_read_channel_map(hci_con_handle_t conn_handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_read_channel_map(packet, conn_handle));
+}
+
+/**
+ * @brief Encode hci_le_read_remote_used_features into buffer
+ * @param packet buffer for 5 bytes
+ * @param conn_handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_le_read_remote_used_features(uint8_t * packet, hci_con_handle_t conn_handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x16);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x16) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) conn_handle;
+    packet[4] = (uint8_t) (conn_handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_le_read_remote_used_features, same as hci_send_cmd(&hci_le_read_remote_used_features, ...)
+ * @param conn_handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_read_remote_used_features(hci_con_handle_t conn_handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_read_remote_used_features(packet, conn_handle));
+}
+
+/**
+ * @brief Encode hci_le_encrypt into buffer
+ * @param packet buffer for 35 bytes
+ * @param key
+ * @param plain_text
+ * @return size of command
+ * @note: format PP
+ */
+static inline uint16_t hci_cmd_encode_le_encrypt(uint8_t * packet, const uint8_t * key, const uint8_t * plain_text){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x17);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x17) >> 8);
+    packet[2] = 32;
+    (void)memcpy(&packet[3], key, 16);
+    (void)memcpy(&packet[19], plain_text, 16);
+    return 35;
+}
+
+/**
+ * @brief Send hci_le_encrypt, same as hci_send_cmd(&hci_le_encrypt, ...)
+ * @param key
+ * @param plain_text
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_encrypt(const uint8_t * key, const uint8_t * plain_text){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_encrypt(packet, key, plain_text));
+}
+
+/**
+ * @brief Encode hci_le_rand into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_le_rand(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x18);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x18) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_le_rand, same as hci_send_cmd(&hci_le_rand, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_rand(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_rand(packet));
+}
+
+/**
+ * @brief Encode hci_le_start_encryption into buffer
+ * @param packet buffer for 31 bytes
+ * @param conn_handle
+ * @param random_number_lower_32bits
+ * @param random_number_higher_32bits
+ * @param encryption_diversifier
+ * @param long_term_key
+ * @return size of command
+ * @note: format H442P
+ */
+static inline uint16_t hci_cmd_encode_le_start_encryption(uint8_t * packet, hci_con_handle_t conn_handle, uint32_t random_number_lower_32bits, uint32_t random_number_higher_32bits, uint16_t encryption_diversifier, const uint8_t * long_term_key){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x19);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x19) >> 8);
+    packet[2] = 28;
+    packet[3] = (uint8_t) conn_handle;
+    packet[4] = (uint8_t) (conn_handle >> 8);
+    packet[5] = (uint8_t) random_number_lower_32bits;
+    packet[6] = (uint8_t) (random_number_lower_32bits >> 8);
+    packet[7] = (uint8_t) (random_number_lower_32bits >> 16);
+    packet[8] = (uint8_t) (random_number_lower_32bits >> 24);
+    packet[9] = (uint8_t) random_number_higher_32bits;
+    packet[10] = (uint8_t) (random_number_higher_32bits >> 8);
+    packet[11] = (uint8_t) (random_number_higher_32bits >> 16);
+    packet[12] = (uint8_t) (random_number_higher_32bits >> 24);
+    packet[13] = (uint8_t) encryption_diversifier;
+    packet[14] = (uint8_t) (encryption_diversifier >> 8);
+    (void)memcpy(&packet[15], long_term_key, 16);
+    return 31;
+}
+
+/**
+ * @brief Send hci_le_start_encryption, same as hci_send_cmd(&hci_le_start_encryption, ...)
+ * @param conn_handle
+ * @param random_number_lower_32bits
+ * @param random_number_higher_32bits
+ * @param encryption_diversifier
+ * @param long_term_key
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_start_encryption(hci_con_handle_t conn_handle, uint32_t random_number_lower_32bits, uint32_t random_number_higher_32bits, uint16_t encryption_diversifier, const uint8_t * long_term_key){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_start_encryption(packet, conn_handle, random_number_lower_32bits, random_number_higher_32bits, encryption_diversifier, long_term_key));
+}
+
+/**
+ * @brief Encode hci_le_long_term_key_request_reply into buffer
+ * @param packet buffer for 21 bytes
+ * @param connection_handle
+ * @param long_term_key
+ * @return size of command
+ * @note: format HP
+ */
+static inline uint16_t hci_cmd_encode_le_long_term_key_request_reply(uint8_t * packet, hci_con_handle_t connection_handle, const uint8_t * long_term_key){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1a);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1a) >> 8);
+    packet[2] = 18;
+    packet[3] = (uint8_t) connection_handle;
+    packet[4] = (uint8_t) (connection_handle >> 8);
+    (void)memcpy(&packet[5], long_term_key, 16);
+    return 21;
+}
+
+/**
+ * @brief Send hci_le_long_term_key_request_reply, same as hci_send_cmd(&hci_le_long_term_key_request_reply, ...)
+ * @param connection_handle
+ * @param long_term_key
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_long_term_key_request_reply(hci_con_handle_t connection_handle, const uint8_t * long_term_key){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_long_term_key_request_reply(packet, connection_handle, long_term_key));
+}
+
+/**
+ * @brief Encode hci_le_long_term_key_negative_reply into buffer
+ * @param packet buffer for 5 bytes
+ * @param conn_handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_le_long_term_key_negative_reply(uint8_t * packet, hci_con_handle_t conn_handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1b);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1b) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) conn_handle;
+    packet[4] = (uint8_t) (conn_handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_le_long_term_key_negative_reply, same as hci_send_cmd(&hci_le_long_term_key_negative_reply, ...)
+ * @param conn_handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_long_term_key_negative_reply(hci_con_handle_t conn_handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_long_term_key_negative_reply(packet, conn_handle));
+}
+
+/**
+ * @brief Encode hci_le_read_supported_states into buffer
+ * @param packet buffer for 5 bytes
+ * @param conn_handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_le_read_supported_states(uint8_t * packet, hci_con_handle_t conn_handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1c);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1c) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) conn_handle;
+    packet[4] = (uint8_t) (conn_handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_le_read_supported_states, same as hci_send_cmd(&hci_le_read_supported_states, ...)
+ * @param conn_handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_read_supported_states(hci_con_handle_t conn_handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_read_supported_states(packet, conn_handle));
+}
+
+/**
+ * @brief Encode hci_le_receiver_test into buffer
+ * @param packet buffer for 4 bytes
+ * @param rx_frequency
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_le_receiver_test(uint8_t * packet, uint8_t rx_frequency){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1d);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1d) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) rx_frequency;
+    return 4;
+}
+
+/**
+ * @brief Send hci_le_receiver_test, same as hci_send_cmd(&hci_le_receiver_test, ...)
+ * @param rx_frequency
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_receiver_test(uint8_t rx_frequency){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_receiver_test(packet, rx_frequency));
+}
+
+/**
+ * @brief Encode hci_le_transmitter_test into buffer
+ * @param packet buffer for 6 bytes
+ * @param tx_frequency
+ * @param test_payload_lengh
+ * @param packet_payload
+ * @return size of command
+ * @note: format 111
+ */
+static inline uint16_t hci_cmd_encode_le_transmitter_test(uint8_t * packet, uint8_t tx_frequency, uint8_t test_payload_lengh, uint8_t packet_payload){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1e);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1e) >> 8);
+    packet[2] = 3;
+    packet[3] = (uint8_t) tx_frequency;
+    packet[4] = (uint8_t) test_payload_lengh;
+    packet[5] = (uint8_t) packet_payload;
+    return 6;
+}
+
+/**
+ * @brief Send hci_le_transmitter_test, same as hci_send_cmd(&hci_le_transmitter_test, ...)
+ * @param tx_frequency
+ * @param test_payload_lengh
+ * @param packet_payload
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_transmitter_test(uint8_t tx_frequency, uint8_t test_payload_lengh, uint8_t packet_payload){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_transmitter_test(packet, tx_frequency, test_payload_lengh, packet_payload));
+}
+
+/**
+ * @brief Encode hci_le_test_end into buffer
+ * @param packet buffer for 4 bytes
+ * @param end_test_cmd
+ * @return size of command
+ * @note: format 1
+ */
+static inline uint16_t hci_cmd_encode_le_test_end(uint8_t * packet, uint8_t end_test_cmd){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1f);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x1f) >> 8);
+    packet[2] = 1;
+    packet[3] = (uint8_t) end_test_cmd;
+    return 4;
+}
+
+/**
+ * @brief Send hci_le_test_end, same as hci_send_cmd(&hci_le_test_end, ...)
+ * @param end_test_cmd
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_test_end(uint8_t end_test_cmd){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_test_end(packet, end_test_cmd));
+}
+
+/**
+ * @brief Encode hci_le_remote_connection_parameter_request_reply into buffer
+ * @param packet buffer for 17 bytes
+ * @param conn_handle
+ * @param conn_interval_min
+ * @param conn_interval_max
+ * @param conn_latency
+ * @param supervision_timeout
+ * @param minimum_ce_length
+ * @param maximum_ce_length
+ * @return size of command
+ * @note: format H222222
+ */
+static inline uint16_t hci_cmd_encode_le_remote_connection_parameter_request_reply(uint8_t * packet, hci_con_handle_t conn_handle, uint16_t conn_interval_min, uint16_t conn_interval_max, uint16_t conn_latency, uint16_t supervision_timeout, uint16_t minimum_ce_length, uint16_t maximum_ce_length){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x20);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x20) >> 8);
+    packet[2] = 14;
+    packet[3] = (uint8_t) conn_handle;
+    packet[4] = (uint8_t) (conn_handle >> 8);
+    packet[5] = (uint8_t) conn_interval_min;
+    packet[6] = (uint8_t) (conn_interval_min >> 8);
+    packet[7] = (uint8_t) conn_interval_max;
+    packet[8] = (uint8_t) (conn_interval_max >> 8);
+    packet[9] = (uint8_t) conn_latency;
+    packet[10] = (uint8_t) (conn_latency >> 8);
+    packet[11] = (uint8_t) supervision_timeout;
+    packet[12] = (uint8_t) (supervision_timeout >> 8);
+    packet[13] = (uint8_t) minimum_ce_length;
+    packet[14] = (uint8_t) (minimum_ce_length >> 8);
+    packet[15] = (uint8_t) maximum_ce_length;
+    packet[16] = (uint8_t) (maximum_ce_length >> 8);
+    return 17;
+}
+
+/**
+ * @brief Send hci_le_remote_connection_parameter_request_reply, same as hci_send_cmd(&hci_le_remote_connection_parameter_request_reply, ...)
+ * @param conn_handle
+ * @param conn_interval_min
+ * @param conn_interval_max
+ * @param conn_latency
+ * @param supervision_timeout
+ * @param minimum_ce_length
+ * @param maximum_ce_length
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_remote_connection_parameter_request_reply(hci_con_handle_t conn_handle, uint16_t conn_interval_min, uint16_t conn_interval_max, uint16_t conn_latency, uint16_t supervision_timeout, uint16_t minimum_ce_length, uint16_t maximum_ce_length){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_remote_connection_parameter_request_reply(packet, conn_handle, conn_interval_min, conn_interval_max, conn_latency, supervision_timeout, minimum_ce_length, maximum_ce_length));
+}
+
+/**
+ * @brief Encode hci_le_remote_connection_parameter_request_negative_reply into buffer
+ * @param packet buffer for 6 bytes
+ * @param con_handle
+ * @param reason
+ * @return size of command
+ * @note: format H1
+ */
+static inline uint16_t hci_cmd_encode_le_remote_connection_parameter_request_negative_reply(uint8_t * packet, hci_con_handle_t con_handle, uint8_t reason){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x21);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x21) >> 8);
+    packet[2] = 3;
+    packet[3] = (uint8_t) con_handle;
+    packet[4] = (uint8_t) (con_handle >> 8);
+    packet[5] = (uint8_t) reason;
+    return 6;
+}
+
+/**
+ * @brief Send hci_le_remote_connection_parameter_request_negative_reply, same as hci_send_cmd(&hci_le_remote_connection_parameter_request_negative_reply, ...)
+ * @param con_handle
+ * @param reason
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_remote_connection_parameter_request_negative_reply(hci_con_handle_t con_handle, uint8_t reason){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_remote_connection_parameter_request_negative_reply(packet, con_handle, reason));
+}
+
+/**
+ * @brief Encode hci_le_set_data_length into buffer
+ * @param packet buffer for 9 bytes
+ * @param con_handle
+ * @param tx_octets
+ * @param tx_time
+ * @return size of command
+ * @note: format H22
+ */
+static inline uint16_t hci_cmd_encode_le_set_data_length(uint8_t * packet, hci_con_handle_t con_handle, uint16_t tx_octets, uint16_t tx_time){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x22);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x22) >> 8);
+    packet[2] = 6;
+    packet[3] = (uint8_t) con_handle;
+    packet[4] = (uint8_t) (con_handle >> 8);
+    packet[5] = (uint8_t) tx_octets;
+    packet[6] = (uint8_t) (tx_octets >> 8);
+    packet[7] = (uint8_t) tx_time;
+    packet[8] = (uint8_t) (tx_time >> 8);
+    return 9;
+}
+
+/**
+ * @brief Send hci_le_set_data_length, same as hci_send_cmd(&hci_le_set_data_length, ...)
+ * @param con_handle
+ * @param tx_octets
+ * @param tx_time
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_set_data_length(hci_con_handle_t con_handle, uint16_t tx_octets, uint16_t tx_time){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_set_data_length(packet, con_handle, tx_octets, tx_time));
+}
+
+/**
+ * @brief Encode hci_le_read_suggested_default_data_length into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_le_read_suggested_default_data_length(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x23);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x23) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_le_read_suggested_default_data_length, same as hci_send_cmd(&hci_le_read_suggested_default_data_length, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_read_suggested_default_data_length(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_read_suggested_default_data_length(packet));
+}
+
+/**
+ * @brief Encode hci_le_write_suggested_default_data_length into buffer
+ * @param packet buffer for 7 bytes
+ * @param suggested_max_tx_octets
+ * @param suggested_max_tx_time
+ * @return size of command
+ * @note: format 22
+ */
+static inline uint16_t hci_cmd_encode_le_write_suggested_default_data_length(uint8_t * packet, uint16_t suggested_max_tx_octets, uint16_t suggested_max_tx_time){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x24);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x24) >> 8);
+    packet[2] = 4;
+    packet[3] = (uint8_t) suggested_max_tx_octets;
+    packet[4] = (uint8_t) (suggested_max_tx_octets >> 8);
+    packet[5] = (uint8_t) suggested_max_tx_time;
+    packet[6] = (uint8_t) (suggested_max_tx_time >> 8);
+    return 7;
+}
+
+/**
+ * @brief Send hci_le_write_suggested_default_data_length, same as hci_send_cmd(&hci_le_write_suggested_default_data_length, ...)
+ * @param suggested_max_tx_octets
+ * @param suggested_max_tx_time
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_write_suggested_default_data_length(uint16_t suggested_max_tx_octets, uint16_t suggested_max_tx_time){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_write_suggested_default_data_length(packet, suggested_max_tx_octets, suggested_max_tx_time));
+}
+
+/**
+ * @brief Encode hci_le_read_local_p256_public_key into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_le_read_local_p256_public_key(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x25);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x25) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_le_read_local_p256_public_key, same as hci_send_cmd(&hci_le_read_local_p256_public_key, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_read_local_p256_public_key(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_read_local_p256_public_key(packet));
+}
+
+/**
+ * @brief Encode hci_le_generate_dhkey into buffer
+ * @param packet buffer for 67 bytes
+ * @param public_1
+ * @param private_2
+ * @return size of command
+ * @note: format QQ
+ */
+static inline uint16_t hci_cmd_encode_le_generate_dhkey(uint8_t * packet, const uint8_t * public_1, const uint8_t * private_2){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x26);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x26) >> 8);
+    packet[2] = 64;
+    reverse_bytes(public_1, &packet[3], 32);
+    reverse_bytes(private_2, &packet[35], 32);
+    return 67;
+}
+
+/**
+ * @brief Send hci_le_generate_dhkey, same as hci_send_cmd(&hci_le_generate_dhkey, ...)
+ * @param public_1
+ * @param private_2
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_generate_dhkey(const uint8_t * public_1, const uint8_t * private_2){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_generate_dhkey(packet, public_1, private_2));
+}
+
+/**
+ * @brief Encode hci_le_read_maximum_data_length into buffer
+ * @param packet buffer for 3 bytes
+ * @return size of command
+ * @note: format -
+ */
+static inline uint16_t hci_cmd_encode_le_read_maximum_data_length(uint8_t * packet){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x2F);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x2F) >> 8);
+    packet[2] = 0;
+    return 3;
+}
+
+/**
+ * @brief Send hci_le_read_maximum_data_length, same as hci_send_cmd(&hci_le_read_maximum_data_length, ...)
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_read_maximum_data_length(void){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_read_maximum_data_length(packet));
+}
+
+/**
+ * @brief Encode hci_le_read_phy into buffer
+ * @param packet buffer for 5 bytes
+ * @param con_handle
+ * @return size of command
+ * @note: format H
+ */
+static inline uint16_t hci_cmd_encode_le_read_phy(uint8_t * packet, hci_con_handle_t con_handle){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x30);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x30) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) con_handle;
+    packet[4] = (uint8_t) (con_handle >> 8);
+    return 5;
+}
+
+/**
+ * @brief Send hci_le_read_phy, same as hci_send_cmd(&hci_le_read_phy, ...)
+ * @param con_handle
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_read_phy(hci_con_handle_t con_handle){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_read_phy(packet, con_handle));
+}
+
+/**
+ * @brief Encode hci_le_set_default_phy into buffer
+ * @param packet buffer for 6 bytes
+ * @param all_phys
+ * @param tx_phys
+ * @param rx_phys
+ * @return size of command
+ * @note: format 111
+ */
+static inline uint16_t hci_cmd_encode_le_set_default_phy(uint8_t * packet, uint8_t all_phys, uint8_t tx_phys, uint8_t rx_phys){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x31);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x31) >> 8);
+    packet[2] = 3;
+    packet[3] = (uint8_t) all_phys;
+    packet[4] = (uint8_t) tx_phys;
+    packet[5] = (uint8_t) rx_phys;
+    return 6;
+}
+
+/**
+ * @brief Send hci_le_set_default_phy, same as hci_send_cmd(&hci_le_set_default_phy, ...)
+ * @param all_phys
+ * @param tx_phys
+ * @param rx_phys
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_set_default_phy(uint8_t all_phys, uint8_t tx_phys, uint8_t rx_phys){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_set_default_phy(packet, all_phys, tx_phys, rx_phys));
+}
+
+/**
+ * @brief Encode hci_le_set_phy into buffer
+ * @param packet buffer for 9 bytes
+ * @param con_handle
+ * @param all_phys
+ * @param tx_phys
+ * @param rx_phys
+ * @param phy_options
+ * @return size of command
+ * @note: format H1111
+ */
+static inline uint16_t hci_cmd_encode_le_set_phy(uint8_t * packet, hci_con_handle_t con_handle, uint8_t all_phys, uint8_t tx_phys, uint8_t rx_phys, uint8_t phy_options){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x32);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(OGF_LE_CONTROLLER, 0x32) >> 8);
+    packet[2] = 6;
+    packet[3] = (uint8_t) con_handle;
+    packet[4] = (uint8_t) (con_handle >> 8);
+    packet[5] = (uint8_t) all_phys;
+    packet[6] = (uint8_t) tx_phys;
+    packet[7] = (uint8_t) rx_phys;
+    packet[8] = (uint8_t) phy_options;
+    return 9;
+}
+
+/**
+ * @brief Send hci_le_set_phy, same as hci_send_cmd(&hci_le_set_phy, ...)
+ * @param con_handle
+ * @param all_phys
+ * @param tx_phys
+ * @param rx_phys
+ * @param phy_options
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_le_set_phy(hci_con_handle_t con_handle, uint8_t all_phys, uint8_t tx_phys, uint8_t rx_phys, uint8_t phy_options){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_le_set_phy(packet, con_handle, all_phys, tx_phys, rx_phys, phy_options));
+}
+
+/**
+ * @brief Encode hci_bcm_write_sco_pcm_int into buffer
+ * @param packet buffer for 8 bytes
+ * @param sco_routing
+ * @param pcm_interface_rate
+ * @param frame_type
+ * @param sync_mode
+ * @param clock_mode
+ * @return size of command
+ * @note: format 11111
+ */
+static inline uint16_t hci_cmd_encode_bcm_write_sco_pcm_int(uint8_t * packet, uint8_t sco_routing, uint8_t pcm_interface_rate, uint8_t frame_type, uint8_t sync_mode, uint8_t clock_mode){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(0x3f, 0x1c);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(0x3f, 0x1c) >> 8);
+    packet[2] = 5;
+    packet[3] = (uint8_t) sco_routing;
+    packet[4] = (uint8_t) pcm_interface_rate;
+    packet[5] = (uint8_t) frame_type;
+    packet[6] = (uint8_t) sync_mode;
+    packet[7] = (uint8_t) clock_mode;
+    return 8;
+}
+
+/**
+ * @brief Send hci_bcm_write_sco_pcm_int, same as hci_send_cmd(&hci_bcm_write_sco_pcm_int, ...)
+ * @param sco_routing
+ * @param pcm_interface_rate
+ * @param frame_type
+ * @param sync_mode
+ * @param clock_mode
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_bcm_write_sco_pcm_int(uint8_t sco_routing, uint8_t pcm_interface_rate, uint8_t frame_type, uint8_t sync_mode, uint8_t clock_mode){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_bcm_write_sco_pcm_int(packet, sco_routing, pcm_interface_rate, frame_type, sync_mode, clock_mode));
+}
+
+/**
+ * @brief Encode hci_bcm_set_sleep_mode into buffer
+ * @param packet buffer for 15 bytes
+ * @param sleep_mode
+ * @param idle_threshold_host
+ * @param idle_threshold_controller
+ * @param bt_wake_active_mode
+ * @param host_wake_active_mode
+ * @param allow_host_sleep_during_sco
+ * @param combine_sleep_mode_and_lpm
+ * @param enable_tristate_control_of_uart_tx_line
+ * @param active_connection_handling_on_suspend
+ * @param resume_timeout
+ * @param enable_break_to_host
+ * @param pulsed_host_wake
+ * @return size of command
+ * @note: format 111111111111
+ */
+static inline uint16_t hci_cmd_encode_bcm_set_sleep_mode(uint8_t * packet, uint8_t sleep_mode, uint8_t idle_threshold_host, uint8_t idle_threshold_controller, uint8_t bt_wake_active_mode, uint8_t host_wake_active_mode, uint8_t allow_host_sleep_during_sco, uint8_t combine_sleep_mode_and_lpm, uint8_t enable_tristate_control_of_uart_tx_line, uint8_t active_connection_handling_on_suspend, uint8_t resume_timeout, uint8_t enable_break_to_host, uint8_t pulsed_host_wake){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(0x3f, 0x0027);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(0x3f, 0x0027) >> 8);
+    packet[2] = 12;
+    packet[3] = (uint8_t) sleep_mode;
+    packet[4] = (uint8_t) idle_threshold_host;
+    packet[5] = (uint8_t) idle_threshold_controller;
+    packet[6] = (uint8_t) bt_wake_active_mode;
+    packet[7] = (uint8_t) host_wake_active_mode;
+    packet[8] = (uint8_t) allow_host_sleep_during_sco;
+    packet[9] = (uint8_t) combine_sleep_mode_and_lpm;
+    packet[10] = (uint8_t) enable_tristate_control_of_uart_tx_line;
+    packet[11] = (uint8_t) active_connection_handling_on_suspend;
+    packet[12] = (uint8_t) resume_timeout;
+    packet[13] = (uint8_t) enable_break_to_host;
+    packet[14] = (uint8_t) pulsed_host_wake;
+    return 15;
+}
+
+/**
+ * @brief Send hci_bcm_set_sleep_mode, same as hci_send_cmd(&hci_bcm_set_sleep_mode, ...)
+ * @param sleep_mode
+ * @param idle_threshold_host
+ * @param idle_threshold_controller
+ * @param bt_wake_active_mode
+ * @param host_wake_active_mode
+ * @param allow_host_sleep_during_sco
+ * @param combine_sleep_mode_and_lpm
+ * @param enable_tristate_control_of_uart_tx_line
+ * @param active_connection_handling_on_suspend
+ * @param resume_timeout
+ * @param enable_break_to_host
+ * @param pulsed_host_wake
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_bcm_set_sleep_mode(uint8_t sleep_mode, uint8_t idle_threshold_host, uint8_t idle_threshold_controller, uint8_t bt_wake_active_mode, uint8_t host_wake_active_mode, uint8_t allow_host_sleep_during_sco, uint8_t combine_sleep_mode_and_lpm, uint8_t enable_tristate_control_of_uart_tx_line, uint8_t active_connection_handling_on_suspend, uint8_t resume_timeout, uint8_t enable_break_to_host, uint8_t pulsed_host_wake){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_bcm_set_sleep_mode(packet, sleep_mode, idle_threshold_host, idle_threshold_controller, bt_wake_active_mode, host_wake_active_mode, allow_host_sleep_during_sco, combine_sleep_mode_and_lpm, enable_tristate_control_of_uart_tx_line, active_connection_handling_on_suspend, resume_timeout, enable_break_to_host, pulsed_host_wake));
+}
+
+/**
+ * @brief Encode hci_bcm_write_tx_power_table into buffer
+ * @param packet buffer for 5 bytes
+ * @param is_le
+ * @param chip_max_tx_pwr_db
+ * @return size of command
+ * @note: format 11
+ */
+static inline uint16_t hci_cmd_encode_bcm_write_tx_power_table(uint8_t * packet, uint8_t is_le, uint8_t chip_max_tx_pwr_db){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(0x3f, 0x1C9);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(0x3f, 0x1C9) >> 8);
+    packet[2] = 2;
+    packet[3] = (uint8_t) is_le;
+    packet[4] = (uint8_t) chip_max_tx_pwr_db;
+    return 5;
+}
+
+/**
+ * @brief Send hci_bcm_write_tx_power_table, same as hci_send_cmd(&hci_bcm_write_tx_power_table, ...)
+ * @param is_le
+ * @param chip_max_tx_pwr_db
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_bcm_write_tx_power_table(uint8_t is_le, uint8_t chip_max_tx_pwr_db){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_bcm_write_tx_power_table(packet, is_le, chip_max_tx_pwr_db));
+}
+
+/**
+ * @brief Encode hci_bcm_set_tx_pwr into buffer
+ * @param packet buffer for 7 bytes
+ * @param arg1
+ * @param arg2
+ * @param arg3
+ * @return size of command
+ * @note: format 11H
+ */
+static inline uint16_t hci_cmd_encode_bcm_set_tx_pwr(uint8_t * packet, uint8_t arg1, uint8_t arg2, hci_con_handle_t arg3){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(0x3f, 0x1A5);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(0x3f, 0x1A5) >> 8);
+    packet[2] = 4;
+    packet[3] = (uint8_t) arg1;
+    packet[4] = (uint8_t) arg2;
+    packet[5] = (uint8_t) arg3;
+    packet[6] = (uint8_t) (arg3 >> 8);
+    return 7;
+}
+
+/**
+ * @brief Send hci_bcm_set_tx_pwr, same as hci_send_cmd(&hci_bcm_set_tx_pwr, ...)
+ * @param arg1
+ * @param arg2
+ * @param arg3
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_bcm_set_tx_pwr(uint8_t arg1, uint8_t arg2, hci_con_handle_t arg3){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_bcm_set_tx_pwr(packet, arg1, arg2, arg3));
+}
+
+/**
+ * @brief Encode hci_ti_drpb_tester_con_tx into buffer
+ * @param packet buffer for 15 bytes
+ * @param modulation
+ * @param test_patern
+ * @param frequency
+ * @param power_level
+ * @param reserved1
+ * @param reserved2
+ * @return size of command
+ * @note: format 111144
+ */
+static inline uint16_t hci_cmd_encode_ti_drpb_tester_con_tx(uint8_t * packet, uint8_t modulation, uint8_t test_patern, uint8_t frequency, uint8_t power_level, uint32_t reserved1, uint32_t reserved2){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(0x3f, 0x184);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(0x3f, 0x184) >> 8);
+    packet[2] = 12;
+    packet[3] = (uint8_t) modulation;
+    packet[4] = (uint8_t) test_patern;
+    packet[5] = (uint8_t) frequency;
+    packet[6] = (uint8_t) power_level;
+    packet[7] = (uint8_t) reserved1;
+    packet[8] = (uint8_t) (reserved1 >> 8);
+    packet[9] = (uint8_t) (reserved1 >> 16);
+    packet[10] = (uint8_t) (reserved1 >> 24);
+    packet[11] = (uint8_t) reserved2;
+    packet[12] = (uint8_t) (reserved2 >> 8);
+    packet[13] = (uint8_t) (reserved2 >> 16);
+    packet[14] = (uint8_t) (reserved2 >> 24);
+    return 15;
+}
+
+/**
+ * @brief Send hci_ti_drpb_tester_con_tx, same as hci_send_cmd(&hci_ti_drpb_tester_con_tx, ...)
+ * @param modulation
+ * @param test_patern
+ * @param frequency
+ * @param power_level
+ * @param reserved1
+ * @param reserved2
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_ti_drpb_tester_con_tx(uint8_t modulation, uint8_t test_patern, uint8_t frequency, uint8_t power_level, uint32_t reserved1, uint32_t reserved2){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_ti_drpb_tester_con_tx(packet, modulation, test_patern, frequency, power_level, reserved1, reserved2));
+}
+
+/**
+ * @brief Encode hci_ti_drpb_tester_packet_tx_rx into buffer
+ * @param packet buffer for 15 bytes
+ * @param arg1
+ * @param arg2
+ * @param arg3
+ * @param arg4
+ * @param arg5
+ * @param arg6
+ * @param arg7
+ * @param arg8
+ * @param arg9
+ * @param arg10
+ * @return size of command
+ * @note: format 1111112112
+ */
+static inline uint16_t hci_cmd_encode_ti_drpb_tester_packet_tx_rx(uint8_t * packet, uint8_t arg1, uint8_t arg2, uint8_t arg3, uint8_t arg4, uint8_t arg5, uint8_t arg6, uint16_t arg7, uint8_t arg8, uint8_t arg9, uint16_t arg10){
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE(0x3f, 0x185);
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE(0x3f, 0x185) >> 8);
+    packet[2] = 12;
+    packet[3] = (uint8_t) arg1;
+    packet[4] = (uint8_t) arg2;
+    packet[5] = (uint8_t) arg3;
+    packet[6] = (uint8_t) arg4;
+    packet[7] = (uint8_t) arg5;
+    packet[8] = (uint8_t) arg6;
+    packet[9] = (uint8_t) arg7;
+    packet[10] = (uint8_t) (arg7 >> 8);
+    packet[11] = (uint8_t) arg8;
+    packet[12] = (uint8_t) arg9;
+    packet[13] = (uint8_t) arg10;
+    packet[14] = (uint8_t) (arg10 >> 8);
+    return 15;
+}
+
+/**
+ * @brief Send hci_ti_drpb_tester_packet_tx_rx, same as hci_send_cmd(&hci_ti_drpb_tester_packet_tx_rx, ...)
+ * @param arg1
+ * @param arg2
+ * @param arg3
+ * @param arg4
+ * @param arg5
+ * @param arg6
+ * @param arg7
+ * @param arg8
+ * @param arg9
+ * @param arg10
+ * @return status as hci_send_cmd
+ */
+static inline int hci_send_cmd_ti_drpb_tester_packet_tx_rx(uint8_t arg1, uint8_t arg2, uint8_t arg3, uint8_t arg4, uint8_t arg5, uint8_t arg6, uint16_t arg7, uint8_t arg8, uint8_t arg9, uint16_t arg10){
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer(hci_cmd_encode_ti_drpb_tester_packet_tx_rx(packet, arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9, arg10));
+}
+
+/* API_END */
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // HCI_CMD_ENCODER_H
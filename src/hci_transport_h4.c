@@ -46,6 +46,7 @@
  */
 
 #include <inttypes.h>
+#include <string.h>
 
 #include "btstack_config.h"
 
@@ -143,6 +144,10 @@ static  H4_STATE h4_state;
 static uint16_t bytes_to_read;
 static uint16_t read_pos;
 
+// streaming mode: bytes of current block already received
+static bool     h4_streaming;
+static uint16_t block_pos;
+
 // incoming packet buffer
 static uint8_t hci_packet_with_pre_buffer[HCI_INCOMING_PRE_BUFFER_SIZE + HCI_INCOMING_PACKET_BUFFER_SIZE + 1]; // packet type + max(acl header + acl payload, event header + event data)
 static uint8_t * hci_packet = &hci_packet_with_pre_buffer[HCI_INCOMING_PRE_BUFFER_SIZE];
@@ -179,10 +184,13 @@ static int hci_transport_h4_set_baudrate(uint32_t baudrate){
 static void hci_transport_h4_reset_statemachine(void){
     h4_state = H4_W4_PACKET_TYPE;
     read_pos = 0;
+    block_pos = 0;
     bytes_to_read = 1;
 }
 
 static void hci_transport_h4_trigger_next_read(void){
+    // in streaming mode, UART driver provides all data
+    if (h4_streaming) return;
     // log_info("hci_transport_h4_trigger_next_read: %u bytes", bytes_to_read);
     btstack_uart->receive_block(&hci_packet[read_pos], bytes_to_read);  
 }
@@ -222,7 +230,7 @@ static void hci_transport_h4_packet_complete(void){
     packet_handler(hci_packet[0], &hci_packet[1], packet_len);
 }
 
-static void hci_transport_h4_block_read(void){
+static void hci_transport_h4_process_block(void){
 
     read_pos += bytes_to_read;
 
@@ -312,12 +320,29 @@ static void hci_transport_h4_block_read(void){
     if (h4_state == H4_W4_PAYLOAD && bytes_to_read == 0) {
         hci_transport_h4_packet_complete();
     }
+}
 
+static void hci_transport_h4_block_read(void){
+    hci_transport_h4_process_block();
     if (h4_state != H4_OFF) {
         hci_transport_h4_trigger_next_read();
     }
 }
 
+// streaming mode: extract all complete packets from received data
+static void hci_transport_h4_data_received(const uint8_t * data, uint16_t size){
+    while ((size > 0) && (h4_state != H4_OFF)){
+        uint16_t bytes_to_copy = btstack_min(size, bytes_to_read - block_pos);
+        (void)memcpy(&hci_packet[read_pos + block_pos], data, bytes_to_copy);
+        data      += bytes_to_copy;
+        size      -= bytes_to_copy;
+        block_pos += bytes_to_copy;
+        if (block_pos < bytes_to_read) break;
+        block_pos = 0;
+        hci_transport_h4_process_block();
+    }
+}
+
 static void hci_transport_h4_block_sent(void){
 
     static const uint8_t packet_sent_event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
@@ -420,6 +445,12 @@ static void hci_transport_h4_init(const void * transport_config){
 }
 
 static int hci_transport_h4_open(void){
+    // use streaming mode if supported by UART driver
+    h4_streaming = btstack_uart->set_data_received != NULL;
+    if (h4_streaming){
+        btstack_uart->set_data_received(&hci_transport_h4_data_received);
+    }
+
     // open uart driver
     int res = btstack_uart->open();
     if (res){
@@ -443,7 +474,13 @@ static int hci_transport_h4_close(void){
     h4_state = H4_OFF;
 
     // close uart driver
-    return btstack_uart->close();
+    int res = btstack_uart->close();
+
+    // UART driver might be used in block mode by chipset drivers
+    if (h4_streaming){
+        btstack_uart->set_data_received(NULL);
+    }
+    return res;
 }
 
 static void hci_transport_h4_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
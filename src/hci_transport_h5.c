@@ -74,8 +74,16 @@ typedef enum {
 
 } hci_transport_link_actions_t;
 
-// Configuration Field. No packet buffers -> sliding window = 1, no OOF flow control, support data integrity check
+// Configuration Field. Sliding window as configured, no OOF flow control, support data integrity check
+#ifdef HCI_TRANSPORT_H5_SLIDING_WINDOW_SIZE
+#if (HCI_TRANSPORT_H5_SLIDING_WINDOW_SIZE < 1) || (HCI_TRANSPORT_H5_SLIDING_WINDOW_SIZE > 7)
+#error "HCI_TRANSPORT_H5_SLIDING_WINDOW_SIZE must be in range 1..7"
+#endif
+#define LINK_CONFIG_SLIDING_WINDOW_SIZE HCI_TRANSPORT_H5_SLIDING_WINDOW_SIZE
+#else
+// No packet buffers -> sliding window = 1
 #define LINK_CONFIG_SLIDING_WINDOW_SIZE 1
+#endif
 #define LINK_CONFIG_OOF_FLOW_CONTROL 0
 #define LINK_CONFIG_DATA_INTEGRITY_CHECK 1
 #define LINK_CONFIG_VERSION_NR 0
@@ -114,6 +122,10 @@ static uint8_t   slip_outgoing_buffer[LINK_SLIP_TX_CHUNK_LEN+4+1];
 static uint16_t  slip_outgoing_dic;
 static uint16_t  slip_outgoing_dic_present;
 static int       slip_write_active;
+static btstack_slip_encoder_t slip_encoder;
+
+// incoming slip decoder
+static btstack_slip_decoder_t slip_decoder;
 
 // H5 Link State
 static hci_transport_link_state_t link_state;
@@ -123,15 +135,31 @@ static uint8_t  link_ack_nr;
 static uint16_t link_resend_timeout_ms;
 static uint8_t  link_peer_asleep;
 static uint8_t  link_peer_supports_data_integrity_check;
+static uint8_t  link_sliding_window_size;
 
 // auto sleep-mode
 static btstack_timer_source_t inactivity_timer;
 static uint16_t link_inactivity_timeout_ms; // auto-sleep if set
 
-// Outgoing packet
-static uint8_t   hci_packet_type;
-static uint16_t  hci_packet_size;
-static uint8_t * hci_packet;
+// Outgoing packets, oldest unacknowledged packet is at link_tx_head and has sequence nr link_seq_nr
+typedef struct {
+    uint8_t * packet;
+    uint16_t  size;
+    uint8_t   type;
+} hci_transport_link_tx_packet_t;
+
+static hci_transport_link_tx_packet_t link_tx_queue[LINK_CONFIG_SLIDING_WINDOW_SIZE];
+static uint8_t link_tx_head;
+static uint8_t link_tx_count;
+// number of queued packets that have been sent since queued or last retransmission
+static uint8_t link_tx_num_sent;
+// emit packet sent event after frame was sent if there's room for another packet
+static uint8_t link_tx_notify_pending;
+
+#if LINK_CONFIG_SLIDING_WINDOW_SIZE > 1
+// HCI re-uses its outgoing buffer as soon as send_packet returns, keep copy for retransmission
+static uint8_t link_tx_buffers[LINK_CONFIG_SLIDING_WINDOW_SIZE][HCI_OUTGOING_PACKET_BUFFER_SIZE];
+#endif
 
 // hci packet handler
 static  void (*packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
@@ -220,20 +248,18 @@ static void hci_transport_inactivity_timer_set(void){
 
 // Fill chunk and write
 static void hci_transport_slip_encode_chunk_and_send(int pos){
-    while (btstack_slip_encoder_has_data() & (pos < LINK_SLIP_TX_CHUNK_LEN)) {
-        slip_outgoing_buffer[pos++] = btstack_slip_encoder_get_byte();
+    if (pos < LINK_SLIP_TX_CHUNK_LEN){
+        pos += btstack_slip_encoder_instance_encode(&slip_encoder, &slip_outgoing_buffer[pos], LINK_SLIP_TX_CHUNK_LEN - pos);
     }
 
-    if (!btstack_slip_encoder_has_data()){
+    if (!btstack_slip_encoder_instance_has_data(&slip_encoder)){
         // Payload encoded, append DIC if present.
         // note: slip_outgoing_buffer is guaranteed to be big enough to add DIC + SOF after LINK_SLIP_TX_CHUNK_LEN
         if (slip_outgoing_dic_present){
             uint8_t dic_buffer[2];
             big_endian_store_16(dic_buffer, 0, slip_outgoing_dic);
-            btstack_slip_encoder_start(dic_buffer, 2);
-            while (btstack_slip_encoder_has_data()){
-                slip_outgoing_buffer[pos++] = btstack_slip_encoder_get_byte();
-            } 
+            btstack_slip_encoder_instance_start(&slip_encoder, dic_buffer, 2);
+            pos += btstack_slip_encoder_instance_encode(&slip_encoder, &slip_outgoing_buffer[pos], 4);
         }
         // Start of Frame
         slip_outgoing_buffer[pos++] = BTSTACK_SLIP_SOF;
@@ -261,13 +287,11 @@ static void hci_transport_slip_send_frame(const uint8_t * header, const uint8_t
     slip_outgoing_buffer[pos++] = BTSTACK_SLIP_SOF;
 
     // Header
-    btstack_slip_encoder_start(header, 4);
-    while (btstack_slip_encoder_has_data()){
-        slip_outgoing_buffer[pos++] = btstack_slip_encoder_get_byte();
-    }
+    btstack_slip_encoder_instance_start(&slip_encoder, header, 4);
+    pos += btstack_slip_encoder_instance_encode(&slip_encoder, &slip_outgoing_buffer[pos], 8);
 
     // Packet
-    btstack_slip_encoder_start(packet, packet_size);
+    btstack_slip_encoder_instance_start(&slip_encoder, packet, packet_size);
 
     // Fill rest of chunk from packet and send
     hci_transport_slip_encode_chunk_and_send(pos);
@@ -276,7 +300,7 @@ static void hci_transport_slip_send_frame(const uint8_t * header, const uint8_t
 // SLIP Incoming
 
 static void hci_transport_slip_init(void){
-    btstack_slip_decoder_init(&hci_packet_with_pre_buffer[HCI_INCOMING_PRE_BUFFER_SIZE], 6 + HCI_INCOMING_PACKET_BUFFER_SIZE);
+    btstack_slip_decoder_instance_init(&slip_decoder, &hci_packet_with_pre_buffer[HCI_INCOMING_PRE_BUFFER_SIZE], 6 + HCI_INCOMING_PACKET_BUFFER_SIZE);
 }
 
 // H5 Three-Wire Implementation
@@ -348,19 +372,24 @@ static void hci_transport_link_send_sleep(void){
     hci_transport_link_send_control(link_control_sleep, sizeof(link_control_sleep));
 }
 
+// send next queued packet that has not been sent yet
 static void hci_transport_link_send_queued_packet(void){
 
+    const hci_transport_link_tx_packet_t * tx_packet = &link_tx_queue[(link_tx_head + link_tx_num_sent) % LINK_CONFIG_SLIDING_WINDOW_SIZE];
+    uint8_t seq_nr = (link_seq_nr + link_tx_num_sent) & 0x07;
+    link_tx_num_sent++;
+
     uint8_t header[4];
-    hci_transport_link_calc_header(header, link_seq_nr, link_ack_nr, link_peer_supports_data_integrity_check, 1, hci_packet_type, hci_packet_size);
+    hci_transport_link_calc_header(header, seq_nr, link_ack_nr, link_peer_supports_data_integrity_check, 1, tx_packet->type, tx_packet->size);
 
     uint16_t data_integrity_check = 0;
     if (link_peer_supports_data_integrity_check){
-        data_integrity_check = crc16_calc_for_slip_frame(header, hci_packet, hci_packet_size);
+        data_integrity_check = crc16_calc_for_slip_frame(header, tx_packet->packet, tx_packet->size);
     }
-    log_debug("hci_transport_link_send_queued_packet: seq %u, ack %u, size %u. Append dic %u, dic = 0x%04x", link_seq_nr, link_ack_nr, hci_packet_size, link_peer_supports_data_integrity_check, data_integrity_check);
-    log_debug_hexdump(hci_packet, hci_packet_size);
+    log_debug("hci_transport_link_send_queued_packet: seq %u, ack %u, size %u. Append dic %u, dic = 0x%04x", seq_nr, link_ack_nr, tx_packet->size, link_peer_supports_data_integrity_check, data_integrity_check);
+    log_debug_hexdump(tx_packet->packet, tx_packet->size);
 
-    hci_transport_slip_send_frame(header, hci_packet, hci_packet_size, data_integrity_check);
+    hci_transport_slip_send_frame(header, tx_packet->packet, tx_packet->size, data_integrity_check);
 
     // reset inactvitiy timer
     hci_transport_inactivity_timer_set();
@@ -415,10 +444,12 @@ static void hci_transport_link_run(void){
         return;
     }
     if (hci_transport_link_actions & HCI_TRANSPORT_LINK_SEND_QUEUED_PACKET){
-        hci_transport_link_actions &= ~HCI_TRANSPORT_LINK_SEND_QUEUED_PACKET;
         // packet already contains ack, no need to send addtitional one
         hci_transport_link_actions &= ~HCI_TRANSPORT_LINK_SEND_ACK_PACKET;
         hci_transport_link_send_queued_packet();
+        if (link_tx_num_sent >= link_tx_count){
+            hci_transport_link_actions &= ~HCI_TRANSPORT_LINK_SEND_QUEUED_PACKET;
+        }
         return;
     }
     if (hci_transport_link_actions & HCI_TRANSPORT_LINK_SEND_ACK_PACKET){
@@ -436,6 +467,7 @@ static void hci_transport_link_run(void){
 }
 
 static void hci_transport_link_set_timer(uint16_t timeout_ms){
+    btstack_run_loop_remove_timer(&link_timer);
     btstack_run_loop_set_timer_handler(&link_timer, &hci_transport_link_timeout_handler);
     btstack_run_loop_set_timer(&link_timer, timeout_ms);
     btstack_run_loop_add_timer(&link_timer);
@@ -462,7 +494,8 @@ static void hci_transport_link_timeout_handler(btstack_timer_source_t * ts){
                 hci_transport_link_set_timer(LINK_WAKEUP_MS);
                 return;
             }
-            // resend packet
+            // resend all unacknowledged packets, starting with the oldest one
+            link_tx_num_sent = 0;
             hci_transport_link_actions |= HCI_TRANSPORT_LINK_SEND_QUEUED_PACKET;
             hci_transport_link_set_timer(link_resend_timeout_ms);
             break;
@@ -477,6 +510,7 @@ static void hci_transport_link_init(void){
     link_state = LINK_UNINITIALIZED;
     link_peer_asleep = 0;
     link_peer_supports_data_integrity_check = 0;
+    link_sliding_window_size = 1;
  
     // get started
     hci_transport_link_actions |= HCI_TRANSPORT_LINK_SEND_SYNC;
@@ -489,18 +523,63 @@ static int hci_transport_link_inc_seq_nr(int seq_nr){
 }
 
 static int hci_transport_link_have_outgoing_packet(void){
-    return hci_packet != NULL;
+    return link_tx_count > 0;
 }
 
 static void hci_transport_link_clear_queue(void){
     btstack_run_loop_remove_timer(&link_timer);
-    hci_packet = NULL;
+    hci_transport_link_actions &= ~HCI_TRANSPORT_LINK_SEND_QUEUED_PACKET;
+    link_tx_head = 0;
+    link_tx_count = 0;
+    link_tx_num_sent = 0;
+    link_tx_notify_pending = 0;
 }
 
 static void hci_transport_h5_queue_packet(uint8_t packet_type, uint8_t *packet, int size){
-    hci_packet = packet;
-    hci_packet_type = packet_type;
-    hci_packet_size = size;
+    hci_transport_link_tx_packet_t * tx_packet = &link_tx_queue[(link_tx_head + link_tx_count) % LINK_CONFIG_SLIDING_WINDOW_SIZE];
+#if LINK_CONFIG_SLIDING_WINDOW_SIZE > 1
+    uint8_t * buffer = link_tx_buffers[(link_tx_head + link_tx_count) % LINK_CONFIG_SLIDING_WINDOW_SIZE];
+    (void)memcpy(buffer, packet, size);
+    tx_packet->packet = buffer;
+#else
+    tx_packet->packet = packet;
+#endif
+    tx_packet->type = packet_type;
+    tx_packet->size = size;
+    link_tx_count++;
+}
+
+// process cumulative acknowledgement: ack_nr is the sequence nr of the next packet expected by the peer
+static void hci_transport_link_process_ack(uint8_t ack_nr){
+    uint8_t num_acked = (ack_nr - link_seq_nr) & 0x07;
+    if (num_acked == 0) return;
+    if (num_acked > link_tx_count){
+        log_info("ack nr %u does not match outgoing packets: seq nr %u, count %u", ack_nr, link_seq_nr, link_tx_count);
+        return;
+    }
+
+    log_debug("outgoing packets with seq %u..%u ack'ed", link_seq_nr, (link_seq_nr + num_acked - 1) & 0x07);
+    link_seq_nr  = ack_nr;
+    link_tx_head = (link_tx_head + num_acked) % LINK_CONFIG_SLIDING_WINDOW_SIZE;
+    link_tx_count -= num_acked;
+    link_tx_num_sent = (link_tx_num_sent > num_acked) ? (link_tx_num_sent - num_acked) : 0;
+
+    if (link_tx_count == 0){
+        hci_transport_link_clear_queue();
+    } else {
+        // restart resend timer for the oldest unacknowledged packet
+        if (link_tx_num_sent >= link_tx_count){
+            hci_transport_link_actions &= ~HCI_TRANSPORT_LINK_SEND_QUEUED_PACKET;
+        } else {
+            hci_transport_link_actions |= HCI_TRANSPORT_LINK_SEND_QUEUED_PACKET;
+        }
+        hci_transport_link_set_timer(link_resend_timeout_ms);
+    }
+
+    // notify upper stack that it can send again
+    link_tx_notify_pending = 0;
+    uint8_t event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
+    packet_handler(HCI_EVENT_PACKET, &event[0], sizeof(event));
 }
 
 static void hci_transport_h5_emit_sleep_state(int sleep_active){
@@ -609,15 +688,25 @@ static void hci_transport_h5_process_frame(uint16_t frame_size){
                 break;
             }
             if (memcmp(slip_payload, link_control_config_response, link_control_config_response_prefix_len) == 0){
-                uint8_t config = slip_payload[2];
+                // missing config field -> sliding window 1, no data integrity check
+                uint8_t config = 0x01;
+                if (link_payload_len > link_control_config_response_prefix_len){
+                    config = slip_payload[2];
+                }
                 link_peer_supports_data_integrity_check = (config & 0x10) != 0;
-                log_info("link received config response 0x%02x, data integrity check supported %u", config, link_peer_supports_data_integrity_check);
+                // use smaller of both sliding window sizes
+                link_sliding_window_size = btstack_min(config & 0x07, LINK_CONFIG_SLIDING_WINDOW_SIZE);
+                if (link_sliding_window_size == 0){
+                    link_sliding_window_size = 1;
+                }
+                log_info("link received config response 0x%02x, data integrity check supported %u, sliding window %u", config, link_peer_supports_data_integrity_check, link_sliding_window_size);
                 link_state = LINK_ACTIVE;
                 btstack_run_loop_remove_timer(&link_timer);
                 log_info("link activated");
                 // 
                 link_seq_nr = 0;
                 link_ack_nr = 0;
+                hci_transport_link_clear_queue();
                 // notify upper stack that it can start
                 uint8_t event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
                 packet_handler(HCI_EVENT_PACKET, &event[0], sizeof(event));
@@ -640,17 +729,7 @@ static void hci_transport_h5_process_frame(uint16_t frame_size){
 
             // Process ACKs in reliable packet and explicit ack packets
             if (reliable_packet || (link_packet_type == LINK_ACKNOWLEDGEMENT_TYPE)){
-                // our packet is good if the remote expects our seq nr + 1
-                int next_seq_nr = hci_transport_link_inc_seq_nr(link_seq_nr);
-                if (hci_transport_link_have_outgoing_packet() && (next_seq_nr == ack_nr)){
-                    log_debug("outoing packet with seq %u ack'ed", link_seq_nr);
-                    link_seq_nr = next_seq_nr;
-                    hci_transport_link_clear_queue();
-
-                    // notify upper stack that it can send again
-                    uint8_t event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
-                    packet_handler(HCI_EVENT_PACKET, &event[0], sizeof(event));
-                }
+                hci_transport_link_process_ack(ack_nr);
             } 
 
             switch (link_packet_type){
@@ -735,22 +814,30 @@ static void hci_transport_link_update_resend_timeout(uint32_t baudrate){
 static uint8_t hci_transport_link_read_byte;
 static int hci_transport_h5_active;
 
+// streaming mode: UART driver provides all received data
+static bool hci_transport_h5_streaming;
+
 static void hci_transport_h5_read_next_byte(void){
+    // in streaming mode, UART driver provides all data
+    if (hci_transport_h5_streaming) return;
     btstack_uart->receive_block(&hci_transport_link_read_byte, 1);    
 }
 
 // track time receiving SLIP frame
 static uint32_t hci_transport_h5_receive_start;
-static void hci_transport_h5_block_received(void){
-    if (hci_transport_h5_active == 0) return;
 
+// decode SLIP frames in received data
+static void hci_transport_h5_process_data(const uint8_t * data, uint16_t size){
     // track start time when receiving first byte // a bit hackish
-    if ((hci_transport_h5_receive_start == 0) && (hci_transport_link_read_byte != BTSTACK_SLIP_SOF)){
+    if ((hci_transport_h5_receive_start == 0) && ((size > 1u) || (data[0] != BTSTACK_SLIP_SOF))){
         hci_transport_h5_receive_start = btstack_run_loop_get_time_ms();
     }
-    btstack_slip_decoder_process(hci_transport_link_read_byte);
-    uint16_t frame_size = btstack_slip_decoder_frame_size();
-    if (frame_size) {
+    while ((size > 0u) && hci_transport_h5_active){
+        uint16_t bytes_consumed = btstack_slip_decoder_instance_process(&slip_decoder, data, size);
+        data += bytes_consumed;
+        size -= bytes_consumed;
+        uint16_t frame_size = btstack_slip_decoder_instance_frame_size(&slip_decoder);
+        if (frame_size == 0u) continue;
         // track time
         uint32_t packet_receive_time = btstack_run_loop_get_time_ms() - hci_transport_h5_receive_start;
         uint32_t nominal_time = (frame_size + 6) * 10 * 1000 / uart_config.baudrate;
@@ -758,19 +845,29 @@ static void hci_transport_h5_block_received(void){
         UNUSED(packet_receive_time);
         log_info("slip frame time %u ms for %u decoded bytes. nomimal time %u ms", (int) packet_receive_time, frame_size, (int) nominal_time);
         // reset state
-        hci_transport_h5_receive_start = 0;
+        hci_transport_h5_receive_start = (size > 0u) ? btstack_run_loop_get_time_ms() : 0;
         // 
         hci_transport_h5_process_frame(frame_size);
         hci_transport_slip_init();
     }
+}
+
+static void hci_transport_h5_block_received(void){
+    if (hci_transport_h5_active == 0) return;
+    hci_transport_h5_process_data(&hci_transport_link_read_byte, 1);
     hci_transport_h5_read_next_byte();
 }
 
+static void hci_transport_h5_data_received(const uint8_t * data, uint16_t size){
+    if (hci_transport_h5_active == 0) return;
+    hci_transport_h5_process_data(data, size);
+}
+
 static void hci_transport_h5_block_sent(void){
     if (hci_transport_h5_active == 0) return;
 
     // check if more data to send
-    if (btstack_slip_encoder_has_data()){
+    if (btstack_slip_encoder_instance_has_data(&slip_encoder)){
         hci_transport_slip_send_next_chunk();
         return;
     }
@@ -790,6 +887,15 @@ static void hci_transport_h5_block_sent(void){
         hci_transport_h5_emit_sleep_state(1);
     }
 
+    // notify upper stack that it can send another packet while previous ones are not acknowledged yet
+    if (link_tx_notify_pending){
+        link_tx_notify_pending = 0;
+        if (link_tx_count < link_sliding_window_size){
+            uint8_t event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
+            packet_handler(HCI_EVENT_PACKET, &event[0], sizeof(event));
+        }
+    }
+
     hci_transport_link_run();
 }
 
@@ -819,6 +925,12 @@ static void hci_transport_h5_init(const void * transport_config){
 }
 
 static int hci_transport_h5_open(void){
+    // use streaming mode if supported by UART driver
+    hci_transport_h5_streaming = btstack_uart->set_data_received != NULL;
+    if (hci_transport_h5_streaming){
+        btstack_uart->set_data_received(&hci_transport_h5_data_received);
+    }
+
     int res = btstack_uart->open();
     if (res){
         return res;
@@ -861,7 +973,13 @@ static int hci_transport_h5_open(void){
 
 static int hci_transport_h5_close(void){
     hci_transport_h5_active = 0;
-    return btstack_uart->close();
+    int res = btstack_uart->close();
+
+    // UART driver might be used in block mode by chipset drivers
+    if (hci_transport_h5_streaming){
+        btstack_uart->set_data_received(NULL);
+    }
+    return res;
 }
 
 static void hci_transport_h5_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
@@ -869,7 +987,7 @@ static void hci_transport_h5_register_packet_handler(void (*handler)(uint8_t pac
 }
 
 static int hci_transport_h5_can_send_packet_now(uint8_t packet_type){
-    int res = !hci_transport_link_have_outgoing_packet() && (link_state == LINK_ACTIVE);
+    int res = (link_tx_count < link_sliding_window_size) && (link_state == LINK_ACTIVE);
     // log_info("can_send_packet_now: %u", res);
     return res;
 }
@@ -880,11 +998,25 @@ static int hci_transport_h5_send_packet(uint8_t packet_type, uint8_t *packet, in
         return -1;
     }
 
+    if (size > HCI_OUTGOING_PACKET_BUFFER_SIZE){
+        log_error("hci_transport_h5_send_packet: packet of size %u too large", size);
+        return -1;
+    }
+
     // store request
+    int queue_was_empty = link_tx_count == 0;
     hci_transport_h5_queue_packet(packet_type, packet, size);
+    if (link_tx_count < link_sliding_window_size){
+        link_tx_notify_pending = 1;
+    }
 
-    // send wakeup first
-    if (link_peer_asleep){
+    if (!queue_was_empty){
+        // wakeup or resend already in progress
+        if (!link_peer_asleep){
+            hci_transport_link_actions |= HCI_TRANSPORT_LINK_SEND_QUEUED_PACKET;
+        }
+    } else if (link_peer_asleep){
+        // send wakeup first
         hci_transport_h5_emit_sleep_state(0);
         if (btstack_uart_sleep_mode){
             log_info("disable UART sleep");
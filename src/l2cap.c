@@ -47,6 +47,7 @@
 
 #include "l2cap.h"
 #include "hci.h"
+#include "hci_cmd_encoder.h"
 #include "hci_dump.h"
 #include "bluetooth_sdp.h"
 #include "bluetooth_psm.h"
@@ -125,6 +126,12 @@ typedef enum {
 #define L2CAP_LE_DATA_CHANNELS_AUTOMATIC_CREDITS_WATERMARK 5
 #define L2CAP_LE_DATA_CHANNELS_AUTOMATIC_CREDITS_INCREMENT 5
 
+// adaptive credits: bounds for outstanding credits and interval for consumption rate
+#define L2CAP_LE_DATA_CHANNELS_ADAPTIVE_CREDITS_MIN          4
+#define L2CAP_LE_DATA_CHANNELS_ADAPTIVE_CREDITS_INITIAL      8
+#define L2CAP_LE_DATA_CHANNELS_ADAPTIVE_CREDITS_MAX        256
+#define L2CAP_LE_DATA_CHANNELS_ADAPTIVE_CREDITS_INTERVAL_MS 250
+
 // offsets for L2CAP SIGNALING COMMANDS
 #define L2CAP_SIGNALING_COMMAND_CODE_OFFSET   0
 #define L2CAP_SIGNALING_COMMAND_SIGID_OFFSET  1
@@ -152,6 +159,7 @@ static void l2cap_emit_channel_opened(l2cap_channel_t *channel, uint8_t status);
 static void l2cap_emit_channel_closed(l2cap_channel_t *channel);
 static void l2cap_emit_incoming_connection(l2cap_channel_t *channel);
 static int  l2cap_channel_ready_for_open(l2cap_channel_t *channel);
+static int  l2cap_channel_send_prepared(l2cap_channel_t * channel, uint8_t * acl_buffer, uint16_t len);
 #endif
 #ifdef ENABLE_LE_DATA_CHANNELS
 static void l2cap_emit_le_channel_opened(l2cap_channel_t *channel, uint8_t status);
@@ -160,6 +168,15 @@ static void l2cap_emit_le_incoming_connection(l2cap_channel_t *channel);
 static void l2cap_le_notify_channel_can_send(l2cap_channel_t *channel);
 static void l2cap_le_finialize_channel_close(l2cap_channel_t *channel);
 static void l2cap_le_send_pdu(l2cap_channel_t *channel);
+static uint16_t l2cap_le_local_mps(l2cap_channel_t *channel);
+static void l2cap_le_init_credits(l2cap_channel_t *channel);
+static void l2cap_le_update_credits(l2cap_channel_t *channel);
+static void l2cap_le_add_receive_buffer_internal(l2cap_channel_t *channel, uint8_t * receive_sdu_buffer);
+static void l2cap_le_select_receive_buffer(l2cap_channel_t *channel);
+static void l2cap_le_tx_stall_start(l2cap_channel_t *channel);
+static void l2cap_le_tx_stall_stop(l2cap_channel_t *channel);
+static void l2cap_le_rx_stall_start(l2cap_channel_t *channel);
+static void l2cap_le_rx_stall_stop(l2cap_channel_t *channel);
 static inline l2cap_service_t * l2cap_le_get_service(uint16_t psm);
 #endif
 #ifdef L2CAP_USES_CHANNELS
@@ -176,6 +193,7 @@ static void l2cap_free_channel_entry(l2cap_channel_t * channel);
 static void l2cap_ertm_notify_channel_can_send(l2cap_channel_t * channel);
 static void l2cap_ertm_monitor_timeout_callback(btstack_timer_source_t * ts);
 static void l2cap_ertm_retransmission_timeout_callback(btstack_timer_source_t * ts);
+static int  l2cap_ertm_extended_window_size_supported(l2cap_channel_t * channel);
 #endif
 
 // l2cap_fixed_channel_t entries
@@ -210,6 +228,7 @@ static uint8_t   sig_seq_nr  = 0xff;
 static l2cap_signaling_response_t signaling_responses[NR_PENDING_SIGNALING_RESPONSES];
 static int signaling_responses_pending;
 static btstack_packet_callback_registration_t hci_event_callback_registration;
+static btstack_event_filter_t                 hci_event_filter;
 
 #ifdef ENABLE_BLE
 // only used for connection parameter update events
@@ -244,29 +263,214 @@ static const uint16_t crc16_table[256] = {
     0x4400, 0x84c1, 0x8581, 0x4540, 0x8701, 0x47c0, 0x4680, 0x8641, 0x8201, 0x42c0, 0x4380, 0x8341, 0x4100, 0x81c1, 0x8081, 0x4040, 
 };
 
+#ifdef ENABLE_L2CAP_ERTM_FCS_SLICING_BY_8
+/*
+ * CRC lookup tables for byte followed by 1..7 zero bytes, used to process 8 bytes per iteration
+ */
+static const uint16_t crc16_table_slicing_by_8[7][256] = {
+    {
+        0x0000, 0x9001, 0x6001, 0xf000, 0xc002, 0x5003, 0xa003, 0x3002, 0xc007, 0x5006, 0xa006, 0x3007, 0x0005, 0x9004, 0x6004, 0xf005,
+        0xc00d, 0x500c, 0xa00c, 0x300d, 0x000f, 0x900e, 0x600e, 0xf00f, 0x000a, 0x900b, 0x600b, 0xf00a, 0xc008, 0x5009, 0xa009, 0x3008,
+        0xc019, 0x5018, 0xa018, 0x3019, 0x001b, 0x901a, 0x601a, 0xf01b, 0x001e, 0x901f, 0x601f, 0xf01e, 0xc01c, 0x501d, 0xa01d, 0x301c,
+        0x0014, 0x9015, 0x6015, 0xf014, 0xc016, 0x5017, 0xa017, 0x3016, 0xc013, 0x5012, 0xa012, 0x3013, 0x0011, 0x9010, 0x6010, 0xf011,
+        0xc031, 0x5030, 0xa030, 0x3031, 0x0033, 0x9032, 0x6032, 0xf033, 0x0036, 0x9037, 0x6037, 0xf036, 0xc034, 0x5035, 0xa035, 0x3034,
+        0x003c, 0x903d, 0x603d, 0xf03c, 0xc03e, 0x503f, 0xa03f, 0x303e, 0xc03b, 0x503a, 0xa03a, 0x303b, 0x0039, 0x9038, 0x6038, 0xf039,
+        0x0028, 0x9029, 0x6029, 0xf028, 0xc02a, 0x502b, 0xa02b, 0x302a, 0xc02f, 0x502e, 0xa02e, 0x302f, 0x002d, 0x902c, 0x602c, 0xf02d,
+        0xc025, 0x5024, 0xa024, 0x3025, 0x0027, 0x9026, 0x6026, 0xf027, 0x0022, 0x9023, 0x6023, 0xf022, 0xc020, 0x5021, 0xa021, 0x3020,
+        0xc061, 0x5060, 0xa060, 0x3061, 0x0063, 0x9062, 0x6062, 0xf063, 0x0066, 0x9067, 0x6067, 0xf066, 0xc064, 0x5065, 0xa065, 0x3064,
+        0x006c, 0x906d, 0x606d, 0xf06c, 0xc06e, 0x506f, 0xa06f, 0x306e, 0xc06b, 0x506a, 0xa06a, 0x306b, 0x0069, 0x9068, 0x6068, 0xf069,
+        0x0078, 0x9079, 0x6079, 0xf078, 0xc07a, 0x507b, 0xa07b, 0x307a, 0xc07f, 0x507e, 0xa07e, 0x307f, 0x007d, 0x907c, 0x607c, 0xf07d,
+        0xc075, 0x5074, 0xa074, 0x3075, 0x0077, 0x9076, 0x6076, 0xf077, 0x0072, 0x9073, 0x6073, 0xf072, 0xc070, 0x5071, 0xa071, 0x3070,
+        0x0050, 0x9051, 0x6051, 0xf050, 0xc052, 0x5053, 0xa053, 0x3052, 0xc057, 0x5056, 0xa056, 0x3057, 0x0055, 0x9054, 0x6054, 0xf055,
+        0xc05d, 0x505c, 0xa05c, 0x305d, 0x005f, 0x905e, 0x605e, 0xf05f, 0x005a, 0x905b, 0x605b, 0xf05a, 0xc058, 0x5059, 0xa059, 0x3058,
+        0xc049, 0x5048, 0xa048, 0x3049, 0x004b, 0x904a, 0x604a, 0xf04b, 0x004e, 0x904f, 0x604f, 0xf04e, 0xc04c, 0x504d, 0xa04d, 0x304c,
+        0x0044, 0x9045, 0x6045, 0xf044, 0xc046, 0x5047, 0xa047, 0x3046, 0xc043, 0x5042, 0xa042, 0x3043, 0x0041, 0x9040, 0x6040, 0xf041,
+    },
+    {
+        0x0000, 0xc051, 0xc0a1, 0x00f0, 0xc141, 0x0110, 0x01e0, 0xc1b1, 0xc281, 0x02d0, 0x0220, 0xc271, 0x03c0, 0xc391, 0xc361, 0x0330,
+        0xc501, 0x0550, 0x05a0, 0xc5f1, 0x0440, 0xc411, 0xc4e1, 0x04b0, 0x0780, 0xc7d1, 0xc721, 0x0770, 0xc6c1, 0x0690, 0x0660, 0xc631,
+        0xca01, 0x0a50, 0x0aa0, 0xcaf1, 0x0b40, 0xcb11, 0xcbe1, 0x0bb0, 0x0880, 0xc8d1, 0xc821, 0x0870, 0xc9c1, 0x0990, 0x0960, 0xc931,
+        0x0f00, 0xcf51, 0xcfa1, 0x0ff0, 0xce41, 0x0e10, 0x0ee0, 0xceb1, 0xcd81, 0x0dd0, 0x0d20, 0xcd71, 0x0cc0, 0xcc91, 0xcc61, 0x0c30,
+        0xd401, 0x1450, 0x14a0, 0xd4f1, 0x1540, 0xd511, 0xd5e1, 0x15b0, 0x1680, 0xd6d1, 0xd621, 0x1670, 0xd7c1, 0x1790, 0x1760, 0xd731,
+        0x1100, 0xd151, 0xd1a1, 0x11f0, 0xd041, 0x1010, 0x10e0, 0xd0b1, 0xd381, 0x13d0, 0x1320, 0xd371, 0x12c0, 0xd291, 0xd261, 0x1230,
+        0x1e00, 0xde51, 0xdea1, 0x1ef0, 0xdf41, 0x1f10, 0x1fe0, 0xdfb1, 0xdc81, 0x1cd0, 0x1c20, 0xdc71, 0x1dc0, 0xdd91, 0xdd61, 0x1d30,
+        0xdb01, 0x1b50, 0x1ba0, 0xdbf1, 0x1a40, 0xda11, 0xdae1, 0x1ab0, 0x1980, 0xd9d1, 0xd921, 0x1970, 0xd8c1, 0x1890, 0x1860, 0xd831,
+        0xe801, 0x2850, 0x28a0, 0xe8f1, 0x2940, 0xe911, 0xe9e1, 0x29b0, 0x2a80, 0xead1, 0xea21, 0x2a70, 0xebc1, 0x2b90, 0x2b60, 0xeb31,
+        0x2d00, 0xed51, 0xeda1, 0x2df0, 0xec41, 0x2c10, 0x2ce0, 0xecb1, 0xef81, 0x2fd0, 0x2f20, 0xef71, 0x2ec0, 0xee91, 0xee61, 0x2e30,
+        0x2200, 0xe251, 0xe2a1, 0x22f0, 0xe341, 0x2310, 0x23e0, 0xe3b1, 0xe081, 0x20d0, 0x2020, 0xe071, 0x21c0, 0xe191, 0xe161, 0x2130,
+        0xe701, 0x2750, 0x27a0, 0xe7f1, 0x2640, 0xe611, 0xe6e1, 0x26b0, 0x2580, 0xe5d1, 0xe521, 0x2570, 0xe4c1, 0x2490, 0x2460, 0xe431,
+        0x3c00, 0xfc51, 0xfca1, 0x3cf0, 0xfd41, 0x3d10, 0x3de0, 0xfdb1, 0xfe81, 0x3ed0, 0x3e20, 0xfe71, 0x3fc0, 0xff91, 0xff61, 0x3f30,
+        0xf901, 0x3950, 0x39a0, 0xf9f1, 0x3840, 0xf811, 0xf8e1, 0x38b0, 0x3b80, 0xfbd1, 0xfb21, 0x3b70, 0xfac1, 0x3a90, 0x3a60, 0xfa31,
+        0xf601, 0x3650, 0x36a0, 0xf6f1, 0x3740, 0xf711, 0xf7e1, 0x37b0, 0x3480, 0xf4d1, 0xf421, 0x3470, 0xf5c1, 0x3590, 0x3560, 0xf531,
+        0x3300, 0xf351, 0xf3a1, 0x33f0, 0xf241, 0x3210, 0x32e0, 0xf2b1, 0xf181, 0x31d0, 0x3120, 0xf171, 0x30c0, 0xf091, 0xf061, 0x3030,
+    },
+    {
+        0x0000, 0xfc01, 0xb801, 0x4400, 0x3001, 0xcc00, 0x8800, 0x7401, 0x6002, 0x9c03, 0xd803, 0x2402, 0x5003, 0xac02, 0xe802, 0x1403,
+        0xc004, 0x3c05, 0x7805, 0x8404, 0xf005, 0x0c04, 0x4804, 0xb405, 0xa006, 0x5c07, 0x1807, 0xe406, 0x9007, 0x6c06, 0x2806, 0xd407,
+        0xc00b, 0x3c0a, 0x780a, 0x840b, 0xf00a, 0x0c0b, 0x480b, 0xb40a, 0xa009, 0x5c08, 0x1808, 0xe409, 0x9008, 0x6c09, 0x2809, 0xd408,
+        0x000f, 0xfc0e, 0xb80e, 0x440f, 0x300e, 0xcc0f, 0x880f, 0x740e, 0x600d, 0x9c0c, 0xd80c, 0x240d, 0x500c, 0xac0d, 0xe80d, 0x140c,
+        0xc015, 0x3c14, 0x7814, 0x8415, 0xf014, 0x0c15, 0x4815, 0xb414, 0xa017, 0x5c16, 0x1816, 0xe417, 0x9016, 0x6c17, 0x2817, 0xd416,
+        0x0011, 0xfc10, 0xb810, 0x4411, 0x3010, 0xcc11, 0x8811, 0x7410, 0x6013, 0x9c12, 0xd812, 0x2413, 0x5012, 0xac13, 0xe813, 0x1412,
+        0x001e, 0xfc1f, 0xb81f, 0x441e, 0x301f, 0xcc1e, 0x881e, 0x741f, 0x601c, 0x9c1d, 0xd81d, 0x241c, 0x501d, 0xac1c, 0xe81c, 0x141d,
+        0xc01a, 0x3c1b, 0x781b, 0x841a, 0xf01b, 0x0c1a, 0x481a, 0xb41b, 0xa018, 0x5c19, 0x1819, 0xe418, 0x9019, 0x6c18, 0x2818, 0xd419,
+        0xc029, 0x3c28, 0x7828, 0x8429, 0xf028, 0x0c29, 0x4829, 0xb428, 0xa02b, 0x5c2a, 0x182a, 0xe42b, 0x902a, 0x6c2b, 0x282b, 0xd42a,
+        0x002d, 0xfc2c, 0xb82c, 0x442d, 0x302c, 0xcc2d, 0x882d, 0x742c, 0x602f, 0x9c2e, 0xd82e, 0x242f, 0x502e, 0xac2f, 0xe82f, 0x142e,
+        0x0022, 0xfc23, 0xb823, 0x4422, 0x3023, 0xcc22, 0x8822, 0x7423, 0x6020, 0x9c21, 0xd821, 0x2420, 0x5021, 0xac20, 0xe820, 0x1421,
+        0xc026, 0x3c27, 0x7827, 0x8426, 0xf027, 0x0c26, 0x4826, 0xb427, 0xa024, 0x5c25, 0x1825, 0xe424, 0x9025, 0x6c24, 0x2824, 0xd425,
+        0x003c, 0xfc3d, 0xb83d, 0x443c, 0x303d, 0xcc3c, 0x883c, 0x743d, 0x603e, 0x9c3f, 0xd83f, 0x243e, 0x503f, 0xac3e, 0xe83e, 0x143f,
+        0xc038, 0x3c39, 0x7839, 0x8438, 0xf039, 0x0c38, 0x4838, 0xb439, 0xa03a, 0x5c3b, 0x183b, 0xe43a, 0x903b, 0x6c3a, 0x283a, 0xd43b,
+        0xc037, 0x3c36, 0x7836, 0x8437, 0xf036, 0x0c37, 0x4837, 0xb436, 0xa035, 0x5c34, 0x1834, 0xe435, 0x9034, 0x6c35, 0x2835, 0xd434,
+        0x0033, 0xfc32, 0xb832, 0x4433, 0x3032, 0xcc33, 0x8833, 0x7432, 0x6031, 0x9c30, 0xd830, 0x2431, 0x5030, 0xac31, 0xe831, 0x1430,
+    },
+    {
+        0x0000, 0xc03d, 0xc079, 0x0044, 0xc0f1, 0x00cc, 0x0088, 0xc0b5, 0xc1e1, 0x01dc, 0x0198, 0xc1a5, 0x0110, 0xc12d, 0xc169, 0x0154,
+        0xc3c1, 0x03fc, 0x03b8, 0xc385, 0x0330, 0xc30d, 0xc349, 0x0374, 0x0220, 0xc21d, 0xc259, 0x0264, 0xc2d1, 0x02ec, 0x02a8, 0xc295,
+        0xc781, 0x07bc, 0x07f8, 0xc7c5, 0x0770, 0xc74d, 0xc709, 0x0734, 0x0660, 0xc65d, 0xc619, 0x0624, 0xc691, 0x06ac, 0x06e8, 0xc6d5,
+        0x0440, 0xc47d, 0xc439, 0x0404, 0xc4b1, 0x048c, 0x04c8, 0xc4f5, 0xc5a1, 0x059c, 0x05d8, 0xc5e5, 0x0550, 0xc56d, 0xc529, 0x0514,
+        0xcf01, 0x0f3c, 0x0f78, 0xcf45, 0x0ff0, 0xcfcd, 0xcf89, 0x0fb4, 0x0ee0, 0xcedd, 0xce99, 0x0ea4, 0xce11, 0x0e2c, 0x0e68, 0xce55,
+        0x0cc0, 0xccfd, 0xccb9, 0x0c84, 0xcc31, 0x0c0c, 0x0c48, 0xcc75, 0xcd21, 0x0d1c, 0x0d58, 0xcd65, 0x0dd0, 0xcded, 0xcda9, 0x0d94,
+        0x0880, 0xc8bd, 0xc8f9, 0x08c4, 0xc871, 0x084c, 0x0808, 0xc835, 0xc961, 0x095c, 0x0918, 0xc925, 0x0990, 0xc9ad, 0xc9e9, 0x09d4,
+        0xcb41, 0x0b7c, 0x0b38, 0xcb05, 0x0bb0, 0xcb8d, 0xcbc9, 0x0bf4, 0x0aa0, 0xca9d, 0xcad9, 0x0ae4, 0xca51, 0x0a6c, 0x0a28, 0xca15,
+        0xde01, 0x1e3c, 0x1e78, 0xde45, 0x1ef0, 0xdecd, 0xde89, 0x1eb4, 0x1fe0, 0xdfdd, 0xdf99, 0x1fa4, 0xdf11, 0x1f2c, 0x1f68, 0xdf55,
+        0x1dc0, 0xddfd, 0xddb9, 0x1d84, 0xdd31, 0x1d0c, 0x1d48, 0xdd75, 0xdc21, 0x1c1c, 0x1c58, 0xdc65, 0x1cd0, 0xdced, 0xdca9, 0x1c94,
+        0x1980, 0xd9bd, 0xd9f9, 0x19c4, 0xd971, 0x194c, 0x1908, 0xd935, 0xd861, 0x185c, 0x1818, 0xd825, 0x1890, 0xd8ad, 0xd8e9, 0x18d4,
+        0xda41, 0x1a7c, 0x1a38, 0xda05, 0x1ab0, 0xda8d, 0xdac9, 0x1af4, 0x1ba0, 0xdb9d, 0xdbd9, 0x1be4, 0xdb51, 0x1b6c, 0x1b28, 0xdb15,
+        0x1100, 0xd13d, 0xd179, 0x1144, 0xd1f1, 0x11cc, 0x1188, 0xd1b5, 0xd0e1, 0x10dc, 0x1098, 0xd0a5, 0x1010, 0xd02d, 0xd069, 0x1054,
+        0xd2c1, 0x12fc, 0x12b8, 0xd285, 0x1230, 0xd20d, 0xd249, 0x1274, 0x1320, 0xd31d, 0xd359, 0x1364, 0xd3d1, 0x13ec, 0x13a8, 0xd395,
+        0xd681, 0x16bc, 0x16f8, 0xd6c5, 0x1670, 0xd64d, 0xd609, 0x1634, 0x1760, 0xd75d, 0xd719, 0x1724, 0xd791, 0x17ac, 0x17e8, 0xd7d5,
+        0x1540, 0xd57d, 0xd539, 0x1504, 0xd5b1, 0x158c, 0x15c8, 0xd5f5, 0xd4a1, 0x149c, 0x14d8, 0xd4e5, 0x1450, 0xd46d, 0xd429, 0x1414,
+    },
+    {
+        0x0000, 0xd101, 0xe201, 0x3300, 0x8401, 0x5500, 0x6600, 0xb701, 0x4801, 0x9900, 0xaa00, 0x7b01, 0xcc00, 0x1d01, 0x2e01, 0xff00,
+        0x9002, 0x4103, 0x7203, 0xa302, 0x1403, 0xc502, 0xf602, 0x2703, 0xd803, 0x0902, 0x3a02, 0xeb03, 0x5c02, 0x8d03, 0xbe03, 0x6f02,
+        0x6007, 0xb106, 0x8206, 0x5307, 0xe406, 0x3507, 0x0607, 0xd706, 0x2806, 0xf907, 0xca07, 0x1b06, 0xac07, 0x7d06, 0x4e06, 0x9f07,
+        0xf005, 0x2104, 0x1204, 0xc305, 0x7404, 0xa505, 0x9605, 0x4704, 0xb804, 0x6905, 0x5a05, 0x8b04, 0x3c05, 0xed04, 0xde04, 0x0f05,
+        0xc00e, 0x110f, 0x220f, 0xf30e, 0x440f, 0x950e, 0xa60e, 0x770f, 0x880f, 0x590e, 0x6a0e, 0xbb0f, 0x0c0e, 0xdd0f, 0xee0f, 0x3f0e,
+        0x500c, 0x810d, 0xb20d, 0x630c, 0xd40d, 0x050c, 0x360c, 0xe70d, 0x180d, 0xc90c, 0xfa0c, 0x2b0d, 0x9c0c, 0x4d0d, 0x7e0d, 0xaf0c,
+        0xa009, 0x7108, 0x4208, 0x9309, 0x2408, 0xf509, 0xc609, 0x1708, 0xe808, 0x3909, 0x0a09, 0xdb08, 0x6c09, 0xbd08, 0x8e08, 0x5f09,
+        0x300b, 0xe10a, 0xd20a, 0x030b, 0xb40a, 0x650b, 0x560b, 0x870a, 0x780a, 0xa90b, 0x9a0b, 0x4b0a, 0xfc0b, 0x2d0a, 0x1e0a, 0xcf0b,
+        0xc01f, 0x111e, 0x221e, 0xf31f, 0x441e, 0x951f, 0xa61f, 0x771e, 0x881e, 0x591f, 0x6a1f, 0xbb1e, 0x0c1f, 0xdd1e, 0xee1e, 0x3f1f,
+        0x501d, 0x811c, 0xb21c, 0x631d, 0xd41c, 0x051d, 0x361d, 0xe71c, 0x181c, 0xc91d, 0xfa1d, 0x2b1c, 0x9c1d, 0x4d1c, 0x7e1c, 0xaf1d,
+        0xa018, 0x7119, 0x4219, 0x9318, 0x2419, 0xf518, 0xc618, 0x1719, 0xe819, 0x3918, 0x0a18, 0xdb19, 0x6c18, 0xbd19, 0x8e19, 0x5f18,
+        0x301a, 0xe11b, 0xd21b, 0x031a, 0xb41b, 0x651a, 0x561a, 0x871b, 0x781b, 0xa91a, 0x9a1a, 0x4b1b, 0xfc1a, 0x2d1b, 0x1e1b, 0xcf1a,
+        0x0011, 0xd110, 0xe210, 0x3311, 0x8410, 0x5511, 0x6611, 0xb710, 0x4810, 0x9911, 0xaa11, 0x7b10, 0xcc11, 0x1d10, 0x2e10, 0xff11,
+        0x9013, 0x4112, 0x7212, 0xa313, 0x1412, 0xc513, 0xf613, 0x2712, 0xd812, 0x0913, 0x3a13, 0xeb12, 0x5c13, 0x8d12, 0xbe12, 0x6f13,
+        0x6016, 0xb117, 0x8217, 0x5316, 0xe417, 0x3516, 0x0616, 0xd717, 0x2817, 0xf916, 0xca16, 0x1b17, 0xac16, 0x7d17, 0x4e17, 0x9f16,
+        0xf014, 0x2115, 0x1215, 0xc314, 0x7415, 0xa514, 0x9614, 0x4715, 0xb815, 0x6914, 0x5a14, 0x8b15, 0x3c14, 0xed15, 0xde15, 0x0f14,
+    },
+    {
+        0x0000, 0xc010, 0xc023, 0x0033, 0xc045, 0x0055, 0x0066, 0xc076, 0xc089, 0x0099, 0x00aa, 0xc0ba, 0x00cc, 0xc0dc, 0xc0ef, 0x00ff,
+        0xc111, 0x0101, 0x0132, 0xc122, 0x0154, 0xc144, 0xc177, 0x0167, 0x0198, 0xc188, 0xc1bb, 0x01ab, 0xc1dd, 0x01cd, 0x01fe, 0xc1ee,
+        0xc221, 0x0231, 0x0202, 0xc212, 0x0264, 0xc274, 0xc247, 0x0257, 0x02a8, 0xc2b8, 0xc28b, 0x029b, 0xc2ed, 0x02fd, 0x02ce, 0xc2de,
+        0x0330, 0xc320, 0xc313, 0x0303, 0xc375, 0x0365, 0x0356, 0xc346, 0xc3b9, 0x03a9, 0x039a, 0xc38a, 0x03fc, 0xc3ec, 0xc3df, 0x03cf,
+        0xc441, 0x0451, 0x0462, 0xc472, 0x0404, 0xc414, 0xc427, 0x0437, 0x04c8, 0xc4d8, 0xc4eb, 0x04fb, 0xc48d, 0x049d, 0x04ae, 0xc4be,
+        0x0550, 0xc540, 0xc573, 0x0563, 0xc515, 0x0505, 0x0536, 0xc526, 0xc5d9, 0x05c9, 0x05fa, 0xc5ea, 0x059c, 0xc58c, 0xc5bf, 0x05af,
+        0x0660, 0xc670, 0xc643, 0x0653, 0xc625, 0x0635, 0x0606, 0xc616, 0xc6e9, 0x06f9, 0x06ca, 0xc6da, 0x06ac, 0xc6bc, 0xc68f, 0x069f,
+        0xc771, 0x0761, 0x0752, 0xc742, 0x0734, 0xc724, 0xc717, 0x0707, 0x07f8, 0xc7e8, 0xc7db, 0x07cb, 0xc7bd, 0x07ad, 0x079e, 0xc78e,
+        0xc881, 0x0891, 0x08a2, 0xc8b2, 0x08c4, 0xc8d4, 0xc8e7, 0x08f7, 0x0808, 0xc818, 0xc82b, 0x083b, 0xc84d, 0x085d, 0x086e, 0xc87e,
+        0x0990, 0xc980, 0xc9b3, 0x09a3, 0xc9d5, 0x09c5, 0x09f6, 0xc9e6, 0xc919, 0x0909, 0x093a, 0xc92a, 0x095c, 0xc94c, 0xc97f, 0x096f,
+        0x0aa0, 0xcab0, 0xca83, 0x0a93, 0xcae5, 0x0af5, 0x0ac6, 0xcad6, 0xca29, 0x0a39, 0x0a0a, 0xca1a, 0x0a6c, 0xca7c, 0xca4f, 0x0a5f,
+        0xcbb1, 0x0ba1, 0x0b92, 0xcb82, 0x0bf4, 0xcbe4, 0xcbd7, 0x0bc7, 0x0b38, 0xcb28, 0xcb1b, 0x0b0b, 0xcb7d, 0x0b6d, 0x0b5e, 0xcb4e,
+        0x0cc0, 0xccd0, 0xcce3, 0x0cf3, 0xcc85, 0x0c95, 0x0ca6, 0xccb6, 0xcc49, 0x0c59, 0x0c6a, 0xcc7a, 0x0c0c, 0xcc1c, 0xcc2f, 0x0c3f,
+        0xcdd1, 0x0dc1, 0x0df2, 0xcde2, 0x0d94, 0xcd84, 0xcdb7, 0x0da7, 0x0d58, 0xcd48, 0xcd7b, 0x0d6b, 0xcd1d, 0x0d0d, 0x0d3e, 0xcd2e,
+        0xcee1, 0x0ef1, 0x0ec2, 0xced2, 0x0ea4, 0xceb4, 0xce87, 0x0e97, 0x0e68, 0xce78, 0xce4b, 0x0e5b, 0xce2d, 0x0e3d, 0x0e0e, 0xce1e,
+        0x0ff0, 0xcfe0, 0xcfd3, 0x0fc3, 0xcfb5, 0x0fa5, 0x0f96, 0xcf86, 0xcf79, 0x0f69, 0x0f5a, 0xcf4a, 0x0f3c, 0xcf2c, 0xcf1f, 0x0f0f,
+    },
+    {
+        0x0000, 0xccc1, 0xd981, 0x1540, 0xf301, 0x3fc0, 0x2a80, 0xe641, 0xa601, 0x6ac0, 0x7f80, 0xb341, 0x5500, 0x99c1, 0x8c81, 0x4040,
+        0x0c01, 0xc0c0, 0xd580, 0x1941, 0xff00, 0x33c1, 0x2681, 0xea40, 0xaa00, 0x66c1, 0x7381, 0xbf40, 0x5901, 0x95c0, 0x8080, 0x4c41,
+        0x1802, 0xd4c3, 0xc183, 0x0d42, 0xeb03, 0x27c2, 0x3282, 0xfe43, 0xbe03, 0x72c2, 0x6782, 0xab43, 0x4d02, 0x81c3, 0x9483, 0x5842,
+        0x1403, 0xd8c2, 0xcd82, 0x0143, 0xe702, 0x2bc3, 0x3e83, 0xf242, 0xb202, 0x7ec3, 0x6b83, 0xa742, 0x4103, 0x8dc2, 0x9882, 0x5443,
+        0x3004, 0xfcc5, 0xe985, 0x2544, 0xc305, 0x0fc4, 0x1a84, 0xd645, 0x9605, 0x5ac4, 0x4f84, 0x8345, 0x6504, 0xa9c5, 0xbc85, 0x7044,
+        0x3c05, 0xf0c4, 0xe584, 0x2945, 0xcf04, 0x03c5, 0x1685, 0xda44, 0x9a04, 0x56c5, 0x4385, 0x8f44, 0x6905, 0xa5c4, 0xb084, 0x7c45,
+        0x2806, 0xe4c7, 0xf187, 0x3d46, 0xdb07, 0x17c6, 0x0286, 0xce47, 0x8e07, 0x42c6, 0x5786, 0x9b47, 0x7d06, 0xb1c7, 0xa487, 0x6846,
+        0x2407, 0xe8c6, 0xfd86, 0x3147, 0xd706, 0x1bc7, 0x0e87, 0xc246, 0x8206, 0x4ec7, 0x5b87, 0x9746, 0x7107, 0xbdc6, 0xa886, 0x6447,
+        0x6008, 0xacc9, 0xb989, 0x7548, 0x9309, 0x5fc8, 0x4a88, 0x8649, 0xc609, 0x0ac8, 0x1f88, 0xd349, 0x3508, 0xf9c9, 0xec89, 0x2048,
+        0x6c09, 0xa0c8, 0xb588, 0x7949, 0x9f08, 0x53c9, 0x4689, 0x8a48, 0xca08, 0x06c9, 0x1389, 0xdf48, 0x3909, 0xf5c8, 0xe088, 0x2c49,
+        0x780a, 0xb4cb, 0xa18b, 0x6d4a, 0x8b0b, 0x47ca, 0x528a, 0x9e4b, 0xde0b, 0x12ca, 0x078a, 0xcb4b, 0x2d0a, 0xe1cb, 0xf48b, 0x384a,
+        0x740b, 0xb8ca, 0xad8a, 0x614b, 0x870a, 0x4bcb, 0x5e8b, 0x924a, 0xd20a, 0x1ecb, 0x0b8b, 0xc74a, 0x210b, 0xedca, 0xf88a, 0x344b,
+        0x500c, 0x9ccd, 0x898d, 0x454c, 0xa30d, 0x6fcc, 0x7a8c, 0xb64d, 0xf60d, 0x3acc, 0x2f8c, 0xe34d, 0x050c, 0xc9cd, 0xdc8d, 0x104c,
+        0x5c0d, 0x90cc, 0x858c, 0x494d, 0xaf0c, 0x63cd, 0x768d, 0xba4c, 0xfa0c, 0x36cd, 0x238d, 0xef4c, 0x090d, 0xc5cc, 0xd08c, 0x1c4d,
+        0x480e, 0x84cf, 0x918f, 0x5d4e, 0xbb0f, 0x77ce, 0x628e, 0xae4f, 0xee0f, 0x22ce, 0x378e, 0xfb4f, 0x1d0e, 0xd1cf, 0xc48f, 0x084e,
+        0x440f, 0x88ce, 0x9d8e, 0x514f, 0xb70e, 0x7bcf, 0x6e8f, 0xa24e, 0xe20e, 0x2ecf, 0x3b8f, 0xf74e, 0x110f, 0xddce, 0xc88e, 0x044f,
+    },
+};
+#endif
+
 static uint16_t crc16_calc(uint8_t * data, uint16_t len){
-    uint16_t crc = 0;   // initial value = 0 
+    uint16_t crc = 0;   // initial value = 0
+#ifdef ENABLE_L2CAP_ERTM_FCS_SLICING_BY_8
+    while (len >= 8){
+        crc ^= (uint16_t) (data[0] | (data[1] << 8));
+        crc = crc16_table_slicing_by_8[6][crc & 0xff] ^ crc16_table_slicing_by_8[5][crc >> 8]
+            ^ crc16_table_slicing_by_8[4][data[2]]    ^ crc16_table_slicing_by_8[3][data[3]]
+            ^ crc16_table_slicing_by_8[2][data[4]]    ^ crc16_table_slicing_by_8[1][data[5]]
+            ^ crc16_table_slicing_by_8[0][data[6]]    ^ crc16_table[data[7]];
+        data += 8;
+        len  -= 8;
+    }
+#endif
     while (len--){
         crc = (crc >> 8) ^ crc16_table[ (crc ^ ((uint16_t) *data++)) & 0x00FF ];
     }
     return crc;
 }
 
-static inline uint16_t l2cap_encanced_control_field_for_information_frame(uint8_t tx_seq, int final, uint8_t req_seq, l2cap_segmentation_and_reassembly_t sar){
-    return (((uint16_t) sar) << 14) | (req_seq << 8) | (final << 7) | (tx_seq << 1) | 0; 
+// I-Frames are stored with room for HCI pre-buffer, ACL and L2CAP header, Extended Control Field and FCS
+// to send them without copy if they fit into a single ACL packet
+#define L2CAP_ERTM_TX_FRAME_HEADER_SIZE (HCI_OUTGOING_PRE_BUFFER_SIZE + COMPLETE_L2CAP_HEADER + 4)
+#define L2CAP_ERTM_TX_FRAME_OVERHEAD    (L2CAP_ERTM_TX_FRAME_HEADER_SIZE + 2)
+
+static uint8_t * l2cap_ertm_tx_payload(l2cap_channel_t * channel, int index){
+    return &channel->tx_packets_data[(index * (channel->local_mps + L2CAP_ERTM_TX_FRAME_OVERHEAD)) + L2CAP_ERTM_TX_FRAME_HEADER_SIZE];
+}
+
+// Enhanced Control Field (16 bit) or Extended Control Field (32 bit) if Extended Window Size option is used
+static uint16_t l2cap_ertm_control_field_size(l2cap_channel_t * channel){
+    return channel->extended_control ? 4 : 2;
 }
 
-static inline uint16_t l2cap_encanced_control_field_for_supevisor_frame(l2cap_supervisory_function_t supervisory_function, int poll, int final, uint8_t req_seq){
-    return (req_seq << 8) | (final << 7) | (poll << 4) | (((int) supervisory_function) << 2) | 1; 
+static uint16_t l2cap_ertm_seq_nr_mask(l2cap_channel_t * channel){
+    return channel->extended_control ? 0x3fff : 0x3f;
 }
 
-static int l2cap_next_ertm_seq_nr(int seq_nr){
-    return (seq_nr + 1) & 0x3f;
+static inline uint32_t l2cap_encanced_control_field_for_information_frame(l2cap_channel_t * channel, uint16_t tx_seq, int final, uint16_t req_seq, l2cap_segmentation_and_reassembly_t sar){
+    if (channel->extended_control){
+        return (((uint32_t) tx_seq) << 18) | (((uint32_t) sar) << 16) | (((uint32_t) req_seq) << 2) | (final << 1) | 0;
+    }
+    return (((uint16_t) sar) << 14) | (req_seq << 8) | (final << 7) | (tx_seq << 1) | 0;
+}
+
+static inline uint32_t l2cap_encanced_control_field_for_supevisor_frame(l2cap_channel_t * channel, l2cap_supervisory_function_t supervisory_function, int poll, int final, uint16_t req_seq){
+    if (channel->extended_control){
+        return (((uint32_t) poll) << 18) | (((uint32_t) supervisory_function) << 16) | (((uint32_t) req_seq) << 2) | (final << 1) | 1;
+    }
+    return (req_seq << 8) | (final << 7) | (poll << 4) | (((int) supervisory_function) << 2) | 1;
+}
+
+static void l2cap_ertm_store_control_field(l2cap_channel_t * channel, uint8_t * acl_buffer, uint32_t control){
+    if (channel->extended_control){
+        little_endian_store_32(acl_buffer, COMPLETE_L2CAP_HEADER, control);
+    } else {
+        little_endian_store_16(acl_buffer, COMPLETE_L2CAP_HEADER, (uint16_t) control);
+    }
+}
+
+static uint16_t l2cap_next_ertm_seq_nr(l2cap_channel_t * channel, uint16_t seq_nr){
+    return (seq_nr + 1) & l2cap_ertm_seq_nr_mask(channel);
 }
 
 static int l2cap_ertm_can_store_packet_now(l2cap_channel_t * channel){
     // get num free tx buffers
     int num_free_tx_buffers = channel->num_tx_buffers - channel->num_stored_tx_frames;
+    // don't overwrite tx buffer of I-Frame that is still in transit
+    if (channel->tx_frame_in_transit && hci_is_packet_buffer_reserved()){
+        int num_tx_buffers_before_in_transit = channel->tx_frame_in_transit_index - channel->tx_write_index;
+        if (num_tx_buffers_before_in_transit < 0){
+            num_tx_buffers_before_in_transit += channel->num_tx_buffers;
+        }
+        num_free_tx_buffers = btstack_min(num_free_tx_buffers, num_tx_buffers_before_in_transit);
+    }
     // calculate num tx buffers for remote MTU
     int num_tx_buffers_for_max_remote_mtu;
     uint16_t effective_mps = btstack_min(channel->remote_mps, channel->local_mps);
@@ -285,6 +489,8 @@ static void l2cap_ertm_retransmit_unacknowleded_frames(l2cap_channel_t * l2cap_c
     log_info("Retransmit unacknowleged frames");
     l2cap_channel->unacked_frames = 0;;
     l2cap_channel->tx_send_index  = l2cap_channel->tx_read_index;
+    // don't wait for next HCI event
+    l2cap_notify_channel_can_send();
 }
 
 static void l2cap_ertm_next_tx_write_index(l2cap_channel_t * channel){
@@ -334,9 +540,6 @@ static void l2cap_ertm_monitor_timeout_callback(btstack_timer_source_t * ts){
         // increment retry count
         tx_state->retry_count++;
 
-        // start retransmit
-        l2cap_ertm_retransmit_unacknowleded_frames(l2cap_channel);
-
         // start monitor timer
         l2cap_ertm_start_monitor_timer(l2cap_channel);
 
@@ -360,8 +563,7 @@ static void l2cap_ertm_retransmission_timeout_callback(btstack_timer_source_t *
     // set retry count = 1
     tx_state->retry_count = 1;
 
-    // start retransmit
-    l2cap_ertm_retransmit_unacknowleded_frames(l2cap_channel);
+    // unacknowledged frames are retransmitted on poll response, receiver might have stored them already
 
     // start monitor timer
     l2cap_ertm_start_monitor_timer(l2cap_channel);
@@ -373,18 +575,29 @@ static void l2cap_ertm_retransmission_timeout_callback(btstack_timer_source_t *
 
 static int l2cap_ertm_send_information_frame(l2cap_channel_t * channel, int index, int final){
     l2cap_ertm_tx_packet_state_t * tx_state = &channel->tx_packets_state[index];
-    hci_reserve_packet_buffer();
-    uint8_t *acl_buffer = hci_get_outgoing_packet_buffer();
-    uint16_t control = l2cap_encanced_control_field_for_information_frame(tx_state->tx_seq, final, channel->req_seq, tx_state->sar);
-    log_info("I-Frame: control 0x%04x", control);
-    little_endian_store_16(acl_buffer, 8, control);
-    (void)memcpy(&acl_buffer[8 + 2],
-                 &channel->tx_packets_data[index * channel->local_mps],
-                 tx_state->len);
-    // (re-)start retransmission timer on 
+    uint32_t control = l2cap_encanced_control_field_for_information_frame(channel, tx_state->tx_seq, final, channel->req_seq, tx_state->sar);
+    log_info("I-Frame: tx_seq %u, req_seq %u, final %u", tx_state->tx_seq, channel->req_seq, final);
+    uint16_t control_size = l2cap_ertm_control_field_size(channel);
+    uint16_t fcs_size = channel->fcs_option ? 2 : 0;
+    uint16_t len = control_size + tx_state->len;
+    uint8_t * payload = l2cap_ertm_tx_payload(channel, index);
+    // (re-)start retransmission timer on
     l2cap_ertm_start_retransmission_timer(channel);
+    hci_reserve_packet_buffer();
+    uint8_t *acl_buffer;
+    if ((L2CAP_HEADER_SIZE + len + fcs_size) <= hci_max_acl_data_packet_length()){
+        // send from tx buffer
+        acl_buffer = payload - (COMPLETE_L2CAP_HEADER + control_size);
+        channel->tx_frame_in_transit = 1;
+        channel->tx_frame_in_transit_index = index;
+    } else {
+        // copy into outgoing packet buffer for fragmentation
+        acl_buffer = hci_get_outgoing_packet_buffer();
+        (void)memcpy(&acl_buffer[COMPLETE_L2CAP_HEADER + control_size], payload, tx_state->len);
+    }
+    l2cap_ertm_store_control_field(channel, acl_buffer, control);
     // send
-    return l2cap_send_prepared(channel->local_cid, 2 + tx_state->len);
+    return l2cap_channel_send_prepared(channel, acl_buffer, len);
 }
 
 static void l2cap_ertm_store_fragment(l2cap_channel_t * channel, l2cap_segmentation_and_reassembly_t sar, uint16_t sdu_length, uint8_t * data, uint16_t len){
@@ -396,7 +609,7 @@ static void l2cap_ertm_store_fragment(l2cap_channel_t * channel, l2cap_segmentat
     tx_state->sar = sar;
     tx_state->retry_count = 0;
 
-    uint8_t * tx_packet = &channel->tx_packets_data[index * channel->local_mps];
+    uint8_t * tx_packet = l2cap_ertm_tx_payload(channel, index);
     log_debug("index %u, local mps %u, remote mps %u, packet tx %p, len %u", index, channel->local_mps, channel->remote_mps, tx_packet, len);
     int pos = 0;
     if (sar == L2CAP_SEGMENTATION_AND_REASSEMBLY_START_OF_L2CAP_SDU){
@@ -408,7 +621,7 @@ static void l2cap_ertm_store_fragment(l2cap_channel_t * channel, l2cap_segmentat
 
     // update
     channel->num_stored_tx_frames++;
-    channel->next_tx_seq = l2cap_next_ertm_seq_nr(channel->next_tx_seq);
+    channel->next_tx_seq = l2cap_next_ertm_seq_nr(channel, channel->next_tx_seq);
     l2cap_ertm_next_tx_write_index(channel);
 
     log_info("l2cap_ertm_store_fragment: tx_read_index %u, tx_write_index %u, num stored %u", channel->tx_read_index, channel->tx_write_index, channel->num_stored_tx_frames);
@@ -438,6 +651,7 @@ static int l2cap_ertm_send(l2cap_channel_t * channel, uint8_t * data, uint16_t l
                     chunk_len = effective_mps - 2;    // sdu_length
                     l2cap_ertm_store_fragment(channel, sar, len, data, chunk_len);
                     len -= chunk_len;
+                    data += chunk_len;
                     sar = L2CAP_SEGMENTATION_AND_REASSEMBLY_CONTINUATION_OF_L2CAP_SDU;
                     break;
                 case L2CAP_SEGMENTATION_AND_REASSEMBLY_CONTINUATION_OF_L2CAP_SDU:
@@ -448,6 +662,7 @@ static int l2cap_ertm_send(l2cap_channel_t * channel, uint8_t * data, uint16_t l
                     }
                     l2cap_ertm_store_fragment(channel, sar, len, data, chunk_len);
                     len -= chunk_len;
+                    data += chunk_len;
                     break;
                 default:
                     break;
@@ -468,7 +683,7 @@ static uint16_t l2cap_setup_options_ertm_request(l2cap_channel_t * channel, uint
     config_options[pos++] = L2CAP_CONFIG_OPTION_TYPE_RETRANSMISSION_AND_FLOW_CONTROL;
     config_options[pos++] = 9;      // length
     config_options[pos++] = (uint8_t) channel->mode;
-    config_options[pos++] = channel->num_rx_buffers;    // == TxWindows size
+    config_options[pos++] = (uint8_t) btstack_min(channel->num_rx_buffers, 63);    // == TxWindows size
     config_options[pos++] = channel->local_max_transmit;
     little_endian_store_16( config_options, pos, channel->local_retransmission_timeout_ms);
     pos += 2;
@@ -487,7 +702,16 @@ static uint16_t l2cap_setup_options_ertm_request(l2cap_channel_t * channel, uint
     config_options[pos++] = L2CAP_CONFIG_OPTION_TYPE_FRAME_CHECK_SEQUENCE;
     config_options[pos++] = 1;     // length
     config_options[pos++] = channel->fcs_option;
-    return pos; // 11+4+3=18
+
+    // Extended Window Size for TxWindow > 63 if supported by remote, both sides use the Extended Control Field then
+    if (l2cap_ertm_extended_window_size_supported(channel) && (channel->num_rx_buffers > 63)){
+        channel->extended_control = 1;
+        config_options[pos++] = L2CAP_CONFIG_OPTION_TYPE_EXTENDED_WINDOW_SIZE;
+        config_options[pos++] = 2;     // length
+        little_endian_store_16(config_options, pos, btstack_min(channel->num_rx_buffers, 0x3fff));
+        pos += 2;
+    }
+    return pos; // 11+4+3+4=22
 }
 
 static uint16_t l2cap_setup_options_ertm_response(l2cap_channel_t * channel, uint8_t * config_options){
@@ -496,7 +720,7 @@ static uint16_t l2cap_setup_options_ertm_response(l2cap_channel_t * channel, uin
     config_options[pos++] = 9;      // length
     config_options[pos++] = (uint8_t) channel->mode;
     // less or equal to remote tx window size
-    config_options[pos++] = btstack_min(channel->num_tx_buffers, channel->remote_tx_window_size);
+    config_options[pos++] = (uint8_t) btstack_min(btstack_min(channel->num_tx_buffers, channel->remote_tx_window_size), 63);
     // max transmit in response shall be ignored -> use sender values
     config_options[pos++] = channel->remote_max_transmit;
     // A value for the Retransmission time-out shall be sent in a positive Configuration Response
@@ -525,12 +749,11 @@ static uint16_t l2cap_setup_options_ertm_response(l2cap_channel_t * channel, uin
     return pos; // 11+4=15
 }
 
-static int l2cap_ertm_send_supervisor_frame(l2cap_channel_t * channel, uint16_t control){
+static int l2cap_ertm_send_supervisor_frame(l2cap_channel_t * channel, uint32_t control){
     hci_reserve_packet_buffer();
     uint8_t *acl_buffer = hci_get_outgoing_packet_buffer();
-    log_info("S-Frame: control 0x%04x", control);
-    little_endian_store_16(acl_buffer, 8, control);
-    return l2cap_send_prepared(channel->local_cid, 2);
+    l2cap_ertm_store_control_field(channel, acl_buffer, control);
+    return l2cap_send_prepared(channel->local_cid, l2cap_ertm_control_field_size(channel));
 }
 
 static uint8_t l2cap_ertm_validate_local_config(l2cap_ertm_config_t * ertm_config){
@@ -586,12 +809,17 @@ static void l2cap_ertm_configure_channel(l2cap_channel_t * channel, l2cap_ertm_c
     channel->tx_packets_state = (l2cap_ertm_tx_packet_state_t *) (void *) &buffer[pos];
     pos += ertm_config->num_tx_buffers * sizeof(l2cap_ertm_tx_packet_state_t);
 
+    // buffer might be re-used from a previous channel, clear stored frames
+    memset(buffer, 0, pos);
+
     // setup reassembly buffer
     channel->reassembly_buffer = &buffer[pos];
     pos += ertm_config->local_mtu;
 
-    // divide rest of data equally
-    channel->local_mps = (size - pos) / (ertm_config->num_rx_buffers + ertm_config->num_tx_buffers);
+    // divide rest of data equally, tx buffers additionally contain headers and fcs
+    uint32_t tx_frame_overhead = ertm_config->num_tx_buffers * L2CAP_ERTM_TX_FRAME_OVERHEAD;
+    uint32_t data_size = (size > (pos + tx_frame_overhead)) ? (size - pos - tx_frame_overhead) : 0;
+    channel->local_mps = data_size / (ertm_config->num_rx_buffers + ertm_config->num_tx_buffers);
     log_info("Local MPS: %u", channel->local_mps);
     channel->rx_packets_data = &buffer[pos];
     pos += ertm_config->num_rx_buffers * channel->local_mps;
@@ -648,6 +876,21 @@ static void l2cap_ertm_notify_channel_can_send(l2cap_channel_t * channel){
     }
 }
 
+static void l2cap_ertm_handle_transport_packet_sent(void){
+    btstack_linked_list_iterator_t it;
+    btstack_linked_list_iterator_init(&it, &l2cap_channels);
+    while (btstack_linked_list_iterator_has_next(&it)){
+        l2cap_channel_t * channel = (l2cap_channel_t *) btstack_linked_list_iterator_next(&it);
+        if (channel->channel_type != L2CAP_CHANNEL_TYPE_CLASSIC) continue;
+        if (!channel->tx_frame_in_transit) continue;
+        // tx buffer can be used again
+        channel->tx_frame_in_transit = 0;
+        if (channel->waiting_for_can_send_now){
+            l2cap_ertm_notify_channel_can_send(channel);
+        }
+    }
+}
+
 uint8_t l2cap_accept_ertm_connection(uint16_t local_cid, l2cap_ertm_config_t * ertm_config, uint8_t * buffer, uint32_t size){
 
     log_info("L2CAP_ACCEPT_ERTM_CONNECTION local_cid 0x%x", local_cid);
@@ -722,7 +965,7 @@ uint8_t l2cap_ertm_set_ready(uint16_t local_cid){
 }
 
 // Process-ReqSeq
-static void l2cap_ertm_process_req_seq(l2cap_channel_t * l2cap_channel, uint8_t req_seq){
+static void l2cap_ertm_process_req_seq(l2cap_channel_t * l2cap_channel, uint16_t req_seq){
     int num_buffers_acked = 0;
     l2cap_ertm_tx_packet_state_t * tx_state;
     log_info("l2cap_ertm_process_req_seq: tx_read_index %u, tx_write_index %u, req_seq %u", l2cap_channel->tx_read_index, l2cap_channel->tx_write_index, req_seq);
@@ -737,17 +980,18 @@ static void l2cap_ertm_process_req_seq(l2cap_channel_t * l2cap_channel, uint8_t
 
         tx_state = &l2cap_channel->tx_packets_state[l2cap_channel->tx_read_index];
         // calc delta
-        int delta = (req_seq - tx_state->tx_seq) & 0x03f;
+        int delta = (req_seq - tx_state->tx_seq) & l2cap_ertm_seq_nr_mask(l2cap_channel);
         if (delta == 0) break;  // all packets acknowledged
         if (delta > l2cap_channel->remote_tx_window_size) break;   
 
         num_buffers_acked++;
         l2cap_channel->num_stored_tx_frames--;
         l2cap_channel->unacked_frames--;
+        tx_state->retransmission_requested = 0;
         log_info("RR seq %u => packet with tx_seq %u done", req_seq, tx_state->tx_seq);
 
         l2cap_channel->tx_read_index++;
-        if (l2cap_channel->tx_read_index >= l2cap_channel->num_rx_buffers){
+        if (l2cap_channel->tx_read_index >= l2cap_channel->num_tx_buffers){
             l2cap_channel->tx_read_index = 0;
         }
     }
@@ -757,38 +1001,56 @@ static void l2cap_ertm_process_req_seq(l2cap_channel_t * l2cap_channel, uint8_t
 }     
 }     
 
-static l2cap_ertm_tx_packet_state_t * l2cap_ertm_get_tx_state(l2cap_channel_t * l2cap_channel, uint8_t tx_seq){
+// only unacknowledged frames can be retransmitted, buffers of acknowledged frames get reused
+static l2cap_ertm_tx_packet_state_t * l2cap_ertm_get_tx_state(l2cap_channel_t * l2cap_channel, uint16_t tx_seq){
+    int index = l2cap_channel->tx_read_index;
     int i;
-    for (i=0;i<l2cap_channel->num_tx_buffers;i++){
-        l2cap_ertm_tx_packet_state_t * tx_state = &l2cap_channel->tx_packets_state[i];
+    for (i=0;i<l2cap_channel->unacked_frames;i++){
+        l2cap_ertm_tx_packet_state_t * tx_state = &l2cap_channel->tx_packets_state[index];
         if (tx_state->tx_seq == tx_seq) return tx_state;
+        index++;
+        if (index >= l2cap_channel->num_tx_buffers){
+            index = 0;
+        }
     }
     return NULL;
 }
 
 // @param delta number of frames in the future, >= 1
-// @assumption size <= l2cap_channel->local_mps (checked in l2cap_acl_classic_handler)
 static void l2cap_ertm_handle_out_of_sequence_sdu(l2cap_channel_t * l2cap_channel, l2cap_segmentation_and_reassembly_t sar, int delta, const uint8_t * payload, uint16_t size){
     log_info("Store SDU with delta %u", delta);
     // get rx state for packet to store
-    int index = l2cap_channel->rx_store_index + delta - 1;
-    if (index > l2cap_channel->num_rx_buffers){
+    int index = l2cap_channel->rx_store_index + delta;
+    if (index >= l2cap_channel->num_rx_buffers){
         index -= l2cap_channel->num_rx_buffers;
     }
     log_info("Index of packet to store %u", index);
     l2cap_ertm_rx_packet_state_t * rx_state = &l2cap_channel->rx_packets_state[index];
     // check if buffer is free
     if (rx_state->valid){
-        log_error("Packet buffer already used");
+        log_info("Packet already stored");
+        return;
+    }
+    // check if packet fits into buffer
+    if (size > l2cap_channel->local_mps){
+        log_error("Packet larger than local MPS");
         return;
     }
     rx_state->valid = 1;
     rx_state->sar = sar;
     rx_state->len = size;
-    uint8_t * rx_buffer = &l2cap_channel->rx_packets_data[index];
+    l2cap_channel->num_stored_rx_frames++;
+    uint8_t * rx_buffer = &l2cap_channel->rx_packets_data[index * l2cap_channel->local_mps];
     (void)memcpy(rx_buffer, payload, size);
 }
 
+static void l2cap_ertm_next_rx_store_index(l2cap_channel_t * l2cap_channel){
+    l2cap_channel->rx_store_index++;
+    if (l2cap_channel->rx_store_index >= l2cap_channel->num_rx_buffers){
+        l2cap_channel->rx_store_index = 0;
+    }
+}
+
 // @assumption size <= l2cap_channel->local_mps (checked in l2cap_acl_classic_handler)
 static void l2cap_ertm_handle_in_sequence_sdu(l2cap_channel_t * l2cap_channel, l2cap_segmentation_and_reassembly_t sar, const uint8_t * payload, uint16_t size){
     uint16_t reassembly_sdu_length;
@@ -906,7 +1168,10 @@ void l2cap_init(void){
     // 
     // register callback with HCI
     //
+    // channels are driven by connection, security and ACL flow control events, skip scan results
+    btstack_event_filter_init_without_scan_results(&hci_event_filter);
     hci_event_callback_registration.callback = &l2cap_hci_event_handler;
+    hci_event_callback_registration.event_filter = &hci_event_filter;
     hci_add_event_handler(&hci_event_callback_registration);
 
     hci_register_acl_packet_handler(&l2cap_acl_handler);
@@ -1262,28 +1527,16 @@ static int l2cap_send_signaling_packet(hci_con_handle_t handle, L2CAP_SIGNALING_
     return hci_send_acl_packet_buffer(len);
 }
 
-// assumption - only on Classic connections
-// cannot be used for L2CAP ERTM
-int l2cap_send_prepared(uint16_t local_cid, uint16_t len){
-    
-    if (!hci_is_packet_buffer_reserved()){
-        log_error("l2cap_send_prepared called without reserving packet first");
-        return BTSTACK_ACL_BUFFERS_FULL;
-    }
-
-    l2cap_channel_t * channel = l2cap_get_channel_for_local_cid(local_cid);
-    if (!channel) {
-        log_error("l2cap_send_prepared no channel for cid 0x%02x", local_cid);
-        return -1;   // TODO: define error
-    }
+// pre: packet buffer reserved, acl_buffer is outgoing packet buffer or I-Frame in ERTM tx buffer
+static int l2cap_channel_send_prepared(l2cap_channel_t * channel, uint8_t * acl_buffer, uint16_t len){
 
     if (!hci_can_send_prepared_acl_packet_now(channel->con_handle)){
-        log_info("l2cap_send_prepared cid 0x%02x, cannot send", local_cid);
+        log_info("l2cap_send_prepared cid 0x%02x, cannot send", channel->local_cid);
         return BTSTACK_ACL_BUFFERS_FULL;
     }
-    
-    log_debug("l2cap_send_prepared cid 0x%02x, handle %u, 1 credit used", local_cid, channel->con_handle);
-    
+
+    log_debug("l2cap_send_prepared cid 0x%02x, handle %u, 1 credit used", channel->local_cid, channel->con_handle);
+
     int fcs_size = 0;
 
 #ifdef ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
@@ -1293,7 +1546,6 @@ int l2cap_send_prepared(uint16_t local_cid, uint16_t len){
 #endif
 
     // set non-flushable packet boundary flag if supported on Controller
-    uint8_t *acl_buffer = hci_get_outgoing_packet_buffer();
     uint8_t packet_boundary_flag = hci_non_flushable_packet_boundary_flag_supported() ? 0x00 : 0x02;
     l2cap_setup_header(acl_buffer, channel->con_handle, packet_boundary_flag, channel->remote_cid, len + fcs_size);
 
@@ -1304,12 +1556,34 @@ int l2cap_send_prepared(uint16_t local_cid, uint16_t len){
         log_info("I-Frame: fcs 0x%04x", fcs);
         little_endian_store_16(acl_buffer, 8 + len, fcs);
     }
+
+    if (acl_buffer != hci_get_outgoing_packet_buffer()){
+        return hci_send_acl_packet_external(acl_buffer, len+8+fcs_size);
+    }
 #endif
 
     // send
     return hci_send_acl_packet_buffer(len+8+fcs_size);
 }
 
+// assumption - only on Classic connections
+// cannot be used for L2CAP ERTM
+int l2cap_send_prepared(uint16_t local_cid, uint16_t len){
+
+    if (!hci_is_packet_buffer_reserved()){
+        log_error("l2cap_send_prepared called without reserving packet first");
+        return BTSTACK_ACL_BUFFERS_FULL;
+    }
+
+    l2cap_channel_t * channel = l2cap_get_channel_for_local_cid(local_cid);
+    if (!channel) {
+        log_error("l2cap_send_prepared no channel for cid 0x%02x", local_cid);
+        return -1;   // TODO: define error
+    }
+
+    return l2cap_channel_send_prepared(channel, hci_get_outgoing_packet_buffer(), len);
+}
+
 // assumption - only on Classic connections
 int l2cap_send(uint16_t local_cid, uint8_t *data, uint16_t len){
     l2cap_channel_t * channel = l2cap_get_channel_for_local_cid(local_cid);
@@ -1407,6 +1681,12 @@ static int l2cap_ertm_mode(l2cap_channel_t * channel){
     return ((connection->l2cap_state.information_state == L2CAP_INFORMATION_STATE_DONE) 
         &&  (connection->l2cap_state.extended_feature_mask & 0x08));
 }
+
+static int l2cap_ertm_extended_window_size_supported(l2cap_channel_t * channel){
+    hci_connection_t * connection = hci_connection_for_handle(channel->con_handle);
+    return ((connection->l2cap_state.information_state == L2CAP_INFORMATION_STATE_DONE)
+        &&  (connection->l2cap_state.extended_feature_mask & 0x100));
+}
 #endif
 
 static uint16_t l2cap_setup_options_request(l2cap_channel_t * channel, uint8_t * config_options){
@@ -1429,7 +1709,8 @@ static uint32_t l2cap_extended_features_mask(void){
     // extended features request supported, features: fixed channels, unicast connectionless data reception
     uint32_t features = 0x280;
 #ifdef ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
-    features |= 0x0028;
+    // Enhanced Retransmission Mode, FCS Option, Extended Window Size
+    features |= 0x0128;
 #endif
     return features;
 }
@@ -1442,7 +1723,7 @@ static uint32_t l2cap_extended_features_mask(void){
 static bool l2cap_run_for_classic_channel(l2cap_channel_t * channel){
 
 #ifdef ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
-    uint8_t  config_options[18];
+    uint8_t  config_options[22];
 #else
     uint8_t  config_options[10];
 #endif
@@ -1574,6 +1855,14 @@ static bool l2cap_run_for_classic_channel(l2cap_channel_t * channel){
 }
 
 #ifdef ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
+static void l2cap_ertm_send_receiver_ready_poll(l2cap_channel_t * channel){
+    log_info("Send S-Frame: RR %u with poll=1 ", channel->req_seq);
+    channel->waiting_for_final = 1;
+    channel->srej_save_req_seq_valid = 0;
+    uint32_t control = l2cap_encanced_control_field_for_supevisor_frame(channel, L2CAP_SUPERVISORY_FUNCTION_RR_RECEIVER_READY, 1, 0, channel->req_seq);
+    l2cap_ertm_send_supervisor_frame(channel, control);
+}
+
 static void l2cap_run_for_classic_channel_ertm(l2cap_channel_t * channel){
 
     // ERTM mode
@@ -1586,36 +1875,34 @@ static void l2cap_run_for_classic_channel_ertm(l2cap_channel_t * channel){
     if (channel->send_supervisor_frame_receiver_ready){
         channel->send_supervisor_frame_receiver_ready = 0;
         log_info("Send S-Frame: RR %u, final %u", channel->req_seq, channel->set_final_bit_after_packet_with_poll_bit_set);
-        uint16_t control = l2cap_encanced_control_field_for_supevisor_frame( L2CAP_SUPERVISORY_FUNCTION_RR_RECEIVER_READY, 0,  channel->set_final_bit_after_packet_with_poll_bit_set, channel->req_seq);
+        uint32_t control = l2cap_encanced_control_field_for_supevisor_frame(channel, L2CAP_SUPERVISORY_FUNCTION_RR_RECEIVER_READY, 0,  channel->set_final_bit_after_packet_with_poll_bit_set, channel->req_seq);
         channel->set_final_bit_after_packet_with_poll_bit_set = 0;
         l2cap_ertm_send_supervisor_frame(channel, control);
         return;
     }
     if (channel->send_supervisor_frame_receiver_ready_poll){
         channel->send_supervisor_frame_receiver_ready_poll = 0;
-        log_info("Send S-Frame: RR %u with poll=1 ", channel->req_seq);
-        uint16_t control = l2cap_encanced_control_field_for_supevisor_frame( L2CAP_SUPERVISORY_FUNCTION_RR_RECEIVER_READY, 1, 0, channel->req_seq);
-        l2cap_ertm_send_supervisor_frame(channel, control);
+        l2cap_ertm_send_receiver_ready_poll(channel);
         return;
     }
     if (channel->send_supervisor_frame_receiver_not_ready){
         channel->send_supervisor_frame_receiver_not_ready = 0;
         log_info("Send S-Frame: RNR %u", channel->req_seq);
-        uint16_t control = l2cap_encanced_control_field_for_supevisor_frame( L2CAP_SUPERVISORY_FUNCTION_RNR_RECEIVER_NOT_READY, 0, 0, channel->req_seq);
+        uint32_t control = l2cap_encanced_control_field_for_supevisor_frame(channel, L2CAP_SUPERVISORY_FUNCTION_RNR_RECEIVER_NOT_READY, 0, 0, channel->req_seq);
         l2cap_ertm_send_supervisor_frame(channel, control);
         return;
     }
     if (channel->send_supervisor_frame_reject){
         channel->send_supervisor_frame_reject = 0;
         log_info("Send S-Frame: REJ %u", channel->req_seq);
-        uint16_t control = l2cap_encanced_control_field_for_supevisor_frame( L2CAP_SUPERVISORY_FUNCTION_REJ_REJECT, 0, 0, channel->req_seq);
+        uint32_t control = l2cap_encanced_control_field_for_supevisor_frame(channel, L2CAP_SUPERVISORY_FUNCTION_REJ_REJECT, 0, 0, channel->req_seq);
         l2cap_ertm_send_supervisor_frame(channel, control);
         return;
     }
     if (channel->send_supervisor_frame_selective_reject){
         channel->send_supervisor_frame_selective_reject = 0;
         log_info("Send S-Frame: SREJ %u", channel->expected_tx_seq);
-        uint16_t control = l2cap_encanced_control_field_for_supevisor_frame( L2CAP_SUPERVISORY_FUNCTION_SREJ_SELECTIVE_REJECT, 0, channel->set_final_bit_after_packet_with_poll_bit_set, channel->expected_tx_seq);
+        uint32_t control = l2cap_encanced_control_field_for_supevisor_frame(channel, L2CAP_SUPERVISORY_FUNCTION_SREJ_SELECTIVE_REJECT, 0, channel->set_final_bit_after_packet_with_poll_bit_set, channel->expected_tx_seq);
         channel->set_final_bit_after_packet_with_poll_bit_set = 0;
         l2cap_ertm_send_supervisor_frame(channel, control);
         return;
@@ -1627,6 +1914,9 @@ static void l2cap_run_for_classic_channel_ertm(l2cap_channel_t * channel){
             l2cap_ertm_tx_packet_state_t * tx_state = &channel->tx_packets_state[i];
             if (tx_state->retransmission_requested) {
                 tx_state->retransmission_requested = 0;
+                if (tx_state->retry_count < 0xff){
+                    tx_state->retry_count++;
+                }
                 uint8_t final = channel->set_final_bit_after_packet_with_poll_bit_set;
                 channel->set_final_bit_after_packet_with_poll_bit_set = 0;
                 l2cap_ertm_send_information_frame(channel, i, final);
@@ -1641,6 +1931,17 @@ static void l2cap_run_for_classic_channel_ertm(l2cap_channel_t * channel){
             return;
         }
     }
+
+    // the receiver requests a missing frame only once. if the window is full and its oldest frame has been
+    // retransmitted, poll now instead of waiting for the retransmission timeout in case the retransmission got lost
+    if (channel->waiting_for_final) return;
+    if (channel->unacked_frames == 0) return;
+    if (channel->unacked_frames < channel->remote_tx_window_size) return;
+    if (channel->tx_packets_state[channel->tx_read_index].retry_count == 0) return;
+    log_info("Window full and oldest I-Frame retransmitted -> poll");
+    l2cap_ertm_stop_retransmission_timer(channel);
+    l2cap_ertm_start_monitor_timer(channel);
+    l2cap_ertm_send_receiver_ready_poll(channel);
 }
 #endif /* ERTM */
 #endif /* Classic */
@@ -1764,18 +2065,20 @@ static void l2cap_run_le_data_channels(void){
                 channel->state = L2CAP_STATE_WAIT_LE_CONNECTION_RESPONSE;
                 // le psm, source cid, mtu, mps, initial credits
                 channel->local_sig_id = l2cap_next_sig_id();
+                l2cap_le_init_credits(channel);
                 channel->credits_incoming =  channel->new_credits_incoming;
                 channel->new_credits_incoming = 0;
-                mps = btstack_min(l2cap_max_le_mtu(), channel->local_mtu);
+                mps = l2cap_le_local_mps(channel);
                 l2cap_send_le_signaling_packet( channel->con_handle, LE_CREDIT_BASED_CONNECTION_REQUEST, channel->local_sig_id, channel->psm, channel->local_cid, channel->local_mtu, mps, channel->credits_incoming);
                 break;
             case L2CAP_STATE_WILL_SEND_LE_CONNECTION_RESPONSE_ACCEPT:
                 if (!hci_can_send_acl_packet_now(channel->con_handle)) break;
                 // TODO: support larger MPS
                 channel->state = L2CAP_STATE_OPEN;
+                l2cap_le_init_credits(channel);
                 channel->credits_incoming =  channel->new_credits_incoming;
                 channel->new_credits_incoming = 0;
-                mps = btstack_min(l2cap_max_le_mtu(), channel->local_mtu);
+                mps = l2cap_le_local_mps(channel);
                 l2cap_send_le_signaling_packet(channel->con_handle, LE_CREDIT_BASED_CONNECTION_RESPONSE, channel->remote_sig_id, channel->local_cid, channel->local_mtu, mps, channel->credits_incoming, 0);
                 // notify client
                 l2cap_emit_le_channel_opened(channel, 0);
@@ -1798,6 +2101,8 @@ static void l2cap_run_le_data_channels(void){
                     uint16_t new_credits = channel->new_credits_incoming;
                     channel->new_credits_incoming = 0;
                     channel->credits_incoming += new_credits;
+                    channel->le_statistics.credits_granted += new_credits;
+                    l2cap_le_rx_stall_stop(channel);
                     l2cap_send_le_signaling_packet(channel->con_handle, LE_FLOW_CONTROL_CREDIT, channel->local_sig_id, channel->remote_cid, new_credits);
                 }
                 break;
@@ -2104,12 +2409,13 @@ static bool l2cap_channel_ready_to_send(l2cap_channel_t * channel){
 #ifdef ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
             // send if we have more data and remote windows isn't full yet
             if (channel->mode == L2CAP_CHANNEL_MODE_ENHANCED_RETRANSMISSION) {
+                if (channel->waiting_for_final) return false;
                 if (channel->unacked_frames >= btstack_min(channel->num_stored_tx_frames, channel->remote_tx_window_size)) return false;
                 return hci_can_send_acl_classic_packet_now() != 0;
             }
 #endif
             if (!channel->waiting_for_can_send_now) return false;
-            return (hci_can_send_acl_classic_packet_now() != 0);
+            return hci_can_send_acl_classic_packet_now() != 0;
         case L2CAP_CHANNEL_TYPE_CONNECTIONLESS:
             if (!channel->waiting_for_can_send_now) return false;
             return hci_can_send_acl_classic_packet_now() != 0;
@@ -2120,6 +2426,7 @@ static bool l2cap_channel_ready_to_send(l2cap_channel_t * channel){
             return hci_can_send_acl_le_packet_now() != 0;
 #ifdef ENABLE_LE_DATA_CHANNELS
         case L2CAP_CHANNEL_TYPE_LE_DATA_CHANNEL:
+            if (channel->state != L2CAP_STATE_OPEN) return false;
             if (channel->send_sdu_buffer == NULL) return false;
             if (channel->credits_outgoing == 0) return false;
             return hci_can_send_acl_le_packet_now() != 0;
@@ -2164,28 +2471,68 @@ static void l2cap_channel_trigger_send(l2cap_channel_t * channel){
     }
 }
 
+static hci_acl_tx_priority_t l2cap_channel_tx_priority(l2cap_channel_t * channel){
+    switch (channel->channel_type){
+#ifdef ENABLE_CLASSIC
+        case L2CAP_CHANNEL_TYPE_CLASSIC:
+            return hci_get_acl_tx_priority(channel->con_handle);
+#endif
+#ifdef ENABLE_LE_DATA_CHANNELS
+        case L2CAP_CHANNEL_TYPE_LE_DATA_CHANNEL:
+            return hci_get_acl_tx_priority(channel->con_handle);
+#endif
+        default:
+            // fixed channels are not bound to a single connection
+            return HCI_ACL_TX_PRIORITY_BULK;
+    }
+}
+
+// fixed channels don't leave controller buffers for higher priority connections
+static bool l2cap_channel_uses_acl_tx_priority(l2cap_channel_t * channel){
+    switch (channel->channel_type){
+#ifdef ENABLE_CLASSIC
+        case L2CAP_CHANNEL_TYPE_CLASSIC:
+            return true;
+#endif
+#ifdef ENABLE_LE_DATA_CHANNELS
+        case L2CAP_CHANNEL_TYPE_LE_DATA_CHANNEL:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
 static void l2cap_notify_channel_can_send(void){
-    bool done = false;
-    while (!done){
-        done = true;
+    while (true){
+        // find ready channel with highest priority, first in list wins for same priority
+        l2cap_channel_t * next_channel = NULL;
+        hci_acl_tx_priority_t next_priority = HCI_ACL_TX_PRIORITY_BULK;
         btstack_linked_list_iterator_t it;
         btstack_linked_list_iterator_init(&it, &l2cap_channels);
         while (btstack_linked_list_iterator_has_next(&it)){
             l2cap_channel_t * channel = (l2cap_channel_t *) btstack_linked_list_iterator_next(&it);
             bool ready = l2cap_channel_ready_to_send(channel);
             if (!ready) continue;
+            // hold back PDU to leave controller buffers for higher priority connections
+            if (l2cap_channel_uses_acl_tx_priority(channel) && !hci_acl_tx_priority_can_send_now(channel->con_handle)){
+                hci_acl_tx_priority_packet_deferred(channel->con_handle);
+                continue;
+            }
+            hci_acl_tx_priority_t priority = l2cap_channel_tx_priority(channel);
+            if ((next_channel != NULL) && (priority <= next_priority)) continue;
+            next_channel = channel;
+            next_priority = priority;
+            if (next_priority == HCI_ACL_TX_PRIORITY_AUDIO) break;
+        }
+        if (next_channel == NULL) break;
 
-            // requeue channel for fairness
-            btstack_linked_list_remove(&l2cap_channels, (btstack_linked_item_t *) channel);
-            btstack_linked_list_add_tail(&l2cap_channels, (btstack_linked_item_t *) channel);
-
-            // trigger sending
-            l2cap_channel_trigger_send(channel);
+        // requeue channel for fairness
+        btstack_linked_list_remove(&l2cap_channels, (btstack_linked_item_t *) next_channel);
+        btstack_linked_list_add_tail(&l2cap_channels, (btstack_linked_item_t *) next_channel);
 
-            // exit inner loop as we just broke the iterator, but try again
-            done = false;
-            break;
-        }
+        // trigger sending
+        l2cap_channel_trigger_send(next_channel);
     }
 }
 
@@ -2275,6 +2622,11 @@ static void l2cap_hci_event_handler(uint8_t packet_type, uint16_t cid, uint8_t *
         case HCI_EVENT_TRANSPORT_PACKET_SENT:
         case HCI_EVENT_NUMBER_OF_COMPLETED_PACKETS:
         case BTSTACK_EVENT_NR_CONNECTIONS_CHANGED:
+#ifdef ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
+            if (hci_event_packet_get_type(packet) == HCI_EVENT_TRANSPORT_PACKET_SENT){
+                l2cap_ertm_handle_transport_packet_sent();
+            }
+#endif
             l2cap_run();    // try sending signaling packets first
             l2cap_notify_channel_can_send();
             break;
@@ -2368,7 +2720,7 @@ static void l2cap_hci_event_handler(uint8_t packet_type, uint16_t cid, uint8_t *
             }
             if (hci_con_used) break;
             if (!hci_can_send_command_packet_now()) break;
-            hci_send_cmd(&hci_disconnect, handle, 0x13); // remote closed connection             
+            hci_send_cmd_disconnect(handle, 0x13); // remote closed connection             
             break;
 
         case HCI_EVENT_READ_REMOTE_SUPPORTED_FEATURES_COMPLETE:
@@ -2543,6 +2895,7 @@ static void l2cap_signaling_handle_configure_request(l2cap_channel_t *channel, u
 
 #ifdef ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
     uint8_t use_fcs = 1;
+    uint16_t extended_window_size = 0;
 #endif
 
     channel->remote_sig_id = command[L2CAP_SIGNALING_COMMAND_SIGID_OFFSET];
@@ -2624,7 +2977,11 @@ static void l2cap_signaling_handle_configure_request(l2cap_channel_t *channel, u
         }
         if (option_type == L2CAP_CONFIG_OPTION_TYPE_FRAME_CHECK_SEQUENCE && length == 1){
             use_fcs = command[pos];
-        }        
+        }
+        // Extended Window Size { type(8): 7, len(8): 2, Max Window Size(16) }
+        if ((option_type == L2CAP_CONFIG_OPTION_TYPE_EXTENDED_WINDOW_SIZE) && (length == 2)){
+            extended_window_size = little_endian_read_16(command, pos) & 0x3fff;
+        }
 #endif        
         // check for unknown options
         if ((option_hint == 0) && ((option_type < L2CAP_CONFIG_OPTION_TYPE_MAX_TRANSMISSION_UNIT) || (option_type > L2CAP_CONFIG_OPTION_TYPE_EXTENDED_WINDOW_SIZE))){
@@ -2635,6 +2992,12 @@ static void l2cap_signaling_handle_configure_request(l2cap_channel_t *channel, u
     }
 
 #ifdef ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
+        // Extended Window Size replaces TxWindow of Retransmission and Flow Control option
+        if ((channel->mode == L2CAP_CHANNEL_MODE_ENHANCED_RETRANSMISSION) && (extended_window_size > 0)){
+            log_info("Extended Window Size %u", extended_window_size);
+            channel->remote_tx_window_size = extended_window_size;
+            channel->extended_control = 1;
+        }
         // "FCS" has precedence over "No FCS"
         uint8_t update = channel->fcs_option || use_fcs;
         log_info("local fcs: %u, remote fcs: %u -> %u", channel->fcs_option, use_fcs, update);
@@ -2837,10 +3200,10 @@ static void l2cap_signaling_handler_channel(l2cap_channel_t *channel, uint8_t *c
                 // assert that packet can be stored in fragment buffers in ertm
                 if (channel->mode == L2CAP_CHANNEL_MODE_ENHANCED_RETRANSMISSION){
                     uint16_t effective_mps = btstack_min(channel->remote_mps, channel->local_mps);
-                    uint16_t usable_mtu = channel->num_tx_buffers == 1 ? effective_mps : channel->num_tx_buffers * effective_mps - 2;
+                    uint32_t usable_mtu = channel->num_tx_buffers == 1 ? effective_mps : ((uint32_t) channel->num_tx_buffers * effective_mps) - 2;
                     if (usable_mtu < channel->remote_mtu){
-                        log_info("Remote MTU %u > max storable ERTM packet, only using MTU = %u", channel->remote_mtu, usable_mtu);
-                        channel->remote_mtu = usable_mtu;
+                        log_info("Remote MTU %u > max storable ERTM packet, only using MTU = %u", channel->remote_mtu, (unsigned int) usable_mtu);
+                        channel->remote_mtu = (uint16_t) usable_mtu;
                     }
                 }
 #endif
@@ -3206,7 +3569,7 @@ static int l2cap_le_signaling_handler_dispatch(hci_con_handle_t handle, uint8_t
 
                 // set initial state
                 channel->state      = L2CAP_STATE_WAIT_CLIENT_ACCEPT_OR_REJECT;
-                channel->state_var |= L2CAP_CHANNEL_STATE_VAR_INCOMING;
+                channel->state_var = (L2CAP_CHANNEL_STATE_VAR) (channel->state_var | L2CAP_CHANNEL_STATE_VAR_INCOMING);
 
                 // add to connections list
                 btstack_linked_list_add_tail(&l2cap_channels, (btstack_linked_item_t *) channel);
@@ -3280,6 +3643,11 @@ static int l2cap_le_signaling_handler_dispatch(hci_con_handle_t handle, uint8_t
                 break;
             }            
             log_info("l2cap: %u credits for 0x%02x, now %u", new_credits, local_cid, channel->credits_outgoing);
+            if (new_credits){
+                l2cap_le_tx_stall_stop(channel);
+                // continue with pending SDU
+                l2cap_notify_channel_can_send();
+            }
             break;
 
         case DISCONNECTION_REQUEST:
@@ -3298,10 +3666,25 @@ static int l2cap_le_signaling_handler_dispatch(hci_con_handle_t handle, uint8_t
             channel->state = L2CAP_STATE_WILL_SEND_DISCONNECT_RESPONSE;
             break;
 
-#endif
+        case DISCONNECTION_RESPONSE:
 
+            // check size
+            if (len < 4) return 0;
+
+            // find channel by source cid
+            local_cid = little_endian_read_16(command, L2CAP_SIGNALING_COMMAND_DATA_OFFSET + 2);
+            channel = l2cap_get_channel_for_local_cid(local_cid);
+            if (!channel) {
+                log_error("l2cap: no channel for cid 0x%02x", local_cid);
+                break;
+            }
+            if (channel->state != L2CAP_STATE_WAIT_DISCONNECT) break;
+            l2cap_le_finialize_channel_close(channel);
+            break;
+#else
         case DISCONNECTION_RESPONSE:
             break;
+#endif
 
         default:
             // command unknown -> reject command
@@ -3317,9 +3700,10 @@ static void l2cap_acl_classic_handler_for_channel(l2cap_channel_t * l2cap_channe
     if (l2cap_channel->mode == L2CAP_CHANNEL_MODE_ENHANCED_RETRANSMISSION){
 
         int fcs_size = l2cap_channel->fcs_option ? 2 : 0;
+        int control_size = l2cap_ertm_control_field_size(l2cap_channel);
 
         // assert control + FCS fields are inside
-        if (size < COMPLETE_L2CAP_HEADER+2+fcs_size) return;
+        if (size < COMPLETE_L2CAP_HEADER+control_size+fcs_size) return;
 
         if (l2cap_channel->fcs_option){
             // verify FCS (required if one side requested it)
@@ -3346,14 +3730,30 @@ static void l2cap_acl_classic_handler_for_channel(l2cap_channel_t * l2cap_channe
         }
 
         // switch on packet type
-        uint16_t control = little_endian_read_16(packet, COMPLETE_L2CAP_HEADER);
-        uint8_t  req_seq = (control >> 8) & 0x3f;
-        int final = (control >> 7) & 0x01;
+        uint32_t control;
+        uint16_t req_seq;
+        int final;
+        if (l2cap_channel->extended_control){
+            control = little_endian_read_32(packet, COMPLETE_L2CAP_HEADER);
+            req_seq = (control >> 2) & 0x3fff;
+            final   = (control >> 1) & 0x01;
+        } else {
+            control = little_endian_read_16(packet, COMPLETE_L2CAP_HEADER);
+            req_seq = (control >> 8) & 0x3f;
+            final   = (control >> 7) & 0x01;
+        }
         if (control & 1){
             // S-Frame
-            int poll  = (control >> 4) & 0x01;
-            l2cap_supervisory_function_t s = (l2cap_supervisory_function_t) ((control >> 2) & 0x03);
-            log_info("Control: 0x%04x => Supervisory function %u, ReqSeq %02u", control, (int) s, req_seq);
+            int poll;
+            l2cap_supervisory_function_t s;
+            if (l2cap_channel->extended_control){
+                poll = (control >> 18) & 0x01;
+                s    = (l2cap_supervisory_function_t) ((control >> 16) & 0x03);
+            } else {
+                poll = (control >> 4) & 0x01;
+                s    = (l2cap_supervisory_function_t) ((control >> 2) & 0x03);
+            }
+            log_info("Control => Supervisory function %u, ReqSeq %02u", (int) s, req_seq);
             l2cap_ertm_tx_packet_state_t * tx_state;
             switch (s){
                 case L2CAP_SUPERVISORY_FUNCTION_RR_RECEIVER_READY:
@@ -3366,18 +3766,7 @@ static void l2cap_acl_classic_handler_for_channel(l2cap_channel_t * l2cap_channe
                     }
                     if (poll){
                         // check if we did request selective retransmission before <==> we have stored SDU segments
-                        int i;
-                        int num_stored_out_of_order_packets = 0;
-                        for (i=0;i<l2cap_channel->num_rx_buffers;i++){
-                            int index = l2cap_channel->rx_store_index + i;
-                            if (index >= l2cap_channel->num_rx_buffers){
-                                index -= l2cap_channel->num_rx_buffers;
-                            }
-                            l2cap_ertm_rx_packet_state_t * rx_state = &l2cap_channel->rx_packets_state[index];
-                            if (!rx_state->valid) continue;
-                            num_stored_out_of_order_packets++;
-                        }
-                        if (num_stored_out_of_order_packets){
+                        if (l2cap_channel->num_stored_rx_frames){
                             l2cap_channel->send_supervisor_frame_selective_reject = 1;
                         } else {
                             l2cap_channel->send_supervisor_frame_receiver_ready   = 1;
@@ -3387,6 +3776,7 @@ static void l2cap_acl_classic_handler_for_channel(l2cap_channel_t * l2cap_channe
                     if (final){
                         // Stop-MonitorTimer
                         l2cap_ertm_stop_monitor_timer(l2cap_channel);
+                        l2cap_channel->waiting_for_final = 0;
                         // If UnackedFrames > 0 then Start-RetransTimer
                         if (l2cap_channel->unacked_frames){
                             l2cap_ertm_start_retransmission_timer(l2cap_channel);
@@ -3409,6 +3799,19 @@ static void l2cap_acl_classic_handler_for_channel(l2cap_channel_t * l2cap_channe
                     if (poll){
                         l2cap_ertm_process_req_seq(l2cap_channel, req_seq);
                     }
+                    if (final){
+                        // response to RR with poll bit set
+                        l2cap_ertm_stop_monitor_timer(l2cap_channel);
+                        l2cap_channel->waiting_for_final = 0;
+                        if (l2cap_channel->unacked_frames){
+                            l2cap_ertm_start_retransmission_timer(l2cap_channel);
+                        }
+                        // frame was retransmitted already for SREJ received while waiting for the response
+                        if (l2cap_channel->srej_save_req_seq_valid && (l2cap_channel->srej_save_req_seq == req_seq)){
+                            l2cap_channel->srej_save_req_seq_valid = 0;
+                            break;
+                        }
+                    }
                     // find requested i-frame
                     tx_state = l2cap_ertm_get_tx_state(l2cap_channel, req_seq);
                     if (tx_state){
@@ -3416,6 +3819,10 @@ static void l2cap_acl_classic_handler_for_channel(l2cap_channel_t * l2cap_channe
                         l2cap_channel->set_final_bit_after_packet_with_poll_bit_set = poll;
                         tx_state->retransmission_requested = 1;
                         l2cap_channel->srej_active = 1;
+                        if (l2cap_channel->waiting_for_final){
+                            l2cap_channel->srej_save_req_seq_valid = 1;
+                            l2cap_channel->srej_save_req_seq = req_seq;
+                        }
                     }
                     break;
                 default:
@@ -3424,20 +3831,28 @@ static void l2cap_acl_classic_handler_for_channel(l2cap_channel_t * l2cap_channe
         } else {
             // I-Frame
             // get control
-            l2cap_segmentation_and_reassembly_t sar = (l2cap_segmentation_and_reassembly_t) (control >> 14);
-            uint8_t tx_seq = (control >> 1) & 0x3f;
-            log_info("Control: 0x%04x => SAR %u, ReqSeq %02u, R?, TxSeq %02u", control, (int) sar, req_seq, tx_seq);
+            l2cap_segmentation_and_reassembly_t sar;
+            uint16_t tx_seq;
+            if (l2cap_channel->extended_control){
+                sar    = (l2cap_segmentation_and_reassembly_t) ((control >> 16) & 0x03);
+                tx_seq = (control >> 18) & 0x3fff;
+            } else {
+                sar    = (l2cap_segmentation_and_reassembly_t) ((control >> 14) & 0x03);
+                tx_seq = (control >> 1) & 0x3f;
+            }
+            log_info("Control => SAR %u, ReqSeq %02u, R?, TxSeq %02u", (int) sar, req_seq, tx_seq);
             log_info("SAR: pos %u", l2cap_channel->reassembly_pos);
             log_info("State: expected_tx_seq %02u, req_seq %02u", l2cap_channel->expected_tx_seq, l2cap_channel->req_seq);
             l2cap_ertm_process_req_seq(l2cap_channel, req_seq);
             if (final){
                 // final bit set <- response to RR with poll bit set. All not acknowledged packets need to be retransmitted
+                l2cap_channel->waiting_for_final = 0;
                 l2cap_ertm_retransmit_unacknowleded_frames(l2cap_channel);
             }
 
             // get SDU
-            const uint8_t * payload_data = &packet[COMPLETE_L2CAP_HEADER+2];
-            uint16_t        payload_len  = size-(COMPLETE_L2CAP_HEADER+2+fcs_size);
+            const uint8_t * payload_data = &packet[COMPLETE_L2CAP_HEADER+control_size];
+            uint16_t        payload_len  = size-(COMPLETE_L2CAP_HEADER+control_size+fcs_size);
 
             // assert SDU size is smaller or equal to our buffers
             uint16_t max_payload_size = 0;
@@ -3460,47 +3875,53 @@ static void l2cap_acl_classic_handler_for_channel(l2cap_channel_t * l2cap_channe
             // check ordering
             if (l2cap_channel->expected_tx_seq == tx_seq){
                 log_info("Received expected frame with TxSeq == ExpectedTxSeq == %02u", tx_seq);
-                l2cap_channel->expected_tx_seq = l2cap_next_ertm_seq_nr(l2cap_channel->expected_tx_seq);
+                l2cap_channel->expected_tx_seq = l2cap_next_ertm_seq_nr(l2cap_channel, l2cap_channel->expected_tx_seq);
                 l2cap_channel->req_seq         = l2cap_channel->expected_tx_seq;
+                l2cap_ertm_next_rx_store_index(l2cap_channel);
 
                 // process SDU
                 l2cap_ertm_handle_in_sequence_sdu(l2cap_channel, sar, payload_data, payload_len);
 
                 // process stored segments
-                while (true){
+                while (l2cap_channel->num_stored_rx_frames){
                     int index = l2cap_channel->rx_store_index;
                     l2cap_ertm_rx_packet_state_t * rx_state = &l2cap_channel->rx_packets_state[index];
                     if (!rx_state->valid) break;
 
                     log_info("Processing stored frame with TxSeq == ExpectedTxSeq == %02u", l2cap_channel->expected_tx_seq);
-                    l2cap_channel->expected_tx_seq = l2cap_next_ertm_seq_nr(l2cap_channel->expected_tx_seq);
+                    l2cap_channel->expected_tx_seq = l2cap_next_ertm_seq_nr(l2cap_channel, l2cap_channel->expected_tx_seq);
                     l2cap_channel->req_seq         = l2cap_channel->expected_tx_seq;
 
                     rx_state->valid = 0;
-                    l2cap_ertm_handle_in_sequence_sdu(l2cap_channel, rx_state->sar, &l2cap_channel->rx_packets_data[index], rx_state->len);
+                    l2cap_channel->num_stored_rx_frames--;
+                    l2cap_ertm_handle_in_sequence_sdu(l2cap_channel, rx_state->sar, &l2cap_channel->rx_packets_data[index * l2cap_channel->local_mps], rx_state->len);
 
                     // update rx store index
-                    index++;
-                    if (index >= l2cap_channel->num_rx_buffers){
-                        index = 0;
-                    }
-                    l2cap_channel->rx_store_index = index;
+                    l2cap_ertm_next_rx_store_index(l2cap_channel);
                 }
 
-                //
-                l2cap_channel->send_supervisor_frame_receiver_ready = 1;
+                if (l2cap_channel->num_stored_rx_frames){
+                    // next frame is missing, too
+                    log_info("Frame TxSeq %u missing -> send S-SREJ", l2cap_channel->expected_tx_seq);
+                    l2cap_channel->send_supervisor_frame_selective_reject = 1;
+                } else {
+                    l2cap_channel->send_supervisor_frame_receiver_ready = 1;
+                }
 
             } else {
-                int delta = (tx_seq - l2cap_channel->expected_tx_seq) & 0x3f;
-                if (delta < 2){
+                int delta = (tx_seq - l2cap_channel->expected_tx_seq) & l2cap_ertm_seq_nr_mask(l2cap_channel);
+                if (delta < l2cap_channel->num_rx_buffers){
                     // store segment
+                    uint16_t num_stored_rx_frames = l2cap_channel->num_stored_rx_frames;
                     l2cap_ertm_handle_out_of_sequence_sdu(l2cap_channel, sar, delta, payload_data, payload_len);
 
-                    log_info("Received unexpected frame TxSeq %u but expected %u -> send S-SREJ", tx_seq, l2cap_channel->expected_tx_seq);
-                    l2cap_channel->send_supervisor_frame_selective_reject = 1;
+                    // request missing frame once, it is requested again on poll
+                    if (num_stored_rx_frames == 0){
+                        log_info("Received unexpected frame TxSeq %u but expected %u -> send S-SREJ", tx_seq, l2cap_channel->expected_tx_seq);
+                        l2cap_channel->send_supervisor_frame_selective_reject = 1;
+                    }
                 } else {
-                    log_info("Received unexpected frame TxSeq %u but expected %u -> send S-REJ", tx_seq, l2cap_channel->expected_tx_seq);
-                    l2cap_channel->send_supervisor_frame_reject = 1;
+                    log_info("Received frame TxSeq %u outside of receive window, expected %u -> ignore", tx_seq, l2cap_channel->expected_tx_seq);
                 }
             }
         }
@@ -3607,12 +4028,22 @@ static void l2cap_acl_le_handler(hci_con_handle_t handle, uint8_t *packet, uint1
                     break;
                 }
                 l2cap_channel->credits_incoming--;
+                if (l2cap_channel->credits_incoming == 0){
+                    l2cap_le_rx_stall_start(l2cap_channel);
+                }
 
-                // automatic credits
-                if ((l2cap_channel->credits_incoming < L2CAP_LE_DATA_CHANNELS_AUTOMATIC_CREDITS_WATERMARK) && l2cap_channel->automatic_credits){
+                // automatic credits, with multiple receive buffers see l2cap_le_update_credits
+                if ((l2cap_channel->credits_incoming < L2CAP_LE_DATA_CHANNELS_AUTOMATIC_CREDITS_WATERMARK) && l2cap_channel->automatic_credits
+                && (l2cap_channel->receive_sdu_buffers_num <= 1)){
                     l2cap_channel->new_credits_incoming = L2CAP_LE_DATA_CHANNELS_AUTOMATIC_CREDITS_INCREMENT;
                 }
 
+                // all receive buffers held by application, only possible if it provided more credits than free receive buffers
+                if (l2cap_channel->receive_sdu_buffer == NULL){
+                    log_error("LE Data Channel packet received but no receive buffer available");
+                    break;
+                }
+
                 // first fragment
                 uint16_t pos = 0;
                 if (!l2cap_channel->receive_sdu_len){
@@ -3633,8 +4064,18 @@ static void l2cap_acl_le_handler(hci_con_handle_t handle, uint8_t *packet, uint1
                 // done?
                 log_debug("le packet pos %u, len %u", l2cap_channel->receive_sdu_pos, l2cap_channel->receive_sdu_len);
                 if (l2cap_channel->receive_sdu_pos >= l2cap_channel->receive_sdu_len){
-                    l2cap_dispatch_to_channel(l2cap_channel, L2CAP_DATA_PACKET, l2cap_channel->receive_sdu_buffer, l2cap_channel->receive_sdu_len);
+                    uint8_t * sdu_buffer = l2cap_channel->receive_sdu_buffer;
+                    uint16_t  sdu_len    = l2cap_channel->receive_sdu_len;
                     l2cap_channel->receive_sdu_len = 0;
+                    // with multiple receive buffers, SDU stays in its buffer until released
+                    if (l2cap_channel->receive_sdu_buffers_num > 1){
+                        l2cap_channel->receive_sdu_buffers_in_use |= 1u << l2cap_channel->receive_sdu_buffers_index;
+                        l2cap_le_select_receive_buffer(l2cap_channel);
+                    }
+                    l2cap_le_update_credits(l2cap_channel);
+                    l2cap_dispatch_to_channel(l2cap_channel, L2CAP_DATA_PACKET, sdu_buffer, sdu_len);
+                } else {
+                    l2cap_le_update_credits(l2cap_channel);
                 }
             } else {
                 log_error("LE Data Channel packet received but no channel found for cid 0x%02x", channel_id);
@@ -3667,6 +4108,10 @@ static void l2cap_acl_handler(uint8_t packet_type, uint16_t channel, uint8_t *pa
     }
 
     l2cap_run();
+#ifdef ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
+    // acknowledged I-Frames or response to poll allow to send new I-Frames
+    l2cap_notify_channel_can_send();
+#endif
 }
 
 // Bluetooth 4.0 - allows to register handler for Attribute Protocol and Security Manager Protocol
@@ -3842,11 +4287,19 @@ static void l2cap_le_send_pdu(l2cap_channel_t *channel){
     l2cap_setup_header(acl_buffer, channel->con_handle, 0, channel->remote_cid, pos);
 
     channel->credits_outgoing--;
+    if ((channel->credits_outgoing == 0) && (channel->send_sdu_pos < (channel->send_sdu_len + 2))){
+        l2cap_le_tx_stall_start(channel);
+    }
+
+    // SDU done before sending, HCI Transport may report packet sent and trigger next send right away
+    bool sdu_done = channel->send_sdu_pos >= (channel->send_sdu_len + 2);
+    if (sdu_done){
+        channel->send_sdu_buffer = NULL;
+    }
 
     hci_send_acl_packet_buffer(8 + pos);
 
-    if (channel->send_sdu_pos >= (channel->send_sdu_len + 2)){
-        channel->send_sdu_buffer = NULL;
+    if (sdu_done){
         // send done event
         l2cap_emit_simple_event_with_cid(channel, L2CAP_EVENT_LE_PACKET_SENT);
         // inform about can send now
@@ -3854,10 +4307,176 @@ static void l2cap_le_send_pdu(l2cap_channel_t *channel){
     }
 }
 
+static uint16_t l2cap_le_local_mps(l2cap_channel_t *channel){
+    // TODO: support larger MPS
+    return btstack_min(l2cap_max_le_mtu(), channel->local_mtu);
+}
+
+static void l2cap_le_tx_stall_start(l2cap_channel_t *channel){
+    if (channel->tx_stalled) return;
+    channel->tx_stalled = 1;
+    channel->tx_stall_start_ms = btstack_run_loop_get_time_ms();
+    channel->le_statistics.tx_stalls++;
+}
+
+static void l2cap_le_tx_stall_stop(l2cap_channel_t *channel){
+    if (!channel->tx_stalled) return;
+    channel->tx_stalled = 0;
+    channel->le_statistics.tx_stall_time_ms += btstack_run_loop_get_time_ms() - channel->tx_stall_start_ms;
+}
+
+static void l2cap_le_rx_stall_start(l2cap_channel_t *channel){
+    if (channel->rx_stalled) return;
+    channel->rx_stalled = 1;
+    channel->rx_stall_start_ms = btstack_run_loop_get_time_ms();
+    channel->le_statistics.rx_stalls++;
+}
+
+static void l2cap_le_rx_stall_stop(l2cap_channel_t *channel){
+    if (!channel->rx_stalled) return;
+    channel->rx_stalled = 0;
+    channel->le_statistics.rx_stall_time_ms += btstack_run_loop_get_time_ms() - channel->rx_stall_start_ms;
+}
+
+static void l2cap_le_select_receive_buffer(l2cap_channel_t *channel){
+    channel->receive_sdu_buffer = NULL;
+    uint8_t i;
+    for (i=0;i<channel->receive_sdu_buffers_num;i++){
+        if ((channel->receive_sdu_buffers_in_use & (1u << i)) != 0) continue;
+        channel->receive_sdu_buffers_index = i;
+        channel->receive_sdu_buffer = channel->receive_sdu_buffers[i];
+        return;
+    }
+}
+
+static void l2cap_le_add_receive_buffer_internal(l2cap_channel_t *channel, uint8_t * receive_sdu_buffer){
+    if (channel->receive_sdu_buffers_num >= L2CAP_LE_MAX_RECEIVE_SDU_BUFFERS){
+        log_error("l2cap: no space for receive buffer, increase L2CAP_LE_MAX_RECEIVE_SDU_BUFFERS");
+        return;
+    }
+    channel->receive_sdu_buffers[channel->receive_sdu_buffers_num++] = receive_sdu_buffer;
+    if (channel->receive_sdu_buffer == NULL){
+        l2cap_le_select_receive_buffer(channel);
+    }
+}
+
+// credits that can be used without running out of receive buffers
+static uint16_t l2cap_le_receive_buffer_credits(l2cap_channel_t *channel){
+    // single receive buffer is available again after SDU was delivered
+    if (channel->receive_sdu_buffers_num <= 1) return L2CAP_LE_DATA_CHANNELS_ADAPTIVE_CREDITS_MAX;
+    uint32_t num_free_buffers = 0;
+    uint8_t i;
+    for (i=0;i<channel->receive_sdu_buffers_num;i++){
+        if ((channel->receive_sdu_buffers_in_use & (1u << i)) == 0){
+            num_free_buffers++;
+        }
+    }
+    // worst case: each PDU completes an SDU that occupies a free buffer
+    uint32_t credits = num_free_buffers;
+    // SDU in reassembly needs at least this number of PDUs before its buffer is occupied
+    if (channel->receive_sdu_len){
+        uint16_t mps = l2cap_le_local_mps(channel);
+        uint32_t remaining = channel->receive_sdu_len - channel->receive_sdu_pos;
+        credits += ((remaining + mps - 1u) / mps) - 1u;
+    }
+    return (uint16_t) btstack_min(credits, L2CAP_LE_DATA_CHANNELS_ADAPTIVE_CREDITS_MAX);
+}
+
+static void l2cap_le_top_up_credits(l2cap_channel_t *channel, uint16_t limit){
+    uint32_t outstanding = channel->credits_incoming + channel->new_credits_incoming;
+    // top up after half of the credits have been used
+    if (outstanding > (limit / 2u)) return;
+    channel->new_credits_incoming += limit - outstanding;
+}
+
+static void l2cap_le_adaptive_credits_grant(l2cap_channel_t *channel){
+    l2cap_le_top_up_credits(channel, btstack_min(channel->credits_target, l2cap_le_receive_buffer_credits(channel)));
+}
+
+static void l2cap_le_adaptive_credits_init(l2cap_channel_t *channel){
+    channel->credits_target = L2CAP_LE_DATA_CHANNELS_ADAPTIVE_CREDITS_INITIAL;
+    channel->credits_consumed_in_interval = 0;
+    channel->credits_stalled_in_interval = 0;
+    channel->credits_interval_start_ms = btstack_run_loop_get_time_ms();
+    channel->new_credits_incoming = 0;
+    l2cap_le_adaptive_credits_grant(channel);
+}
+
+// called for each received PDU
+static void l2cap_le_adaptive_credits_update(l2cap_channel_t *channel){
+    channel->credits_consumed_in_interval++;
+
+    // remote used all credits, allow more credits in flight
+    if ((channel->credits_incoming == 0) && !channel->credits_stalled_in_interval){
+        channel->credits_stalled_in_interval = 1;
+        channel->credits_target = (uint16_t) btstack_min(channel->credits_target * 2u, L2CAP_LE_DATA_CHANNELS_ADAPTIVE_CREDITS_MAX);
+        log_info("l2cap: remote out of credits, target %u", channel->credits_target);
+    }
+
+    // remote consumed credits of current target within interval, fewer credit packets with larger target
+    if ((channel->credits_consumed_in_interval >= channel->credits_target) && (channel->credits_target < L2CAP_LE_DATA_CHANNELS_ADAPTIVE_CREDITS_MAX)){
+        channel->credits_target = (uint16_t) btstack_min(channel->credits_target * 2u, L2CAP_LE_DATA_CHANNELS_ADAPTIVE_CREDITS_MAX);
+        log_info("l2cap: remote streaming, target %u", channel->credits_target);
+    }
+
+    uint32_t now = btstack_run_loop_get_time_ms();
+    uint32_t elapsed_ms = now - channel->credits_interval_start_ms;
+    if (elapsed_ms >= L2CAP_LE_DATA_CHANNELS_ADAPTIVE_CREDITS_INTERVAL_MS){
+        uint32_t consumed = channel->credits_consumed_in_interval;
+        channel->le_statistics.credits_per_second = (uint16_t) btstack_min((consumed * 1000u) / elapsed_ms, 0xffff);
+        // remote did not need all credits, reduce slowly towards consumption
+        if (!channel->credits_stalled_in_interval && (consumed < channel->credits_target)){
+            uint32_t target = btstack_max(consumed, (channel->credits_target * 3u) / 4u);
+            channel->credits_target = (uint16_t) btstack_max(target, L2CAP_LE_DATA_CHANNELS_ADAPTIVE_CREDITS_MIN);
+        }
+        channel->credits_consumed_in_interval = 0;
+        channel->credits_stalled_in_interval = 0;
+        channel->credits_interval_start_ms = now;
+    }
+
+    l2cap_le_adaptive_credits_grant(channel);
+}
+
+// credits for connection request or response
+static void l2cap_le_init_credits(l2cap_channel_t *channel){
+    if (channel->adaptive_credits){
+        l2cap_le_adaptive_credits_init(channel);
+        return;
+    }
+    // automatic credits with multiple receive buffers are limited by free receive buffers
+    if (channel->automatic_credits && (channel->receive_sdu_buffers_num > 1)){
+        channel->new_credits_incoming = l2cap_le_receive_buffer_credits(channel);
+    }
+}
+
+// called for each received PDU after it was stored
+static void l2cap_le_update_credits(l2cap_channel_t *channel){
+    if (channel->adaptive_credits){
+        l2cap_le_adaptive_credits_update(channel);
+        return;
+    }
+    if (channel->automatic_credits && (channel->receive_sdu_buffers_num > 1)){
+        l2cap_le_top_up_credits(channel, l2cap_le_receive_buffer_credits(channel));
+    }
+}
+
+// receive buffer added or released
+static void l2cap_le_receive_buffers_changed(l2cap_channel_t *channel){
+    if (channel->state != L2CAP_STATE_OPEN) return;
+    if (channel->adaptive_credits){
+        l2cap_le_adaptive_credits_grant(channel);
+    } else if (channel->automatic_credits){
+        l2cap_le_top_up_credits(channel, l2cap_le_receive_buffer_credits(channel));
+    } else {
+        return;
+    }
+    l2cap_run();
+}
+
 // finalize closed channel - l2cap_handle_disconnect_request & DISCONNECTION_RESPONSE
 void l2cap_le_finialize_channel_close(l2cap_channel_t * channel){
     channel->state = L2CAP_STATE_CLOSED;
-    l2cap_emit_simple_event_with_cid(channel, L2CAP_EVENT_CHANNEL_CLOSED);
+    l2cap_emit_le_channel_closed(channel);
     // discard channel
     btstack_linked_list_remove(&l2cap_channels, (btstack_linked_item_t *) channel);
     l2cap_free_channel_entry(channel);
@@ -3919,10 +4538,11 @@ uint8_t l2cap_le_accept_connection(uint16_t local_cid, uint8_t * receive_sdu_buf
 
     // set state accept connection
     channel->state = L2CAP_STATE_WILL_SEND_LE_CONNECTION_RESPONSE_ACCEPT;
-    channel->receive_sdu_buffer = receive_sdu_buffer;
+    l2cap_le_add_receive_buffer_internal(channel, receive_sdu_buffer);
     channel->local_mtu = mtu;
-    channel->new_credits_incoming = initial_credits;
     channel->automatic_credits  = initial_credits == L2CAP_LE_AUTOMATIC_CREDITS;
+    channel->adaptive_credits   = initial_credits == L2CAP_LE_ADAPTIVE_CREDITS;
+    channel->new_credits_incoming = channel->adaptive_credits ? 0 : initial_credits;
 
     // test
     // channel->new_credits_incoming = 1;
@@ -3980,10 +4600,11 @@ uint8_t l2cap_le_create_channel(btstack_packet_handler_t packet_handler, hci_con
 
     // provide buffer
     channel->con_handle = con_handle;
-    channel->receive_sdu_buffer = receive_sdu_buffer;
+    l2cap_le_add_receive_buffer_internal(channel, receive_sdu_buffer);
     channel->state = L2CAP_STATE_WILL_SEND_LE_CONNECTION_REQUEST;
-    channel->new_credits_incoming = initial_credits;
     channel->automatic_credits    = initial_credits == L2CAP_LE_AUTOMATIC_CREDITS;
+    channel->adaptive_credits     = initial_credits == L2CAP_LE_ADAPTIVE_CREDITS;
+    channel->new_credits_incoming = channel->adaptive_credits ? 0 : initial_credits;
 
     // add to connections list
     btstack_linked_list_add_tail(&l2cap_channels, (btstack_linked_item_t *) channel);
@@ -4028,6 +4649,68 @@ uint8_t l2cap_le_provide_credits(uint16_t local_cid, uint16_t credits){
     return ERROR_CODE_SUCCESS;
 }
 
+uint8_t l2cap_le_add_receive_buffer(uint16_t local_cid, uint8_t * receive_sdu_buffer){
+    l2cap_channel_t * channel = l2cap_get_channel_for_local_cid(local_cid);
+    if (!channel) {
+        log_error("l2cap_le_add_receive_buffer no channel for cid 0x%02x", local_cid);
+        return L2CAP_LOCAL_CID_DOES_NOT_EXIST;
+    }
+    if (channel->receive_sdu_buffers_num >= L2CAP_LE_MAX_RECEIVE_SDU_BUFFERS){
+        return BTSTACK_MEMORY_ALLOC_FAILED;
+    }
+    // automatic credits for a single receive buffer have been granted already, they cannot be taken back
+    if (channel->automatic_credits && (channel->receive_sdu_buffers_num == 1)
+    && ((channel->state == L2CAP_STATE_WAIT_LE_CONNECTION_RESPONSE) || (channel->state == L2CAP_STATE_OPEN))){
+        log_error("l2cap_le_add_receive_buffer automatic credits granted for single buffer on cid 0x%02x", local_cid);
+        return ERROR_CODE_COMMAND_DISALLOWED;
+    }
+    l2cap_le_add_receive_buffer_internal(channel, receive_sdu_buffer);
+
+    // more buffer space for adaptive and automatic credits
+    l2cap_le_receive_buffers_changed(channel);
+    return ERROR_CODE_SUCCESS;
+}
+
+uint8_t l2cap_le_release_receive_buffer(uint16_t local_cid, const uint8_t * receive_sdu_buffer){
+    l2cap_channel_t * channel = l2cap_get_channel_for_local_cid(local_cid);
+    if (!channel) {
+        log_error("l2cap_le_release_receive_buffer no channel for cid 0x%02x", local_cid);
+        return L2CAP_LOCAL_CID_DOES_NOT_EXIST;
+    }
+    uint8_t i;
+    for (i=0;i<channel->receive_sdu_buffers_num;i++){
+        if (channel->receive_sdu_buffers[i] != receive_sdu_buffer) continue;
+        if ((channel->receive_sdu_buffers_in_use & (1u << i)) == 0) break;
+        channel->receive_sdu_buffers_in_use &= ~(1u << i);
+        if (channel->receive_sdu_buffer == NULL){
+            l2cap_le_select_receive_buffer(channel);
+        }
+        l2cap_le_receive_buffers_changed(channel);
+        return ERROR_CODE_SUCCESS;
+    }
+    log_error("l2cap_le_release_receive_buffer buffer %p not in use", receive_sdu_buffer);
+    return ERROR_CODE_INVALID_HCI_COMMAND_PARAMETERS;
+}
+
+uint8_t l2cap_le_get_channel_statistics(uint16_t local_cid, l2cap_le_channel_statistics_t * statistics){
+    l2cap_channel_t * channel = l2cap_get_channel_for_local_cid(local_cid);
+    if (!channel) {
+        log_error("l2cap_le_get_channel_statistics no channel for cid 0x%02x", local_cid);
+        return L2CAP_LOCAL_CID_DOES_NOT_EXIST;
+    }
+    *statistics = channel->le_statistics;
+    statistics->credits_target = channel->credits_target;
+    // include ongoing stalls
+    uint32_t now = btstack_run_loop_get_time_ms();
+    if (channel->tx_stalled){
+        statistics->tx_stall_time_ms += now - channel->tx_stall_start_ms;
+    }
+    if (channel->rx_stalled){
+        statistics->rx_stall_time_ms += now - channel->rx_stall_start_ms;
+    }
+    return ERROR_CODE_SUCCESS;
+}
+
 /**
  * @brief Check if outgoing buffer is available and that there's space on the Bluetooth module
  * @param local_cid             L2CAP LE Data Channel Identifier
@@ -4095,6 +4778,10 @@ uint8_t l2cap_le_send_data(uint16_t local_cid, uint8_t * data, uint16_t len){
     channel->send_sdu_len    = len;
     channel->send_sdu_pos    = 0;
 
+    if (channel->credits_outgoing == 0){
+        l2cap_le_tx_stall_start(channel);
+    }
+
     l2cap_notify_channel_can_send();
     return ERROR_CODE_SUCCESS;
 }
@@ -68,6 +68,30 @@ extern "C" {
 #endif
 
 #define L2CAP_LE_AUTOMATIC_CREDITS 0xffff
+#define L2CAP_LE_ADAPTIVE_CREDITS  0xfffe
+
+// max number of receive SDU buffers per LE Data Channel, see l2cap_le_add_receive_buffer
+#ifndef L2CAP_LE_MAX_RECEIVE_SDU_BUFFERS
+#define L2CAP_LE_MAX_RECEIVE_SDU_BUFFERS 4
+#endif
+#if L2CAP_LE_MAX_RECEIVE_SDU_BUFFERS > 8
+#error "L2CAP_LE_MAX_RECEIVE_SDU_BUFFERS must not exceed 8, buffers in use are tracked in an 8-bit bitmap"
+#endif
+
+// LE Data Channel credit statistics
+typedef struct {
+    // time an outgoing SDU waited for credits from remote, in ms
+    uint32_t tx_stall_time_ms;
+    uint32_t tx_stalls;
+    // time remote had no credits to send to us, in ms
+    uint32_t rx_stall_time_ms;
+    uint32_t rx_stalls;
+    // credits provided to remote after channel setup
+    uint32_t credits_granted;
+    // adaptive credits: max outstanding credits and observed consumption
+    uint16_t credits_target;
+    uint16_t credits_per_second;
+} l2cap_le_channel_statistics_t;
 
 // private structs
 typedef enum {
@@ -144,7 +168,7 @@ typedef struct {
 typedef struct {
     l2cap_segmentation_and_reassembly_t sar;
     uint16_t len;
-    uint8_t tx_seq;
+    uint16_t tx_seq;
     uint8_t retry_count;
     uint8_t retransmission_requested;
 } l2cap_ertm_tx_packet_state_t;
@@ -166,10 +190,11 @@ typedef struct {
     uint16_t local_mtu;
 
     // Number of buffers for outgoing data
-    uint8_t num_tx_buffers;
+    uint16_t num_tx_buffers;
 
     // Number of packets that can be received out of order (-> our tx_window size)
-    uint8_t num_rx_buffers;
+    // Values above 63 use the Extended Window Size option if supported by remote, up to 0x3fff
+    uint16_t num_rx_buffers;
 
     // Frame Check Sequence (FCS) Option
     uint8_t fcs_option;
@@ -252,6 +277,12 @@ typedef struct {
     uint16_t  receive_sdu_len;
     uint16_t  receive_sdu_pos;
 
+    // additional receive SDU buffers, SDUs are held by application until released if more than one is provided
+    uint8_t * receive_sdu_buffers[L2CAP_LE_MAX_RECEIVE_SDU_BUFFERS];
+    uint8_t   receive_sdu_buffers_num;
+    uint8_t   receive_sdu_buffers_in_use;    // bitmap
+    uint8_t   receive_sdu_buffers_index;     // buffer used for current SDU
+
     // outgoing SDU
     uint8_t  * send_sdu_buffer;
     uint16_t   send_sdu_len;
@@ -272,6 +303,20 @@ typedef struct {
     // automatic credits incoming
     uint16_t automatic_credits;
 
+    // adaptive credits incoming: outstanding credits follow consumption rate and free receive buffers
+    uint8_t  adaptive_credits;
+    uint16_t credits_target;
+    uint16_t credits_consumed_in_interval;
+    uint32_t credits_interval_start_ms;
+    uint8_t  credits_stalled_in_interval;
+
+    // stall tracking
+    uint8_t  tx_stalled;
+    uint8_t  rx_stalled;
+    uint32_t tx_stall_start_ms;
+    uint32_t rx_stall_start_ms;
+    l2cap_le_channel_statistics_t le_statistics;
+
 #ifdef ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
 
     // l2cap channel mode: basic or enhanced retransmission mode
@@ -293,7 +338,7 @@ typedef struct {
     uint16_t remote_retransmission_timeout_ms;
     uint16_t remote_monitor_timeout_ms;
 
-    uint8_t remote_tx_window_size;
+    uint16_t remote_tx_window_size;
 
     uint8_t local_max_transmit;
     uint8_t remote_max_transmit;
@@ -304,42 +349,59 @@ typedef struct {
     // Frame Chech Sequence (crc16) is present in both directions
     uint8_t fcs_option;
 
+    // Extended Window Size option sent or received: Extended Control Field and 14-bit sequence numbers are used
+    uint8_t extended_control;
+
     // sender: max num of stored outgoing frames
-    uint8_t num_tx_buffers;
+    uint16_t num_tx_buffers;
 
     // sender: num stored outgoing frames
-    uint8_t num_stored_tx_frames;
+    uint16_t num_stored_tx_frames;
 
     // sender: number of unacknowledeged I-Frames - frames have been sent, but not acknowledged yet
-    uint8_t unacked_frames;
+    uint16_t unacked_frames;
 
     // sender: buffer index of oldest packet
-    uint8_t tx_read_index;
+    uint16_t tx_read_index;
 
     // sender: buffer index to store next tx packet
-    uint8_t tx_write_index;
+    uint16_t tx_write_index;
 
     // sender: buffer index of packet to send next
-    uint8_t tx_send_index;
+    uint16_t tx_send_index;
 
     // sender: next seq nr used for sending
-    uint8_t next_tx_seq;
+    uint16_t next_tx_seq;
 
     // sender: selective retransmission requested
     uint8_t srej_active;
 
+    // sender: RR with poll bit sent, no new I-Frames until response with final bit set
+    uint8_t waiting_for_final;
+
+    // sender: I-Frame retransmitted for SREJ while waiting for final bit, not retransmitted again for SREJ(F=1) with same req_seq
+    uint8_t  srej_save_req_seq_valid;
+    uint16_t srej_save_req_seq;
+
+    // sender: I-Frame sent from tx buffer without copy, buffer may still be used by HCI Transport
+    uint8_t  tx_frame_in_transit;
+    uint16_t tx_frame_in_transit_index;
+
 
     // receiver: max num out-of-order packets // tx_window
-    uint8_t num_rx_buffers;
+    uint16_t num_rx_buffers;
+
+    // receiver: num out-of-order packets stored
+    uint16_t num_stored_rx_frames;
 
-    // receiver: buffer index of to store packet with delta = 1
-    uint8_t rx_store_index;
+    // receiver: buffer index of packet with tx_seq == expected_tx_seq
+    uint16_t rx_store_index;
 
     // receiver: value of tx_seq in next expected i-frame
-    uint8_t expected_tx_seq;
+    uint16_t expected_tx_seq;
 
     // receiver: request transmission with tx_seq = req_seq and ack up to and including req_seq
-    uint8_t req_seq;
+    uint16_t req_seq;
 
     // receiver: local busy condition
     uint8_t local_busy;
@@ -380,7 +442,7 @@ typedef struct {
     // receiver: num_rx_buffers of size local_mps
     uint8_t * rx_packets_data;
 
-    // sender: num_tx_buffers of size local_mps
+    // sender: num_tx_buffers of size local_mps plus room for HCI, L2CAP and control headers, and FCS
     uint8_t * tx_packets_data;
 
 #endif    
@@ -602,7 +664,8 @@ uint8_t l2cap_le_unregister_service(uint16_t psm);
  * @param local_cid             L2CAP LE Data Channel Identifier
  * @param receive_buffer        buffer used for reassembly of L2CAP LE Information Frames into service data unit (SDU) with given MTU
  * @param receive_buffer_size   buffer size equals MTU
- * @param initial_credits       Number of initial credits provided to peer or L2CAP_LE_AUTOMATIC_CREDITS to enable automatic credits
+ * @param initial_credits       Number of initial credits provided to peer, L2CAP_LE_AUTOMATIC_CREDITS to enable automatic credits,
+ *                              or L2CAP_LE_ADAPTIVE_CREDITS to follow consumption rate and free receive buffers
  */
 
 uint8_t l2cap_le_accept_connection(uint16_t local_cid, uint8_t * receive_sdu_buffer, uint16_t mtu, uint16_t initial_credits);
@@ -621,7 +684,8 @@ uint8_t l2cap_le_decline_connection(uint16_t local_cid);
  * @param psm                   Service PSM to connect to
  * @param receive_buffer        buffer used for reassembly of L2CAP LE Information Frames into service data unit (SDU) with given MTU
  * @param receive_buffer_size   buffer size equals MTU
- * @param initial_credits       Number of initial credits provided to peer or L2CAP_LE_AUTOMATIC_CREDITS to enable automatic credits
+ * @param initial_credits       Number of initial credits provided to peer, L2CAP_LE_AUTOMATIC_CREDITS to enable automatic credits,
+ *                              or L2CAP_LE_ADAPTIVE_CREDITS to follow consumption rate and free receive buffers
  * @param security_level        Minimum required security level
  * @param out_local_cid         L2CAP LE Channel Identifier is stored here
  */
@@ -631,11 +695,42 @@ uint8_t l2cap_le_create_channel(btstack_packet_handler_t packet_handler, hci_con
 
 /**
  * @brief Provide credtis for LE Data Channel
+ * @note With more than one receive buffer, each credit may be used for an SDU that occupies a free receive buffer.
+ *       Data received without a free receive buffer is dropped.
  * @param local_cid             L2CAP LE Data Channel Identifier
  * @param credits               Number additional credits for peer
  */
 uint8_t l2cap_le_provide_credits(uint16_t cid, uint16_t credits);
 
+/**
+ * @brief Provide additional receive SDU buffer of MTU size for LE Data Channel
+ * @note If more than one buffer is provided, the buffer of a received SDU is not used until it is
+ *       returned with l2cap_le_release_receive_buffer. L2CAP_LE_AUTOMATIC_CREDITS and L2CAP_LE_ADAPTIVE_CREDITS
+ *       then only provide credits that free receive buffers can take if each PDU is a complete SDU. For incoming channels, call before
+ *       l2cap_le_accept_connection to consider it for initial credits. Not possible for L2CAP_LE_AUTOMATIC_CREDITS
+ *       after the initial credits for a single buffer have been sent.
+ * @param local_cid             L2CAP LE Data Channel Identifier
+ * @param receive_sdu_buffer    buffer with size of MTU
+ * @return status
+ */
+uint8_t l2cap_le_add_receive_buffer(uint16_t local_cid, uint8_t * receive_sdu_buffer);
+
+/**
+ * @brief Return receive SDU buffer after SDU was processed, only used with more than one receive buffer
+ * @param local_cid             L2CAP LE Data Channel Identifier
+ * @param receive_sdu_buffer    buffer provided in L2CAP_DATA_PACKET
+ * @return status
+ */
+uint8_t l2cap_le_release_receive_buffer(uint16_t local_cid, const uint8_t * receive_sdu_buffer);
+
+/**
+ * @brief Get credit statistics for LE Data Channel, incl. time stalled by missing credits
+ * @param local_cid             L2CAP LE Data Channel Identifier
+ * @param statistics
+ * @return status
+ */
+uint8_t l2cap_le_get_channel_statistics(uint16_t local_cid, l2cap_le_channel_statistics_t * statistics);
+
 /**
  * @brief Check if packet can be scheduled for transmission
  * @param local_cid             L2CAP LE Data Channel Identifier
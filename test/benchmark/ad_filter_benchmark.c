@@ -0,0 +1,237 @@
+// *****************************************************************************
+//
+// Advertising Data Filter benchmark
+//
+// Matches a set of advertisements against eight rules: Service UUIDs,
+// Manufacturer Specific Data and local name prefixes. Compares checking
+// each rule with a separate pass over the data using the ad_iterator, as
+// done by applications, with the single pass of ad_filter_match. Both have
+// to report the same rules.
+//
+// *****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ad_parser.h"
+#include "benchmark_util.h"
+#include "bluetooth_data_types.h"
+#include "btstack_util.h"
+
+#define NUM_ITERATIONS  200000
+#define BATCH_SIZE         100
+
+typedef enum {
+    RULE_TYPE_UUID16,
+    RULE_TYPE_UUID128,
+    RULE_TYPE_MANUFACTURER_DATA,
+    RULE_TYPE_NAME_PREFIX,
+} rule_type_t;
+
+typedef struct {
+    rule_type_t     type;
+    uint16_t        uuid16;
+    const uint8_t * uuid128;
+    uint16_t        company_id;
+    const uint8_t * data;
+    const uint8_t * mask;
+    uint8_t         len;
+    const char    * name_prefix;
+} rule_t;
+
+static const uint8_t uuid128_vendor[] = {
+    0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,
+};
+static const uint8_t ibeacon_data[] = { 0x02, 0x15, 0xE2, 0xC5 };
+static const uint8_t ibeacon_mask[] = { 0xFF, 0xFF, 0xFF, 0xFF };
+static const uint8_t eddystone_data[] = { 0x00 };
+
+static const rule_t rules[] = {
+    { RULE_TYPE_UUID16,            0x180D, NULL,           0,      NULL,           NULL,         0, NULL       },
+    { RULE_TYPE_UUID16,            0x181A, NULL,           0,      NULL,           NULL,         0, NULL       },
+    { RULE_TYPE_UUID16,            0xFEAA, NULL,           0,      NULL,           NULL,         0, NULL       },
+    { RULE_TYPE_UUID128,           0,      uuid128_vendor, 0,      NULL,           NULL,         0, NULL       },
+    { RULE_TYPE_MANUFACTURER_DATA, 0,      NULL,           0x004C, ibeacon_data,   ibeacon_mask, 4, NULL       },
+    { RULE_TYPE_MANUFACTURER_DATA, 0,      NULL,           0x0059, eddystone_data, NULL,         1, NULL       },
+    { RULE_TYPE_NAME_PREFIX,       0,      NULL,           0,      NULL,           NULL,         0, "Tracker-" },
+    { RULE_TYPE_NAME_PREFIX,       0,      NULL,           0,      NULL,           NULL,         0, "BTstack"  },
+};
+#define NUM_RULES (sizeof(rules) / sizeof(rule_t))
+
+typedef struct {
+    uint8_t len;
+    uint8_t data[31];
+} advertisement_t;
+
+static const advertisement_t advertisements[] = {
+    // iBeacon
+    { 30, { 0x02, 0x01, 0x06, 0x1A, 0xFF, 0x4C, 0x00, 0x02, 0x15, 0xE2, 0xC5, 0x6D, 0xB5, 0xDF, 0xFB, 0x48,
+            0xD2, 0xB0, 0x60, 0xD0, 0xF5, 0xA7, 0x10, 0x96, 0xE0, 0x00, 0x01, 0x00, 0x02, 0xC5 } },
+    // other Apple device
+    { 17, { 0x02, 0x01, 0x1A, 0x0D, 0xFF, 0x4C, 0x00, 0x10, 0x05, 0x0B, 0x1C, 0xA2, 0x33, 0x7E, 0x01, 0x02,
+            0x03 } },
+    // Heart Rate Sensor with name
+    { 20, { 0x02, 0x01, 0x06, 0x05, 0x03, 0x0D, 0x18, 0x0F, 0x18, 0x0A, 0x09, 'P', 'o', 'l', 'a', 'r', ' ',
+            'H', '1', '0' } },
+    // Eddystone
+    { 26, { 0x02, 0x01, 0x06, 0x03, 0x03, 0xAA, 0xFE, 0x12, 0x16, 0xAA, 0xFE, 0x10, 0x00, 0x03, 'b', 't',
+            's', 't', 'a', 'c', 'k', 0x07, 0x03, 0x03, 0x03, 0x03 } },
+    // asset tracker with vendor service
+    { 31, { 0x02, 0x01, 0x06, 0x11, 0x07, 0x10, 0x0F, 0x0E, 0x0D, 0x0C, 0x0B, 0x0A, 0x09, 0x08, 0x07, 0x06,
+            0x05, 0x04, 0x03, 0x02, 0x01, 0x0A, 0x09, 'T', 'r', 'a', 'c', 'k', 'e', 'r', '-' } },
+    // Microsoft Swift Pair
+    { 31, { 0x1E, 0xFF, 0x06, 0x00, 0x03, 0x00, 0x80, 0x4B, 0x65, 0x79, 0x62, 0x6F, 0x61, 0x72, 0x64, 0x20,
+            0x4D, 0x58, 0x20, 0x4B, 0x65, 0x79, 0x73, 0x20, 0x50, 0x72, 0x6F, 0x00, 0x00, 0x00, 0x00 } },
+    // Nordic device
+    { 25, { 0x02, 0x01, 0x06, 0x08, 0xFF, 0x59, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x0B, 0x09, 'B', 'T',
+            's', 't', 'a', 'c', 'k', ' ', 'L', 'E', 0x00 } },
+    // flags only
+    { 3,  { 0x02, 0x01, 0x06 } },
+};
+#define NUM_ADVERTISEMENTS (sizeof(advertisements) / sizeof(advertisement_t))
+
+static ad_filter_t ad_filter;
+
+// prevent compiler from dropping results
+static volatile uint32_t result_sink;
+
+static bool ad_data_contains_manufacturer_data(uint8_t ad_len, const uint8_t * ad_data, const rule_t * rule){
+    ad_context_t context;
+    for (ad_iterator_init(&context, ad_len, ad_data); ad_iterator_has_more(&context); ad_iterator_next(&context)){
+        if (ad_iterator_get_data_type(&context) != BLUETOOTH_DATA_TYPE_MANUFACTURER_SPECIFIC_DATA) continue;
+        uint8_t data_len = ad_iterator_get_data_len(&context);
+        const uint8_t * data = ad_iterator_get_data(&context);
+        if (data_len < (2 + rule->len)) continue;
+        if (little_endian_read_16(data, 0) != rule->company_id) continue;
+        uint8_t i;
+        for (i=0;i<rule->len;i++){
+            uint8_t mask = (rule->mask != NULL) ? rule->mask[i] : 0xff;
+            if ((data[2+i] & mask) != (rule->data[i] & mask)) break;
+        }
+        if (i == rule->len) return true;
+    }
+    return false;
+}
+
+static bool ad_data_contains_name_prefix(uint8_t ad_len, const uint8_t * ad_data, const char * name_prefix){
+    ad_context_t context;
+    uint8_t prefix_len = (uint8_t) strlen(name_prefix);
+    for (ad_iterator_init(&context, ad_len, ad_data); ad_iterator_has_more(&context); ad_iterator_next(&context)){
+        switch (ad_iterator_get_data_type(&context)){
+            case BLUETOOTH_DATA_TYPE_SHORTENED_LOCAL_NAME:
+            case BLUETOOTH_DATA_TYPE_COMPLETE_LOCAL_NAME:
+                if (ad_iterator_get_data_len(&context) < prefix_len) break;
+                if (memcmp(ad_iterator_get_data(&context), name_prefix, prefix_len) == 0) return true;
+                break;
+            default:
+                break;
+        }
+    }
+    return false;
+}
+
+static uint32_t match_per_rule(uint8_t ad_len, const uint8_t * ad_data){
+    uint32_t matches = 0;
+    unsigned int i;
+    for (i=0;i<NUM_RULES;i++){
+        const rule_t * rule = &rules[i];
+        bool match = false;
+        switch (rule->type){
+            case RULE_TYPE_UUID16:
+                match = ad_data_contains_uuid16(ad_len, ad_data, rule->uuid16);
+                break;
+            case RULE_TYPE_UUID128:
+                match = ad_data_contains_uuid128(ad_len, ad_data, rule->uuid128);
+                break;
+            case RULE_TYPE_MANUFACTURER_DATA:
+                match = ad_data_contains_manufacturer_data(ad_len, ad_data, rule);
+                break;
+            case RULE_TYPE_NAME_PREFIX:
+                match = ad_data_contains_name_prefix(ad_len, ad_data, rule->name_prefix);
+                break;
+            default:
+                break;
+        }
+        if (match){
+            matches |= 1u << i;
+        }
+    }
+    return matches;
+}
+
+static uint32_t match_ad_filter(uint8_t ad_len, const uint8_t * ad_data){
+    return ad_filter_match(&ad_filter, ad_len, ad_data);
+}
+
+static void setup_ad_filter(void){
+    ad_filter_init(&ad_filter);
+    unsigned int i;
+    for (i=0;i<NUM_RULES;i++){
+        const rule_t * rule = &rules[i];
+        switch (rule->type){
+            case RULE_TYPE_UUID16:
+                ad_filter_add_uuid16(&ad_filter, i, rule->uuid16);
+                break;
+            case RULE_TYPE_UUID128:
+                ad_filter_add_uuid128(&ad_filter, i, rule->uuid128);
+                break;
+            case RULE_TYPE_MANUFACTURER_DATA:
+                ad_filter_add_manufacturer_data(&ad_filter, i, rule->company_id, rule->data, rule->mask, rule->len);
+                break;
+            case RULE_TYPE_NAME_PREFIX:
+                ad_filter_add_name_prefix(&ad_filter, i, rule->name_prefix);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static void benchmark_verify(void){
+    unsigned int i;
+    for (i=0;i<NUM_ADVERTISEMENTS;i++){
+        const advertisement_t * advertisement = &advertisements[i];
+        uint32_t expected = match_per_rule(advertisement->len, advertisement->data);
+        uint32_t actual   = match_ad_filter(advertisement->len, advertisement->data);
+        if (expected != actual){
+            fprintf(stderr, "advertisement %u: ad_filter reports rules 0x%02x instead of 0x%02x\n", i, actual, expected);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// measure batches as single advertisements are too fast for the timer
+static void benchmark_run(const char * name, uint32_t (*function)(uint8_t ad_len, const uint8_t * ad_data)){
+    benchmark_stats_t stats;
+    benchmark_stats_init(&stats, name, NUM_ITERATIONS / BATCH_SIZE);
+    uint32_t batch;
+    unsigned int index = 0;
+    for (batch = 0; batch < (NUM_ITERATIONS / BATCH_SIZE); batch++){
+        uint64_t start_ns = benchmark_time_ns();
+        uint16_t i;
+        for (i=0;i<BATCH_SIZE;i++){
+            const advertisement_t * advertisement = &advertisements[index];
+            result_sink = (*function)(advertisement->len, advertisement->data);
+            index++;
+            if (index == NUM_ADVERTISEMENTS){
+                index = 0;
+            }
+        }
+        benchmark_stats_add(&stats, benchmark_time_ns() - start_ns);
+    }
+    benchmark_stats_report(&stats);
+}
+
+int main(int argc, const char * argv[]){
+    if ((argc > 1) && (strcmp(argv[1], "-c") == 0)){
+        benchmark_set_csv_output(1);
+    }
+    benchmark_report_header("batches of 100 advertisements, 8 rules");
+
+    setup_ad_filter();
+    benchmark_verify();
+    benchmark_run("ad_match_per_rule",  &match_per_rule);
+    benchmark_run("ad_match_ad_filter", &match_ad_filter);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+// *****************************************************************************
+//
+// benchmark helpers: monotonic timestamps, latency samples and reporting
+//
+// *****************************************************************************
+
+#include "benchmark_util.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static int          benchmark_csv_output;
+static const char * benchmark_backend = "";
+
+uint64_t benchmark_time_ns(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000ULL) + (uint64_t) now.tv_nsec;
+}
+
+void benchmark_set_csv_output(int enabled){
+    benchmark_csv_output = enabled;
+}
+
+void benchmark_report_header(const char * backend){
+    benchmark_backend = backend;
+    if (benchmark_csv_output) {
+        printf("backend,benchmark,ops,ops_per_sec,p50_us,p90_us,p99_us,max_us\n");
+    } else {
+        printf("\n== %s ==\n", backend);
+        printf("%-28s %8s %12s %10s %10s %10s %10s\n", "benchmark", "ops", "ops/sec", "p50 us", "p90 us", "p99 us", "max us");
+    }
+}
+
+void benchmark_stats_init(benchmark_stats_t * stats, const char * name, uint32_t capacity){
+    memset(stats, 0, sizeof(benchmark_stats_t));
+    stats->name     = name;
+    stats->capacity = capacity;
+    stats->samples  = (uint32_t *) malloc(capacity * sizeof(uint32_t));
+}
+
+void benchmark_stats_add(benchmark_stats_t * stats, uint64_t duration_ns){
+    stats->total_ns += duration_ns;
+    if (stats->num_samples >= stats->capacity) return;
+    if (duration_ns > 0xffffffffULL){
+        duration_ns = 0xffffffffULL;
+    }
+    stats->samples[stats->num_samples++] = (uint32_t) duration_ns;
+}
+
+static int benchmark_compare_samples(const void * a, const void * b){
+    uint32_t sample_a = *(const uint32_t *) a;
+    uint32_t sample_b = *(const uint32_t *) b;
+    if (sample_a < sample_b) return -1;
+    if (sample_a > sample_b) return 1;
+    return 0;
+}
+
+// nearest-rank percentile in us, samples have to be sorted
+static double benchmark_percentile_us(const benchmark_stats_t * stats, uint32_t percent){
+    uint32_t rank = ((stats->num_samples * percent) + 99) / 100;
+    if (rank == 0){
+        rank = 1;
+    }
+    return stats->samples[rank - 1] / 1000.0;
+}
+
+void benchmark_stats_report(benchmark_stats_t * stats){
+    if (stats->num_samples == 0){
+        benchmark_report_skipped(stats->name, "no samples");
+    } else {
+        qsort(stats->samples, stats->num_samples, sizeof(uint32_t), &benchmark_compare_samples);
+        double ops_per_sec = (stats->num_samples * 1000000000.0) / (double) stats->total_ns;
+        double p50 = benchmark_percentile_us(stats, 50);
+        double p90 = benchmark_percentile_us(stats, 90);
+        double p99 = benchmark_percentile_us(stats, 99);
+        double max = stats->samples[stats->num_samples - 1] / 1000.0;
+        if (benchmark_csv_output){
+            printf("%s,%s,%u,%.1f,%.3f,%.3f,%.3f,%.3f\n", benchmark_backend, stats->name, stats->num_samples, ops_per_sec, p50, p90, p99, max);
+        } else {
+            printf("%-28s %8u %12.1f %10.3f %10.3f %10.3f %10.3f\n", stats->name, stats->num_samples, ops_per_sec, p50, p90, p99, max);
+        }
+    }
+    free(stats->samples);
+    stats->samples = NULL;
+}
+
+void benchmark_report_count(const char * name, uint32_t count){
+    if (benchmark_csv_output){
+        printf("%s,%s,%u,,,,,\n", benchmark_backend, name, count);
+    } else {
+        printf("%-28s %8u\n", name, count);
+    }
+}
+
+void benchmark_report_skipped(const char * name, const char * reason){
+    if (benchmark_csv_output){
+        printf("%s,%s,0,,,,,\n", benchmark_backend, name);
+    } else {
+        printf("%-28s -- %s\n", name, reason);
+    }
+}
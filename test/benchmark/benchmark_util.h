@@ -0,0 +1,82 @@
+// *****************************************************************************
+//
+// benchmark helpers: monotonic timestamps, latency samples and reporting
+//
+// *****************************************************************************
+
+#ifndef BENCHMARK_UTIL_H
+#define BENCHMARK_UTIL_H
+
+#include <stdint.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const char * name;
+    // latency samples in ns
+    uint32_t   * samples;
+    uint32_t     capacity;
+    uint32_t     num_samples;
+    // accumulated time of all samples, used for ops/sec
+    uint64_t     total_ns;
+} benchmark_stats_t;
+
+/**
+ * @brief Get monotonic time in ns
+ */
+uint64_t benchmark_time_ns(void);
+
+/**
+ * @brief Select output format: human readable table (default) or CSV for regression tracking
+ * @param enabled
+ */
+void benchmark_set_csv_output(int enabled);
+
+/**
+ * @brief Print header for following reports
+ * @param backend name, e.g. "software" or "controller"
+ */
+void benchmark_report_header(const char * backend);
+
+/**
+ * @brief Init stats, storage is allocated with capacity entries
+ * @param stats
+ * @param name
+ * @param capacity
+ */
+void benchmark_stats_init(benchmark_stats_t * stats, const char * name, uint32_t capacity);
+
+/**
+ * @brief Add latency sample
+ * @param stats
+ * @param duration_ns
+ */
+void benchmark_stats_add(benchmark_stats_t * stats, uint64_t duration_ns);
+
+/**
+ * @brief Report ops/sec and latency percentiles, free storage
+ * @param stats
+ */
+void benchmark_stats_report(benchmark_stats_t * stats);
+
+/**
+ * @brief Report number of events observed during a benchmark, e.g. stalls
+ * @param name
+ * @param count
+ */
+void benchmark_report_count(const char * name, uint32_t count);
+
+/**
+ * @brief Report that a benchmark is not available for current backend
+ * @param name
+ * @param reason
+ */
+void benchmark_report_skipped(const char * name, const char * reason);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // BENCHMARK_UTIL_H
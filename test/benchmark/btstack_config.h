@@ -0,0 +1,32 @@
+//
+// btstack_config.h for benchmarks
+//
+// AES128 and ECC backends are selected per target in the Makefile
+//
+
+#ifndef __BTSTACK_CONFIG
+#define __BTSTACK_CONFIG
+
+// Port related features
+#define HAVE_MALLOC
+#define HAVE_POSIX_TIME
+#define HAVE_POSIX_FILE_IO
+
+// BTstack features that can be enabled
+#define ENABLE_BLE
+#define ENABLE_LE_PERIPHERAL
+#define ENABLE_LE_CENTRAL
+#define ENABLE_LE_SECURE_CONNECTIONS
+
+// BTstack configuration. buffers, sizes, ...
+#ifndef HCI_ACL_PAYLOAD_SIZE
+#define HCI_ACL_PAYLOAD_SIZE 255
+#endif
+// BNEP reconstructs Ethernet header in front of payload
+#define HCI_INCOMING_PRE_BUFFER_SIZE 6
+#define MAX_NR_LE_DEVICE_DB_ENTRIES 4
+#define MAX_NR_HCI_CONNECTIONS 1
+#define MAX_NR_L2CAP_CHANNELS 1
+#define MAX_NR_L2CAP_SERVICES 1
+
+#endif
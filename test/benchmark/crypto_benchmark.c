@@ -0,0 +1,333 @@
+// *****************************************************************************
+//
+// btstack_crypto micro-benchmark
+//
+// Reports ops/sec and latency percentiles for AES-128, AES-CMAC, AES-CCM,
+// P-256 key generation and DHKey calculation. The backend is selected at
+// compile time (see Makefile), AES-CCM is only available with the controller backend:
+// - software:   ENABLE_SOFTWARE_AES128 + ENABLE_MICRO_ECC_P256
+// - controller: HCI LE Encrypt / LE Read Local P256 Public Key / LE Generate DHKey
+//               answered by a mocked HCI Controller using rijndael and micro-ecc
+//
+// *****************************************************************************
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "btstack_crypto.h"
+#include "btstack_debug.h"
+#include "btstack_linked_list.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_cmd.h"
+#include "rijndael.h"
+#include "uECC.h"
+
+#include "benchmark_util.h"
+
+#ifdef ENABLE_SOFTWARE_AES128
+#define BENCHMARK_BACKEND "software"
+#else
+#define BENCHMARK_BACKEND "controller"
+#endif
+
+#define NUM_ITERATIONS_AES128   100000
+#define NUM_ITERATIONS_CMAC      20000
+#define NUM_ITERATIONS_CCM       10000
+#define NUM_ITERATIONS_ECC         100
+
+//
+// mocked HCI: commands are answered with events that are queued and delivered from
+// the benchmark loop, similar to a real HCI round-trip without the transport
+//
+
+#define MOCK_EVENT_QUEUE_SIZE 4
+
+static btstack_linked_list_t mock_event_handlers;
+static uint8_t  mock_event_queue[MOCK_EVENT_QUEUE_SIZE][HCI_EVENT_BUFFER_SIZE];
+static uint16_t mock_event_queue_len[MOCK_EVENT_QUEUE_SIZE];
+static uint8_t  mock_event_queue_head;
+static uint8_t  mock_event_queue_count;
+static uint8_t  mock_packet_buffer[HCI_CMD_HEADER_SIZE + 255];
+
+#ifndef ENABLE_SOFTWARE_AES128
+static uint8_t  mock_ecc_private_key[32];
+#endif
+
+static int benchmark_uecc_rng(uint8_t * dest, unsigned size){
+    while (size > 0){
+        *dest++ = (uint8_t) rand();
+        size--;
+    }
+    return 1;
+}
+
+void hci_add_event_handler(btstack_packet_callback_registration_t * callback_handler){
+    btstack_linked_list_add(&mock_event_handlers, (btstack_linked_item_t *) callback_handler);
+}
+
+int hci_can_send_command_packet_now(void){
+    return 1;
+}
+
+HCI_STATE hci_get_state(void){
+    return HCI_STATE_WORKING;
+}
+
+void hci_halting_defer(void){
+}
+
+static uint8_t * mock_event_queue_reserve(void){
+    btstack_assert(mock_event_queue_count < MOCK_EVENT_QUEUE_SIZE);
+    uint8_t index = (mock_event_queue_head + mock_event_queue_count) % MOCK_EVENT_QUEUE_SIZE;
+    return mock_event_queue[index];
+}
+
+static void mock_event_queue_commit(uint16_t len){
+    uint8_t index = (mock_event_queue_head + mock_event_queue_count) % MOCK_EVENT_QUEUE_SIZE;
+    mock_event_queue_len[index] = len;
+    mock_event_queue_count++;
+}
+
+static void mock_queue_command_complete(uint16_t opcode, const uint8_t * return_params, uint16_t return_params_len){
+    uint8_t * event = mock_event_queue_reserve();
+    event[0] = HCI_EVENT_COMMAND_COMPLETE;
+    event[1] = 4 + return_params_len;
+    event[2] = 1;
+    little_endian_store_16(event, 3, opcode);
+    event[5] = ERROR_CODE_SUCCESS;
+    (void)memcpy(&event[6], return_params, return_params_len);
+    mock_event_queue_commit(6 + return_params_len);
+}
+
+#ifndef ENABLE_SOFTWARE_AES128
+static void mock_queue_le_meta_event(uint8_t subevent_code, const uint8_t * params, uint16_t params_len){
+    uint8_t * event = mock_event_queue_reserve();
+    event[0] = HCI_EVENT_LE_META;
+    event[1] = 2 + params_len;
+    event[2] = subevent_code;
+    event[3] = ERROR_CODE_SUCCESS;
+    (void)memcpy(&event[4], params, params_len);
+    mock_event_queue_commit(4 + params_len);
+}
+#endif
+
+// deliver queued events
+static void mock_hci_process(void){
+    while (mock_event_queue_count > 0){
+        uint8_t * event = mock_event_queue[mock_event_queue_head];
+        uint16_t  size  = mock_event_queue_len[mock_event_queue_head];
+        mock_event_queue_head = (mock_event_queue_head + 1) % MOCK_EVENT_QUEUE_SIZE;
+        mock_event_queue_count--;
+        btstack_linked_list_iterator_t it;
+        btstack_linked_list_iterator_init(&it, &mock_event_handlers);
+        while (btstack_linked_list_iterator_has_next(&it)){
+            btstack_packet_callback_registration_t * item = (btstack_packet_callback_registration_t *) btstack_linked_list_iterator_next(&it);
+            item->callback(HCI_EVENT_PACKET, 0, event, size);
+        }
+    }
+}
+
+int hci_send_cmd(const hci_cmd_t * cmd, ...){
+    va_list argptr;
+    va_start(argptr, cmd);
+    uint16_t len = hci_cmd_create_from_template(mock_packet_buffer, cmd, argptr);
+    va_end(argptr);
+    UNUSED(len);
+
+    if (cmd->opcode == hci_le_rand.opcode){
+        uint8_t random[8];
+        uint8_t i;
+        for (i = 0; i < sizeof(random); i++){
+            random[i] = (uint8_t) rand();
+        }
+        mock_queue_command_complete(cmd->opcode, random, sizeof(random));
+    }
+#ifndef ENABLE_SOFTWARE_AES128
+    else if (cmd->opcode == hci_le_encrypt.opcode){
+        // command and event use little endian byte order
+        uint8_t key[16];
+        uint8_t plaintext[16];
+        uint8_t ciphertext[16];
+        uint8_t ciphertext_flipped[16];
+        reverse_128(&mock_packet_buffer[3],  key);
+        reverse_128(&mock_packet_buffer[19], plaintext);
+        uint32_t rk[RKLENGTH(KEYBITS)];
+        int nrounds = rijndaelSetupEncrypt(rk, key, KEYBITS);
+        rijndaelEncrypt(rk, nrounds, plaintext, ciphertext);
+        reverse_128(ciphertext, ciphertext_flipped);
+        mock_queue_command_complete(cmd->opcode, ciphertext_flipped, sizeof(ciphertext_flipped));
+    }
+    else if (cmd->opcode == hci_le_read_local_p256_public_key.opcode){
+        // X and Y coordinates are sent in little endian byte order
+        uint8_t public_key[64];
+        uint8_t public_key_flipped[64];
+        uECC_set_rng(&benchmark_uecc_rng);
+        uECC_make_key(public_key, mock_ecc_private_key);
+        reverse_256(&public_key[0],  &public_key_flipped[0]);
+        reverse_256(&public_key[32], &public_key_flipped[32]);
+        mock_queue_le_meta_event(HCI_SUBEVENT_LE_READ_LOCAL_P256_PUBLIC_KEY_COMPLETE, public_key_flipped, sizeof(public_key_flipped));
+    }
+    else if (cmd->opcode == hci_le_generate_dhkey.opcode){
+        uint8_t public_key[64];
+        uint8_t dhkey[32];
+        uint8_t dhkey_flipped[32];
+        reverse_256(&mock_packet_buffer[3],  &public_key[0]);
+        reverse_256(&mock_packet_buffer[35], &public_key[32]);
+        uECC_shared_secret(public_key, mock_ecc_private_key, dhkey);
+        reverse_256(dhkey, dhkey_flipped);
+        mock_queue_le_meta_event(HCI_SUBEVENT_LE_GENERATE_DHKEY_COMPLETE, dhkey_flipped, sizeof(dhkey_flipped));
+    }
+#endif
+    return 0;
+}
+
+//
+// benchmarks
+//
+
+static int operation_done;
+
+static void operation_done_handler(void * arg){
+    UNUSED(arg);
+    operation_done = 1;
+}
+
+static void wait_for_operation(void){
+    while (!operation_done){
+        mock_hci_process();
+    }
+    operation_done = 0;
+}
+
+static const uint8_t benchmark_key[16] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+#ifndef ENABLE_SOFTWARE_AES128
+static const uint8_t benchmark_nonce[13] = {
+    0x00, 0x03, 0x07, 0x08, 0x0d, 0x12, 0x34, 0x00, 0x00, 0x12, 0x34, 0x56, 0x77
+};
+#endif
+
+static uint8_t benchmark_message[1024];
+
+static void benchmark_aes128(void){
+    btstack_crypto_aes128_t request;
+    uint8_t ciphertext[16];
+    benchmark_stats_t stats;
+    benchmark_stats_init(&stats, "aes128", NUM_ITERATIONS_AES128);
+    uint32_t i;
+    for (i = 0; i < NUM_ITERATIONS_AES128; i++){
+        uint64_t start = benchmark_time_ns();
+        btstack_crypto_aes128_encrypt(&request, benchmark_key, benchmark_message, ciphertext, &operation_done_handler, NULL);
+        wait_for_operation();
+        benchmark_stats_add(&stats, benchmark_time_ns() - start);
+    }
+    benchmark_stats_report(&stats);
+}
+
+static void benchmark_cmac(uint16_t message_len){
+    btstack_crypto_aes128_cmac_t request;
+    uint8_t hash[16];
+    char name[32];
+    snprintf(name, sizeof(name), "aes_cmac_%u", message_len);
+    benchmark_stats_t stats;
+    benchmark_stats_init(&stats, name, NUM_ITERATIONS_CMAC);
+    uint32_t i;
+    for (i = 0; i < NUM_ITERATIONS_CMAC; i++){
+        uint64_t start = benchmark_time_ns();
+        btstack_crypto_aes128_cmac_message(&request, benchmark_key, message_len, benchmark_message, hash, &operation_done_handler, NULL);
+        wait_for_operation();
+        benchmark_stats_add(&stats, benchmark_time_ns() - start);
+    }
+    benchmark_stats_report(&stats);
+}
+
+#ifndef ENABLE_SOFTWARE_AES128
+static void benchmark_ccm(uint16_t message_len){
+    char name[32];
+    snprintf(name, sizeof(name), "aes_ccm_encrypt_%u", message_len);
+    // AES-CCM as used by Mesh Upper Transport: 16 byte AAD (label uuid), 8 byte MIC
+    btstack_crypto_ccm_t request;
+    uint8_t ciphertext[1024];
+    uint8_t mic[8];
+    uint8_t aad[16];
+    memset(aad, 0x55, sizeof(aad));
+    benchmark_stats_t stats;
+    benchmark_stats_init(&stats, name, NUM_ITERATIONS_CCM);
+    uint32_t i;
+    for (i = 0; i < NUM_ITERATIONS_CCM; i++){
+        uint64_t start = benchmark_time_ns();
+        btstack_crypto_ccm_init(&request, benchmark_key, benchmark_nonce, message_len, sizeof(aad), sizeof(mic));
+        btstack_crypto_ccm_digest(&request, aad, sizeof(aad), &operation_done_handler, NULL);
+        wait_for_operation();
+        btstack_crypto_ccm_encrypt_block(&request, message_len, benchmark_message, ciphertext, &operation_done_handler, NULL);
+        wait_for_operation();
+        btstack_crypto_ccm_get_authentication_value(&request, mic);
+        benchmark_stats_add(&stats, benchmark_time_ns() - start);
+    }
+    benchmark_stats_report(&stats);
+}
+#endif
+
+static void benchmark_ecc_p256(void){
+    btstack_crypto_ecc_p256_t request;
+    uint8_t public_key[64];
+    uint8_t peer_public_key[64];
+    uint8_t peer_private_key[32];
+    uint8_t dhkey[32];
+    uint32_t i;
+
+    benchmark_stats_t stats;
+    benchmark_stats_init(&stats, "ecc_p256_generate_key", NUM_ITERATIONS_ECC);
+    for (i = 0; i < NUM_ITERATIONS_ECC; i++){
+        uint64_t start = benchmark_time_ns();
+        btstack_crypto_ecc_p256_generate_key(&request, public_key, &operation_done_handler, NULL);
+        wait_for_operation();
+        benchmark_stats_add(&stats, benchmark_time_ns() - start);
+    }
+    benchmark_stats_report(&stats);
+
+    // peer key, btstack_crypto resets the micro-ecc rng after key generation
+    uECC_set_rng(&benchmark_uecc_rng);
+    uECC_make_key(peer_public_key, peer_private_key);
+
+    benchmark_stats_init(&stats, "ecc_p256_calculate_dhkey", NUM_ITERATIONS_ECC);
+    for (i = 0; i < NUM_ITERATIONS_ECC; i++){
+        uint64_t start = benchmark_time_ns();
+        btstack_crypto_ecc_p256_calculate_dhkey(&request, peer_public_key, dhkey, &operation_done_handler, NULL);
+        wait_for_operation();
+        benchmark_stats_add(&stats, benchmark_time_ns() - start);
+    }
+    benchmark_stats_report(&stats);
+}
+
+int main(int argc, const char * argv[]){
+    if ((argc > 1) && (strcmp(argv[1], "-c") == 0)){
+        benchmark_set_csv_output(1);
+    }
+
+    uint16_t i;
+    for (i = 0; i < sizeof(benchmark_message); i++){
+        benchmark_message[i] = (uint8_t) i;
+    }
+
+    btstack_crypto_init();
+
+    benchmark_report_header(BENCHMARK_BACKEND);
+    benchmark_aes128();
+    benchmark_cmac(16);
+    benchmark_cmac(64);
+    benchmark_cmac(256);
+    benchmark_cmac(1024);
+#ifndef ENABLE_SOFTWARE_AES128
+    benchmark_ccm(16);
+    benchmark_ccm(64);
+    benchmark_ccm(384);
+#endif
+    benchmark_ecc_p256();
+    return 0;
+}
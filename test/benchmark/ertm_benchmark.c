@@ -0,0 +1,290 @@
+// *****************************************************************************
+//
+// L2CAP Enhanced Retransmission Mode throughput benchmark
+//
+// Runs sender and receiver in two processes with the full BTstack host stack,
+// connected via mock controllers over BR/EDR. The sender streams SDUs over an
+// ERTM channel, the receiver measures the time to receive each block of SDUs.
+// Compares the standard window of 8 and 63 frames with an extended window of
+// 256 frames, on a lossless link and on a link that drops every 50th I-Frame.
+// The FCS implementation is selected per target in the Makefile.
+//
+// *****************************************************************************
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "btstack_config.h"
+
+#include "benchmark_util.h"
+#include "btstack_event.h"
+#include "btstack_memory.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "gap.h"
+#include "hci.h"
+#include "l2cap.h"
+#include "mock_controller.h"
+
+#define SDU_SIZE          1000
+#define SDUS_PER_BLOCK      64
+#define NUM_BLOCKS          50
+#define MAX_WINDOW_SIZE    256
+#define PSM_BENCHMARK   0x1001
+
+// per frame: rx and tx buffer, packet states, headers and fcs
+#define ERTM_BUFFER_SIZE(window) (((window) * 2 * (SDU_SIZE + 64)) + SDU_SIZE + 16)
+
+#ifdef ENABLE_L2CAP_ERTM_FCS_SLICING_BY_8
+#define BACKEND_NAME "fcs slicing-by-8"
+#else
+#define BACKEND_NAME "fcs byte-wise"
+#endif
+
+typedef struct {
+    const char * name;
+    uint16_t     window_size;
+    uint16_t     acl_drop_interval;
+} benchmark_run_t;
+
+static const benchmark_run_t benchmark_runs[] = {
+    { "ertm_window_8",            8,  0 },
+    { "ertm_window_63",          63,  0 },
+    { "ertm_window_256_ext",    256,  0 },
+    { "ertm_window_8_lossy",      8, 50 },
+    { "ertm_window_63_lossy",    63, 50 },
+    { "ertm_window_256_lossy",  256, 50 },
+};
+#define NUM_BENCHMARK_RUNS (sizeof(benchmark_runs) / sizeof(benchmark_run_t))
+
+static const bd_addr_t sender_address   = { 0x00, 0x1B, 0xDC, 0x07, 0x00, 0x01 };
+static const bd_addr_t receiver_address = { 0x00, 0x1B, 0xDC, 0x07, 0x00, 0x02 };
+
+static mock_controller_config_t controller_config;
+static btstack_packet_callback_registration_t hci_event_callback_registration;
+
+static l2cap_ertm_config_t ertm_config;
+static uint8_t ertm_buffer[ERTM_BUFFER_SIZE(MAX_WINDOW_SIZE)];
+static uint8_t sdu[SDU_SIZE];
+
+// SDUs are numbered to verify in-order delivery
+static uint32_t sdu_nr;
+
+static btstack_timer_source_t next_run_timer;
+
+static pid_t    receiver_pid;
+static uint16_t l2cap_cid;
+static unsigned int benchmark_run_index;
+
+// receiver, runs are executed in order
+static const benchmark_run_t * receiver_run;
+static unsigned int receiver_run_index;
+static benchmark_stats_t benchmark_stats;
+static uint64_t block_start_ns;
+static uint16_t num_sdus_received;
+static uint16_t num_blocks_received;
+
+static void sender_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size);
+
+static void ertm_config_init(const benchmark_run_t * run){
+    memset(&ertm_config, 0, sizeof(ertm_config));
+    ertm_config.ertm_mandatory = 1;
+    ertm_config.max_transmit = 20;
+    ertm_config.retransmission_timeout_ms = 2000;
+    ertm_config.monitor_timeout_ms = 12000;
+    ertm_config.local_mtu = SDU_SIZE;
+    ertm_config.num_tx_buffers = run->window_size;
+    ertm_config.num_rx_buffers = run->window_size;
+    ertm_config.fcs_option = 1;
+}
+
+static void sender_start_run(btstack_timer_source_t * ts){
+    UNUSED(ts);
+    if (benchmark_run_index >= NUM_BENCHMARK_RUNS){
+        kill(receiver_pid, SIGTERM);
+        waitpid(receiver_pid, NULL, 0);
+        exit(EXIT_SUCCESS);
+    }
+    const benchmark_run_t * run = &benchmark_runs[benchmark_run_index];
+    // only I-Frames from sender to receiver get lost
+    controller_config.acl_drop_interval = run->acl_drop_interval;
+    ertm_config_init(run);
+    uint8_t status = l2cap_create_ertm_channel(&sender_packet_handler, (uint8_t *) receiver_address, PSM_BENCHMARK, &ertm_config,
+                                               ertm_buffer, ERTM_BUFFER_SIZE(run->window_size), &l2cap_cid);
+    if (status != ERROR_CODE_SUCCESS){
+        fprintf(stderr, "%s: create ERTM channel failed, status 0x%02x\n", run->name, status);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void sender_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    uint8_t status;
+    switch (packet_type){
+        case L2CAP_DATA_PACKET:
+            // receiver has measured all blocks, frames sent afterwards only avoid tail loss
+            l2cap_disconnect(l2cap_cid, 0);
+            break;
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case BTSTACK_EVENT_STATE:
+                    if (btstack_event_state_get_state(packet) != HCI_STATE_WORKING) break;
+                    sender_start_run(NULL);
+                    break;
+                case L2CAP_EVENT_CHANNEL_OPENED:
+                    sdu_nr = 0;
+                    status = l2cap_event_channel_opened_get_status(packet);
+                    if (status != ERROR_CODE_SUCCESS){
+                        fprintf(stderr, "%s: channel open failed, status 0x%02x\n", benchmark_runs[benchmark_run_index].name, status);
+                        exit(EXIT_FAILURE);
+                    }
+                    l2cap_request_can_send_now_event(l2cap_cid);
+                    break;
+                case L2CAP_EVENT_CAN_SEND_NOW:
+                    little_endian_store_32(sdu, 0, sdu_nr++);
+                    status = (uint8_t) l2cap_send(l2cap_cid, sdu, sizeof(sdu));
+                    if (status != ERROR_CODE_SUCCESS){
+                        fprintf(stderr, "%s: send failed, status 0x%02x\n", benchmark_runs[benchmark_run_index].name, status);
+                        exit(EXIT_FAILURE);
+                    }
+                    l2cap_request_can_send_now_event(l2cap_cid);
+                    break;
+                case L2CAP_EVENT_CHANNEL_CLOSED:
+                    // channel is freed after event, start next run from run loop
+                    benchmark_run_index++;
+                    btstack_run_loop_set_timer_handler(&next_run_timer, &sender_start_run);
+                    btstack_run_loop_set_timer(&next_run_timer, 0);
+                    btstack_run_loop_add_timer(&next_run_timer);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void receiver_handle_sdu(const uint8_t * packet, uint16_t size){
+    if ((size != SDU_SIZE) || (little_endian_read_32(packet, 0) != sdu_nr)){
+        fprintf(stderr, "%s: SDU %u missing\n", receiver_run->name, sdu_nr);
+        exit(EXIT_FAILURE);
+    }
+    sdu_nr++;
+
+    num_sdus_received++;
+    if (num_sdus_received < SDUS_PER_BLOCK) return;
+    num_sdus_received = 0;
+
+    uint64_t now_ns = benchmark_time_ns();
+    benchmark_stats_add(&benchmark_stats, now_ns - block_start_ns);
+    block_start_ns = now_ns;
+
+    num_blocks_received++;
+    if (num_blocks_received < NUM_BLOCKS) return;
+    benchmark_stats_report(&benchmark_stats);
+    fflush(stdout);
+
+    // ask sender to close the channel
+    uint8_t done = 0;
+    l2cap_send(l2cap_cid, &done, 1);
+}
+
+static void receiver_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    switch (packet_type){
+        case L2CAP_DATA_PACKET:
+            if (num_blocks_received >= NUM_BLOCKS) break;
+            receiver_handle_sdu(packet, size);
+            break;
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case L2CAP_EVENT_INCOMING_CONNECTION:
+                    l2cap_cid = l2cap_event_incoming_connection_get_local_cid(packet);
+                    receiver_run = &benchmark_runs[receiver_run_index];
+                    ertm_config_init(receiver_run);
+                    l2cap_accept_ertm_connection(l2cap_cid, &ertm_config, ertm_buffer, ERTM_BUFFER_SIZE(receiver_run->window_size));
+                    break;
+                case L2CAP_EVENT_CHANNEL_OPENED:
+                    benchmark_stats_init(&benchmark_stats, receiver_run->name, NUM_BLOCKS);
+                    sdu_nr = 0;
+                    num_sdus_received = 0;
+                    num_blocks_received = 0;
+                    block_start_ns = benchmark_time_ns();
+                    break;
+                case L2CAP_EVENT_CHANNEL_CLOSED:
+                    receiver_run_index++;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void stack_init(int fd, const bd_addr_t public_address){
+    controller_config.peer_fd = fd;
+    (void)memcpy(controller_config.public_address, public_address, 6);
+    controller_config.le_acl_packet_length     = 27;
+    controller_config.le_acl_packets_total_num = 8;
+    controller_config.acl_packet_length        = 1021;
+    controller_config.acl_packets_total_num    = 8;
+
+    btstack_memory_init();
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+    hci_init(mock_controller_transport_instance(), &controller_config);
+    l2cap_init();
+    gap_set_security_level(LEVEL_0);
+}
+
+int main(int argc, const char * argv[]){
+    int sockets[2];
+
+    if ((argc > 1) && (strcmp(argv[1], "-c") == 0)){
+        benchmark_set_csv_output(1);
+    }
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) != 0){
+        perror("socketpair");
+        return EXIT_FAILURE;
+    }
+
+    char backend[60];
+    snprintf(backend, sizeof(backend), "%s, blocks of %u SDUs with %u bytes", BACKEND_NAME, SDUS_PER_BLOCK, SDU_SIZE);
+    benchmark_report_header(backend);
+
+    // make output visible before fork
+    fflush(stdout);
+
+    receiver_pid = fork();
+    if (receiver_pid < 0){
+        perror("fork");
+        return EXIT_FAILURE;
+    }
+
+    if (receiver_pid == 0){
+        // Receiver accepts channels for all runs and reports
+        close(sockets[0]);
+        stack_init(sockets[1], receiver_address);
+        l2cap_register_service(&receiver_packet_handler, PSM_BENCHMARK, SDU_SIZE, LEVEL_0);
+    } else {
+        // Sender streams SDUs until receiver is done
+        close(sockets[1]);
+        stack_init(sockets[0], sender_address);
+        hci_event_callback_registration.callback = &sender_packet_handler;
+        hci_add_event_handler(&hci_event_callback_registration);
+    }
+
+    hci_power_control(HCI_POWER_ON);
+    btstack_run_loop_execute();
+    return EXIT_SUCCESS;
+}
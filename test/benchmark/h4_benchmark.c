@@ -0,0 +1,145 @@
+// *****************************************************************************
+//
+// H4 receive throughput benchmark
+//
+// Streams HCI ACL packets through a pty into the H4 transport on top of the
+// POSIX UART driver and compares block mode, which reads type, header and
+// payload separately, with streaming mode.
+//
+// *****************************************************************************
+
+// posix_openpt, grantpt, unlockpt, ptsname
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "btstack_config.h"
+
+#include "benchmark_util.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "btstack_uart_block.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_transport.h"
+
+static hci_transport_config_uart_t config = {
+    HCI_TRANSPORT_CONFIG_UART,
+    115200,
+    0,  // main baudrate
+    0,  // flow control
+    NULL,
+};
+
+static btstack_data_source_t writer_data_source;
+static uint8_t * writer_data;
+static uint32_t  writer_len;
+static uint32_t  writer_pos;
+
+static benchmark_stats_t benchmark_stats;
+static uint32_t num_packets_expected;
+static uint32_t num_packets_received;
+static uint64_t last_packet_ns;
+
+static void writer_process(btstack_data_source_t * ds, btstack_data_source_callback_type_t callback_type){
+    UNUSED(callback_type);
+    ssize_t bytes_written = write(ds->source.fd, &writer_data[writer_pos], writer_len - writer_pos);
+    if (bytes_written <= 0) return;
+    writer_pos += (uint32_t) bytes_written;
+    if (writer_pos == writer_len){
+        btstack_run_loop_disable_data_source_callbacks(ds, DATA_SOURCE_CALLBACK_WRITE);
+    }
+}
+
+static void packet_handler(uint8_t packet_type, uint8_t *packet, uint16_t size){
+    UNUSED(packet);
+    UNUSED(size);
+    if (packet_type != HCI_ACL_DATA_PACKET) return;
+    uint64_t now = benchmark_time_ns();
+    benchmark_stats_add(&benchmark_stats, now - last_packet_ns);
+    last_packet_ns = now;
+    num_packets_received++;
+    if (num_packets_received < num_packets_expected) return;
+    benchmark_stats_report(&benchmark_stats);
+    exit(EXIT_SUCCESS);
+}
+
+static void benchmark_run(const char * name, int streaming, uint16_t payload_len, uint32_t num_packets){
+    // pty
+    int master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((master_fd < 0) || (grantpt(master_fd) != 0) || (unlockpt(master_fd) != 0)){
+        perror("posix_openpt");
+        exit(EXIT_FAILURE);
+    }
+    fcntl(master_fd, F_SETFL, fcntl(master_fd, F_GETFL) | O_NONBLOCK);
+    config.device_name = ptsname(master_fd);
+
+    // H4 ACL packets with handle 0x0001, first fragment
+    uint16_t packet_len = 1 + HCI_ACL_HEADER_SIZE + payload_len;
+    writer_len = packet_len * num_packets;
+    writer_data = (uint8_t *) malloc(writer_len);
+    uint32_t i;
+    for (i=0;i<num_packets;i++){
+        uint8_t * packet = &writer_data[i * packet_len];
+        packet[0] = HCI_ACL_DATA_PACKET;
+        little_endian_store_16(packet, 1, 0x2001);
+        little_endian_store_16(packet, 3, payload_len);
+        memset(&packet[5], (uint8_t) i, payload_len);
+    }
+    writer_pos = 0;
+
+    // use POSIX UART driver with or without streaming support
+    static btstack_uart_block_t uart_driver;
+    uart_driver = *btstack_uart_block_posix_instance();
+    if (!streaming){
+        uart_driver.set_data_received = NULL;
+    }
+
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+    const hci_transport_t * transport = hci_transport_h4_instance(&uart_driver);
+    transport->init(&config);
+    transport->register_packet_handler(&packet_handler);
+    if (transport->open() != 0){
+        fprintf(stderr, "failed to open %s\n", config.device_name);
+        exit(EXIT_FAILURE);
+    }
+
+    benchmark_stats_init(&benchmark_stats, name, num_packets);
+    num_packets_expected = num_packets;
+    num_packets_received = 0;
+    last_packet_ns = benchmark_time_ns();
+
+    btstack_run_loop_set_data_source_fd(&writer_data_source, master_fd);
+    btstack_run_loop_set_data_source_handler(&writer_data_source, &writer_process);
+    btstack_run_loop_enable_data_source_callbacks(&writer_data_source, DATA_SOURCE_CALLBACK_WRITE);
+    btstack_run_loop_add_data_source(&writer_data_source);
+
+    btstack_run_loop_execute();
+}
+
+static void benchmark_fork(const char * name, int streaming, uint16_t payload_len, uint32_t num_packets){
+    // run loop cannot be stopped, use a new process for each run
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0){
+        benchmark_run(name, streaming, payload_len, num_packets);
+    }
+    waitpid(pid, NULL, 0);
+}
+
+int main(int argc, const char * argv[]){
+    if ((argc > 1) && (strcmp(argv[1], "-c") == 0)){
+        benchmark_set_csv_output(1);
+    }
+    benchmark_report_header("posix-pty");
+    benchmark_fork("h4_rx_acl_27_block",   0,  27, 50000);
+    benchmark_fork("h4_rx_acl_27_stream",  1,  27, 50000);
+    benchmark_fork("h4_rx_acl_251_block",  0, 251, 20000);
+    benchmark_fork("h4_rx_acl_251_stream", 1, 251, 20000);
+    return EXIT_SUCCESS;
+}
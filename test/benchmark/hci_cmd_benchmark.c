@@ -0,0 +1,130 @@
+// *****************************************************************************
+//
+// HCI Command encoding benchmark
+//
+// Compares hci_cmd_create_from_template, which interprets the format string
+// of each hci_cmd_t, with the typed encoders generated into hci_cmd_encoder.h
+// for commands sent frequently by an LE Central. Both have to produce the
+// same packets.
+//
+// *****************************************************************************
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark_util.h"
+#include "btstack_util.h"
+#include "hci_cmd.h"
+#include "hci_cmd_encoder.h"
+
+#define NUM_ITERATIONS  200000
+#define BATCH_SIZE         100
+
+static uint8_t packet_template[HCI_CMD_HEADER_SIZE + 255];
+static uint8_t packet_encoder[HCI_CMD_HEADER_SIZE + 255];
+static const bd_addr_t peer_addr = { 0x00, 0x1b, 0xdc, 0x07, 0x32, 0xef };
+
+// prevent compiler from dropping encoded packets
+static volatile uint8_t packet_sink;
+
+static uint16_t create_from_template(uint8_t * packet, const hci_cmd_t * cmd, ...){
+    va_list argptr;
+    va_start(argptr, cmd);
+    uint16_t size = hci_cmd_create_from_template(packet, cmd, argptr);
+    va_end(argptr);
+    return size;
+}
+
+static uint16_t template_le_connection_update(uint8_t * packet, uint16_t i){
+    return create_from_template(packet, &hci_le_connection_update, 0x0040, 6 + i % 10, 12, 0, 400, 0x0000, 0xffff);
+}
+
+static uint16_t encoder_le_connection_update(uint8_t * packet, uint16_t i){
+    return hci_cmd_encode_le_connection_update(packet, 0x0040, 6 + i % 10, 12, 0, 400, 0x0000, 0xffff);
+}
+
+static uint16_t template_le_set_scan_enable(uint8_t * packet, uint16_t i){
+    return create_from_template(packet, &hci_le_set_scan_enable, i & 1, 0);
+}
+
+static uint16_t encoder_le_set_scan_enable(uint8_t * packet, uint16_t i){
+    return hci_cmd_encode_le_set_scan_enable(packet, i & 1, 0);
+}
+
+static uint16_t template_le_create_connection(uint8_t * packet, uint16_t i){
+    return create_from_template(packet, &hci_le_create_connection, 0x60, 0x30, 0, 0, peer_addr, 0, 6 + i % 10, 12, 0, 400, 2, 0x30);
+}
+
+static uint16_t encoder_le_create_connection(uint8_t * packet, uint16_t i){
+    return hci_cmd_encode_le_create_connection(packet, 0x60, 0x30, 0, 0, peer_addr, 0, 6 + i % 10, 12, 0, 400, 2, 0x30);
+}
+
+static uint16_t template_disconnect(uint8_t * packet, uint16_t i){
+    return create_from_template(packet, &hci_disconnect, 0x0040 + i % 4, 0x13);
+}
+
+static uint16_t encoder_disconnect(uint8_t * packet, uint16_t i){
+    return hci_cmd_encode_disconnect(packet, 0x0040 + i % 4, 0x13);
+}
+
+typedef struct {
+    const char * name;
+    uint16_t (*template_function)(uint8_t * packet, uint16_t i);
+    uint16_t (*encoder_function)(uint8_t * packet, uint16_t i);
+} benchmark_command_t;
+
+static const benchmark_command_t benchmark_commands[] = {
+    { "le_connection_update", &template_le_connection_update, &encoder_le_connection_update },
+    { "le_set_scan_enable",   &template_le_set_scan_enable,   &encoder_le_set_scan_enable   },
+    { "le_create_connection", &template_le_create_connection, &encoder_le_create_connection },
+    { "disconnect",           &template_disconnect,           &encoder_disconnect           },
+};
+
+static void benchmark_verify(const benchmark_command_t * command){
+    uint16_t i;
+    for (i=0;i<20;i++){
+        uint16_t size_template = (*command->template_function)(packet_template, i);
+        uint16_t size_encoder  = (*command->encoder_function)(packet_encoder, i);
+        if ((size_template != size_encoder) || (memcmp(packet_template, packet_encoder, size_template) != 0)){
+            fprintf(stderr, "%s: encoder differs from template\n", command->name);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// measure batches as single commands are too fast for the timer
+static void benchmark_run(const char * prefix, const char * name, uint8_t * packet, uint16_t (*function)(uint8_t * packet, uint16_t i)){
+    char stats_name[40];
+    snprintf(stats_name, sizeof(stats_name), "%s_%s", prefix, name);
+    benchmark_stats_t stats;
+    benchmark_stats_init(&stats, stats_name, NUM_ITERATIONS / BATCH_SIZE);
+    uint32_t batch;
+    for (batch = 0; batch < (NUM_ITERATIONS / BATCH_SIZE); batch++){
+        uint64_t start_ns = benchmark_time_ns();
+        uint16_t i;
+        for (i=0;i<BATCH_SIZE;i++){
+            (*function)(packet, i);
+            packet_sink = packet[3];
+        }
+        benchmark_stats_add(&stats, benchmark_time_ns() - start_ns);
+    }
+    benchmark_stats_report(&stats);
+}
+
+int main(int argc, const char * argv[]){
+    if ((argc > 1) && (strcmp(argv[1], "-c") == 0)){
+        benchmark_set_csv_output(1);
+    }
+    benchmark_report_header("batches of 100 commands");
+
+    unsigned int i;
+    for (i=0;i<sizeof(benchmark_commands)/sizeof(benchmark_command_t);i++){
+        const benchmark_command_t * command = &benchmark_commands[i];
+        benchmark_verify(command);
+        benchmark_run("template", command->name, packet_template, command->template_function);
+        benchmark_run("encoder",  command->name, packet_encoder,  command->encoder_function);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,189 @@
+// *****************************************************************************
+//
+// HCI Event dispatch benchmark
+//
+// Feeds LE Advertising Reports into hci.c and measures the time to deliver
+// them to a set of event handlers that emulate profiles, which run their state
+// machine on every event like L2CAP, SM, and GATT Client, plus a single
+// catch-all application handler. Compares registration without event filter,
+// with the filter used by the stack modules that skips scan results, and with
+// an event filter that only lists a few connection related events.
+//
+// *****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "benchmark_util.h"
+#include "btstack_event.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_transport.h"
+
+#define NUM_PROFILE_HANDLERS    8
+#define NUM_PROFILE_CONNECTIONS 4
+#define NUM_ITERATIONS     200000
+#define BATCH_SIZE            100
+
+static void (*transport_packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
+
+static btstack_packet_callback_registration_t profile_callback_registrations[NUM_PROFILE_HANDLERS];
+static btstack_event_filter_t                 profile_event_filters[NUM_PROFILE_HANDLERS];
+static btstack_packet_callback_registration_t app_callback_registration;
+
+static uint32_t num_profile_events;
+static uint32_t num_app_events;
+
+// LE Advertising Report with a single iBeacon report
+static uint8_t advertising_report[] = {
+    HCI_EVENT_LE_META, 42, HCI_SUBEVENT_LE_ADVERTISING_REPORT, 1, 0, 0, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 30,
+    0x02, 0x01, 0x06, 0x1a, 0xff, 0x4c, 0x00, 0x02, 0x15, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+    0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x00, 0x01, 0x00, 0x02, 0xc5, 0xc4,
+};
+
+static void transport_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
+    transport_packet_handler = handler;
+}
+
+static const hci_transport_t transport = {
+    /* .name = */ "benchmark",
+    /* .init = */ NULL,
+    /* .open = */ NULL,
+    /* .close = */ NULL,
+    /* .register_packet_handler = */ &transport_register_packet_handler,
+    /* .can_send_packet_now = */ NULL,
+    /* .send_packet = */ NULL,
+    /* .set_baudrate = */ NULL,
+    /* .reset_link = */ NULL,
+    /* .set_sco_config = */ NULL,
+};
+
+// connections with pending work that cannot be sent yet, as there's no ACL connection
+static hci_con_handle_t profile_con_handles[NUM_PROFILE_CONNECTIONS] = { 0x0040, 0x0041, 0x0042, 0x0043 };
+
+static void profile_run(void){
+    int i;
+    for (i=0;i<NUM_PROFILE_CONNECTIONS;i++){
+        if (!hci_can_send_acl_packet_now(profile_con_handles[i])) continue;
+        fprintf(stderr, "unexpected ACL connection\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+// typical profile handler: check for a few events, then run state machine
+static void profile_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    if (packet_type != HCI_EVENT_PACKET) return;
+    num_profile_events++;
+    switch (hci_event_packet_get_type(packet)){
+        case HCI_EVENT_DISCONNECTION_COMPLETE:
+        case HCI_EVENT_ENCRYPTION_CHANGE:
+            break;
+        case HCI_EVENT_LE_META:
+            switch (hci_event_le_meta_get_subevent_code(packet)){
+                case HCI_SUBEVENT_LE_CONNECTION_COMPLETE:
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+    profile_run();
+}
+
+static void app_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(packet);
+    UNUSED(size);
+    if (packet_type != HCI_EVENT_PACKET) return;
+    num_app_events++;
+}
+
+typedef enum {
+    PROFILE_FILTER_NONE,
+    PROFILE_FILTER_WITHOUT_SCAN_RESULTS,
+    PROFILE_FILTER_CONNECTION_EVENTS,
+} profile_filter_t;
+
+static void benchmark_run(const char * name, profile_filter_t filter){
+    hci_init(&transport, NULL);
+
+    int i;
+    for (i=0;i<NUM_PROFILE_HANDLERS;i++){
+        profile_callback_registrations[i].callback = &profile_packet_handler;
+        switch (filter){
+            case PROFILE_FILTER_WITHOUT_SCAN_RESULTS:
+                btstack_event_filter_init_without_scan_results(&profile_event_filters[i]);
+                profile_callback_registrations[i].event_filter = &profile_event_filters[i];
+                break;
+            case PROFILE_FILTER_CONNECTION_EVENTS:
+                btstack_event_filter_init(&profile_event_filters[i]);
+                btstack_event_filter_add_event(&profile_event_filters[i], HCI_EVENT_DISCONNECTION_COMPLETE);
+                btstack_event_filter_add_event(&profile_event_filters[i], HCI_EVENT_ENCRYPTION_CHANGE);
+                btstack_event_filter_add_le_subevent(&profile_event_filters[i], HCI_SUBEVENT_LE_CONNECTION_COMPLETE);
+                profile_callback_registrations[i].event_filter = &profile_event_filters[i];
+                break;
+            default:
+                profile_callback_registrations[i].event_filter = NULL;
+                break;
+        }
+        hci_add_event_handler(&profile_callback_registrations[i]);
+    }
+    app_callback_registration.callback = &app_packet_handler;
+    hci_add_event_handler(&app_callback_registration);
+
+    num_profile_events = 0;
+    num_app_events = 0;
+
+    // measure batches as single events are too fast for the timer
+    benchmark_stats_t stats;
+    benchmark_stats_init(&stats, name, NUM_ITERATIONS / BATCH_SIZE);
+    uint32_t batch;
+    for (batch = 0; batch < (NUM_ITERATIONS / BATCH_SIZE); batch++){
+        uint64_t start_ns = benchmark_time_ns();
+        for (i=0;i<BATCH_SIZE;i++){
+            (*transport_packet_handler)(HCI_EVENT_PACKET, advertising_report, sizeof(advertising_report));
+        }
+        benchmark_stats_add(&stats, benchmark_time_ns() - start_ns);
+    }
+
+    // all reports have to reach the application, but no profile if filtered
+    uint32_t num_profile_events_expected = (filter == PROFILE_FILTER_NONE) ? (NUM_ITERATIONS * NUM_PROFILE_HANDLERS) : 0;
+    if ((num_app_events != NUM_ITERATIONS) || (num_profile_events != num_profile_events_expected)){
+        fprintf(stderr, "%s: unexpected number of events delivered\n", name);
+        exit(EXIT_FAILURE);
+    }
+    benchmark_stats_report(&stats);
+}
+
+static void benchmark_fork(const char * name, profile_filter_t filter){
+    // hci_init cannot be undone, use a new process for each run
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0){
+        benchmark_run(name, filter);
+        exit(EXIT_SUCCESS);
+    }
+    waitpid(pid, NULL, 0);
+}
+
+int main(int argc, const char * argv[]){
+    if ((argc > 1) && (strcmp(argv[1], "-c") == 0)){
+        benchmark_set_csv_output(1);
+    }
+
+    char backend[40];
+    snprintf(backend, sizeof(backend), "batches of 100 events, %u profiles", NUM_PROFILE_HANDLERS);
+    benchmark_report_header(backend);
+
+    benchmark_fork("adv_report_catch_all",            PROFILE_FILTER_NONE);
+    benchmark_fork("adv_report_skip_scan_results",    PROFILE_FILTER_WITHOUT_SCAN_RESULTS);
+    benchmark_fork("adv_report_connection_events",    PROFILE_FILTER_CONNECTION_EVENTS);
+    return EXIT_SUCCESS;
+}
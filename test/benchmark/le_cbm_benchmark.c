@@ -0,0 +1,310 @@
+// *****************************************************************************
+//
+// LE Credit-Based Flow Control Mode benchmark
+//
+// Runs sender and receiver in two processes with the full BTstack host stack,
+// connected via mock controllers over LE. The sender streams SDUs over an LE
+// Data Channel, the receiver measures the time to receive each block of SDUs
+// and counts how often the sender ran out of credits. Compares automatic
+// credits, credits provided by the application after each SDU, and adaptive
+// credits with a single receive buffer and with four receive buffers that are
+// released after deferred processing.
+//
+// *****************************************************************************
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "btstack_config.h"
+
+#include "benchmark_util.h"
+#include "btstack_event.h"
+#include "btstack_memory.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "gap.h"
+#include "hci.h"
+#include "l2cap.h"
+#include "mock_controller.h"
+
+#define SDU_SIZE              1000
+#define SDUS_PER_BLOCK          32
+#define NUM_BLOCKS              50
+#define NUM_RECEIVE_BUFFERS      4
+#define PSM_BENCHMARK         0x0080
+
+// SDU len + SDU with 251 byte PDUs
+#define PDUS_PER_SDU             4
+
+typedef struct {
+    const char * name;
+    uint16_t     initial_credits;
+    uint8_t      num_receive_buffers;
+} benchmark_run_t;
+
+static const benchmark_run_t benchmark_runs[] = {
+    { "le_cbm_automatic",         L2CAP_LE_AUTOMATIC_CREDITS, 1 },
+    { "le_cbm_credits_per_sdu",   PDUS_PER_SDU,               1 },
+    { "le_cbm_adaptive",          L2CAP_LE_ADAPTIVE_CREDITS,  1 },
+    { "le_cbm_adaptive_buffers",  L2CAP_LE_ADAPTIVE_CREDITS,  NUM_RECEIVE_BUFFERS },
+};
+#define NUM_BENCHMARK_RUNS (sizeof(benchmark_runs) / sizeof(benchmark_run_t))
+
+static const bd_addr_t sender_address   = { 0x00, 0x1B, 0xDC, 0x07, 0x00, 0x01 };
+static const bd_addr_t receiver_address = { 0x00, 0x1B, 0xDC, 0x07, 0x00, 0x02 };
+
+static mock_controller_config_t controller_config;
+static btstack_packet_callback_registration_t hci_event_callback_registration;
+
+static uint8_t receive_buffers[NUM_RECEIVE_BUFFERS][SDU_SIZE];
+static uint8_t sdu[SDU_SIZE];
+
+// SDUs are numbered to verify in-order delivery
+static uint32_t sdu_nr;
+
+static btstack_timer_source_t next_run_timer;
+
+static uint16_t l2cap_cid;
+
+// sender
+static pid_t            receiver_pid;
+static hci_con_handle_t con_handle;
+static unsigned int     benchmark_run_index;
+
+// receiver, runs are executed in order
+static const benchmark_run_t * receiver_run;
+static unsigned int receiver_run_index;
+static benchmark_stats_t benchmark_stats;
+static uint64_t block_start_ns;
+static uint16_t num_sdus_received;
+static uint16_t num_blocks_received;
+
+// receiver: SDUs held for deferred processing
+static btstack_timer_source_t process_timer;
+static const uint8_t * held_sdus[NUM_RECEIVE_BUFFERS];
+static uint8_t num_held_sdus;
+
+static void sender_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size);
+
+static void sender_start_run(btstack_timer_source_t * ts){
+    UNUSED(ts);
+    if (benchmark_run_index >= NUM_BENCHMARK_RUNS){
+        kill(receiver_pid, SIGTERM);
+        waitpid(receiver_pid, NULL, 0);
+        exit(EXIT_SUCCESS);
+    }
+    uint8_t status = l2cap_le_create_channel(&sender_packet_handler, con_handle, PSM_BENCHMARK, receive_buffers[0], SDU_SIZE,
+                                             L2CAP_LE_AUTOMATIC_CREDITS, LEVEL_0, &l2cap_cid);
+    if (status != ERROR_CODE_SUCCESS){
+        fprintf(stderr, "%s: create channel failed, status 0x%02x\n", benchmark_runs[benchmark_run_index].name, status);
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void sender_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    uint8_t status;
+    switch (packet_type){
+        case L2CAP_DATA_PACKET:
+            // receiver has measured all blocks
+            l2cap_le_disconnect(l2cap_cid);
+            break;
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case BTSTACK_EVENT_STATE:
+                    if (btstack_event_state_get_state(packet) != HCI_STATE_WORKING) break;
+                    gap_connect((uint8_t *) receiver_address, BD_ADDR_TYPE_LE_PUBLIC);
+                    break;
+                case HCI_EVENT_LE_META:
+                    if (hci_event_le_meta_get_subevent_code(packet) != HCI_SUBEVENT_LE_CONNECTION_COMPLETE) break;
+                    con_handle = hci_subevent_le_connection_complete_get_connection_handle(packet);
+                    sender_start_run(NULL);
+                    break;
+                case L2CAP_EVENT_LE_CHANNEL_OPENED:
+                    sdu_nr = 0;
+                    status = l2cap_event_le_channel_opened_get_status(packet);
+                    if (status != ERROR_CODE_SUCCESS){
+                        fprintf(stderr, "%s: channel open failed, status 0x%02x\n", benchmark_runs[benchmark_run_index].name, status);
+                        exit(EXIT_FAILURE);
+                    }
+                    l2cap_le_request_can_send_now_event(l2cap_cid);
+                    break;
+                case L2CAP_EVENT_LE_CAN_SEND_NOW:
+                    little_endian_store_32(sdu, 0, sdu_nr++);
+                    status = l2cap_le_send_data(l2cap_cid, sdu, sizeof(sdu));
+                    if (status != ERROR_CODE_SUCCESS){
+                        fprintf(stderr, "%s: send failed, status 0x%02x\n", benchmark_runs[benchmark_run_index].name, status);
+                        exit(EXIT_FAILURE);
+                    }
+                    l2cap_le_request_can_send_now_event(l2cap_cid);
+                    break;
+                case L2CAP_EVENT_LE_CHANNEL_CLOSED:
+                    // channel is freed after event, start next run from run loop
+                    benchmark_run_index++;
+                    btstack_run_loop_set_timer_handler(&next_run_timer, &sender_start_run);
+                    btstack_run_loop_set_timer(&next_run_timer, 0);
+                    btstack_run_loop_add_timer(&next_run_timer);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void receiver_handle_sdu(const uint8_t * packet, uint16_t size){
+    if ((size != SDU_SIZE) || (little_endian_read_32(packet, 0) != sdu_nr)){
+        fprintf(stderr, "%s: SDU %u missing\n", receiver_run->name, sdu_nr);
+        exit(EXIT_FAILURE);
+    }
+    sdu_nr++;
+
+    // provide credits for next SDU after processing
+    if (receiver_run->initial_credits == PDUS_PER_SDU){
+        l2cap_le_provide_credits(l2cap_cid, PDUS_PER_SDU);
+    }
+
+    num_sdus_received++;
+    if (num_sdus_received < SDUS_PER_BLOCK) return;
+    num_sdus_received = 0;
+
+    uint64_t now_ns = benchmark_time_ns();
+    benchmark_stats_add(&benchmark_stats, now_ns - block_start_ns);
+    block_start_ns = now_ns;
+
+    num_blocks_received++;
+    if (num_blocks_received < NUM_BLOCKS) return;
+    benchmark_stats_report(&benchmark_stats);
+    l2cap_le_channel_statistics_t statistics;
+    l2cap_le_get_channel_statistics(l2cap_cid, &statistics);
+    benchmark_report_count("  sender out of credits", statistics.rx_stalls);
+    fflush(stdout);
+
+    // ask sender to close the channel
+    static uint8_t done = 0;
+    l2cap_le_send_data(l2cap_cid, &done, 1);
+}
+
+// process held SDUs from run loop and return their buffers
+static void receiver_process_held_sdus(btstack_timer_source_t * ts){
+    UNUSED(ts);
+    uint8_t i;
+    for (i=0;i<num_held_sdus;i++){
+        if (num_blocks_received < NUM_BLOCKS){
+            receiver_handle_sdu(held_sdus[i], SDU_SIZE);
+        }
+        l2cap_le_release_receive_buffer(l2cap_cid, held_sdus[i]);
+    }
+    num_held_sdus = 0;
+}
+
+static void receiver_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    uint8_t i;
+    switch (packet_type){
+        case L2CAP_DATA_PACKET:
+            if (receiver_run->num_receive_buffers == 1){
+                if (num_blocks_received >= NUM_BLOCKS) break;
+                receiver_handle_sdu(packet, size);
+                break;
+            }
+            if (num_held_sdus == 0){
+                btstack_run_loop_set_timer_handler(&process_timer, &receiver_process_held_sdus);
+                btstack_run_loop_set_timer(&process_timer, 0);
+                btstack_run_loop_add_timer(&process_timer);
+            }
+            held_sdus[num_held_sdus++] = packet;
+            break;
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case L2CAP_EVENT_LE_INCOMING_CONNECTION:
+                    l2cap_cid = l2cap_event_le_incoming_connection_get_local_cid(packet);
+                    receiver_run = &benchmark_runs[receiver_run_index];
+                    for (i=1;i<receiver_run->num_receive_buffers;i++){
+                        l2cap_le_add_receive_buffer(l2cap_cid, receive_buffers[i]);
+                    }
+                    l2cap_le_accept_connection(l2cap_cid, receive_buffers[0], SDU_SIZE, receiver_run->initial_credits);
+                    break;
+                case L2CAP_EVENT_LE_CHANNEL_OPENED:
+                    benchmark_stats_init(&benchmark_stats, receiver_run->name, NUM_BLOCKS);
+                    sdu_nr = 0;
+                    num_sdus_received = 0;
+                    num_blocks_received = 0;
+                    num_held_sdus = 0;
+                    block_start_ns = benchmark_time_ns();
+                    break;
+                case L2CAP_EVENT_LE_CHANNEL_CLOSED:
+                    btstack_run_loop_remove_timer(&process_timer);
+                    receiver_run_index++;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void stack_init(int fd, const bd_addr_t public_address){
+    controller_config.peer_fd = fd;
+    (void)memcpy(controller_config.public_address, public_address, 6);
+    controller_config.le_acl_packet_length     = 251;
+    controller_config.le_acl_packets_total_num = 8;
+
+    btstack_memory_init();
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+    hci_init(mock_controller_transport_instance(), &controller_config);
+    l2cap_init();
+}
+
+int main(int argc, const char * argv[]){
+    int sockets[2];
+
+    if ((argc > 1) && (strcmp(argv[1], "-c") == 0)){
+        benchmark_set_csv_output(1);
+    }
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) != 0){
+        perror("socketpair");
+        return EXIT_FAILURE;
+    }
+
+    char backend[60];
+    snprintf(backend, sizeof(backend), "blocks of %u SDUs with %u bytes", SDUS_PER_BLOCK, SDU_SIZE);
+    benchmark_report_header(backend);
+
+    // make output visible before fork
+    fflush(stdout);
+
+    receiver_pid = fork();
+    if (receiver_pid < 0){
+        perror("fork");
+        return EXIT_FAILURE;
+    }
+
+    if (receiver_pid == 0){
+        // Receiver accepts channels for all runs and reports
+        close(sockets[0]);
+        stack_init(sockets[1], receiver_address);
+        l2cap_le_register_service(&receiver_packet_handler, PSM_BENCHMARK, LEVEL_0);
+    } else {
+        // Sender connects and streams SDUs until receiver is done
+        close(sockets[1]);
+        stack_init(sockets[0], sender_address);
+        hci_event_callback_registration.callback = &sender_packet_handler;
+        hci_add_event_handler(&hci_event_callback_registration);
+    }
+
+    hci_power_control(HCI_POWER_ON);
+    btstack_run_loop_execute();
+    return EXIT_SUCCESS;
+}
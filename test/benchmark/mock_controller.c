@@ -0,0 +1,556 @@
+// *****************************************************************************
+//
+// mock Controller for benchmarks
+//
+// *****************************************************************************
+
+#include "mock_controller.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "bluetooth_company_id.h"
+#include "btstack_debug.h"
+#include "btstack_run_loop.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_cmd.h"
+#include "rijndael.h"
+#include "uECC.h"
+
+#define MOCK_CONTROLLER_CON_HANDLE  0x0040
+#define MOCK_CONTROLLER_QUEUE_SIZE  32
+#define MOCK_CONTROLLER_PACKET_SIZE (HCI_ACL_HEADER_SIZE + 1021)
+#define MOCK_CONTROLLER_DELAY_QUEUE_SIZE 64
+
+// messages exchanged with peer controller
+typedef enum {
+    MOCK_AIR_CONNECT = 1,           // bd_addr_t of initiator
+    MOCK_AIR_DISCONNECT,            // reason
+    MOCK_AIR_ACL,                   // acl packet
+    MOCK_AIR_START_ENCRYPTION,      // rand (8), ediv (2)
+    MOCK_AIR_LONG_TERM_KEY,         // status, ltk (16)
+    MOCK_AIR_ENCRYPTION_RESULT,     // status
+    MOCK_AIR_CREATE_CONNECTION,     // bd_addr_t of initiator, BR/EDR
+    MOCK_AIR_CONNECTION_ACCEPTED,   // bd_addr_t of acceptor, BR/EDR
+} mock_air_message_t;
+
+typedef struct {
+    uint8_t  packet_type;
+    uint16_t size;
+    uint8_t  data[MOCK_CONTROLLER_PACKET_SIZE];
+} mock_controller_packet_t;
+
+// message from peer controller held back to emulate latency
+typedef struct {
+    uint32_t due_ms;
+    uint16_t size;
+    uint8_t  data[1 + MOCK_CONTROLLER_PACKET_SIZE];
+} mock_controller_message_t;
+
+static const mock_controller_config_t * mock_controller_config;
+static void (*mock_controller_packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
+
+static btstack_data_source_t  mock_controller_data_source;
+static btstack_timer_source_t mock_controller_deliver_timer;
+
+static mock_controller_packet_t mock_controller_queue[MOCK_CONTROLLER_QUEUE_SIZE];
+static uint8_t mock_controller_queue_head;
+static uint8_t mock_controller_queue_count;
+
+static btstack_timer_source_t    mock_controller_delay_timer;
+static mock_controller_message_t mock_controller_delay_queue[MOCK_CONTROLLER_DELAY_QUEUE_SIZE];
+static uint8_t mock_controller_delay_queue_head;
+static uint8_t mock_controller_delay_queue_count;
+
+static uint8_t  mock_controller_connected;
+static uint16_t mock_controller_acl_packets_sent;
+static uint8_t mock_controller_ltk[16];
+static uint8_t mock_controller_ecc_private_key[32];
+
+static int mock_controller_uecc_rng(uint8_t * dest, unsigned size){
+    while (size > 0){
+        *dest++ = (uint8_t) rand();
+        size--;
+    }
+    return 1;
+}
+
+static void mock_controller_handle_peer_message(const uint8_t * message, uint16_t size);
+
+static int mock_controller_can_receive_from_peer(void){
+    if (mock_controller_config->latency_ms == 0) return 1;
+    return mock_controller_delay_queue_count < MOCK_CONTROLLER_DELAY_QUEUE_SIZE;
+}
+
+static void mock_controller_delay_timer_start(uint32_t timeout_ms){
+    btstack_run_loop_remove_timer(&mock_controller_delay_timer);
+    btstack_run_loop_set_timer(&mock_controller_delay_timer, timeout_ms);
+    btstack_run_loop_add_timer(&mock_controller_delay_timer);
+}
+
+static void mock_controller_receive_from_peer(const uint8_t * message, uint16_t size){
+    if (mock_controller_config->latency_ms == 0){
+        mock_controller_handle_peer_message(message, size);
+        return;
+    }
+    btstack_assert(mock_controller_delay_queue_count < MOCK_CONTROLLER_DELAY_QUEUE_SIZE);
+    uint8_t index = (mock_controller_delay_queue_head + mock_controller_delay_queue_count) % MOCK_CONTROLLER_DELAY_QUEUE_SIZE;
+    mock_controller_delay_queue[index].due_ms = btstack_run_loop_get_time_ms() + mock_controller_config->latency_ms;
+    mock_controller_delay_queue[index].size = size;
+    (void)memcpy(mock_controller_delay_queue[index].data, message, size);
+    mock_controller_delay_queue_count++;
+    if (mock_controller_delay_queue_count == 1){
+        mock_controller_delay_timer_start(mock_controller_config->latency_ms);
+    }
+    // stop reading from peer until messages have been handled
+    if (mock_controller_delay_queue_count == MOCK_CONTROLLER_DELAY_QUEUE_SIZE){
+        btstack_run_loop_disable_data_source_callbacks(&mock_controller_data_source, DATA_SOURCE_CALLBACK_READ);
+    }
+}
+
+static void mock_controller_delay_timeout(btstack_timer_source_t * ts){
+    UNUSED(ts);
+    uint32_t now = btstack_run_loop_get_time_ms();
+    while ((mock_controller_delay_queue_count > 0) && (mock_controller_queue_count < (MOCK_CONTROLLER_QUEUE_SIZE / 2))){
+        mock_controller_message_t * message = &mock_controller_delay_queue[mock_controller_delay_queue_head];
+        if ((int32_t) (message->due_ms - now) > 0) break;
+        mock_controller_delay_queue_head = (mock_controller_delay_queue_head + 1) % MOCK_CONTROLLER_DELAY_QUEUE_SIZE;
+        mock_controller_delay_queue_count--;
+        mock_controller_handle_peer_message(message->data, message->size);
+    }
+    if (mock_controller_delay_queue_count < MOCK_CONTROLLER_DELAY_QUEUE_SIZE){
+        btstack_run_loop_enable_data_source_callbacks(&mock_controller_data_source, DATA_SOURCE_CALLBACK_READ);
+    }
+    if (mock_controller_delay_queue_count == 0) return;
+    // wait for next message or for delivery of queued packets
+    int32_t timeout_ms = (int32_t) (mock_controller_delay_queue[mock_controller_delay_queue_head].due_ms - now);
+    mock_controller_delay_timer_start((timeout_ms > 0) ? (uint32_t) timeout_ms : 1);
+}
+
+static void mock_controller_deliver(btstack_timer_source_t * ts){
+    UNUSED(ts);
+    // the run loop processes timers that are due without checking the peer socket, poll it here
+    uint8_t message[1 + MOCK_CONTROLLER_PACKET_SIZE];
+    while ((mock_controller_queue_count < (MOCK_CONTROLLER_QUEUE_SIZE / 2)) && mock_controller_can_receive_from_peer()){
+        ssize_t size = recv(mock_controller_config->peer_fd, message, sizeof(message), MSG_DONTWAIT);
+        if (size <= 0) break;
+        mock_controller_receive_from_peer(message, (uint16_t) size);
+    }
+    // packets queued during delivery are delivered from next timer
+    uint8_t num_packets = mock_controller_queue_count;
+    while (num_packets > 0){
+        num_packets--;
+        mock_controller_packet_t * packet = &mock_controller_queue[mock_controller_queue_head];
+        mock_controller_queue_head = (mock_controller_queue_head + 1) % MOCK_CONTROLLER_QUEUE_SIZE;
+        mock_controller_queue_count--;
+        (*mock_controller_packet_handler)(packet->packet_type, packet->data, packet->size);
+    }
+}
+
+static void mock_controller_queue_packet(uint8_t packet_type, const uint8_t * data, uint16_t size){
+    btstack_assert(mock_controller_queue_count < MOCK_CONTROLLER_QUEUE_SIZE);
+    btstack_assert(size <= MOCK_CONTROLLER_PACKET_SIZE);
+    uint8_t index = (mock_controller_queue_head + mock_controller_queue_count) % MOCK_CONTROLLER_QUEUE_SIZE;
+    mock_controller_queue[index].packet_type = packet_type;
+    mock_controller_queue[index].size = size;
+    (void)memcpy(mock_controller_queue[index].data, data, size);
+    mock_controller_queue_count++;
+    // deliver asynchronously from run loop
+    btstack_run_loop_remove_timer(&mock_controller_deliver_timer);
+    btstack_run_loop_set_timer(&mock_controller_deliver_timer, 0);
+    btstack_run_loop_add_timer(&mock_controller_deliver_timer);
+}
+
+static void mock_controller_send_to_peer(mock_air_message_t message, const uint8_t * data, uint16_t size){
+    uint8_t buffer[1 + MOCK_CONTROLLER_PACKET_SIZE];
+    buffer[0] = (uint8_t) message;
+    (void)memcpy(&buffer[1], data, size);
+    ssize_t res = write(mock_controller_config->peer_fd, buffer, 1 + size);
+    UNUSED(res);
+}
+
+static void mock_controller_emit_command_complete(uint16_t opcode, const uint8_t * return_params, uint16_t return_params_len){
+    uint8_t event[HCI_EVENT_BUFFER_SIZE];
+    event[0] = HCI_EVENT_COMMAND_COMPLETE;
+    event[1] = 3 + return_params_len;
+    event[2] = 1;
+    little_endian_store_16(event, 3, opcode);
+    (void)memcpy(&event[5], return_params, return_params_len);
+    mock_controller_queue_packet(HCI_EVENT_PACKET, event, 5 + return_params_len);
+}
+
+static void mock_controller_emit_command_complete_status(uint16_t opcode, uint8_t status){
+    mock_controller_emit_command_complete(opcode, &status, 1);
+}
+
+static void mock_controller_emit_command_status(uint16_t opcode, uint8_t status){
+    uint8_t event[] = { HCI_EVENT_COMMAND_STATUS, 4, status, 1, 0, 0};
+    little_endian_store_16(event, 4, opcode);
+    mock_controller_queue_packet(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void mock_controller_emit_le_connection_complete(uint8_t role, const bd_addr_t peer_address){
+    uint8_t event[21];
+    event[0] = HCI_EVENT_LE_META;
+    event[1] = sizeof(event) - 2;
+    event[2] = HCI_SUBEVENT_LE_CONNECTION_COMPLETE;
+    event[3] = ERROR_CODE_SUCCESS;
+    little_endian_store_16(event, 4, MOCK_CONTROLLER_CON_HANDLE);
+    event[6] = role;
+    event[7] = BD_ADDR_TYPE_LE_PUBLIC;
+    reverse_bd_addr(peer_address, &event[8]);
+    little_endian_store_16(event, 14, 0x0018);  // 30 ms connection interval
+    little_endian_store_16(event, 16, 0);       // latency
+    little_endian_store_16(event, 18, 0x0048);  // supervision timeout
+    event[20] = 0;                              // master clock accuracy
+    mock_controller_queue_packet(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void mock_controller_emit_connection_request(const bd_addr_t peer_address){
+    uint8_t event[12];
+    event[0] = HCI_EVENT_CONNECTION_REQUEST;
+    event[1] = sizeof(event) - 2;
+    reverse_bd_addr(peer_address, &event[2]);
+    little_endian_store_24(event, 8, 0);        // class of device
+    event[11] = 1;                              // ACL
+    mock_controller_queue_packet(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void mock_controller_emit_connection_complete(const bd_addr_t peer_address){
+    uint8_t event[13];
+    event[0] = HCI_EVENT_CONNECTION_COMPLETE;
+    event[1] = sizeof(event) - 2;
+    event[2] = ERROR_CODE_SUCCESS;
+    little_endian_store_16(event, 3, MOCK_CONTROLLER_CON_HANDLE);
+    reverse_bd_addr(peer_address, &event[5]);
+    event[11] = 1;                              // ACL
+    event[12] = 0;                              // encryption disabled
+    mock_controller_queue_packet(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void mock_controller_emit_read_remote_supported_features_complete(void){
+    uint8_t event[13];
+    memset(event, 0, sizeof(event));
+    event[0] = HCI_EVENT_READ_REMOTE_SUPPORTED_FEATURES_COMPLETE;
+    event[1] = sizeof(event) - 2;
+    event[2] = ERROR_CODE_SUCCESS;
+    little_endian_store_16(event, 3, MOCK_CONTROLLER_CON_HANDLE);
+    mock_controller_queue_packet(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void mock_controller_emit_disconnection_complete(uint8_t reason){
+    uint8_t event[] = { HCI_EVENT_DISCONNECTION_COMPLETE, 4, ERROR_CODE_SUCCESS, 0, 0, reason};
+    little_endian_store_16(event, 3, MOCK_CONTROLLER_CON_HANDLE);
+    mock_controller_queue_packet(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void mock_controller_emit_encryption_change(uint8_t status){
+    uint8_t event[] = { HCI_EVENT_ENCRYPTION_CHANGE, 4, status, 0, 0, status == ERROR_CODE_SUCCESS ? 1 : 0};
+    little_endian_store_16(event, 3, MOCK_CONTROLLER_CON_HANDLE);
+    mock_controller_queue_packet(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void mock_controller_emit_number_of_completed_packets(hci_con_handle_t con_handle){
+    uint8_t event[] = { HCI_EVENT_NUMBER_OF_COMPLETED_PACKETS, 5, 1, 0, 0, 1, 0};
+    little_endian_store_16(event, 3, con_handle);
+    mock_controller_queue_packet(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void mock_controller_emit_le_meta_event(uint8_t subevent_code, const uint8_t * params, uint16_t params_len){
+    uint8_t event[HCI_EVENT_BUFFER_SIZE];
+    event[0] = HCI_EVENT_LE_META;
+    event[1] = 2 + params_len;
+    event[2] = subevent_code;
+    event[3] = ERROR_CODE_SUCCESS;
+    (void)memcpy(&event[4], params, params_len);
+    mock_controller_queue_packet(HCI_EVENT_PACKET, event, 4 + params_len);
+}
+
+static void mock_controller_handle_command(const uint8_t * packet, uint16_t size){
+    UNUSED(size);
+    uint16_t opcode = little_endian_read_16(packet, 0);
+    const uint8_t * params = &packet[3];
+    uint8_t return_params[65];
+    memset(return_params, 0, sizeof(return_params));
+
+    if (opcode == hci_read_local_version_information.opcode){
+        return_params[1] = 0x09;    // HCI Version 5.0
+        return_params[4] = 0x09;    // LMP Version 5.0
+        little_endian_store_16(return_params, 5, BLUETOOTH_COMPANY_ID_BLUEKITCHEN_GMBH);
+        mock_controller_emit_command_complete(opcode, return_params, 9);
+    } else if (opcode == hci_read_bd_addr.opcode){
+        reverse_bd_addr(mock_controller_config->public_address, &return_params[1]);
+        mock_controller_emit_command_complete(opcode, return_params, 7);
+    } else if (opcode == hci_read_buffer_size.opcode){
+        little_endian_store_16(return_params, 1, mock_controller_config->acl_packet_length);
+        little_endian_store_16(return_params, 4, mock_controller_config->acl_packets_total_num);
+        mock_controller_emit_command_complete(opcode, return_params, 8);
+    } else if (opcode == hci_le_read_buffer_size.opcode){
+        little_endian_store_16(return_params, 1, mock_controller_config->le_acl_packet_length);
+        return_params[3] = mock_controller_config->le_acl_packets_total_num;
+        mock_controller_emit_command_complete(opcode, return_params, 4);
+    } else if (opcode == hci_read_local_supported_features.opcode){
+        if (mock_controller_config->acl_packet_length > 0){
+            return_params[1 + 4] = 0x40;    // LE Supported (Controller)
+        } else {
+            return_params[1 + 4] = 0x60;    // BR/EDR Not Supported, LE Supported (Controller)
+        }
+        mock_controller_emit_command_complete(opcode, return_params, 9);
+    } else if (opcode == hci_read_local_supported_commands.opcode){
+        return_params[1 + 34] = 0x06;   // LE Read Local P-256 Public Key, LE Generate DHKey
+        if (mock_controller_config->acl_packet_length > 0){
+            return_params[1 + 14] = 0x80;   // Read Buffer Size
+        }
+        mock_controller_emit_command_complete(opcode, return_params, 65);
+    } else if (opcode == hci_le_rand.opcode){
+        uint8_t i;
+        for (i = 1; i < 9; i++){
+            return_params[i] = (uint8_t) rand();
+        }
+        mock_controller_emit_command_complete(opcode, return_params, 9);
+    } else if (opcode == hci_le_encrypt.opcode){
+        // command and event use little endian byte order
+        uint8_t key[16];
+        uint8_t plaintext[16];
+        uint8_t ciphertext[16];
+        reverse_128(&params[0],  key);
+        reverse_128(&params[16], plaintext);
+        uint32_t rk[RKLENGTH(KEYBITS)];
+        int nrounds = rijndaelSetupEncrypt(rk, key, KEYBITS);
+        rijndaelEncrypt(rk, nrounds, plaintext, ciphertext);
+        reverse_128(ciphertext, &return_params[1]);
+        mock_controller_emit_command_complete(opcode, return_params, 17);
+    } else if (opcode == hci_le_read_local_p256_public_key.opcode){
+        uint8_t public_key[64];
+        uint8_t public_key_flipped[64];
+        mock_controller_emit_command_status(opcode, ERROR_CODE_SUCCESS);
+        uECC_set_rng(&mock_controller_uecc_rng);
+        uECC_make_key(public_key, mock_controller_ecc_private_key);
+        reverse_256(&public_key[0],  &public_key_flipped[0]);
+        reverse_256(&public_key[32], &public_key_flipped[32]);
+        mock_controller_emit_le_meta_event(HCI_SUBEVENT_LE_READ_LOCAL_P256_PUBLIC_KEY_COMPLETE, public_key_flipped, sizeof(public_key_flipped));
+    } else if (opcode == hci_le_generate_dhkey.opcode){
+        uint8_t public_key[64];
+        uint8_t dhkey[32];
+        uint8_t dhkey_flipped[32];
+        mock_controller_emit_command_status(opcode, ERROR_CODE_SUCCESS);
+        reverse_256(&params[0],  &public_key[0]);
+        reverse_256(&params[32], &public_key[32]);
+        uECC_shared_secret(public_key, mock_controller_ecc_private_key, dhkey);
+        reverse_256(dhkey, dhkey_flipped);
+        mock_controller_emit_le_meta_event(HCI_SUBEVENT_LE_GENERATE_DHKEY_COMPLETE, dhkey_flipped, sizeof(dhkey_flipped));
+    } else if (opcode == hci_le_create_connection.opcode){
+        bd_addr_t peer_address;
+        reverse_bd_addr(&params[6], peer_address);
+        mock_controller_emit_command_status(opcode, ERROR_CODE_SUCCESS);
+        mock_controller_connected = 1;
+        mock_controller_send_to_peer(MOCK_AIR_CONNECT, mock_controller_config->public_address, 6);
+        mock_controller_emit_le_connection_complete(HCI_ROLE_MASTER, peer_address);
+    } else if (opcode == hci_create_connection.opcode){
+        mock_controller_emit_command_status(opcode, ERROR_CODE_SUCCESS);
+        mock_controller_send_to_peer(MOCK_AIR_CREATE_CONNECTION, mock_controller_config->public_address, 6);
+    } else if (opcode == hci_accept_connection_request.opcode){
+        bd_addr_t peer_address;
+        reverse_bd_addr(&params[0], peer_address);
+        mock_controller_emit_command_status(opcode, ERROR_CODE_SUCCESS);
+        mock_controller_connected = 1;
+        mock_controller_send_to_peer(MOCK_AIR_CONNECTION_ACCEPTED, mock_controller_config->public_address, 6);
+        mock_controller_emit_connection_complete(peer_address);
+    } else if (opcode == hci_read_remote_supported_features_command.opcode){
+        mock_controller_emit_command_status(opcode, ERROR_CODE_SUCCESS);
+        mock_controller_emit_read_remote_supported_features_complete();
+    } else if (opcode == hci_disconnect.opcode){
+        mock_controller_emit_command_status(opcode, ERROR_CODE_SUCCESS);
+        if (mock_controller_connected){
+            uint8_t reason = params[2];
+            mock_controller_connected = 0;
+            mock_controller_send_to_peer(MOCK_AIR_DISCONNECT, &reason, 1);
+            mock_controller_emit_disconnection_complete(ERROR_CODE_CONNECTION_TERMINATED_BY_LOCAL_HOST);
+        }
+    } else if (opcode == hci_le_start_encryption.opcode){
+        // store ltk, forward rand and ediv
+        mock_controller_emit_command_status(opcode, ERROR_CODE_SUCCESS);
+        (void)memcpy(mock_controller_ltk, &params[12], 16);
+        mock_controller_send_to_peer(MOCK_AIR_START_ENCRYPTION, &params[2], 10);
+    } else if (opcode == hci_le_long_term_key_request_reply.opcode){
+        uint8_t message[17];
+        message[0] = ERROR_CODE_SUCCESS;
+        (void)memcpy(&message[1], &params[2], 16);
+        little_endian_store_16(return_params, 1, MOCK_CONTROLLER_CON_HANDLE);
+        mock_controller_emit_command_complete(opcode, return_params, 3);
+        mock_controller_send_to_peer(MOCK_AIR_LONG_TERM_KEY, message, sizeof(message));
+    } else if (opcode == hci_le_long_term_key_negative_reply.opcode){
+        uint8_t message[17];
+        memset(message, 0, sizeof(message));
+        message[0] = ERROR_CODE_PIN_OR_KEY_MISSING;
+        little_endian_store_16(return_params, 1, MOCK_CONTROLLER_CON_HANDLE);
+        mock_controller_emit_command_complete(opcode, return_params, 3);
+        mock_controller_send_to_peer(MOCK_AIR_LONG_TERM_KEY, message, sizeof(message));
+    } else {
+        // all other commands succeed without return parameters
+        mock_controller_emit_command_complete_status(opcode, ERROR_CODE_SUCCESS);
+    }
+}
+
+static void mock_controller_handle_peer_message(const uint8_t * message, uint16_t size){
+    uint8_t status;
+    uint8_t event[15];
+    bd_addr_t peer_address;
+    switch ((mock_air_message_t) message[0]){
+        case MOCK_AIR_CONNECT:
+            mock_controller_connected = 1;
+            (void)memcpy(peer_address, &message[1], 6);
+            mock_controller_emit_le_connection_complete(HCI_ROLE_SLAVE, peer_address);
+            break;
+        case MOCK_AIR_DISCONNECT:
+            if (!mock_controller_connected) break;
+            mock_controller_connected = 0;
+            mock_controller_emit_disconnection_complete(message[1]);
+            break;
+        case MOCK_AIR_ACL:
+            if (!mock_controller_connected) break;
+            // Controller to Host uses 'first automatically flushable' for start fragments
+            if ((message[2] & 0x30) == 0x00){
+                uint8_t acl_packet[MOCK_CONTROLLER_PACKET_SIZE];
+                (void)memcpy(acl_packet, &message[1], size - 1);
+                acl_packet[1] |= 0x20;
+                mock_controller_queue_packet(HCI_ACL_DATA_PACKET, acl_packet, size - 1);
+            } else {
+                mock_controller_queue_packet(HCI_ACL_DATA_PACKET, &message[1], size - 1);
+            }
+            break;
+        case MOCK_AIR_START_ENCRYPTION:
+            event[0] = HCI_EVENT_LE_META;
+            event[1] = sizeof(event) - 2;
+            event[2] = HCI_SUBEVENT_LE_LONG_TERM_KEY_REQUEST;
+            little_endian_store_16(event, 3, MOCK_CONTROLLER_CON_HANDLE);
+            (void)memcpy(&event[5], &message[1], 10);
+            mock_controller_queue_packet(HCI_EVENT_PACKET, event, sizeof(event));
+            break;
+        case MOCK_AIR_LONG_TERM_KEY:
+            // encryption only succeeds if both sides use the same key
+            status = message[1];
+            if ((status == ERROR_CODE_SUCCESS) && (memcmp(&message[2], mock_controller_ltk, 16) != 0)){
+                status = ERROR_CODE_PIN_OR_KEY_MISSING;
+            }
+            mock_controller_send_to_peer(MOCK_AIR_ENCRYPTION_RESULT, &status, 1);
+            mock_controller_emit_encryption_change(status);
+            break;
+        case MOCK_AIR_ENCRYPTION_RESULT:
+            mock_controller_emit_encryption_change(message[1]);
+            break;
+        case MOCK_AIR_CREATE_CONNECTION:
+            (void)memcpy(peer_address, &message[1], 6);
+            mock_controller_emit_connection_request(peer_address);
+            break;
+        case MOCK_AIR_CONNECTION_ACCEPTED:
+            mock_controller_connected = 1;
+            (void)memcpy(peer_address, &message[1], 6);
+            mock_controller_emit_connection_complete(peer_address);
+            break;
+        default:
+            break;
+    }
+}
+
+static void mock_controller_process(btstack_data_source_t * ds, btstack_data_source_callback_type_t callback_type){
+    UNUSED(callback_type);
+    uint8_t message[1 + MOCK_CONTROLLER_PACKET_SIZE];
+    ssize_t size = read(ds->source.fd, message, sizeof(message));
+    if (size <= 0){
+        // peer gone
+        btstack_run_loop_remove_data_source(ds);
+        return;
+    }
+    mock_controller_receive_from_peer(message, (uint16_t) size);
+}
+
+static void mock_controller_init(const void * transport_config){
+    mock_controller_config = (const mock_controller_config_t *) transport_config;
+    mock_controller_queue_head  = 0;
+    mock_controller_queue_count = 0;
+    mock_controller_connected   = 0;
+    mock_controller_acl_packets_sent = 0;
+    mock_controller_delay_queue_head  = 0;
+    mock_controller_delay_queue_count = 0;
+    btstack_run_loop_set_timer_handler(&mock_controller_deliver_timer, &mock_controller_deliver);
+    btstack_run_loop_set_timer_handler(&mock_controller_delay_timer, &mock_controller_delay_timeout);
+}
+
+static int mock_controller_open(void){
+    btstack_run_loop_set_data_source_fd(&mock_controller_data_source, mock_controller_config->peer_fd);
+    btstack_run_loop_set_data_source_handler(&mock_controller_data_source, &mock_controller_process);
+    btstack_run_loop_enable_data_source_callbacks(&mock_controller_data_source, DATA_SOURCE_CALLBACK_READ);
+    btstack_run_loop_add_data_source(&mock_controller_data_source);
+    return 0;
+}
+
+static int mock_controller_close(void){
+    btstack_run_loop_remove_data_source(&mock_controller_data_source);
+    btstack_run_loop_remove_timer(&mock_controller_deliver_timer);
+    btstack_run_loop_remove_timer(&mock_controller_delay_timer);
+    return 0;
+}
+
+static void mock_controller_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
+    mock_controller_packet_handler = handler;
+}
+
+// emulate lossy link, connection setup over the L2CAP Signaling Channel is not affected
+static int mock_controller_drop_acl_packet(const uint8_t * packet, uint16_t size){
+    if (mock_controller_config->acl_drop_interval == 0) return 0;
+    if (size < (HCI_ACL_HEADER_SIZE + L2CAP_HEADER_SIZE)) return 0;
+    // continuation fragments don't start with an L2CAP header
+    if ((packet[1] & 0x30) == 0x10) return 0;
+    if (little_endian_read_16(packet, HCI_ACL_HEADER_SIZE + 2) == L2CAP_CID_SIGNALING) return 0;
+    mock_controller_acl_packets_sent++;
+    if (mock_controller_acl_packets_sent < mock_controller_config->acl_drop_interval) return 0;
+    mock_controller_acl_packets_sent = 0;
+    return 1;
+}
+
+static int mock_controller_can_send_packet_now(uint8_t packet_type){
+    UNUSED(packet_type);
+    return 1;
+}
+
+static int mock_controller_send_packet(uint8_t packet_type, uint8_t *packet, int size){
+    // asynchronous transport: packet buffer is released by packet sent event after controller response
+    static const uint8_t packet_sent_event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
+    switch (packet_type){
+        case HCI_COMMAND_DATA_PACKET:
+            mock_controller_handle_command(packet, (uint16_t) size);
+            break;
+        case HCI_ACL_DATA_PACKET:
+            if (mock_controller_connected && !mock_controller_drop_acl_packet(packet, (uint16_t) size)){
+                mock_controller_send_to_peer(MOCK_AIR_ACL, packet, (uint16_t) size);
+            }
+            mock_controller_emit_number_of_completed_packets(little_endian_read_16(packet, 0) & 0x0fff);
+            break;
+        default:
+            break;
+    }
+    mock_controller_queue_packet(HCI_EVENT_PACKET, packet_sent_event, sizeof(packet_sent_event));
+    return 0;
+}
+
+static const hci_transport_t mock_controller_transport = {
+    /* const char * name; */                                        "MockController",
+    /* void   (*init) (const void *transport_config); */            &mock_controller_init,
+    /* int    (*open)(void); */                                     &mock_controller_open,
+    /* int    (*close)(void); */                                    &mock_controller_close,
+    /* void   (*register_packet_handler)(void (*handler)(...); */   &mock_controller_register_packet_handler,
+    /* int    (*can_send_packet_now)(uint8_t packet_type); */       &mock_controller_can_send_packet_now,
+    /* int    (*send_packet)(...); */                               &mock_controller_send_packet,
+    /* int    (*set_baudrate)(uint32_t baudrate); */                NULL,
+    /* void   (*reset_link)(void); */                               NULL,
+    /* void   (*set_sco_config)(uint16_t voice_setting, int num_connections); */ NULL,
+};
+
+const hci_transport_t * mock_controller_transport_instance(void){
+    return &mock_controller_transport;
+}
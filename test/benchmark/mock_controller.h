@@ -0,0 +1,50 @@
+// *****************************************************************************
+//
+// mock Controller for benchmarks
+//
+// Provides an HCI Transport that is answered by an emulated LE Controller,
+// which also supports BR/EDR ACL connections if configured.
+// Two instances, usually in two processes, are linked via a SOCK_SEQPACKET
+// socket that carries connection setup, ACL data and encryption setup.
+//
+// *****************************************************************************
+
+#ifndef MOCK_CONTROLLER_H
+#define MOCK_CONTROLLER_H
+
+#include <stdint.h>
+
+#include "bluetooth.h"
+#include "hci_transport.h"
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    // socket connected to the peer controller
+    int       peer_fd;
+    // public address
+    bd_addr_t public_address;
+    // reported by LE Read Buffer Size
+    uint16_t  le_acl_packet_length;
+    uint8_t   le_acl_packets_total_num;
+    // reported by Read Buffer Size, BR/EDR is supported if acl_packet_length > 0
+    uint16_t  acl_packet_length;
+    uint8_t   acl_packets_total_num;
+    // drop every n-th ACL packet that is not sent on the L2CAP Signaling Channel, 0 = no loss
+    uint16_t  acl_drop_interval;
+    // delay all messages received from the peer controller, 0 = no delay
+    uint16_t  latency_ms;
+} mock_controller_config_t;
+
+/**
+ * @brief Get HCI Transport for mock controller, config is passed to hci_init
+ */
+const hci_transport_t * mock_controller_transport_instance(void);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // MOCK_CONTROLLER_H
@@ -0,0 +1,446 @@
+// *****************************************************************************
+//
+// mock libusb for benchmarks
+//
+// *****************************************************************************
+
+#include <poll.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "libusb.h"
+#include "mock_libusb.h"
+
+#define MOCK_EVENT_IN_ADDR 0x81
+#define MOCK_ACL_IN_ADDR   0x82
+#define MOCK_ACL_OUT_ADDR  0x02
+
+typedef struct mock_transfer {
+    struct mock_transfer * next;
+    uint64_t due_ns;
+    int      submitted;
+    // assert: last field, as it ends with the flexible iso packet array
+    struct libusb_transfer transfer;
+} mock_transfer_t;
+
+struct libusb_device {
+    struct libusb_device_descriptor descriptor;
+};
+
+struct libusb_device_handle {
+    libusb_device * device;
+};
+
+static const struct libusb_endpoint_descriptor mock_endpoints[] = {
+    { 7, 5, MOCK_EVENT_IN_ADDR, LIBUSB_TRANSFER_TYPE_INTERRUPT, 16, 1 },
+    { 7, 5, MOCK_ACL_IN_ADDR,   LIBUSB_TRANSFER_TYPE_BULK,      64, 0 },
+    { 7, 5, MOCK_ACL_OUT_ADDR,  LIBUSB_TRANSFER_TYPE_BULK,      64, 0 },
+};
+
+static const struct libusb_interface_descriptor mock_interface_descriptor = {
+    9, 4, 0, 0, 3, 0xE0, 0x01, 0x01, 0, mock_endpoints
+};
+
+static const struct libusb_interface mock_interface = {
+    &mock_interface_descriptor, 1
+};
+
+static struct libusb_config_descriptor mock_config_descriptor = {
+    9, 2, 0, 1, 1, &mock_interface
+};
+
+static libusb_device mock_device = {
+    { 18, 1, 0x0200, 0xE0, 0x01, 0x01, 64, 0x1234, 0x5678, 0x0100, 0, 0, 0, 1 }
+};
+
+static libusb_device_handle mock_device_handle = { &mock_device };
+
+static mock_libusb_config_t mock_config;
+
+// submitted transfers ordered by due time
+static mock_transfer_t * pending_transfers;
+// end of last bulk transfer on each bulk endpoint
+static uint64_t acl_in_busy_until_ns;
+static uint64_t acl_out_busy_until_ns;
+static uint32_t acl_out_completed;
+static uint8_t  acl_in_sequence;
+
+static int timer_fd = -1;
+static struct libusb_pollfd timer_pollfd;
+
+static uint64_t mock_time_ns(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t) now.tv_sec * 1000000000ULL) + (uint64_t) now.tv_nsec;
+}
+
+static mock_transfer_t * mock_transfer_for_transfer(struct libusb_transfer * transfer){
+    return (mock_transfer_t *) (((uint8_t *) transfer) - offsetof(mock_transfer_t, transfer));
+}
+
+static uint64_t mock_bulk_duration_ns(int len){
+    return mock_config.bulk_transfer_overhead_ns + ((uint64_t) len * mock_config.bulk_ns_per_byte);
+}
+
+static void mock_update_timer(void){
+    if (timer_fd < 0) return;
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    if (pending_transfers != NULL){
+        // absolute time, 1 ns if already due as 0 disarms the timer
+        uint64_t due_ns = pending_transfers->due_ns;
+        if (due_ns == 0) {
+            due_ns = 1;
+        }
+        spec.it_value.tv_sec  = (time_t) (due_ns / 1000000000ULL);
+        spec.it_value.tv_nsec = (long) (due_ns % 1000000000ULL);
+    }
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+}
+
+static void mock_schedule(mock_transfer_t * mock_transfer, uint64_t due_ns){
+    mock_transfer->due_ns = due_ns;
+    mock_transfer->submitted = 1;
+
+    // insert sorted by due time, after transfers with same due time
+    mock_transfer_t ** it = &pending_transfers;
+    while ((*it != NULL) && ((*it)->due_ns <= due_ns)){
+        it = &(*it)->next;
+    }
+    mock_transfer->next = *it;
+    *it = mock_transfer;
+    mock_update_timer();
+}
+
+static void mock_unschedule(mock_transfer_t * mock_transfer){
+    mock_transfer_t ** it = &pending_transfers;
+    while (*it != NULL){
+        if (*it == mock_transfer){
+            *it = mock_transfer->next;
+            break;
+        }
+        it = &(*it)->next;
+    }
+    mock_transfer->next = NULL;
+}
+
+static void mock_complete(mock_transfer_t * mock_transfer){
+    struct libusb_transfer * transfer = &mock_transfer->transfer;
+    mock_transfer->submitted = 0;
+    if (transfer->status != LIBUSB_TRANSFER_COMPLETED){
+        transfer->callback(transfer);
+        return;
+    }
+    switch (transfer->endpoint){
+        case MOCK_ACL_OUT_ADDR:
+            acl_out_completed++;
+            transfer->actual_length = transfer->length;
+            break;
+        case MOCK_ACL_IN_ADDR: {
+            // ACL packet with handle 0x0001, first fragment
+            uint16_t payload_len = mock_config.acl_in_payload_len;
+            if ((payload_len + 4) > transfer->length){
+                payload_len = (uint16_t) (transfer->length - 4);
+            }
+            transfer->buffer[0] = 0x01;
+            transfer->buffer[1] = 0x20;
+            transfer->buffer[2] = (uint8_t) payload_len;
+            transfer->buffer[3] = (uint8_t) (payload_len >> 8);
+            memset(&transfer->buffer[4], acl_in_sequence++, payload_len);
+            transfer->actual_length = 4 + payload_len;
+            break;
+        }
+        default:
+            // HCI Commands complete without response
+            transfer->actual_length = transfer->length;
+            break;
+    }
+    transfer->callback(transfer);
+}
+
+void mock_libusb_init(const mock_libusb_config_t * config){
+    mock_config = *config;
+}
+
+uint32_t mock_libusb_get_acl_out_completed(void){
+    return acl_out_completed;
+}
+
+// library
+int libusb_init(libusb_context ** ctx){
+    if (ctx != NULL) {
+        *ctx = NULL;
+    }
+    pending_transfers = NULL;
+    acl_in_busy_until_ns = 0;
+    acl_out_busy_until_ns = 0;
+    acl_out_completed = 0;
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    timer_pollfd.fd = timer_fd;
+    timer_pollfd.events = POLLIN;
+    return (timer_fd < 0) ? LIBUSB_ERROR_OTHER : LIBUSB_SUCCESS;
+}
+
+void libusb_exit(libusb_context * ctx){
+    (void) ctx;
+    if (timer_fd >= 0){
+        close(timer_fd);
+        timer_fd = -1;
+    }
+}
+
+void libusb_set_debug(libusb_context * ctx, int level){
+    (void) ctx;
+    (void) level;
+}
+
+const char * libusb_error_name(int error_code){
+    (void) error_code;
+    return "LIBUSB_ERROR";
+}
+
+// devices
+ssize_t libusb_get_device_list(libusb_context * ctx, libusb_device *** list){
+    (void) ctx;
+    libusb_device ** devices = (libusb_device **) calloc(2, sizeof(libusb_device *));
+    if (devices == NULL) return LIBUSB_ERROR_NO_MEM;
+    devices[0] = &mock_device;
+    *list = devices;
+    return 1;
+}
+
+void libusb_free_device_list(libusb_device ** list, int unref_devices){
+    (void) unref_devices;
+    free(list);
+}
+
+int libusb_get_device_descriptor(libusb_device * dev, struct libusb_device_descriptor * desc){
+    *desc = dev->descriptor;
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_get_active_config_descriptor(libusb_device * dev, struct libusb_config_descriptor ** config){
+    (void) dev;
+    *config = &mock_config_descriptor;
+    return LIBUSB_SUCCESS;
+}
+
+void libusb_free_config_descriptor(struct libusb_config_descriptor * config){
+    (void) config;
+}
+
+uint8_t libusb_get_bus_number(libusb_device * dev){
+    (void) dev;
+    return 1;
+}
+
+uint8_t libusb_get_device_address(libusb_device * dev){
+    (void) dev;
+    return 2;
+}
+
+int libusb_get_port_numbers(libusb_device * dev, uint8_t * port_numbers, int port_numbers_len){
+    (void) dev;
+    if (port_numbers_len < 1) return LIBUSB_ERROR_INVALID_PARAM;
+    port_numbers[0] = 1;
+    return 1;
+}
+
+// device handles
+int libusb_open(libusb_device * dev, libusb_device_handle ** dev_handle){
+    mock_device_handle.device = dev;
+    *dev_handle = &mock_device_handle;
+    return LIBUSB_SUCCESS;
+}
+
+libusb_device_handle * libusb_open_device_with_vid_pid(libusb_context * ctx, uint16_t vendor_id, uint16_t product_id){
+    (void) ctx;
+    if ((vendor_id != mock_device.descriptor.idVendor) || (product_id != mock_device.descriptor.idProduct)) return NULL;
+    return &mock_device_handle;
+}
+
+void libusb_close(libusb_device_handle * dev_handle){
+    (void) dev_handle;
+}
+
+libusb_device * libusb_get_device(libusb_device_handle * dev_handle){
+    return dev_handle->device;
+}
+
+int libusb_reset_device(libusb_device_handle * dev_handle){
+    (void) dev_handle;
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_set_configuration(libusb_device_handle * dev_handle, int configuration){
+    (void) dev_handle;
+    (void) configuration;
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_claim_interface(libusb_device_handle * dev_handle, int interface_number){
+    (void) dev_handle;
+    return (interface_number == 0) ? LIBUSB_SUCCESS : LIBUSB_ERROR_NOT_FOUND;
+}
+
+int libusb_release_interface(libusb_device_handle * dev_handle, int interface_number){
+    (void) dev_handle;
+    (void) interface_number;
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_set_interface_alt_setting(libusb_device_handle * dev_handle, int interface_number, int alternate_setting){
+    (void) dev_handle;
+    (void) interface_number;
+    (void) alternate_setting;
+    return LIBUSB_ERROR_NOT_FOUND;
+}
+
+int libusb_kernel_driver_active(libusb_device_handle * dev_handle, int interface_number){
+    (void) dev_handle;
+    (void) interface_number;
+    return 0;
+}
+
+int libusb_detach_kernel_driver(libusb_device_handle * dev_handle, int interface_number){
+    (void) dev_handle;
+    (void) interface_number;
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_attach_kernel_driver(libusb_device_handle * dev_handle, int interface_number){
+    (void) dev_handle;
+    (void) interface_number;
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_clear_halt(libusb_device_handle * dev_handle, unsigned char endpoint){
+    (void) dev_handle;
+    (void) endpoint;
+    return LIBUSB_SUCCESS;
+}
+
+// transfers
+struct libusb_transfer * libusb_alloc_transfer(int iso_packets){
+    size_t size = sizeof(mock_transfer_t) + ((size_t) iso_packets * sizeof(struct libusb_iso_packet_descriptor));
+    mock_transfer_t * mock_transfer = (mock_transfer_t *) calloc(1, size);
+    if (mock_transfer == NULL) return NULL;
+    mock_transfer->transfer.num_iso_packets = iso_packets;
+    return &mock_transfer->transfer;
+}
+
+void libusb_free_transfer(struct libusb_transfer * transfer){
+    if (transfer == NULL) return;
+    mock_transfer_t * mock_transfer = mock_transfer_for_transfer(transfer);
+    mock_unschedule(mock_transfer);
+    if (transfer->flags & LIBUSB_TRANSFER_FREE_BUFFER){
+        free(transfer->buffer);
+    }
+    free(mock_transfer);
+}
+
+int libusb_submit_transfer(struct libusb_transfer * transfer){
+    mock_transfer_t * mock_transfer = mock_transfer_for_transfer(transfer);
+    if (mock_transfer->submitted) return LIBUSB_ERROR_BUSY;
+
+    transfer->status = LIBUSB_TRANSFER_COMPLETED;
+    transfer->actual_length = 0;
+
+    uint64_t now_ns = mock_time_ns();
+    uint64_t start_ns;
+    switch (transfer->endpoint){
+        case MOCK_ACL_OUT_ADDR:
+            // bulk transfers are served one after the other
+            start_ns = (acl_out_busy_until_ns > now_ns) ? acl_out_busy_until_ns : now_ns;
+            acl_out_busy_until_ns = start_ns + mock_bulk_duration_ns(transfer->length);
+            mock_schedule(mock_transfer, acl_out_busy_until_ns);
+            break;
+        case MOCK_ACL_IN_ADDR:
+            if (mock_config.acl_in_payload_len == 0){
+                // no data from device
+                mock_transfer->submitted = 1;
+                break;
+            }
+            // device only sends data if IN transfer is queued
+            start_ns = (acl_in_busy_until_ns > now_ns) ? acl_in_busy_until_ns : now_ns;
+            acl_in_busy_until_ns = start_ns + mock_bulk_duration_ns(4 + mock_config.acl_in_payload_len);
+            mock_schedule(mock_transfer, acl_in_busy_until_ns);
+            break;
+        case MOCK_EVENT_IN_ADDR:
+            // no events from device
+            mock_transfer->submitted = 1;
+            break;
+        default:
+            mock_schedule(mock_transfer, now_ns);
+            break;
+    }
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_cancel_transfer(struct libusb_transfer * transfer){
+    mock_transfer_t * mock_transfer = mock_transfer_for_transfer(transfer);
+    if (mock_transfer->submitted == 0) return LIBUSB_ERROR_NOT_FOUND;
+    mock_unschedule(mock_transfer);
+    transfer->status = LIBUSB_TRANSFER_CANCELLED;
+    mock_schedule(mock_transfer, 0);
+    return LIBUSB_SUCCESS;
+}
+
+// events
+int libusb_handle_events_timeout(libusb_context * ctx, struct timeval * tv){
+    (void) ctx;
+    (void) tv;
+
+    // clear timerfd
+    uint64_t expirations;
+    if (timer_fd >= 0){
+        ssize_t bytes_read = read(timer_fd, &expirations, sizeof(expirations));
+        (void) bytes_read;
+    }
+
+    uint64_t now_ns = mock_time_ns();
+    while ((pending_transfers != NULL) && (pending_transfers->due_ns <= now_ns)){
+        mock_transfer_t * mock_transfer = pending_transfers;
+        pending_transfers = mock_transfer->next;
+        mock_transfer->next = NULL;
+        mock_complete(mock_transfer);
+    }
+    mock_update_timer();
+    return LIBUSB_SUCCESS;
+}
+
+int libusb_pollfds_handle_timeouts(libusb_context * ctx){
+    (void) ctx;
+    return 1;
+}
+
+int libusb_get_next_timeout(libusb_context * ctx, struct timeval * tv){
+    (void) ctx;
+    (void) tv;
+    return 0;
+}
+
+const struct libusb_pollfd ** libusb_get_pollfds(libusb_context * ctx){
+    (void) ctx;
+    if (!mock_config.pollfds_supported) return NULL;
+    const struct libusb_pollfd ** pollfds = (const struct libusb_pollfd **) calloc(2, sizeof(struct libusb_pollfd *));
+    if (pollfds == NULL) return NULL;
+    pollfds[0] = &timer_pollfd;
+    return pollfds;
+}
+
+void libusb_free_pollfds(const struct libusb_pollfd ** pollfds){
+    free((void *) pollfds);
+}
+
+void libusb_set_pollfd_notifiers(libusb_context * ctx, libusb_pollfd_added_cb added_cb, libusb_pollfd_removed_cb removed_cb, void * user_data){
+    // timerfd is the only fd and stays valid until libusb_exit
+    (void) ctx;
+    (void) added_cb;
+    (void) removed_cb;
+    (void) user_data;
+}
@@ -0,0 +1,46 @@
+// *****************************************************************************
+//
+// mock libusb for benchmarks
+//
+// Emulates a single Bluetooth USB device for the H2 libusb transport. Bulk
+// transfers are served one after the other with a configurable throughput.
+// Completed transfers are signalled via a timerfd, which is reported by
+// libusb_get_pollfds if enabled.
+//
+// *****************************************************************************
+
+#ifndef MOCK_LIBUSB_H
+#define MOCK_LIBUSB_H
+
+#include <stdint.h>
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    // report timerfd via libusb_get_pollfds, otherwise transport has to poll
+    int      pollfds_supported;
+    // time to transfer a bulk packet = overhead + len * ns per byte
+    uint32_t bulk_transfer_overhead_ns;
+    uint32_t bulk_ns_per_byte;
+    // payload length of ACL packets sent by device on ACL IN, 0 = none
+    uint16_t acl_in_payload_len;
+} mock_libusb_config_t;
+
+/**
+ * @brief Configure emulated device, call before opening transport
+ * @param config
+ */
+void mock_libusb_init(const mock_libusb_config_t * config);
+
+/**
+ * @brief Get number of completed ACL OUT transfers
+ */
+uint32_t mock_libusb_get_acl_out_completed(void);
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // MOCK_LIBUSB_H
@@ -0,0 +1,305 @@
+// *****************************************************************************
+//
+// PAN throughput benchmark with TAP loopback
+//
+// Runs PANU and NAP in two processes with the full BTstack host stack,
+// connected via mock controllers over BR/EDR. The PANU brings up a TAP network
+// interface via btstack_network_posix. A generator thread injects Ethernet frames
+// into the interface with a raw packet socket, which are read from the TAP device
+// and forwarded over BNEP to the NAP. The NAP measures the time to receive each
+// block of frames. The number of packets read from the TAP device per wakeup
+// is limited by BTSTACK_NETWORK_QUEUE_SIZE selected in the Makefile.
+//
+// Requires Linux and permission to create TAP interfaces, skipped otherwise.
+//
+// *****************************************************************************
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef __linux
+#include <arpa/inet.h>
+#include <linux/if_packet.h>
+#include <net/if.h>
+#include <pthread.h>
+#endif
+
+#include "btstack_config.h"
+
+#include "benchmark_util.h"
+#include "bluetooth_psm.h"
+#include "bluetooth_sdp.h"
+#include "btstack_event.h"
+#include "btstack_memory.h"
+#include "btstack_network.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "classic/bnep.h"
+#include "gap.h"
+#include "hci.h"
+#include "l2cap.h"
+#include "mock_controller.h"
+
+#define FRAMES_PER_BLOCK        64
+#define NUM_BLOCKS              20
+#define NUM_FRAMES              (FRAMES_PER_BLOCK * NUM_BLOCKS)
+#define FRAME_SIZE            1514
+// local experimental ethertype, ignored by the network stack
+#define ETHERTYPE_BENCHMARK   0x88b5
+// max frames injected but not sent over BNEP yet, stays below TAP device queue
+#define GENERATOR_WINDOW        64
+
+static const bd_addr_t panu_address = { 0x00, 0x1B, 0xDC, 0x07, 0x00, 0x01 };
+static const bd_addr_t nap_address  = { 0x00, 0x1B, 0xDC, 0x07, 0x00, 0x02 };
+
+static mock_controller_config_t controller_config;
+static btstack_packet_callback_registration_t hci_event_callback_registration;
+
+static uint16_t bnep_cid;
+
+// panu
+static pid_t           nap_pid;
+static const uint8_t * network_buffer;
+static uint16_t        network_buffer_len;
+static uint32_t        num_frames_forwarded;
+static uint32_t        num_other_packets_forwarded;
+
+// nap
+static benchmark_stats_t benchmark_stats;
+static uint64_t block_start_ns;
+static uint32_t num_frames_received;
+
+static void panu_exit(int status){
+    kill(nap_pid, SIGTERM);
+    waitpid(nap_pid, NULL, 0);
+    exit(status);
+}
+
+#ifdef __linux
+static void * generator_thread(void * arg){
+    UNUSED(arg);
+    int fd = socket(AF_PACKET, SOCK_RAW, htons(ETHERTYPE_BENCHMARK));
+    if (fd < 0){
+        perror("socket");
+        exit(EXIT_FAILURE);
+    }
+    struct sockaddr_ll addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sll_family   = AF_PACKET;
+    addr.sll_protocol = htons(ETHERTYPE_BENCHMARK);
+    addr.sll_ifindex  = (int) if_nametoindex(btstack_network_get_name());
+    addr.sll_halen    = ETHER_ADDR_LEN;
+    (void)memcpy(addr.sll_addr, nap_address, ETHER_ADDR_LEN);
+
+    uint8_t frame[FRAME_SIZE];
+    memset(frame, 0x55, sizeof(frame));
+    (void)memcpy(&frame[0], nap_address, ETHER_ADDR_LEN);
+    (void)memcpy(&frame[6], panu_address, ETHER_ADDR_LEN);
+    big_endian_store_16(frame, 12, ETHERTYPE_BENCHMARK);
+
+    uint32_t i;
+    for (i = 0; i < NUM_FRAMES; i++){
+        while ((i - __atomic_load_n(&num_frames_forwarded, __ATOMIC_ACQUIRE)) >= GENERATOR_WINDOW){
+            usleep(50);
+        }
+        little_endian_store_32(frame, 14, i);
+        if (sendto(fd, frame, sizeof(frame), 0, (struct sockaddr *) &addr, sizeof(addr)) < 0){
+            perror("sendto");
+            exit(EXIT_FAILURE);
+        }
+    }
+    close(fd);
+    return NULL;
+}
+#endif
+
+static void panu_network_up(void){
+#ifdef __linux
+    if (btstack_network_up((uint8_t *) panu_address) == 0){
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, &generator_thread, NULL) == 0) return;
+        perror("pthread_create");
+        panu_exit(EXIT_FAILURE);
+    }
+#endif
+    benchmark_report_skipped("pan_tap_throughput", "TAP not available");
+    panu_exit(EXIT_SUCCESS);
+}
+
+static void network_send_packet_callback(const uint8_t * packet, uint16_t size){
+    network_buffer = packet;
+    network_buffer_len = size;
+    bnep_request_can_send_now_event(bnep_cid);
+}
+
+static void panu_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    int status;
+    switch (packet_type){
+        case BNEP_DATA_PACKET:
+            // nap has measured all blocks
+            benchmark_report_count("  frames forwarded", num_frames_forwarded);
+            benchmark_report_count("  other packets forwarded", num_other_packets_forwarded);
+            panu_exit(EXIT_SUCCESS);
+            break;
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case BTSTACK_EVENT_STATE:
+                    if (btstack_event_state_get_state(packet) != HCI_STATE_WORKING) break;
+                    status = bnep_connect(&panu_packet_handler, (uint8_t *) nap_address, BLUETOOTH_PSM_BNEP, BLUETOOTH_SERVICE_CLASS_PANU, BLUETOOTH_SERVICE_CLASS_NAP);
+                    if (status != 0){
+                        fprintf(stderr, "connect failed, status %d\n", status);
+                        panu_exit(EXIT_FAILURE);
+                    }
+                    break;
+                case BNEP_EVENT_CHANNEL_OPENED:
+                    status = bnep_event_channel_opened_get_status(packet);
+                    if (status != 0){
+                        fprintf(stderr, "channel open failed, status 0x%02x\n", status);
+                        panu_exit(EXIT_FAILURE);
+                    }
+                    bnep_cid = bnep_event_channel_opened_get_bnep_cid(packet);
+                    panu_network_up();
+                    break;
+                case BNEP_EVENT_CAN_SEND_NOW:
+                    if (network_buffer_len == 0) break;
+                    bnep_send(bnep_cid, (uint8_t *) network_buffer, network_buffer_len);
+                    if (big_endian_read_16(network_buffer, 12) == ETHERTYPE_BENCHMARK){
+                        __atomic_add_fetch(&num_frames_forwarded, 1, __ATOMIC_RELEASE);
+                    } else {
+                        num_other_packets_forwarded++;
+                    }
+                    network_buffer_len = 0;
+                    btstack_network_packet_sent();
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void nap_handle_frame(const uint8_t * packet, uint16_t size){
+    if (size < 18) return;
+    if (big_endian_read_16(packet, 12) != ETHERTYPE_BENCHMARK) return;
+    if (little_endian_read_32(packet, 14) != num_frames_received){
+        fprintf(stderr, "frame %u missing\n", num_frames_received);
+        exit(EXIT_FAILURE);
+    }
+    if (size != FRAME_SIZE){
+        fprintf(stderr, "frame %u size %u invalid\n", num_frames_received, size);
+        exit(EXIT_FAILURE);
+    }
+    num_frames_received++;
+    if ((num_frames_received % FRAMES_PER_BLOCK) != 0) return;
+
+    uint64_t now_ns = benchmark_time_ns();
+    benchmark_stats_add(&benchmark_stats, now_ns - block_start_ns);
+    block_start_ns = now_ns;
+
+    if (num_frames_received < NUM_FRAMES) return;
+    benchmark_stats_report(&benchmark_stats);
+    fflush(stdout);
+    bnep_request_can_send_now_event(bnep_cid);
+}
+
+static void nap_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    uint8_t done[18];
+    switch (packet_type){
+        case BNEP_DATA_PACKET:
+            if (num_frames_received >= NUM_FRAMES) break;
+            nap_handle_frame(packet, size);
+            break;
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case BNEP_EVENT_CHANNEL_OPENED:
+                    bnep_cid = bnep_event_channel_opened_get_bnep_cid(packet);
+                    benchmark_stats_init(&benchmark_stats, "pan_tap_throughput", NUM_BLOCKS);
+                    num_frames_received = 0;
+                    block_start_ns = benchmark_time_ns();
+                    break;
+                case BNEP_EVENT_CAN_SEND_NOW:
+                    // tell panu that we're done
+                    (void)memcpy(&done[0], panu_address, ETHER_ADDR_LEN);
+                    (void)memcpy(&done[6], nap_address, ETHER_ADDR_LEN);
+                    big_endian_store_16(done, 12, ETHERTYPE_BENCHMARK);
+                    little_endian_store_32(done, 14, NUM_FRAMES);
+                    bnep_send(bnep_cid, done, sizeof(done));
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void stack_init(int fd, const bd_addr_t public_address){
+    controller_config.peer_fd = fd;
+    (void)memcpy(controller_config.public_address, public_address, 6);
+    controller_config.le_acl_packet_length     = 27;
+    controller_config.le_acl_packets_total_num = 8;
+    controller_config.acl_packet_length        = 1021;
+    controller_config.acl_packets_total_num    = 8;
+
+    btstack_memory_init();
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+    hci_init(mock_controller_transport_instance(), &controller_config);
+    l2cap_init();
+    gap_set_security_level(LEVEL_0);
+    bnep_init();
+}
+
+int main(int argc, const char * argv[]){
+    int sockets[2];
+
+    if ((argc > 1) && (strcmp(argv[1], "-c") == 0)){
+        benchmark_set_csv_output(1);
+    }
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) != 0){
+        perror("socketpair");
+        return EXIT_FAILURE;
+    }
+
+    char backend[80];
+    snprintf(backend, sizeof(backend), "queue size %u, blocks of %u x %u bytes", BTSTACK_NETWORK_QUEUE_SIZE, FRAMES_PER_BLOCK, FRAME_SIZE);
+    benchmark_report_header(backend);
+
+    // make output visible before fork
+    fflush(stdout);
+
+    nap_pid = fork();
+    if (nap_pid < 0){
+        perror("fork");
+        return EXIT_FAILURE;
+    }
+
+    if (nap_pid == 0){
+        // NAP accepts channel and reports
+        close(sockets[0]);
+        stack_init(sockets[1], nap_address);
+        bnep_register_service(&nap_packet_handler, BLUETOOTH_SERVICE_CLASS_NAP, BNEP_MTU_MIN);
+    } else {
+        // PANU forwards frames from TAP interface until NAP is done
+        close(sockets[1]);
+        stack_init(sockets[0], panu_address);
+        btstack_network_init(&network_send_packet_callback);
+        hci_event_callback_registration.callback = &panu_packet_handler;
+        hci_add_event_handler(&hci_event_callback_registration);
+    }
+
+    hci_power_control(HCI_POWER_ON);
+    btstack_run_loop_execute();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,286 @@
+// *****************************************************************************
+//
+// RFCOMM credit flow control benchmark
+//
+// Runs sender and receiver in two processes with the full BTstack host stack,
+// connected via mock controllers over BR/EDR with a one-way latency of 10 ms.
+// The sender streams frames of the max frame size, the receiver measures the
+// time to receive each block of frames, the sender reports how often it ran
+// out of credits. Credits are provided automatically by the receiver, either
+// with the fixed scheme or with adaptive credits selected in the Makefile.
+// With BENCHMARK_RFCOMM_STREAMING, the sender writes into a ring buffer in
+// streaming mode instead of sending each frame from RFCOMM_EVENT_CAN_SEND_NOW.
+//
+// *****************************************************************************
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "btstack_config.h"
+
+#include "benchmark_util.h"
+#include "btstack_event.h"
+#include "btstack_memory.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "classic/rfcomm.h"
+#include "gap.h"
+#include "hci.h"
+#include "l2cap.h"
+#include "mock_controller.h"
+
+#define FRAMES_PER_BLOCK        64
+#define NUM_BLOCKS              20
+#define LATENCY_MS              10
+#define RFCOMM_SERVER_CHANNEL    1
+#define MAX_FRAME_SIZE        1000
+
+#define STREAM_BUFFER_SIZE    8192
+
+#ifdef ENABLE_RFCOMM_ADAPTIVE_CREDITS
+#define CREDITS_NAME "adaptive credits"
+#else
+#define CREDITS_NAME "fixed credits"
+#endif
+
+#ifdef BENCHMARK_RFCOMM_STREAMING
+#define SEND_NAME "streaming"
+#else
+#define SEND_NAME "frames"
+#endif
+
+static const bd_addr_t sender_address   = { 0x00, 0x1B, 0xDC, 0x07, 0x00, 0x01 };
+static const bd_addr_t receiver_address = { 0x00, 0x1B, 0xDC, 0x07, 0x00, 0x02 };
+
+static mock_controller_config_t controller_config;
+static btstack_packet_callback_registration_t hci_event_callback_registration;
+
+static uint8_t frame[MAX_FRAME_SIZE];
+
+// data is a byte pattern to verify in-order delivery independent of frame size
+static uint32_t stream_pos;
+
+#ifdef BENCHMARK_RFCOMM_STREAMING
+static uint8_t stream_storage[STREAM_BUFFER_SIZE];
+#endif
+
+// sender
+static uint32_t num_can_send_now_events;
+
+static pid_t    receiver_pid;
+static uint16_t rfcomm_cid;
+
+// receiver
+static benchmark_stats_t benchmark_stats;
+static uint64_t block_start_ns;
+static uint32_t num_bytes_received;
+static uint16_t num_blocks_received;
+
+static void fill_pattern(uint8_t * buffer, uint16_t len){
+    uint16_t i;
+    for (i = 0; i < len; i++){
+        buffer[i] = (uint8_t) ((stream_pos + i) % 251u);
+    }
+    stream_pos += len;
+}
+
+static void sender_send(void){
+#ifdef BENCHMARK_RFCOMM_STREAMING
+    // fill ring buffer, frames are sent by RFCOMM as credits allow
+    while (1){
+        fill_pattern(frame, sizeof(frame));
+        uint32_t written = rfcomm_stream_write(rfcomm_cid, frame, sizeof(frame));
+        if (written < sizeof(frame)){
+            stream_pos -= sizeof(frame) - written;
+            break;
+        }
+    }
+#else
+    fill_pattern(frame, sizeof(frame));
+    uint8_t status = (uint8_t) rfcomm_send(rfcomm_cid, frame, sizeof(frame));
+    if (status != ERROR_CODE_SUCCESS){
+        fprintf(stderr, "send failed, status 0x%02x\n", status);
+        exit(EXIT_FAILURE);
+    }
+#endif
+    rfcomm_request_can_send_now_event(rfcomm_cid);
+}
+
+static void sender_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    uint8_t status;
+    switch (packet_type){
+        case RFCOMM_DATA_PACKET:
+            // receiver has measured all blocks
+            rfcomm_request_channel_statistics_event(rfcomm_cid);
+            break;
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case BTSTACK_EVENT_STATE:
+                    if (btstack_event_state_get_state(packet) != HCI_STATE_WORKING) break;
+                    status = rfcomm_create_channel(&sender_packet_handler, (uint8_t *) receiver_address, RFCOMM_SERVER_CHANNEL, &rfcomm_cid);
+                    if (status != ERROR_CODE_SUCCESS){
+                        fprintf(stderr, "create channel failed, status 0x%02x\n", status);
+                        exit(EXIT_FAILURE);
+                    }
+                    break;
+                case RFCOMM_EVENT_CHANNEL_OPENED:
+                    status = rfcomm_event_channel_opened_get_status(packet);
+                    if (status != ERROR_CODE_SUCCESS){
+                        fprintf(stderr, "channel open failed, status 0x%02x\n", status);
+                        exit(EXIT_FAILURE);
+                    }
+                    if (rfcomm_event_channel_opened_get_max_frame_size(packet) < MAX_FRAME_SIZE){
+                        fprintf(stderr, "max frame size %u too small\n", rfcomm_event_channel_opened_get_max_frame_size(packet));
+                        exit(EXIT_FAILURE);
+                    }
+                    stream_pos = 0;
+#ifdef BENCHMARK_RFCOMM_STREAMING
+                    rfcomm_enable_streaming(rfcomm_cid, stream_storage, sizeof(stream_storage));
+#endif
+                    rfcomm_request_can_send_now_event(rfcomm_cid);
+                    break;
+                case RFCOMM_EVENT_CAN_SEND_NOW:
+                    num_can_send_now_events++;
+                    sender_send();
+                    break;
+                case RFCOMM_EVENT_CHANNEL_STATISTICS:
+                    benchmark_report_count("  sender out of credits", rfcomm_event_channel_statistics_get_tx_stalls(packet));
+                    benchmark_report_count("  can send now events", num_can_send_now_events);
+                    kill(receiver_pid, SIGTERM);
+                    waitpid(receiver_pid, NULL, 0);
+                    exit(EXIT_SUCCESS);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void receiver_handle_frame(const uint8_t * packet, uint16_t size){
+    uint16_t i;
+    for (i = 0; i < size; i++){
+        if (packet[i] != (uint8_t) ((stream_pos + i) % 251u)){
+            fprintf(stderr, "data at %u invalid\n", stream_pos + i);
+            exit(EXIT_FAILURE);
+        }
+    }
+    stream_pos += size;
+
+    num_bytes_received += size;
+    if (num_bytes_received < (FRAMES_PER_BLOCK * MAX_FRAME_SIZE)) return;
+    num_bytes_received -= FRAMES_PER_BLOCK * MAX_FRAME_SIZE;
+
+    uint64_t now_ns = benchmark_time_ns();
+    benchmark_stats_add(&benchmark_stats, now_ns - block_start_ns);
+    block_start_ns = now_ns;
+
+    num_blocks_received++;
+    if (num_blocks_received < NUM_BLOCKS) return;
+    benchmark_stats_report(&benchmark_stats);
+    fflush(stdout);
+    rfcomm_request_can_send_now_event(rfcomm_cid);
+}
+
+static void receiver_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    static uint8_t done = 0;
+    switch (packet_type){
+        case RFCOMM_DATA_PACKET:
+            if (num_blocks_received >= NUM_BLOCKS) break;
+            receiver_handle_frame(packet, size);
+            break;
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case RFCOMM_EVENT_INCOMING_CONNECTION:
+                    rfcomm_cid = rfcomm_event_incoming_connection_get_rfcomm_cid(packet);
+                    rfcomm_accept_connection(rfcomm_cid);
+                    break;
+                case RFCOMM_EVENT_CHANNEL_OPENED:
+                    benchmark_stats_init(&benchmark_stats, "rfcomm_stream_latency_10ms", NUM_BLOCKS);
+                    stream_pos = 0;
+                    num_bytes_received = 0;
+                    num_blocks_received = 0;
+                    block_start_ns = benchmark_time_ns();
+                    break;
+                case RFCOMM_EVENT_CAN_SEND_NOW:
+                    // tell sender that we're done
+                    rfcomm_send(rfcomm_cid, &done, 1);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void stack_init(int fd, const bd_addr_t public_address){
+    controller_config.peer_fd = fd;
+    (void)memcpy(controller_config.public_address, public_address, 6);
+    controller_config.le_acl_packet_length     = 27;
+    controller_config.le_acl_packets_total_num = 8;
+    controller_config.acl_packet_length        = 1021;
+    controller_config.acl_packets_total_num    = 8;
+    controller_config.latency_ms               = LATENCY_MS;
+
+    btstack_memory_init();
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+    hci_init(mock_controller_transport_instance(), &controller_config);
+    l2cap_init();
+    gap_set_security_level(LEVEL_0);
+    rfcomm_init();
+}
+
+int main(int argc, const char * argv[]){
+    int sockets[2];
+
+    if ((argc > 1) && (strcmp(argv[1], "-c") == 0)){
+        benchmark_set_csv_output(1);
+    }
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) != 0){
+        perror("socketpair");
+        return EXIT_FAILURE;
+    }
+
+    char backend[80];
+    snprintf(backend, sizeof(backend), "%s, %s, blocks of %u x %u bytes", CREDITS_NAME, SEND_NAME, FRAMES_PER_BLOCK, MAX_FRAME_SIZE);
+    benchmark_report_header(backend);
+
+    // make output visible before fork
+    fflush(stdout);
+
+    receiver_pid = fork();
+    if (receiver_pid < 0){
+        perror("fork");
+        return EXIT_FAILURE;
+    }
+
+    if (receiver_pid == 0){
+        // Receiver accepts channel and reports
+        close(sockets[0]);
+        stack_init(sockets[1], receiver_address);
+        rfcomm_register_service(&receiver_packet_handler, RFCOMM_SERVER_CHANNEL, 0xffff);
+    } else {
+        // Sender streams frames until receiver is done
+        close(sockets[1]);
+        stack_init(sockets[0], sender_address);
+        hci_event_callback_registration.callback = &sender_packet_handler;
+        hci_add_event_handler(&hci_event_callback_registration);
+    }
+
+    hci_power_control(HCI_POWER_ON);
+    btstack_run_loop_execute();
+    return EXIT_SUCCESS;
+}
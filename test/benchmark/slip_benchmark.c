@@ -0,0 +1,107 @@
+// *****************************************************************************
+//
+// SLIP encoder/decoder benchmark
+//
+// Encodes and decodes 1 kB frames with the byte-wise API and with the block
+// API, which copies runs without SOF or escape bytes at once. Frames contain
+// about one byte that needs escaping per 128 bytes.
+//
+// *****************************************************************************
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "benchmark_util.h"
+#include "btstack_slip.h"
+#include "btstack_util.h"
+
+#define FRAME_LEN       1024
+#define NUM_ITERATIONS 20000
+
+static uint8_t frame[FRAME_LEN];
+static uint8_t encoded[2 * FRAME_LEN + 2];
+static uint16_t encoded_len;
+static uint8_t decoded[FRAME_LEN];
+
+static void benchmark_prepare_frame(void){
+    uint16_t i;
+    for (i=0;i<FRAME_LEN;i++){
+        uint8_t value = (uint8_t) rand();
+        if ((value == BTSTACK_SLIP_SOF) || (value == 0xdb)){
+            value = 0;
+        }
+        frame[i] = value;
+    }
+    for (i=0;i<FRAME_LEN;i+=128){
+        frame[i] = (i & 128) ? 0xdb : BTSTACK_SLIP_SOF;
+    }
+}
+
+static void benchmark_encode_bytes(void){
+    encoded_len = 0;
+    encoded[encoded_len++] = BTSTACK_SLIP_SOF;
+    btstack_slip_encoder_start(frame, FRAME_LEN);
+    while (btstack_slip_encoder_has_data()){
+        encoded[encoded_len++] = btstack_slip_encoder_get_byte();
+    }
+    encoded[encoded_len++] = BTSTACK_SLIP_SOF;
+}
+
+static void benchmark_encode_block(void){
+    btstack_slip_encoder_t encoder;
+    encoded_len = 0;
+    encoded[encoded_len++] = BTSTACK_SLIP_SOF;
+    btstack_slip_encoder_instance_start(&encoder, frame, FRAME_LEN);
+    encoded_len += btstack_slip_encoder_instance_encode(&encoder, &encoded[encoded_len], sizeof(encoded) - 2);
+    encoded[encoded_len++] = BTSTACK_SLIP_SOF;
+}
+
+static void benchmark_decode_bytes(void){
+    btstack_slip_decoder_init(decoded, sizeof(decoded));
+    uint16_t i;
+    for (i=0;i<encoded_len;i++){
+        btstack_slip_decoder_process(encoded[i]);
+    }
+    if (btstack_slip_decoder_frame_size() != FRAME_LEN){
+        fprintf(stderr, "decoding failed\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void benchmark_decode_block(void){
+    btstack_slip_decoder_t decoder;
+    btstack_slip_decoder_instance_init(&decoder, decoded, sizeof(decoded));
+    (void) btstack_slip_decoder_instance_process(&decoder, encoded, encoded_len);
+    if (btstack_slip_decoder_instance_frame_size(&decoder) != FRAME_LEN){
+        fprintf(stderr, "decoding failed\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static void benchmark_run(const char * name, void (*function)(void)){
+    benchmark_stats_t stats;
+    benchmark_stats_init(&stats, name, NUM_ITERATIONS);
+    uint32_t i;
+    for (i=0;i<NUM_ITERATIONS;i++){
+        uint64_t start_ns = benchmark_time_ns();
+        (*function)();
+        benchmark_stats_add(&stats, benchmark_time_ns() - start_ns);
+    }
+    benchmark_stats_report(&stats);
+}
+
+int main(int argc, const char * argv[]){
+    if ((argc > 1) && (strcmp(argv[1], "-c") == 0)){
+        benchmark_set_csv_output(1);
+    }
+    benchmark_report_header("1 kB frames");
+    benchmark_prepare_frame();
+
+    benchmark_run("slip_encode_bytes", &benchmark_encode_bytes);
+    benchmark_run("slip_encode_block", &benchmark_encode_block);
+    // decode frame encoded by block encoder
+    benchmark_run("slip_decode_bytes", &benchmark_decode_bytes);
+    benchmark_run("slip_decode_block", &benchmark_decode_block);
+    return EXIT_SUCCESS;
+}
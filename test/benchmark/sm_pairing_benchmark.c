@@ -0,0 +1,200 @@
+// *****************************************************************************
+//
+// LE pairing benchmark
+//
+// Runs Central and Peripheral in two processes with the full BTstack host
+// stack, connected via mock controllers, and measures the time from
+// sm_request_pairing() to SM_EVENT_PAIRING_COMPLETE for LE Legacy Pairing
+// and LE Secure Connections with Just Works.
+//
+// *****************************************************************************
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "btstack_config.h"
+
+#include "ble/sm.h"
+#include "benchmark_util.h"
+#include "btstack_event.h"
+#include "btstack_memory.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "gap.h"
+#include "hci.h"
+#include "l2cap.h"
+#include "mock_controller.h"
+
+#define NUM_PAIRINGS 50
+
+#ifdef ENABLE_MICRO_ECC_P256
+#define BACKEND_NAME "software"
+#else
+#define BACKEND_NAME "controller"
+#endif
+
+typedef enum {
+    BENCHMARK_MODE_LEGACY,
+    BENCHMARK_MODE_SECURE_CONNECTIONS,
+    BENCHMARK_MODE_DONE,
+} benchmark_mode_t;
+
+static const bd_addr_t central_address    = { 0x00, 0x1B, 0xDC, 0x07, 0x00, 0x01 };
+static const bd_addr_t peripheral_address = { 0x00, 0x1B, 0xDC, 0x07, 0x00, 0x02 };
+
+static mock_controller_config_t controller_config;
+static btstack_packet_callback_registration_t hci_event_callback_registration;
+static btstack_packet_callback_registration_t sm_event_callback_registration;
+
+static pid_t             peripheral_pid;
+static benchmark_mode_t  benchmark_mode;
+static benchmark_stats_t benchmark_stats;
+static uint64_t          pairing_start_ns;
+static uint16_t          pairing_attempts;
+
+static void central_start_mode(benchmark_mode_t mode){
+    benchmark_mode = mode;
+    pairing_attempts = 0;
+    switch (mode){
+        case BENCHMARK_MODE_LEGACY:
+            benchmark_stats_init(&benchmark_stats, "sm_pairing_legacy", NUM_PAIRINGS);
+            sm_set_authentication_requirements(SM_AUTHREQ_NO_BONDING);
+            break;
+        case BENCHMARK_MODE_SECURE_CONNECTIONS:
+            benchmark_stats_init(&benchmark_stats, "sm_pairing_sc_just_works", NUM_PAIRINGS);
+            sm_set_authentication_requirements(SM_AUTHREQ_SECURE_CONNECTION);
+            break;
+        default:
+            kill(peripheral_pid, SIGTERM);
+            waitpid(peripheral_pid, NULL, 0);
+            exit(EXIT_SUCCESS);
+            break;
+    }
+    gap_connect((uint8_t *) peripheral_address, BD_ADDR_TYPE_LE_PUBLIC);
+}
+
+static void central_hci_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    if (packet_type != HCI_EVENT_PACKET) return;
+    switch (hci_event_packet_get_type(packet)){
+        case BTSTACK_EVENT_STATE:
+            if (btstack_event_state_get_state(packet) != HCI_STATE_WORKING) break;
+            central_start_mode(BENCHMARK_MODE_LEGACY);
+            break;
+        case HCI_EVENT_LE_META:
+            if (hci_event_le_meta_get_subevent_code(packet) != HCI_SUBEVENT_LE_CONNECTION_COMPLETE) break;
+            pairing_attempts++;
+            pairing_start_ns = benchmark_time_ns();
+            sm_request_pairing(hci_subevent_le_connection_complete_get_connection_handle(packet));
+            break;
+        case HCI_EVENT_DISCONNECTION_COMPLETE:
+            if (pairing_attempts < NUM_PAIRINGS){
+                gap_connect((uint8_t *) peripheral_address, BD_ADDR_TYPE_LE_PUBLIC);
+                break;
+            }
+            benchmark_stats_report(&benchmark_stats);
+            central_start_mode((benchmark_mode_t) (benchmark_mode + 1));
+            break;
+        default:
+            break;
+    }
+}
+
+static void central_sm_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    if (packet_type != HCI_EVENT_PACKET) return;
+    switch (hci_event_packet_get_type(packet)){
+        case SM_EVENT_JUST_WORKS_REQUEST:
+            sm_just_works_confirm(sm_event_just_works_request_get_handle(packet));
+            break;
+        case SM_EVENT_PAIRING_COMPLETE:
+            if (sm_event_pairing_complete_get_status(packet) == ERROR_CODE_SUCCESS){
+                benchmark_stats_add(&benchmark_stats, benchmark_time_ns() - pairing_start_ns);
+            } else {
+                fprintf(stderr, "pairing failed, status 0x%02x, reason 0x%02x\n", sm_event_pairing_complete_get_status(packet),
+                        sm_event_pairing_complete_get_reason(packet));
+            }
+            gap_disconnect(sm_event_pairing_complete_get_handle(packet));
+            break;
+        default:
+            break;
+    }
+}
+
+static void peripheral_sm_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    UNUSED(size);
+    if (packet_type != HCI_EVENT_PACKET) return;
+    switch (hci_event_packet_get_type(packet)){
+        case SM_EVENT_JUST_WORKS_REQUEST:
+            sm_just_works_confirm(sm_event_just_works_request_get_handle(packet));
+            break;
+        default:
+            break;
+    }
+}
+
+static void stack_init(int fd, const bd_addr_t public_address){
+    controller_config.peer_fd = fd;
+    (void)memcpy(controller_config.public_address, public_address, 6);
+    controller_config.le_acl_packet_length     = 27;
+    controller_config.le_acl_packets_total_num = 8;
+
+    btstack_memory_init();
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+    hci_init(mock_controller_transport_instance(), &controller_config);
+    l2cap_init();
+    sm_init();
+    sm_set_io_capabilities(IO_CAPABILITY_NO_INPUT_NO_OUTPUT);
+}
+
+int main(int argc, const char * argv[]){
+    int sockets[2];
+
+    if ((argc > 1) && (strcmp(argv[1], "-c") == 0)){
+        benchmark_set_csv_output(1);
+    }
+
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sockets) != 0){
+        perror("socketpair");
+        return EXIT_FAILURE;
+    }
+
+    // make output visible before fork
+    fflush(stdout);
+
+    peripheral_pid = fork();
+    if (peripheral_pid < 0){
+        perror("fork");
+        return EXIT_FAILURE;
+    }
+
+    if (peripheral_pid == 0){
+        // Peripheral accepts pairing with Secure Connections, if requested
+        close(sockets[0]);
+        stack_init(sockets[1], peripheral_address);
+        sm_set_authentication_requirements(SM_AUTHREQ_SECURE_CONNECTION);
+        sm_event_callback_registration.callback = &peripheral_sm_packet_handler;
+        sm_add_event_handler(&sm_event_callback_registration);
+    } else {
+        // Central starts pairing after each connect
+        close(sockets[1]);
+        stack_init(sockets[0], central_address);
+        hci_event_callback_registration.callback = &central_hci_packet_handler;
+        hci_add_event_handler(&hci_event_callback_registration);
+        sm_event_callback_registration.callback = &central_sm_packet_handler;
+        sm_add_event_handler(&sm_event_callback_registration);
+        benchmark_report_header(BACKEND_NAME);
+    }
+
+    hci_power_control(HCI_POWER_ON);
+    btstack_run_loop_execute();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,151 @@
+// *****************************************************************************
+//
+// H2 libusb ACL throughput benchmark
+//
+// Sends and receives HCI ACL packets through the H2 libusb transport on top
+// of a mock libusb device with USB Full Speed bulk throughput. Compares
+// polling via timer with file descriptor based event handling. Built with
+// default and with single transfer ACL queues.
+//
+// *****************************************************************************
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "btstack_config.h"
+
+#include "benchmark_util.h"
+#include "btstack_event.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_posix.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_transport.h"
+#include "mock_libusb.h"
+
+// USB Full Speed, ~1 MB/s for bulk transfers
+#define BULK_TRANSFER_OVERHEAD_NS 20000
+#define BULK_NS_PER_BYTE           1000
+
+#define ACL_PAYLOAD_LEN 251
+
+static const hci_transport_t * transport;
+static uint8_t  acl_packet[HCI_ACL_HEADER_SIZE + ACL_PAYLOAD_LEN];
+static benchmark_stats_t benchmark_stats;
+static uint32_t num_packets_expected;
+static uint32_t num_packets;
+static uint64_t last_packet_ns;
+
+static void benchmark_sample(void){
+    uint64_t now = benchmark_time_ns();
+    benchmark_stats_add(&benchmark_stats, now - last_packet_ns);
+    last_packet_ns = now;
+    num_packets++;
+    if (num_packets < num_packets_expected) return;
+    benchmark_stats_report(&benchmark_stats);
+    exit(EXIT_SUCCESS);
+}
+
+static void tx_send_packets(void){
+    while (transport->can_send_packet_now(HCI_ACL_DATA_PACKET)){
+        if (transport->send_packet(HCI_ACL_DATA_PACKET, acl_packet, sizeof(acl_packet)) != 0){
+            fprintf(stderr, "send failed\n");
+            exit(EXIT_FAILURE);
+        }
+        benchmark_sample();
+    }
+}
+
+static void packet_handler(uint8_t packet_type, uint8_t *packet, uint16_t size){
+    UNUSED(size);
+    switch (packet_type){
+        case HCI_EVENT_PACKET:
+            if (hci_event_packet_get_type(packet) != HCI_EVENT_TRANSPORT_PACKET_SENT) break;
+            tx_send_packets();
+            break;
+        case HCI_ACL_DATA_PACKET:
+            benchmark_sample();
+            break;
+        default:
+            break;
+    }
+}
+
+static void benchmark_run(const char * name, int pollfds, int receive, uint32_t packets){
+    mock_libusb_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.pollfds_supported = pollfds;
+    config.bulk_transfer_overhead_ns = BULK_TRANSFER_OVERHEAD_NS;
+    config.bulk_ns_per_byte = BULK_NS_PER_BYTE;
+    config.acl_in_payload_len = receive ? ACL_PAYLOAD_LEN : 0;
+    mock_libusb_init(&config);
+
+    // ACL packet with handle 0x0001, first fragment
+    little_endian_store_16(acl_packet, 0, 0x2001);
+    little_endian_store_16(acl_packet, 2, ACL_PAYLOAD_LEN);
+
+    btstack_run_loop_init(btstack_run_loop_posix_get_instance());
+    transport = hci_transport_usb_instance();
+    transport->register_packet_handler(&packet_handler);
+
+    // hide USB path printed by transport
+    int stdout_fd = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY);
+    dup2(null_fd, STDOUT_FILENO);
+    int err = transport->open();
+    fflush(stdout);
+    dup2(stdout_fd, STDOUT_FILENO);
+    close(null_fd);
+    close(stdout_fd);
+    if (err != 0){
+        fprintf(stderr, "failed to open USB transport\n");
+        exit(EXIT_FAILURE);
+    }
+
+    benchmark_stats_init(&benchmark_stats, name, packets);
+    num_packets_expected = packets;
+    num_packets = 0;
+    last_packet_ns = benchmark_time_ns();
+
+    if (!receive){
+        tx_send_packets();
+    }
+
+    btstack_run_loop_execute();
+}
+
+static void benchmark_fork(const char * name, int pollfds, int receive, uint32_t packets){
+    // run loop cannot be stopped, use a new process for each run
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0){
+        benchmark_run(name, pollfds, receive, packets);
+    }
+    waitpid(pid, NULL, 0);
+}
+
+int main(int argc, const char * argv[]){
+    if ((argc > 1) && (strcmp(argv[1], "-c") == 0)){
+        benchmark_set_csv_output(1);
+    }
+
+    char name[40];
+    char backend[40];
+    snprintf(backend, sizeof(backend), "mock-libusb, out %u, in %u", HCI_TRANSPORT_USB_ACL_OUT_BUFFER_COUNT,
+             HCI_TRANSPORT_USB_ACL_IN_BUFFER_COUNT);
+    benchmark_report_header(backend);
+
+    snprintf(name, sizeof(name), "usb_tx_acl_timer_out%u", HCI_TRANSPORT_USB_ACL_OUT_BUFFER_COUNT);
+    benchmark_fork(name, 0, 0, 2000);
+    snprintf(name, sizeof(name), "usb_tx_acl_pollfd_out%u", HCI_TRANSPORT_USB_ACL_OUT_BUFFER_COUNT);
+    benchmark_fork(name, 1, 0, 2000);
+    snprintf(name, sizeof(name), "usb_rx_acl_timer_in%u", HCI_TRANSPORT_USB_ACL_IN_BUFFER_COUNT);
+    benchmark_fork(name, 0, 1, 2000);
+    snprintf(name, sizeof(name), "usb_rx_acl_pollfd_in%u", HCI_TRANSPORT_USB_ACL_IN_BUFFER_COUNT);
+    benchmark_fork(name, 1, 1, 2000);
+    return EXIT_SUCCESS;
+}
@@ -203,6 +203,115 @@ TEST(ADParser, TestMalformed){
     CHECK_EQUAL(ad_iterator_has_more(&context), 0);
 }
 
+// Flags, 16-bit UUIDs 0x180D + 0x180F, 32-bit UUID 0x12345678, Manufacturer Data 0x004C 02 15 .., Complete Local Name
+static const uint8_t ad_filter_data[] = {
+    0x02, 0x01, 0x06,
+    0x05, 0x03, 0x0D, 0x18, 0x0F, 0x18,
+    0x05, 0x05, 0x78, 0x56, 0x34, 0x12,
+    0x07, 0xFF, 0x4C, 0x00, 0x02, 0x15, 0xAA, 0x55,
+    0x08, 0x09, 'B', 'T', 's', 't', 'a', 'c', 'k',
+};
+
+// 128-bit UUIDs: Heart Rate Service 0x180D based on Bluetooth Base UUID, vendor UUID
+static const uint8_t ad_filter_data_uuid128[] = {
+    0x21, 0x07,
+    0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x0D, 0x18, 0x00, 0x00,
+    0x10, 0x0F, 0x0E, 0x0D, 0x0C, 0x0B, 0x0A, 0x09, 0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,
+};
+
+static const uint8_t uuid128_vendor[] = {
+    0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,
+};
+
+static const uint8_t uuid128_battery_service[] = {
+    0x00, 0x00, 0x18, 0x0F, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB,
+};
+
+TEST_GROUP(ADFilter){
+    ad_filter_t filter;
+    void setup(void){
+        ad_filter_init(&filter);
+    }
+};
+
+TEST(ADFilter, NoRules){
+    CHECK_EQUAL(0, ad_filter_match(&filter, sizeof(ad_filter_data), ad_filter_data));
+}
+
+TEST(ADFilter, Uuid16){
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_uuid16(&filter, 0, 0x1800));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_uuid16(&filter, 1, 0x180F));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_uuid16(&filter, 2, 0x180D));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_uuid16(&filter, 3, 0x180F));
+    CHECK_EQUAL(0x0e, ad_filter_match(&filter, sizeof(ad_filter_data), ad_filter_data));
+    // 16-bit UUID in 128-bit list
+    CHECK_EQUAL(0x04, ad_filter_match(&filter, sizeof(ad_filter_data_uuid128), ad_filter_data_uuid128));
+}
+
+TEST(ADFilter, Uuid32){
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_uuid32(&filter, 5, 0x12345678));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_uuid32(&filter, 6, 0x0000180D));
+    CHECK_EQUAL(0x60, ad_filter_match(&filter, sizeof(ad_filter_data), ad_filter_data));
+}
+
+TEST(ADFilter, Uuid128){
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_uuid128(&filter, 0, uuid128_vendor));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_uuid128(&filter, 1, uuid128_battery_service));
+    CHECK_EQUAL(0x01, ad_filter_match(&filter, sizeof(ad_filter_data_uuid128), ad_filter_data_uuid128));
+    // Bluetooth Base UUID matches 16-bit UUID list
+    CHECK_EQUAL(0x02, ad_filter_match(&filter, sizeof(ad_filter_data), ad_filter_data));
+}
+
+TEST(ADFilter, ManufacturerData){
+    const uint8_t ibeacon_prefix[] = { 0x02, 0x15 };
+    const uint8_t masked_data[]    = { 0x02, 0x15, 0xA0, 0x00 };
+    const uint8_t mask[]           = { 0xFF, 0xFF, 0xF0, 0x00 };
+    const uint8_t wrong_data[]     = { 0x02, 0x16 };
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_manufacturer_data(&filter, 0, 0x004C, NULL, NULL, 0));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_manufacturer_data(&filter, 1, 0x004C, ibeacon_prefix, NULL, sizeof(ibeacon_prefix)));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_manufacturer_data(&filter, 2, 0x004C, masked_data, mask, sizeof(masked_data)));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_manufacturer_data(&filter, 3, 0x004C, wrong_data, NULL, sizeof(wrong_data)));
+    CHECK_EQUAL(0x07, ad_filter_match(&filter, sizeof(ad_filter_data), ad_filter_data));
+    // data longer than manufacturer data in advertisement
+    ad_filter_init(&filter);
+    uint8_t long_data[6] = { 0x02, 0x15, 0xAA, 0x55, 0x00, 0x00 };
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_manufacturer_data(&filter, 0, 0x004C, long_data, NULL, sizeof(long_data)));
+    CHECK_EQUAL(0, ad_filter_match(&filter, sizeof(ad_filter_data), ad_filter_data));
+}
+
+TEST(ADFilter, NamePrefix){
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_name_prefix(&filter, 0, "BT"));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_name_prefix(&filter, 1, "BTstack-LE"));
+    CHECK_EQUAL(0x01, ad_filter_match(&filter, sizeof(ad_filter_data), ad_filter_data));
+    CHECK_EQUAL(0x01, ad_filter_match(&filter, sizeof(adv_data_2), adv_data_2));
+}
+
+TEST(ADFilter, Capacity){
+    int i;
+    for (i=0;i<AD_FILTER_MAX_UUIDS;i++){
+        CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_uuid16(&filter, 0, 0x2000 - i));
+    }
+    CHECK_EQUAL(ERROR_CODE_MEMORY_CAPACITY_EXCEEDED, ad_filter_add_uuid16(&filter, 0, 0x3000));
+    // existing UUID can be added to another rule
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_uuid16(&filter, 1, 0x2000));
+    CHECK_EQUAL(ERROR_CODE_INVALID_HCI_COMMAND_PARAMETERS, ad_filter_add_uuid16(&filter, AD_FILTER_MAX_RULES, 0x2000));
+    uint8_t data[] = { 0x03, 0x03, 0x00, 0x20 };
+    CHECK_EQUAL(0x03, ad_filter_match(&filter, sizeof(data), data));
+    data[2] = 0xFF;
+    data[3] = 0x1F;
+    CHECK_EQUAL(0x01, ad_filter_match(&filter, sizeof(data), data));
+    data[3] = 0x30;
+    CHECK_EQUAL(0x00, ad_filter_match(&filter, sizeof(data), data));
+}
+
+TEST(ADFilter, Malformed){
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_uuid16(&filter, 0, 0x180D));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, ad_filter_add_manufacturer_data(&filter, 1, 0x004C, NULL, NULL, 0));
+    // truncated UUID list and manufacturer data without complete company id
+    uint8_t data[] = { 0x02, 0x03, 0x0D, 0x02, 0xFF, 0x4C };
+    CHECK_EQUAL(0, ad_filter_match(&filter, sizeof(data), data));
+}
+
 int main (int argc, const char * argv[]){
     return CommandLineTestRunner::RunAllTests(argc, argv);
 }
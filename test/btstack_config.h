@@ -24,6 +24,8 @@
 #define ENABLE_LE_SIGNED_WRITE
 #define ENABLE_LE_PERIPHERAL
 #define ENABLE_LE_CENTRAL
+#define ENABLE_LE_SCAN_FILTER
+#define ENABLE_LE_THROUGHPUT_OPTIMIZER
 #define ENABLE_SDP_EXTRA_QUERIES
 #define ENABLE_L2CAP_ENHANCED_RETRANSMISSION_MODE
 
@@ -13,7 +13,7 @@
 #include "btstack_config.h"
 #include "btstack_debug.h"
 
-#define HAL_FLASH_BANK_MEMORY_STORAGE_SIZE 512
+#define HAL_FLASH_BANK_MEMORY_STORAGE_SIZE 2048
 static uint8_t hal_flash_bank_memory_storage[HAL_FLASH_BANK_MEMORY_STORAGE_SIZE];
 
 static void CHECK_EQUAL_ARRAY(uint8_t * expected, uint8_t * actual, int size){
@@ -123,6 +123,76 @@ TEST(LE_DEVICE_DB, AddTwoRemoveOneAddOne){
     CHECK_EQUAL_ARRAY(addr_cc, addr, 6);
 }
 
+TEST(LE_DEVICE_DB, AddSameAddressTwice){
+    int index_a = le_device_db_add(BD_ADDR_TYPE_LE_PUBLIC, addr_aa, sm_key_aa);
+    CHECK_TRUE(index_a >= 0);
+    int index_b = le_device_db_add(BD_ADDR_TYPE_LE_PUBLIC, addr_aa, sm_key_bb);
+    CHECK_EQUAL(index_a, index_b);
+    CHECK_EQUAL(1, le_device_db_count());
+    sm_key_t sm_key;
+    le_device_db_info(index_b, NULL, NULL, sm_key);
+    CHECK_EQUAL_ARRAY(sm_key_bb, sm_key, 16);
+}
+
+TEST(LE_DEVICE_DB, AddSameAddressDifferentType){
+    int index_a = le_device_db_add(BD_ADDR_TYPE_LE_PUBLIC, addr_aa, sm_key_aa);
+    int index_b = le_device_db_add(BD_ADDR_TYPE_LE_RANDOM, addr_aa, sm_key_bb);
+    CHECK_TRUE(index_a != index_b);
+    CHECK_EQUAL(2, le_device_db_count());
+}
+
+TEST(LE_DEVICE_DB, RemovedEntryUnknown){
+    int index_a = le_device_db_add(BD_ADDR_TYPE_LE_PUBLIC, addr_aa, sm_key_aa);
+    le_device_db_remove(index_a);
+    CHECK_EQUAL(0, le_device_db_count());
+    int addr_type = BD_ADDR_TYPE_LE_PUBLIC;
+    le_device_db_info(index_a, &addr_type, NULL, NULL);
+    CHECK_EQUAL(BD_ADDR_TYPE_UNKNOWN, addr_type);
+    // re-add after remove
+    int index_b = le_device_db_add(BD_ADDR_TYPE_LE_PUBLIC, addr_aa, sm_key_aa);
+    CHECK_TRUE(index_b >= 0);
+    CHECK_EQUAL(1, le_device_db_count());
+}
+
+TEST(LE_DEVICE_DB, FullEvictsOldest){
+    int i;
+    bd_addr_t addr;
+    int index_first = -1;
+    for (i=0;i<le_device_db_max_count();i++){
+        memset(addr, i, 6);
+        int index = le_device_db_add(BD_ADDR_TYPE_LE_PUBLIC, addr, sm_key_aa);
+        if (i == 0){
+            index_first = index;
+        }
+    }
+    CHECK_EQUAL(le_device_db_max_count(), le_device_db_count());
+    int index_new = le_device_db_add(BD_ADDR_TYPE_LE_PUBLIC, addr_cc, sm_key_cc);
+    CHECK_EQUAL(index_first, index_new);
+    CHECK_EQUAL(le_device_db_max_count(), le_device_db_count());
+    // evicted entry can be re-added
+    memset(addr, 0, 6);
+    int index_old = le_device_db_add(BD_ADDR_TYPE_LE_PUBLIC, addr, sm_key_aa);
+    CHECK_TRUE(index_old >= 0);
+    CHECK_TRUE(index_old != index_new);
+}
+
+TEST(LE_DEVICE_DB, IndexRestoredFromTLV){
+    int index_a = le_device_db_add(BD_ADDR_TYPE_LE_PUBLIC, addr_aa, sm_key_aa);
+    int index_b = le_device_db_add(BD_ADDR_TYPE_LE_RANDOM, addr_bb, sm_key_bb);
+    le_device_db_tlv_configure(btstack_tlv_impl, &btstack_tlv_context);
+    CHECK_EQUAL(2, le_device_db_count());
+    bd_addr_t addr;
+    sm_key_t sm_key;
+    int addr_type;
+    le_device_db_info(index_b, &addr_type, addr, sm_key);
+    CHECK_EQUAL(BD_ADDR_TYPE_LE_RANDOM, addr_type);
+    CHECK_EQUAL_ARRAY(sm_key_bb, sm_key, 16);
+    CHECK_EQUAL_ARRAY(addr_bb, addr, 6);
+    // known address maps to same entry
+    CHECK_EQUAL(index_a, le_device_db_add(BD_ADDR_TYPE_LE_PUBLIC, addr_aa, sm_key_aa));
+    CHECK_EQUAL(2, le_device_db_count());
+}
+
 
 int main (int argc, const char * argv[]){
     hci_dump_open("tlv_le_test.pklg", HCI_DUMP_PACKETLOGGER);
@@ -326,6 +326,45 @@ TEST(LINK_KEY_DB, KeyReplacement){
     CHECK_EQUAL_ARRAY(link_key1, test_link_key, 16);
 }
 
+TEST(LINK_KEY_DB, KeyReplacementLeastRecentlyUsed){
+	link_key_t test_link_key;
+    link_key_type_t test_link_key_type;
+
+	btstack_link_key_db->put_link_key(addr1, link_key1, link_key_type);
+	btstack_link_key_db->put_link_key(addr2, link_key2, link_key_type);
+    CHECK(btstack_link_key_db->get_link_key(addr1, test_link_key, &test_link_key_type) == 1);
+	btstack_link_key_db->put_link_key(addr3, link_key1, link_key_type);
+
+    CHECK(btstack_link_key_db->get_link_key(addr3, test_link_key, &test_link_key_type) == 1);
+    CHECK(btstack_link_key_db->get_link_key(addr2, test_link_key, &test_link_key_type) == 0);
+    CHECK(btstack_link_key_db->get_link_key(addr1, test_link_key, &test_link_key_type) == 1);
+    CHECK_EQUAL_ARRAY(link_key1, test_link_key, 16);
+}
+
+TEST(LINK_KEY_DB, IndexRestoredFromTLV){
+	link_key_t test_link_key;
+    link_key_type_t test_link_key_type;
+
+	btstack_link_key_db->put_link_key(addr1, link_key1, link_key_type);
+	btstack_link_key_db->put_link_key(addr2, link_key2, link_key_type);
+	btstack_link_key_db->delete_link_key(addr1);
+	btstack_link_key_db = btstack_link_key_db_tlv_get_instance(btstack_tlv_impl, &btstack_tlv_context);
+
+    CHECK(btstack_link_key_db->get_link_key(addr1, test_link_key, &test_link_key_type) == 0);
+    CHECK(btstack_link_key_db->get_link_key(addr2, test_link_key, &test_link_key_type) == 1);
+    CHECK_EQUAL_ARRAY(link_key2, test_link_key, 16);
+
+    btstack_link_key_iterator_t it;
+    bd_addr_t test_addr;
+    int num_keys = 0;
+    btstack_link_key_db->iterator_init(&it);
+    while (btstack_link_key_db->iterator_get_next(&it, test_addr, test_link_key, &test_link_key_type)){
+        num_keys++;
+    }
+    btstack_link_key_db->iterator_done(&it);
+    CHECK_EQUAL(1, num_keys);
+}
+
 int main (int argc, const char * argv[]){
 	hci_dump_open("tlv_test.pklg", HCI_DUMP_PACKETLOGGER);
     return CommandLineTestRunner::RunAllTests(argc, argv);
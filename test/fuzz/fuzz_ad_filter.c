@@ -0,0 +1,38 @@
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ad_parser.h"
+
+static const uint8_t uuid128_vendor[] = {
+    0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,
+};
+
+static const uint8_t uuid128_battery_service[] = {
+    0x00, 0x00, 0x18, 0x0F, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB,
+};
+
+static const uint8_t ibeacon_data[] = { 0x02, 0x15, 0xA0, 0x00 };
+static const uint8_t ibeacon_mask[] = { 0xFF, 0xFF, 0xF0, 0x00 };
+
+static ad_filter_t ad_filter;
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static int initialized = 0;
+    if (initialized == 0){
+        initialized = 1;
+        // use all rule types
+        ad_filter_init(&ad_filter);
+        ad_filter_add_uuid16(&ad_filter, 0, 0x180D);
+        ad_filter_add_uuid16(&ad_filter, 1, 0x180F);
+        ad_filter_add_uuid32(&ad_filter, 2, 0x12345678);
+        ad_filter_add_uuid128(&ad_filter, 3, uuid128_vendor);
+        ad_filter_add_uuid128(&ad_filter, 4, uuid128_battery_service);
+        ad_filter_add_manufacturer_data(&ad_filter, 5, 0x004C, ibeacon_data, ibeacon_mask, sizeof(ibeacon_data));
+        ad_filter_add_manufacturer_data(&ad_filter, 6, 0x0059, NULL, NULL, 0);
+        ad_filter_add_name_prefix(&ad_filter, 7, "BTstack");
+    }
+    // ad parser uses uint8_t length
+    if (size > 255) return 0;
+    ad_filter_match(&ad_filter, size, data);
+    return 0;
+}
@@ -0,0 +1,226 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include "btstack_debug.h"
+#include "btstack_event.h"
+#include "btstack_memory.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_base.h"
+#include "hci.h"
+#include "hci_cmd.h"
+#include "hci_dump.h"
+
+#define CON_HANDLE_BULK  0x0040
+#define CON_HANDLE_AUDIO 0x0041
+
+#define LE_ACL_PACKETS_TOTAL 4
+#define LE_ACL_PACKET_LENGTH 27
+
+static int num_acl_packets_sent;
+
+static  void (*packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
+
+static const uint8_t packet_sent_event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
+
+static int hci_transport_test_set_baudrate(uint32_t baudrate){
+    return 0;
+}
+
+static int hci_transport_test_can_send_now(uint8_t packet_type){
+    return 1;
+}
+
+static int hci_transport_test_send_packet(uint8_t packet_type, uint8_t * packet, int size){
+    if (packet_type == HCI_ACL_DATA_PACKET){
+        num_acl_packets_sent++;
+    }
+    // notify upper stack that it can send again
+    packet_handler(HCI_EVENT_PACKET, (uint8_t *) &packet_sent_event[0], sizeof(packet_sent_event));
+    return 0;
+}
+
+static void hci_transport_test_init(const void * transport_config){
+}
+
+static int hci_transport_test_open(void){
+    return 0;
+}
+
+static int hci_transport_test_close(void){
+    return 0;
+}
+
+static void hci_transport_test_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
+    packet_handler = handler;
+}
+
+static const hci_transport_t hci_transport_test = {
+        /* const char * name; */                                        "TEST",
+        /* void   (*init) (const void *transport_config); */            &hci_transport_test_init,
+        /* int    (*open)(void); */                                     &hci_transport_test_open,
+        /* int    (*close)(void); */                                    &hci_transport_test_close,
+        /* void   (*register_packet_handler)(void (*handler)(...); */   &hci_transport_test_register_packet_handler,
+        /* int    (*can_send_packet_now)(uint8_t packet_type); */       &hci_transport_test_can_send_now,
+        /* int    (*send_packet)(...); */                               &hci_transport_test_send_packet,
+        /* int    (*set_baudrate)(uint32_t baudrate); */                &hci_transport_test_set_baudrate,
+        /* void   (*reset_link)(void); */                               NULL,
+        /* void   (*set_sco_config)(uint16_t voice_setting, int num_connections); */ NULL,
+};
+
+// mock run loop without time
+
+static void mock_run_loop_init(void){
+    btstack_run_loop_base_init();
+}
+
+static void mock_run_loop_set_timer(btstack_timer_source_t * ts, uint32_t timeout_in_ms){
+    ts->timeout = timeout_in_ms;
+}
+
+static uint32_t mock_run_loop_get_time_ms(void){
+    return 0;
+}
+
+static const btstack_run_loop_t mock_run_loop = {
+    &mock_run_loop_init,
+    &btstack_run_loop_base_add_data_source,
+    &btstack_run_loop_base_remove_data_source,
+    &btstack_run_loop_base_enable_data_source_callbacks,
+    &btstack_run_loop_base_disable_data_source_callbacks,
+    &mock_run_loop_set_timer,
+    &btstack_run_loop_base_add_timer,
+    &btstack_run_loop_base_remove_timer,
+    NULL,
+    NULL,
+    &mock_run_loop_get_time_ms,
+};
+
+static void send_le_read_buffer_size_complete(void){
+    uint8_t event[] = { HCI_EVENT_COMMAND_COMPLETE, 7, 1, 0, 0, 0, 0, 0, 0 };
+    little_endian_store_16(event, 3, hci_le_read_buffer_size.opcode);
+    little_endian_store_16(event, 6, LE_ACL_PACKET_LENGTH);
+    event[8] = LE_ACL_PACKETS_TOTAL;
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void send_le_connection_complete(hci_con_handle_t con_handle){
+    uint8_t event[] = { HCI_EVENT_LE_META, 19, HCI_SUBEVENT_LE_CONNECTION_COMPLETE, 0, 0, 0, HCI_ROLE_MASTER, 0,
+                        0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x18, 0, 0, 0, 0x48, 0, 0 };
+    little_endian_store_16(event, 4, con_handle);
+    event[13] = (uint8_t) con_handle;
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void send_number_of_completed_packets(hci_con_handle_t con_handle, uint16_t num_packets){
+    uint8_t event[] = { HCI_EVENT_NUMBER_OF_COMPLETED_PACKETS, 5, 1, 0, 0, 0, 0 };
+    little_endian_store_16(event, 3, con_handle);
+    little_endian_store_16(event, 5, num_packets);
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+// send L2CAP PDU with payload of given size
+static void send_l2cap_pdu(hci_con_handle_t con_handle, uint16_t payload_len){
+    CHECK(hci_reserve_packet_buffer() != 0);
+    uint8_t * packet = hci_get_outgoing_packet_buffer();
+    little_endian_store_16(packet, 0, con_handle);
+    little_endian_store_16(packet, 2, 4 + payload_len);
+    little_endian_store_16(packet, 4, payload_len);
+    little_endian_store_16(packet, 6, L2CAP_CID_ATTRIBUTE_PROTOCOL);
+    memset(&packet[8], 0x55, payload_len);
+    hci_send_acl_packet_buffer(8 + payload_len);
+}
+
+TEST_GROUP(HCI_ACL_TX_PRIORITY){
+    void setup(void){
+        num_acl_packets_sent = 0;
+        hci_init(&hci_transport_test, NULL);
+        hci_simulate_working_fuzz();
+        send_le_read_buffer_size_complete();
+        send_le_connection_complete(CON_HANDLE_BULK);
+        send_le_connection_complete(CON_HANDLE_AUDIO);
+    }
+    void teardown(void){
+        hci_free_connections_fuzz();
+    }
+};
+
+TEST(HCI_ACL_TX_PRIORITY, SetAndGet){
+    CHECK_EQUAL(HCI_ACL_TX_PRIORITY_BULK, hci_get_acl_tx_priority(CON_HANDLE_AUDIO));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, hci_set_acl_tx_priority(CON_HANDLE_AUDIO, HCI_ACL_TX_PRIORITY_AUDIO));
+    CHECK_EQUAL(HCI_ACL_TX_PRIORITY_AUDIO, hci_get_acl_tx_priority(CON_HANDLE_AUDIO));
+    CHECK_EQUAL(ERROR_CODE_INVALID_HCI_COMMAND_PARAMETERS, hci_set_acl_tx_priority(CON_HANDLE_AUDIO, HCI_ACL_TX_PRIORITY_NUM));
+    CHECK_EQUAL(ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER, hci_set_acl_tx_priority(0x0123, HCI_ACL_TX_PRIORITY_AUDIO));
+    CHECK_EQUAL(HCI_ACL_TX_PRIORITY_BULK, hci_get_acl_tx_priority(0x0123));
+    CHECK_EQUAL(false, hci_acl_tx_priority_can_send_now(0x0123));
+}
+
+TEST(HCI_ACL_TX_PRIORITY, NoReservationWithoutHigherPriority){
+    int i;
+    for (i = 0; i < (LE_ACL_PACKETS_TOTAL - 1); i++){
+        CHECK_EQUAL(true, hci_acl_tx_priority_can_send_now(CON_HANDLE_BULK));
+        send_l2cap_pdu(CON_HANDLE_BULK, 10);
+    }
+    CHECK_EQUAL(true, hci_acl_tx_priority_can_send_now(CON_HANDLE_BULK));
+}
+
+TEST(HCI_ACL_TX_PRIORITY, LowerPriorityLeavesBufferFree){
+    hci_set_acl_tx_priority(CON_HANDLE_AUDIO, HCI_ACL_TX_PRIORITY_AUDIO);
+    int i;
+    for (i = 0; i < (LE_ACL_PACKETS_TOTAL - 1); i++){
+        CHECK_EQUAL(true, hci_acl_tx_priority_can_send_now(CON_HANDLE_BULK));
+        send_l2cap_pdu(CON_HANDLE_BULK, 10);
+    }
+    // last buffer is reserved for audio connection
+    CHECK_EQUAL(false, hci_acl_tx_priority_can_send_now(CON_HANDLE_BULK));
+    CHECK_EQUAL(false, hci_acl_tx_priority_can_send_now(CON_HANDLE_BULK));
+    CHECK_EQUAL(true,  hci_acl_tx_priority_can_send_now(CON_HANDLE_AUDIO));
+
+    // checks alone are not counted
+    hci_acl_tx_statistics_t statistics;
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, hci_get_acl_tx_statistics(CON_HANDLE_BULK, &statistics));
+    CHECK_EQUAL(0, statistics.packets_deferred);
+
+    // held back PDU is counted once
+    hci_acl_tx_priority_packet_deferred(CON_HANDLE_BULK);
+    hci_acl_tx_priority_packet_deferred(CON_HANDLE_BULK);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, hci_get_acl_tx_statistics(CON_HANDLE_BULK, &statistics));
+    CHECK_EQUAL(1, statistics.packets_deferred);
+    CHECK_EQUAL(3, statistics.packets_in_flight);
+
+    // reservation ends with completed packets or lowered priority
+    send_number_of_completed_packets(CON_HANDLE_BULK, 1);
+    CHECK_EQUAL(true, hci_acl_tx_priority_can_send_now(CON_HANDLE_BULK));
+    send_l2cap_pdu(CON_HANDLE_BULK, 10);
+    CHECK_EQUAL(false, hci_acl_tx_priority_can_send_now(CON_HANDLE_BULK));
+    // next PDU counted again
+    hci_acl_tx_priority_packet_deferred(CON_HANDLE_BULK);
+    hci_get_acl_tx_statistics(CON_HANDLE_BULK, &statistics);
+    CHECK_EQUAL(2, statistics.packets_deferred);
+    hci_set_acl_tx_priority(CON_HANDLE_AUDIO, HCI_ACL_TX_PRIORITY_BULK);
+    CHECK_EQUAL(true, hci_acl_tx_priority_can_send_now(CON_HANDLE_BULK));
+}
+
+TEST(HCI_ACL_TX_PRIORITY, StartedPduIsNotDeferred){
+    hci_set_acl_tx_priority(CON_HANDLE_AUDIO, HCI_ACL_TX_PRIORITY_AUDIO);
+    send_l2cap_pdu(CON_HANDLE_BULK, 10);
+    CHECK_EQUAL(true, hci_acl_tx_priority_can_send_now(CON_HANDLE_BULK));
+    // 3 fragments use the reserved buffer as well
+    send_l2cap_pdu(CON_HANDLE_BULK, (3 * LE_ACL_PACKET_LENGTH) - 4);
+    CHECK_EQUAL(4, num_acl_packets_sent);
+
+    hci_acl_tx_statistics_t statistics;
+    hci_get_acl_tx_statistics(CON_HANDLE_BULK, &statistics);
+    CHECK_EQUAL(0, statistics.packets_deferred);
+    CHECK_EQUAL(4, statistics.packets_in_flight);
+    CHECK_EQUAL(2, statistics.sdus_sent);
+}
+
+int main (int argc, const char * argv[]){
+    btstack_run_loop_init(&mock_run_loop);
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
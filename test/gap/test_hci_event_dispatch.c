@@ -0,0 +1,280 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include "btstack_debug.h"
+#include "btstack_event.h"
+#include "btstack_memory.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_base.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_cmd.h"
+#include "hci_dump.h"
+
+#define NUM_HANDLERS (HCI_EVENT_DISPATCH_CACHE_MAX_HANDLERS + 2)
+
+// LE Meta subevent without special handling in HCI
+#define TEST_LE_SUBEVENT 0x30
+
+static  void (*packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
+
+static btstack_packet_callback_registration_t callback_registrations[NUM_HANDLERS];
+static btstack_event_filter_t                 event_filters[NUM_HANDLERS];
+static int                                    num_events[NUM_HANDLERS];
+
+// order of handler calls
+static int call_log[32];
+static int call_log_len;
+
+static void (*handler_hook)(int handler_index, uint8_t * packet);
+
+static int hci_transport_test_set_baudrate(uint32_t baudrate){
+    return 0;
+}
+
+static int hci_transport_test_can_send_now(uint8_t packet_type){
+    return 1;
+}
+
+static int hci_transport_test_send_packet(uint8_t packet_type, uint8_t * packet, int size){
+    return 0;
+}
+
+static void hci_transport_test_init(const void * transport_config){
+}
+
+static int hci_transport_test_open(void){
+    return 0;
+}
+
+static int hci_transport_test_close(void){
+    return 0;
+}
+
+static void hci_transport_test_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
+    packet_handler = handler;
+}
+
+static const hci_transport_t hci_transport_test = {
+        /* const char * name; */                                        "TEST",
+        /* void   (*init) (const void *transport_config); */            &hci_transport_test_init,
+        /* int    (*open)(void); */                                     &hci_transport_test_open,
+        /* int    (*close)(void); */                                    &hci_transport_test_close,
+        /* void   (*register_packet_handler)(void (*handler)(...); */   &hci_transport_test_register_packet_handler,
+        /* int    (*can_send_packet_now)(uint8_t packet_type); */       &hci_transport_test_can_send_now,
+        /* int    (*send_packet)(...); */                               &hci_transport_test_send_packet,
+        /* int    (*set_baudrate)(uint32_t baudrate); */                &hci_transport_test_set_baudrate,
+        /* void   (*reset_link)(void); */                               NULL,
+        /* void   (*set_sco_config)(uint16_t voice_setting, int num_connections); */ NULL,
+};
+
+// mock run loop without time
+
+static void mock_run_loop_init(void){
+    btstack_run_loop_base_init();
+}
+
+static void mock_run_loop_set_timer(btstack_timer_source_t * ts, uint32_t timeout_in_ms){
+    ts->timeout = timeout_in_ms;
+}
+
+static uint32_t mock_run_loop_get_time_ms(void){
+    return 0;
+}
+
+static const btstack_run_loop_t mock_run_loop = {
+    &mock_run_loop_init,
+    &btstack_run_loop_base_add_data_source,
+    &btstack_run_loop_base_remove_data_source,
+    &btstack_run_loop_base_enable_data_source_callbacks,
+    &btstack_run_loop_base_disable_data_source_callbacks,
+    &mock_run_loop_set_timer,
+    &btstack_run_loop_base_add_timer,
+    &btstack_run_loop_base_remove_timer,
+    NULL,
+    NULL,
+    &mock_run_loop_get_time_ms,
+};
+
+static void handle_event(int handler_index, uint8_t * packet){
+    num_events[handler_index]++;
+    if (call_log_len < (int) (sizeof(call_log) / sizeof(int))){
+        call_log[call_log_len++] = handler_index;
+    }
+    if (handler_hook != NULL){
+        (*handler_hook)(handler_index, packet);
+    }
+}
+
+static void packet_handler_0(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    handle_event(0, packet);
+}
+
+static void packet_handler_1(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    handle_event(1, packet);
+}
+
+static void packet_handler_2(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    handle_event(2, packet);
+}
+
+static void packet_handler_n(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    handle_event(NUM_HANDLERS - 1, packet);
+}
+
+static const btstack_packet_handler_t packet_handlers[] = {
+    &packet_handler_0, &packet_handler_1, &packet_handler_2,
+};
+
+static void add_handler(int handler_index, const btstack_event_filter_t * event_filter){
+    callback_registrations[handler_index].callback = packet_handlers[handler_index];
+    callback_registrations[handler_index].event_filter = event_filter;
+    hci_add_event_handler(&callback_registrations[handler_index]);
+}
+
+static void send_encryption_change(void){
+    uint8_t event[] = { HCI_EVENT_ENCRYPTION_CHANGE, 4, 0, 0x40, 0x00, 1 };
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void send_le_subevent(uint8_t subevent_code){
+    uint8_t event[] = { HCI_EVENT_LE_META, 1, subevent_code };
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void send_advertising_report(void){
+    uint8_t event[] = { HCI_EVENT_LE_META, 13, HCI_SUBEVENT_LE_ADVERTISING_REPORT, 1, 0, 0, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0, 0xc5, 0 };
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+TEST_GROUP(HCI_EVENT_DISPATCH){
+    void setup(void){
+        memset(callback_registrations, 0, sizeof(callback_registrations));
+        memset(num_events, 0, sizeof(num_events));
+        call_log_len = 0;
+        handler_hook = NULL;
+        hci_init(&hci_transport_test, NULL);
+        hci_simulate_working_fuzz();
+    }
+};
+
+TEST(HCI_EVENT_DISPATCH, FilterSelectsEventsAndSubevents){
+    add_handler(0, NULL);
+    btstack_event_filter_init(&event_filters[1]);
+    btstack_event_filter_add_event(&event_filters[1], HCI_EVENT_ENCRYPTION_CHANGE);
+    add_handler(1, &event_filters[1]);
+    btstack_event_filter_init(&event_filters[2]);
+    btstack_event_filter_add_le_subevent(&event_filters[2], TEST_LE_SUBEVENT);
+    add_handler(2, &event_filters[2]);
+
+    // dispatch twice to use collected handlers
+    int i;
+    for (i = 0; i < 2; i++){
+        send_encryption_change();
+        send_le_subevent(TEST_LE_SUBEVENT);
+        send_le_subevent(TEST_LE_SUBEVENT + 1);
+    }
+    CHECK_EQUAL(6, num_events[0]);
+    CHECK_EQUAL(2, num_events[1]);
+    CHECK_EQUAL(2, num_events[2]);
+}
+
+TEST(HCI_EVENT_DISPATCH, LeMetaEnablesAllSubevents){
+    btstack_event_filter_init(&event_filters[0]);
+    btstack_event_filter_add_event(&event_filters[0], HCI_EVENT_LE_META);
+    add_handler(0, &event_filters[0]);
+    send_encryption_change();
+    send_le_subevent(TEST_LE_SUBEVENT);
+    send_le_subevent(TEST_LE_SUBEVENT + 1);
+    CHECK_EQUAL(2, num_events[0]);
+}
+
+TEST(HCI_EVENT_DISPATCH, WithoutScanResults){
+    btstack_event_filter_init_without_scan_results(&event_filters[0]);
+    add_handler(0, &event_filters[0]);
+    add_handler(1, NULL);
+    send_advertising_report();
+    send_advertising_report();
+    CHECK_EQUAL(0, num_events[0]);
+    CHECK_EQUAL(2, num_events[1]);
+    send_encryption_change();
+    send_le_subevent(TEST_LE_SUBEVENT);
+    CHECK_EQUAL(2, num_events[0]);
+
+    uint8_t inquiry_result[] = { GAP_EVENT_INQUIRY_RESULT, 0 };
+    CHECK_EQUAL(false, btstack_event_filter_matches(&event_filters[0], inquiry_result, sizeof(inquiry_result)));
+    CHECK_EQUAL(true,  btstack_event_filter_matches(NULL, inquiry_result, sizeof(inquiry_result)));
+}
+
+TEST(HCI_EVENT_DISPATCH, RegistrationOrder){
+    add_handler(2, NULL);
+    add_handler(0, NULL);
+    add_handler(1, NULL);
+    send_encryption_change();
+    send_encryption_change();
+    CHECK_EQUAL(6, call_log_len);
+    int expected[] = { 2, 0, 1, 2, 0, 1 };
+    MEMCMP_EQUAL(expected, call_log, sizeof(expected));
+}
+
+static void add_handler_1_hook(int handler_index, uint8_t * packet){
+    if (handler_index != 0) return;
+    handler_hook = NULL;
+    add_handler(1, NULL);
+}
+
+TEST(HCI_EVENT_DISPATCH, HandlerAddedDuringDispatch){
+    add_handler(0, NULL);
+    // collect handlers for event
+    send_encryption_change();
+    handler_hook = &add_handler_1_hook;
+    send_encryption_change();
+    CHECK_EQUAL(2, num_events[0]);
+    CHECK_EQUAL(1, num_events[1]);
+    send_encryption_change();
+    CHECK_EQUAL(3, num_events[0]);
+    CHECK_EQUAL(2, num_events[1]);
+}
+
+static void nested_events_hook(int handler_index, uint8_t * packet){
+    if (handler_index != 0) return;
+    if (hci_event_packet_get_type(packet) != HCI_EVENT_ENCRYPTION_CHANGE) return;
+    handler_hook = NULL;
+    // replace all cache entries
+    int i;
+    for (i = 0; i <= HCI_EVENT_DISPATCH_CACHE_SIZE; i++){
+        send_le_subevent(TEST_LE_SUBEVENT + i);
+    }
+}
+
+TEST(HCI_EVENT_DISPATCH, NestedEvents){
+    add_handler(0, NULL);
+    btstack_event_filter_init(&event_filters[1]);
+    btstack_event_filter_add_event(&event_filters[1], HCI_EVENT_ENCRYPTION_CHANGE);
+    add_handler(1, &event_filters[1]);
+    handler_hook = &nested_events_hook;
+    send_encryption_change();
+    CHECK_EQUAL(1 + HCI_EVENT_DISPATCH_CACHE_SIZE + 1, num_events[0]);
+    CHECK_EQUAL(1, num_events[1]);
+}
+
+TEST(HCI_EVENT_DISPATCH, MoreHandlersThanCacheEntry){
+    int i;
+    for (i = 0; i < NUM_HANDLERS; i++){
+        callback_registrations[i].callback = &packet_handler_n;
+        hci_add_event_handler(&callback_registrations[i]);
+    }
+    send_encryption_change();
+    send_encryption_change();
+    CHECK_EQUAL(2 * NUM_HANDLERS, num_events[NUM_HANDLERS - 1]);
+}
+
+int main (int argc, const char * argv[]){
+    btstack_run_loop_init(&mock_run_loop);
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
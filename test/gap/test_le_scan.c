@@ -11,10 +11,15 @@
 
 #include "btstack_memory.h"
 #include "hci.h"
+#include "ble/att_dispatch.h"
 #include "ble/gatt_client.h"
+#include "ble/le_device_db.h"
+#include "ble/sm.h"
 #include "btstack_event.h"
 #include "hci_dump.h"
 #include "btstack_debug.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_base.h"
 
 typedef struct {
     uint8_t type;
@@ -131,6 +136,472 @@ TEST(GAP_LE, ScanStartParam){
     CHECK_HCI_COMMAND(&hci_le_set_scan_enable);
 }
 
+// mock run loop with simulated time
+
+static uint32_t mock_time_ms;
+
+static void mock_run_loop_init(void){
+    btstack_run_loop_base_init();
+}
+
+static void mock_run_loop_set_timer(btstack_timer_source_t * ts, uint32_t timeout_in_ms){
+    ts->timeout = mock_time_ms + timeout_in_ms;
+}
+
+static uint32_t mock_run_loop_get_time_ms(void){
+    return mock_time_ms;
+}
+
+static const btstack_run_loop_t mock_run_loop = {
+    &mock_run_loop_init,
+    &btstack_run_loop_base_add_data_source,
+    &btstack_run_loop_base_remove_data_source,
+    &btstack_run_loop_base_enable_data_source_callbacks,
+    &btstack_run_loop_base_disable_data_source_callbacks,
+    &mock_run_loop_set_timer,
+    &btstack_run_loop_base_add_timer,
+    &btstack_run_loop_base_remove_timer,
+    NULL,
+    NULL,
+    &mock_run_loop_get_time_ms,
+};
+
+static void mock_run_loop_setup(void){
+    // run loop can only be initialized once, reset timers instead
+    static int run_loop_initialized = 0;
+    if (run_loop_initialized == 0){
+        run_loop_initialized = 1;
+        btstack_run_loop_init(&mock_run_loop);
+    }
+    btstack_run_loop_base_init();
+}
+
+static void advance_time(uint32_t ms){
+    mock_time_ms += ms;
+    btstack_run_loop_base_process_timers(mock_time_ms);
+}
+
+// advertising reports received by application
+
+static btstack_packet_callback_registration_t hci_event_callback_registration;
+static int      num_advertising_reports;
+static int      num_batch_events;
+static int      num_batched_reports;
+static uint8_t  last_batch_event[HCI_EVENT_BUFFER_SIZE];
+
+static void scan_filter_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    if (packet_type != HCI_EVENT_PACKET) return;
+    switch (hci_event_packet_get_type(packet)){
+        case GAP_EVENT_ADVERTISING_REPORT:
+            num_advertising_reports++;
+            break;
+        case GAP_EVENT_ADVERTISING_REPORT_BATCH:
+            num_batch_events++;
+            num_batched_reports += gap_event_advertising_report_batch_get_num_reports(packet);
+            memcpy(last_batch_event, packet, size);
+            break;
+        default:
+            break;
+    }
+}
+
+// send HCI LE Advertising Report with num_reports reports from consecutive addresses
+static void send_advertising_reports(uint8_t num_reports, uint8_t event_type, uint8_t first_address, uint8_t data_length, uint8_t data_value, int8_t rssi){
+    uint8_t event[HCI_EVENT_BUFFER_SIZE];
+    uint16_t pos = 0;
+    event[pos++] = HCI_EVENT_LE_META;
+    pos++;
+    event[pos++] = HCI_SUBEVENT_LE_ADVERTISING_REPORT;
+    event[pos++] = num_reports;
+    uint8_t i;
+    for (i=0;i<num_reports;i++){
+        btstack_assert((pos + 10 + data_length) <= HCI_EVENT_BUFFER_SIZE);
+        event[pos++] = event_type;
+        event[pos++] = BD_ADDR_TYPE_LE_PUBLIC;
+        memset(&event[pos], 0x11, 6);
+        event[pos] = first_address + i;
+        pos += 6;
+        event[pos++] = data_length;
+        memset(&event[pos], data_value, data_length);
+        pos += data_length;
+        event[pos++] = (uint8_t) rssi;
+    }
+    event[1] = pos - 2;
+    packet_handler(HCI_EVENT_PACKET, event, pos);
+}
+
+TEST_GROUP(GAP_LE_SCAN_FILTER){
+    void setup(void){
+        transport_count_packets = 0;
+        mock_run_loop_setup();
+        hci_init(&hci_transport_test, NULL);
+        hci_simulate_working_fuzz();
+        hci_event_callback_registration.callback = &scan_filter_packet_handler;
+        hci_add_event_handler(&hci_event_callback_registration);
+        num_advertising_reports = 0;
+        num_batch_events = 0;
+        num_batched_reports = 0;
+        gap_start_scan();
+    }
+};
+
+TEST(GAP_LE_SCAN_FILTER, DeliverAllByDefault){
+    send_advertising_reports(1, 0, 1, 10, 0x55, -50);
+    send_advertising_reports(1, 0, 1, 10, 0x55, -50);
+    send_advertising_reports(3, 0, 1, 10, 0x55, -50);
+    CHECK_EQUAL(5, num_advertising_reports);
+}
+
+TEST(GAP_LE_SCAN_FILTER, DuplicateFilter){
+    gap_le_scan_filter_set_duplicate_filter(1, 0);
+    send_advertising_reports(1, 0, 1, 10, 0x55, -50);
+    send_advertising_reports(1, 0, 1, 10, 0x55, -60);
+    advance_time(10000);
+    send_advertising_reports(1, 0, 1, 10, 0x55, -50);
+    CHECK_EQUAL(1, num_advertising_reports);
+    // changed data
+    send_advertising_reports(1, 0, 1, 10, 0x66, -50);
+    CHECK_EQUAL(2, num_advertising_reports);
+    // scan response with same data
+    send_advertising_reports(1, 4, 1, 10, 0x66, -50);
+    CHECK_EQUAL(3, num_advertising_reports);
+    // other device
+    send_advertising_reports(1, 0, 2, 10, 0x66, -50);
+    CHECK_EQUAL(4, num_advertising_reports);
+    // cache is cleared on scan start
+    gap_start_scan();
+    send_advertising_reports(1, 0, 1, 10, 0x55, -50);
+    CHECK_EQUAL(5, num_advertising_reports);
+}
+
+TEST(GAP_LE_SCAN_FILTER, ReportInterval){
+    gap_le_scan_filter_set_duplicate_filter(1, 1000);
+    send_advertising_reports(1, 0, 1, 10, 0x55, -50);
+    advance_time(500);
+    send_advertising_reports(1, 0, 1, 10, 0x55, -50);
+    CHECK_EQUAL(1, num_advertising_reports);
+    advance_time(500);
+    send_advertising_reports(1, 0, 1, 10, 0x55, -50);
+    CHECK_EQUAL(2, num_advertising_reports);
+    advance_time(999);
+    send_advertising_reports(1, 0, 1, 10, 0x55, -50);
+    CHECK_EQUAL(2, num_advertising_reports);
+}
+
+TEST(GAP_LE_SCAN_FILTER, CacheEviction){
+    gap_le_scan_filter_set_duplicate_filter(1, 0);
+    int i;
+    for (i=0;i<(2*LE_SCAN_FILTER_CACHE_SIZE);i++){
+        send_advertising_reports(1, 0, i, 10, 0x55, -50);
+        advance_time(1);
+    }
+    CHECK_EQUAL(2*LE_SCAN_FILTER_CACHE_SIZE, num_advertising_reports);
+    // most recent device is still cached
+    send_advertising_reports(1, 0, (2*LE_SCAN_FILTER_CACHE_SIZE) - 1, 10, 0x55, -50);
+    CHECK_EQUAL(2*LE_SCAN_FILTER_CACHE_SIZE, num_advertising_reports);
+}
+
+TEST(GAP_LE_SCAN_FILTER, RssiThreshold){
+    gap_le_scan_filter_set_rssi_threshold(-60);
+    send_advertising_reports(1, 0, 1, 10, 0x55, -70);
+    CHECK_EQUAL(0, num_advertising_reports);
+    send_advertising_reports(1, 0, 1, 10, 0x55, -60);
+    send_advertising_reports(1, 0, 1, 10, 0x55, -50);
+    // rssi not available
+    send_advertising_reports(1, 0, 1, 10, 0x55, 127);
+    CHECK_EQUAL(3, num_advertising_reports);
+}
+
+TEST(GAP_LE_SCAN_FILTER, AdFilter){
+    ad_filter_t ad_filter;
+    ad_filter_init(&ad_filter);
+    ad_filter_add_uuid16(&ad_filter, 0, 0x0303);
+    gap_le_scan_filter_set_ad_filter(&ad_filter);
+    // data 03 03 03 03 = 16-bit Service UUID list with 0x0303
+    send_advertising_reports(1, 0, 1, 4, 0x03, -50);
+    send_advertising_reports(1, 0, 2, 10, 0x55, -50);
+    CHECK_EQUAL(1, num_advertising_reports);
+    gap_le_scan_filter_set_ad_filter(NULL);
+    send_advertising_reports(1, 0, 2, 10, 0x55, -50);
+    CHECK_EQUAL(2, num_advertising_reports);
+}
+
+TEST(GAP_LE_SCAN_FILTER, Batching){
+    gap_le_scan_filter_set_batching(100);
+    send_advertising_reports(3, 0, 1, 5, 0x55, -50);
+    advance_time(99);
+    CHECK_EQUAL(0, num_batch_events);
+    advance_time(1);
+    CHECK_EQUAL(0, num_advertising_reports);
+    CHECK_EQUAL(1, num_batch_events);
+    CHECK_EQUAL(3, num_batched_reports);
+
+    gap_advertising_report_iterator_t it;
+    uint8_t expected_address = 1;
+    for (gap_advertising_report_iterator_init(&it, last_batch_event); gap_advertising_report_iterator_has_more(&it); gap_advertising_report_iterator_next(&it)){
+        bd_addr_t address;
+        gap_advertising_report_iterator_get_address(&it, address);
+        CHECK_EQUAL(expected_address, address[5]);
+        CHECK_EQUAL(BD_ADDR_TYPE_LE_PUBLIC, gap_advertising_report_iterator_get_address_type(&it));
+        CHECK_EQUAL(0, gap_advertising_report_iterator_get_advertising_event_type(&it));
+        CHECK_EQUAL(-50, gap_advertising_report_iterator_get_rssi(&it));
+        CHECK_EQUAL(5, gap_advertising_report_iterator_get_data_length(&it));
+        CHECK_EQUAL(0x55, gap_advertising_report_iterator_get_data(&it)[4]);
+        expected_address++;
+    }
+    CHECK_EQUAL(4, expected_address);
+}
+
+TEST(GAP_LE_SCAN_FILTER, BatchFullAndStop){
+    gap_le_scan_filter_set_batching(1000);
+    // 41 bytes per report, 6 fit into a single event
+    send_advertising_reports(4, 0, 1, 31, 0x55, -50);
+    send_advertising_reports(4, 0, 5, 31, 0x55, -50);
+    CHECK_EQUAL(1, num_batch_events);
+    CHECK_EQUAL(6, num_batched_reports);
+    // stop scan delivers pending reports
+    gap_stop_scan();
+    CHECK_EQUAL(2, num_batch_events);
+    CHECK_EQUAL(8, num_batched_reports);
+    advance_time(1000);
+    CHECK_EQUAL(2, num_batch_events);
+}
+
+// LE Throughput Optimizer
+
+#define TEST_CON_HANDLE 0x0040
+
+static int      num_throughput_events;
+static uint8_t  last_throughput_event[HCI_EVENT_BUFFER_SIZE];
+static uint16_t mtu_exchange_max_tx_octets;
+
+static void throughput_optimizer_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    UNUSED(channel);
+    if (packet_type != HCI_EVENT_PACKET) return;
+    if (hci_event_packet_get_type(packet) != GAP_EVENT_LE_THROUGHPUT_OPTIMIZATION_COMPLETE) return;
+    num_throughput_events++;
+    memcpy(last_throughput_event, packet, size);
+}
+
+static void throughput_optimizer_mtu_exchange(hci_con_handle_t con_handle, uint16_t max_tx_octets){
+    mtu_exchange_max_tx_octets = max_tx_octets;
+    hci_le_throughput_optimizer_mtu_exchanged(con_handle, max_tx_octets - 4);
+}
+
+static void send_supported_commands(uint8_t set_data_length, uint8_t set_phy){
+    uint8_t event[70];
+    memset(event, 0, sizeof(event));
+    event[0] = HCI_EVENT_COMMAND_COMPLETE;
+    event[1] = sizeof(event) - 2;
+    event[2] = 1;
+    little_endian_store_16(event, 3, hci_read_local_supported_commands.opcode);
+    event[6 + 33] = set_data_length ? 0x40 : 0;
+    event[6 + 35] = set_phy ? 0x40 : 0;
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void send_le_connection_complete(void){
+    uint8_t event[] = { HCI_EVENT_LE_META, 19, HCI_SUBEVENT_LE_CONNECTION_COMPLETE, 0, 0, 0, HCI_ROLE_MASTER, 0,
+                        0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x18, 0, 0, 0, 0x48, 0, 0 };
+    little_endian_store_16(event, 4, TEST_CON_HANDLE);
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void send_set_data_length_complete(void){
+    uint8_t event[] = { HCI_EVENT_COMMAND_COMPLETE, 6, 1, 0, 0, 0, 0, 0 };
+    little_endian_store_16(event, 3, hci_le_set_data_length.opcode);
+    little_endian_store_16(event, 6, TEST_CON_HANDLE);
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void send_data_length_change(uint16_t max_octets, uint16_t max_time){
+    uint8_t event[13];
+    event[0] = HCI_EVENT_LE_META;
+    event[1] = sizeof(event) - 2;
+    event[2] = HCI_SUBEVENT_LE_DATA_LENGTH_CHANGE;
+    little_endian_store_16(event,  3, TEST_CON_HANDLE);
+    little_endian_store_16(event,  5, max_octets);
+    little_endian_store_16(event,  7, max_time);
+    little_endian_store_16(event,  9, max_octets);
+    little_endian_store_16(event, 11, max_time);
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void send_phy_update_complete(uint8_t status, uint8_t phy){
+    uint8_t event[] = { HCI_EVENT_LE_META, 6, HCI_SUBEVENT_LE_PHY_UPDATE_COMPLETE, status, 0, 0, phy, phy };
+    little_endian_store_16(event, 4, TEST_CON_HANDLE);
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void send_disconnection_complete(void){
+    uint8_t event[] = { HCI_EVENT_DISCONNECTION_COMPLETE, 4, 0, 0, 0, ERROR_CODE_REMOTE_USER_TERMINATED_CONNECTION };
+    little_endian_store_16(event, 3, TEST_CON_HANDLE);
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+// mock ATT bearer, SM and LE Device DB for GATT Client
+
+static btstack_packet_handler_t att_client_packet_handler;
+static uint8_t att_outgoing_buffer[64];
+static uint8_t att_last_request_opcode;
+
+void att_dispatch_register_client(btstack_packet_handler_t handler){
+    att_client_packet_handler = handler;
+}
+int att_dispatch_client_can_send_now(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return 1;
+}
+void att_dispatch_client_request_can_send_now_event(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+}
+void att_dispatch_client_mtu_exchanged(hci_con_handle_t con_handle, uint16_t new_mtu){
+    UNUSED(con_handle);
+    UNUSED(new_mtu);
+}
+int l2cap_reserve_packet_buffer(void){
+    return 1;
+}
+uint8_t * l2cap_get_outgoing_buffer(void){
+    return att_outgoing_buffer;
+}
+uint16_t l2cap_max_le_mtu(void){
+    return 247;
+}
+int l2cap_send_prepared_connectionless(hci_con_handle_t con_handle, uint16_t cid, uint16_t len){
+    UNUSED(con_handle);
+    UNUSED(cid);
+    UNUSED(len);
+    att_last_request_opcode = att_outgoing_buffer[0];
+    return 0;
+}
+void sm_add_event_handler(btstack_packet_callback_registration_t * callback_handler){
+    UNUSED(callback_handler);
+}
+int sm_cmac_ready(void){
+    return 1;
+}
+void sm_cmac_signed_write_start(const sm_key_t key, uint8_t opcode, uint16_t attribute_handle, uint16_t message_len, const uint8_t * message, uint32_t sign_counter, void (*done_callback)(uint8_t * hash)){
+}
+irk_lookup_state_t sm_identity_resolving_state(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return IRK_LOOKUP_SUCCEEDED;
+}
+int sm_le_device_index(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return -1;
+}
+void le_device_db_local_csrk_get(int index, sm_key_t csrk){
+    UNUSED(index);
+    memset(csrk, 0, 16);
+}
+uint32_t le_device_db_local_counter_get(int index){
+    UNUSED(index);
+    return 0;
+}
+void le_device_db_local_counter_set(int index, uint32_t counter){
+    UNUSED(index);
+    UNUSED(counter);
+}
+int gap_reconnect_security_setup_active(hci_con_handle_t con_handle){
+    UNUSED(con_handle);
+    return 0;
+}
+
+static uint16_t last_hci_command_opcode(void){
+    return little_endian_read_16(transport_packets[transport_count_packets - 1].buffer, 0);
+}
+
+TEST_GROUP(GAP_LE_THROUGHPUT_OPTIMIZER){
+    void setup(void){
+        transport_count_packets = 0;
+        mock_run_loop_setup();
+        hci_init(&hci_transport_test, NULL);
+        hci_simulate_working_fuzz();
+        hci_event_callback_registration.callback = &throughput_optimizer_packet_handler;
+        hci_add_event_handler(&hci_event_callback_registration);
+        num_throughput_events = 0;
+        mtu_exchange_max_tx_octets = 0;
+        att_last_request_opcode = 0;
+    }
+    void teardown(void){
+        hci_free_connections_fuzz();
+    }
+};
+
+TEST(GAP_LE_THROUGHPUT_OPTIMIZER, DisabledByDefault){
+    send_supported_commands(1, 1);
+    send_le_connection_complete();
+    CHECK_EQUAL(0, transport_count_packets);
+    CHECK_EQUAL(0, num_throughput_events);
+}
+
+TEST(GAP_LE_THROUGHPUT_OPTIMIZER, DataLengthPhyMtu){
+    hci_le_throughput_optimizer_register_mtu_exchange_handler(&throughput_optimizer_mtu_exchange);
+    gap_le_throughput_optimizer_enable(true);
+    send_supported_commands(1, 1);
+    send_le_connection_complete();
+    CHECK_EQUAL(hci_le_set_data_length.opcode, last_hci_command_opcode());
+    send_set_data_length_complete();
+    CHECK_EQUAL(hci_le_set_phy.opcode, last_hci_command_opcode());
+    send_data_length_change(251, 2120);
+    CHECK_EQUAL(0, num_throughput_events);
+    send_phy_update_complete(ERROR_CODE_SUCCESS, 2);
+    CHECK_EQUAL(251, mtu_exchange_max_tx_octets);
+    CHECK_EQUAL(1, num_throughput_events);
+    CHECK_EQUAL(TEST_CON_HANDLE, gap_event_le_throughput_optimization_complete_get_con_handle(last_throughput_event));
+    CHECK_EQUAL(251,  gap_event_le_throughput_optimization_complete_get_max_tx_octets(last_throughput_event));
+    CHECK_EQUAL(2120, gap_event_le_throughput_optimization_complete_get_max_tx_time(last_throughput_event));
+    CHECK_EQUAL(251,  gap_event_le_throughput_optimization_complete_get_max_rx_octets(last_throughput_event));
+    CHECK_EQUAL(2, gap_event_le_throughput_optimization_complete_get_tx_phy(last_throughput_event));
+    CHECK_EQUAL(2, gap_event_le_throughput_optimization_complete_get_rx_phy(last_throughput_event));
+    CHECK_EQUAL(247, gap_event_le_throughput_optimization_complete_get_att_mtu(last_throughput_event));
+}
+
+TEST(GAP_LE_THROUGHPUT_OPTIMIZER, PhyNotSupportedByRemote){
+    gap_le_throughput_optimizer_enable(true);
+    send_supported_commands(1, 1);
+    send_le_connection_complete();
+    send_set_data_length_complete();
+    send_phy_update_complete(ERROR_CODE_UNSUPPORTED_REMOTE_FEATURE_UNSUPPORTED_LMP_FEATURE, 0);
+    CHECK_EQUAL(1, num_throughput_events);
+    CHECK_EQUAL(27, gap_event_le_throughput_optimization_complete_get_max_tx_octets(last_throughput_event));
+    CHECK_EQUAL(1, gap_event_le_throughput_optimization_complete_get_tx_phy(last_throughput_event));
+    CHECK_EQUAL(ATT_DEFAULT_MTU, gap_event_le_throughput_optimization_complete_get_att_mtu(last_throughput_event));
+}
+
+TEST(GAP_LE_THROUGHPUT_OPTIMIZER, CommandsNotSupported){
+    send_supported_commands(0, 0);
+    send_le_connection_complete();
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, gap_le_throughput_optimizer_start(TEST_CON_HANDLE));
+    CHECK_EQUAL(0, transport_count_packets);
+    CHECK_EQUAL(1, num_throughput_events);
+    CHECK_EQUAL(ERROR_CODE_UNKNOWN_CONNECTION_IDENTIFIER, gap_le_throughput_optimizer_start(TEST_CON_HANDLE + 1));
+}
+
+TEST(GAP_LE_THROUGHPUT_OPTIMIZER, MtuExchangeRejected){
+    gatt_client_init();
+    gap_le_throughput_optimizer_enable(true);
+    send_supported_commands(1, 1);
+    send_le_connection_complete();
+    send_set_data_length_complete();
+    send_data_length_change(251, 2120);
+    send_phy_update_complete(ERROR_CODE_SUCCESS, 2);
+    CHECK_EQUAL(ATT_EXCHANGE_MTU_REQUEST, att_last_request_opcode);
+    CHECK_EQUAL(0, num_throughput_events);
+    // remote rejects MTU Exchange Request, default MTU is used
+    uint8_t error_response[] = { ATT_ERROR_RESPONSE, ATT_EXCHANGE_MTU_REQUEST, 0, 0, ATT_ERROR_REQUEST_NOT_SUPPORTED };
+    (*att_client_packet_handler)(ATT_DATA_PACKET, TEST_CON_HANDLE, error_response, sizeof(error_response));
+    CHECK_EQUAL(1, num_throughput_events);
+    CHECK_EQUAL(251, gap_event_le_throughput_optimization_complete_get_max_tx_octets(last_throughput_event));
+    CHECK_EQUAL(2, gap_event_le_throughput_optimization_complete_get_tx_phy(last_throughput_event));
+    CHECK_EQUAL(ATT_DEFAULT_MTU, gap_event_le_throughput_optimization_complete_get_att_mtu(last_throughput_event));
+    // optimizer is done and can be started again
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, gap_le_throughput_optimizer_start(TEST_CON_HANDLE));
+    send_disconnection_complete();
+}
+
 int main (int argc, const char * argv[]){
     const char * log_path = "/tmp/test_scan.pklg";
     printf("Log: %s\n", log_path);
@@ -0,0 +1,772 @@
+// *****************************************************************************
+//
+// test H5 transport sliding window over simulated lossy link and SLIP encoder/decoder
+//
+// *****************************************************************************
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include "btstack_debug.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_base.h"
+#include "btstack_slip.h"
+#include "btstack_uart_block.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_transport.h"
+
+#define LINK_ACKNOWLEDGEMENT_TYPE 0x00
+#define LINK_CONTROL_PACKET_TYPE  0x0f
+
+#define SLIP_SOF 0xc0
+
+// mock run loop with simulated time
+
+static uint32_t mock_time_ms;
+
+static void mock_run_loop_init(void){
+    btstack_run_loop_base_init();
+}
+
+static void mock_run_loop_set_timer(btstack_timer_source_t * ts, uint32_t timeout_in_ms){
+    ts->timeout = mock_time_ms + timeout_in_ms;
+}
+
+static uint32_t mock_run_loop_get_time_ms(void){
+    return mock_time_ms;
+}
+
+static const btstack_run_loop_t mock_run_loop = {
+    &mock_run_loop_init,
+    &btstack_run_loop_base_add_data_source,
+    &btstack_run_loop_base_remove_data_source,
+    &btstack_run_loop_base_enable_data_source_callbacks,
+    &btstack_run_loop_base_disable_data_source_callbacks,
+    &mock_run_loop_set_timer,
+    &btstack_run_loop_base_add_timer,
+    &btstack_run_loop_base_remove_timer,
+    NULL,
+    NULL,
+    &mock_run_loop_get_time_ms,
+};
+
+// mock UART connected to simulated controller
+
+static void (*uart_block_received)(void);
+static void (*uart_block_sent)(void);
+static void (*uart_data_received)(const uint8_t * data, uint16_t size);
+static uint8_t * uart_rx_buffer;
+static int       uart_send_pending;
+
+// bytes from controller to host
+static uint8_t  uart_rx_fifo[20000];
+static uint16_t uart_rx_fifo_read;
+static uint16_t uart_rx_fifo_write;
+
+static void controller_process_byte(uint8_t data);
+
+static int mock_uart_init(const btstack_uart_config_t * config){
+    UNUSED(config);
+    return 0;
+}
+
+static int mock_uart_open(void){
+    return 0;
+}
+
+static int mock_uart_close(void){
+    return 0;
+}
+
+static void mock_uart_set_block_received(void (*handler)(void)){
+    uart_block_received = handler;
+}
+
+static void mock_uart_set_block_sent(void (*handler)(void)){
+    uart_block_sent = handler;
+}
+
+static int mock_uart_set_baudrate(uint32_t baudrate){
+    UNUSED(baudrate);
+    return 0;
+}
+
+static int mock_uart_set_parity(int parity){
+    UNUSED(parity);
+    return 0;
+}
+
+static void mock_uart_receive_block(uint8_t * buffer, uint16_t len){
+    CHECK_EQUAL(1, len);
+    uart_rx_buffer = buffer;
+}
+
+static void mock_uart_set_data_received(void (*handler)(const uint8_t * data, uint16_t size)){
+    uart_data_received = handler;
+}
+
+static void mock_uart_send_block(const uint8_t * buffer, uint16_t length){
+    CHECK_EQUAL(0, uart_send_pending);
+    uint16_t i;
+    for (i=0;i<length;i++){
+        controller_process_byte(buffer[i]);
+    }
+    uart_send_pending = 1;
+}
+
+static const btstack_uart_block_t mock_uart = {
+    &mock_uart_init,
+    &mock_uart_open,
+    &mock_uart_close,
+    &mock_uart_set_block_received,
+    &mock_uart_set_block_sent,
+    &mock_uart_set_baudrate,
+    &mock_uart_set_parity,
+    NULL,
+    &mock_uart_receive_block,
+    &mock_uart_send_block,
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+};
+
+// mock UART in streaming mode
+static const btstack_uart_block_t mock_uart_streaming = {
+    &mock_uart_init,
+    &mock_uart_open,
+    &mock_uart_close,
+    &mock_uart_set_block_received,
+    &mock_uart_set_block_sent,
+    &mock_uart_set_baudrate,
+    &mock_uart_set_parity,
+    NULL,
+    &mock_uart_receive_block,
+    &mock_uart_send_block,
+    NULL,
+    NULL,
+    NULL,
+    &mock_uart_set_data_received,
+};
+
+// simulated controller
+
+// link config of controller, default: sliding window 7, data integrity check
+static uint8_t  controller_config;
+// drop or corrupt frames in percent
+static uint8_t  controller_loss_percent;
+static uint8_t  controller_corrupt_percent;
+// if set, controller doesn't acknowledge reliable packets
+static int      controller_manual_ack;
+static uint32_t controller_random;
+
+static uint8_t  controller_frame[2000];
+static uint16_t controller_frame_len;
+static int      controller_frame_escape;
+
+static uint8_t  controller_ack_nr;
+static uint8_t  controller_last_ack_nr_received;
+static uint32_t controller_num_reliable_frames;
+
+// received reliable packets, in order
+static uint8_t  controller_received[200000];
+static uint32_t controller_received_len;
+static uint16_t controller_num_received;
+
+static int controller_random_percent(uint8_t percent){
+    controller_random = controller_random * 1103515245u + 12345u;
+    return ((controller_random >> 16) % 100) < percent;
+}
+
+static uint16_t controller_crc16(const uint8_t * data, uint16_t len, uint16_t crc){
+    uint16_t i;
+    for (i=0;i<len;i++){
+        crc ^= data[i];
+        int j;
+        for (j=0;j<8;j++){
+            crc = (crc & 1) ? ((crc >> 1) ^ 0x8408) : (crc >> 1);
+        }
+    }
+    return crc;
+}
+
+static uint16_t controller_calc_dic(const uint8_t * frame, uint16_t len){
+    uint16_t crc = controller_crc16(frame, len, 0xffff);
+    uint16_t reverse = 0;
+    int i;
+    for (i=0;i<16;i++){
+        reverse = (reverse << 1) | (crc & 1);
+        crc >>= 1;
+    }
+    return reverse;
+}
+
+static void controller_send_byte(uint8_t data){
+    CHECK(uart_rx_fifo_write < sizeof(uart_rx_fifo));
+    uart_rx_fifo[uart_rx_fifo_write++] = data;
+}
+
+static void controller_send_frame_unreliable(uint8_t seq_nr, uint8_t reliable, uint8_t packet_type, const uint8_t * payload, uint16_t len){
+    if (controller_random_percent(controller_loss_percent)) return;
+
+    uint8_t frame[300];
+    frame[0] = seq_nr | (controller_ack_nr << 3) | (reliable << 7);
+    frame[1] = packet_type | ((len & 0x0f) << 4);
+    frame[2] = len >> 4;
+    frame[3] = 0xff - (frame[0] + frame[1] + frame[2]);
+    if (len > 0){
+        memcpy(&frame[4], payload, len);
+    }
+    uint16_t frame_len = 4 + len;
+    if (controller_random_percent(controller_corrupt_percent)){
+        frame[controller_random % frame_len] ^= 0x10;
+    }
+
+    controller_send_byte(SLIP_SOF);
+    uint16_t i;
+    for (i=0;i<frame_len;i++){
+        switch (frame[i]){
+            case 0xc0:
+                controller_send_byte(0xdb);
+                controller_send_byte(0xdc);
+                break;
+            case 0xdb:
+                controller_send_byte(0xdb);
+                controller_send_byte(0xdd);
+                break;
+            default:
+                controller_send_byte(frame[i]);
+                break;
+        }
+    }
+    controller_send_byte(SLIP_SOF);
+}
+
+static void controller_send_control(const uint8_t * message, uint16_t len){
+    controller_send_frame_unreliable(0, 0, LINK_CONTROL_PACKET_TYPE, message, len);
+}
+
+static void controller_send_ack(void){
+    controller_send_frame_unreliable(0, 0, LINK_ACKNOWLEDGEMENT_TYPE, NULL, 0);
+}
+
+static void controller_send_reliable(uint8_t seq_nr, uint8_t packet_type, const uint8_t * payload, uint16_t len){
+    controller_send_frame_unreliable(seq_nr, 1, packet_type, payload, len);
+}
+
+static void controller_process_frame(void){
+    if (controller_frame_len < 4) return;
+
+    // simulate loss and corruption in host -> controller direction
+    if (controller_random_percent(controller_loss_percent)) return;
+    if (controller_random_percent(controller_corrupt_percent)){
+        controller_frame[controller_random % controller_frame_len] ^= 0x01;
+    }
+
+    uint8_t * header = controller_frame;
+    uint8_t  header_checksum = header[0] + header[1] + header[2] + header[3];
+    if (header_checksum != 0xff) return;
+
+    uint8_t  seq_nr   = header[0] & 0x07;
+    uint8_t  ack_nr   = (header[0] >> 3) & 0x07;
+    uint8_t  dic      = (header[0] & 0x40) != 0;
+    uint8_t  reliable = (header[0] & 0x80) != 0;
+    uint8_t  packet_type = header[1] & 0x0f;
+    uint16_t payload_len = (header[1] >> 4) | (header[2] << 4);
+    uint8_t * payload = &controller_frame[4];
+
+    if ((uint16_t)(4 + payload_len + (dic ? 2 : 0)) != controller_frame_len) return;
+    if (dic){
+        uint16_t dic_received = big_endian_read_16(controller_frame, 4 + payload_len);
+        if (dic_received != controller_calc_dic(controller_frame, 4 + payload_len)) return;
+    }
+
+    if (packet_type == LINK_CONTROL_PACKET_TYPE){
+        static const uint8_t sync[]            = { 0x01, 0x7e };
+        static const uint8_t sync_response[]   = { 0x02, 0x7d };
+        static const uint8_t config_prefix[]   = { 0x03, 0xfc };
+        if ((payload_len == 2) && (memcmp(payload, sync, 2) == 0)){
+            controller_send_control(sync_response, sizeof(sync_response));
+            return;
+        }
+        if ((payload_len >= 2) && (memcmp(payload, config_prefix, 2) == 0)){
+            uint8_t config_response[] = { 0x04, 0x7b, controller_config };
+            controller_send_control(config_response, sizeof(config_response));
+            return;
+        }
+        return;
+    }
+
+    if (reliable || (packet_type == LINK_ACKNOWLEDGEMENT_TYPE)){
+        controller_last_ack_nr_received = ack_nr;
+    }
+
+    if (!reliable) return;
+    controller_num_reliable_frames++;
+
+    // accept in-order packets only
+    if (seq_nr == controller_ack_nr){
+        controller_ack_nr = (controller_ack_nr + 1) & 0x07;
+        CHECK(controller_received_len + payload_len <= sizeof(controller_received));
+        memcpy(&controller_received[controller_received_len], payload, payload_len);
+        controller_received_len += payload_len;
+        controller_num_received++;
+    }
+    if (!controller_manual_ack){
+        controller_send_ack();
+    }
+}
+
+static void controller_process_byte(uint8_t data){
+    if (data == SLIP_SOF){
+        controller_process_frame();
+        controller_frame_len = 0;
+        controller_frame_escape = 0;
+        return;
+    }
+    if (controller_frame_escape){
+        controller_frame_escape = 0;
+        switch (data){
+            case 0xdc:
+                data = 0xc0;
+                break;
+            case 0xdd:
+                data = 0xdb;
+                break;
+            default:
+                break;
+        }
+    } else if (data == 0xdb){
+        controller_frame_escape = 1;
+        return;
+    }
+    if (controller_frame_len < sizeof(controller_frame)){
+        controller_frame[controller_frame_len++] = data;
+    }
+}
+
+// host stack
+
+static const hci_transport_t * transport;
+static hci_transport_config_uart_t config = {
+    HCI_TRANSPORT_CONFIG_UART,
+    115200,
+    0,  // main baudrate
+    0,  // flow control
+    NULL,
+};
+
+static uint16_t host_num_packet_sent_events;
+static uint8_t  host_received[2000];
+static uint16_t host_received_len;
+static uint16_t host_num_received;
+
+static void host_packet_handler(uint8_t packet_type, uint8_t *packet, uint16_t size){
+    switch (packet_type){
+        case HCI_EVENT_PACKET:
+            if (packet[0] == HCI_EVENT_TRANSPORT_PACKET_SENT){
+                host_num_packet_sent_events++;
+                break;
+            }
+            /* fall through */
+        case HCI_ACL_DATA_PACKET:
+            memcpy(&host_received[host_received_len], packet, size);
+            host_received_len += size;
+            host_num_received++;
+            break;
+        default:
+            break;
+    }
+}
+
+// deliver pending UART callbacks until idle
+static void run_until_idle(void){
+    while (true){
+        if (uart_send_pending){
+            uart_send_pending = 0;
+            (*uart_block_sent)();
+            continue;
+        }
+        if ((uart_rx_buffer != NULL) && (uart_rx_fifo_read < uart_rx_fifo_write)){
+            uint8_t * buffer = uart_rx_buffer;
+            uart_rx_buffer = NULL;
+            *buffer = uart_rx_fifo[uart_rx_fifo_read++];
+            (*uart_block_received)();
+            continue;
+        }
+        if ((uart_data_received != NULL) && (uart_rx_fifo_read < uart_rx_fifo_write)){
+            // deliver chunks of varying size
+            uint16_t size = btstack_min(uart_rx_fifo_write - uart_rx_fifo_read, 1 + (uart_rx_fifo_read * 7) % 61);
+            const uint8_t * data = &uart_rx_fifo[uart_rx_fifo_read];
+            uart_rx_fifo_read += size;
+            (*uart_data_received)(data, size);
+            continue;
+        }
+        break;
+    }
+    if (uart_rx_fifo_read == uart_rx_fifo_write){
+        uart_rx_fifo_read  = 0;
+        uart_rx_fifo_write = 0;
+    }
+}
+
+static void advance_time(uint32_t ms){
+    mock_time_ms += ms;
+    btstack_run_loop_base_process_timers(mock_time_ms);
+    run_until_idle();
+}
+
+static void host_open(void){
+    transport->init(&config);
+    transport->register_packet_handler(&host_packet_handler);
+    CHECK_EQUAL(0, transport->open());
+    run_until_idle();
+    // wait for link establishment
+    int i;
+    for (i=0;i<100;i++){
+        if (transport->can_send_packet_now(HCI_ACL_DATA_PACKET)) break;
+        advance_time(50);
+    }
+    CHECK_EQUAL(1, transport->can_send_packet_now(HCI_ACL_DATA_PACKET));
+}
+
+static uint16_t host_prepare_acl_packet(uint8_t * packet, uint16_t packet_nr){
+    uint16_t payload_len = 1 + (packet_nr * 37) % 200;
+    little_endian_store_16(packet, 0, 0x2001);
+    little_endian_store_16(packet, 2, payload_len);
+    uint16_t i;
+    for (i=0;i<payload_len;i++){
+        packet[4+i] = (uint8_t)(packet_nr + i);
+    }
+    return 4 + payload_len;
+}
+
+static void host_send_acl_packet(uint16_t packet_nr){
+    static uint8_t packet[HCI_ACL_HEADER_SIZE + 256];
+    uint16_t len = host_prepare_acl_packet(packet, packet_nr);
+    CHECK_EQUAL(0, transport->send_packet(HCI_ACL_DATA_PACKET, packet, len));
+    // hci re-uses its packet buffer as soon as send_packet returns
+    memset(packet, 0x55, sizeof(packet));
+    run_until_idle();
+}
+
+static void controller_verify_acl_packets(uint16_t num_packets){
+    CHECK_EQUAL(num_packets, controller_num_received);
+    uint8_t  packet[HCI_ACL_HEADER_SIZE + 256];
+    uint32_t pos = 0;
+    uint16_t packet_nr;
+    for (packet_nr=0;packet_nr<num_packets;packet_nr++){
+        uint16_t len = host_prepare_acl_packet(packet, packet_nr);
+        MEMCMP_EQUAL(packet, &controller_received[pos], len);
+        pos += len;
+    }
+    CHECK_EQUAL(pos, controller_received_len);
+}
+
+static void test_setup(const btstack_uart_block_t * uart){
+    mock_time_ms = 0;
+    uart_rx_buffer = NULL;
+    uart_send_pending = 0;
+    uart_rx_fifo_read  = 0;
+    uart_rx_fifo_write = 0;
+    controller_config = 0x17;
+    controller_loss_percent = 0;
+    controller_corrupt_percent = 0;
+    controller_manual_ack = 0;
+    controller_random = 0x12345678;
+    controller_frame_len = 0;
+    controller_frame_escape = 0;
+    controller_ack_nr = 0;
+    controller_last_ack_nr_received = 0;
+    controller_num_reliable_frames = 0;
+    controller_received_len = 0;
+    controller_num_received = 0;
+    host_num_packet_sent_events = 0;
+    host_received_len = 0;
+    host_num_received = 0;
+    // run loop can only be initialized once, reset timers instead
+    static int run_loop_initialized = 0;
+    if (run_loop_initialized == 0){
+        run_loop_initialized = 1;
+        btstack_run_loop_init(&mock_run_loop);
+    }
+    btstack_run_loop_base_init();
+    transport = hci_transport_h5_instance(uart);
+}
+
+TEST_GROUP(H5){
+    void setup(void){
+        test_setup(&mock_uart);
+    }
+    void teardown(void){
+        transport->close();
+    }
+};
+
+TEST(H5, SlidingWindowNegotiated){
+    host_open();
+    controller_manual_ack = 1;
+    int i;
+    for (i=0;i<HCI_TRANSPORT_H5_SLIDING_WINDOW_SIZE;i++){
+        CHECK_EQUAL(1, transport->can_send_packet_now(HCI_ACL_DATA_PACKET));
+        host_send_acl_packet(i);
+    }
+    CHECK_EQUAL(0, transport->can_send_packet_now(HCI_ACL_DATA_PACKET));
+    controller_verify_acl_packets(HCI_TRANSPORT_H5_SLIDING_WINDOW_SIZE);
+}
+
+TEST(H5, SlidingWindowOfController){
+    // controller only supports sliding window of 2
+    controller_config = 0x12;
+    host_open();
+    controller_manual_ack = 1;
+    host_send_acl_packet(0);
+    CHECK_EQUAL(1, transport->can_send_packet_now(HCI_ACL_DATA_PACKET));
+    host_send_acl_packet(1);
+    CHECK_EQUAL(0, transport->can_send_packet_now(HCI_ACL_DATA_PACKET));
+}
+
+TEST(H5, CumulativeAck){
+    host_open();
+    controller_manual_ack = 1;
+    int i;
+    for (i=0;i<HCI_TRANSPORT_H5_SLIDING_WINDOW_SIZE;i++){
+        host_send_acl_packet(i);
+    }
+    CHECK_EQUAL(0, transport->can_send_packet_now(HCI_ACL_DATA_PACKET));
+    uint16_t num_events = host_num_packet_sent_events;
+
+    // single ack for all packets
+    controller_send_ack();
+    run_until_idle();
+    CHECK(host_num_packet_sent_events > num_events);
+    for (i=0;i<HCI_TRANSPORT_H5_SLIDING_WINDOW_SIZE;i++){
+        CHECK_EQUAL(1, transport->can_send_packet_now(HCI_ACL_DATA_PACKET));
+        host_send_acl_packet(HCI_TRANSPORT_H5_SLIDING_WINDOW_SIZE + i);
+    }
+    CHECK_EQUAL(0, transport->can_send_packet_now(HCI_ACL_DATA_PACKET));
+
+    // no retransmission for acknowledged packets
+    advance_time(1000);
+    controller_verify_acl_packets(2 * HCI_TRANSPORT_H5_SLIDING_WINDOW_SIZE);
+    CHECK_EQUAL(1, controller_num_reliable_frames > 2 * HCI_TRANSPORT_H5_SLIDING_WINDOW_SIZE);
+}
+
+TEST(H5, RetransmitAfterLoss){
+    host_open();
+    // lose all packets but the first one
+    controller_manual_ack = 1;
+    controller_loss_percent = 100;
+    host_send_acl_packet(0);
+    controller_loss_percent = 0;
+    controller_verify_acl_packets(0);
+    int i;
+    for (i=1;i<HCI_TRANSPORT_H5_SLIDING_WINDOW_SIZE;i++){
+        host_send_acl_packet(i);
+    }
+    // out of sequence packets are dropped
+    controller_verify_acl_packets(0);
+
+    // go back and resend all unacknowledged packets after timeout
+    controller_manual_ack = 0;
+    advance_time(1000);
+    controller_verify_acl_packets(HCI_TRANSPORT_H5_SLIDING_WINDOW_SIZE);
+    CHECK_EQUAL(1, transport->can_send_packet_now(HCI_ACL_DATA_PACKET));
+}
+
+TEST(H5, ReceiveOutOfOrder){
+    host_open();
+    const uint8_t event_0[] = { 0xff, 0x01, 0x00 };
+    const uint8_t event_1[] = { 0xff, 0x01, 0x01 };
+
+    // out of order, dropped and acknowledged with expected sequence nr
+    controller_send_reliable(1, HCI_EVENT_PACKET, event_1, sizeof(event_1));
+    run_until_idle();
+    CHECK_EQUAL(0, host_num_received);
+    CHECK_EQUAL(0, controller_last_ack_nr_received);
+
+    controller_send_reliable(0, HCI_EVENT_PACKET, event_0, sizeof(event_0));
+    controller_send_reliable(1, HCI_EVENT_PACKET, event_1, sizeof(event_1));
+    run_until_idle();
+    CHECK_EQUAL(2, host_num_received);
+    MEMCMP_EQUAL(event_0, &host_received[0], sizeof(event_0));
+    MEMCMP_EQUAL(event_1, &host_received[3], sizeof(event_1));
+    CHECK_EQUAL(2, controller_last_ack_nr_received);
+}
+
+TEST(H5, LossyLink){
+    host_open();
+    controller_loss_percent    = 10;
+    controller_corrupt_percent = 5;
+    const uint16_t num_packets = 500;
+    uint16_t packet_nr = 0;
+    uint32_t time_ms;
+    for (time_ms = 0; time_ms < 600000; time_ms += 10){
+        while ((packet_nr < num_packets) && transport->can_send_packet_now(HCI_ACL_DATA_PACKET)){
+            host_send_acl_packet(packet_nr++);
+        }
+        if ((packet_nr == num_packets) && (controller_num_received == num_packets)) break;
+        advance_time(10);
+    }
+    controller_verify_acl_packets(num_packets);
+}
+
+TEST_GROUP(H5Streaming){
+    void setup(void){
+        test_setup(&mock_uart_streaming);
+    }
+    void teardown(void){
+        transport->close();
+        CHECK(uart_data_received == NULL);
+    }
+};
+
+TEST(H5Streaming, ReceiveOutOfOrder){
+    host_open();
+    // receive_block not used in streaming mode
+    CHECK(uart_rx_buffer == NULL);
+    const uint8_t event_0[] = { 0xff, 0x02, 0xc0, 0xdb };
+    const uint8_t event_1[] = { 0xff, 0x01, 0x01 };
+
+    controller_send_reliable(1, HCI_EVENT_PACKET, event_1, sizeof(event_1));
+    controller_send_reliable(0, HCI_EVENT_PACKET, event_0, sizeof(event_0));
+    controller_send_reliable(1, HCI_EVENT_PACKET, event_1, sizeof(event_1));
+    run_until_idle();
+    CHECK_EQUAL(2, host_num_received);
+    MEMCMP_EQUAL(event_0, &host_received[0], sizeof(event_0));
+    MEMCMP_EQUAL(event_1, &host_received[4], sizeof(event_1));
+    CHECK_EQUAL(2, controller_last_ack_nr_received);
+}
+
+TEST(H5Streaming, LossyLink){
+    host_open();
+    controller_loss_percent    = 10;
+    controller_corrupt_percent = 5;
+    const uint16_t num_packets = 500;
+    uint16_t packet_nr = 0;
+    uint32_t time_ms;
+    for (time_ms = 0; time_ms < 600000; time_ms += 10){
+        while ((packet_nr < num_packets) && transport->can_send_packet_now(HCI_ACL_DATA_PACKET)){
+            host_send_acl_packet(packet_nr++);
+        }
+        if ((packet_nr == num_packets) && (controller_num_received == num_packets)) break;
+        advance_time(10);
+    }
+    controller_verify_acl_packets(num_packets);
+}
+
+// SLIP encoder/decoder
+
+static uint16_t slip_prepare_data(uint8_t * data, uint16_t len, uint32_t seed){
+    uint16_t i;
+    for (i=0;i<len;i++){
+        seed = seed * 1103515245u + 12345u;
+        // mostly plain data with some SOF and ESC
+        switch ((seed >> 16) % 16){
+            case 0:
+                data[i] = 0xc0;
+                break;
+            case 1:
+                data[i] = 0xdb;
+                break;
+            default:
+                data[i] = (uint8_t)(seed >> 8);
+                break;
+        }
+    }
+    return len;
+}
+
+TEST_GROUP(SLIP){
+};
+
+TEST(SLIP, EncodeMatchesByteEncoder){
+    uint8_t data[300];
+    uint8_t encoded_bytes[600];
+    uint8_t encoded_block[600];
+    uint16_t len;
+    for (len = 0; len < sizeof(data); len += 13){
+        slip_prepare_data(data, len, len);
+        uint16_t bytes_len = 0;
+        btstack_slip_encoder_start(data, len);
+        while (btstack_slip_encoder_has_data()){
+            encoded_bytes[bytes_len++] = btstack_slip_encoder_get_byte();
+        }
+        // encode into chunks of varying size, escape sequences may be split
+        uint16_t chunk_size;
+        for (chunk_size = 1; chunk_size < 20; chunk_size++){
+            btstack_slip_encoder_t encoder;
+            btstack_slip_encoder_instance_start(&encoder, data, len);
+            uint16_t block_len = 0;
+            while (btstack_slip_encoder_instance_has_data(&encoder)){
+                block_len += btstack_slip_encoder_instance_encode(&encoder, &encoded_block[block_len], chunk_size);
+            }
+            CHECK_EQUAL(bytes_len, block_len);
+            MEMCMP_EQUAL(encoded_bytes, encoded_block, bytes_len);
+        }
+    }
+}
+
+TEST(SLIP, DecodeChunks){
+    uint8_t data[2][200];
+    uint8_t stream[1000];
+    uint8_t decoded[200];
+    uint16_t stream_len = 0;
+    int i;
+    // garbage, two frames with repeated SOF
+    stream[stream_len++] = 0x12;
+    for (i=0;i<2;i++){
+        slip_prepare_data(data[i], sizeof(data[i]), 1 + i);
+        stream[stream_len++] = BTSTACK_SLIP_SOF;
+        stream[stream_len++] = BTSTACK_SLIP_SOF;
+        btstack_slip_encoder_t encoder;
+        btstack_slip_encoder_instance_start(&encoder, data[i], sizeof(data[i]));
+        stream_len += btstack_slip_encoder_instance_encode(&encoder, &stream[stream_len], sizeof(stream) - stream_len - 1);
+        stream[stream_len++] = BTSTACK_SLIP_SOF;
+    }
+    uint16_t chunk_size;
+    for (chunk_size = 1; chunk_size < sizeof(stream); chunk_size += 7){
+        btstack_slip_decoder_t decoder;
+        btstack_slip_decoder_instance_init(&decoder, decoded, sizeof(decoded));
+        int num_frames = 0;
+        uint16_t pos = 0;
+        while (pos < stream_len){
+            uint16_t size = btstack_min(chunk_size, stream_len - pos);
+            while (size > 0){
+                uint16_t consumed = btstack_slip_decoder_instance_process(&decoder, &stream[pos], size);
+                pos  += consumed;
+                size -= consumed;
+                uint16_t frame_size = btstack_slip_decoder_instance_frame_size(&decoder);
+                if (frame_size == 0) continue;
+                CHECK_EQUAL(sizeof(data[num_frames]), frame_size);
+                MEMCMP_EQUAL(data[num_frames], decoded, frame_size);
+                num_frames++;
+                btstack_slip_decoder_instance_init(&decoder, decoded, sizeof(decoded));
+            }
+        }
+        CHECK_EQUAL(2, num_frames);
+    }
+}
+
+TEST(SLIP, DecodeInvalidEscapeAndOverflow){
+    // invalid escape drops frame, frame larger than buffer is dropped
+    const uint8_t stream[] = { 0xc0, 0x01, 0xdb, 0x02, 0xc0, 0xc0, 0x01, 0x02, 0x03, 0x04, 0x05, 0xc0, 0xc0, 0x0a, 0xdb, 0xdd, 0xc0 };
+    const uint8_t expected[] = { 0x0a, 0xdb };
+    uint8_t decoded[4];
+    btstack_slip_decoder_t decoder;
+    btstack_slip_decoder_instance_init(&decoder, decoded, sizeof(decoded));
+    uint16_t consumed = btstack_slip_decoder_instance_process(&decoder, stream, sizeof(stream));
+    CHECK_EQUAL(sizeof(stream), consumed);
+    CHECK_EQUAL(sizeof(expected), btstack_slip_decoder_instance_frame_size(&decoder));
+    MEMCMP_EQUAL(expected, decoded, sizeof(expected));
+}
+
+int main (int argc, const char * argv[]){
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
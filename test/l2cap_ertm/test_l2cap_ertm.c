@@ -0,0 +1,764 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include "bluetooth_psm.h"
+#include "btstack_debug.h"
+#include "btstack_event.h"
+#include "btstack_memory.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_base.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_cmd.h"
+#include "hci_dump.h"
+#include "l2cap.h"
+#include "l2cap_signaling.h"
+
+// ready Classic ACL connection from hci_setup_test_connections_fuzz
+#define CON_HANDLE      0x0003
+#define REMOTE_CID      0x0050
+#define PSM_TEST        0x1001
+
+#define MAX_PACKETS     64
+#define MAX_PACKET_SIZE (HCI_ACL_PAYLOAD_SIZE + 4)
+
+// local ERTM config
+#define NUM_TX_BUFFERS   4
+#define NUM_RX_BUFFERS   4
+#define LOCAL_MTU      200
+#define RETRANSMISSION_TIMEOUT_MS  2000
+#define MONITOR_TIMEOUT_MS        12000
+
+// S-Frame supervisory function
+#define SUPERVISORY_FUNCTION_RR   0
+#define SUPERVISORY_FUNCTION_REJ  1
+#define SUPERVISORY_FUNCTION_RNR  2
+#define SUPERVISORY_FUNCTION_SREJ 3
+
+// L2CAP Configuration options
+#define CONFIG_OPTION_TYPE_MAX_TRANSMISSION_UNIT            1
+#define CONFIG_OPTION_TYPE_RETRANSMISSION_AND_FLOW_CONTROL  4
+#define CONFIG_OPTION_TYPE_FRAME_CHECK_SEQUENCE             5
+
+static const bd_addr_t remote_address = { 0x66, 0x55, 0x44, 0x33, 0x00, 0x03 };
+
+static void (*packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
+
+// ACL packets sent by the stack
+static uint8_t  sent_packets[MAX_PACKETS][MAX_PACKET_SIZE];
+static uint16_t sent_packets_len[MAX_PACKETS];
+static int      num_sent_packets;
+
+// ERTM frames sent by the stack on the test channel
+typedef struct {
+    uint16_t control;
+    uint8_t  payload[MAX_PACKET_SIZE];
+    uint16_t len;
+} ertm_frame_t;
+
+static ertm_frame_t ertm_frames[MAX_PACKETS];
+static int          num_ertm_frames;
+
+// SDUs received on the test channel
+static uint8_t  received_sdus[MAX_PACKETS][LOCAL_MTU];
+static uint16_t received_sdus_len[MAX_PACKETS];
+static int      num_received_sdus;
+
+static l2cap_ertm_config_t ertm_config;
+static uint8_t  ertm_buffer[10000];
+static uint8_t * channel_buffer;
+static uint32_t channel_buffer_size;
+static uint16_t local_cid;
+static int      channel_opened;
+
+// remote ERTM config
+static uint8_t  remote_tx_window;
+static uint16_t remote_mps;
+static uint16_t remote_mtu;
+
+static uint32_t mock_time_ms;
+
+static uint16_t crc16_calc(const uint8_t * data, uint16_t len){
+    uint16_t crc = 0;
+    while (len--){
+        crc ^= *data++;
+        int i;
+        for (i = 0; i < 8; i++){
+            crc = (crc & 1) ? ((crc >> 1) ^ 0xa001) : (crc >> 1);
+        }
+    }
+    return crc;
+}
+
+static int hci_transport_test_set_baudrate(uint32_t baudrate){
+    return 0;
+}
+
+static int hci_transport_test_can_send_now(uint8_t packet_type){
+    return 1;
+}
+
+static int hci_transport_test_send_packet(uint8_t packet_type, uint8_t * packet, int size){
+    static const uint8_t packet_sent_event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
+    if (packet_type == HCI_ACL_DATA_PACKET){
+        CHECK(num_sent_packets < MAX_PACKETS);
+        CHECK(size <= MAX_PACKET_SIZE);
+        memcpy(sent_packets[num_sent_packets], packet, size);
+        sent_packets_len[num_sent_packets] = size;
+        num_sent_packets++;
+    }
+    // notify upper stack that it can send again
+    packet_handler(HCI_EVENT_PACKET, (uint8_t *) &packet_sent_event[0], sizeof(packet_sent_event));
+    return 0;
+}
+
+static void hci_transport_test_init(const void * transport_config){
+}
+
+static int hci_transport_test_open(void){
+    return 0;
+}
+
+static int hci_transport_test_close(void){
+    return 0;
+}
+
+static void hci_transport_test_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
+    packet_handler = handler;
+}
+
+static const hci_transport_t hci_transport_test = {
+        /* const char * name; */                                        "TEST",
+        /* void   (*init) (const void *transport_config); */            &hci_transport_test_init,
+        /* int    (*open)(void); */                                     &hci_transport_test_open,
+        /* int    (*close)(void); */                                    &hci_transport_test_close,
+        /* void   (*register_packet_handler)(void (*handler)(...); */   &hci_transport_test_register_packet_handler,
+        /* int    (*can_send_packet_now)(uint8_t packet_type); */       &hci_transport_test_can_send_now,
+        /* int    (*send_packet)(...); */                               &hci_transport_test_send_packet,
+        /* int    (*set_baudrate)(uint32_t baudrate); */                &hci_transport_test_set_baudrate,
+        /* void   (*reset_link)(void); */                               NULL,
+        /* void   (*set_sco_config)(uint16_t voice_setting, int num_connections); */ NULL,
+};
+
+// mock run loop with manual time
+
+static void mock_run_loop_init(void){
+    btstack_run_loop_base_init();
+}
+
+static void mock_run_loop_set_timer(btstack_timer_source_t * ts, uint32_t timeout_in_ms){
+    ts->timeout = mock_time_ms + timeout_in_ms;
+}
+
+static uint32_t mock_run_loop_get_time_ms(void){
+    return mock_time_ms;
+}
+
+static const btstack_run_loop_t mock_run_loop = {
+    &mock_run_loop_init,
+    &btstack_run_loop_base_add_data_source,
+    &btstack_run_loop_base_remove_data_source,
+    &btstack_run_loop_base_enable_data_source_callbacks,
+    &btstack_run_loop_base_disable_data_source_callbacks,
+    &mock_run_loop_set_timer,
+    &btstack_run_loop_base_add_timer,
+    &btstack_run_loop_base_remove_timer,
+    NULL,
+    NULL,
+    &mock_run_loop_get_time_ms,
+};
+
+static void advance_time_ms(uint32_t duration_ms){
+    mock_time_ms += duration_ms;
+    btstack_run_loop_base_process_timers(mock_time_ms);
+}
+
+// remote device
+
+static void send_l2cap_packet(uint16_t cid, const uint8_t * data, uint16_t len){
+    uint8_t packet[HCI_INCOMING_PRE_BUFFER_SIZE + MAX_PACKET_SIZE];
+    uint8_t * acl = &packet[HCI_INCOMING_PRE_BUFFER_SIZE];
+    little_endian_store_16(acl, 0, CON_HANDLE | (0x02 << 12));
+    little_endian_store_16(acl, 2, 4 + len);
+    little_endian_store_16(acl, 4, len);
+    little_endian_store_16(acl, 6, cid);
+    memcpy(&acl[8], data, len);
+    packet_handler(HCI_ACL_DATA_PACKET, acl, 8 + len);
+}
+
+static void send_signaling(uint8_t code, uint8_t sig_id, const uint8_t * data, uint16_t len){
+    uint8_t command[100];
+    command[0] = code;
+    command[1] = sig_id;
+    little_endian_store_16(command, 2, len);
+    memcpy(&command[4], data, len);
+    send_l2cap_packet(L2CAP_CID_SIGNALING, command, 4 + len);
+}
+
+static void send_ertm_frame(uint16_t control, const uint8_t * data, uint16_t len){
+    uint8_t frame[MAX_PACKET_SIZE];
+    // FCS covers Basic L2CAP header, control and payload
+    little_endian_store_16(frame, 0, 2 + len + 2);
+    little_endian_store_16(frame, 2, local_cid);
+    little_endian_store_16(frame, 4, control);
+    if (len > 0){
+        memcpy(&frame[6], data, len);
+    }
+    little_endian_store_16(frame, 6 + len, crc16_calc(frame, 6 + len));
+    send_l2cap_packet(local_cid, &frame[4], 2 + len + 2);
+}
+
+static void send_i_frame(uint8_t tx_seq, uint8_t req_seq, l2cap_segmentation_and_reassembly_t sar, const uint8_t * data, uint16_t len){
+    send_ertm_frame((((uint16_t) sar) << 14) | (req_seq << 8) | (tx_seq << 1), data, len);
+}
+
+static void send_s_frame(uint8_t function, int poll, int final, uint8_t req_seq){
+    send_ertm_frame((req_seq << 8) | (final << 7) | (poll << 4) | (function << 2) | 1, NULL, 0);
+}
+
+static void send_remote_supported_features_complete(void){
+    uint8_t event[] = { HCI_EVENT_READ_REMOTE_SUPPORTED_FEATURES_COMPLETE, 11, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+    little_endian_store_16(event, 3, CON_HANDLE);
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void send_disconnection_complete(void){
+    uint8_t event[] = { HCI_EVENT_DISCONNECTION_COMPLETE, 4, 0, 0, 0, 0x13 };
+    little_endian_store_16(event, 3, CON_HANDLE);
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void send_configure_request(void){
+    uint8_t data[22];
+    int pos = 0;
+    little_endian_store_16(data, pos, local_cid);
+    pos += 2;
+    little_endian_store_16(data, pos, 0);
+    pos += 2;
+    data[pos++] = CONFIG_OPTION_TYPE_RETRANSMISSION_AND_FLOW_CONTROL;
+    data[pos++] = 9;
+    data[pos++] = L2CAP_CHANNEL_MODE_ENHANCED_RETRANSMISSION;
+    data[pos++] = remote_tx_window;
+    data[pos++] = 20;
+    little_endian_store_16(data, pos, RETRANSMISSION_TIMEOUT_MS);
+    pos += 2;
+    little_endian_store_16(data, pos, MONITOR_TIMEOUT_MS);
+    pos += 2;
+    little_endian_store_16(data, pos, remote_mps);
+    pos += 2;
+    data[pos++] = CONFIG_OPTION_TYPE_MAX_TRANSMISSION_UNIT;
+    data[pos++] = 2;
+    little_endian_store_16(data, pos, remote_mtu);
+    pos += 2;
+    data[pos++] = CONFIG_OPTION_TYPE_FRAME_CHECK_SEQUENCE;
+    data[pos++] = 1;
+    data[pos++] = 1;
+    send_signaling(CONFIGURE_REQUEST, 0x80, data, pos);
+}
+
+static void handle_signaling_packet(const uint8_t * command){
+    uint8_t  code   = command[0];
+    uint8_t  sig_id = command[1];
+    uint8_t  data[8];
+    switch (code){
+        case INFORMATION_REQUEST:
+            // info type, result, ERTM and FCS option supported
+            little_endian_store_16(data, 0, little_endian_read_16(command, 4));
+            little_endian_store_16(data, 2, 0);
+            little_endian_store_32(data, 4, 0x28);
+            send_signaling(INFORMATION_RESPONSE, sig_id, data, 8);
+            break;
+        case CONNECTION_REQUEST:
+            // destination cid, source cid, result, status
+            little_endian_store_16(data, 0, REMOTE_CID);
+            little_endian_store_16(data, 2, little_endian_read_16(command, 6));
+            little_endian_store_16(data, 4, 0);
+            little_endian_store_16(data, 6, 0);
+            send_signaling(CONNECTION_RESPONSE, sig_id, data, 8);
+            send_configure_request();
+            break;
+        case CONFIGURE_REQUEST:
+            // source cid, flags, result
+            little_endian_store_16(data, 0, local_cid);
+            little_endian_store_16(data, 2, 0);
+            little_endian_store_16(data, 4, 0);
+            send_signaling(CONFIGURE_RESPONSE, sig_id, data, 6);
+            break;
+        default:
+            break;
+    }
+}
+
+// respond to signaling packets and collect ERTM frames sent by the stack
+static void process_sent_packets(void){
+    while (num_sent_packets){
+        uint8_t packet[MAX_PACKET_SIZE];
+        uint16_t size = sent_packets_len[0];
+        memcpy(packet, sent_packets[0], size);
+        num_sent_packets--;
+        memmove(&sent_packets[0], &sent_packets[1], num_sent_packets * MAX_PACKET_SIZE);
+        memmove(&sent_packets_len[0], &sent_packets_len[1], num_sent_packets * sizeof(uint16_t));
+
+        uint16_t l2cap_len = little_endian_read_16(packet, 4);
+        CHECK_EQUAL(size, 8 + l2cap_len);
+        uint16_t cid = little_endian_read_16(packet, 6);
+        if (cid == L2CAP_CID_SIGNALING){
+            handle_signaling_packet(&packet[8]);
+            continue;
+        }
+        CHECK_EQUAL(REMOTE_CID, cid);
+        CHECK(num_ertm_frames < MAX_PACKETS);
+        // verify FCS
+        CHECK_EQUAL(crc16_calc(&packet[4], 4 + l2cap_len - 2), little_endian_read_16(packet, size - 2));
+        ertm_frame_t * frame = &ertm_frames[num_ertm_frames++];
+        frame->control = little_endian_read_16(packet, 8);
+        frame->len     = l2cap_len - 4;
+        memcpy(frame->payload, &packet[10], frame->len);
+    }
+}
+
+static void clear_ertm_frames(void){
+    process_sent_packets();
+    num_ertm_frames = 0;
+}
+
+static bool frame_is_i_frame(const ertm_frame_t * frame){
+    return (frame->control & 1) == 0;
+}
+
+static uint8_t frame_get_tx_seq(const ertm_frame_t * frame){
+    return (frame->control >> 1) & 0x3f;
+}
+
+static uint8_t frame_get_req_seq(const ertm_frame_t * frame){
+    return (frame->control >> 8) & 0x3f;
+}
+
+static l2cap_segmentation_and_reassembly_t frame_get_sar(const ertm_frame_t * frame){
+    return (l2cap_segmentation_and_reassembly_t) (frame->control >> 14);
+}
+
+static int frame_get_final(const ertm_frame_t * frame){
+    return (frame->control >> 7) & 1;
+}
+
+static int frame_get_poll(const ertm_frame_t * frame){
+    return (frame->control >> 4) & 1;
+}
+
+static uint8_t frame_get_supervisory_function(const ertm_frame_t * frame){
+    return (frame->control >> 2) & 3;
+}
+
+static void l2cap_channel_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    switch (packet_type){
+        case L2CAP_DATA_PACKET:
+            CHECK(num_received_sdus < MAX_PACKETS);
+            CHECK(size <= LOCAL_MTU);
+            memcpy(received_sdus[num_received_sdus], packet, size);
+            received_sdus_len[num_received_sdus] = size;
+            num_received_sdus++;
+            break;
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case L2CAP_EVENT_CHANNEL_OPENED:
+                    CHECK_EQUAL(ERROR_CODE_SUCCESS, l2cap_event_channel_opened_get_status(packet));
+                    channel_opened = 1;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void open_channel(void){
+    send_remote_supported_features_complete();
+    uint8_t status = l2cap_create_ertm_channel(&l2cap_channel_packet_handler, (uint8_t *) remote_address, PSM_TEST,
+                                               &ertm_config, channel_buffer, channel_buffer_size, &local_cid);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, status);
+    process_sent_packets();
+    CHECK_EQUAL(1, channel_opened);
+    CHECK_EQUAL(0, num_ertm_frames);
+}
+
+static void send_sdu(uint8_t value, uint16_t len){
+    uint8_t sdu[LOCAL_MTU];
+    memset(sdu, value, len);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, l2cap_send(local_cid, sdu, len));
+    process_sent_packets();
+}
+
+TEST_GROUP(L2CAP_ERTM){
+    void setup(void){
+        num_sent_packets  = 0;
+        num_ertm_frames   = 0;
+        num_received_sdus = 0;
+        channel_opened    = 0;
+        mock_time_ms      = 0;
+        remote_tx_window  = NUM_RX_BUFFERS;
+        remote_mps        = 100;
+        remote_mtu        = 100;
+        channel_buffer      = ertm_buffer;
+        channel_buffer_size = sizeof(ertm_buffer);
+        memset(&ertm_config, 0, sizeof(ertm_config));
+        ertm_config.ertm_mandatory = 1;
+        ertm_config.max_transmit = 3;
+        ertm_config.retransmission_timeout_ms = RETRANSMISSION_TIMEOUT_MS;
+        ertm_config.monitor_timeout_ms = MONITOR_TIMEOUT_MS;
+        ertm_config.local_mtu = LOCAL_MTU;
+        ertm_config.num_tx_buffers = NUM_TX_BUFFERS;
+        ertm_config.num_rx_buffers = NUM_RX_BUFFERS;
+        ertm_config.fcs_option = 1;
+        // drop timers from previous test
+        btstack_run_loop_base_init();
+        hci_init(&hci_transport_test, NULL);
+        l2cap_init();
+        hci_setup_test_connections_fuzz();
+        hci_simulate_working_fuzz();
+        gap_set_security_level(LEVEL_0);
+    }
+    void teardown(void){
+        send_disconnection_complete();
+        hci_free_connections_fuzz();
+        if (channel_buffer != ertm_buffer){
+            free(channel_buffer);
+        }
+    }
+};
+
+TEST(L2CAP_ERTM, RetransmissionTimeoutSendsPoll){
+    open_channel();
+    send_sdu(0, 10);
+    send_sdu(1, 10);
+    send_sdu(2, 10);
+    CHECK_EQUAL(3, num_ertm_frames);
+    clear_ertm_frames();
+
+    // unacknowledged frames are not retransmitted on timeout, the receiver is polled instead
+    advance_time_ms(RETRANSMISSION_TIMEOUT_MS);
+    process_sent_packets();
+    CHECK_EQUAL(1, num_ertm_frames);
+    CHECK_FALSE(frame_is_i_frame(&ertm_frames[0]));
+    CHECK_EQUAL(SUPERVISORY_FUNCTION_RR, frame_get_supervisory_function(&ertm_frames[0]));
+    CHECK_EQUAL(1, frame_get_poll(&ertm_frames[0]));
+    clear_ertm_frames();
+
+    // receiver got first frame and does not store any other frame: retransmit all frames after it
+    send_s_frame(SUPERVISORY_FUNCTION_RR, 0, 1, 1);
+    process_sent_packets();
+    CHECK_EQUAL(2, num_ertm_frames);
+    CHECK(frame_is_i_frame(&ertm_frames[0]));
+    CHECK_EQUAL(1, frame_get_tx_seq(&ertm_frames[0]));
+    CHECK(frame_is_i_frame(&ertm_frames[1]));
+    CHECK_EQUAL(2, frame_get_tx_seq(&ertm_frames[1]));
+}
+
+TEST(L2CAP_ERTM, SelectiveRejectOnlyForUnacknowledgedFrames){
+    open_channel();
+    send_sdu(0, 10);
+    send_sdu(1, 10);
+    send_s_frame(SUPERVISORY_FUNCTION_RR, 0, 0, 2);
+    send_sdu(2, 10);
+    clear_ertm_frames();
+
+    // buffer of acknowledged frame with tx_seq 0 is still in tx buffer array
+    send_s_frame(SUPERVISORY_FUNCTION_SREJ, 0, 0, 0);
+    process_sent_packets();
+    CHECK_EQUAL(0, num_ertm_frames);
+
+    send_s_frame(SUPERVISORY_FUNCTION_SREJ, 0, 0, 2);
+    process_sent_packets();
+    CHECK_EQUAL(1, num_ertm_frames);
+    CHECK(frame_is_i_frame(&ertm_frames[0]));
+    CHECK_EQUAL(2, frame_get_tx_seq(&ertm_frames[0]));
+    CHECK_EQUAL(2, ertm_frames[0].payload[0]);
+}
+
+TEST(L2CAP_ERTM, SelectiveRejectWithFinalStopsMonitorTimer){
+    open_channel();
+    send_sdu(0, 10);
+    send_sdu(1, 10);
+    advance_time_ms(RETRANSMISSION_TIMEOUT_MS);
+    clear_ertm_frames();
+
+    // response to poll: frame 1 is missing
+    send_s_frame(SUPERVISORY_FUNCTION_SREJ, 0, 1, 1);
+    process_sent_packets();
+    CHECK_EQUAL(1, num_ertm_frames);
+    CHECK_EQUAL(1, frame_get_tx_seq(&ertm_frames[0]));
+    clear_ertm_frames();
+
+    // all frames acknowledged, neither monitor nor retransmission timer send a poll
+    send_s_frame(SUPERVISORY_FUNCTION_RR, 0, 0, 2);
+    advance_time_ms(MONITOR_TIMEOUT_MS);
+    advance_time_ms(MONITOR_TIMEOUT_MS);
+    process_sent_packets();
+    CHECK_EQUAL(0, num_ertm_frames);
+}
+
+TEST(L2CAP_ERTM, LostRetransmissionPollsWhenWindowFull){
+    open_channel();
+    send_sdu(0, 10);
+    send_sdu(1, 10);
+    send_sdu(2, 10);
+    send_sdu(3, 10);
+    CHECK_EQUAL(4, num_ertm_frames);
+    clear_ertm_frames();
+
+    // window full and oldest frame retransmitted: poll right away
+    send_s_frame(SUPERVISORY_FUNCTION_SREJ, 0, 0, 0);
+    process_sent_packets();
+    CHECK_EQUAL(2, num_ertm_frames);
+    CHECK(frame_is_i_frame(&ertm_frames[0]));
+    CHECK_EQUAL(0, frame_get_tx_seq(&ertm_frames[0]));
+    CHECK_FALSE(frame_is_i_frame(&ertm_frames[1]));
+    CHECK_EQUAL(SUPERVISORY_FUNCTION_RR, frame_get_supervisory_function(&ertm_frames[1]));
+    CHECK_EQUAL(1, frame_get_poll(&ertm_frames[1]));
+    clear_ertm_frames();
+
+    // retransmission got lost, receiver still misses frame 0: retransmit and poll again
+    send_s_frame(SUPERVISORY_FUNCTION_SREJ, 0, 1, 0);
+    process_sent_packets();
+    CHECK_EQUAL(2, num_ertm_frames);
+    CHECK(frame_is_i_frame(&ertm_frames[0]));
+    CHECK_EQUAL(0, frame_get_tx_seq(&ertm_frames[0]));
+    CHECK_EQUAL(1, frame_get_poll(&ertm_frames[1]));
+    clear_ertm_frames();
+
+    send_s_frame(SUPERVISORY_FUNCTION_RR, 0, 1, 4);
+    send_sdu(4, 10);
+    CHECK_EQUAL(1, num_ertm_frames);
+    CHECK_EQUAL(4, frame_get_tx_seq(&ertm_frames[0]));
+}
+
+TEST(L2CAP_ERTM, SelectiveRejectWhileWaitingForFinal){
+    open_channel();
+    send_sdu(0, 10);
+    send_sdu(1, 10);
+    send_sdu(2, 10);
+    send_sdu(3, 10);
+    send_s_frame(SUPERVISORY_FUNCTION_SREJ, 0, 0, 0);
+    clear_ertm_frames();
+
+    // frame 1 requested before response to poll
+    send_s_frame(SUPERVISORY_FUNCTION_SREJ, 0, 0, 1);
+    process_sent_packets();
+    CHECK_EQUAL(1, num_ertm_frames);
+    CHECK_EQUAL(1, frame_get_tx_seq(&ertm_frames[0]));
+    clear_ertm_frames();
+
+    // no new I-Frames until final bit received
+    send_s_frame(SUPERVISORY_FUNCTION_RR, 0, 0, 1);
+    send_sdu(4, 10);
+    CHECK_EQUAL(0, num_ertm_frames);
+
+    // response to poll for same frame: not retransmitted again, new I-Frame fills window
+    send_s_frame(SUPERVISORY_FUNCTION_SREJ, 0, 1, 1);
+    process_sent_packets();
+    CHECK_EQUAL(2, num_ertm_frames);
+    CHECK(frame_is_i_frame(&ertm_frames[0]));
+    CHECK_EQUAL(4, frame_get_tx_seq(&ertm_frames[0]));
+    CHECK_FALSE(frame_is_i_frame(&ertm_frames[1]));
+    CHECK_EQUAL(1, frame_get_poll(&ertm_frames[1]));
+}
+
+static void send_i_frame_sdu(uint8_t tx_seq, uint8_t value){
+    uint8_t sdu[10];
+    memset(sdu, value, sizeof(sdu));
+    send_i_frame(tx_seq, 0, L2CAP_SEGMENTATION_AND_REASSEMBLY_UNSEGMENTED_L2CAP_SDU, sdu, sizeof(sdu));
+    process_sent_packets();
+}
+
+static void check_s_frame(const ertm_frame_t * frame, uint8_t function, uint8_t req_seq, int final){
+    CHECK_FALSE(frame_is_i_frame(frame));
+    CHECK_EQUAL(function, frame_get_supervisory_function(frame));
+    CHECK_EQUAL(req_seq, frame_get_req_seq(frame));
+    CHECK_EQUAL(final, frame_get_final(frame));
+}
+
+static void check_received_sdus(int count){
+    CHECK_EQUAL(count, num_received_sdus);
+    int i;
+    for (i = 0; i < count; i++){
+        CHECK_EQUAL(10, received_sdus_len[i]);
+        CHECK_EQUAL(i, received_sdus[i][0]);
+    }
+}
+
+TEST(L2CAP_ERTM, SelectiveRejectOncePerMissingFrame){
+    open_channel();
+    send_i_frame_sdu(0, 0);
+    CHECK_EQUAL(1, num_ertm_frames);
+    check_s_frame(&ertm_frames[0], SUPERVISORY_FUNCTION_RR, 1, 0);
+    clear_ertm_frames();
+
+    // frame 1 lost: requested once, following frames are stored
+    send_i_frame_sdu(2, 2);
+    send_i_frame_sdu(3, 3);
+    CHECK_EQUAL(1, num_ertm_frames);
+    check_s_frame(&ertm_frames[0], SUPERVISORY_FUNCTION_SREJ, 1, 0);
+    check_received_sdus(1);
+    clear_ertm_frames();
+
+    // stored frames delivered in order
+    send_i_frame_sdu(1, 1);
+    CHECK_EQUAL(1, num_ertm_frames);
+    check_s_frame(&ertm_frames[0], SUPERVISORY_FUNCTION_RR, 4, 0);
+    check_received_sdus(4);
+}
+
+TEST(L2CAP_ERTM, SelectiveRejectForNextGapAndOnPoll){
+    open_channel();
+
+    // frames 0 and 2 lost
+    send_i_frame_sdu(1, 1);
+    send_i_frame_sdu(3, 3);
+    CHECK_EQUAL(1, num_ertm_frames);
+    check_s_frame(&ertm_frames[0], SUPERVISORY_FUNCTION_SREJ, 0, 0);
+    clear_ertm_frames();
+
+    // first gap filled, next missing frame requested
+    send_i_frame_sdu(0, 0);
+    CHECK_EQUAL(1, num_ertm_frames);
+    check_s_frame(&ertm_frames[0], SUPERVISORY_FUNCTION_SREJ, 2, 0);
+    check_received_sdus(2);
+    clear_ertm_frames();
+
+    // missing frame requested again on poll
+    send_s_frame(SUPERVISORY_FUNCTION_RR, 1, 0, 0);
+    process_sent_packets();
+    CHECK_EQUAL(1, num_ertm_frames);
+    check_s_frame(&ertm_frames[0], SUPERVISORY_FUNCTION_SREJ, 2, 1);
+    clear_ertm_frames();
+
+    send_i_frame_sdu(2, 2);
+    CHECK_EQUAL(1, num_ertm_frames);
+    check_s_frame(&ertm_frames[0], SUPERVISORY_FUNCTION_RR, 4, 0);
+    check_received_sdus(4);
+}
+
+static void fill_sdu(uint8_t * sdu, uint16_t len){
+    uint16_t i;
+    for (i = 0; i < len; i++){
+        sdu[i] = (uint8_t) i;
+    }
+}
+
+// reassemble SDU from collected I-Frames, returns SDU length
+static uint16_t reassemble_sent_sdu(uint8_t * sdu){
+    uint16_t sdu_len = 0;
+    int i;
+    for (i = 0; i < num_ertm_frames; i++){
+        const ertm_frame_t * frame = &ertm_frames[i];
+        CHECK(frame_is_i_frame(frame));
+        CHECK_EQUAL(i, frame_get_tx_seq(frame));
+        const uint8_t * payload = frame->payload;
+        uint16_t len = frame->len;
+        if (frame_get_sar(frame) == L2CAP_SEGMENTATION_AND_REASSEMBLY_START_OF_L2CAP_SDU){
+            CHECK_EQUAL(0, i);
+            payload += 2;
+            len -= 2;
+        }
+        memcpy(&sdu[sdu_len], payload, len);
+        sdu_len += len;
+    }
+    CHECK_EQUAL(L2CAP_SEGMENTATION_AND_REASSEMBLY_END_OF_L2CAP_SDU, frame_get_sar(&ertm_frames[num_ertm_frames-1]));
+    CHECK_EQUAL(sdu_len, little_endian_read_16(ertm_frames[0].payload, 0));
+    return sdu_len;
+}
+
+TEST(L2CAP_ERTM, SegmentedSduUsesRemoteMps){
+    remote_mps = 40;
+    open_channel();
+    uint8_t sdu[100];
+    fill_sdu(sdu, sizeof(sdu));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, l2cap_send(local_cid, sdu, sizeof(sdu)));
+    process_sent_packets();
+
+    CHECK_EQUAL(3, num_ertm_frames);
+    CHECK_EQUAL(L2CAP_SEGMENTATION_AND_REASSEMBLY_START_OF_L2CAP_SDU, frame_get_sar(&ertm_frames[0]));
+    CHECK_EQUAL(40, ertm_frames[0].len);
+    CHECK_EQUAL(L2CAP_SEGMENTATION_AND_REASSEMBLY_CONTINUATION_OF_L2CAP_SDU, frame_get_sar(&ertm_frames[1]));
+    CHECK_EQUAL(40, ertm_frames[1].len);
+    CHECK_EQUAL(22, ertm_frames[2].len);
+    uint8_t reassembled[100];
+    CHECK_EQUAL(sizeof(sdu), reassemble_sent_sdu(reassembled));
+    MEMCMP_EQUAL(sdu, reassembled, sizeof(sdu));
+}
+
+TEST(L2CAP_ERTM, RemoteMtuLimitedByTxBuffers){
+    remote_mps = 20;
+    remote_mtu = 200;
+    open_channel();
+    uint16_t usable_mtu = NUM_TX_BUFFERS * remote_mps - 2;
+    CHECK_EQUAL(usable_mtu, l2cap_get_remote_mtu_for_local_cid(local_cid));
+
+    uint8_t sdu[200];
+    fill_sdu(sdu, sizeof(sdu));
+    CHECK_EQUAL(L2CAP_DATA_LEN_EXCEEDS_REMOTE_MTU, l2cap_send(local_cid, sdu, usable_mtu + 1));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, l2cap_send(local_cid, sdu, usable_mtu));
+    process_sent_packets();
+    CHECK_EQUAL(NUM_TX_BUFFERS, num_ertm_frames);
+    uint8_t reassembled[200];
+    CHECK_EQUAL(usable_mtu, reassemble_sent_sdu(reassembled));
+    MEMCMP_EQUAL(sdu, reassembled, usable_mtu);
+}
+
+TEST(L2CAP_ERTM, LargestSduFitsIntoChannelBuffer){
+    // I-Frames use full local MPS, buffer overruns are detected by address sanitizer
+    channel_buffer_size = 2000;
+    channel_buffer = (uint8_t *) malloc(channel_buffer_size);
+    remote_mps = 1000;
+    remote_mtu = 1000;
+    open_channel();
+    uint16_t usable_mtu = l2cap_get_remote_mtu_for_local_cid(local_cid);
+    CHECK(usable_mtu < remote_mtu);
+
+    uint8_t sdu[1000];
+    fill_sdu(sdu, usable_mtu);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, l2cap_send(local_cid, sdu, usable_mtu));
+    process_sent_packets();
+    CHECK_EQUAL(NUM_TX_BUFFERS, num_ertm_frames);
+    uint16_t local_mps = (usable_mtu + 2) / NUM_TX_BUFFERS;
+    int i;
+    for (i = 0; i < num_ertm_frames; i++){
+        CHECK_EQUAL(local_mps, ertm_frames[i].len);
+    }
+    uint8_t reassembled[1000];
+    CHECK_EQUAL(usable_mtu, reassemble_sent_sdu(reassembled));
+    MEMCMP_EQUAL(sdu, reassembled, usable_mtu);
+}
+
+TEST(L2CAP_ERTM, OutOfSequenceSegmentsReassembled){
+    open_channel();
+    uint8_t sdu[90];
+    fill_sdu(sdu, sizeof(sdu));
+    uint8_t start[32];
+    little_endian_store_16(start, 0, sizeof(sdu));
+    memcpy(&start[2], &sdu[0], 30);
+
+    // start segment lost, continuation and end stored
+    send_i_frame(1, 0, L2CAP_SEGMENTATION_AND_REASSEMBLY_CONTINUATION_OF_L2CAP_SDU, &sdu[30], 30);
+    send_i_frame(2, 0, L2CAP_SEGMENTATION_AND_REASSEMBLY_END_OF_L2CAP_SDU, &sdu[60], 30);
+    process_sent_packets();
+    CHECK_EQUAL(0, num_received_sdus);
+
+    send_i_frame(0, 0, L2CAP_SEGMENTATION_AND_REASSEMBLY_START_OF_L2CAP_SDU, start, sizeof(start));
+    process_sent_packets();
+    CHECK_EQUAL(1, num_received_sdus);
+    CHECK_EQUAL(sizeof(sdu), received_sdus_len[0]);
+    MEMCMP_EQUAL(sdu, received_sdus[0], sizeof(sdu));
+}
+
+int main (int argc, const char * argv[]){
+    btstack_run_loop_init(&mock_run_loop);
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
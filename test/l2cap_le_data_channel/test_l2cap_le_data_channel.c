@@ -0,0 +1,550 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include "btstack_debug.h"
+#include "btstack_event.h"
+#include "btstack_memory.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_base.h"
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_cmd.h"
+#include "hci_dump.h"
+#include "l2cap.h"
+#include "l2cap_signaling.h"
+
+// ready LE ACL connection from hci_setup_test_connections_fuzz
+#define CON_HANDLE      0x0005
+#define CON_HANDLE_AUDIO 0x0006
+#define REMOTE_CID      0x0040
+#define PSM_TEST        0x0080
+
+#define MAX_PACKETS     64
+#define MAX_PACKET_SIZE (HCI_ACL_PAYLOAD_SIZE + 4)
+
+// local LE Data Channel config
+#define LOCAL_MTU            200
+#define LOCAL_MPS             50
+#define NUM_RECEIVE_BUFFERS    L2CAP_LE_MAX_RECEIVE_SDU_BUFFERS
+
+#define MAX_SDUS             100
+
+static void (*packet_handler)(uint8_t packet_type, uint8_t *packet, uint16_t size);
+
+// ACL packets sent by the stack
+static uint8_t  sent_packets[MAX_PACKETS][MAX_PACKET_SIZE];
+static uint16_t sent_packets_len[MAX_PACKETS];
+static int      num_sent_packets;
+
+// local channel
+static uint8_t  receive_buffers[NUM_RECEIVE_BUFFERS][LOCAL_MTU];
+static uint8_t  num_receive_buffers;
+static uint16_t initial_credits;
+static uint16_t local_cid;
+static int      channel_opened;
+static int      num_le_channel_closed;
+static int      num_channel_closed;
+
+// SDUs received on the local channel, buffers held until released by test
+static uint16_t received_sdus_len[MAX_SDUS];
+static int      num_received_sdus;
+static const uint8_t * held_sdus[NUM_RECEIVE_BUFFERS];
+static int      num_held_sdus;
+
+// remote sender
+static uint16_t remote_initial_credits;
+static uint16_t remote_credits;
+static uint16_t remote_mps;
+static uint16_t remote_sdus_len[MAX_SDUS];
+static int      remote_num_sdus;
+static int      remote_sdu_index;
+static uint16_t remote_sdu_pos;
+
+// remote receiver
+static uint8_t  remote_received_pdus;
+static uint8_t  remote_disconnection_requests;
+static uint8_t  remote_disconnection_responses;
+
+static int hci_transport_test_set_baudrate(uint32_t baudrate){
+    return 0;
+}
+
+static int hci_transport_test_can_send_now(uint8_t packet_type){
+    return 1;
+}
+
+static int hci_transport_test_send_packet(uint8_t packet_type, uint8_t * packet, int size){
+    static const uint8_t packet_sent_event[] = { HCI_EVENT_TRANSPORT_PACKET_SENT, 0};
+    if (packet_type == HCI_ACL_DATA_PACKET){
+        CHECK(num_sent_packets < MAX_PACKETS);
+        CHECK(size <= MAX_PACKET_SIZE);
+        memcpy(sent_packets[num_sent_packets], packet, size);
+        sent_packets_len[num_sent_packets] = size;
+        num_sent_packets++;
+    }
+    // notify upper stack that it can send again
+    packet_handler(HCI_EVENT_PACKET, (uint8_t *) &packet_sent_event[0], sizeof(packet_sent_event));
+    return 0;
+}
+
+static void hci_transport_test_init(const void * transport_config){
+}
+
+static int hci_transport_test_open(void){
+    return 0;
+}
+
+static int hci_transport_test_close(void){
+    return 0;
+}
+
+static void hci_transport_test_register_packet_handler(void (*handler)(uint8_t packet_type, uint8_t *packet, uint16_t size)){
+    packet_handler = handler;
+}
+
+static const hci_transport_t hci_transport_test = {
+        /* const char * name; */                                        "TEST",
+        /* void   (*init) (const void *transport_config); */            &hci_transport_test_init,
+        /* int    (*open)(void); */                                     &hci_transport_test_open,
+        /* int    (*close)(void); */                                    &hci_transport_test_close,
+        /* void   (*register_packet_handler)(void (*handler)(...); */   &hci_transport_test_register_packet_handler,
+        /* int    (*can_send_packet_now)(uint8_t packet_type); */       &hci_transport_test_can_send_now,
+        /* int    (*send_packet)(...); */                               &hci_transport_test_send_packet,
+        /* int    (*set_baudrate)(uint32_t baudrate); */                &hci_transport_test_set_baudrate,
+        /* void   (*reset_link)(void); */                               NULL,
+        /* void   (*set_sco_config)(uint16_t voice_setting, int num_connections); */ NULL,
+};
+
+// mock run loop without time
+
+static void mock_run_loop_init(void){
+    btstack_run_loop_base_init();
+}
+
+static void mock_run_loop_set_timer(btstack_timer_source_t * ts, uint32_t timeout_in_ms){
+    ts->timeout = timeout_in_ms;
+}
+
+static uint32_t mock_run_loop_get_time_ms(void){
+    return 0;
+}
+
+static const btstack_run_loop_t mock_run_loop = {
+    &mock_run_loop_init,
+    &btstack_run_loop_base_add_data_source,
+    &btstack_run_loop_base_remove_data_source,
+    &btstack_run_loop_base_enable_data_source_callbacks,
+    &btstack_run_loop_base_disable_data_source_callbacks,
+    &mock_run_loop_set_timer,
+    &btstack_run_loop_base_add_timer,
+    &btstack_run_loop_base_remove_timer,
+    NULL,
+    NULL,
+    &mock_run_loop_get_time_ms,
+};
+
+// remote device
+
+static void send_l2cap_packet(uint16_t cid, const uint8_t * data, uint16_t len){
+    uint8_t packet[HCI_INCOMING_PRE_BUFFER_SIZE + MAX_PACKET_SIZE];
+    uint8_t * acl = &packet[HCI_INCOMING_PRE_BUFFER_SIZE];
+    little_endian_store_16(acl, 0, CON_HANDLE | (0x02 << 12));
+    little_endian_store_16(acl, 2, 4 + len);
+    little_endian_store_16(acl, 4, len);
+    little_endian_store_16(acl, 6, cid);
+    memcpy(&acl[8], data, len);
+    packet_handler(HCI_ACL_DATA_PACKET, acl, 8 + len);
+}
+
+static void send_le_signaling(uint8_t code, uint8_t sig_id, const uint8_t * data, uint16_t len){
+    uint8_t command[100];
+    command[0] = code;
+    command[1] = sig_id;
+    little_endian_store_16(command, 2, len);
+    memcpy(&command[4], data, len);
+    send_l2cap_packet(L2CAP_CID_SIGNALING_LE, command, 4 + len);
+}
+
+static void send_le_connection_request(void){
+    // le psm, source cid, mtu, mps, initial credits
+    uint8_t data[10];
+    little_endian_store_16(data, 0, PSM_TEST);
+    little_endian_store_16(data, 2, REMOTE_CID);
+    little_endian_store_16(data, 4, LOCAL_MTU);
+    little_endian_store_16(data, 6, LOCAL_MPS);
+    little_endian_store_16(data, 8, remote_initial_credits);
+    send_le_signaling(LE_CREDIT_BASED_CONNECTION_REQUEST, 0x01, data, sizeof(data));
+}
+
+static void send_le_credits(uint16_t credits){
+    // cid of channel endpoint receiving the credits
+    uint8_t data[4];
+    little_endian_store_16(data, 0, local_cid);
+    little_endian_store_16(data, 2, credits);
+    send_le_signaling(LE_FLOW_CONTROL_CREDIT, 0x02, data, sizeof(data));
+}
+
+static void send_disconnection(uint8_t code, uint8_t sig_id){
+    // destination cid, source cid as seen by sender of request
+    uint8_t data[4];
+    if (code == DISCONNECTION_REQUEST){
+        little_endian_store_16(data, 0, local_cid);
+        little_endian_store_16(data, 2, REMOTE_CID);
+    } else {
+        little_endian_store_16(data, 0, REMOTE_CID);
+        little_endian_store_16(data, 2, local_cid);
+    }
+    send_le_signaling(code, sig_id, data, sizeof(data));
+}
+
+// closes all channels on the connection
+static void send_disconnection_complete(void){
+    uint8_t event[] = { HCI_EVENT_DISCONNECTION_COMPLETE, 4, 0, 0, 0, 0x13 };
+    little_endian_store_16(event, 3, CON_HANDLE);
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void send_le_read_buffer_size_complete(uint8_t num_packets){
+    uint8_t event[] = { HCI_EVENT_COMMAND_COMPLETE, 7, 1, 0, 0, 0, 0, 0, 0 };
+    little_endian_store_16(event, 3, hci_le_read_buffer_size.opcode);
+    little_endian_store_16(event, 6, 251);
+    event[8] = num_packets;
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void send_le_connection_complete(hci_con_handle_t con_handle){
+    uint8_t event[] = { HCI_EVENT_LE_META, 19, HCI_SUBEVENT_LE_CONNECTION_COMPLETE, 0, 0, 0, HCI_ROLE_MASTER, 0,
+                        0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x18, 0, 0, 0, 0x48, 0, 0 };
+    little_endian_store_16(event, 4, con_handle);
+    event[13] = (uint8_t) con_handle;
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void send_number_of_completed_packets(uint16_t num_packets){
+    uint8_t event[] = { HCI_EVENT_NUMBER_OF_COMPLETED_PACKETS, 5, 1, 0, 0, 0, 0 };
+    little_endian_store_16(event, 3, CON_HANDLE);
+    little_endian_store_16(event, 5, num_packets);
+    packet_handler(HCI_EVENT_PACKET, event, sizeof(event));
+}
+
+static void handle_le_signaling_packet(const uint8_t * command){
+    uint8_t code = command[0];
+    switch (code){
+        case DISCONNECTION_REQUEST:
+            // destination cid, source cid
+            CHECK_EQUAL(REMOTE_CID, little_endian_read_16(command, 4));
+            CHECK_EQUAL(local_cid,  little_endian_read_16(command, 6));
+            remote_disconnection_requests++;
+            break;
+        case DISCONNECTION_RESPONSE:
+            CHECK_EQUAL(local_cid,  little_endian_read_16(command, 4));
+            CHECK_EQUAL(REMOTE_CID, little_endian_read_16(command, 6));
+            remote_disconnection_responses++;
+            break;
+        case LE_CREDIT_BASED_CONNECTION_RESPONSE:
+            // destination cid, mtu, mps, initial credits, result
+            CHECK_EQUAL(0, little_endian_read_16(command, 12));
+            remote_mps      = little_endian_read_16(command, 8);
+            remote_credits += little_endian_read_16(command, 10);
+            break;
+        case LE_FLOW_CONTROL_CREDIT:
+            // cid, credits
+            CHECK_EQUAL(REMOTE_CID, little_endian_read_16(command, 4));
+            remote_credits += little_endian_read_16(command, 6);
+            break;
+        default:
+            break;
+    }
+}
+
+// handle signaling packets sent by the stack
+static void process_sent_packets(void){
+    while (num_sent_packets){
+        uint8_t packet[MAX_PACKET_SIZE];
+        uint16_t size = sent_packets_len[0];
+        memcpy(packet, sent_packets[0], size);
+        num_sent_packets--;
+        memmove(&sent_packets[0], &sent_packets[1], num_sent_packets * MAX_PACKET_SIZE);
+        memmove(&sent_packets_len[0], &sent_packets_len[1], num_sent_packets * sizeof(uint16_t));
+
+        uint16_t l2cap_len = little_endian_read_16(packet, 4);
+        CHECK_EQUAL(size, 8 + l2cap_len);
+        uint16_t cid = little_endian_read_16(packet, 6);
+        if (cid == L2CAP_CID_SIGNALING_LE){
+            handle_le_signaling_packet(&packet[8]);
+        }
+        if (cid == REMOTE_CID){
+            remote_received_pdus++;
+        }
+    }
+}
+
+static uint8_t sdu_data(int sdu_index, uint16_t pos){
+    return (uint8_t) (sdu_index + pos);
+}
+
+// send SDUs queued with remote_queue_sdu while remote has credits
+static void remote_send_pdus(void){
+    while (remote_credits && (remote_sdu_index < remote_num_sdus)){
+        uint8_t  pdu[LOCAL_MPS];
+        uint16_t pdu_len = 0;
+        uint16_t sdu_len = remote_sdus_len[remote_sdu_index];
+        if (remote_sdu_pos == 0){
+            little_endian_store_16(pdu, 0, sdu_len);
+            pdu_len = 2;
+        }
+        while ((pdu_len < remote_mps) && (remote_sdu_pos < sdu_len)){
+            pdu[pdu_len++] = sdu_data(remote_sdu_index, remote_sdu_pos++);
+        }
+        if (remote_sdu_pos == sdu_len){
+            remote_sdu_index++;
+            remote_sdu_pos = 0;
+        }
+        remote_credits--;
+        send_l2cap_packet(local_cid, pdu, pdu_len);
+        process_sent_packets();
+    }
+}
+
+static void remote_queue_sdu(uint16_t len){
+    CHECK(remote_num_sdus < MAX_SDUS);
+    remote_sdus_len[remote_num_sdus++] = len;
+}
+
+static void l2cap_channel_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    uint8_t i;
+    switch (packet_type){
+        case L2CAP_DATA_PACKET:
+            CHECK(num_received_sdus < MAX_SDUS);
+            CHECK_EQUAL(remote_sdus_len[num_received_sdus], size);
+            uint16_t pos;
+            for (pos = 0; pos < size; pos++){
+                CHECK_EQUAL(sdu_data(num_received_sdus, pos), packet[pos]);
+            }
+            received_sdus_len[num_received_sdus++] = size;
+            if (num_receive_buffers > 1){
+                CHECK(num_held_sdus < num_receive_buffers);
+                held_sdus[num_held_sdus++] = packet;
+            }
+            break;
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case L2CAP_EVENT_LE_INCOMING_CONNECTION:
+                    local_cid = l2cap_event_le_incoming_connection_get_local_cid(packet);
+                    for (i = 1; i < num_receive_buffers; i++){
+                        CHECK_EQUAL(ERROR_CODE_SUCCESS, l2cap_le_add_receive_buffer(local_cid, receive_buffers[i]));
+                    }
+                    l2cap_le_accept_connection(local_cid, receive_buffers[0], LOCAL_MTU, initial_credits);
+                    break;
+                case L2CAP_EVENT_LE_CHANNEL_OPENED:
+                    CHECK_EQUAL(ERROR_CODE_SUCCESS, l2cap_event_le_channel_opened_get_status(packet));
+                    channel_opened = 1;
+                    break;
+                case L2CAP_EVENT_LE_CHANNEL_CLOSED:
+                    CHECK_EQUAL(local_cid, l2cap_event_le_channel_closed_get_local_cid(packet));
+                    num_le_channel_closed++;
+                    break;
+                case L2CAP_EVENT_CHANNEL_CLOSED:
+                    num_channel_closed++;
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void open_channel(void){
+    send_le_connection_request();
+    process_sent_packets();
+    CHECK_EQUAL(1, channel_opened);
+    CHECK_EQUAL(LOCAL_MPS, remote_mps);
+}
+
+static void release_held_sdus(void){
+    int i;
+    for (i = 0; i < num_held_sdus; i++){
+        CHECK_EQUAL(ERROR_CODE_SUCCESS, l2cap_le_release_receive_buffer(local_cid, held_sdus[i]));
+    }
+    num_held_sdus = 0;
+    process_sent_packets();
+}
+
+// single PDU SDUs after segmented ones
+static void queue_mixed_sdus(void){
+    static const uint16_t sdu_sizes[] = { LOCAL_MTU, 10, 10, 10, 10, 120, 1, LOCAL_MPS - 2, LOCAL_MPS - 1, 10, LOCAL_MTU, 20, 20, 20, 20, 20 };
+    unsigned int i;
+    for (i = 0; i < (sizeof(sdu_sizes) / sizeof(uint16_t)); i++){
+        remote_queue_sdu(sdu_sizes[i]);
+    }
+}
+
+static void receive_mixed_sdus(void){
+    queue_mixed_sdus();
+    open_channel();
+    int rounds = 0;
+    while (remote_sdu_index < remote_num_sdus){
+        CHECK(rounds++ < MAX_SDUS);
+        remote_send_pdus();
+        // all SDUs that the remote could send with its credits fit into the free receive buffers
+        CHECK(num_held_sdus <= NUM_RECEIVE_BUFFERS);
+        CHECK_EQUAL(remote_sdu_index, num_received_sdus);
+        release_held_sdus();
+    }
+    CHECK_EQUAL(remote_num_sdus, num_received_sdus);
+}
+
+TEST_GROUP(L2CAP_LE_DATA_CHANNEL){
+    void setup(void){
+        num_sent_packets    = 0;
+        num_received_sdus   = 0;
+        num_held_sdus       = 0;
+        channel_opened      = 0;
+        num_le_channel_closed = 0;
+        num_channel_closed  = 0;
+        num_receive_buffers = NUM_RECEIVE_BUFFERS;
+        initial_credits     = L2CAP_LE_ADAPTIVE_CREDITS;
+        remote_initial_credits = 10;
+        remote_credits      = 0;
+        remote_received_pdus = 0;
+        remote_disconnection_requests  = 0;
+        remote_disconnection_responses = 0;
+        remote_mps          = 0;
+        remote_num_sdus     = 0;
+        remote_sdu_index    = 0;
+        remote_sdu_pos      = 0;
+        btstack_run_loop_base_init();
+        hci_init(&hci_transport_test, NULL);
+        l2cap_init();
+        l2cap_set_max_le_mtu(LOCAL_MPS);
+        l2cap_le_register_service(&l2cap_channel_packet_handler, PSM_TEST, LEVEL_0);
+        hci_setup_test_connections_fuzz();
+        hci_simulate_working_fuzz();
+    }
+    void teardown(void){
+        send_disconnection_complete();
+        l2cap_le_unregister_service(PSM_TEST);
+        hci_free_connections_fuzz();
+    }
+};
+
+TEST(L2CAP_LE_DATA_CHANNEL, AdaptiveCreditsMixedSduSizes){
+    receive_mixed_sdus();
+}
+
+TEST(L2CAP_LE_DATA_CHANNEL, AutomaticCreditsMixedSduSizes){
+    initial_credits = L2CAP_LE_AUTOMATIC_CREDITS;
+    receive_mixed_sdus();
+}
+
+TEST(L2CAP_LE_DATA_CHANNEL, NoCreditsWithoutFreeReceiveBuffer){
+    // one PDU per SDU
+    int i;
+    for (i = 0; i < NUM_RECEIVE_BUFFERS + 2; i++){
+        remote_queue_sdu(10);
+    }
+    open_channel();
+    CHECK_EQUAL(NUM_RECEIVE_BUFFERS, remote_credits);
+    remote_send_pdus();
+    CHECK_EQUAL(NUM_RECEIVE_BUFFERS, num_held_sdus);
+    CHECK_EQUAL(0, remote_credits);
+
+    // credit for each released buffer
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, l2cap_le_release_receive_buffer(local_cid, held_sdus[0]));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, l2cap_le_release_receive_buffer(local_cid, held_sdus[1]));
+    process_sent_packets();
+    CHECK_EQUAL(2, remote_credits);
+}
+
+TEST(L2CAP_LE_DATA_CHANNEL, AutomaticCreditsSingleBuffer){
+    initial_credits     = L2CAP_LE_AUTOMATIC_CREDITS;
+    num_receive_buffers = 1;
+    queue_mixed_sdus();
+    open_channel();
+    CHECK_EQUAL(L2CAP_LE_AUTOMATIC_CREDITS, remote_credits);
+    remote_send_pdus();
+    CHECK_EQUAL(remote_num_sdus, num_received_sdus);
+
+    // unlimited credits granted already
+    CHECK_EQUAL(ERROR_CODE_COMMAND_DISALLOWED, l2cap_le_add_receive_buffer(local_cid, receive_buffers[1]));
+}
+
+TEST(L2CAP_LE_DATA_CHANNEL, LocalDisconnect){
+    open_channel();
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, l2cap_le_disconnect(local_cid));
+    process_sent_packets();
+    CHECK_EQUAL(1, remote_disconnection_requests);
+    CHECK_EQUAL(0, num_le_channel_closed);
+
+    // channel closed on response
+    send_disconnection(DISCONNECTION_RESPONSE, 0x02);
+    process_sent_packets();
+    CHECK_EQUAL(1, num_le_channel_closed);
+    CHECK_EQUAL(0, num_channel_closed);
+    CHECK_EQUAL(L2CAP_LOCAL_CID_DOES_NOT_EXIST, l2cap_le_disconnect(local_cid));
+}
+
+TEST(L2CAP_LE_DATA_CHANNEL, RemoteDisconnect){
+    open_channel();
+    send_disconnection(DISCONNECTION_REQUEST, 0x02);
+    process_sent_packets();
+    CHECK_EQUAL(1, remote_disconnection_responses);
+    CHECK_EQUAL(1, num_le_channel_closed);
+    CHECK_EQUAL(0, num_channel_closed);
+    CHECK_EQUAL(L2CAP_LOCAL_CID_DOES_NOT_EXIST, l2cap_le_disconnect(local_cid));
+}
+
+TEST(L2CAP_LE_DATA_CHANNEL, PendingSduResumedOnCredits){
+    remote_initial_credits = 2;
+    open_channel();
+
+    // SDU with 5 PDUs
+    static uint8_t sdu[LOCAL_MTU];
+    memset(sdu, 0x55, sizeof(sdu));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, l2cap_le_send_data(local_cid, sdu, sizeof(sdu)));
+    process_sent_packets();
+    CHECK_EQUAL(2, remote_received_pdus);
+
+    // rest of SDU sent without further HCI events
+    send_le_credits(10);
+    process_sent_packets();
+    CHECK_EQUAL(5, remote_received_pdus);
+}
+
+TEST(L2CAP_LE_DATA_CHANNEL, PduHeldBackForHigherPriorityConnection){
+    send_le_read_buffer_size_complete(4);
+    open_channel();
+    send_le_connection_complete(CON_HANDLE_AUDIO);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, hci_set_acl_tx_priority(CON_HANDLE_AUDIO, HCI_ACL_TX_PRIORITY_AUDIO));
+    hci_acl_tx_statistics_t statistics;
+    hci_get_acl_tx_statistics(CON_HANDLE, &statistics);
+    CHECK_EQUAL(1, statistics.packets_in_flight);
+
+    // SDU with 5 PDUs, last buffer left for audio connection
+    static uint8_t sdu[LOCAL_MTU];
+    memset(sdu, 0x55, sizeof(sdu));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, l2cap_le_send_data(local_cid, sdu, sizeof(sdu)));
+    process_sent_packets();
+    CHECK_EQUAL(2, remote_received_pdus);
+    hci_get_acl_tx_statistics(CON_HANDLE, &statistics);
+    CHECK_EQUAL(1, statistics.packets_deferred);
+
+    // resumed on completed packets
+    send_number_of_completed_packets(3);
+    process_sent_packets();
+    CHECK_EQUAL(5, remote_received_pdus);
+    hci_get_acl_tx_statistics(CON_HANDLE, &statistics);
+    CHECK_EQUAL(1, statistics.packets_deferred);
+}
+
+int main (int argc, const char * argv[]){
+    btstack_run_loop_init(&mock_run_loop);
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
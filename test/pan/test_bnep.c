@@ -0,0 +1,484 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include "bluetooth_psm.h"
+#include "bluetooth_sdp.h"
+#include "btstack_defines.h"
+#include "btstack_event.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_base.h"
+#include "btstack_util.h"
+#include "classic/bnep.h"
+#include "gap.h"
+#include "l2cap.h"
+
+#define BNEP_PKT_TYPE_CONTROL                       0x01
+#define BNEP_CONTROL_TYPE_SETUP_CONNECTION_REQUEST  0x01
+#define BNEP_CONTROL_TYPE_FILTER_NET_TYPE_SET       0x03
+#define BNEP_CONTROL_TYPE_FILTER_MULTI_ADDR_SET     0x05
+
+#define BNEP_NETWORK_PROTOCOL_TYPE_IPV4             0x0800
+#define BNEP_NETWORK_PROTOCOL_TYPE_ARP              0x0806
+#define BNEP_NETWORK_PROTOCOL_TYPE_IPV6             0x86DD
+
+#define NUM_CHANNELS 2
+
+static const bd_addr_t local_addr = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+
+// mock L2CAP
+
+static btstack_packet_handler_t l2cap_packet_handler;
+static uint8_t  l2cap_outgoing_buffer[1700];
+static int      l2cap_can_send_now_requested[NUM_CHANNELS];
+
+typedef struct {
+    uint16_t l2cap_cid;
+    uint16_t len;
+    uint8_t  data[64];
+} sent_packet_t;
+
+static sent_packet_t sent_packets[32];
+static int           sent_packets_count;
+
+static uint16_t l2cap_cid_for_index(int index){
+    return 0x41 + index;
+}
+
+uint8_t l2cap_register_service(btstack_packet_handler_t packet_handler, uint16_t psm, uint16_t mtu, gap_security_level_t security_level){
+    l2cap_packet_handler = packet_handler;
+    return ERROR_CODE_SUCCESS;
+}
+
+uint8_t l2cap_unregister_service(uint16_t psm){
+    return ERROR_CODE_SUCCESS;
+}
+
+uint8_t l2cap_create_channel(btstack_packet_handler_t packet_handler, bd_addr_t address, uint16_t psm, uint16_t mtu, uint16_t * out_local_cid){
+    return ERROR_CODE_SUCCESS;
+}
+
+void l2cap_accept_connection(uint16_t local_cid){
+}
+
+void l2cap_decline_connection(uint16_t local_cid){
+}
+
+void l2cap_disconnect(uint16_t local_cid, uint8_t reason){
+}
+
+uint16_t l2cap_max_mtu(void){
+    return 1691;
+}
+
+uint16_t l2cap_get_remote_mtu_for_local_cid(uint16_t local_cid){
+    return 1691;
+}
+
+int l2cap_can_send_packet_now(uint16_t local_cid){
+    return 1;
+}
+
+void l2cap_request_can_send_now_event(uint16_t local_cid){
+    l2cap_can_send_now_requested[local_cid - l2cap_cid_for_index(0)] = 1;
+}
+
+int l2cap_reserve_packet_buffer(void){
+    return 1;
+}
+
+void l2cap_release_packet_buffer(void){
+}
+
+uint8_t * l2cap_get_outgoing_buffer(void){
+    return l2cap_outgoing_buffer;
+}
+
+int l2cap_send_prepared(uint16_t local_cid, uint16_t len){
+    sent_packet_t * packet = &sent_packets[sent_packets_count++];
+    packet->l2cap_cid = local_cid;
+    packet->len = len;
+    memcpy(packet->data, l2cap_outgoing_buffer, btstack_min(len, sizeof(packet->data)));
+    return ERROR_CODE_SUCCESS;
+}
+
+gap_security_level_t gap_get_security_level(void){
+    return LEVEL_0;
+}
+
+void gap_local_bd_addr(bd_addr_t address_buffer){
+    bd_addr_copy(address_buffer, local_addr);
+}
+
+// emit single can send now event if requested, @returns 1 if event was emitted
+static int l2cap_can_send_now(int index){
+    if (l2cap_can_send_now_requested[index] == 0) return 0;
+    l2cap_can_send_now_requested[index] = 0;
+    uint8_t event[4];
+    event[0] = L2CAP_EVENT_CAN_SEND_NOW;
+    event[1] = 2;
+    little_endian_store_16(event, 2, l2cap_cid_for_index(index));
+    (*l2cap_packet_handler)(HCI_EVENT_PACKET, 0, event, sizeof(event));
+    return 1;
+}
+
+static void l2cap_can_send_now_all(void){
+    int emitted = 1;
+    while (emitted){
+        emitted = 0;
+        int i;
+        for (i = 0; i < NUM_CHANNELS; i++){
+            emitted |= l2cap_can_send_now(i);
+        }
+    }
+}
+
+// mock run loop without time
+
+static void mock_run_loop_init(void){
+    btstack_run_loop_base_init();
+}
+
+static void mock_run_loop_set_timer(btstack_timer_source_t * ts, uint32_t timeout_in_ms){
+    ts->timeout = timeout_in_ms;
+}
+
+static uint32_t mock_run_loop_get_time_ms(void){
+    return 0;
+}
+
+static const btstack_run_loop_t mock_run_loop = {
+    &mock_run_loop_init,
+    &btstack_run_loop_base_add_data_source,
+    &btstack_run_loop_base_remove_data_source,
+    &btstack_run_loop_base_enable_data_source_callbacks,
+    &btstack_run_loop_base_disable_data_source_callbacks,
+    &mock_run_loop_set_timer,
+    &btstack_run_loop_base_add_timer,
+    &btstack_run_loop_base_remove_timer,
+    NULL,
+    NULL,
+    &mock_run_loop_get_time_ms,
+};
+
+// application
+
+static int app_can_send_now_count;
+
+static void app_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    if (packet_type != HCI_EVENT_PACKET) return;
+    if (hci_event_packet_get_type(packet) != BNEP_EVENT_CAN_SEND_NOW) return;
+    app_can_send_now_count++;
+    // mark in sent packets
+    sent_packets[sent_packets_count].l2cap_cid = 0;
+    sent_packets[sent_packets_count].len = 0;
+    sent_packets_count++;
+}
+
+// shared frames
+
+static int frames_released;
+
+static void frame_release_handler(bnep_shared_frame_t * frame){
+    frames_released++;
+}
+
+static uint8_t frame_data[8][14 + 4];
+static bnep_shared_frame_t frames[8];
+
+static bnep_shared_frame_t * create_frame(int index, const bd_addr_t dest, uint16_t network_protocol_type){
+    uint8_t * data = frame_data[index];
+    memcpy(&data[0], dest, 6);
+    memcpy(&data[6], local_addr, 6);
+    big_endian_store_16(data, 12, network_protocol_type);
+    memset(&data[14], index, 4);
+    bnep_shared_frame_t * frame = &frames[index];
+    frame->ref_count = 1;
+    frame->data = data;
+    frame->len = sizeof(frame_data[0]);
+    frame->release_handler = &frame_release_handler;
+    return frame;
+}
+
+// remote device
+
+static void remote_connect(int index){
+    uint16_t l2cap_cid = l2cap_cid_for_index(index);
+    bd_addr_t remote_addr = { 0x02, 0x00, 0x00, 0x00, 0x01, 0x00 };
+    remote_addr[5] = (uint8_t) index;
+
+    uint8_t incoming[16];
+    memset(incoming, 0, sizeof(incoming));
+    incoming[0] = L2CAP_EVENT_INCOMING_CONNECTION;
+    incoming[1] = sizeof(incoming) - 2;
+    reverse_bd_addr(remote_addr, &incoming[2]);
+    little_endian_store_16(incoming, 8, 0x0b00 + index);
+    little_endian_store_16(incoming, 10, BLUETOOTH_PSM_BNEP);
+    little_endian_store_16(incoming, 12, l2cap_cid);
+    (*l2cap_packet_handler)(HCI_EVENT_PACKET, 0, incoming, sizeof(incoming));
+
+    uint8_t opened[26];
+    memset(opened, 0, sizeof(opened));
+    opened[0] = L2CAP_EVENT_CHANNEL_OPENED;
+    opened[1] = sizeof(opened) - 2;
+    reverse_bd_addr(remote_addr, &opened[3]);
+    little_endian_store_16(opened, 9, 0x0b00 + index);
+    little_endian_store_16(opened, 11, BLUETOOTH_PSM_BNEP);
+    little_endian_store_16(opened, 13, l2cap_cid);
+    little_endian_store_16(opened, 17, 1691);
+    (*l2cap_packet_handler)(HCI_EVENT_PACKET, 0, opened, sizeof(opened));
+
+    uint8_t request[] = { BNEP_PKT_TYPE_CONTROL, BNEP_CONTROL_TYPE_SETUP_CONNECTION_REQUEST, 2, 0, 0, 0, 0 };
+    big_endian_store_16(request, 3, BLUETOOTH_SERVICE_CLASS_NAP);
+    big_endian_store_16(request, 5, BLUETOOTH_SERVICE_CLASS_PANU);
+    (*l2cap_packet_handler)(L2CAP_DATA_PACKET, l2cap_cid, request, sizeof(request));
+    l2cap_can_send_now_all();
+}
+
+static void remote_disconnect(int index){
+    uint8_t event[4];
+    event[0] = L2CAP_EVENT_CHANNEL_CLOSED;
+    event[1] = 2;
+    little_endian_store_16(event, 2, l2cap_cid_for_index(index));
+    (*l2cap_packet_handler)(HCI_EVENT_PACKET, 0, event, sizeof(event));
+}
+
+static void remote_set_net_type_filter(int index, const uint16_t * ranges, int num_ranges){
+    uint8_t request[4 + MAX_BNEP_NETFILTER * 4];
+    request[0] = BNEP_PKT_TYPE_CONTROL;
+    request[1] = BNEP_CONTROL_TYPE_FILTER_NET_TYPE_SET;
+    big_endian_store_16(request, 2, num_ranges * 4);
+    int i;
+    for (i = 0; i < num_ranges * 2; i++){
+        big_endian_store_16(request, 4 + (i * 2), ranges[i]);
+    }
+    (*l2cap_packet_handler)(L2CAP_DATA_PACKET, l2cap_cid_for_index(index), request, 4 + (num_ranges * 4));
+    l2cap_can_send_now_all();
+}
+
+static void remote_set_multicast_filter(int index, const bd_addr_t * ranges, int num_ranges){
+    uint8_t request[4 + MAX_BNEP_MULTICAST_FILTER * 12];
+    request[0] = BNEP_PKT_TYPE_CONTROL;
+    request[1] = BNEP_CONTROL_TYPE_FILTER_MULTI_ADDR_SET;
+    big_endian_store_16(request, 2, num_ranges * 12);
+    int i;
+    for (i = 0; i < num_ranges * 2; i++){
+        memcpy(&request[4 + (i * 6)], ranges[i], 6);
+    }
+    (*l2cap_packet_handler)(L2CAP_DATA_PACKET, l2cap_cid_for_index(index), request, 4 + (num_ranges * 12));
+    l2cap_can_send_now_all();
+}
+
+static const bd_addr_t addr_broadcast = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+static const bd_addr_t addr_unicast   = { 0x02, 0x00, 0x00, 0x00, 0x02, 0x00 };
+
+// @returns 1 if frame passes filter of channel
+static int frame_passes(int index, const bd_addr_t dest, uint16_t network_protocol_type){
+    bnep_shared_frame_t * frame = create_frame(7, dest, network_protocol_type);
+    int queued = bnep_send_shared_frame(l2cap_cid_for_index(index), frame) == 0 ? (frame->ref_count - 1) : 0;
+    l2cap_can_send_now_all();
+    bnep_shared_frame_release(frame);
+    return queued;
+}
+
+TEST_GROUP(BNEP){
+    void setup(void){
+        memset(l2cap_can_send_now_requested, 0, sizeof(l2cap_can_send_now_requested));
+        sent_packets_count = 0;
+        app_can_send_now_count = 0;
+        frames_released = 0;
+        bnep_init();
+        bnep_register_service(&app_packet_handler, BLUETOOTH_SERVICE_CLASS_NAP, 1691);
+        int i;
+        for (i = 0; i < NUM_CHANNELS; i++){
+            remote_connect(i);
+        }
+        sent_packets_count = 0;
+    }
+    void teardown(void){
+        int i;
+        for (i = 0; i < NUM_CHANNELS; i++){
+            remote_disconnect(i);
+        }
+        bnep_unregister_service(BLUETOOTH_SERVICE_CLASS_NAP);
+    }
+};
+
+TEST(BNEP, NoFilter){
+    CHECK_EQUAL(1, frame_passes(0, addr_unicast, 0x1234));
+    CHECK_EQUAL(1, frame_passes(0, addr_broadcast, 0x1234));
+}
+
+TEST(BNEP, NetTypeFilterOverlappingRanges){
+    const uint16_t ranges[] = {
+        0x0900, 0x0a00,
+        0x0800, 0x0805,     // contains IPv4 and ARP
+        0x0802, 0x0900,     // overlaps both
+        0x8000, 0x80f0,
+        0x8050, 0x8060,     // contained in previous
+    };
+    remote_set_net_type_filter(0, ranges, 5);
+    CHECK_EQUAL(0, frame_passes(0, addr_unicast, 0x07ff));
+    CHECK_EQUAL(1, frame_passes(0, addr_unicast, BNEP_NETWORK_PROTOCOL_TYPE_IPV4));
+    CHECK_EQUAL(1, frame_passes(0, addr_unicast, BNEP_NETWORK_PROTOCOL_TYPE_ARP));
+    CHECK_EQUAL(1, frame_passes(0, addr_unicast, 0x0901));
+    CHECK_EQUAL(1, frame_passes(0, addr_unicast, 0x0a00));
+    CHECK_EQUAL(0, frame_passes(0, addr_unicast, 0x0a01));
+    CHECK_EQUAL(0, frame_passes(0, addr_unicast, 0x7fff));
+    CHECK_EQUAL(1, frame_passes(0, addr_unicast, 0x8055));
+    CHECK_EQUAL(1, frame_passes(0, addr_unicast, 0x80f0));
+    CHECK_EQUAL(0, frame_passes(0, addr_unicast, 0x80f1));
+    CHECK_EQUAL(0, frame_passes(0, addr_unicast, BNEP_NETWORK_PROTOCOL_TYPE_IPV6));
+    // other channel not affected
+    CHECK_EQUAL(1, frame_passes(1, addr_unicast, BNEP_NETWORK_PROTOCOL_TYPE_IPV6));
+}
+
+TEST(BNEP, NetTypeFilterAdjacentRanges){
+    const uint16_t ranges[] = {
+        0x86de, 0x86dd,     // invalid, ignored
+        0x86de, 0x86df,
+        0x86dd, 0x86dd,     // IPv6, adjacent to previous
+        0x0806, 0x0806,     // ARP
+        0x0800, 0x0800,     // IPv4, not adjacent to ARP
+    };
+    remote_set_net_type_filter(0, ranges, 5);
+    CHECK_EQUAL(1, frame_passes(0, addr_unicast, BNEP_NETWORK_PROTOCOL_TYPE_IPV6));
+    CHECK_EQUAL(1, frame_passes(0, addr_unicast, 0x86de));
+    CHECK_EQUAL(1, frame_passes(0, addr_unicast, 0x86df));
+    CHECK_EQUAL(0, frame_passes(0, addr_unicast, 0x86dc));
+    CHECK_EQUAL(0, frame_passes(0, addr_unicast, 0x86e0));
+    CHECK_EQUAL(1, frame_passes(0, addr_unicast, BNEP_NETWORK_PROTOCOL_TYPE_ARP));
+    CHECK_EQUAL(1, frame_passes(0, addr_unicast, BNEP_NETWORK_PROTOCOL_TYPE_IPV4));
+    CHECK_EQUAL(0, frame_passes(0, addr_unicast, 0x0801));
+    CHECK_EQUAL(0, frame_passes(0, addr_unicast, 0x0805));
+}
+
+TEST(BNEP, MulticastFilterOverlappingAndAdjacentRanges){
+    const bd_addr_t ranges[] = {
+        { 0x01, 0x00, 0x5e, 0x00, 0x00, 0x10 }, { 0x01, 0x00, 0x5e, 0x00, 0x00, 0x20 },
+        { 0x01, 0x00, 0x5e, 0x00, 0x00, 0x00 }, { 0x01, 0x00, 0x5e, 0x00, 0x00, 0x18 },  // overlaps previous
+        { 0x01, 0x00, 0x5e, 0x00, 0x00, 0x21 }, { 0x01, 0x00, 0x5e, 0x00, 0x00, 0x21 },  // adjacent
+        { 0x33, 0x33, 0x00, 0x00, 0x00, 0x01 }, { 0x33, 0x33, 0x00, 0x00, 0x00, 0x01 },
+    };
+    remote_set_multicast_filter(0, ranges, 4);
+    const bd_addr_t inside_overlap = { 0x01, 0x00, 0x5e, 0x00, 0x00, 0x14 };
+    const bd_addr_t adjacent       = { 0x01, 0x00, 0x5e, 0x00, 0x00, 0x21 };
+    const bd_addr_t after          = { 0x01, 0x00, 0x5e, 0x00, 0x00, 0x22 };
+    const bd_addr_t ipv6_all_nodes = { 0x33, 0x33, 0x00, 0x00, 0x00, 0x01 };
+    const bd_addr_t ipv6_other     = { 0x33, 0x33, 0x00, 0x00, 0x00, 0x02 };
+    CHECK_EQUAL(1, frame_passes(0, ranges[2], BNEP_NETWORK_PROTOCOL_TYPE_IPV4));
+    CHECK_EQUAL(1, frame_passes(0, inside_overlap, BNEP_NETWORK_PROTOCOL_TYPE_IPV4));
+    CHECK_EQUAL(1, frame_passes(0, ranges[1], BNEP_NETWORK_PROTOCOL_TYPE_IPV4));
+    CHECK_EQUAL(1, frame_passes(0, adjacent, BNEP_NETWORK_PROTOCOL_TYPE_IPV4));
+    CHECK_EQUAL(0, frame_passes(0, after, BNEP_NETWORK_PROTOCOL_TYPE_IPV4));
+    CHECK_EQUAL(1, frame_passes(0, ipv6_all_nodes, BNEP_NETWORK_PROTOCOL_TYPE_IPV6));
+    CHECK_EQUAL(0, frame_passes(0, ipv6_other, BNEP_NETWORK_PROTOCOL_TYPE_IPV6));
+    // broadcast not in filter, unicast not filtered
+    CHECK_EQUAL(0, frame_passes(0, addr_broadcast, BNEP_NETWORK_PROTOCOL_TYPE_IPV4));
+    CHECK_EQUAL(1, frame_passes(0, addr_unicast, BNEP_NETWORK_PROTOCOL_TYPE_IPV4));
+}
+
+TEST(BNEP, SharedFrameReleasedAfterSentOnAllChannels){
+    bnep_shared_frame_t * frame = create_frame(0, addr_broadcast, BNEP_NETWORK_PROTOCOL_TYPE_IPV4);
+    CHECK_EQUAL(NUM_CHANNELS, bnep_broadcast_shared_frame(frame, 0, NULL));
+    bnep_shared_frame_release(frame);
+    CHECK_EQUAL(NUM_CHANNELS, frame->ref_count);
+
+    CHECK_EQUAL(1, l2cap_can_send_now(0));
+    CHECK_EQUAL(1, frame->ref_count);
+    CHECK_EQUAL(0, frames_released);
+
+    CHECK_EQUAL(1, l2cap_can_send_now(1));
+    CHECK_EQUAL(0, frame->ref_count);
+    CHECK_EQUAL(1, frames_released);
+
+    CHECK_EQUAL(2, sent_packets_count);
+    CHECK_EQUAL(l2cap_cid_for_index(0), sent_packets[0].l2cap_cid);
+    CHECK_EQUAL(l2cap_cid_for_index(1), sent_packets[1].l2cap_cid);
+}
+
+TEST(BNEP, SharedFrameBroadcastExcludesChannel){
+    bnep_shared_frame_t * frame = create_frame(0, addr_broadcast, BNEP_NETWORK_PROTOCOL_TYPE_IPV4);
+    CHECK_EQUAL(1, bnep_broadcast_shared_frame(frame, l2cap_cid_for_index(0), NULL));
+    bnep_shared_frame_release(frame);
+    l2cap_can_send_now_all();
+    CHECK_EQUAL(1, frames_released);
+    CHECK_EQUAL(1, sent_packets_count);
+    CHECK_EQUAL(l2cap_cid_for_index(1), sent_packets[0].l2cap_cid);
+}
+
+TEST(BNEP, SharedFrameReleasedOnChannelClose){
+    bnep_shared_frame_t * frame = create_frame(0, addr_broadcast, BNEP_NETWORK_PROTOCOL_TYPE_IPV4);
+    bnep_broadcast_shared_frame(frame, 0, NULL);
+    bnep_shared_frame_release(frame);
+    l2cap_can_send_now(0);
+    CHECK_EQUAL(0, frames_released);
+    remote_disconnect(1);
+    CHECK_EQUAL(1, frames_released);
+    CHECK_EQUAL(0, frame->ref_count);
+}
+
+TEST(BNEP, SharedFrameQueueFull){
+    int i;
+    for (i = 0; i < BNEP_SHARED_FRAME_QUEUE_SIZE; i++){
+        bnep_shared_frame_t * frame = create_frame(i, addr_broadcast, BNEP_NETWORK_PROTOCOL_TYPE_IPV4);
+        CHECK_EQUAL(0, bnep_send_shared_frame(l2cap_cid_for_index(0), frame));
+        bnep_shared_frame_release(frame);
+    }
+    bnep_shared_frame_t * frame = create_frame(BNEP_SHARED_FRAME_QUEUE_SIZE, addr_broadcast, BNEP_NETWORK_PROTOCOL_TYPE_IPV4);
+    CHECK_EQUAL(BTSTACK_ACL_BUFFERS_FULL, bnep_send_shared_frame(l2cap_cid_for_index(0), frame));
+    CHECK_EQUAL(1, frame->ref_count);
+    // broadcast reports channel with full queue
+    uint16_t num_dropped = 0;
+    CHECK_EQUAL(1, bnep_broadcast_shared_frame(frame, 0, &num_dropped));
+    CHECK_EQUAL(1, num_dropped);
+    bnep_shared_frame_release(frame);
+    CHECK_EQUAL(0, frames_released);
+    l2cap_can_send_now_all();
+    CHECK_EQUAL(BNEP_SHARED_FRAME_QUEUE_SIZE + 1, frames_released);
+}
+
+TEST(BNEP, SharedFramesAlternateWithApplication){
+    int i;
+    for (i = 0; i < 3; i++){
+        bnep_shared_frame_t * frame = create_frame(i, addr_broadcast, BNEP_NETWORK_PROTOCOL_TYPE_IPV4);
+        bnep_send_shared_frame(l2cap_cid_for_index(0), frame);
+        bnep_shared_frame_release(frame);
+    }
+    bnep_request_can_send_now_event(l2cap_cid_for_index(0));
+    l2cap_can_send_now_all();
+    CHECK_EQUAL(1, app_can_send_now_count);
+    CHECK_EQUAL(3, frames_released);
+    // shared frame, application, remaining shared frames
+    CHECK_EQUAL(4, sent_packets_count);
+    CHECK_EQUAL(l2cap_cid_for_index(0), sent_packets[0].l2cap_cid);
+    CHECK_EQUAL(0, sent_packets[1].l2cap_cid);
+    CHECK_EQUAL(l2cap_cid_for_index(0), sent_packets[2].l2cap_cid);
+    CHECK_EQUAL(l2cap_cid_for_index(0), sent_packets[3].l2cap_cid);
+}
+
+TEST(BNEP, ApplicationNotStarvedBySharedFrames){
+    int i;
+    int app_turns = 0;
+    for (i = 0; i < 6; i++){
+        bnep_shared_frame_t * frame = create_frame(i % BNEP_SHARED_FRAME_QUEUE_SIZE, addr_broadcast, BNEP_NETWORK_PROTOCOL_TYPE_IPV4);
+        bnep_send_shared_frame(l2cap_cid_for_index(0), frame);
+        bnep_shared_frame_release(frame);
+        if (app_can_send_now_count == app_turns){
+            bnep_request_can_send_now_event(l2cap_cid_for_index(0));
+        }
+        l2cap_can_send_now(0);
+        app_turns = app_can_send_now_count;
+    }
+    // application gets every other can send now while shared frames are queued
+    CHECK_EQUAL(3, app_can_send_now_count);
+}
+
+int main (int argc, const char * argv[]){
+    btstack_run_loop_init(&mock_run_loop);
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
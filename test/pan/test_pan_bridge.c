@@ -0,0 +1,392 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include "bluetooth_sdp.h"
+#include "btstack_defines.h"
+#include "btstack_event.h"
+#include "btstack_util.h"
+#include "classic/bnep.h"
+#include "classic/pan_bridge.h"
+
+// mock BNEP channels
+
+#define MOCK_NUM_CHANNELS   3
+#define MOCK_QUEUE_SIZE     16
+
+typedef struct {
+    uint16_t              bnep_cid;
+    int                   connected;
+    bnep_shared_frame_t * queue[MOCK_QUEUE_SIZE];
+    int                   queue_count;
+    int                   queue_full;
+} mock_channel_t;
+
+static mock_channel_t mock_channels[MOCK_NUM_CHANNELS];
+static btstack_packet_handler_t bridge_packet_handler;
+static uint32_t mock_time_ms;
+
+static mock_channel_t * mock_channel_for_cid(uint16_t bnep_cid){
+    int i;
+    for (i = 0; i < MOCK_NUM_CHANNELS; i++){
+        if (mock_channels[i].bnep_cid == bnep_cid) return &mock_channels[i];
+    }
+    return NULL;
+}
+
+uint32_t btstack_run_loop_get_time_ms(void){
+    return mock_time_ms;
+}
+
+uint8_t bnep_register_service(btstack_packet_handler_t packet_handler, uint16_t service_uuid, uint16_t max_frame_size){
+    bridge_packet_handler = packet_handler;
+    return ERROR_CODE_SUCCESS;
+}
+
+void bnep_shared_frame_retain(bnep_shared_frame_t * frame){
+    frame->ref_count++;
+}
+
+void bnep_shared_frame_release(bnep_shared_frame_t * frame){
+    CHECK(frame->ref_count > 0);
+    frame->ref_count--;
+    if (frame->ref_count > 0) return;
+    if (frame->release_handler == NULL) return;
+    (*frame->release_handler)(frame);
+}
+
+int bnep_send_shared_frame(uint16_t bnep_cid, bnep_shared_frame_t * frame){
+    mock_channel_t * channel = mock_channel_for_cid(bnep_cid);
+    if ((channel == NULL) || (channel->connected == 0)) return BNEP_CHANNEL_NOT_CONNECTED;
+    if (channel->queue_full || (channel->queue_count == MOCK_QUEUE_SIZE)) return BTSTACK_ACL_BUFFERS_FULL;
+    bnep_shared_frame_retain(frame);
+    channel->queue[channel->queue_count++] = frame;
+    return 0;
+}
+
+int bnep_broadcast_shared_frame(bnep_shared_frame_t * frame, uint16_t exclude_bnep_cid, uint16_t * out_num_dropped){
+    int count = 0;
+    uint16_t num_dropped = 0;
+    int i;
+    for (i = 0; i < MOCK_NUM_CHANNELS; i++){
+        if (mock_channels[i].bnep_cid == exclude_bnep_cid) continue;
+        if (mock_channels[i].connected == 0) continue;
+        if (bnep_send_shared_frame(mock_channels[i].bnep_cid, frame) == 0){
+            count++;
+        } else {
+            num_dropped++;
+        }
+    }
+    if (out_num_dropped != NULL){
+        *out_num_dropped = num_dropped;
+    }
+    return count;
+}
+
+// complete sending of oldest queued frame
+static void mock_channel_send(uint16_t bnep_cid){
+    mock_channel_t * channel = mock_channel_for_cid(bnep_cid);
+    CHECK(channel->queue_count > 0);
+    bnep_shared_frame_t * frame = channel->queue[0];
+    channel->queue_count--;
+    memmove(&channel->queue[0], &channel->queue[1], channel->queue_count * sizeof(bnep_shared_frame_t *));
+    bnep_shared_frame_release(frame);
+}
+
+static void mock_channel_close(uint16_t bnep_cid){
+    mock_channel_t * channel = mock_channel_for_cid(bnep_cid);
+    while (channel->queue_count > 0){
+        mock_channel_send(bnep_cid);
+    }
+    channel->connected = 0;
+    uint8_t event[4];
+    event[0] = BNEP_EVENT_CHANNEL_CLOSED;
+    event[1] = 2;
+    little_endian_store_16(event, 2, bnep_cid);
+    (*bridge_packet_handler)(HCI_EVENT_PACKET, 0, event, sizeof(event));
+}
+
+// mock network interface
+
+static int network_received_frames;
+static uint8_t network_last_frame[PAN_BRIDGE_MAX_FRAME_SIZE];
+static int network_packet_sent_count;
+
+static void network_process_packet(const uint8_t * packet, uint16_t size){
+    network_received_frames++;
+    memcpy(network_last_frame, packet, size);
+}
+
+static void network_packet_sent(void){
+    network_packet_sent_count++;
+}
+
+static const pan_bridge_network_t network = {
+    &network_process_packet,
+    &network_packet_sent,
+};
+
+static const bd_addr_t network_addr   = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+static const bd_addr_t addr_a         = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x0a };
+static const bd_addr_t addr_b         = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x0b };
+static const bd_addr_t addr_unknown   = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x0f };
+static const bd_addr_t addr_broadcast = { 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
+
+static uint8_t frames[32][64];
+static int     frame_index;
+
+static uint8_t * create_frame(const bd_addr_t dest, const bd_addr_t src){
+    uint8_t * frame = frames[frame_index++ % 32];
+    memcpy(&frame[0], dest, 6);
+    memcpy(&frame[6], src, 6);
+    big_endian_store_16(frame, 12, 0x0800);
+    memset(&frame[14], frame_index, sizeof(frames[0]) - 14);
+    return frame;
+}
+
+static void channel_receive(uint16_t bnep_cid, const bd_addr_t dest, const bd_addr_t src){
+    (*bridge_packet_handler)(BNEP_DATA_PACKET, bnep_cid, create_frame(dest, src), sizeof(frames[0]));
+}
+
+static int queued(uint16_t bnep_cid){
+    return mock_channel_for_cid(bnep_cid)->queue_count;
+}
+
+TEST_GROUP(PANBridge){
+    void setup(void){
+        int i;
+        memset(mock_channels, 0, sizeof(mock_channels));
+        for (i = 0; i < MOCK_NUM_CHANNELS; i++){
+            mock_channels[i].bnep_cid = 0x41 + i;
+            mock_channels[i].connected = 1;
+        }
+        mock_time_ms = 1000;
+        network_received_frames = 0;
+        network_packet_sent_count = 0;
+        frame_index = 0;
+        pan_bridge_init(&network, network_addr);
+        pan_bridge_register_service(BLUETOOTH_SERVICE_CLASS_NAP, PAN_BRIDGE_MAX_FRAME_SIZE);
+    }
+};
+
+TEST(PANBridge, BroadcastIsFlooded){
+    channel_receive(0x41, addr_broadcast, addr_a);
+    CHECK_EQUAL(1, network_received_frames);
+    CHECK_EQUAL(0, queued(0x41));
+    CHECK_EQUAL(1, queued(0x42));
+    CHECK_EQUAL(1, queued(0x43));
+    // single copy shared by both channels
+    POINTERS_EQUAL(mock_channels[1].queue[0], mock_channels[2].queue[0]);
+    CHECK_EQUAL(2, mock_channels[1].queue[0]->ref_count);
+}
+
+TEST(PANBridge, UnknownUnicastIsFlooded){
+    channel_receive(0x41, addr_unknown, addr_a);
+    CHECK_EQUAL(1, network_received_frames);
+    CHECK_EQUAL(1, queued(0x42));
+    CHECK_EQUAL(1, queued(0x43));
+}
+
+TEST(PANBridge, UnicastBetweenChannels){
+    channel_receive(0x41, addr_broadcast, addr_a);
+    mock_channel_send(0x42);
+    mock_channel_send(0x43);
+    channel_receive(0x42, addr_a, addr_b);
+    // learned address: only channel 0x41, network interface not involved
+    CHECK_EQUAL(1, network_received_frames);
+    CHECK_EQUAL(1, queued(0x41));
+    CHECK_EQUAL(0, queued(0x42));
+    CHECK_EQUAL(0, queued(0x43));
+    MEMCMP_EQUAL(addr_b, &mock_channels[0].queue[0]->data[6], 6);
+}
+
+TEST(PANBridge, UnicastToSameChannelIsDropped){
+    channel_receive(0x41, addr_broadcast, addr_a);
+    channel_receive(0x41, addr_broadcast, addr_b);
+    mock_channel_send(0x42);
+    mock_channel_send(0x42);
+    mock_channel_send(0x43);
+    mock_channel_send(0x43);
+    channel_receive(0x41, addr_a, addr_b);
+    CHECK_EQUAL(2, network_received_frames);
+    CHECK_EQUAL(0, queued(0x41));
+    CHECK_EQUAL(0, queued(0x42));
+    CHECK_EQUAL(0, queued(0x43));
+}
+
+TEST(PANBridge, UnicastToNetwork){
+    channel_receive(0x41, network_addr, addr_a);
+    CHECK_EQUAL(1, network_received_frames);
+    CHECK_EQUAL(0, queued(0x42));
+    CHECK_EQUAL(0, queued(0x43));
+}
+
+TEST(PANBridge, LearnedAddressAgesOut){
+    channel_receive(0x41, addr_broadcast, addr_a);
+    mock_channel_send(0x42);
+    mock_channel_send(0x43);
+    mock_time_ms += PAN_BRIDGE_MAC_TABLE_TIMEOUT_MS + 1;
+    channel_receive(0x42, addr_a, addr_b);
+    CHECK_EQUAL(2, network_received_frames);
+    CHECK_EQUAL(1, queued(0x41));
+    CHECK_EQUAL(1, queued(0x43));
+}
+
+TEST(PANBridge, AddressRefreshedBeforeTimeout){
+    channel_receive(0x41, addr_broadcast, addr_a);
+    mock_time_ms += PAN_BRIDGE_MAC_TABLE_TIMEOUT_MS;
+    channel_receive(0x41, network_addr, addr_a);
+    mock_time_ms += PAN_BRIDGE_MAC_TABLE_TIMEOUT_MS;
+    channel_receive(0x42, addr_a, addr_b);
+    CHECK_EQUAL(1, queued(0x41));
+    CHECK_EQUAL(1, queued(0x43));
+}
+
+TEST(PANBridge, StationMovesToOtherChannel){
+    channel_receive(0x41, addr_broadcast, addr_a);
+    channel_receive(0x43, network_addr, addr_a);
+    channel_receive(0x42, addr_a, addr_b);
+    CHECK_EQUAL(0, queued(0x41));
+    CHECK_EQUAL(2, queued(0x43));
+}
+
+TEST(PANBridge, ChannelClosedForgetsAddresses){
+    channel_receive(0x41, addr_broadcast, addr_a);
+    mock_channel_close(0x41);
+    channel_receive(0x42, addr_a, addr_b);
+    // flooded
+    CHECK_EQUAL(2, network_received_frames);
+    CHECK_EQUAL(2, queued(0x43));
+}
+
+TEST(PANBridge, NetworkFrameSharedWithoutCopy){
+    channel_receive(0x41, addr_broadcast, addr_a);
+    mock_channel_send(0x42);
+    mock_channel_send(0x43);
+    uint8_t * frame = create_frame(addr_a, network_addr);
+    pan_bridge_network_send_packet(frame, sizeof(frames[0]));
+    CHECK_EQUAL(1, queued(0x41));
+    CHECK_EQUAL(0, queued(0x42));
+    POINTERS_EQUAL(frame, mock_channels[0].queue[0]->data);
+    // packet_sent when frame was sent
+    CHECK_EQUAL(0, network_packet_sent_count);
+    mock_channel_send(0x41);
+    CHECK_EQUAL(1, network_packet_sent_count);
+}
+
+TEST(PANBridge, NetworkBroadcastReleasedByLastChannel){
+    uint8_t * frame = create_frame(addr_broadcast, network_addr);
+    pan_bridge_network_send_packet(frame, sizeof(frames[0]));
+    CHECK_EQUAL(1, queued(0x41));
+    CHECK_EQUAL(1, queued(0x42));
+    CHECK_EQUAL(1, queued(0x43));
+    mock_channel_send(0x41);
+    mock_channel_send(0x42);
+    CHECK_EQUAL(0, network_packet_sent_count);
+    mock_channel_send(0x43);
+    CHECK_EQUAL(1, network_packet_sent_count);
+}
+
+TEST(PANBridge, NetworkFrameToNetworkAddress){
+    pan_bridge_network_send_packet(create_frame(network_addr, addr_a), sizeof(frames[0]));
+    CHECK_EQUAL(1, network_packet_sent_count);
+    CHECK_EQUAL(0, queued(0x41));
+}
+
+TEST(PANBridge, NetworkFrameWhilePreviousQueuedIsCopied){
+    uint8_t * frame_1 = create_frame(addr_broadcast, network_addr);
+    pan_bridge_network_send_packet(frame_1, sizeof(frames[0]));
+    CHECK_EQUAL(0, network_packet_sent_count);
+    uint8_t * frame_2 = create_frame(addr_broadcast, network_addr);
+    pan_bridge_network_send_packet(frame_2, sizeof(frames[0]));
+    // second frame copied, caller can reuse it
+    CHECK_EQUAL(1, network_packet_sent_count);
+    CHECK_EQUAL(0, pan_bridge_get_dropped_frames());
+    CHECK_EQUAL(2, queued(0x41));
+    CHECK(mock_channels[0].queue[1]->data != frame_2);
+    MEMCMP_EQUAL(frame_2, mock_channels[0].queue[1]->data, sizeof(frames[0]));
+    // first frame reported when sent by all channels
+    mock_channel_send(0x41);
+    mock_channel_send(0x42);
+    mock_channel_send(0x43);
+    CHECK_EQUAL(2, network_packet_sent_count);
+}
+
+TEST(PANBridge, FramePoolExhausted){
+    int i;
+    for (i = 0; i < PAN_BRIDGE_FRAME_POOL_SIZE; i++){
+        channel_receive(0x41, addr_broadcast, addr_a);
+    }
+    CHECK_EQUAL(0, pan_bridge_get_dropped_frames());
+    CHECK_EQUAL(PAN_BRIDGE_FRAME_POOL_SIZE, queued(0x42));
+
+    // network interface still gets frame, channels don't
+    channel_receive(0x41, addr_broadcast, addr_a);
+    CHECK_EQUAL(1, pan_bridge_get_dropped_frames());
+    CHECK_EQUAL(PAN_BRIDGE_FRAME_POOL_SIZE + 1, network_received_frames);
+    CHECK_EQUAL(PAN_BRIDGE_FRAME_POOL_SIZE, queued(0x42));
+
+    // buffer is free after all channels sent it
+    mock_channel_send(0x42);
+    channel_receive(0x41, addr_broadcast, addr_a);
+    CHECK_EQUAL(2, pan_bridge_get_dropped_frames());
+    mock_channel_send(0x43);
+    channel_receive(0x41, addr_broadcast, addr_a);
+    CHECK_EQUAL(2, pan_bridge_get_dropped_frames());
+    CHECK_EQUAL(PAN_BRIDGE_FRAME_POOL_SIZE, queued(0x42));
+}
+
+TEST(PANBridge, NetworkFrameDroppedWhenPoolExhausted){
+    int i;
+    for (i = 0; i < PAN_BRIDGE_FRAME_POOL_SIZE; i++){
+        channel_receive(0x41, addr_broadcast, addr_a);
+    }
+    pan_bridge_network_send_packet(create_frame(addr_broadcast, network_addr), sizeof(frames[0]));
+    CHECK_EQUAL(0, network_packet_sent_count);
+    pan_bridge_network_send_packet(create_frame(addr_broadcast, network_addr), sizeof(frames[0]));
+    CHECK_EQUAL(1, network_packet_sent_count);
+    CHECK_EQUAL(1, pan_bridge_get_dropped_frames());
+    CHECK_EQUAL(PAN_BRIDGE_FRAME_POOL_SIZE + 1, queued(0x42));
+}
+
+TEST(PANBridge, RuntFrameFromNetworkIsCounted){
+    uint8_t frame[10] = { 0 };
+    pan_bridge_network_send_packet(frame, sizeof(frame));
+    CHECK_EQUAL(1, network_packet_sent_count);
+    CHECK_EQUAL(1, pan_bridge_get_dropped_frames());
+}
+
+TEST(PANBridge, FrameDroppedWhenChannelQueueFull){
+    mock_channels[1].queue_full = 1;
+    // broadcast queued on other channel
+    channel_receive(0x41, addr_broadcast, addr_a);
+    CHECK_EQUAL(0, queued(0x42));
+    CHECK_EQUAL(1, queued(0x43));
+    CHECK_EQUAL(1, pan_bridge_get_dropped_frames());
+
+    // learn address on full channel, then unicast to it
+    channel_receive(0x42, addr_broadcast, addr_b);
+    CHECK_EQUAL(1, queued(0x41));
+    CHECK_EQUAL(1, pan_bridge_get_dropped_frames());
+    pan_bridge_network_send_packet(create_frame(addr_b, network_addr), sizeof(frames[0]));
+    CHECK_EQUAL(2, pan_bridge_get_dropped_frames());
+    // frame not queued anywhere, reported as sent
+    CHECK_EQUAL(1, network_packet_sent_count);
+
+    // network broadcast counts channel with full queue
+    mock_channel_send(0x41);
+    mock_channel_send(0x43);
+    mock_channel_send(0x43);
+    pan_bridge_network_send_packet(create_frame(addr_broadcast, network_addr), sizeof(frames[0]));
+    CHECK_EQUAL(3, pan_bridge_get_dropped_frames());
+    CHECK_EQUAL(1, queued(0x41));
+    CHECK_EQUAL(1, queued(0x43));
+}
+
+int main (int argc, const char * argv[]){
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -0,0 +1,704 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include "bluetooth_sdp.h"
+#include "btstack_debug.h"
+#include "btstack_event.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_base.h"
+#include "btstack_util.h"
+#include "classic/rfcomm.h"
+#include "gap.h"
+#include "l2cap.h"
+
+#define L2CAP_CID       0x0041
+#define CON_HANDLE      0x0005
+#define SERVER_CHANNEL  1
+// remote is initiator, direction bit cleared
+#define DLCI            (SERVER_CHANNEL << 1)
+
+#define MAX_FRAMES      64
+#define MAX_FRAME_SIZE  1030
+#define MAX_REMOTE_DATA 2048
+
+// RFCOMM frame types and multiplexer commands
+#define RFCOMM_SABM     0x3F
+#define RFCOMM_UA       0x73
+#define RFCOMM_UIH      0xEF
+#define RFCOMM_UIH_PF   0xFF
+#define RFCOMM_PN_CMD   0x83
+#define RFCOMM_MSC_CMD  0xE3
+#define RFCOMM_MSC_RSP  0xE1
+
+// frames received by remote
+#define REMOTE_DATA_FRAME_LEN  100
+
+static const bd_addr_t remote_addr = { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+
+static btstack_packet_handler_t rfcomm_l2cap_packet_handler;
+
+// mock L2CAP
+static uint8_t  l2cap_outgoing_buffer[MAX_FRAME_SIZE];
+static int      l2cap_outgoing_buffer_reserved;
+static int      l2cap_can_send_now_requested;
+static uint8_t  sent_frames[MAX_FRAMES][MAX_FRAME_SIZE];
+static uint16_t sent_frames_len[MAX_FRAMES];
+static int      num_sent_frames;
+
+// local channel
+static uint16_t rfcomm_cid;
+static int      channel_opened;
+static int      num_can_send_now_events;
+static int      num_received_frames;
+static uint8_t  credits_target;
+static uint32_t credits_granted;
+static uint16_t rtt_ms;
+static uint32_t rx_frames;
+static uint32_t rx_bytes_per_second;
+
+// remote
+static uint8_t  remote_data[MAX_REMOTE_DATA];
+static uint16_t remote_data_len;
+static uint16_t remote_data_frames_len[MAX_FRAMES];
+static int      num_remote_data_frames;
+static uint16_t remote_credits;
+static uint32_t remote_credits_received;
+static uint16_t remote_rtt_ms;
+// credits in transit to remote
+static uint32_t pending_credits_time_ms[MAX_FRAMES];
+static uint8_t  pending_credits[MAX_FRAMES];
+static int      num_pending_credits;
+
+// mock run loop with time controlled by test
+
+static uint32_t mock_time_ms;
+
+static void mock_run_loop_init(void){
+    btstack_run_loop_base_init();
+}
+
+static void mock_run_loop_set_timer(btstack_timer_source_t * ts, uint32_t timeout_in_ms){
+    ts->timeout = mock_time_ms + timeout_in_ms;
+}
+
+static uint32_t mock_run_loop_get_time_ms(void){
+    return mock_time_ms;
+}
+
+static const btstack_run_loop_t mock_run_loop = {
+    &mock_run_loop_init,
+    &btstack_run_loop_base_add_data_source,
+    &btstack_run_loop_base_remove_data_source,
+    &btstack_run_loop_base_enable_data_source_callbacks,
+    &btstack_run_loop_base_disable_data_source_callbacks,
+    &mock_run_loop_set_timer,
+    &btstack_run_loop_base_add_timer,
+    &btstack_run_loop_base_remove_timer,
+    NULL,
+    NULL,
+    &mock_run_loop_get_time_ms,
+};
+
+// mock L2CAP, frames are collected and handled by remote in process_sent_frames
+
+gap_security_level_t gap_get_security_level(void){
+    return LEVEL_0;
+}
+
+uint8_t l2cap_register_service(btstack_packet_handler_t packet_handler, uint16_t psm, uint16_t mtu, gap_security_level_t security_level){
+    rfcomm_l2cap_packet_handler = packet_handler;
+    return ERROR_CODE_SUCCESS;
+}
+
+uint8_t l2cap_unregister_service(uint16_t psm){
+    return ERROR_CODE_SUCCESS;
+}
+
+uint8_t l2cap_create_channel(btstack_packet_handler_t packet_handler, bd_addr_t address, uint16_t psm, uint16_t mtu, uint16_t * out_local_cid){
+    return BTSTACK_MEMORY_ALLOC_FAILED;
+}
+
+void l2cap_accept_connection(uint16_t local_cid){
+}
+
+void l2cap_decline_connection(uint16_t local_cid){
+}
+
+void l2cap_disconnect(uint16_t local_cid, uint8_t reason){
+}
+
+int l2cap_can_send_packet_now(uint16_t local_cid){
+    return 1;
+}
+
+int l2cap_can_send_prepared_packet_now(uint16_t local_cid){
+    return 1;
+}
+
+void l2cap_request_can_send_now_event(uint16_t local_cid){
+    l2cap_can_send_now_requested = 1;
+}
+
+int l2cap_reserve_packet_buffer(void){
+    CHECK_EQUAL(0, l2cap_outgoing_buffer_reserved);
+    l2cap_outgoing_buffer_reserved = 1;
+    return 1;
+}
+
+void l2cap_release_packet_buffer(void){
+    CHECK_EQUAL(1, l2cap_outgoing_buffer_reserved);
+    l2cap_outgoing_buffer_reserved = 0;
+}
+
+uint8_t * l2cap_get_outgoing_buffer(void){
+    return l2cap_outgoing_buffer;
+}
+
+int l2cap_send_prepared(uint16_t local_cid, uint16_t len){
+    CHECK_EQUAL(L2CAP_CID, local_cid);
+    CHECK_EQUAL(1, l2cap_outgoing_buffer_reserved);
+    l2cap_outgoing_buffer_reserved = 0;
+    CHECK(num_sent_frames < MAX_FRAMES);
+    CHECK(len <= MAX_FRAME_SIZE);
+    memcpy(sent_frames[num_sent_frames], l2cap_outgoing_buffer, len);
+    sent_frames_len[num_sent_frames] = len;
+    num_sent_frames++;
+    return ERROR_CODE_SUCCESS;
+}
+
+uint16_t l2cap_max_mtu(void){
+    return HCI_ACL_PAYLOAD_SIZE - L2CAP_HEADER_SIZE;
+}
+
+// remote device
+
+static void remote_send_frame(uint8_t address, uint8_t control, const uint8_t * data, uint16_t len){
+    uint8_t frame[MAX_FRAME_SIZE];
+    uint16_t pos = 0;
+    frame[pos++] = address;
+    frame[pos++] = control;
+    if (len < 128){
+        frame[pos++] = (uint8_t) ((len << 1) | 1);
+    } else {
+        frame[pos++] = (uint8_t) ((len & 0x7f) << 1);
+        frame[pos++] = (uint8_t) (len >> 7);
+    }
+    memcpy(&frame[pos], data, len);
+    pos += len;
+    // FCS over address and control for UIH, incl. length otherwise
+    frame[pos] = btstack_crc8_calc(frame, (control == RFCOMM_UIH) ? 2 : 3);
+    pos++;
+    (*rfcomm_l2cap_packet_handler)(L2CAP_DATA_PACKET, L2CAP_CID, frame, pos);
+}
+
+// remote is initiator: C/R bit set for commands and UIH frames
+static void remote_send_command(uint8_t dlci, uint8_t control){
+    remote_send_frame((uint8_t) ((dlci << 2) | 0x03), control, NULL, 0);
+}
+
+static void remote_send_multiplexer_command(const uint8_t * command, uint16_t len){
+    remote_send_frame(0x03, RFCOMM_UIH, command, len);
+}
+
+static void remote_send_data(uint16_t len){
+    uint8_t data[MAX_FRAME_SIZE];
+    memset(data, 0x55, len);
+    CHECK(remote_credits > 0);
+    remote_credits--;
+    remote_send_frame((DLCI << 2) | 0x03, RFCOMM_UIH, data, len);
+}
+
+// provide credits for local device
+static void remote_grant_credits(uint8_t credits){
+    uint8_t frame[] = { (DLCI << 2) | 0x03, RFCOMM_UIH_PF, 0x01, credits, 0 };
+    frame[4] = btstack_crc8_calc(frame, 2);
+    (*rfcomm_l2cap_packet_handler)(L2CAP_DATA_PACKET, L2CAP_CID, frame, sizeof(frame));
+}
+
+static void remote_handle_frame(const uint8_t * frame, uint16_t len){
+    uint8_t dlci    = frame[0] >> 2;
+    uint8_t control = frame[1];
+    if (dlci != DLCI) return;
+    if ((control != RFCOMM_UIH) && (control != RFCOMM_UIH_PF)) return;
+    uint16_t pos = 2;
+    uint16_t data_len = frame[pos++] >> 1;
+    if ((frame[2] & 1) == 0){
+        data_len |= frame[pos++] << 7;
+    }
+    if (control == RFCOMM_UIH_PF){
+        // credits arrive at remote after round-trip time
+        CHECK(num_pending_credits < MAX_FRAMES);
+        pending_credits_time_ms[num_pending_credits] = mock_time_ms + remote_rtt_ms;
+        pending_credits[num_pending_credits] = frame[pos++];
+        num_pending_credits++;
+    }
+    if (data_len == 0) return;
+    CHECK_EQUAL(len, pos + data_len + 1);
+    CHECK(num_remote_data_frames < MAX_FRAMES);
+    CHECK((remote_data_len + data_len) <= MAX_REMOTE_DATA);
+    memcpy(&remote_data[remote_data_len], &frame[pos], data_len);
+    remote_data_len += data_len;
+    remote_data_frames_len[num_remote_data_frames++] = data_len;
+}
+
+static void remote_receive_pending_credits(void){
+    int i = 0;
+    while (i < num_pending_credits){
+        if (btstack_time_delta(mock_time_ms, pending_credits_time_ms[i]) < 0){
+            i++;
+            continue;
+        }
+        remote_credits += pending_credits[i];
+        remote_credits_received += pending_credits[i];
+        num_pending_credits--;
+        memmove(&pending_credits_time_ms[i], &pending_credits_time_ms[i+1], (num_pending_credits - i) * sizeof(uint32_t));
+        memmove(&pending_credits[i], &pending_credits[i+1], (num_pending_credits - i) * sizeof(uint8_t));
+    }
+}
+
+static void process_sent_frames(void){
+    int i;
+    for (i = 0; i < num_sent_frames; i++){
+        remote_handle_frame(sent_frames[i], sent_frames_len[i]);
+    }
+    num_sent_frames = 0;
+    remote_receive_pending_credits();
+}
+
+// deliver can send now events as long as requested by RFCOMM
+static void process(void){
+    while (l2cap_can_send_now_requested){
+        l2cap_can_send_now_requested = 0;
+        uint8_t event[] = { L2CAP_EVENT_CAN_SEND_NOW, 2, 0, 0 };
+        little_endian_store_16(event, 2, L2CAP_CID);
+        (*rfcomm_l2cap_packet_handler)(HCI_EVENT_PACKET, 0, event, sizeof(event));
+    }
+    process_sent_frames();
+}
+
+static uint32_t remote_credits_outstanding(void){
+    uint32_t credits = remote_credits;
+    int i;
+    for (i = 0; i < num_pending_credits; i++){
+        credits += pending_credits[i];
+    }
+    return credits;
+}
+
+static void advance_time(uint32_t delta_ms){
+    mock_time_ms += delta_ms;
+    btstack_run_loop_base_process_timers(mock_time_ms);
+    remote_receive_pending_credits();
+}
+
+static void request_statistics(void){
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, rfcomm_request_channel_statistics_event(rfcomm_cid));
+}
+
+static void rfcomm_channel_packet_handler(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    switch (packet_type){
+        case RFCOMM_DATA_PACKET:
+            num_received_frames++;
+            break;
+        case HCI_EVENT_PACKET:
+            switch (hci_event_packet_get_type(packet)){
+                case RFCOMM_EVENT_INCOMING_CONNECTION:
+                    rfcomm_cid = rfcomm_event_incoming_connection_get_rfcomm_cid(packet);
+                    rfcomm_accept_connection(rfcomm_cid);
+                    break;
+                case RFCOMM_EVENT_CHANNEL_OPENED:
+                    CHECK_EQUAL(ERROR_CODE_SUCCESS, rfcomm_event_channel_opened_get_status(packet));
+                    channel_opened = 1;
+                    break;
+                case RFCOMM_EVENT_CAN_SEND_NOW:
+                    num_can_send_now_events++;
+                    break;
+                case RFCOMM_EVENT_CHANNEL_STATISTICS:
+                    CHECK_EQUAL(rfcomm_cid, rfcomm_event_channel_statistics_get_rfcomm_cid(packet));
+                    credits_target  = rfcomm_event_channel_statistics_get_credits_target(packet);
+                    credits_granted = rfcomm_event_channel_statistics_get_credits_granted(packet);
+                    rtt_ms          = rfcomm_event_channel_statistics_get_rtt_ms(packet);
+                    rx_frames       = rfcomm_event_channel_statistics_get_rx_frames(packet);
+                    rx_bytes_per_second = rfcomm_event_channel_statistics_get_rx_bytes_per_second(packet);
+                    break;
+                default:
+                    break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+static void open_channel(uint16_t max_frame_size){
+    // L2CAP channel for RFCOMM
+    uint8_t incoming[16];
+    memset(incoming, 0, sizeof(incoming));
+    incoming[0] = L2CAP_EVENT_INCOMING_CONNECTION;
+    incoming[1] = sizeof(incoming) - 2;
+    reverse_bd_addr(remote_addr, &incoming[2]);
+    little_endian_store_16(incoming,  8, CON_HANDLE);
+    little_endian_store_16(incoming, 10, BLUETOOTH_PROTOCOL_RFCOMM);
+    little_endian_store_16(incoming, 12, L2CAP_CID);
+    (*rfcomm_l2cap_packet_handler)(HCI_EVENT_PACKET, 0, incoming, sizeof(incoming));
+
+    uint8_t opened[24];
+    memset(opened, 0, sizeof(opened));
+    opened[0] = L2CAP_EVENT_CHANNEL_OPENED;
+    opened[1] = sizeof(opened) - 2;
+    reverse_bd_addr(remote_addr, &opened[3]);
+    little_endian_store_16(opened,  9, CON_HANDLE);
+    little_endian_store_16(opened, 11, BLUETOOTH_PROTOCOL_RFCOMM);
+    little_endian_store_16(opened, 13, L2CAP_CID);
+    little_endian_store_16(opened, 17, l2cap_max_mtu());
+    little_endian_store_16(opened, 19, l2cap_max_mtu());
+    (*rfcomm_l2cap_packet_handler)(HCI_EVENT_PACKET, 0, opened, sizeof(opened));
+
+    // multiplexer
+    remote_send_command(0, RFCOMM_SABM);
+    process();
+
+    // parameter negotiation with credit based flow control, no credits for local device
+    uint8_t pn[] = { RFCOMM_PN_CMD, (8 << 1) | 1, DLCI, 0xf0, 0, 0, 0, 0, 0, 0};
+    little_endian_store_16(pn, 6, max_frame_size);
+    remote_send_multiplexer_command(pn, sizeof(pn));
+    process();
+
+    // channel
+    remote_send_command(DLCI, RFCOMM_SABM);
+    process();
+    uint8_t msc_cmd[] = { RFCOMM_MSC_CMD, (2 << 1) | 1, (DLCI << 2) | 0x03, 0x8d };
+    remote_send_multiplexer_command(msc_cmd, sizeof(msc_cmd));
+    uint8_t msc_rsp[] = { RFCOMM_MSC_RSP, (2 << 1) | 1, (DLCI << 2) | 0x03, 0x8d };
+    remote_send_multiplexer_command(msc_rsp, sizeof(msc_rsp));
+    process();
+    CHECK_EQUAL(1, channel_opened);
+}
+
+// remote sends a frame every frame_interval_ms if it has credits
+static void run_link(uint32_t duration_ms, uint32_t frame_interval_ms){
+    uint32_t elapsed_ms;
+    for (elapsed_ms = 0; elapsed_ms < duration_ms; elapsed_ms += frame_interval_ms){
+        advance_time(frame_interval_ms);
+        if (remote_credits == 0) continue;
+        remote_send_data(REMOTE_DATA_FRAME_LEN);
+        process();
+    }
+}
+
+static void test_setup(void){
+    btstack_run_loop_base_init();
+    mock_time_ms = 0;
+    l2cap_outgoing_buffer_reserved = 0;
+    l2cap_can_send_now_requested = 0;
+    num_sent_frames      = 0;
+    channel_opened       = 0;
+    num_can_send_now_events = 0;
+    num_received_frames  = 0;
+    remote_data_len      = 0;
+    num_remote_data_frames = 0;
+    remote_credits       = 0;
+    remote_credits_received = 0;
+    remote_rtt_ms        = 0;
+    num_pending_credits  = 0;
+    rfcomm_init();
+    rfcomm_register_service(&rfcomm_channel_packet_handler, SERVER_CHANNEL, 0xffff);
+}
+
+static void test_teardown(void){
+    // closes multiplexer and channels
+    uint8_t closed[] = { L2CAP_EVENT_CHANNEL_CLOSED, 2, 0, 0 };
+    little_endian_store_16(closed, 2, L2CAP_CID);
+    (*rfcomm_l2cap_packet_handler)(HCI_EVENT_PACKET, 0, closed, sizeof(closed));
+    rfcomm_unregister_service(SERVER_CHANNEL);
+}
+
+TEST_GROUP(RFCOMM_ADAPTIVE_CREDITS){
+    void setup(void){
+        test_setup();
+    }
+    void teardown(void){
+        test_teardown();
+    }
+};
+
+TEST(RFCOMM_ADAPTIVE_CREDITS, TopUpWhenHalfOfCreditsUsed){
+    open_channel(REMOTE_DATA_FRAME_LEN);
+    CHECK_EQUAL(10, remote_credits);
+
+    // no credits while more than half of the target is outstanding
+    int i;
+    for (i = 0; i < 4; i++){
+        remote_send_data(REMOTE_DATA_FRAME_LEN);
+        process();
+    }
+    CHECK_EQUAL(4, num_received_frames);
+    CHECK_EQUAL(10, remote_credits_received);
+
+    remote_send_data(REMOTE_DATA_FRAME_LEN);
+    process();
+    CHECK_EQUAL(15, remote_credits_received);
+    CHECK_EQUAL(10, remote_credits);
+
+    request_statistics();
+    CHECK_EQUAL(10, credits_target);
+    CHECK_EQUAL(15, credits_granted);
+    CHECK_EQUAL(5, rx_frames);
+}
+
+TEST(RFCOMM_ADAPTIVE_CREDITS, TargetCoversTwoRoundTrips){
+    // 200 frames per second, 100 ms round-trip time: 20 frames per round-trip
+    remote_rtt_ms = 100;
+    open_channel(REMOTE_DATA_FRAME_LEN);
+    advance_time(remote_rtt_ms);
+
+    uint8_t previous_target = 10;
+    int interval;
+    for (interval = 0; interval < 16; interval++){
+        run_link(250, 5);
+        request_statistics();
+        CHECK_EQUAL(remote_rtt_ms, rtt_ms);
+        CHECK(credits_target <= (2 * previous_target));
+        previous_target = credits_target;
+    }
+
+    // credits for two round-trips, throughput limited by link
+    CHECK_EQUAL(40, credits_target);
+    CHECK_EQUAL(200 * REMOTE_DATA_FRAME_LEN, rx_bytes_per_second);
+    CHECK_EQUAL((uint32_t) num_received_frames, rx_frames);
+    CHECK_EQUAL(remote_credits_received + remote_credits_outstanding() - remote_credits, credits_granted);
+}
+
+TEST(RFCOMM_ADAPTIVE_CREDITS, TargetAtMostDoublesPerInterval){
+    // RFCOMM_ADAPTIVE_CREDITS_MAX_BYTES / 100 byte frames
+    const uint8_t max_target = 163;
+
+    // round-trip time longer than interval, remote uses all credits in a burst
+    remote_rtt_ms = 1000;
+    open_channel(REMOTE_DATA_FRAME_LEN);
+    advance_time(remote_rtt_ms);
+
+    uint8_t previous_target = 10;
+    int doubled = 0;
+    int interval;
+    for (interval = 0; interval < 40; interval++){
+        run_link(250, 5);
+        request_statistics();
+        uint32_t rtt_credits = (rx_bytes_per_second / REMOTE_DATA_FRAME_LEN) * rtt_ms * 2 / 1000;
+        if ((credits_target != previous_target) && (rtt_credits > (2u * previous_target))){
+            CHECK_EQUAL(btstack_min(2 * previous_target, max_target), credits_target);
+            doubled++;
+        }
+        CHECK(credits_target <= (2 * previous_target));
+        previous_target = credits_target;
+    }
+    CHECK(doubled > 0);
+    CHECK_EQUAL(remote_rtt_ms, rtt_ms);
+    CHECK_EQUAL(max_target, credits_target);
+}
+
+TEST(RFCOMM_ADAPTIVE_CREDITS, TargetShrinksByQuarter){
+    remote_rtt_ms = 100;
+    open_channel(REMOTE_DATA_FRAME_LEN);
+    advance_time(remote_rtt_ms);
+    run_link(4000, 5);
+    request_statistics();
+    CHECK_EQUAL(40, credits_target);
+
+    // 20 frames per second need 4 credits. remote has credits left, which must not increase round-trip time
+    uint8_t previous_target = credits_target;
+    int interval;
+    for (interval = 0; interval < 8; interval++){
+        run_link(250, 50);
+        request_statistics();
+        CHECK_EQUAL(remote_rtt_ms, rtt_ms);
+        CHECK_EQUAL(btstack_max(10, previous_target - (previous_target / 4)), credits_target);
+        previous_target = credits_target;
+    }
+    CHECK_EQUAL(10, credits_target);
+    CHECK_EQUAL(20 * REMOTE_DATA_FRAME_LEN, rx_bytes_per_second);
+}
+
+TEST(RFCOMM_ADAPTIVE_CREDITS, TargetLimitedByMaxFrameSize){
+    // RFCOMM_ADAPTIVE_CREDITS_MAX_BYTES / 1000 byte frames
+    const uint8_t max_target = 16;
+    remote_rtt_ms = 100;
+    open_channel(1000);
+    advance_time(remote_rtt_ms);
+
+    uint32_t elapsed_ms;
+    for (elapsed_ms = 0; elapsed_ms < 4000; elapsed_ms += 250){
+        run_link(250, 5);
+        CHECK(remote_credits_outstanding() <= max_target);
+    }
+    request_statistics();
+    CHECK_EQUAL(max_target, credits_target);
+}
+
+// data pattern to verify in-order delivery
+static void fill_pattern(uint8_t * buffer, uint16_t len, uint32_t offset){
+    uint16_t i;
+    for (i = 0; i < len; i++){
+        buffer[i] = (uint8_t) ((offset + i) % 251u);
+    }
+}
+
+static void check_remote_data(uint16_t len){
+    CHECK_EQUAL(len, remote_data_len);
+    uint16_t i;
+    for (i = 0; i < len; i++){
+        CHECK_EQUAL((uint8_t) (i % 251u), remote_data[i]);
+    }
+}
+
+TEST_GROUP(RFCOMM_SEND){
+    void setup(void){
+        test_setup();
+        open_channel(REMOTE_DATA_FRAME_LEN);
+    }
+    void teardown(void){
+        test_teardown();
+    }
+};
+
+TEST(RFCOMM_SEND, ReserveCommit){
+    uint16_t size = 0;
+    POINTERS_EQUAL(NULL, rfcomm_reserve_send_buffer(rfcomm_cid, &size));
+    CHECK_EQUAL(0, l2cap_outgoing_buffer_reserved);
+
+    remote_grant_credits(2);
+    uint8_t * buffer = rfcomm_reserve_send_buffer(rfcomm_cid, &size);
+    CHECK(buffer != NULL);
+    CHECK_EQUAL(REMOTE_DATA_FRAME_LEN, size);
+    CHECK_EQUAL(1, l2cap_outgoing_buffer_reserved);
+    fill_pattern(buffer, size, 0);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, rfcomm_commit_send_buffer(rfcomm_cid, size));
+    CHECK_EQUAL(0, l2cap_outgoing_buffer_reserved);
+    process();
+    CHECK_EQUAL(1, num_remote_data_frames);
+    check_remote_data(REMOTE_DATA_FRAME_LEN);
+}
+
+TEST(RFCOMM_SEND, ReserveRelease){
+    remote_grant_credits(1);
+    uint16_t size = 0;
+    CHECK(rfcomm_reserve_send_buffer(rfcomm_cid, &size) != NULL);
+    rfcomm_release_send_buffer(rfcomm_cid);
+    CHECK_EQUAL(0, l2cap_outgoing_buffer_reserved);
+    process();
+    CHECK_EQUAL(0, num_remote_data_frames);
+
+    // credit not used
+    CHECK(rfcomm_reserve_send_buffer(rfcomm_cid, &size) != NULL);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, rfcomm_commit_send_buffer(rfcomm_cid, 1));
+    POINTERS_EQUAL(NULL, rfcomm_reserve_send_buffer(rfcomm_cid, &size));
+}
+
+TEST(RFCOMM_SEND, CommitTooLongReleasesBuffer){
+    remote_grant_credits(1);
+    uint16_t size = 0;
+    CHECK(rfcomm_reserve_send_buffer(rfcomm_cid, &size) != NULL);
+    CHECK_EQUAL(RFCOMM_DATA_LEN_EXCEEDS_MTU, rfcomm_commit_send_buffer(rfcomm_cid, size + 1));
+    CHECK_EQUAL(0, l2cap_outgoing_buffer_reserved);
+    process();
+    CHECK_EQUAL(0, num_remote_data_frames);
+}
+
+TEST(RFCOMM_SEND, SendIovGathersBuffers){
+    uint8_t data[REMOTE_DATA_FRAME_LEN];
+    fill_pattern(data, sizeof(data), 0);
+    btstack_iovec_t iov[3];
+    iov[0].data = &data[0];
+    iov[0].len  = 10;
+    iov[1].data = &data[10];
+    iov[1].len  = 0;
+    iov[2].data = &data[10];
+    iov[2].len  = sizeof(data) - 10;
+
+    CHECK_EQUAL(RFCOMM_NO_OUTGOING_CREDITS, rfcomm_send_iov(rfcomm_cid, iov, 3));
+    CHECK_EQUAL(0, l2cap_outgoing_buffer_reserved);
+
+    remote_grant_credits(1);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, rfcomm_send_iov(rfcomm_cid, iov, 3));
+    CHECK_EQUAL(0, l2cap_outgoing_buffer_reserved);
+    process();
+    CHECK_EQUAL(1, num_remote_data_frames);
+    check_remote_data(REMOTE_DATA_FRAME_LEN);
+}
+
+TEST(RFCOMM_SEND, SendIovExceedsMaxFrameSize){
+    uint8_t data[REMOTE_DATA_FRAME_LEN];
+    fill_pattern(data, sizeof(data), 0);
+    btstack_iovec_t iov[2];
+    iov[0].data = data;
+    iov[0].len  = sizeof(data);
+    iov[1].data = data;
+    iov[1].len  = 1;
+    remote_grant_credits(1);
+    CHECK_EQUAL(RFCOMM_DATA_LEN_EXCEEDS_MTU, rfcomm_send_iov(rfcomm_cid, iov, 2));
+    CHECK_EQUAL(0, l2cap_outgoing_buffer_reserved);
+    CHECK_EQUAL(1, rfcomm_can_send_packet_now(rfcomm_cid));
+}
+
+TEST(RFCOMM_SEND, StreamWrapAroundWithPartialCredits){
+    uint8_t storage[256];
+    uint8_t data[512];
+    fill_pattern(data, sizeof(data), 0);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, rfcomm_enable_streaming(rfcomm_cid, storage, sizeof(storage)));
+
+    // two credits for 200 bytes, 50 bytes stay in ring buffer
+    CHECK_EQUAL(250, rfcomm_stream_write(rfcomm_cid, data, 250));
+    remote_grant_credits(2);
+    process();
+    CHECK_EQUAL(2, num_remote_data_frames);
+    check_remote_data(200);
+
+    // fill up, write position wraps around
+    CHECK_EQUAL(206, rfcomm_stream_write(rfcomm_cid, &data[250], 262));
+    CHECK_EQUAL(0, rfcomm_stream_write(rfcomm_cid, &data[456], 1));
+    process();
+    CHECK_EQUAL(2, num_remote_data_frames);
+
+    // first frame wraps around end of storage, last one is partial
+    remote_grant_credits(5);
+    process();
+    CHECK_EQUAL(5, num_remote_data_frames);
+    CHECK_EQUAL(REMOTE_DATA_FRAME_LEN, remote_data_frames_len[2]);
+    CHECK_EQUAL(REMOTE_DATA_FRAME_LEN, remote_data_frames_len[3]);
+    CHECK_EQUAL(56, remote_data_frames_len[4]);
+    check_remote_data(456);
+    CHECK_EQUAL(0, l2cap_outgoing_buffer_reserved);
+}
+
+TEST(RFCOMM_SEND, StreamCanSendNowWhenHalfFree){
+    uint8_t storage[400];
+    uint8_t data[400];
+    fill_pattern(data, sizeof(data), 0);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, rfcomm_enable_streaming(rfcomm_cid, storage, sizeof(storage)));
+    CHECK_EQUAL(400, rfcomm_stream_write(rfcomm_cid, data, sizeof(data)));
+    CHECK_EQUAL(0, rfcomm_stream_write(rfcomm_cid, data, 1));
+    rfcomm_request_can_send_now_event(rfcomm_cid);
+    process();
+    CHECK_EQUAL(0, num_can_send_now_events);
+
+    // 100 bytes free
+    remote_grant_credits(1);
+    process();
+    CHECK_EQUAL(0, num_can_send_now_events);
+
+    // 200 bytes free
+    remote_grant_credits(1);
+    process();
+    CHECK_EQUAL(1, num_can_send_now_events);
+    check_remote_data(200);
+}
+
+int main (int argc, const char * argv[]){
+    btstack_run_loop_init(&mock_run_loop);
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -0,0 +1,265 @@
+
+// *****************************************************************************
+//
+// test sdp server with multiple l2cap channels
+//
+// *****************************************************************************
+
+#include "btstack_config.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include "bluetooth_psm.h"
+#include "bluetooth_sdp.h"
+#include "btstack_defines.h"
+#include "btstack_memory.h"
+#include "btstack_util.h"
+#include "l2cap.h"
+#include "classic/sdp_server.h"
+#include "classic/sdp_util.h"
+#include "classic/spp_server.h"
+
+// mock l2cap
+
+#define MAX_CIDS 8
+
+static btstack_packet_handler_t sdp_server_packet_handler;
+static uint16_t accepted_cids[MAX_CIDS];
+static int      accepted_count;
+static uint16_t declined_count;
+static uint16_t can_send_now_requested_cids[MAX_CIDS];
+static int      can_send_now_requested_count;
+static int      can_send_now;
+static uint8_t  outgoing_buffer[HCI_ACL_PAYLOAD_SIZE];
+static int      outgoing_buffer_reserved;
+static uint16_t sent_cids[MAX_CIDS];
+static uint8_t  sent_responses[MAX_CIDS][HCI_ACL_PAYLOAD_SIZE];
+static int      sent_count;
+
+uint8_t l2cap_register_service(btstack_packet_handler_t packet_handler, uint16_t psm, uint16_t mtu, gap_security_level_t security_level){
+    CHECK_EQUAL(BLUETOOTH_PSM_SDP, psm);
+    sdp_server_packet_handler = packet_handler;
+    return ERROR_CODE_SUCCESS;
+}
+
+void l2cap_accept_connection(uint16_t local_cid){
+    accepted_cids[accepted_count++] = local_cid;
+}
+
+void l2cap_decline_connection(uint16_t local_cid){
+    declined_count++;
+}
+
+int l2cap_can_send_packet_now(uint16_t local_cid){
+    return can_send_now;
+}
+
+void l2cap_request_can_send_now_event(uint16_t local_cid){
+    can_send_now_requested_cids[can_send_now_requested_count++] = local_cid;
+}
+
+int l2cap_reserve_packet_buffer(void){
+    CHECK_EQUAL(0, outgoing_buffer_reserved);
+    outgoing_buffer_reserved = 1;
+    return 1;
+}
+
+uint8_t * l2cap_get_outgoing_buffer(void){
+    return outgoing_buffer;
+}
+
+void l2cap_release_packet_buffer(void){
+    outgoing_buffer_reserved = 0;
+}
+
+int l2cap_send_prepared(uint16_t local_cid, uint16_t len){
+    CHECK_EQUAL(1, outgoing_buffer_reserved);
+    outgoing_buffer_reserved = 0;
+    sent_cids[sent_count] = local_cid;
+    memcpy(sent_responses[sent_count], outgoing_buffer, len);
+    sent_count++;
+    return ERROR_CODE_SUCCESS;
+}
+
+uint16_t l2cap_get_remote_mtu_for_local_cid(uint16_t local_cid){
+    return L2CAP_DEFAULT_MTU;
+}
+
+uint16_t l2cap_max_mtu(void){
+    return HCI_ACL_PAYLOAD_SIZE - L2CAP_HEADER_SIZE;
+}
+
+static void incoming_connection(uint16_t cid){
+    uint8_t event[16];
+    memset(event, 0, sizeof(event));
+    event[0] = L2CAP_EVENT_INCOMING_CONNECTION;
+    event[1] = sizeof(event) - 2;
+    little_endian_store_16(event, 12, cid);
+    (*sdp_server_packet_handler)(HCI_EVENT_PACKET, 0, event, sizeof(event));
+}
+
+static void channel_closed(uint16_t cid){
+    uint8_t event[4];
+    event[0] = L2CAP_EVENT_CHANNEL_CLOSED;
+    event[1] = sizeof(event) - 2;
+    little_endian_store_16(event, 2, cid);
+    (*sdp_server_packet_handler)(HCI_EVENT_PACKET, 0, event, sizeof(event));
+}
+
+static void emit_can_send_now(uint16_t cid){
+    uint8_t event[4];
+    event[0] = L2CAP_EVENT_CAN_SEND_NOW;
+    event[1] = sizeof(event) - 2;
+    little_endian_store_16(event, 2, cid);
+    (*sdp_server_packet_handler)(HCI_EVENT_PACKET, 0, event, sizeof(event));
+}
+
+// requests
+
+static uint8_t spp_record[150];
+static uint8_t request[400];
+
+// ServiceSearchAttributeRequest for SPP with num_attribute_ids attribute IDs
+static uint16_t create_service_search_attribute_request(uint16_t transaction_id, uint16_t num_attribute_ids){
+    uint8_t pattern[20];
+    uint8_t attribute_ids[350];
+    uint16_t i;
+    de_create_sequence(pattern);
+    de_add_number(pattern, DE_UUID, DE_SIZE_16, BLUETOOTH_SERVICE_CLASS_SERIAL_PORT);
+    de_create_sequence(attribute_ids);
+    for (i = 0; i < num_attribute_ids; i++){
+        de_add_number(attribute_ids, DE_UINT, DE_SIZE_16, i);
+    }
+    uint16_t pattern_len = de_get_len(pattern);
+    uint16_t attribute_ids_len = de_get_len(attribute_ids);
+    uint16_t pos = 5;
+    request[0] = SDP_ServiceSearchAttributeRequest;
+    big_endian_store_16(request, 1, transaction_id);
+    memcpy(&request[pos], pattern, pattern_len);
+    pos += pattern_len;
+    big_endian_store_16(request, pos, 200);
+    pos += 2;
+    memcpy(&request[pos], attribute_ids, attribute_ids_len);
+    pos += attribute_ids_len;
+    request[pos++] = 0;
+    big_endian_store_16(request, 3, pos - 5);
+    return pos;
+}
+
+static void receive_request(uint16_t cid, uint16_t transaction_id, uint16_t num_attribute_ids){
+    uint16_t size = create_service_search_attribute_request(transaction_id, num_attribute_ids);
+    (*sdp_server_packet_handler)(L2CAP_DATA_PACKET, cid, request, size);
+}
+
+static void check_response(int index, uint16_t cid, uint16_t transaction_id){
+    CHECK(index < sent_count);
+    CHECK_EQUAL(cid, sent_cids[index]);
+    CHECK_EQUAL(SDP_ServiceSearchAttributeResponse, sent_responses[index][0]);
+    CHECK_EQUAL(transaction_id, big_endian_read_16(sent_responses[index], 1));
+}
+
+TEST_GROUP(SDPServerChannels){
+    uint32_t spp_handle;
+
+    void setup(void){
+        btstack_memory_init();
+        accepted_count = 0;
+        declined_count = 0;
+        can_send_now_requested_count = 0;
+        can_send_now = 1;
+        outgoing_buffer_reserved = 0;
+        sent_count = 0;
+        sdp_init();
+        spp_handle = sdp_create_service_record_handle();
+        spp_create_sdp_record(spp_record, spp_handle, 1, "SPP");
+        CHECK_EQUAL(0, sdp_register_service(spp_record));
+    }
+
+    void teardown(void){
+        sdp_unregister_service(spp_handle);
+    }
+};
+
+TEST(SDPServerChannels, RespondRightAway){
+    incoming_connection(0x41);
+    CHECK_EQUAL(1, accepted_count);
+    receive_request(0x41, 1, 2);
+    CHECK_EQUAL(1, sent_count);
+    check_response(0, 0x41, 1);
+    CHECK_EQUAL(0, can_send_now_requested_count);
+}
+
+TEST(SDPServerChannels, ChannelsServedInParallel){
+    incoming_connection(0x41);
+    incoming_connection(0x42);
+    CHECK_EQUAL(2, accepted_count);
+    CHECK_EQUAL(0x41, accepted_cids[0]);
+    CHECK_EQUAL(0x42, accepted_cids[1]);
+
+    // both requests stored until response can be sent
+    can_send_now = 0;
+    receive_request(0x41, 1, 2);
+    receive_request(0x42, 2, 2);
+    CHECK_EQUAL(0, sent_count);
+    CHECK_EQUAL(2, can_send_now_requested_count);
+    CHECK_EQUAL(0x41, can_send_now_requested_cids[0]);
+    CHECK_EQUAL(0x42, can_send_now_requested_cids[1]);
+
+    // each channel answers its own request
+    can_send_now = 1;
+    emit_can_send_now(0x42);
+    emit_can_send_now(0x41);
+    CHECK_EQUAL(2, sent_count);
+    check_response(0, 0x42, 2);
+    check_response(1, 0x41, 1);
+
+    // request was handled
+    emit_can_send_now(0x41);
+    CHECK_EQUAL(2, sent_count);
+}
+
+TEST(SDPServerChannels, WaitingListHandOff){
+    incoming_connection(0x41);
+    incoming_connection(0x42);
+    incoming_connection(0x43);
+    CHECK_EQUAL(2, accepted_count);
+    CHECK_EQUAL(0, declined_count);
+
+    // queued connection is accepted on the channel that was closed
+    can_send_now = 0;
+    receive_request(0x42, 1, 2);
+    channel_closed(0x41);
+    CHECK_EQUAL(3, accepted_count);
+    CHECK_EQUAL(0x43, accepted_cids[2]);
+
+    // request of other channel still pending
+    receive_request(0x43, 2, 2);
+    can_send_now = 1;
+    emit_can_send_now(0x43);
+    emit_can_send_now(0x42);
+    CHECK_EQUAL(2, sent_count);
+    check_response(0, 0x43, 2);
+    check_response(1, 0x42, 1);
+}
+
+TEST(SDPServerChannels, LargeRequestDeferred){
+    incoming_connection(0x41);
+    can_send_now = 0;
+    // 100 attribute IDs, more than 300 bytes
+    receive_request(0x41, 7, 100);
+    CHECK_EQUAL(1, can_send_now_requested_count);
+    can_send_now = 1;
+    emit_can_send_now(0x41);
+    CHECK_EQUAL(1, sent_count);
+    check_response(0, 0x41, 7);
+}
+
+int main (int argc, const char * argv[]){
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
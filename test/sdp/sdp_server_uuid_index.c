@@ -0,0 +1,116 @@
+
+// *****************************************************************************
+//
+// test sdp server service search with UUID index
+//
+// *****************************************************************************
+
+#include "btstack_config.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#include "bluetooth_sdp.h"
+#include "btstack_memory.h"
+#include "btstack_util.h"
+#include "classic/sdp_server.h"
+#include "classic/sdp_util.h"
+#include "classic/spp_server.h"
+
+#define NUM_RECORDS 3
+
+static uint8_t spp_records[NUM_RECORDS][150];
+static uint8_t custom_record[100];
+static uint8_t response[200];
+
+static const uint8_t custom_uuid128[] = { 0xf0, 0x00, 0x00, 0x01, 0x45, 0x1b, 0x4e, 0x5c, 0x8c, 0x3e, 0x2a, 0x5b, 0x43, 0xa1, 0x76, 0x2f };
+// same hash as custom_uuid128 (xor of 32-bit words)
+static const uint8_t collision_uuid128[] = { 0xf0, 0x00, 0x00, 0x01, 0x45, 0x1b, 0x4e, 0x5c, 0x43, 0xa1, 0x76, 0x2f, 0x8c, 0x3e, 0x2a, 0x5b };
+
+static void create_custom_record(uint8_t * service, uint32_t service_record_handle){
+    de_create_sequence(service);
+    de_add_number(service, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_SERVICE_RECORD_HANDLE);
+    de_add_number(service, DE_UINT, DE_SIZE_32, service_record_handle);
+    de_add_number(service, DE_UINT, DE_SIZE_16, BLUETOOTH_ATTRIBUTE_SERVICE_CLASS_ID_LIST);
+    uint8_t * attribute = de_push_sequence(service);
+    {
+        de_add_uuid128(attribute, (uint8_t *) custom_uuid128);
+    }
+    de_pop_sequence(service, attribute);
+}
+
+static uint16_t service_search(uint8_t * pattern){
+    uint8_t request[50];
+    uint16_t pattern_len = de_get_len(pattern);
+    request[0] = SDP_ServiceSearchRequest;
+    big_endian_store_16(request, 1, 1);
+    big_endian_store_16(request, 3, pattern_len + 3);
+    memcpy(&request[5], pattern, pattern_len);
+    big_endian_store_16(request, 5 + pattern_len, 10);
+    request[7 + pattern_len] = 0;
+    int size = sdp_handle_service_search_request(request, sizeof(response), response);
+    CHECK(size >= 9);
+    // current service record count
+    return big_endian_read_16(response, 7);
+}
+
+static uint32_t service_search_result(uint16_t index){
+    return big_endian_read_32(response, 9 + 4 * index);
+}
+
+TEST_GROUP(SDPServerUUIDIndex){
+    uint32_t spp_handles[NUM_RECORDS];
+    uint32_t custom_handle;
+
+    void setup(void){
+        int i;
+        btstack_memory_init();
+        for (i=0;i<NUM_RECORDS;i++){
+            spp_handles[i] = sdp_create_service_record_handle();
+            spp_create_sdp_record(spp_records[i], spp_handles[i], i + 1, "SPP");
+            CHECK_EQUAL(0, sdp_register_service(spp_records[i]));
+        }
+        custom_handle = sdp_create_service_record_handle();
+        create_custom_record(custom_record, custom_handle);
+        CHECK_EQUAL(0, sdp_register_service(custom_record));
+    }
+
+    void teardown(void){
+        int i;
+        for (i=0;i<NUM_RECORDS;i++){
+            sdp_unregister_service(spp_handles[i]);
+        }
+        sdp_unregister_service(custom_handle);
+    }
+};
+
+TEST(SDPServerUUIDIndex, SearchUUID16){
+    CHECK_EQUAL(NUM_RECORDS, service_search(sdp_service_search_pattern_for_uuid16(BLUETOOTH_SERVICE_CLASS_SERIAL_PORT)));
+    // UUIDs in protocol descriptor list are found as well
+    CHECK_EQUAL(NUM_RECORDS, service_search(sdp_service_search_pattern_for_uuid16(BLUETOOTH_PROTOCOL_RFCOMM)));
+    CHECK_EQUAL(0, service_search(sdp_service_search_pattern_for_uuid16(BLUETOOTH_SERVICE_CLASS_HANDSFREE)));
+}
+
+TEST(SDPServerUUIDIndex, SearchUUID128){
+    CHECK_EQUAL(1, service_search(sdp_service_search_pattern_for_uuid128(custom_uuid128)));
+    CHECK_EQUAL(custom_handle, service_search_result(0));
+    // hash collision is resolved by matching against record
+    CHECK_EQUAL(0, service_search(sdp_service_search_pattern_for_uuid128(collision_uuid128)));
+}
+
+TEST(SDPServerUUIDIndex, Unregister){
+    sdp_unregister_service(spp_handles[1]);
+    CHECK_EQUAL(NUM_RECORDS - 1, service_search(sdp_service_search_pattern_for_uuid16(BLUETOOTH_SERVICE_CLASS_SERIAL_PORT)));
+    CHECK(service_search_result(0) != spp_handles[1]);
+    CHECK(service_search_result(1) != spp_handles[1]);
+    CHECK_EQUAL(1, service_search(sdp_service_search_pattern_for_uuid128(custom_uuid128)));
+}
+
+int main (int argc, const char * argv[]){
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
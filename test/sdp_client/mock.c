@@ -8,6 +8,13 @@
 
 static btstack_packet_handler_t packet_handler;
 
+static uint16_t mock_cid = 0x40;
+static uint16_t mock_channels_created;
+static uint16_t mock_disconnects;
+static uint16_t mock_requests_sent;
+static uint16_t mock_request_cid;
+static uint8_t  mock_outgoing_buffer[1000];
+
 extern "C" int l2cap_can_send_packet_now(uint16_t cid){
     return 1;
 }
@@ -19,12 +26,18 @@ extern "C" void l2cap_request_can_send_now_event(uint16_t cid){
 
 extern "C" uint8_t l2cap_create_channel(btstack_packet_handler_t handler, bd_addr_t address, uint16_t psm, uint16_t mtu, uint16_t * out_local_cid){
 	packet_handler = handler;
-    return 0x41;
+    mock_cid++;
+    mock_channels_created++;
+    if (out_local_cid != NULL){
+        *out_local_cid = mock_cid;
+    }
+    return ERROR_CODE_SUCCESS;
 }
 extern "C" void l2cap_disconnect(uint16_t local_cid, uint8_t reason){
+    mock_disconnects++;
 }
 extern "C" uint8_t *l2cap_get_outgoing_buffer(void){
-    return NULL;
+    return mock_outgoing_buffer;
 }
 extern "C" uint16_t l2cap_max_mtu(void){
     return 0;
@@ -33,5 +46,34 @@ extern "C" int l2cap_reserve_packet_buffer(void){
     return 0;
 }
 extern "C" int l2cap_send_prepared(uint16_t local_cid, uint16_t len){
+    mock_requests_sent++;
+    mock_request_cid = local_cid;
     return 0;
+}
+
+void mock_l2cap_reset(void){
+    mock_channels_created = 0;
+    mock_disconnects = 0;
+    mock_requests_sent = 0;
+}
+uint16_t mock_l2cap_channels_created(void){
+    return mock_channels_created;
+}
+uint16_t mock_l2cap_disconnects(void){
+    return mock_disconnects;
+}
+uint16_t mock_l2cap_requests_sent(void){
+    return mock_requests_sent;
+}
+uint16_t mock_l2cap_last_cid(void){
+    return mock_cid;
+}
+uint16_t mock_l2cap_request_cid(void){
+    return mock_request_cid;
+}
+const uint8_t * mock_l2cap_request(void){
+    return mock_outgoing_buffer;
+}
+void mock_l2cap_emit(uint8_t packet_type, uint16_t channel, uint8_t * packet, uint16_t size){
+    packet_handler(packet_type, channel, packet, size);
 }
\ No newline at end of file
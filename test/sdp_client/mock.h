@@ -11,3 +11,11 @@ void sdp_client_query_rfcomm_init(void);
 
 void sdp_client_reset(void);
 
+void mock_l2cap_reset(void);
+uint16_t mock_l2cap_channels_created(void);
+uint16_t mock_l2cap_disconnects(void);
+uint16_t mock_l2cap_requests_sent(void);
+uint16_t mock_l2cap_last_cid(void);
+uint16_t mock_l2cap_request_cid(void);
+const uint8_t * mock_l2cap_request(void);
+void mock_l2cap_emit(uint8_t packet_type, uint16_t channel, uint8_t * packet, uint16_t size);
@@ -0,0 +1,237 @@
+// *****************************************************************************
+//
+// test sdp client result cache
+//
+// *****************************************************************************
+
+#include "btstack_config.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bluetooth_psm.h"
+#include "bluetooth_sdp.h"
+#include "btstack_event.h"
+#include "btstack_run_loop.h"
+#include "btstack_run_loop_base.h"
+#include "classic/sdp_client.h"
+#include "classic/sdp_util.h"
+#include "l2cap.h"
+#include "mock.h"
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#ifndef ENABLE_SDP_CLIENT_CACHE
+#error "sdp_client_cache test requires ENABLE_SDP_CLIENT_CACHE"
+#endif
+
+static const uint8_t attribute_id_list[] = { 0x35, 0x03, 0x09, 0x00, 0x01 };
+
+static int      num_complete;
+static uint8_t  complete_status;
+static int      num_attribute_bytes;
+
+// mock run loop with time controlled by test
+
+static uint32_t mock_time_ms;
+
+static void mock_run_loop_init(void){
+    btstack_run_loop_base_init();
+}
+
+static void mock_run_loop_set_timer(btstack_timer_source_t * ts, uint32_t timeout_in_ms){
+    ts->timeout = mock_time_ms + timeout_in_ms;
+}
+
+static uint32_t mock_run_loop_get_time_ms(void){
+    return mock_time_ms;
+}
+
+static const btstack_run_loop_t mock_run_loop = {
+    &mock_run_loop_init,
+    &btstack_run_loop_base_add_data_source,
+    &btstack_run_loop_base_remove_data_source,
+    &btstack_run_loop_base_enable_data_source_callbacks,
+    &btstack_run_loop_base_disable_data_source_callbacks,
+    &mock_run_loop_set_timer,
+    &btstack_run_loop_base_add_timer,
+    &btstack_run_loop_base_remove_timer,
+    NULL,
+    NULL,
+    &mock_run_loop_get_time_ms,
+};
+
+static void mock_run_loop_advance(uint32_t delta_ms){
+    mock_time_ms += delta_ms;
+    btstack_run_loop_base_process_timers(mock_time_ms);
+}
+
+static void handle_sdp_client_event(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    switch (hci_event_packet_get_type(packet)){
+        case SDP_EVENT_QUERY_ATTRIBUTE_VALUE:
+            num_attribute_bytes++;
+            break;
+        case SDP_EVENT_QUERY_COMPLETE:
+            complete_status = sdp_event_query_complete_get_status(packet);
+            num_complete++;
+            break;
+        default:
+            break;
+    }
+}
+
+static void emit_channel_opened(uint16_t cid){
+    // event (8), len(8), status (8), address(48), handle (16), psm (16), local_cid(16), remote_cid (16), local_mtu(16), remote_mtu(16), ..
+    uint8_t event[26];
+    memset(event, 0, sizeof(event));
+    event[0] = L2CAP_EVENT_CHANNEL_OPENED;
+    event[1] = sizeof(event) - 2;
+    little_endian_store_16(event, 11, BLUETOOTH_PSM_SDP);
+    little_endian_store_16(event, 13, cid);
+    little_endian_store_16(event, 17, 672);
+    mock_l2cap_emit(HCI_EVENT_PACKET, cid, event, sizeof(event));
+}
+
+static void emit_channel_closed(uint16_t cid){
+    uint8_t event[4];
+    event[0] = L2CAP_EVENT_CHANNEL_CLOSED;
+    event[1] = 2;
+    little_endian_store_16(event, 2, cid);
+    mock_l2cap_emit(HCI_EVENT_PACKET, cid, event, sizeof(event));
+}
+
+// ServiceSearchAttributeResponse with a single record with attribute 0x0001 = UUID16 0x1101
+static void emit_response(uint16_t cid){
+    const uint8_t * request = mock_l2cap_request();
+    uint8_t attribute_lists[] = { 0x35, 0x08, 0x35, 0x06, 0x09, 0x00, 0x01, 0x19, 0x11, 0x01 };
+    uint8_t response[5 + 2 + sizeof(attribute_lists) + 1];
+    uint16_t pos = 0;
+    response[pos++] = SDP_ServiceSearchAttributeResponse;
+    response[pos++] = request[1];
+    response[pos++] = request[2];
+    big_endian_store_16(response, pos, sizeof(response) - 5);
+    pos += 2;
+    big_endian_store_16(response, pos, sizeof(attribute_lists));
+    pos += 2;
+    memcpy(&response[pos], attribute_lists, sizeof(attribute_lists));
+    pos += sizeof(attribute_lists);
+    response[pos++] = 0;
+    mock_l2cap_emit(L2CAP_DATA_PACKET, cid, response, pos);
+}
+
+static uint8_t start_query(bd_addr_t remote){
+    return sdp_client_query(&handle_sdp_client_event, remote, sdp_service_search_pattern_for_uuid16(0x1101), attribute_id_list);
+}
+
+// query answered by remote device
+static void query_remote(bd_addr_t remote){
+    int channels_created = mock_l2cap_channels_created();
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, start_query(remote));
+    CHECK_EQUAL(channels_created + 1, mock_l2cap_channels_created());
+    uint16_t cid = mock_l2cap_last_cid();
+    emit_channel_opened(cid);
+    emit_response(cid);
+    emit_channel_closed(cid);
+}
+
+TEST_GROUP(SDPClientCache){
+    bd_addr_t address_a;
+    bd_addr_t address_b;
+
+    void setup(void){
+        btstack_run_loop_base_init();
+        mock_time_ms = 0;
+        sdp_client_reset();
+        mock_l2cap_reset();
+        num_complete = 0;
+        num_attribute_bytes = 0;
+        complete_status = 0xff;
+        memset(address_a, 0, sizeof(address_a));
+        memset(address_b, 0, sizeof(address_b));
+        address_a[5] = 0x0a;
+        address_b[5] = 0x0b;
+    }
+};
+
+TEST(SDPClientCache, SecondQueryAnsweredFromCache){
+    query_remote(address_a);
+    CHECK_EQUAL(1, num_complete);
+    CHECK_EQUAL(3, num_attribute_bytes);
+
+    // results delivered from run loop without connecting again
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, start_query(address_a));
+    CHECK_EQUAL(1, num_complete);
+    mock_run_loop_advance(0);
+    CHECK_EQUAL(1, mock_l2cap_channels_created());
+    CHECK_EQUAL(2, num_complete);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, complete_status);
+    CHECK_EQUAL(6, num_attribute_bytes);
+    CHECK_EQUAL(1, sdp_client_ready());
+}
+
+TEST(SDPClientCache, CacheIsPerRemoteAndQuery){
+    query_remote(address_a);
+
+    // other remote
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, start_query(address_b));
+    CHECK_EQUAL(2, mock_l2cap_channels_created());
+    emit_channel_closed(mock_l2cap_last_cid());
+
+    // other search pattern
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, sdp_client_query(&handle_sdp_client_event, address_a, sdp_service_search_pattern_for_uuid16(0x1102), attribute_id_list));
+    CHECK_EQUAL(3, mock_l2cap_channels_created());
+}
+
+TEST(SDPClientCache, ExpiredAfterTtl){
+    query_remote(address_a);
+
+    mock_run_loop_advance(SDP_CLIENT_CACHE_TTL_MS);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, start_query(address_a));
+    mock_run_loop_advance(0);
+    CHECK_EQUAL(1, mock_l2cap_channels_created());
+    CHECK_EQUAL(2, num_complete);
+
+    mock_run_loop_advance(SDP_CLIENT_CACHE_TTL_MS + 1);
+    query_remote(address_a);
+    CHECK_EQUAL(2, mock_l2cap_channels_created());
+    CHECK_EQUAL(3, num_complete);
+}
+
+TEST(SDPClientCache, RemovedForRemote){
+    query_remote(address_a);
+    query_remote(address_b);
+
+    sdp_client_cache_remove(address_a);
+    query_remote(address_a);
+    CHECK_EQUAL(3, mock_l2cap_channels_created());
+
+    // entry of other remote kept
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, start_query(address_b));
+    mock_run_loop_advance(0);
+    CHECK_EQUAL(3, mock_l2cap_channels_created());
+    CHECK_EQUAL(4, num_complete);
+}
+
+TEST(SDPClientCache, RemovedBeforeDelivery){
+    query_remote(address_a);
+
+    // query falls back to remote device if entry is removed before results are delivered
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, start_query(address_a));
+    sdp_client_cache_remove(address_a);
+    mock_run_loop_advance(0);
+    CHECK_EQUAL(2, mock_l2cap_channels_created());
+    CHECK_EQUAL(1, num_complete);
+    uint16_t cid = mock_l2cap_last_cid();
+    emit_channel_opened(cid);
+    emit_response(cid);
+    CHECK_EQUAL(2, num_complete);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, complete_status);
+}
+
+int main (int argc, const char * argv[]){
+    btstack_run_loop_init(&mock_run_loop);
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
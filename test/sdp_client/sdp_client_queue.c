@@ -0,0 +1,175 @@
+
+// *****************************************************************************
+//
+// test sdp client query queue
+//
+// *****************************************************************************
+
+#include "btstack_config.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bluetooth_psm.h"
+#include "bluetooth_sdp.h"
+#include "btstack_event.h"
+#include "classic/sdp_client.h"
+#include "classic/sdp_util.h"
+#include "l2cap.h"
+#include "mock.h"
+
+#include "CppUTest/TestHarness.h"
+#include "CppUTest/CommandLineTestRunner.h"
+
+#define MAX_QUERIES 8
+
+static uint16_t complete_query_id[MAX_QUERIES];
+static uint8_t  complete_status[MAX_QUERIES];
+static int      num_complete;
+static int      num_attribute_bytes;
+
+static void handle_sdp_client_event(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size){
+    switch (hci_event_packet_get_type(packet)){
+        case SDP_EVENT_QUERY_ATTRIBUTE_VALUE:
+            num_attribute_bytes++;
+            break;
+        case SDP_EVENT_QUERY_COMPLETE:
+            if (num_complete >= MAX_QUERIES) break;
+            complete_query_id[num_complete] = channel;
+            complete_status[num_complete] = sdp_event_query_complete_get_status(packet);
+            num_complete++;
+            break;
+        default:
+            break;
+    }
+}
+
+static void emit_channel_opened(uint16_t cid){
+    // event (8), len(8), status (8), address(48), handle (16), psm (16), local_cid(16), remote_cid (16), local_mtu(16), remote_mtu(16), ..
+    uint8_t event[26];
+    memset(event, 0, sizeof(event));
+    event[0] = L2CAP_EVENT_CHANNEL_OPENED;
+    event[1] = sizeof(event) - 2;
+    little_endian_store_16(event, 11, BLUETOOTH_PSM_SDP);
+    little_endian_store_16(event, 13, cid);
+    little_endian_store_16(event, 17, 672);
+    mock_l2cap_emit(HCI_EVENT_PACKET, cid, event, sizeof(event));
+}
+
+static void emit_channel_closed(uint16_t cid){
+    uint8_t event[4];
+    event[0] = L2CAP_EVENT_CHANNEL_CLOSED;
+    event[1] = 2;
+    little_endian_store_16(event, 2, cid);
+    mock_l2cap_emit(HCI_EVENT_PACKET, cid, event, sizeof(event));
+}
+
+// ServiceSearchAttributeResponse with a single record with attribute 0x0001 = UUID16 0x1101
+static void emit_response(uint16_t cid){
+    const uint8_t * request = mock_l2cap_request();
+    uint8_t attribute_lists[] = { 0x35, 0x08, 0x35, 0x06, 0x09, 0x00, 0x01, 0x19, 0x11, 0x01 };
+    uint8_t response[5 + 2 + sizeof(attribute_lists) + 1];
+    uint16_t pos = 0;
+    response[pos++] = SDP_ServiceSearchAttributeResponse;
+    response[pos++] = request[1];
+    response[pos++] = request[2];
+    big_endian_store_16(response, pos, sizeof(response) - 5);
+    pos += 2;
+    big_endian_store_16(response, pos, sizeof(attribute_lists));
+    pos += 2;
+    memcpy(&response[pos], attribute_lists, sizeof(attribute_lists));
+    pos += sizeof(attribute_lists);
+    response[pos++] = 0;
+    mock_l2cap_emit(L2CAP_DATA_PACKET, cid, response, pos);
+}
+
+TEST_GROUP(SDPClientQueue){
+    bd_addr_t address_a;
+    bd_addr_t address_b;
+
+    void setup(void){
+        sdp_client_reset();
+        mock_l2cap_reset();
+        num_complete = 0;
+        num_attribute_bytes = 0;
+        memset(address_a, 0, sizeof(address_a));
+        memset(address_b, 0, sizeof(address_b));
+        address_a[5] = 0x0a;
+        address_b[5] = 0x0b;
+    }
+};
+
+TEST(SDPClientQueue, QueriesToSameRemoteShareChannel){
+    uint16_t query_1;
+    uint16_t query_2;
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, sdp_client_query_with_id(&handle_sdp_client_event, address_a, sdp_service_search_pattern_for_uuid16(0x1101), (uint8_t *) "\x35\x03\x09\x00\x01", &query_1));
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, sdp_client_query_with_id(&handle_sdp_client_event, address_a, sdp_service_search_pattern_for_uuid16(0x1102), (uint8_t *) "\x35\x03\x09\x00\x01", &query_2));
+    CHECK(query_1 != query_2);
+    CHECK_EQUAL(1, mock_l2cap_channels_created());
+    uint16_t cid = mock_l2cap_last_cid();
+
+    emit_channel_opened(cid);
+    CHECK_EQUAL(1, mock_l2cap_requests_sent());
+    // search pattern of first query was copied
+    CHECK_EQUAL(0x11, mock_l2cap_request()[8]);
+    CHECK_EQUAL(0x01, mock_l2cap_request()[9]);
+
+    emit_response(cid);
+    CHECK_EQUAL(1, num_complete);
+    CHECK_EQUAL(query_1, complete_query_id[0]);
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, complete_status[0]);
+    CHECK_EQUAL(3, num_attribute_bytes);
+
+    // second query sent on same channel
+    CHECK_EQUAL(2, mock_l2cap_requests_sent());
+    CHECK_EQUAL(cid, mock_l2cap_request_cid());
+    CHECK_EQUAL(0x02, mock_l2cap_request()[9]);
+    CHECK_EQUAL(0, mock_l2cap_disconnects());
+
+    emit_response(cid);
+    CHECK_EQUAL(2, num_complete);
+    CHECK_EQUAL(query_2, complete_query_id[1]);
+    CHECK_EQUAL(1, mock_l2cap_channels_created());
+    CHECK_EQUAL(1, mock_l2cap_disconnects());
+    emit_channel_closed(cid);
+    CHECK_EQUAL(2, num_complete);
+    CHECK_EQUAL(1, sdp_client_ready());
+}
+
+TEST(SDPClientQueue, QueriesToDifferentRemotesRunInParallel){
+    uint16_t query_1;
+    uint16_t query_2;
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, sdp_client_query_with_id(&handle_sdp_client_event, address_a, sdp_service_search_pattern_for_uuid16(0x1101), (uint8_t *) "\x35\x03\x09\x00\x01", &query_1));
+    uint16_t cid_a = mock_l2cap_last_cid();
+    CHECK_EQUAL(ERROR_CODE_SUCCESS, sdp_client_query_with_id(&handle_sdp_client_event, address_b, sdp_service_search_pattern_for_uuid16(0x1101), (uint8_t *) "\x35\x03\x09\x00\x01", &query_2));
+    uint16_t cid_b = mock_l2cap_last_cid();
+    CHECK_EQUAL(2, mock_l2cap_channels_created());
+    CHECK(cid_a != cid_b);
+
+    emit_channel_opened(cid_b);
+    emit_channel_opened(cid_a);
+    emit_response(cid_a);
+    CHECK_EQUAL(1, num_complete);
+    CHECK_EQUAL(query_1, complete_query_id[0]);
+
+    // closing channel before response completes query with error
+    emit_channel_closed(cid_b);
+    CHECK_EQUAL(2, num_complete);
+    CHECK_EQUAL(query_2, complete_query_id[1]);
+    CHECK_EQUAL(SDP_QUERY_INCOMPLETE, complete_status[1]);
+}
+
+TEST(SDPClientQueue, QueueFull){
+    int i;
+    for (i=0;i<SDP_CLIENT_MAX_QUERIES;i++){
+        CHECK_EQUAL(ERROR_CODE_SUCCESS, sdp_client_query_uuid16(&handle_sdp_client_event, address_a, 0x1101));
+    }
+    CHECK_EQUAL(0, sdp_client_ready());
+    CHECK_EQUAL(SDP_QUERY_BUSY, sdp_client_query_uuid16(&handle_sdp_client_event, address_a, 0x1101));
+}
+
+int main (int argc, const char * argv[]){
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
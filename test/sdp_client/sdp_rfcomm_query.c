@@ -112,6 +112,12 @@ TEST_GROUP(SDPClient){
         // start query using public API although data will be injected
         sdp_client_query_rfcomm_channel_and_name_for_uuid(&handle_query_rfcomm_event, address, 0x1234);
     }
+    void teardown(void){
+        int i;
+        for (i=0; i<service_index; i++){
+            free(service_name[i]);
+        }
+    }
 };
 
 
@@ -282,7 +282,7 @@ def create_events(events):
             offset_is_number = 1
             offset_unknown = 0
             supported = all_fields_supported(format)
-            last_variable_length_field_pos = ""
+            last_variable_length_field_pos = None
             if is_le_event(event_group):
                 fout.write("#ifdef ENABLE_BLE\n")
             if len(format) != len(args):
@@ -308,7 +308,7 @@ def create_events(events):
                     else:
                         last_variable_length_field_pos = offset
                 if field_type in 'V':
-                    if last_variable_length_field_pos >= 0:
+                    if last_variable_length_field_pos is not None:
                         if offset_is_number:
                             # convert to string
                             offset = '%u' % offset
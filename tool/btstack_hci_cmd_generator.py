@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+# BlueKitchen GmbH (c) 2020
+
+# Creates src/hci_cmd_encoder.h with typed HCI Command encoders for all commands in src/hci_cmd.c
+
+import os
+import sys
+
+import btstack_parser as parser
+
+program_info = '''
+BTstack HCI Command Encoder Generator for BTstack
+Copyright 2020, BlueKitchen GmbH
+'''
+
+copyright = """/*
+ * Copyright (C) 2020 BlueKitchen GmbH
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holders nor the names of
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ * 4. Any redistribution, use, or modification is done solely for
+ *    personal benefit and not for any commercial purpose or for
+ *    monetary gain.
+ *
+ * THIS SOFTWARE IS PROVIDED BY BLUEKITCHEN GMBH AND CONTRIBUTORS
+ * ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL MATTHIAS
+ * RINGWALD OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * Please inquire about commercial licensing options at 
+ * contact@bluekitchen-gmbh.com
+ *
+ */
+"""
+
+hfile_header_begin = """
+
+/*
+ *  hci_cmd_encoder.h
+ *
+ *  @brief Typed HCI Command encoders, alternative to hci_send_cmd without format string interpretation
+ *  @note  Don't edit - generated by tool/btstack_hci_cmd_generator.py
+ *
+ */
+
+#ifndef HCI_CMD_ENCODER_H
+#define HCI_CMD_ENCODER_H
+
+#if defined __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <string.h>
+
+#include "btstack_util.h"
+#include "hci.h"
+#include "hci_cmd.h"
+
+#define HCI_CMD_ENCODER_OPCODE(ogf, ocf) ((ocf) | ((ogf) << 10))
+
+/* API_START */
+
+"""
+
+hfile_header_end = """/* API_END */
+
+#if defined __cplusplus
+}
+#endif
+
+#endif // HCI_CMD_ENCODER_H
+"""
+
+encoder_template = '''/**
+ * @brief Encode {command_name} into buffer
+ * @param packet buffer for {size} bytes
+{param_docs} * @return size of command
+ * @note: format {format}
+ */
+static inline uint16_t {encoder_name}({encoder_params}){{
+    packet[0] = (uint8_t) HCI_CMD_ENCODER_OPCODE({ogf}, {ocf});
+    packet[1] = (uint8_t) (HCI_CMD_ENCODER_OPCODE({ogf}, {ocf}) >> 8);
+    packet[2] = {param_len};
+{code}    return {size};
+}}
+
+/**
+ * @brief Send {command_name}, same as hci_send_cmd(&{command_name}, ...)
+{param_docs} * @return status as hci_send_cmd
+ */
+static inline int {sender_name}({sender_params}){{
+    uint8_t * packet = hci_reserve_cmd_packet_buffer();
+    if (packet == NULL) return 0;
+    return hci_send_cmd_packet_buffer({encoder_name}({encoder_args}));
+}}
+
+'''
+
+# C type and size for each format character
+param_types = {
+    '1' : ('uint8_t', 1),
+    '2' : ('uint16_t', 2),
+    '3' : ('uint32_t', 3),
+    '4' : ('uint32_t', 4),
+    'H' : ('hci_con_handle_t', 2),
+    'B' : ('const bd_addr_t', 6),
+    'D' : ('const uint8_t *', 8),
+    'E' : ('const uint8_t *', 240),
+    'N' : ('const char *', 248),
+    'P' : ('const uint8_t *', 16),
+    'A' : ('const uint8_t *', 31),
+    'Q' : ('const uint8_t *', 32),
+}
+
+# parameter names that are C or C++ keywords or clash with the packet buffer
+keywords = ['auto', 'char', 'class', 'default', 'delete', 'int', 'long', 'new', 'operator', 'packet', 'private',
+            'protected', 'public', 'register', 'short', 'signed', 'template', 'this', 'unsigned']
+
+# integers are stored byte by byte to allow for constant folding after inlining
+def store_little_endian(name, pos, num_bytes):
+    code = '    packet[%u] = (uint8_t) %s;\n' % (pos, name)
+    for i in range(1, num_bytes):
+        code += '    packet[%u] = (uint8_t) (%s >> %u);\n' % (pos + i, name, 8 * i)
+    return code
+
+def param_code(format_char, name, pos):
+    if format_char in '1234H':
+        return store_little_endian(name, pos, param_types[format_char][1])
+    if format_char == 'B':
+        return '    reverse_bd_addr(%s, &packet[%u]);\n' % (name, pos)
+    if format_char == 'Q':
+        return '    reverse_bytes(%s, &packet[%u], 32);\n' % (name, pos)
+    if format_char == 'N':
+        code  = '    uint16_t %s_len = btstack_min(strlen(%s), 248);\n' % (name, name)
+        code += '    (void)memcpy(&packet[%u], %s, %s_len);\n' % (pos, name, name)
+        code += '    memset(&packet[%u + %s_len], 0, 248 - %s_len);\n' % (pos, name, name)
+        return code
+    return '    (void)memcpy(&packet[%u], %s, %u);\n' % (pos, name, param_types[format_char][1])
+
+def create_encoder(fout, command):
+    (command_name, ogf, ocf, format, params) = command
+    short_name = command_name[len('hci_'):] if command_name.startswith('hci_') else command_name
+    names = []
+    for param in params:
+        if param in keywords or param in names:
+            param = param + '_%u' % (len(names) + 1)
+        names.append(param)
+    pos = 3
+    code = ''
+    typed_params = []
+    for (format_char, name) in zip(format, names):
+        (param_type, param_size) = param_types[format_char]
+        typed_params.append('%s %s' % (param_type, name))
+        code += param_code(format_char, name, pos)
+        pos += param_size
+    fout.write(encoder_template.format(
+        command_name=command_name,
+        encoder_name='hci_cmd_encode_' + short_name,
+        sender_name='hci_send_cmd_' + short_name,
+        encoder_params=', '.join(['uint8_t * packet'] + typed_params),
+        sender_params=', '.join(typed_params) if typed_params else 'void',
+        encoder_args=', '.join(['packet'] + names),
+        param_docs=''.join([' * @param %s\n' % name for name in names]),
+        format=format if format else '-',
+        ogf=ogf, ocf=ocf, code=code, param_len=pos - 3, size=pos))
+
+def create_encoders(commands):
+    with open(gen_path, 'wt') as fout:
+        fout.write(copyright)
+        fout.write(hfile_header_begin)
+        for command in commands:
+            create_encoder(fout, command)
+        fout.write(hfile_header_end)
+
+btstack_root = os.path.abspath(os.path.dirname(sys.argv[0]) + '/..')
+gen_path = btstack_root + '/src/hci_cmd_encoder.h'
+
+print(program_info)
+
+# parse commands
+commands = parser.my_parse_commands(btstack_root + '/' + parser.hci_cmds_c_path, False, True)
+
+# create encoders
+create_encoders(commands)
+
+# done
+print('Done!')
@@ -103,7 +103,7 @@ def parse_events():
 
     return (events, subvents, event_types)
 
-def my_parse_commands(infile, convert_to_camel_case):
+def my_parse_commands(infile, convert_to_camel_case, allow_raw_opcode=False):
     commands = []
     with open (infile, 'rt') as fin:
 
@@ -133,8 +133,18 @@ def my_parse_commands(infile, convert_to_camel_case):
                 continue
 
             definition = re.match('\s*OPCODE\\(\s*(\w+)\s*,\s+(\w+)\s*\\)\s*,\s\\"(\w*)\\".*', line)
+            if not definition and allow_raw_opcode:
+                # vendor commands defined with raw opcode, e.g. 0xFD84
+                raw_definition = re.match('\s*(0x[0-9a-fA-F]{4})\s*,\s*\\"(\w*)\\".*', line)
+                if raw_definition:
+                    (opcode, format) = raw_definition.groups()
+                    opcode = int(opcode, 16)
+                    definition = raw_definition
             if definition:
-                (ogf, ocf, format) = definition.groups()
+                if definition.re.groups == 3:
+                    (ogf, ocf, format) = definition.groups()
+                else:
+                    (ogf, ocf) = ('0x%02x' % (opcode >> 10), '0x%03x' % (opcode & 0x3ff))
                 if len(params) != len(format):
                     params = []
                     arg_counter = 1